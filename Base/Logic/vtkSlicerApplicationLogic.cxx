@@ -445,6 +445,29 @@ vtkMTimeType vtkSlicerApplicationLogic::RequestReadFile(const char *refNode, con
   return uid;
 }
 
+//----------------------------------------------------------------------------
+vtkMTimeType vtkSlicerApplicationLogic::RequestSetVolumeImageData(const std::string& volumeNodeID,
+  vtkImageData* imageData, vtkMatrix4x4* ijkToRASMatrix, int displayData)
+{
+  // only request to read data if the ReadData queue is up
+  this->ReadDataQueueActiveLock.lock();
+  int active = this->ReadDataQueueActive;
+  this->ReadDataQueueActiveLock.unlock();
+  if (!active)
+  {
+    // could not request the record be added to the queue
+    return 0;
+  }
+
+  this->ReadDataQueueLock.lock();
+  this->RequestTimeStamp.Modified();
+  vtkMTimeType uid = this->RequestTimeStamp.GetMTime();
+  (*this->InternalReadDataQueue).push(
+    new ReadDataRequestVolumeImageData(volumeNodeID, imageData, ijkToRASMatrix, displayData, uid));
+  this->ReadDataQueueLock.unlock();
+  return uid;
+}
+
 //----------------------------------------------------------------------------
 vtkMTimeType vtkSlicerApplicationLogic::RequestUpdateParentTransform(const std::string &refNode, const std::string& parentTransformNode)
 {
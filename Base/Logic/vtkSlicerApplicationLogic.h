@@ -33,6 +33,8 @@
 // STL includes
 #include <mutex>
 
+class vtkImageData;
+class vtkMatrix4x4;
 class vtkMRMLSelectionNode;
 class vtkMRMLInteractionNode;
 class vtkMRMLRemoteIOLogic;
@@ -113,6 +115,18 @@ class VTK_SLICER_BASE_LOGIC_EXPORT vtkSlicerApplicationLogic
   vtkMTimeType RequestReadFile(const char *refNode, const char *filename,
     int displayData = false, int deleteFile = false);
 
+  /// Request that the image data and geometry of a volume node be replaced.
+  /// This allows a processing thread to hand over an image that it created
+  /// in memory (without writing it to a file). The image data must not be
+  /// modified after the request is made. The request will be sent to the main
+  /// thread, which sets the image on the volume node and updates the display.
+  /// Return the request UID (monotonically increasing) of the request or 0 if
+  /// the request failed to be registered. When the request is processed,
+  /// RequestProcessedEvent is invoked with the request UID as calldata.
+  /// \sa RequestReadFile()
+  vtkMTimeType RequestSetVolumeImageData(const std::string& volumeNodeID, vtkImageData* imageData,
+    vtkMatrix4x4* ijkToRASMatrix, int displayData = false);
+
   /// Request setting of parent transform.
   /// The request will executed on the main thread.
   /// Return the request UID (monotonically increasing) of the request or 0 if
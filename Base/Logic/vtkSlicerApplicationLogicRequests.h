@@ -19,6 +19,10 @@
 #include <vtkMRMLSubjectHierarchyNode.h>
 #include <vtkMRMLTableNode.h>
 
+#include <vtkImageData.h>
+#include <vtkMatrix4x4.h>
+#include <vtkSmartPointer.h>
+
 //----------------------------------------------------------------------------
 class DataRequest
 {
@@ -40,6 +44,58 @@ public:
   int GetUID()const{return m_UID;}
 
 protected:
+  /// Create default display nodes for a node that has been read, notify observers,
+  /// and if displayData is enabled then show the node in the views.
+  static void UpdateDisplay(vtkSlicerApplicationLogic* appLogic, vtkMRMLNode* nd, int displayData)
+  {
+    // Get the right type of display node. Only create a display node
+    // if one does not exist already
+    //
+    vtkMRMLDisplayableNode *displayableNode =
+      vtkMRMLDisplayableNode::SafeDownCast(nd);
+    if (displayableNode)
+    {
+      // Create a default display node if no display node exists for the node yet.
+      displayableNode->CreateDefaultDisplayNodes();
+    }
+
+    // Cause the any observers to fire (we may have avoided calling
+    // modified on the node)
+    //
+    nd->Modified();
+
+    // If scalar volume, set the volume as the active volume and
+    // propagate selection.
+    //
+    // Models are always displayed when loaded above.
+    //
+    // Tensors? Vectors?
+    if (displayData)
+    {
+      if (vtkMRMLLabelMapVolumeNode::SafeDownCast(nd) != nullptr)
+      {
+        appLogic->GetSelectionNode()->SetActiveLabelVolumeID(nd->GetID());
+        appLogic->PropagateVolumeSelection();
+      }
+      else if (vtkMRMLScalarVolumeNode::SafeDownCast(nd) != nullptr)
+      {
+        appLogic->GetSelectionNode()->SetActiveVolumeID(nd->GetID());
+        // make sure win/level gets calculated
+        vtkMRMLDisplayNode* displayNode = vtkMRMLScalarVolumeNode::SafeDownCast(nd)->GetDisplayNode();
+        if (displayNode)
+        {
+          displayNode->Modified();
+        }
+        appLogic->PropagateVolumeSelection();
+      }
+      else if (vtkMRMLTableNode::SafeDownCast(nd) != nullptr)
+      {
+        appLogic->GetSelectionNode()->SetActiveTableID(nd->GetID());
+        appLogic->PropagateTableSelection();
+      }
+    }
+  }
+
   vtkMTimeType m_UID;
 };
 
@@ -189,59 +245,52 @@ public:
     }
 
 
-    // Get the right type of display node. Only create a display node
-    // if one does not exist already
-    //
-    vtkMRMLDisplayableNode *displayableNode =
-      vtkMRMLDisplayableNode::SafeDownCast(nd);
-    if (displayableNode)
-    {
-      // Create a default display node if no display node exists for the node yet.
-      displayableNode->CreateDefaultDisplayNodes();
-    }
+    this->UpdateDisplay(appLogic, nd, m_DisplayData);
+  }
 
-    // Cause the any observers to fire (we may have avoided calling
-    // modified on the node)
-    //
-    nd->Modified();
+protected:
+  std::string m_TargetNode;
+  std::string m_Filename;
+  int m_DisplayData;
+  int m_DeleteFile;
+};
 
-    // If scalar volume, set the volume as the active volume and
-    // propagate selection.
-    //
-    // Models are always displayed when loaded above.
-    //
-    // Tensors? Vectors?
-    if (m_DisplayData)
+//----------------------------------------------------------------------------
+class ReadDataRequestVolumeImageData : public DataRequest
+{
+public:
+  ReadDataRequestVolumeImageData(const std::string& node, vtkImageData* imageData,
+    vtkMatrix4x4* ijkToRASMatrix, int displayData, int uid = 0)
+    : DataRequest(uid)
+  {
+    m_TargetNode = node;
+    m_ImageData = imageData;
+    m_IJKToRASMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+    m_IJKToRASMatrix->DeepCopy(ijkToRASMatrix);
+    m_DisplayData = displayData;
+  }
+
+  void Execute(vtkSlicerApplicationLogic* appLogic) override
+  {
+    vtkMRMLVolumeNode* volumeNode = vtkMRMLVolumeNode::SafeDownCast(
+      appLogic->GetMRMLScene()->GetNodeByID(m_TargetNode.c_str()));
+    if (!volumeNode)
     {
-      if (vtkMRMLLabelMapVolumeNode::SafeDownCast(nd) != nullptr)
-      {
-        appLogic->GetSelectionNode()->SetActiveLabelVolumeID(m_TargetNode.c_str());
-        appLogic->PropagateVolumeSelection();
-      }
-      else if (vtkMRMLScalarVolumeNode::SafeDownCast(nd) != nullptr)
-      {
-        appLogic->GetSelectionNode()->SetActiveVolumeID(m_TargetNode.c_str());
-        // make sure win/level gets calculated
-        vtkMRMLDisplayNode* displayNode = vtkMRMLScalarVolumeNode::SafeDownCast(nd)->GetDisplayNode();
-        if (displayNode)
-        {
-          displayNode->Modified();
-        }
-        appLogic->PropagateVolumeSelection();
-      }
-      else if (vtkMRMLTableNode::SafeDownCast(nd) != nullptr)
-      {
-        appLogic->GetSelectionNode()->SetActiveTableID(m_TargetNode.c_str());
-        appLogic->PropagateTableSelection();
-      }
+      vtkErrorWithObjectMacro(appLogic, "ProcessReadNodeData: volume node " << m_TargetNode << " not found");
+      return;
     }
+    int wasModified = volumeNode->StartModify();
+    volumeNode->SetIJKToRASMatrix(m_IJKToRASMatrix);
+    volumeNode->SetAndObserveImageData(m_ImageData);
+    volumeNode->EndModify(wasModified);
+    this->UpdateDisplay(appLogic, volumeNode, m_DisplayData);
   }
 
 protected:
   std::string m_TargetNode;
-  std::string m_Filename;
+  vtkSmartPointer<vtkImageData> m_ImageData;
+  vtkSmartPointer<vtkMatrix4x4> m_IJKToRASMatrix;
   int m_DisplayData;
-  int m_DeleteFile;
 };
 
 //----------------------------------------------------------------------------
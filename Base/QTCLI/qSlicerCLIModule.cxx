@@ -104,6 +104,12 @@ vtkMRMLAbstractLogic* qSlicerCLIModule::createLogic()
     logic->SetAllowInMemoryTransfer(0);
   }
 
+  // Transfer volumes to and from command line executables through shared memory
+  if (settings.value("Modules/CLISharedMemoryTransfer", false).toBool())
+  {
+    logic->SetAllowSharedMemoryTransfer(1);
+  }
+
   return logic;
 }
 
@@ -26,19 +26,28 @@
 #include <vtkMRMLModelHierarchyNode.h>
 #include <vtkMRMLModelNode.h>
 #include <vtkMRMLROIListNode.h>
+#include <vtkMRMLScalarVolumeNode.h>
 #include <vtkMRMLStorageNode.h>
 #include <vtkMRMLModelStorageNode.h>
 #include <vtkMRMLTransformNode.h>
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
 #include <vtkIntArray.h>
+#include <vtkMatrix4x4.h>
 #include <vtkMultiThreader.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSmartPointer.h>
 #include <vtkStringArray.h>
 #include <vtksys/SystemTools.hxx>
 
+// ITK includes
+#include <itkSharedMemoryImageIO.h>
+
 // ITKSYS includes
 #include <itksys/Process.h>
 #include <itksys/SystemTools.hxx>
@@ -46,7 +55,9 @@
 
 // STL includes
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstring>
 #include <ctime>
 #include <mutex>
 #include <random>
@@ -58,6 +69,152 @@
 #include <unistd.h>
 #endif
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool GetITKComponentTypeFromVTKScalarType(int vtkScalarType, itk::IOComponentEnum& componentType)
+{
+  switch (vtkScalarType)
+  {
+    case VTK_CHAR:
+    case VTK_SIGNED_CHAR: componentType = itk::IOComponentEnum::CHAR; return true;
+    case VTK_UNSIGNED_CHAR: componentType = itk::IOComponentEnum::UCHAR; return true;
+    case VTK_SHORT: componentType = itk::IOComponentEnum::SHORT; return true;
+    case VTK_UNSIGNED_SHORT: componentType = itk::IOComponentEnum::USHORT; return true;
+    case VTK_INT: componentType = itk::IOComponentEnum::INT; return true;
+    case VTK_UNSIGNED_INT: componentType = itk::IOComponentEnum::UINT; return true;
+    case VTK_LONG_LONG: componentType = itk::IOComponentEnum::LONGLONG; return true;
+    case VTK_UNSIGNED_LONG_LONG: componentType = itk::IOComponentEnum::ULONGLONG; return true;
+    case VTK_FLOAT: componentType = itk::IOComponentEnum::FLOAT; return true;
+    case VTK_DOUBLE: componentType = itk::IOComponentEnum::DOUBLE; return true;
+    default: return false;
+  }
+}
+
+//----------------------------------------------------------------------------
+int GetVTKScalarTypeFromITKComponentType(itk::IOComponentEnum componentType)
+{
+  switch (componentType)
+  {
+    case itk::IOComponentEnum::CHAR: return VTK_SIGNED_CHAR;
+    case itk::IOComponentEnum::UCHAR: return VTK_UNSIGNED_CHAR;
+    case itk::IOComponentEnum::SHORT: return VTK_SHORT;
+    case itk::IOComponentEnum::USHORT: return VTK_UNSIGNED_SHORT;
+    case itk::IOComponentEnum::INT: return VTK_INT;
+    case itk::IOComponentEnum::UINT: return VTK_UNSIGNED_INT;
+    case itk::IOComponentEnum::LONG: return sizeof(long) == 8 ? VTK_LONG_LONG : VTK_INT;
+    case itk::IOComponentEnum::ULONG: return sizeof(unsigned long) == 8 ? VTK_UNSIGNED_LONG_LONG : VTK_UNSIGNED_INT;
+    case itk::IOComponentEnum::LONGLONG: return VTK_LONG_LONG;
+    case itk::IOComponentEnum::ULONGLONG: return VTK_UNSIGNED_LONG_LONG;
+    case itk::IOComponentEnum::FLOAT: return VTK_FLOAT;
+    case itk::IOComponentEnum::DOUBLE: return VTK_DOUBLE;
+    default: return VTK_VOID;
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Publish the voxels and geometry of a volume node in a new shared memory segment.
+/// Geometry is converted to LPS, which is the coordinate system ITK uses.
+bool WriteVolumeToSharedMemory(vtkMRMLScalarVolumeNode* volumeNode, const std::string& segmentName)
+{
+  vtkImageData* imageData = volumeNode ? volumeNode->GetImageData() : nullptr;
+  if (!imageData || !imageData->GetPointData() || !imageData->GetPointData()->GetScalars())
+  {
+    return false;
+  }
+  int* extent = imageData->GetExtent();
+  if (extent[0] != 0 || extent[2] != 0 || extent[4] != 0)
+  {
+    return false;
+  }
+  itk::SharedMemoryImageIO::HeaderType header;
+  itk::SharedMemoryImageIO::InitializeHeader(header);
+  itk::IOComponentEnum componentType;
+  if (!GetITKComponentTypeFromVTKScalarType(imageData->GetScalarType(), componentType))
+  {
+    return false;
+  }
+  header.ComponentType = static_cast<std::int32_t>(componentType);
+  header.NumberOfComponents = imageData->GetNumberOfScalarComponents();
+
+  int* dimensions = imageData->GetDimensions();
+  double* spacing = volumeNode->GetSpacing();
+  double* origin = volumeNode->GetOrigin();
+  double directions[3][3] = { { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  volumeNode->GetIJKToRASDirections(directions);
+  const double rasToLps[3] = { -1.0, -1.0, 1.0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    header.Size[axis] = static_cast<std::uint64_t>(dimensions[axis]);
+    header.Spacing[axis] = spacing[axis];
+    header.Origin[axis] = rasToLps[axis] * origin[axis];
+    for (int row = 0; row < 3; ++row)
+    {
+      header.Direction[axis * 3 + row] = rasToLps[row] * directions[row][axis];
+    }
+  }
+  header.DataSize = static_cast<std::uint64_t>(imageData->GetPointData()->GetScalars()->GetDataSize())
+    * imageData->GetScalarSize();
+
+  void* voxels = itk::SharedMemoryImageIO::CreateSegment(segmentName, header);
+  if (!voxels)
+  {
+    return false;
+  }
+  memcpy(voxels, imageData->GetScalarPointer(), static_cast<size_t>(header.DataSize));
+  itk::SharedMemoryImageIO::UnmapSegment(voxels, header);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Create image data that uses the voxels of a shared memory segment without copying them
+/// and get the IJK to RAS matrix of the image. The segment is mapped copy-on-write, therefore
+/// the image can be modified, and it is unmapped when the scalars of the image are deleted.
+vtkSmartPointer<vtkImageData> ImportImageFromSharedMemory(const std::string& segmentName, vtkMatrix4x4* ijkToRASMatrix)
+{
+  itk::SharedMemoryImageIO::HeaderType header;
+  void* voxels = itk::SharedMemoryImageIO::MapSegment(segmentName, header);
+  if (!voxels)
+  {
+    return nullptr;
+  }
+  int scalarType = GetVTKScalarTypeFromITKComponentType(static_cast<itk::IOComponentEnum>(header.ComponentType));
+  if (scalarType == VTK_VOID || header.NumberOfComponents == 0)
+  {
+    itk::SharedMemoryImageIO::ReleaseMappedSegment(voxels);
+    return nullptr;
+  }
+  vtkSmartPointer<vtkDataArray> scalars = vtk::TakeSmartPointer(vtkDataArray::CreateDataArray(scalarType));
+  scalars->SetNumberOfComponents(static_cast<int>(header.NumberOfComponents));
+  const std::uint64_t numberOfValues = header.Size[0] * header.Size[1] * header.Size[2] * header.NumberOfComponents;
+  if (numberOfValues * scalars->GetDataTypeSize() != header.DataSize)
+  {
+    itk::SharedMemoryImageIO::ReleaseMappedSegment(voxels);
+    return nullptr;
+  }
+  scalars->SetVoidArray(voxels, static_cast<vtkIdType>(numberOfValues), 0, vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+  scalars->SetArrayFreeFunction(&itk::SharedMemoryImageIO::ReleaseMappedSegment);
+
+  vtkSmartPointer<vtkImageData> imageData = vtkSmartPointer<vtkImageData>::New();
+  imageData->SetDimensions(static_cast<int>(header.Size[0]), static_cast<int>(header.Size[1]), static_cast<int>(header.Size[2]));
+  imageData->GetPointData()->SetScalars(scalars);
+
+  const double lpsToRas[3] = { -1.0, -1.0, 1.0 };
+  ijkToRASMatrix->Identity();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    ijkToRASMatrix->SetElement(axis, 3, lpsToRas[axis] * header.Origin[axis]);
+    for (int row = 0; row < 3; ++row)
+    {
+      ijkToRASMatrix->SetElement(row, axis, lpsToRas[row] * header.Direction[axis * 3 + row] * header.Spacing[axis]);
+    }
+  }
+  return imageData;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 struct DigitsToCharacters
 {
@@ -192,9 +349,13 @@ public:
   ModuleDescription DefaultModuleDescription;
   int DeleteTemporaryFiles;
   int AllowInMemoryTransfer;
+  int AllowSharedMemoryTransfer;
 
   int RedirectModuleStreams;
 
+  /// Counter used for generating unique shared memory segment names
+  std::atomic<unsigned int> SharedMemorySegmentCounter{ 0 };
+
   std::default_random_engine RandomGenerator;
 
   std::mutex ProcessesKillLock;
@@ -305,6 +466,7 @@ vtkSlicerCLIModuleLogic::vtkSlicerCLIModuleLogic()
 
   this->Internal->DeleteTemporaryFiles = 1;
   this->Internal->AllowInMemoryTransfer = 1;
+  this->Internal->AllowSharedMemoryTransfer = 0;
   this->Internal->RedirectModuleStreams = 1;
   this->Internal->RescheduleCallback =
     vtkSmartPointer<vtkSlicerCLIRescheduleCallback>::New();
@@ -408,6 +570,22 @@ int vtkSlicerCLIModuleLogic::GetAllowInMemoryTransfer() const
   return this->Internal->AllowInMemoryTransfer;
 }
 
+//----------------------------------------------------------------------------
+void vtkSlicerCLIModuleLogic::SetAllowSharedMemoryTransfer(int value)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting AllowSharedMemoryTransfer to " << value);
+  if (this->Internal->AllowSharedMemoryTransfer != value)
+  {
+    this->Internal->AllowSharedMemoryTransfer = value;
+  }
+}
+
+//----------------------------------------------------------------------------
+int vtkSlicerCLIModuleLogic::GetAllowSharedMemoryTransfer() const
+{
+  return this->Internal->AllowSharedMemoryTransfer;
+}
+
 //----------------------------------------------------------------------------
 void vtkSlicerCLIModuleLogic::RedirectModuleStreamsOn()
 {
@@ -907,6 +1085,16 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   // vector of files to delete
   std::set<std::string> filesToDelete;
 
+  // Volumes transferred to a command line executable through shared memory.
+  // Maps shared memory segment names to the temporary file names that are used
+  // if the volume cannot be transferred through shared memory.
+  std::map<std::string, std::string> sharedMemoryImages;
+  bool useSharedMemory = (commandType == CommandLineModule)
+    && this->GetAllowSharedMemoryTransfer() != 0
+    && itk::SharedMemoryImageIO::IsSupported()
+    && (node0->GetModuleDescription().GetLocation().empty()
+        || node0->GetModuleDescription().GetLocation() == node0->GetModuleDescription().GetTarget());
+
   // iterators for parameter groups
   std::vector<ModuleParameterGroup>::iterator pgbeginit
     = node0->GetModuleDescription().GetParameterGroups().begin();
@@ -957,6 +1145,25 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
                                              commandType);
 
         filesToDelete.insert(fname);
+
+        // Scalar and label volumes can be passed to command line executables
+        // through shared memory instead of a temporary file
+        vtkMRMLNode* imageNode = this->GetMRMLScene()->GetNodeByID(id.c_str());
+        if (useSharedMemory && (*pit).GetTag() == "image" && (*pit).GetType() != "dynamic-contrast-enhanced"
+          && (strcmp(imageNode->GetClassName(), "vtkMRMLScalarVolumeNode") == 0
+              || strcmp(imageNode->GetClassName(), "vtkMRMLLabelMapVolumeNode") == 0))
+        {
+          // Keep the name short, as some systems limit segment name length to 31 characters
+          std::ostringstream segmentName;
+#ifdef _WIN32
+          segmentName << "/slicer" << this->Internal->SharedMemorySegmentCounter++;
+#else
+          segmentName << "/slicer" << getpid() << "_" << this->Internal->SharedMemorySegmentCounter++;
+#endif
+          sharedMemoryImages[segmentName.str()] = fname;
+          fname = itk::SharedMemoryImageIO::GetFileNameFromSegmentName(segmentName.str());
+        }
+
         if ((*pit).GetChannel() == "input")
         {
           nodesToWrite[id] = fname;
@@ -1110,6 +1317,22 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
       this->AddCompleteModelHierarchyToMiniScene(miniscene.GetPointer(), mhnd, &sceneToMiniSceneMap, filesToDelete);
     }
 
+    // Write volume into shared memory. Use the temporary file if shared memory cannot be used.
+    if (itk::SharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second))
+    {
+      std::string segmentName = itk::SharedMemoryImageIO::GetSegmentNameFromFileName((*id2fn0).second);
+      if (WriteVolumeToSharedMemory(vtkMRMLScalarVolumeNode::SafeDownCast(nd), segmentName))
+      {
+        out = nullptr;
+      }
+      else
+      {
+        vtkWarningMacro("Failed to transfer " << nd->GetID() << " through shared memory, using a temporary file instead");
+        nodesToWrite[(*id2fn0).first] = sharedMemoryImages[segmentName];
+        sharedMemoryImages.erase(segmentName);
+      }
+    }
+
     // if the file is to be written, then write it
     if (out)
     {
@@ -2174,10 +2397,33 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
           displayData=false;
         }
 
-        bool deleteFile = this->GetDeleteTemporaryFiles();
-        vtkMTimeType requestUID = this->GetApplicationLogic()
-          ->RequestReadFile((*id2fn0).first.c_str(), (*id2fn0).second.c_str(),
-                            displayData, deleteFile);
+        vtkMTimeType requestUID = 0;
+        if (itk::SharedMemoryImageIO::IsSharedMemoryFileName((*id2fn0).second))
+        {
+          // The output image uses the voxels of the shared memory segment (without copying them)
+          // and it is handed over to the output node directly, no file is read.
+          std::string segmentName = itk::SharedMemoryImageIO::GetSegmentNameFromFileName((*id2fn0).second);
+          vtkNew<vtkMatrix4x4> ijkToRASMatrix;
+          vtkSmartPointer<vtkImageData> imageData = ImportImageFromSharedMemory(segmentName, ijkToRASMatrix);
+          if (imageData)
+          {
+            requestUID = this->GetApplicationLogic()
+              ->RequestSetVolumeImageData((*id2fn0).first, imageData, ijkToRASMatrix, displayData);
+          }
+          else
+          {
+            vtkErrorMacro("Failed to read output " << (*id2fn0).first << " from shared memory segment " << segmentName);
+          }
+          // The mapping remains valid after the segment name is removed
+          itk::SharedMemoryImageIO::RemoveSegment(segmentName);
+          sharedMemoryImages.erase(segmentName);
+        }
+        else
+        {
+          requestUID = this->GetApplicationLogic()
+            ->RequestReadFile((*id2fn0).first.c_str(), (*id2fn0).second.c_str(),
+                              displayData, this->GetDeleteTemporaryFiles());
+        }
         this->Internal->SetLastRequest(node0, requestUID);
 
         // If we are reloading a file, then we know that it is a file
@@ -2361,6 +2607,13 @@ void vtkSlicerCLIModuleLogic::ApplyTask(void *clientdata)
   //
   delete [] command;
 
+  // Release shared memory segments of inputs and of outputs that were not loaded.
+  // Memory is freed when the module has unmapped the segments, too.
+  for (const auto& sharedMemoryImage : sharedMemoryImages)
+  {
+    itk::SharedMemoryImageIO::RemoveSegment(sharedMemoryImage.first);
+  }
+
   // Remove any remaining temporary files.  At this point, these files
   // should be the files written as inputs to the module
   if ( this->GetDeleteTemporaryFiles() )
@@ -96,6 +96,13 @@ public:
   void SetAllowInMemoryTransfer(int value);
   int GetAllowInMemoryTransfer() const;
 
+  /// Control use of shared memory for transferring scalar and label volumes
+  /// to and from command line executables, instead of writing them to temporary files.
+  /// Disabled by default. Only supported on POSIX systems. Temporary files are used
+  /// if a volume cannot be transferred through shared memory.
+  void SetAllowSharedMemoryTransfer(int value);
+  int GetAllowSharedMemoryTransfer() const;
+
   /// For debugging, control redirection of cout and cerr
   virtual void RedirectModuleStreamsOn();
   virtual void RedirectModuleStreamsOff();
@@ -0,0 +1,213 @@
+// ITKFactoryRegistration includes
+#include <itkFactoryRegistration.h>
+#include <itkSharedMemoryImageIO.h>
+#include <itkSharedMemoryImportImageContainer.h>
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImageFileReader.h>
+#include <itkImageFileWriter.h>
+#include <itkImageRegionConstIterator.h>
+
+// STD includes
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <unistd.h>
+
+namespace
+{
+
+typedef itk::Image<short, 3> ImageType;
+
+//----------------------------------------------------------------------------
+ImageType::Pointer CreateImage()
+{
+  ImageType::Pointer image = ImageType::New();
+  ImageType::RegionType region;
+  region.SetSize(0, 7);
+  region.SetSize(1, 5);
+  region.SetSize(2, 3);
+  image->SetRegions(region);
+  ImageType::SpacingType spacing;
+  spacing[0] = 0.5;
+  spacing[1] = 1.5;
+  spacing[2] = 2.0;
+  image->SetSpacing(spacing);
+  ImageType::PointType origin;
+  origin[0] = -10.0;
+  origin[1] = 20.0;
+  origin[2] = 30.0;
+  image->SetOrigin(origin);
+  // rotation around the third axis
+  ImageType::DirectionType direction;
+  direction.SetIdentity();
+  direction[0][0] = 0.0;
+  direction[0][1] = -1.0;
+  direction[1][0] = 1.0;
+  direction[1][1] = 0.0;
+  image->SetDirection(direction);
+  image->Allocate();
+  short value = -100;
+  for (short* pixel = image->GetBufferPointer(); pixel != image->GetBufferPointer() + region.GetNumberOfPixels(); ++pixel)
+  {
+    *pixel = value;
+    value += 3;
+  }
+  return image;
+}
+
+//----------------------------------------------------------------------------
+bool IsSameImage(ImageType* image1, ImageType* image2)
+{
+  if (image1->GetLargestPossibleRegion() != image2->GetLargestPossibleRegion())
+  {
+    std::cerr << "Image regions are different: " << image1->GetLargestPossibleRegion()
+      << " != " << image2->GetLargestPossibleRegion() << std::endl;
+    return false;
+  }
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    if (std::abs(image1->GetSpacing()[axis] - image2->GetSpacing()[axis]) > 1e-9
+      || std::abs(image1->GetOrigin()[axis] - image2->GetOrigin()[axis]) > 1e-9)
+    {
+      std::cerr << "Image spacing or origin is different along axis " << axis << std::endl;
+      return false;
+    }
+    for (unsigned int row = 0; row < 3; ++row)
+    {
+      if (std::abs(image1->GetDirection()[row][axis] - image2->GetDirection()[row][axis]) > 1e-9)
+      {
+        std::cerr << "Image directions are different" << std::endl;
+        return false;
+      }
+    }
+  }
+  itk::ImageRegionConstIterator<ImageType> it1(image1, image1->GetLargestPossibleRegion());
+  itk::ImageRegionConstIterator<ImageType> it2(image2, image2->GetLargestPossibleRegion());
+  for (; !it1.IsAtEnd(); ++it1, ++it2)
+  {
+    if (it1.Get() != it2.Get())
+    {
+      std::cerr << "Voxel at " << it1.GetIndex() << " is different: " << it1.Get() << " != " << it2.Get() << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+ImageType::Pointer ReadImage(const std::string& fileName)
+{
+  typedef itk::ImageFileReader<ImageType> ReaderType;
+  ReaderType::Pointer reader = ReaderType::New();
+  reader->SetFileName(fileName);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject& err)
+  {
+    std::cerr << "Unable to read '" << fileName << "', err = \n" << err << std::endl;
+    return nullptr;
+  }
+  return reader->GetOutput();
+}
+
+} // end of anonymous namespace
+
+int main(int, char*[])
+{
+  itk::itkFactoryRegistration();
+
+  if (!itk::SharedMemoryImageIO::IsSupported())
+  {
+    std::cout << "Shared memory image segments are not supported on this system" << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  std::stringstream segmentName;
+  segmentName << "/itkSharedMemoryImageIOTest" << getpid();
+  const std::string fileName = itk::SharedMemoryImageIO::GetFileNameFromSegmentName(segmentName.str());
+  if (itk::SharedMemoryImageIO::GetSegmentNameFromFileName(fileName) != segmentName.str())
+  {
+    std::cerr << "Segment name is not recovered from file name " << fileName << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Write image through the ImageIO factory
+  ImageType::Pointer image = CreateImage();
+  typedef itk::ImageFileWriter<ImageType> WriterType;
+  WriterType::Pointer writer = WriterType::New();
+  writer->SetFileName(fileName);
+  writer->SetInput(image);
+  try
+  {
+    writer->Update();
+  }
+  catch (itk::ExceptionObject& err)
+  {
+    std::cerr << "Unable to write '" << fileName << "', err = \n" << err << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Read image through the ImageIO factory
+  ImageType::Pointer readImage = ReadImage(fileName);
+  if (!readImage || !IsSameImage(image, readImage))
+  {
+    itk::SharedMemoryImageIO::RemoveSegment(segmentName.str());
+    std::cerr << "Image read from shared memory is different from the written image" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Import image without copying the voxels
+  ImageType::Pointer importedImage = itk::ImportSharedMemoryImage<ImageType>(fileName);
+  if (!importedImage || !IsSameImage(image, importedImage))
+  {
+    itk::SharedMemoryImageIO::RemoveSegment(segmentName.str());
+    std::cerr << "Image imported from shared memory is different from the written image" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (itk::ImportSharedMemoryImage<itk::Image<float, 3>>(fileName))
+  {
+    itk::SharedMemoryImageIO::RemoveSegment(segmentName.str());
+    std::cerr << "Image with mismatching pixel type is imported" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Modifying the imported image does not modify the segment
+  importedImage->GetBufferPointer()[0] = 12345;
+  readImage = ReadImage(fileName);
+  if (!readImage || !IsSameImage(image, readImage))
+  {
+    itk::SharedMemoryImageIO::RemoveSegment(segmentName.str());
+    std::cerr << "Modifying the imported image modified the shared memory segment" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Imported voxels remain valid after the segment name is removed
+  if (!itk::SharedMemoryImageIO::RemoveSegment(segmentName.str()))
+  {
+    std::cerr << "Failed to remove segment " << segmentName.str() << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (importedImage->GetBufferPointer()[0] != 12345 || importedImage->GetBufferPointer()[1] != image->GetBufferPointer()[1])
+  {
+    std::cerr << "Imported voxels are invalid after the segment is removed" << std::endl;
+    return EXIT_FAILURE;
+  }
+  importedImage = nullptr;
+
+  // Removed segment cannot be read
+  itk::SharedMemoryImageIO::HeaderType header;
+  if (itk::SharedMemoryImageIO::OpenSegment(segmentName.str(), header) != nullptr)
+  {
+    std::cerr << "Removed segment can still be opened" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::cout << "Test passed" << std::endl;
+  return EXIT_SUCCESS;
+}
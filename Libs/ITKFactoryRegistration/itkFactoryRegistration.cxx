@@ -1,5 +1,6 @@
 
 #include "itkFactoryRegistration.h"
+#include "itkSharedMemoryImageIOFactory.h"
 
 // ITK includes
 #include <itkImageFileReader.h>
@@ -10,5 +11,12 @@
 // optimized out by the compiler.
 void itk::itkFactoryRegistration()
 {
-  return;
+  // Allow command line modules to exchange images with the application
+  // through shared memory (see vtkSlicerCLIModuleLogic).
+  static bool sharedMemoryImageIOFactoryRegistered = false;
+  if (!sharedMemoryImageIOFactoryRegistered && SharedMemoryImageIO::IsSupported())
+  {
+    SharedMemoryImageIOFactory::RegisterOneFactory();
+    sharedMemoryImageIOFactoryRegistered = true;
+  }
 }
@@ -0,0 +1,352 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkSharedMemoryImageIO.h"
+
+// STD includes
+#include <cstring>
+#include <map>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+const char SharedMemoryFileNamePrefix[] = "slicershm:";
+const char SharedMemoryMagic[8] = { 'S', 'L', 'C', 'R', 'S', 'H', 'M', '\0' };
+const std::uint32_t SharedMemoryVersion = 1;
+
+/// Address and size of segments mapped by MapSegment, indexed by the address of their voxels.
+/// Required for unmapping segments when only the voxel address is known.
+std::mutex MappedSegmentsMutex;
+std::map<void*, std::pair<void*, size_t>> MappedSegments;
+
+//----------------------------------------------------------------------------
+/// Map a segment into memory, copy its header, and return the address of the segment.
+/// If copyOnWrite is enabled then the mapping is private and writable.
+void* MapSegmentInternal(const std::string& segmentName, itk::SharedMemoryImageIO::HeaderType& header, bool copyOnWrite)
+{
+#ifdef _WIN32
+  (void)segmentName;
+  (void)header;
+  (void)copyOnWrite;
+  return nullptr;
+#else
+  int fileDescriptor = shm_open(segmentName.c_str(), O_RDONLY, 0);
+  if (fileDescriptor < 0)
+  {
+    return nullptr;
+  }
+  struct stat segmentStat;
+  if (fstat(fileDescriptor, &segmentStat) != 0
+    || static_cast<size_t>(segmentStat.st_size) < sizeof(itk::SharedMemoryImageIO::HeaderType))
+  {
+    close(fileDescriptor);
+    return nullptr;
+  }
+  const size_t segmentSize = static_cast<size_t>(segmentStat.st_size);
+  void* segment = copyOnWrite
+    ? mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, 0)
+    : mmap(nullptr, segmentSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (segment == MAP_FAILED)
+  {
+    return nullptr;
+  }
+  memcpy(&header, segment, sizeof(itk::SharedMemoryImageIO::HeaderType));
+  if (memcmp(header.Magic, SharedMemoryMagic, sizeof(header.Magic)) != 0
+    || header.Version != SharedMemoryVersion
+    || header.HeaderSize < sizeof(itk::SharedMemoryImageIO::HeaderType)
+    || header.HeaderSize + header.DataSize != segmentSize)
+  {
+    munmap(segment, segmentSize);
+    return nullptr;
+  }
+  return segment;
+#endif
+}
+}
+
+namespace itk
+{
+
+//----------------------------------------------------------------------------
+SharedMemoryImageIO::SharedMemoryImageIO()
+{
+  this->SetNumberOfDimensions(3);
+}
+
+//----------------------------------------------------------------------------
+SharedMemoryImageIO::~SharedMemoryImageIO() = default;
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::PrintSelf(std::ostream& os, Indent indent) const
+{
+  Superclass::PrintSelf(os, indent);
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::IsSupported()
+{
+#ifdef _WIN32
+  return false;
+#else
+  return true;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::IsSharedMemoryFileName(const std::string& fileName)
+{
+  return fileName.compare(0, sizeof(SharedMemoryFileNamePrefix) - 1, SharedMemoryFileNamePrefix) == 0;
+}
+
+//----------------------------------------------------------------------------
+std::string SharedMemoryImageIO::GetFileNameFromSegmentName(const std::string& segmentName)
+{
+  return SharedMemoryFileNamePrefix + segmentName;
+}
+
+//----------------------------------------------------------------------------
+std::string SharedMemoryImageIO::GetSegmentNameFromFileName(const std::string& fileName)
+{
+  if (!IsSharedMemoryFileName(fileName))
+  {
+    return std::string();
+  }
+  return fileName.substr(sizeof(SharedMemoryFileNamePrefix) - 1);
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::InitializeHeader(HeaderType& header)
+{
+  memset(&header, 0, sizeof(header));
+  memcpy(header.Magic, SharedMemoryMagic, sizeof(header.Magic));
+  header.Version = SharedMemoryVersion;
+  header.HeaderSize = sizeof(HeaderType);
+  header.NumberOfComponents = 1;
+  header.ComponentType = static_cast<std::int32_t>(IOComponentEnum::UCHAR);
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    header.Spacing[axis] = 1.0;
+    header.Direction[axis * 3 + axis] = 1.0;
+  }
+}
+
+//----------------------------------------------------------------------------
+void* SharedMemoryImageIO::CreateSegment(const std::string& segmentName, const HeaderType& header)
+{
+#ifdef _WIN32
+  (void)segmentName;
+  (void)header;
+  return nullptr;
+#else
+  const size_t segmentSize = header.HeaderSize + header.DataSize;
+  int fileDescriptor = shm_open(segmentName.c_str(), O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+  if (fileDescriptor < 0)
+  {
+    return nullptr;
+  }
+  if (ftruncate(fileDescriptor, static_cast<off_t>(segmentSize)) != 0)
+  {
+    close(fileDescriptor);
+    shm_unlink(segmentName.c_str());
+    return nullptr;
+  }
+  void* segment = mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+  close(fileDescriptor);
+  if (segment == MAP_FAILED)
+  {
+    shm_unlink(segmentName.c_str());
+    return nullptr;
+  }
+  memcpy(segment, &header, sizeof(HeaderType));
+  return static_cast<char*>(segment) + header.HeaderSize;
+#endif
+}
+
+//----------------------------------------------------------------------------
+const void* SharedMemoryImageIO::OpenSegment(const std::string& segmentName, HeaderType& header)
+{
+  const char* segment = static_cast<const char*>(MapSegmentInternal(segmentName, header, false));
+  return segment ? segment + header.HeaderSize : nullptr;
+}
+
+//----------------------------------------------------------------------------
+void* SharedMemoryImageIO::MapSegment(const std::string& segmentName, HeaderType& header)
+{
+  char* segment = static_cast<char*>(MapSegmentInternal(segmentName, header, true));
+  if (!segment)
+  {
+    return nullptr;
+  }
+  void* voxels = segment + header.HeaderSize;
+  std::lock_guard<std::mutex> lock(MappedSegmentsMutex);
+  MappedSegments[voxels] = std::make_pair(static_cast<void*>(segment), static_cast<size_t>(header.HeaderSize + header.DataSize));
+  return voxels;
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::UnmapSegment(const void* voxels, const HeaderType& header)
+{
+#ifdef _WIN32
+  (void)voxels;
+  (void)header;
+#else
+  if (!voxels)
+  {
+    return;
+  }
+  void* segment = const_cast<char*>(static_cast<const char*>(voxels) - header.HeaderSize);
+  munmap(segment, header.HeaderSize + header.DataSize);
+#endif
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::ReleaseMappedSegment(void* voxels)
+{
+#ifdef _WIN32
+  (void)voxels;
+#else
+  if (!voxels)
+  {
+    return;
+  }
+  std::pair<void*, size_t> segment;
+  {
+    std::lock_guard<std::mutex> lock(MappedSegmentsMutex);
+    auto mappedSegmentIt = MappedSegments.find(voxels);
+    if (mappedSegmentIt == MappedSegments.end())
+    {
+      return;
+    }
+    segment = mappedSegmentIt->second;
+    MappedSegments.erase(mappedSegmentIt);
+  }
+  munmap(segment.first, segment.second);
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::RemoveSegment(const std::string& segmentName)
+{
+#ifdef _WIN32
+  (void)segmentName;
+  return false;
+#else
+  return shm_unlink(segmentName.c_str()) == 0;
+#endif
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::CanReadFile(const char* fileName)
+{
+  return fileName && IsSupported() && IsSharedMemoryFileName(fileName);
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::ReadImageInformation()
+{
+  std::string segmentName = GetSegmentNameFromFileName(m_FileName);
+  HeaderType header;
+  const void* voxels = OpenSegment(segmentName, header);
+  if (!voxels)
+  {
+    itkExceptionMacro("Cannot open shared memory image segment: " << segmentName);
+  }
+  UnmapSegment(voxels, header);
+
+  this->SetNumberOfDimensions(3);
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    this->SetDimensions(axis, static_cast<SizeValueType>(header.Size[axis]));
+    this->SetSpacing(axis, header.Spacing[axis]);
+    this->SetOrigin(axis, header.Origin[axis]);
+    std::vector<double> direction(header.Direction + axis * 3, header.Direction + axis * 3 + 3);
+    this->SetDirection(axis, direction);
+  }
+  this->SetNumberOfComponents(header.NumberOfComponents);
+  this->SetPixelType(header.NumberOfComponents == 1 ? IOPixelEnum::SCALAR : IOPixelEnum::VECTOR);
+  this->SetComponentType(static_cast<IOComponentEnum>(header.ComponentType));
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::Read(void* buffer)
+{
+  std::string segmentName = GetSegmentNameFromFileName(m_FileName);
+  HeaderType header;
+  const void* voxels = OpenSegment(segmentName, header);
+  if (!voxels)
+  {
+    itkExceptionMacro("Cannot open shared memory image segment: " << segmentName);
+  }
+  const SizeType bufferSize = this->GetImageSizeInBytes();
+  if (bufferSize != header.DataSize)
+  {
+    UnmapSegment(voxels, header);
+    itkExceptionMacro("Shared memory image segment " << segmentName << " size (" << header.DataSize
+      << " bytes) does not match the requested image size (" << bufferSize << " bytes)");
+  }
+  memcpy(buffer, voxels, static_cast<size_t>(bufferSize));
+  UnmapSegment(voxels, header);
+}
+
+//----------------------------------------------------------------------------
+bool SharedMemoryImageIO::CanWriteFile(const char* fileName)
+{
+  return fileName && IsSupported() && IsSharedMemoryFileName(fileName);
+}
+
+//----------------------------------------------------------------------------
+void SharedMemoryImageIO::Write(const void* buffer)
+{
+  std::string segmentName = GetSegmentNameFromFileName(m_FileName);
+  if (this->GetNumberOfDimensions() > 3)
+  {
+    itkExceptionMacro("Shared memory image segments can store up to 3D images");
+  }
+
+  HeaderType header;
+  InitializeHeader(header);
+  header.NumberOfComponents = this->GetNumberOfComponents();
+  header.ComponentType = static_cast<std::int32_t>(this->GetComponentType());
+  for (unsigned int axis = 0; axis < this->GetNumberOfDimensions(); ++axis)
+  {
+    header.Size[axis] = this->GetDimensions(axis);
+    header.Spacing[axis] = this->GetSpacing(axis);
+    header.Origin[axis] = this->GetOrigin(axis);
+    std::vector<double> direction = this->GetDirection(axis);
+    for (unsigned int row = 0; row < 3 && row < direction.size(); ++row)
+    {
+      header.Direction[axis * 3 + row] = direction[row];
+    }
+  }
+  for (unsigned int axis = this->GetNumberOfDimensions(); axis < 3; ++axis)
+  {
+    header.Size[axis] = 1;
+  }
+  header.DataSize = this->GetImageSizeInBytes();
+
+  // Replace any segment that was left behind by a previous write
+  RemoveSegment(segmentName);
+  void* voxels = CreateSegment(segmentName, header);
+  if (!voxels)
+  {
+    itkExceptionMacro("Cannot create shared memory image segment: " << segmentName);
+  }
+  memcpy(voxels, buffer, static_cast<size_t>(header.DataSize));
+  UnmapSegment(voxels, header);
+}
+
+} // end namespace itk
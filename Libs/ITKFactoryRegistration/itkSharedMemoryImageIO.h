@@ -0,0 +1,149 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImageIO_h
+#define itkSharedMemoryImageIO_h
+
+#include "itkFactoryRegistrationConfigure.h"
+
+// ITK includes
+#include <itkImageIOBase.h>
+
+// STD includes
+#include <cstdint>
+#include <string>
+
+namespace itk
+{
+/** \class SharedMemoryImageIO
+ * \brief ImageIO object for exchanging images through named shared memory segments
+ *
+ * SharedMemoryImageIO allows an application and a command line module that runs
+ * in a separate process to exchange images without writing them to disk.
+ * The application publishes the image in a named shared memory segment and passes
+ * the segment name to the command line module as file name. The standard ITK
+ * ImageFileReader and ImageFileWriter in the module then use this ImageIO object
+ * to read the image from (or write it to) the segment.
+ *
+ * The "filename" specified will look like:
+ *     <code>slicershm:\<segment name\></code>
+ *
+ * A segment contains a SharedMemoryImageIO::HeaderType structure, followed
+ * by the voxel data. Geometry is stored in LPS coordinate system.
+ *
+ * Shared memory segments are only supported on POSIX systems (see IsSupported()).
+ */
+class ITKFactoryRegistration_EXPORT SharedMemoryImageIO : public ImageIOBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIO Self;
+  typedef ImageIOBase         Superclass;
+  typedef SmartPointer<Self>  Pointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIO, ImageIOBase);
+
+  /** Layout of the beginning of a shared memory segment. Voxel data starts at HeaderSize. */
+  struct HeaderType
+  {
+    char Magic[8];
+    std::uint32_t Version;
+    std::uint32_t HeaderSize;
+    std::uint32_t NumberOfComponents;
+    /** Value of itk::IOComponentEnum */
+    std::int32_t ComponentType;
+    std::uint64_t Size[3];
+    double Spacing[3];
+    double Origin[3];
+    /** Direction of axis i is stored in Direction[i*3] ... Direction[i*3+2] */
+    double Direction[9];
+    std::uint64_t DataSize;
+  };
+
+  /** Returns true if shared memory segments can be used on this system. */
+  static bool IsSupported();
+
+  /** Returns true if the file name refers to a shared memory segment. */
+  static bool IsSharedMemoryFileName(const std::string& fileName);
+
+  /** Get file name that refers to a shared memory segment. */
+  static std::string GetFileNameFromSegmentName(const std::string& segmentName);
+
+  /** Get segment name from a file name. Returns empty string if the file name does not refer to a segment. */
+  static std::string GetSegmentNameFromFileName(const std::string& fileName);
+
+  /** Initialize the header with default values (single-component 1x1x1 unsigned char image). */
+  static void InitializeHeader(HeaderType& header);
+
+  /** Create a new segment that can hold an image described by the header,
+   * copy the header into it, and return the address of the voxel data.
+   * The segment must be unmapped by calling UnmapSegment.
+   * Returns nullptr if the segment cannot be created (for example, a segment already exists with this name). */
+  static void* CreateSegment(const std::string& segmentName, const HeaderType& header);
+
+  /** Map an existing segment into memory, copy its header, and return the address of the voxel data.
+   * The segment must be unmapped by calling UnmapSegment.
+   * Returns nullptr if the segment does not exist or it does not contain a valid image. */
+  static const void* OpenSegment(const std::string& segmentName, HeaderType& header);
+
+  /** Map an existing segment into memory copy-on-write, copy its header, and return the address of the voxel data.
+   * Voxels can be modified through the returned pointer without changing the segment
+   * (modified pages are copied), therefore the voxels can be used as the buffer of an image
+   * without copying them. The segment must be unmapped by calling ReleaseMappedSegment.
+   * Returns nullptr if the segment does not exist or it does not contain a valid image. */
+  static void* MapSegment(const std::string& segmentName, HeaderType& header);
+
+  /** Unmap a segment returned by CreateSegment or OpenSegment. */
+  static void UnmapSegment(const void* voxels, const HeaderType& header);
+
+  /** Unmap a segment returned by MapSegment. The signature allows using it as the free function
+   * of arrays that import the voxels. */
+  static void ReleaseMappedSegment(void* voxels);
+
+  /** Remove the segment name. Memory is released when all processes have unmapped the segment. */
+  static bool RemoveSegment(const std::string& segmentName);
+
+  /** Determine the file type. Returns true if this ImageIO can read the
+   * file specified. */
+  bool CanReadFile(const char*) override;
+
+  /** Set the spacing and dimension information for the set filename. */
+  void ReadImageInformation() override;
+
+  /** Reads the data from the segment into the memory buffer provided. */
+  void Read(void* buffer) override;
+
+  /*-------- This part of the interfaces deals with writing data. ----- */
+
+  /** Determine the file type. Returns true if this ImageIO can write the
+   * file specified. */
+  bool CanWriteFile(const char*) override;
+
+  /** Image information is written along with the voxels. */
+  void WriteImageInformation() override {}
+
+  /** Writes the data to a new segment from the memory buffer provided. */
+  void Write(const void* buffer) override;
+
+protected:
+  SharedMemoryImageIO();
+  ~SharedMemoryImageIO() override;
+  void PrintSelf(std::ostream& os, Indent indent) const override;
+
+private:
+  SharedMemoryImageIO(const Self&) = delete;
+  void operator=(const Self&) = delete;
+};
+
+} /// end namespace itk
+#endif
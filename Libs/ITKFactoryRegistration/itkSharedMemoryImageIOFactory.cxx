@@ -0,0 +1,37 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#include "itkSharedMemoryImageIOFactory.h"
+#include "itkVersion.h"
+
+namespace itk
+{
+SharedMemoryImageIOFactory::SharedMemoryImageIOFactory()
+{
+  this->RegisterOverride("itkImageIOBase",
+                         "itkSharedMemoryImageIO",
+                         "ImageIO to exchange images through shared memory.",
+                         true,
+                         CreateObjectFunction<SharedMemoryImageIO>::New());
+}
+
+SharedMemoryImageIOFactory::~SharedMemoryImageIOFactory() = default;
+
+const char* SharedMemoryImageIOFactory::GetITKSourceVersion() const
+{
+  return ITK_SOURCE_VERSION;
+}
+
+const char*
+SharedMemoryImageIOFactory::GetDescription() const
+{
+  return "ImageIOFactory that imports/exports images through named shared memory segments.";
+}
+
+} // end namespace itk
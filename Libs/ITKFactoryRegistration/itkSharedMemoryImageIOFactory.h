@@ -0,0 +1,62 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImageIOFactory_h
+#define itkSharedMemoryImageIOFactory_h
+
+#include "itkObjectFactoryBase.h"
+#include "itkImageIOBase.h"
+
+#include "itkSharedMemoryImageIO.h"
+
+namespace itk
+{
+/** \class SharedMemoryImageIOFactory
+ * \brief Create instances of SharedMemoryImageIO objects using an object factory.
+ */
+class ITKFactoryRegistration_EXPORT SharedMemoryImageIOFactory : public ObjectFactoryBase
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImageIOFactory Self;
+  typedef ObjectFactoryBase          Superclass;
+  typedef SmartPointer<Self>         Pointer;
+  typedef SmartPointer<const Self>   ConstPointer;
+
+  /** Class methods used to interface with the registered factories. */
+  const char* GetITKSourceVersion() const override;
+  const char* GetDescription() const override;
+
+  /** Method for class instantiation. */
+  itkFactorylessNewMacro(Self);
+  static SharedMemoryImageIOFactory* FactoryNew() { return new SharedMemoryImageIOFactory;}
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImageIOFactory, ObjectFactoryBase);
+
+  /** Register one factory of this type  */
+  static void RegisterOneFactory()
+  {
+    SharedMemoryImageIOFactory::Pointer sharedMemoryFactory = SharedMemoryImageIOFactory::New();
+    ObjectFactoryBase::RegisterFactory(sharedMemoryFactory);
+  }
+
+protected:
+  SharedMemoryImageIOFactory();
+  ~SharedMemoryImageIOFactory() override;
+
+private:
+  SharedMemoryImageIOFactory(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+};
+
+} /// end namespace itk
+
+#endif
@@ -0,0 +1,142 @@
+/*=auto=========================================================================
+
+  Portions (c) Copyright 2005 Brigham and Women's Hospital (BWH) All Rights Reserved.
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+=========================================================================auto=*/
+
+#ifndef itkSharedMemoryImportImageContainer_h
+#define itkSharedMemoryImportImageContainer_h
+
+#include "itkSharedMemoryImageIO.h"
+
+// ITK includes
+#include <itkImage.h>
+#include <itkImportImageContainer.h>
+
+namespace itk
+{
+/** \class SharedMemoryImportImageContainer
+ * \brief Pixel container that uses the voxels of a shared memory segment without copying them
+ *
+ * The segment is mapped copy-on-write (see SharedMemoryImageIO::MapSegment), therefore
+ * the pixels can be modified without changing the segment. The container does not manage
+ * the imported memory, the segment is unmapped when the container is deleted.
+ *
+ * \sa ImportSharedMemoryImage()
+ */
+template <typename TElementIdentifier, typename TElement>
+class SharedMemoryImportImageContainer : public ImportImageContainer<TElementIdentifier, TElement>
+{
+public:
+  /** Standard class typedefs. */
+  typedef SharedMemoryImportImageContainer                   Self;
+  typedef ImportImageContainer<TElementIdentifier, TElement> Superclass;
+  typedef SmartPointer<Self>                                 Pointer;
+  typedef SmartPointer<const Self>                           ConstPointer;
+
+  /** Method for creation through the object factory. */
+  itkNewMacro(Self);
+
+  /** Run-time type information (and related methods). */
+  itkTypeMacro(SharedMemoryImportImageContainer, ImportImageContainer);
+
+  /** Map the voxels of a segment into the container and copy the segment header.
+   * Returns false if the segment does not exist or its data size is not a multiple of the element size. */
+  bool MapSegment(const std::string& segmentName, SharedMemoryImageIO::HeaderType& header)
+  {
+    this->ReleaseSegment();
+    void* voxels = SharedMemoryImageIO::MapSegment(segmentName, header);
+    if (!voxels)
+    {
+      return false;
+    }
+    if (header.DataSize % sizeof(TElement) != 0)
+    {
+      SharedMemoryImageIO::ReleaseMappedSegment(voxels);
+      return false;
+    }
+    this->SetImportPointer(static_cast<TElement*>(voxels),
+      static_cast<TElementIdentifier>(header.DataSize / sizeof(TElement)), false);
+    this->m_MappedVoxels = voxels;
+    return true;
+  }
+
+protected:
+  SharedMemoryImportImageContainer() = default;
+  ~SharedMemoryImportImageContainer() override
+  {
+    this->ReleaseSegment();
+  }
+
+  void ReleaseSegment()
+  {
+    if (!this->m_MappedVoxels)
+    {
+      return;
+    }
+    if (this->GetImportPointer() == this->m_MappedVoxels)
+    {
+      this->SetImportPointer(nullptr, 0, false);
+    }
+    SharedMemoryImageIO::ReleaseMappedSegment(this->m_MappedVoxels);
+    this->m_MappedVoxels = nullptr;
+  }
+
+private:
+  SharedMemoryImportImageContainer(const Self&) = delete;
+  void operator=(const Self&) = delete;
+
+  void* m_MappedVoxels{ nullptr };
+};
+
+/** Create a 3D scalar image that uses the voxels of a shared memory segment without copying them.
+ * The file name must be a shared memory file name (see SharedMemoryImageIO::GetFileNameFromSegmentName).
+ * Returns nullptr if the segment does not exist or its component type does not match the pixel type of the image. */
+template <typename TImage>
+typename TImage::Pointer ImportSharedMemoryImage(const std::string& fileName)
+{
+  static_assert(TImage::ImageDimension == 3, "Shared memory image segments store 3D images");
+  typedef typename TImage::PixelType PixelType;
+  typedef SharedMemoryImportImageContainer<SizeValueType, PixelType> ContainerType;
+
+  typename ContainerType::Pointer container = ContainerType::New();
+  SharedMemoryImageIO::HeaderType header;
+  if (!container->MapSegment(SharedMemoryImageIO::GetSegmentNameFromFileName(fileName), header))
+  {
+    return nullptr;
+  }
+  if (header.NumberOfComponents != 1
+    || static_cast<IOComponentEnum>(header.ComponentType) != ImageIOBase::MapPixelType<PixelType>::CType
+    || header.DataSize != header.Size[0] * header.Size[1] * header.Size[2] * sizeof(PixelType))
+  {
+    return nullptr;
+  }
+
+  typename TImage::Pointer image = TImage::New();
+  typename TImage::RegionType region;
+  typename TImage::SpacingType spacing;
+  typename TImage::PointType origin;
+  typename TImage::DirectionType direction;
+  for (unsigned int axis = 0; axis < 3; ++axis)
+  {
+    region.SetSize(axis, static_cast<SizeValueType>(header.Size[axis]));
+    spacing[axis] = header.Spacing[axis];
+    origin[axis] = header.Origin[axis];
+    for (unsigned int row = 0; row < 3; ++row)
+    {
+      direction[row][axis] = header.Direction[axis * 3 + row];
+    }
+  }
+  image->SetRegions(region);
+  image->SetSpacing(spacing);
+  image->SetOrigin(origin);
+  image->SetDirection(direction);
+  image->SetPixelContainer(container);
+  return image;
+}
+
+} /// end namespace itk
+#endif
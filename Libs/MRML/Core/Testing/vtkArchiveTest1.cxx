@@ -14,6 +14,7 @@
 #include "vtkArchive.h"
 
 // VTK includes
+#include <vtkNew.h>
 
 // VTKSYS includes
 #include <vtksys/SystemTools.hxx>
@@ -21,6 +22,8 @@
 
 
 // STD includes
+#include <cstring>
+#include <string>
 
 #include "vtkMRMLCoreTestingMacros.h"
 
@@ -166,6 +169,62 @@ int vtkArchiveTest1(int argc, char * argv[] )
     std::cerr << "failed to extract archive : " << "extractedArchiveTest" << std::endl;
     return EXIT_FAILURE;
   }
+  vtksys::SystemTools::ChangeDirectory("..");
+
+  //
+  // Create a zip file by streaming entries into it and check that it extracts
+  // the same files as the zip file created from the directory
+  //
+  std::cout << "creating archiveTestStreamed.zip" << std::endl;
+  std::string streamedZipFilePath = vtksys::SystemTools::GetCurrentWorkingDirectory() +
+                                                    std::string("/archiveTestStreamed.zip");
+  const char* extractedFileNames[] = { "vol.mrml", "vol_and_cube.mrml" };
+  {
+    vtkNew<vtkArchive> archive;
+    res = archive->OpenZip(streamedZipFilePath.c_str())
+      && archive->AddZipDirectoryEntry("archiveTest/")
+      && archive->AddZipFileEntry("archiveTest/vol.mrml", (zipDirPath + "/vol.mrml").c_str())
+      && archive->AddZipFileEntry("archiveTest/vol_and_cube.mrml", (zipDirPath + "/vol_and_cube.mrml").c_str(), false);
+    const char text[] = "streamed text";
+    res = res && archive->AddZipDataEntry("archiveTest/text.txt", text, strlen(text));
+    res = archive->CloseZip() && res;
+  }
+  if (!res)
+  {
+    std::cerr << "failed to create new archive by streaming entries" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if ( vtksys::SystemTools::FileExists("extractedStreamedArchiveTest") )
+  {
+    vtksys::SystemTools::RemoveADirectory("extractedStreamedArchiveTest");
+  }
+  vtksys::SystemTools::MakeDirectory("extractedStreamedArchiveTest");
+  res = vtkArchive::UnZip(streamedZipFilePath.c_str(), "extractedStreamedArchiveTest");
+  if (!res)
+  {
+    std::cerr << "failed to extract archive created by streaming entries" << std::endl;
+    return EXIT_FAILURE;
+  }
+  for (const char* extractedFileName : extractedFileNames)
+  {
+    std::string expectedFile = std::string("extractedArchiveTest/archiveTest/") + extractedFileName;
+    std::string streamedFile = std::string("extractedStreamedArchiveTest/archiveTest/") + extractedFileName;
+    if (!vtksys::SystemTools::FileExists(streamedFile, true)
+      || vtksys::SystemTools::FilesDiffer(expectedFile, streamedFile))
+    {
+      std::cerr << "file extracted from archive created by streaming entries differs: " << streamedFile << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Entries can be read into memory
+  std::string content;
+  if (!vtkArchive::ReadZipEntry(streamedZipFilePath.c_str(), "archiveTest/text.txt", content)
+    || content != "streamed text")
+  {
+    std::cerr << "failed to read entry of archive into memory" << std::endl;
+    return EXIT_FAILURE;
+  }
 
   return EXIT_SUCCESS;
 }
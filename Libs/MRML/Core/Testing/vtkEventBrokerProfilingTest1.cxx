@@ -0,0 +1,138 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkEventBroker.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLTextNode.h"
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkNew.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <fstream>
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Modify the text node when the model node is modified, which triggers a nested event
+void ModelModifiedCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* clientData, void* vtkNotUsed(callData))
+{
+  vtkMRMLTextNode* textNode = reinterpret_cast<vtkMRMLTextNode*>(clientData);
+  textNode->SetText(textNode->GetText() + "x");
+}
+
+//-----------------------------------------------------------------------------
+void TextModifiedCallback(vtkObject* vtkNotUsed(caller), unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkEventBrokerProfilingTest1(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: vtkEventBrokerProfilingTest1 /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtkEventBroker* broker = vtkEventBroker::GetInstance();
+  CHECK_BOOL(broker->GetEventProfiling(), false);
+
+  vtkNew<vtkMRMLModelNode> modelNode;
+  vtkNew<vtkMRMLTextNode> textNode;
+  vtkNew<vtkMRMLTextNode> modelObserver;
+  vtkNew<vtkMRMLModelNode> textObserver;
+  vtkNew<vtkCallbackCommand> modelCallback;
+  modelCallback->SetCallback(ModelModifiedCallback);
+  modelCallback->SetClientData(textNode);
+  vtkNew<vtkCallbackCommand> textCallback;
+  textCallback->SetCallback(TextModifiedCallback);
+  broker->AddObservation(modelNode, vtkCommand::ModifiedEvent, modelObserver, modelCallback);
+  broker->AddObservation(textNode, vtkCommand::ModifiedEvent, textObserver, textCallback);
+
+  // Nothing is recorded while profiling is disabled
+  modelNode->Modified();
+  CHECK_INT(broker->GetNumberOfProfiledObservations(), 0);
+
+  broker->EventProfilingOn();
+  const int numberOfModifications = 5;
+  for (int i = 0; i < numberOfModifications; ++i)
+  {
+    modelNode->Modified();
+  }
+  broker->EventProfilingOff();
+  modelNode->Modified();
+
+  CHECK_INT(broker->GetNumberOfProfiledObservations(), 2);
+  for (int n = 0; n < broker->GetNumberOfProfiledObservations(); ++n)
+  {
+    CHECK_INT(broker->GetProfiledEvent(n), vtkCommand::ModifiedEvent);
+    CHECK_INT(broker->GetProfiledInvocationCount(n), numberOfModifications);
+    CHECK_BOOL(broker->GetProfiledSelfTime(n) <= broker->GetProfiledTotalTime(n) + 1e-9, true);
+    if (broker->GetProfiledSubjectClassName(n) == "vtkMRMLModelNode")
+    {
+      CHECK_STD_STRING(broker->GetProfiledObserverName(n), "vtkMRMLTextNode");
+      CHECK_INT(broker->GetProfiledMaximumNestingLevel(n), 1);
+    }
+    else
+    {
+      // Text node is modified from within the model node observation
+      CHECK_STD_STRING(broker->GetProfiledSubjectClassName(n), "vtkMRMLTextNode");
+      CHECK_STD_STRING(broker->GetProfiledObserverName(n), "vtkMRMLModelNode");
+      CHECK_INT(broker->GetProfiledMaximumNestingLevel(n), 2);
+    }
+  }
+  broker->PrintEventProfile(std::cout);
+
+  // Check that observation chains are written in folded stacks format
+  std::string flameGraphFileName = std::string(argv[1]) + "/vtkEventBrokerProfilingTest1.folded";
+  CHECK_BOOL(broker->WriteEventProfileFlameGraph(flameGraphFileName.c_str()), true);
+  std::ifstream flameGraphFile(flameGraphFileName.c_str());
+  std::string line;
+  bool nestedStackFound = false;
+  while (std::getline(flameGraphFile, line))
+  {
+    std::cout << line << std::endl;
+    if (line.find("vtkMRMLModelNode:ModifiedEvent -> vtkMRMLTextNode;vtkMRMLTextNode:ModifiedEvent -> vtkMRMLModelNode ") == 0)
+    {
+      nestedStackFound = true;
+    }
+  }
+  flameGraphFile.close();
+  vtksys::SystemTools::RemoveFile(flameGraphFileName);
+  // Self time may be rounded to 0 microseconds on fast computers, in that case the stack is not written
+  if (!nestedStackFound)
+  {
+    std::cout << "Nested observation stack was not written (observation took less than 1 microsecond)" << std::endl;
+  }
+
+  broker->ResetEventProfile();
+  CHECK_INT(broker->GetNumberOfProfiledObservations(), 0);
+  CHECK_INT(broker->GetProfiledInvocationCount(0), 0);
+
+  broker->RemoveObservations(modelObserver);
+  broker->RemoveObservations(textObserver);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,142 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkOrientedGridTransform.h>
+
+// STD includes
+#include <cmath>
+
+//----------------------------------------------------------------------------
+// Test computation and caching of the precomputed inverse of a grid transform
+int vtkMRMLGridTransformNodeTest2(int , char * [] )
+{
+  // Smooth displacement field
+  vtkNew<vtkImageData> displacementField;
+  displacementField->SetOrigin(-50.0, -50.0, -50.0);
+  displacementField->SetSpacing(10.0, 10.0, 10.0);
+  displacementField->SetDimensions(11, 11, 11);
+  displacementField->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacements = static_cast<double*>(displacementField->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < displacementField->GetNumberOfPoints(); ++pointIndex)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    displacementField->GetPoint(pointIndex, point);
+    displacements[pointIndex * 3 + 0] = 2.0 * sin(point[1] / 20.0);
+    displacements[pointIndex * 3 + 1] = 1.5 * cos(point[2] / 25.0);
+    displacements[pointIndex * 3 + 2] = 1.0 * sin(point[0] / 15.0);
+  }
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacementField);
+  gridTransform->SetInterpolationModeToCubic();
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLGridTransformNode> transformNode;
+  scene->AddNode(transformNode);
+  transformNode->SetAndObserveTransformFromParent(gridTransform);
+
+  // Precomputed inverse is disabled by default, transform to parent is computed by iterative inversion
+  CHECK_BOOL(transformNode->GetPrecomputedInverse(), false);
+  vtkAbstractTransform* iterativeInverseTransform = transformNode->GetTransformToParent();
+  CHECK_POINTER(iterativeInverseTransform, gridTransform->GetInverse());
+  CHECK_POINTER(transformNode->GetTransformToParentForEvaluation(), iterativeInverseTransform);
+  CHECK_NULL(transformNode->GetPrecomputedInverseConvergenceMask());
+
+  transformNode->PrecomputedInverseOn();
+  vtkOrientedGridTransform* precomputedInverseTransform =
+    vtkOrientedGridTransform::SafeDownCast(transformNode->GetTransformToParentForEvaluation());
+  CHECK_NOT_NULL(precomputedInverseTransform);
+  CHECK_INT(precomputedInverseTransform->GetInverseFlag(), 0);
+  // Transform from parent is not affected
+  CHECK_POINTER(transformNode->GetTransformFromParentForEvaluation(), gridTransform);
+  // Stored transform and its exact inverse are still available (for editing, hardening, saving)
+  CHECK_POINTER(transformNode->GetTransformToParent(), iterativeInverseTransform);
+  CHECK_POINTER(transformNode->GetTransformFromParent(), gridTransform);
+
+  // Inversion converges everywhere for this smooth field
+  CHECK_INT(transformNode->GetPrecomputedInverseNumberOfNonConvergedPoints(), 0);
+  vtkImageData* convergenceMask = transformNode->GetPrecomputedInverseConvergenceMask();
+  CHECK_NOT_NULL(convergenceMask);
+  CHECK_INT(convergenceMask->GetNumberOfPoints(), displacementField->GetNumberOfPoints());
+  CHECK_DOUBLE(convergenceMask->GetScalarRange()[0], 1.0);
+
+  // Precomputed and iteratively computed inverse are the same at the grid points
+  // and they are close to each other between grid points.
+  precomputedInverseTransform->Update();
+  iterativeInverseTransform->Update();
+  for (double z = -45.0; z <= 45.0; z += 15.0)
+  {
+    for (double y = -45.0; y <= 45.0; y += 15.0)
+    {
+      for (double x = -45.0; x <= 45.0; x += 15.0)
+      {
+        const double point[3] = { x, y, z };
+        double precomputedInversePoint[3] = { 0.0, 0.0, 0.0 };
+        double iterativeInversePoint[3] = { 0.0, 0.0, 0.0 };
+        precomputedInverseTransform->TransformPoint(point, precomputedInversePoint);
+        iterativeInverseTransform->TransformPoint(point, iterativeInversePoint);
+        double error = sqrt(vtkMath::Distance2BetweenPoints(precomputedInversePoint, iterativeInversePoint));
+        bool isGridPoint = (fmod(x, 10.0) == 0.0 && fmod(y, 10.0) == 0.0 && fmod(z, 10.0) == 0.0);
+        if (error > (isGridPoint ? 0.01 : 0.1))
+        {
+          std::cerr << "Line " << __LINE__ << ": inverse mismatch at (" << x << ", " << y << ", " << z
+                    << "): error = " << error << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+  }
+
+  // Transform to world uses the precomputed inverse, transform from world uses the original transform
+  vtkNew<vtkGeneralTransform> transformToWorld;
+  transformNode->GetTransformToWorld(transformToWorld);
+  CHECK_INT(transformToWorld->GetNumberOfConcatenatedTransforms(), 1);
+  CHECK_POINTER(transformToWorld->GetConcatenatedTransform(0), precomputedInverseTransform);
+  vtkNew<vtkGeneralTransform> transformFromWorld;
+  transformNode->GetTransformFromWorld(transformFromWorld);
+  CHECK_INT(transformFromWorld->GetNumberOfConcatenatedTransforms(), 1);
+  CHECK_POINTER(transformFromWorld->GetConcatenatedTransform(0), gridTransform);
+
+  // Inverse is not recomputed if the displacement field is not modified
+  vtkMTimeType inverseMTime = precomputedInverseTransform->GetMTime();
+  CHECK_POINTER(transformNode->GetTransformToParentForEvaluation(), precomputedInverseTransform);
+  CHECK_BOOL(precomputedInverseTransform->GetMTime() == inverseMTime, true);
+
+  // Inverse is recomputed (in the same transform object) if the displacement field is modified
+  gridTransform->SetDisplacementScale(2.0);
+  CHECK_POINTER(transformNode->GetTransformToParentForEvaluation(), precomputedInverseTransform);
+  CHECK_BOOL(precomputedInverseTransform->GetMTime() > inverseMTime, true);
+  const double point[3] = { 12.0, -7.0, 3.0 };
+  double inversePoint[3] = { 0.0, 0.0, 0.0 };
+  double roundTripPoint[3] = { 0.0, 0.0, 0.0 };
+  precomputedInverseTransform->TransformPoint(point, inversePoint);
+  gridTransform->TransformPoint(inversePoint, roundTripPoint);
+  CHECK_BOOL(sqrt(vtkMath::Distance2BetweenPoints(point, roundTripPoint)) < 0.1, true);
+
+  // Iterative inverse is used when precomputed inverse is disabled
+  transformNode->PrecomputedInverseOff();
+  CHECK_POINTER(transformNode->GetTransformToParentForEvaluation(), gridTransform->GetInverse());
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkArchive.h"
+#include "vtkCacheManager.h"
+#include "vtkDataIOManager.h"
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTextNode.h"
+#include "vtkMRMLVolumeArchetypeStorageNode.h"
+
+// VTK includes
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtksys/Directory.hxx>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+void SetupCache(vtkMRMLScene* scene, const std::string& cacheDirectory)
+{
+  vtkNew<vtkCacheManager> cacheManager;
+  cacheManager->SetRemoteCacheDirectory(cacheDirectory.c_str());
+  vtkNew<vtkDataIOManager> dataIOManager;
+  dataIOManager->SetCacheManager(cacheManager);
+  scene->SetCacheManager(cacheManager);
+  scene->SetDataIOManager(dataIOManager);
+}
+
+//-----------------------------------------------------------------------------
+vtkMRMLTextNode* AddTextNode(vtkMRMLScene* scene, const char* name, const char* text)
+{
+  vtkNew<vtkMRMLTextNode> textNode;
+  textNode->SetName(name);
+  textNode->SetText(text);
+  textNode->SetForceCreateStorageNode(vtkMRMLTextNode::CreateStorageNodeAlways);
+  scene->AddNode(textNode);
+  textNode->AddDefaultStorageNode();
+  return textNode;
+}
+
+//-----------------------------------------------------------------------------
+// Number of temporary directories where bundles are extracted to
+int GetNumberOfBundleDirectories(const std::string& cacheDirectory)
+{
+  vtksys::Directory directory;
+  directory.Load(cacheDirectory);
+  int numberOfBundleDirectories = 0;
+  for (unsigned long fileIndex = 0; fileIndex < directory.GetNumberOfFiles(); ++fileIndex)
+  {
+    std::string fileName = directory.GetFile(fileIndex);
+    if (vtksys::SystemTools::StringStartsWith(fileName, "_tmp")
+      && vtksys::SystemTools::FileIsDirectory(cacheDirectory + "/" + fileName))
+    {
+      ++numberOfBundleDirectories;
+    }
+  }
+  return numberOfBundleDirectories;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLSceneBundleTest(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: vtkMRMLSceneBundleTest /path/to/temp" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tempDir = std::string(argv[1]) + "/vtkMRMLSceneBundleTest";
+  vtksys::SystemTools::RemoveADirectory(tempDir);
+  vtksys::SystemTools::MakeDirectory(tempDir);
+  std::string mrbFileName = tempDir + "/TextScene.mrb";
+
+  std::string secondMrbFileName = tempDir + "/SecondTextScene.mrb";
+  {
+    vtkNew<vtkMRMLScene> scene;
+    SetupCache(scene, tempDir);
+    AddTextNode(scene, "Notes", "first text");
+    AddTextNode(scene, "Notes.Extra", "second text");
+    AddTextNode(scene, "Report", "third text");
+    CHECK_BOOL(scene->WriteToMRB(mrbFileName.c_str()), true);
+    CHECK_BOOL(scene->WriteToMRB(secondMrbFileName.c_str()), true);
+  }
+  // Temporary files of writing are removed
+  CHECK_INT(GetNumberOfBundleDirectories(tempDir), 0);
+
+  // Bundle entries are written in a deterministic order, the scene file is the last entry
+  std::vector<std::string> entryNames;
+  CHECK_BOOL(vtkArchive::ListArchive(mrbFileName.c_str(), entryNames), true);
+  CHECK_BOOL(entryNames.size() >= 4, true);
+  CHECK_STD_STRING(vtksys::SystemTools::GetFilenameLastExtension(entryNames.back()), ".mrml");
+  std::vector<std::string> secondEntryNames;
+  CHECK_BOOL(vtkArchive::ListArchive(secondMrbFileName.c_str(), secondEntryNames), true);
+  CHECK_INT(static_cast<int>(secondEntryNames.size()), static_cast<int>(entryNames.size()));
+  for (size_t entryIndex = 1; entryIndex + 1 < entryNames.size(); ++entryIndex)
+  {
+    // data file entry names only differ in the top-level directory name
+    std::string entryName = entryNames[entryIndex].substr(entryNames[entryIndex].find('/'));
+    std::string secondEntryName = secondEntryNames[entryIndex].substr(secondEntryNames[entryIndex].find('/'));
+    CHECK_STD_STRING(secondEntryName, entryName);
+  }
+
+  // Individual entries can be read into memory or extracted
+  std::string sceneXML;
+  CHECK_BOOL(vtkArchive::ReadZipEntry(mrbFileName.c_str(), entryNames.back().c_str(), sceneXML), true);
+  CHECK_BOOL(sceneXML.find("<MRML") != std::string::npos, true);
+  CHECK_BOOL(vtkArchive::ReadZipEntry(mrbFileName.c_str(), "NotInTheBundle.txt", sceneXML), false);
+  std::string extractDirectory = tempDir + "/Extracted";
+  vtksys::SystemTools::MakeDirectory(extractDirectory);
+  std::vector<std::string> entryNamesToExtract = { entryNames.back() };
+  CHECK_BOOL(vtkArchive::UnZipFiles(mrbFileName.c_str(), extractDirectory.c_str(), entryNamesToExtract), true);
+  CHECK_BOOL(vtksys::SystemTools::FileExists(extractDirectory + "/" + entryNames.back(), true), true);
+  std::vector<std::string> missingEntryNames = { "NotInTheBundle.txt" };
+  CHECK_BOOL(vtkArchive::UnZipFiles(mrbFileName.c_str(), extractDirectory.c_str(), missingEntryNames), false);
+  vtksys::SystemTools::RemoveADirectory(extractDirectory);
+
+  // Files of each node are extracted from the bundle only when the node is read
+  vtkNew<vtkMRMLScene> scene;
+  SetupCache(scene, tempDir);
+  CHECK_BOOL(scene->ReadFromMRB(mrbFileName.c_str(), true), true);
+  // Extracted files are removed after reading
+  CHECK_INT(GetNumberOfBundleDirectories(tempDir), 0);
+  std::vector<vtkMRMLNode*> textNodes;
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLTextNode", textNodes), 3);
+  const char* expectedTexts[] = { "first text", "second text", "third text" };
+  for (int nodeIndex = 0; nodeIndex < 3; ++nodeIndex)
+  {
+    vtkMRMLTextNode* textNode = vtkMRMLTextNode::SafeDownCast(textNodes[nodeIndex]);
+    CHECK_NOT_NULL(textNode);
+    CHECK_STD_STRING(textNode->GetText(), expectedTexts[nodeIndex]);
+  }
+
+  // Files of memory mapped volumes are kept until the scene is cleared
+  std::string volumeMrbFileName = tempDir + "/VolumeScene.mrb";
+  {
+    vtkNew<vtkMRMLScene> volumeScene;
+    SetupCache(volumeScene, tempDir);
+    vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+      volumeScene->AddNewNodeByClass("vtkMRMLScalarVolumeNode", "Volume"));
+    vtkNew<vtkImageData> imageData;
+    imageData->SetDimensions(10, 20, 30);
+    imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    for (vtkIdType voxelIndex = 0; voxelIndex < imageData->GetNumberOfPoints(); ++voxelIndex)
+    {
+      imageData->GetPointData()->GetScalars()->SetTuple1(voxelIndex, voxelIndex % 100);
+    }
+    volumeNode->SetAndObserveImageData(imageData);
+    volumeNode->AddDefaultStorageNode();
+    vtkMRMLVolumeArchetypeStorageNode* storageNode =
+      vtkMRMLVolumeArchetypeStorageNode::SafeDownCast(volumeNode->GetStorageNode());
+    CHECK_NOT_NULL(storageNode);
+    storageNode->SetUseCompression(false);
+    storageNode->UseMemoryMappingOn();
+    CHECK_BOOL(volumeScene->WriteToMRB(volumeMrbFileName.c_str()), true);
+  }
+  CHECK_BOOL(scene->ReadFromMRB(volumeMrbFileName.c_str(), true), true);
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->GetFirstNodeByName("Volume"));
+  CHECK_NOT_NULL(volumeNode);
+  CHECK_NOT_NULL(volumeNode->GetImageData());
+  CHECK_DOUBLE(volumeNode->GetImageData()->GetPointData()->GetScalars()->GetTuple1(123), 23);
+  bool fileInUse = volumeNode->GetStorageNode()->IsFileInUseAfterRead(volumeNode);
+#ifdef MRML_USE_vtkTeem
+  CHECK_BOOL(fileInUse, true);
+#endif
+  CHECK_INT(GetNumberOfBundleDirectories(tempDir), fileInUse ? 1 : 0);
+  scene->Clear();
+  CHECK_INT(GetNumberOfBundleDirectories(tempDir), 0);
+
+  vtksys::SystemTools::RemoveADirectory(tempDir);
+  return EXIT_SUCCESS;
+}
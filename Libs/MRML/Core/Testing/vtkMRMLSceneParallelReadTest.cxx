@@ -0,0 +1,143 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLModelStorageNode.h"
+#include "vtkMRMLScene.h"
+
+// VTK includes
+#include <vtkNew.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+int WriteScene(const std::string& tempDir, const std::string& sceneFileName, int numberOfModels)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetRootDirectory(tempDir.c_str());
+  for (int modelIndex = 0; modelIndex < numberOfModels; ++modelIndex)
+  {
+    vtkNew<vtkSphereSource> sphere;
+    sphere->SetThetaResolution(20 + modelIndex);
+    sphere->SetPhiResolution(20 + modelIndex);
+    sphere->Update();
+    vtkNew<vtkMRMLModelNode> modelNode;
+    modelNode->SetAndObservePolyData(sphere->GetOutput());
+    scene->AddNode(modelNode);
+    vtkNew<vtkMRMLModelStorageNode> storageNode;
+    scene->AddNode(storageNode);
+    modelNode->SetAndObserveStorageNodeID(storageNode->GetID());
+    // Use both legacy and XML file formats
+    std::string fileName = tempDir + "/Model" + std::to_string(modelIndex) + (modelIndex % 2 ? ".vtp" : ".vtk");
+    storageNode->SetFileName(fileName.c_str());
+    CHECK_INT(storageNode->WriteData(modelNode), 1);
+  }
+  scene->SetURL(sceneFileName.c_str());
+  CHECK_INT(scene->Commit(), 1);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int ReadScene(const std::string& sceneFileName, int numberOfThreads, int numberOfModels)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetNumberOfReadThreads(numberOfThreads);
+  scene->SetURL(sceneFileName.c_str());
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  CHECK_INT(scene->Connect(), 1);
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT(std::string("vtkMRMLScene-ConnectTimeSec-") + (numberOfThreads == 1 ? "SingleThread" : "MultiThread"),
+    timer->GetElapsedTime());
+
+  // Models are read completely and in the original order, regardless of the number of threads
+  std::vector<vtkMRMLNode*> modelNodes;
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLModelNode", modelNodes), numberOfModels);
+  for (int modelIndex = 0; modelIndex < numberOfModels; ++modelIndex)
+  {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(modelNodes[modelIndex]);
+    CHECK_NOT_NULL(modelNode);
+    CHECK_NOT_NULL(modelNode->GetPolyData());
+    int resolution = 20 + modelIndex;
+    CHECK_INT(modelNode->GetPolyData()->GetNumberOfPoints(), resolution * (resolution - 2) + 2);
+    CHECK_BOOL(scene->GetNodeReadTime(modelNode->GetID()) >= 0.0, true);
+  }
+  CHECK_DOUBLE(scene->GetNodeReadTime("vtkMRMLModelNodeInvalidID"), -1.0);
+  CHECK_DOUBLE(scene->GetNodeReadTime(nullptr), -1.0);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int ReadSceneWithoutData(const std::string& sceneFileName, int numberOfModels)
+{
+  vtkNew<vtkMRMLScene> scene;
+  // Concurrent reading is disabled by default
+  CHECK_INT(scene->GetNumberOfReadThreads(), 1);
+  scene->SetNumberOfReadThreads(4);
+  scene->SetReadDataOnLoad(0);
+  scene->SetURL(sceneFileName.c_str());
+  CHECK_INT(scene->Connect(), 1);
+
+  // No data is prefetched when the scene does not read data on load
+  std::vector<vtkMRMLNode*> modelNodes;
+  CHECK_INT(scene->GetNodesByClass("vtkMRMLModelNode", modelNodes), numberOfModels);
+  for (vtkMRMLNode* node : modelNodes)
+  {
+    vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(node);
+    CHECK_NOT_NULL(modelNode);
+    CHECK_NULL(modelNode->GetPolyData());
+  }
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLSceneParallelReadTest(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: vtkMRMLSceneParallelReadTest /path/to/temp [numberOfModels]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string tempDir = std::string(argv[1]) + "/vtkMRMLSceneParallelReadTest";
+  int numberOfModels = 20;
+  if (argc > 2)
+  {
+    numberOfModels = atoi(argv[2]);
+  }
+  vtksys::SystemTools::RemoveADirectory(tempDir);
+  vtksys::SystemTools::MakeDirectory(tempDir);
+  std::string sceneFileName = tempDir + "/ModelScene.mrml";
+
+  CHECK_EXIT_SUCCESS(WriteScene(tempDir, sceneFileName, numberOfModels));
+  CHECK_EXIT_SUCCESS(ReadScene(sceneFileName, 1, numberOfModels));
+  CHECK_EXIT_SUCCESS(ReadScene(sceneFileName, 4, numberOfModels));
+  CHECK_EXIT_SUCCESS(ReadSceneWithoutData(sceneFileName, numberOfModels));
+
+  vtksys::SystemTools::RemoveADirectory(tempDir);
+  return EXIT_SUCCESS;
+}
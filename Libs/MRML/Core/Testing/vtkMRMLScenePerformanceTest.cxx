@@ -0,0 +1,198 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTextNode.h"
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+// Get nodes of a class by traversing all nodes of the scene
+std::vector<vtkMRMLNode*> GetNodesByClassReference(vtkMRMLScene* scene, const char* className)
+{
+  std::vector<vtkMRMLNode*> nodes;
+  for (int nodeIndex = 0; nodeIndex < scene->GetNumberOfNodes(); ++nodeIndex)
+  {
+    vtkMRMLNode* node = scene->GetNthNode(nodeIndex);
+    if (node->IsA(className))
+    {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+//-----------------------------------------------------------------------------
+int CheckNodesByClass(vtkMRMLScene* scene, const char* className)
+{
+  std::vector<vtkMRMLNode*> expectedNodes = GetNodesByClassReference(scene, className);
+  std::vector<vtkMRMLNode*> nodes;
+  CHECK_INT(scene->GetNodesByClass(className, nodes), static_cast<int>(expectedNodes.size()));
+  CHECK_INT(scene->GetNumberOfNodesByClass(className), static_cast<int>(expectedNodes.size()));
+  for (size_t nodeIndex = 0; nodeIndex < expectedNodes.size(); ++nodeIndex)
+  {
+    CHECK_POINTER(nodes[nodeIndex], expectedNodes[nodeIndex]);
+  }
+  if (!expectedNodes.empty())
+  {
+    CHECK_POINTER(scene->GetFirstNodeByClass(className), expectedNodes.front());
+    CHECK_POINTER(scene->GetNthNodeByClass(static_cast<int>(expectedNodes.size()) - 1, className), expectedNodes.back());
+  }
+  CHECK_NULL(scene->GetNthNodeByClass(static_cast<int>(expectedNodes.size()), className));
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestNodeIndexes()
+{
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLLinearTransformNode> transformNode1;
+  transformNode1->SetName("Transform");
+  scene->AddNode(transformNode1);
+  vtkNew<vtkMRMLTextNode> textNode;
+  textNode->SetName("Text");
+  scene->AddNode(textNode);
+  vtkNew<vtkMRMLTransformNode> transformNode2;
+  transformNode2->SetName("Transform");
+  scene->AddNode(transformNode2);
+
+  // Nodes of multiple classes are returned in the order of the scene
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLTransformNode"));
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLLinearTransformNode"));
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLNode"));
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLModelNode"));
+
+  // Node inserted before another node
+  vtkNew<vtkMRMLLinearTransformNode> transformNode3;
+  scene->InsertBeforeNode(transformNode1, transformNode3);
+  CHECK_POINTER(scene->GetFirstNodeByClass("vtkMRMLTransformNode"), transformNode3.GetPointer());
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLTransformNode"));
+
+  // Nodes by name
+  vtkSmartPointer<vtkCollection> nodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByName("Transform"));
+  CHECK_INT(nodes->GetNumberOfItems(), 2);
+  CHECK_POINTER(nodes->GetItemAsObject(0), transformNode1.GetPointer());
+  CHECK_POINTER(nodes->GetItemAsObject(1), transformNode2.GetPointer());
+  nodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByClassByName("vtkMRMLLinearTransformNode", "Transform"));
+  CHECK_INT(nodes->GetNumberOfItems(), 1);
+
+  // Renamed node
+  transformNode1->SetName("RenamedTransform");
+  CHECK_POINTER(scene->GetFirstNodeByName("Transform"), transformNode2.GetPointer());
+  CHECK_POINTER(scene->GetFirstNodeByName("RenamedTransform"), transformNode1.GetPointer());
+
+  // Removed node
+  scene->RemoveNode(transformNode2);
+  CHECK_NULL(scene->GetFirstNodeByName("Transform"));
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLTransformNode"));
+
+  // Nodes removed from the node collection directly
+  scene->GetNodes()->RemoveItem(textNode);
+  CHECK_EXIT_SUCCESS(CheckNodesByClass(scene, "vtkMRMLNode"));
+  CHECK_NULL(scene->GetFirstNodeByName("Text"));
+
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestSceneScaling(int numberOfNodes)
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  // Add nodes and query the scene after each node is added, similarly to
+  // displayable managers and module widgets that observe node added events.
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int nodeIndex = 0; nodeIndex < numberOfNodes; ++nodeIndex)
+  {
+    if (nodeIndex % 2)
+    {
+      vtkNew<vtkMRMLTextNode> node;
+      scene->AddNode(node);
+    }
+    else
+    {
+      vtkNew<vtkMRMLLinearTransformNode> node;
+      scene->AddNode(node);
+    }
+    scene->GetNumberOfNodesByClass("vtkMRMLTextNode");
+    scene->GetFirstNodeByClass("vtkMRMLTransformNode");
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkMRMLScene-AddNodeTimePerNodeUsec-" + std::to_string(numberOfNodes), timer->GetElapsedTime() / numberOfNodes * 1e6);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTextNode"), numberOfNodes / 2);
+  CHECK_INT(scene->GetNumberOfNodesByClass("vtkMRMLTransformNode"), numberOfNodes - numberOfNodes / 2);
+
+  // Query nodes by class
+  const int numberOfQueries = 1000;
+  std::vector<vtkMRMLNode*> nodes;
+  timer->StartTimer();
+  for (int queryIndex = 0; queryIndex < numberOfQueries; ++queryIndex)
+  {
+    scene->GetNodesByClass("vtkMRMLTextNode", nodes);
+  }
+  timer->StopTimer();
+  CHECK_INT(static_cast<int>(nodes.size()), numberOfNodes / 2);
+  PRINT_DART_MEASUREMENT("vtkMRMLScene-GetNodesByClassTimePerQueryUsec-" + std::to_string(numberOfNodes), timer->GetElapsedTime() / numberOfQueries * 1e6);
+
+  // Query nodes by name
+  timer->StartTimer();
+  for (int queryIndex = 0; queryIndex < numberOfQueries; ++queryIndex)
+  {
+    vtkMRMLNode* expectedNode = scene->GetNthNode((queryIndex * 7919) % numberOfNodes);
+    if (scene->GetFirstNodeByName(expectedNode->GetName()) != expectedNode)
+    {
+      std::cerr << "Line " << __LINE__ << ": failed to find node by name " << expectedNode->GetName() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkMRMLScene-GetFirstNodeByNameTimePerQueryUsec-" + std::to_string(numberOfNodes), timer->GetElapsedTime() / numberOfQueries * 1e6);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLScenePerformanceTest(int argc, char* argv[])
+{
+  // Largest number of nodes in the scene used for testing scaling
+  int maximumNumberOfNodes = 100000;
+  if (argc > 1)
+  {
+    maximumNumberOfNodes = atoi(argv[1]);
+  }
+  CHECK_EXIT_SUCCESS(TestNodeIndexes());
+  for (int numberOfNodes = 1000; numberOfNodes <= maximumNumberOfNodes; numberOfNodes *= 10)
+  {
+    CHECK_EXIT_SUCCESS(TestSceneScaling(numberOfNodes));
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLLinearTransformNode.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTextNode.h"
+
+// VTK includes
+#include <vtkFloatArray.h>
+#include <vtkMatrix4x4.h>
+#include <vtkNew.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkTimerLog.h>
+
+// STD includes
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+double GetTranslation(vtkMRMLScene* scene, const char* nodeID)
+{
+  vtkMRMLLinearTransformNode* transformNode = vtkMRMLLinearTransformNode::SafeDownCast(scene->GetNodeByID(nodeID));
+  if (!transformNode)
+  {
+    return -1.0;
+  }
+  vtkNew<vtkMatrix4x4> matrix;
+  transformNode->GetMatrixTransformToParent(matrix);
+  return matrix->GetElement(0, 3);
+}
+
+//-----------------------------------------------------------------------------
+void SetTranslation(vtkMRMLLinearTransformNode* transformNode, double translation)
+{
+  vtkNew<vtkMatrix4x4> matrix;
+  matrix->SetElement(0, 3, translation);
+  transformNode->SetMatrixTransformToParent(matrix);
+}
+
+//-----------------------------------------------------------------------------
+int TestUndoRedo()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+
+  vtkNew<vtkMRMLLinearTransformNode> transformNode;
+  transformNode->SetUndoEnabled(true);
+  scene->AddNode(transformNode);
+  std::string transformNodeID = transformNode->GetID();
+  vtkNew<vtkMRMLTextNode> textNode;
+  textNode->SetUndoEnabled(true);
+  textNode->SetText("first");
+  scene->AddNode(textNode);
+
+  // Save states where only one of the nodes changes
+  scene->SaveStateForUndo();
+  SetTranslation(transformNode, 1.0);
+  scene->SaveStateForUndo();
+  SetTranslation(transformNode, 2.0);
+  scene->SaveStateForUndo();
+  textNode->SetText("second");
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 3);
+
+  scene->Undo();
+  CHECK_STD_STRING(textNode->GetText(), "first");
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 2.0);
+  scene->Undo();
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 1.0);
+  scene->Undo();
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 0.0);
+  CHECK_STD_STRING(textNode->GetText(), "first");
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 0);
+
+  scene->Redo();
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 1.0);
+  scene->Redo();
+  scene->Redo();
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 2.0);
+  CHECK_STD_STRING(textNode->GetText(), "second");
+  CHECK_INT(scene->GetNumberOfRedoLevels(), 0);
+
+  // Removed node is restored and can be modified independently from the undo stack
+  scene->SaveStateForUndo();
+  scene->RemoveNode(transformNode);
+  CHECK_NULL(scene->GetNodeByID(transformNodeID.c_str()));
+  scene->Undo();
+  vtkMRMLLinearTransformNode* restoredTransformNode = vtkMRMLLinearTransformNode::SafeDownCast(
+    scene->GetNodeByID(transformNodeID.c_str()));
+  CHECK_NOT_NULL(restoredTransformNode);
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 2.0);
+  SetTranslation(restoredTransformNode, 3.0);
+  scene->Undo();
+  CHECK_DOUBLE(GetTranslation(scene, transformNodeID.c_str()), 2.0);
+
+  // Node that has undo disabled is not restored
+  vtkNew<vtkMRMLTextNode> untrackedTextNode;
+  scene->AddNode(untrackedTextNode);
+  scene->SaveStateForUndo();
+  untrackedTextNode->SetUndoEnabled(true);
+  untrackedTextNode->SetText("modified");
+  scene->SaveStateForUndo();
+  scene->Undo();
+  CHECK_BOOL(scene->IsNodePresent(untrackedTextNode) != 0, true);
+  scene->Undo();
+  CHECK_BOOL(scene->IsNodePresent(untrackedTextNode) != 0, false);
+
+  scene->ClearUndoStack();
+  scene->ClearRedoStack();
+  CHECK_INT(scene->GetNumberOfUndoLevels(), 0);
+  CHECK_INT(scene->GetNumberOfRedoLevels(), 0);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestBulkDataUndo()
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+
+  vtkNew<vtkPoints> points;
+  points->InsertNextPoint(1.0, 2.0, 3.0);
+  points->InsertNextPoint(4.0, 5.0, 6.0);
+  vtkNew<vtkPolyData> mesh;
+  mesh->SetPoints(points);
+  vtkNew<vtkMRMLModelNode> modelNode;
+  modelNode->SetUndoEnabled(true);
+  modelNode->SetName("first");
+  modelNode->SetAndObserveMesh(mesh);
+  scene->AddNode(modelNode);
+
+  // Only the node name changes, the mesh of the first copy is reused
+  scene->SaveStateForUndo();
+  modelNode->SetName("second");
+  scene->SaveStateForUndo();
+
+  // Modify point coordinates in place, only the array is marked as modified
+  vtkFloatArray* coordinates = vtkFloatArray::SafeDownCast(points->GetData());
+  CHECK_NOT_NULL(coordinates);
+  coordinates->GetPointer(0)[0] = 10.0f;
+  coordinates->Modified();
+  CHECK_BOOL(modelNode->GetContentMTime() >= coordinates->GetMTime(), true);
+
+  scene->Undo();
+  CHECK_STD_STRING(modelNode->GetName(), "second");
+  CHECK_DOUBLE(modelNode->GetMesh()->GetPoint(0)[0], 1.0);
+  scene->Undo();
+  CHECK_STD_STRING(modelNode->GetName(), "first");
+  CHECK_DOUBLE(modelNode->GetMesh()->GetPoint(0)[0], 1.0);
+
+  scene->Redo();
+  CHECK_STD_STRING(modelNode->GetName(), "second");
+  CHECK_DOUBLE(modelNode->GetMesh()->GetPoint(0)[0], 1.0);
+  scene->Redo();
+  CHECK_STD_STRING(modelNode->GetName(), "second");
+  CHECK_DOUBLE(modelNode->GetMesh()->GetPoint(0)[0], 10.0);
+  CHECK_DOUBLE(modelNode->GetMesh()->GetPoint(1)[2], 6.0);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestSaveStatePerformance(int numberOfNodes)
+{
+  vtkNew<vtkMRMLScene> scene;
+  scene->SetUndoOn();
+  vtkMRMLLinearTransformNode* modifiedNode = nullptr;
+  for (int nodeIndex = 0; nodeIndex < numberOfNodes; ++nodeIndex)
+  {
+    vtkNew<vtkMRMLLinearTransformNode> transformNode;
+    transformNode->SetUndoEnabled(true);
+    scene->AddNode(transformNode);
+    modifiedNode = transformNode;
+  }
+
+  // Save state after each interaction that modifies a single node
+  const int numberOfSavedStates = 100;
+  scene->SetMaximumNumberOfSavedUndoStates(numberOfSavedStates);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int stateIndex = 0; stateIndex < numberOfSavedStates; ++stateIndex)
+  {
+    scene->SaveStateForUndo();
+    SetTranslation(modifiedNode, stateIndex + 1);
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkMRMLScene-SaveStateForUndoTimePerStateUsec-" + std::to_string(numberOfNodes), timer->GetElapsedTime() / numberOfSavedStates * 1e6);
+
+  timer->StartTimer();
+  for (int stateIndex = numberOfSavedStates - 1; stateIndex >= 0; --stateIndex)
+  {
+    scene->Undo();
+    CHECK_DOUBLE(GetTranslation(scene, modifiedNode->GetID()), stateIndex);
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkMRMLScene-UndoTimePerStateUsec-" + std::to_string(numberOfNodes), timer->GetElapsedTime() / numberOfSavedStates * 1e6);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLSceneUndoTest(int argc, char* argv[])
+{
+  // Number of undo-enabled nodes in the scene used for testing performance
+  int numberOfNodes = 10000;
+  if (argc > 1)
+  {
+    numberOfNodes = atoi(argv[1]);
+  }
+  CHECK_EXIT_SUCCESS(TestUndoRedo());
+  CHECK_EXIT_SUCCESS(TestBulkDataUndo());
+  CHECK_EXIT_SUCCESS(TestSaveStatePerformance(numberOfNodes));
+  return EXIT_SUCCESS;
+}
@@ -19,6 +19,9 @@
 #include "vtkMRMLScene.h"
 #include "vtkMRMLSubjectHierarchyNode.h"
 
+// VTK includes
+#include <vtkIdList.h>
+
 int vtkMRMLSubjectHierarchyNodeTest1(int , char * [])
 {
   // Add a scene with 3 text nodes
@@ -115,5 +118,76 @@ int vtkMRMLSubjectHierarchyNodeTest1(int , char * [])
   CHECK_BOOL(std::find(atts.begin(), atts.end(), "zxcv") != atts.end(), true);
   CHECK_BOOL(std::find(atts.begin(), atts.end(), "qwer") != atts.end(), true);
 
+  // Test finding items by UID and name
+  /////////////////////////
+
+  vtkIdType folderItemId = shNode->CreateFolderItem(shNode->GetSceneItemID(), "Folder");
+  vtkIdType studyItemId = shNode->CreateStudyItem(folderItemId, "Study");
+  shNode->SetItemUID(studyItemId, "DICOM", "1.2.3");
+  shNode->SetItemUID(itemId1, "DICOM", "1.2.3.4 1.2.3.5 1.2.3.6");
+
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), studyItemId);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3.5"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3.5"), itemId1);
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3.4 1.2.3.5"), itemId1);
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3.7"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  // Complete UIDs are preferred over substring matches (itemId1 precedes the study in the tree)
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3"), studyItemId);
+  // Part of a UID is searched as a substring
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3."), itemId1);
+
+  // Duplicate UIDs: the first item in tree order is found
+  vtkIdType duplicateUIDItemId = shNode->CreateFolderItem(shNode->GetSceneItemID(), "Duplicate");
+  shNode->SetItemUID(duplicateUIDItemId, "DICOM", "1.2.3");
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), studyItemId);
+  CHECK_BOOL(shNode->MoveItem(duplicateUIDItemId, folderItemId), true);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), duplicateUIDItemId);
+  CHECK_BOOL(shNode->RemoveItem(duplicateUIDItemId), true);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), studyItemId);
+
+  // Replaced UID
+  shNode->SetItemUID(itemId1, "DICOM", "1.2.3.7");
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3.5"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByUIDList("DICOM", "1.2.3.7"), itemId1);
+
+  CHECK_INT(shNode->GetItemByName("Study"), studyItemId);
+  CHECK_INT(shNode->GetItemChildWithName(folderItemId, "Study"), studyItemId);
+  CHECK_INT(shNode->GetItemChildWithName(shNode->GetSceneItemID(), "Study"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemChildWithName(shNode->GetSceneItemID(), "Study", true), studyItemId);
+
+  // Renamed items (directly and through the data node)
+  shNode->SetItemName(studyItemId, "RenamedStudy");
+  CHECK_INT(shNode->GetItemByName("Study"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByName("RenamedStudy"), studyItemId);
+  dataNode1->SetName("Model");
+  CHECK_INT(shNode->GetItemByName("Model"), itemId1);
+  // Renamed while modified events of the data node are disabled
+  int wasModifying = dataNode1->StartModify();
+  dataNode1->SetName("RenamedModel");
+  CHECK_INT(shNode->GetItemByName("RenamedModel"), itemId1);
+  CHECK_INT(shNode->GetItemByName("Model"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  dataNode1->SetName("Model");
+  dataNode1->EndModify(wasModifying);
+  CHECK_INT(shNode->GetItemByName("RenamedModel"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByName("Model"), itemId1);
+
+  // Reparented item
+  shNode->SetItemParent(studyItemId, shNode->GetSceneItemID());
+  CHECK_INT(shNode->GetItemChildWithName(folderItemId, "RenamedStudy"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemChildWithName(shNode->GetSceneItemID(), "RenamedStudy"), studyItemId);
+
+  // Items with the same name
+  vtkIdType secondModelItemId = shNode->CreateFolderItem(folderItemId, "Model");
+  vtkNew<vtkIdList> foundItemIds;
+  shNode->GetItemsByName("Model", foundItemIds);
+  CHECK_INT(foundItemIds->GetNumberOfIds(), 2);
+  CHECK_INT(foundItemIds->GetId(0), itemId1);
+  CHECK_INT(foundItemIds->GetId(1), secondModelItemId);
+
+  // Removed item
+  CHECK_BOOL(shNode->RemoveItem(studyItemId), true);
+  CHECK_INT(shNode->GetItemByUID("DICOM", "1.2.3"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+  CHECK_INT(shNode->GetItemByName("RenamedStudy"), vtkMRMLSubjectHierarchyNode::GetInvalidItemID());
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,187 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLModelNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLTransformNode.h"
+
+// VTK includes
+#include <vtkFloatArray.h>
+#include <vtkGeneralTransform.h>
+#include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkOrientedGridTransform.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkSphereSource.h>
+#include <vtkThinPlateSplineTransform.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+
+// STD includes
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Composite transform: linear, grid, linear, linear, inverse of thin plate spline
+void CreateCompositeTransform(vtkGeneralTransform* compositeTransform)
+{
+  vtkNew<vtkTransform> linearTransform1;
+  linearTransform1->RotateZ(30.0);
+  linearTransform1->Translate(5.0, -3.0, 2.0);
+
+  vtkNew<vtkImageData> displacementField;
+  displacementField->SetOrigin(-60.0, -60.0, -60.0);
+  displacementField->SetSpacing(10.0, 10.0, 10.0);
+  displacementField->SetDimensions(13, 13, 13);
+  displacementField->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacements = static_cast<double*>(displacementField->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < displacementField->GetNumberOfPoints(); ++pointIndex)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    displacementField->GetPoint(pointIndex, point);
+    displacements[pointIndex * 3 + 0] = 3.0 * sin(point[1] / 20.0);
+    displacements[pointIndex * 3 + 1] = 2.0 * cos(point[2] / 25.0);
+    displacements[pointIndex * 3 + 2] = 1.0 * sin(point[0] / 15.0);
+  }
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacementField);
+  gridTransform->SetInterpolationModeToCubic();
+
+  vtkNew<vtkTransform> linearTransform2;
+  linearTransform2->Scale(1.1, 0.9, 1.0);
+  vtkNew<vtkTransform> linearTransform3;
+  linearTransform3->RotateX(-20.0);
+
+  vtkNew<vtkPoints> sourceLandmarks;
+  vtkNew<vtkPoints> targetLandmarks;
+  for (int i = 0; i < 8; ++i)
+  {
+    double source[3] = { (i & 1) ? 40.0 : -40.0, (i & 2) ? 40.0 : -40.0, (i & 4) ? 40.0 : -40.0 };
+    double target[3] = { source[0] + (i % 3), source[1] - (i % 2), source[2] + 0.5 * i };
+    sourceLandmarks->InsertNextPoint(source);
+    targetLandmarks->InsertNextPoint(target);
+  }
+  vtkNew<vtkThinPlateSplineTransform> tpsTransform;
+  tpsTransform->SetSourceLandmarks(sourceLandmarks);
+  tpsTransform->SetTargetLandmarks(targetLandmarks);
+  tpsTransform->SetBasisToR();
+
+  compositeTransform->PostMultiply();
+  compositeTransform->Concatenate(linearTransform1);
+  compositeTransform->Concatenate(gridTransform);
+  compositeTransform->Concatenate(linearTransform2);
+  compositeTransform->Concatenate(linearTransform3);
+  compositeTransform->Concatenate(tpsTransform->GetInverse());
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLTransformNodeTransformPointsTest1(int , char * [] )
+{
+  vtkNew<vtkGeneralTransform> compositeTransform;
+  CreateCompositeTransform(compositeTransform);
+
+  vtkNew<vtkSphereSource> sphereSource;
+  sphereSource->SetRadius(40.0);
+  sphereSource->SetThetaResolution(60);
+  sphereSource->SetPhiResolution(60);
+  sphereSource->Update();
+  vtkPolyData* sphere = sphereSource->GetOutput();
+  vtkPoints* inputPoints = sphere->GetPoints();
+  vtkDataArray* inputNormals = sphere->GetPointData()->GetNormals();
+  CHECK_NOT_NULL(inputNormals);
+
+  // Reference: transform points one by one
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  vtkNew<vtkPoints> expectedPoints;
+  vtkNew<vtkFloatArray> expectedNormals;
+  expectedNormals->SetNumberOfComponents(3);
+  compositeTransform->TransformPointsNormalsVectors(inputPoints, expectedPoints, inputNormals, expectedNormals,
+    nullptr, nullptr, 0, nullptr, nullptr);
+  timer->StopTimer();
+  double referenceTime = timer->GetElapsedTime();
+
+  // Batched transform
+  timer->StartTimer();
+  vtkNew<vtkPoints> transformedPoints;
+  vtkNew<vtkFloatArray> transformedNormals;
+  vtkMRMLTransformNode::TransformPoints(compositeTransform, inputPoints, transformedPoints, inputNormals, transformedNormals);
+  timer->StopTimer();
+  std::cout << "Transformed " << inputPoints->GetNumberOfPoints() << " points one by one in " << referenceTime
+            << "s, in batch in " << timer->GetElapsedTime() << "s" << std::endl;
+
+  CHECK_INT(transformedPoints->GetNumberOfPoints(), inputPoints->GetNumberOfPoints());
+  CHECK_INT(transformedNormals->GetNumberOfTuples(), inputPoints->GetNumberOfPoints());
+  for (vtkIdType pointIndex = 0; pointIndex < inputPoints->GetNumberOfPoints(); ++pointIndex)
+  {
+    double expectedPoint[3] = { 0.0, 0.0, 0.0 };
+    double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+    expectedPoints->GetPoint(pointIndex, expectedPoint);
+    transformedPoints->GetPoint(pointIndex, transformedPoint);
+    double expectedNormal[3] = { 0.0, 0.0, 0.0 };
+    double transformedNormal[3] = { 0.0, 0.0, 0.0 };
+    expectedNormals->GetTuple(pointIndex, expectedNormal);
+    transformedNormals->GetTuple(pointIndex, transformedNormal);
+    if (sqrt(vtkMath::Distance2BetweenPoints(expectedPoint, transformedPoint)) > 1e-6
+      || sqrt(vtkMath::Distance2BetweenPoints(expectedNormal, transformedNormal)) > 1e-5)
+    {
+      std::cerr << "Line " << __LINE__ << ": mismatch at point " << pointIndex << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Points can be transformed in-place, using a single thread
+  vtkNew<vtkPoints> inPlacePoints;
+  inPlacePoints->DeepCopy(inputPoints);
+  vtkMRMLTransformNode::TransformPoints(compositeTransform, inPlacePoints, inPlacePoints, nullptr, nullptr, 1);
+  for (vtkIdType pointIndex = 0; pointIndex < inputPoints->GetNumberOfPoints(); ++pointIndex)
+  {
+    CHECK_DOUBLE_TOLERANCE(inPlacePoints->GetPoint(pointIndex)[0], expectedPoints->GetPoint(pointIndex)[0], 1e-6);
+  }
+
+  // Hardening a non-linear transform on a model uses batched point transform
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkPolyData> modelMesh;
+  modelMesh->DeepCopy(sphere);
+  vtkMRMLModelNode* modelNode = vtkMRMLModelNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLModelNode"));
+  modelNode->SetAndObservePolyData(modelMesh);
+  vtkMRMLTransformNode* transformNode = vtkMRMLTransformNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLTransformNode"));
+  transformNode->SetAndObserveTransformToParent(compositeTransform);
+  modelNode->SetAndObserveTransformNodeID(transformNode->GetID());
+  CHECK_BOOL(modelNode->HardenTransform(), true);
+  CHECK_NULL(modelNode->GetParentTransformNode());
+  vtkPolyData* hardenedMesh = modelNode->GetPolyData();
+  CHECK_INT(hardenedMesh->GetNumberOfPoints(), inputPoints->GetNumberOfPoints());
+  CHECK_NOT_NULL(hardenedMesh->GetPointData()->GetNormals());
+  for (vtkIdType pointIndex = 0; pointIndex < inputPoints->GetNumberOfPoints(); pointIndex += 97)
+  {
+    double expectedPoint[3] = { 0.0, 0.0, 0.0 };
+    double hardenedPoint[3] = { 0.0, 0.0, 0.0 };
+    expectedPoints->GetPoint(pointIndex, expectedPoint);
+    hardenedMesh->GetPoint(pointIndex, hardenedPoint);
+    CHECK_BOOL(sqrt(vtkMath::Distance2BetweenPoints(expectedPoint, hardenedPoint)) < 1e-4, true);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -23,6 +23,14 @@
 #include <vtksys/SystemTools.hxx>
 #include <vtkTransform.h>
 
+#ifdef MRML_USE_vtkTeem
+#include <vtkTeemNRRDReader.h>
+#endif
+
+// STD includes
+#include <fstream>
+#include <sstream>
+
 std::string tempFilename(std::string tempDir, std::string suffix, std::string fileExtension, bool remove=false)
 {
   std::string filename = tempDir + "/vtkMRMLVolumeArchetypeStorageNodeTest1_" + suffix + "." + fileExtension;
@@ -222,6 +230,145 @@ int TestFlipsLeftHandedVolumes(const std::string& tempDir)
   return EXIT_SUCCESS;
 }
 
+int TestMemoryMapping(const std::string& tempDir)
+{
+  std::cout << "TestMemoryMapping" << std::endl;
+  vtkNew<vtkMRMLScene> scene;
+
+  auto volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  CHECK_NOT_NULL(volumeNode);
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(10, 20, 30);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  for (vtkIdType voxelIndex = 0; voxelIndex < imageData->GetNumberOfPoints(); ++voxelIndex)
+  {
+    imageData->GetPointData()->GetScalars()->SetTuple1(voxelIndex, voxelIndex % 1000);
+  }
+  volumeNode->SetAndObserveImageData(imageData);
+  volumeNode->SetSpacing(0.5, 1.5, 2.5);
+  volumeNode->SetOrigin(10.0, -20.0, 30.0);
+  double ijkToRasDirections[3][3] = { { 0.0, -1.0, 0.0 }, { 1.0, 0.0, 0.0 }, { 0.0, 0.0, 1.0 } };
+  volumeNode->SetIJKToRASDirections(ijkToRasDirections);
+
+  // Memory mapping requires uncompressed file
+  const auto fileName = tempFilename(tempDir, "memory_mapped", "nrrd", true);
+  auto storageNode =
+    vtkMRMLVolumeArchetypeStorageNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLVolumeArchetypeStorageNode"));
+  CHECK_NOT_NULL(storageNode);
+  storageNode->SetSingleFile(true);
+  storageNode->SetUseCompression(false);
+  storageNode->SetFileName(fileName.c_str());
+  volumeNode->SetAndObserveStorageNodeID(storageNode->GetID());
+  CHECK_BOOL(storageNode->WriteData(volumeNode), true);
+
+  // Memory mapping setting is only saved in the scene if it is enabled
+  {
+    std::stringstream xml;
+    storageNode->WriteXML(xml, 0);
+    CHECK_BOOL(xml.str().find("useMemoryMapping") == std::string::npos, true);
+  }
+
+  // Volume read without memory mapping is the reference
+  auto referenceVolumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  CHECK_BOOL(storageNode->ReadData(referenceVolumeNode), true);
+
+  storageNode->UseMemoryMappingOn();
+  {
+    std::stringstream xml;
+    storageNode->WriteXML(xml, 0);
+    CHECK_BOOL(xml.str().find("useMemoryMapping=\"true\"") != std::string::npos, true);
+  }
+  auto volumeNode2 = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  CHECK_BOOL(storageNode->ReadData(volumeNode2), true);
+  CHECK_NOT_NULL(volumeNode2->GetImageData());
+
+  // Mapped volume has the same geometry and scalar type as the volume read by the ITK reader
+  CHECK_INT(volumeNode2->GetImageData()->GetScalarType(), referenceVolumeNode->GetImageData()->GetScalarType());
+  CHECK_INT(volumeNode2->GetVoxelVectorType(), referenceVolumeNode->GetVoxelVectorType());
+  vtkNew<vtkMatrix4x4> ijkToRas;
+  volumeNode2->GetIJKToRASMatrix(ijkToRas);
+  vtkNew<vtkMatrix4x4> referenceIjkToRas;
+  referenceVolumeNode->GetIJKToRASMatrix(referenceIjkToRas);
+  for (int row = 0; row < 4; ++row)
+  {
+    for (int column = 0; column < 4; ++column)
+    {
+      CHECK_DOUBLE_TOLERANCE(ijkToRas->GetElement(row, column), referenceIjkToRas->GetElement(row, column), 1e-6);
+    }
+  }
+  CHECK_DOUBLE(volumeNode2->GetImageData()->GetSpacing()[0], 1.0);
+  CHECK_DOUBLE(volumeNode2->GetImageData()->GetOrigin()[0], 0.0);
+#ifdef MRML_USE_vtkTeem
+  // Voxels can only be mapped if they are correctly aligned in the file (depends on the header length)
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  bool expectedMemoryMapped = reader->CanUseMemoryMapping();
+  CHECK_BOOL(expectedMemoryMapped, reader->GetRawDataOffset() % sizeof(short) == 0);
+  CHECK_BOOL(vtkTeemNRRDReader::IsMemoryMappedArray(volumeNode2->GetImageData()->GetPointData()->GetScalars()),
+    expectedMemoryMapped);
+#endif
+  CHECK_INT(volumeNode2->GetImageData()->GetNumberOfPoints(), imageData->GetNumberOfPoints());
+  for (vtkIdType voxelIndex = 0; voxelIndex < imageData->GetNumberOfPoints(); ++voxelIndex)
+  {
+    CHECK_DOUBLE(volumeNode2->GetImageData()->GetPointData()->GetScalars()->GetTuple1(voxelIndex), voxelIndex % 1000);
+  }
+
+  // Modify the mapped voxels and write them back to the same file
+  volumeNode2->GetImageData()->GetPointData()->GetScalars()->SetTuple1(0, 1234);
+  volumeNode2->SetAndObserveStorageNodeID(storageNode->GetID());
+  CHECK_BOOL(storageNode->WriteData(volumeNode2), true);
+#ifdef MRML_USE_vtkTeem
+  CHECK_BOOL(vtkTeemNRRDReader::IsMemoryMappedArray(volumeNode2->GetImageData()->GetPointData()->GetScalars()), false);
+#endif
+  CHECK_DOUBLE(volumeNode2->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 1234);
+
+  auto volumeNode3 = vtkMRMLScalarVolumeNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  CHECK_BOOL(storageNode->ReadData(volumeNode3), true);
+  CHECK_DOUBLE(volumeNode3->GetImageData()->GetPointData()->GetScalars()->GetTuple1(0), 1234);
+  CHECK_DOUBLE(volumeNode3->GetImageData()->GetPointData()->GetScalars()->GetTuple1(1), 1);
+
+#ifdef MRML_USE_vtkTeem
+  // Voxels that start at an odd file offset are read instead of mapped (mapped voxels would be misaligned)
+  const auto oddOffsetFileName = tempFilename(tempDir, "memory_mapped_odd_offset", "nrrd", true);
+  const unsigned short endiannessTest = 1;
+  const bool littleEndian = (*reinterpret_cast<const unsigned char*>(&endiannessTest) == 1);
+  std::string header = std::string("NRRD0004\ntype: short\ndimension: 3\nsizes: 4 3 2\nspacings: 1 1 1\n")
+    + "endian: " + (littleEndian ? "little" : "big") + "\nencoding: raw\n";
+  if ((header.size() + 1) % 2 == 0)
+  {
+    // comment line of odd length
+    header += "# \n";
+  }
+  header += "\n";
+  short voxels[24];
+  for (int voxelIndex = 0; voxelIndex < 24; ++voxelIndex)
+  {
+    voxels[voxelIndex] = static_cast<short>(voxelIndex * 100 - 1000);
+  }
+  {
+    std::ofstream oddOffsetFile(oddOffsetFileName.c_str(), std::ios::out | std::ios::binary);
+    oddOffsetFile.write(header.c_str(), header.size());
+    oddOffsetFile.write(reinterpret_cast<const char*>(voxels), sizeof(voxels));
+  }
+  vtkNew<vtkTeemNRRDReader> oddOffsetReader;
+  oddOffsetReader->SetFileName(oddOffsetFileName.c_str());
+  oddOffsetReader->UseMemoryMappingOn();
+  CHECK_INT(oddOffsetReader->GetRawDataOffset() % 2, 1);
+  CHECK_BOOL(oddOffsetReader->CanUseMemoryMapping(), false);
+  oddOffsetReader->Update();
+  vtkDataArray* oddOffsetVoxels = oddOffsetReader->GetOutput()->GetPointData()->GetScalars();
+  CHECK_NOT_NULL(oddOffsetVoxels);
+  CHECK_BOOL(vtkTeemNRRDReader::IsMemoryMappedArray(oddOffsetVoxels), false);
+  CHECK_INT(oddOffsetVoxels->GetNumberOfTuples(), 24);
+  for (int voxelIndex = 0; voxelIndex < 24; ++voxelIndex)
+  {
+    CHECK_DOUBLE(oddOffsetVoxels->GetTuple1(voxelIndex), voxels[voxelIndex]);
+  }
+#endif
+
+  return EXIT_SUCCESS;
+}
+
 int vtkMRMLVolumeArchetypeStorageNodeTest1(int argc, char* argv[])
 {
   if (argc != 2)
@@ -247,6 +394,7 @@ int vtkMRMLVolumeArchetypeStorageNodeTest1(int argc, char* argv[])
 
   CHECK_EXIT_SUCCESS(TestVoxelVectorType(tempDir, "jpg",  false,     false,   true,  false));
   CHECK_EXIT_SUCCESS(TestFlipsLeftHandedVolumes(tempDir));
+  CHECK_EXIT_SUCCESS(TestMemoryMapping(tempDir));
 
   std::cout << "Test passed." << std::endl;
   return EXIT_SUCCESS;
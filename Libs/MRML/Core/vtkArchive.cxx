@@ -20,6 +20,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 // STD includes
 #include <cstring>
 #include <iostream>
+#include <set>
 
 // VTK include
 #include <vtkObjectFactory.h>
@@ -225,7 +226,10 @@ long copy_data(struct archive *ar, struct archive *aw)
 vtkArchive::vtkArchive() = default;
 
 //----------------------------------------------------------------------------
-vtkArchive::~vtkArchive() = default;
+vtkArchive::~vtkArchive()
+{
+  this->CloseZip();
+}
 
 //----------------------------------------------------------------------------
 void vtkArchive::PrintSelf(ostream& os, vtkIndent indent)
@@ -514,9 +518,12 @@ bool vtkArchive::Zip(const char* zipFileName, const char* directoryToZip)
   return success;
 }
 
+namespace
+{
 //-----------------------------------------------------------------------------
-// unzips zip file into destinationDirectory
-bool vtkArchive::UnZip(const char* zipFileName, const char* destinationDirectory)
+// unzips entries of zip file into destinationDirectory.
+// If entryNames is nullptr then all entries are extracted.
+bool UnZipEntries(const char* zipFileName, const char* destinationDirectory, const std::set<std::string>* entryNames)
 {
   //
   // Unziping the archive
@@ -579,6 +586,7 @@ bool vtkArchive::UnZip(const char* zipFileName, const char* destinationDirectory
   diskDestination = archive_write_disk_new();
   archive_write_disk_set_standard_lookup(diskDestination);
 
+  size_t numberOfExtractedEntries = 0;
   for (;;)
   {
     // for each file entry
@@ -595,6 +603,13 @@ bool vtkArchive::UnZip(const char* zipFileName, const char* destinationDirectory
         break;
       }
     }
+    if (entryNames && entryNames->find(archive_entry_pathname(entry)) == entryNames->end())
+    {
+      // data of skipped entries is not decompressed
+      archive_read_data_skip(zipArchive);
+      continue;
+    }
+    ++numberOfExtractedEntries;
     result = archive_write_header(diskDestination, entry);
     if (result != ARCHIVE_OK)
     {
@@ -672,5 +687,246 @@ bool vtkArchive::UnZip(const char* zipFileName, const char* destinationDirectory
     return false;
   }
 
+  if (entryNames && numberOfExtractedEntries < entryNames->size())
+  {
+    vtkArchiveTools::Error("Unzip:", "some of the requested entries were not found in the archive");
+    return false;
+  }
+
   return (result == ARCHIVE_OK);
 }
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+// unzips zip file into destinationDirectory
+bool vtkArchive::UnZip(const char* zipFileName, const char* destinationDirectory)
+{
+  return UnZipEntries(zipFileName, destinationDirectory, nullptr);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::UnZipFiles(const char* zipFileName, const char* destinationDirectory,
+  const std::vector<std::string>& entryNames)
+{
+  if (entryNames.empty())
+  {
+    return true;
+  }
+  std::set<std::string> entryNameSet(entryNames.begin(), entryNames.end());
+  return UnZipEntries(zipFileName, destinationDirectory, &entryNameSet);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::ReadZipEntry(const char* zipFileName, const char* entryName, std::string& content)
+{
+  content.clear();
+  if (!zipFileName || !entryName)
+  {
+    vtkArchiveTools::Error("ReadZipEntry:", "Invalid zipfile or entry name");
+    return false;
+  }
+  struct archive* zipArchive = archive_read_new();
+  archive_read_support_filter_all(zipArchive);
+  archive_read_support_format_all(zipArchive);
+  if (archive_read_open_filename(zipArchive, zipFileName, 10240) != ARCHIVE_OK)
+  {
+    vtkArchiveTools::Error("ReadZipEntry: cannot open archive file", zipFileName);
+    archive_read_free(zipArchive);
+    return false;
+  }
+  bool found = false;
+  bool success = true;
+  struct archive_entry* entry = nullptr;
+  int result = ARCHIVE_OK;
+  while (!found)
+  {
+    result = archive_read_next_header(zipArchive, &entry);
+    if (result == ARCHIVE_EOF || result < ARCHIVE_WARN)
+    {
+      break;
+    }
+    if (strcmp(archive_entry_pathname(entry), entryName) != 0)
+    {
+      // zip files are read using the central directory, skipped entries are not decompressed
+      archive_read_data_skip(zipArchive);
+      continue;
+    }
+    found = true;
+    char buff[BUFSIZ];
+    la_ssize_t size = 0;
+    while ((size = archive_read_data(zipArchive, buff, sizeof(buff))) > 0)
+    {
+      content.append(buff, static_cast<size_t>(size));
+    }
+    if (size < 0)
+    {
+      vtkArchiveTools::Error("ReadZipEntry: cannot read data:", archive_error_string(zipArchive));
+      success = false;
+    }
+  }
+  if (result < ARCHIVE_WARN)
+  {
+    vtkArchiveTools::Error("ReadZipEntry:", archive_error_string(zipArchive));
+  }
+  archive_read_free(zipArchive);
+  if (!found)
+  {
+    vtkArchiveTools::Error("ReadZipEntry: entry not found:", entryName);
+    return false;
+  }
+  return success;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::OpenZip(const char* zipFileName)
+{
+  this->CloseZip();
+  if (!zipFileName)
+  {
+    vtkArchiveTools::Error("OpenZip:", "Invalid zipfile");
+    return false;
+  }
+  this->ZipWriter = archive_write_new();
+  archive_write_set_format_zip(this->ZipWriter);
+  if (archive_write_open_filename(this->ZipWriter, zipFileName) != ARCHIVE_OK)
+  {
+    vtkArchiveTools::Error("OpenZip: open output file:", archive_error_string(this->ZipWriter));
+    archive_write_free(this->ZipWriter);
+    this->ZipWriter = nullptr;
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::WriteZipEntryHeader(const char* entryName, bool directory, vtkTypeInt64 size, bool compress)
+{
+  if (!this->ZipWriter || !entryName)
+  {
+    vtkArchiveTools::Error("Zip:", "Archive is not open or invalid entry name");
+    return false;
+  }
+  // deflate is not available if libarchive was built without zlib, store the entry then
+  int result = ARCHIVE_FAILED;
+  if (compress)
+  {
+    result = archive_write_zip_set_compression_deflate(this->ZipWriter);
+  }
+  if (result != ARCHIVE_OK)
+  {
+    result = archive_write_zip_set_compression_store(this->ZipWriter);
+  }
+  if (result != ARCHIVE_OK)
+  {
+    vtkArchiveTools::Error("Zip: set compression:", archive_error_string(this->ZipWriter));
+    return false;
+  }
+  struct archive_entry* entry = archive_entry_new();
+  archive_entry_copy_pathname(entry, entryName);
+  // use a fixed modification time (1980-01-01) so that the archive content
+  // only depends on the entries
+  archive_entry_set_mtime(entry, 315532800, 0);
+  if (directory)
+  {
+    archive_entry_set_filetype(entry, AE_IFDIR);
+    archive_entry_set_perm(entry, 0755);
+  }
+  else
+  {
+    archive_entry_set_filetype(entry, AE_IFREG);
+    archive_entry_set_perm(entry, 0644);
+    archive_entry_set_size(entry, size);
+  }
+  result = archive_write_header(this->ZipWriter, entry);
+  archive_entry_free(entry);
+  if (result != ARCHIVE_OK)
+  {
+    vtkArchiveTools::Error("Zip: write file header:", archive_error_string(this->ZipWriter));
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::AddZipDirectoryEntry(const char* entryName)
+{
+  return this->WriteZipEntryHeader(entryName, true, 0, false);
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::AddZipFileEntry(const char* entryName, const char* fileName, bool compress/*=true*/)
+{
+  if (!fileName)
+  {
+    vtkArchiveTools::Error("Zip:", "Invalid file name");
+    return false;
+  }
+  FILE* fd = vtksys::SystemTools::Fopen(fileName, "rb");
+  if (!fd)
+  {
+    vtkArchiveTools::Error("Zip: cannot open input file:", fileName);
+    return false;
+  }
+  vtkTypeInt64 fileLength = static_cast<vtkTypeInt64>(vtksys::SystemTools::FileLength(fileName));
+  if (!this->WriteZipEntryHeader(entryName, false, fileLength, compress))
+  {
+    fclose(fd);
+    return false;
+  }
+  bool success = true;
+  char buff[BUFSIZ];
+  size_t len = 0;
+  while (success && (len = fread(buff, sizeof(char), sizeof(buff), fd)) > 0)
+  {
+    if (archive_write_data(this->ZipWriter, buff, len) < 0)
+    {
+      vtkArchiveTools::Error("Zip: cannot write data:", archive_error_string(this->ZipWriter));
+      success = false;
+    }
+  }
+  fclose(fd);
+  return success;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::AddZipDataEntry(const char* entryName, const char* data, size_t size, bool compress/*=true*/)
+{
+  if (!data && size > 0)
+  {
+    vtkArchiveTools::Error("Zip:", "Invalid data");
+    return false;
+  }
+  if (!this->WriteZipEntryHeader(entryName, false, static_cast<vtkTypeInt64>(size), compress))
+  {
+    return false;
+  }
+  if (size > 0 && archive_write_data(this->ZipWriter, data, size) < 0)
+  {
+    vtkArchiveTools::Error("Zip: cannot write data:", archive_error_string(this->ZipWriter));
+    return false;
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkArchive::CloseZip()
+{
+  if (!this->ZipWriter)
+  {
+    return true;
+  }
+  bool success = true;
+  if (archive_write_close(this->ZipWriter) != ARCHIVE_OK)
+  {
+    vtkArchiveTools::Error("Zip: close archive", archive_error_string(this->ZipWriter));
+    success = false;
+  }
+  if (archive_write_free(this->ZipWriter) != ARCHIVE_OK)
+  {
+    vtkArchiveTools::Error("Zip: cleanup", "");
+    success = false;
+  }
+  this->ZipWriter = nullptr;
+  return success;
+}
@@ -20,6 +20,8 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 #include <string>
 #include <vector>
 
+struct archive;
+
 /// \brief Simple class for manipulating archive files
 ///
 class VTK_MRML_EXPORT vtkArchive : public vtkObject
@@ -43,11 +45,38 @@ public:
   // (internally this supports many formats of archive, not just zip)
   static bool UnZip(const char* zipFileName, const char *destinationDirectory);
 
+  // unzips only the listed entries of the zip file into specified directory.
+  // Entry names are paths within the archive, as returned by ListArchive().
+  static bool UnZipFiles(const char* zipFileName, const char* destinationDirectory,
+    const std::vector<std::string>& entryNames);
+
+  // reads an entry of the zip file into memory, without extracting it to disk.
+  // Entry name is a path within the archive, as returned by ListArchive().
+  static bool ReadZipEntry(const char* zipFileName, const char* entryName, std::string& content);
+
+  // Streaming zip writer: OpenZip() creates the zip file, entries are then appended
+  // in the order of the Add...Entry() calls and compressed while they are written,
+  // and CloseZip() writes the central directory. Entries are not staged on disk.
+  // Entry names are paths within the archive (directory entries end with "/").
+  // All entries get the same modification time, therefore the archive only
+  // depends on the entries and their order.
+  bool OpenZip(const char* zipFileName);
+  bool AddZipDirectoryEntry(const char* entryName);
+  // If compress is false then the entry is stored without compression
+  // (e.g., for files that are already compressed).
+  bool AddZipFileEntry(const char* entryName, const char* fileName, bool compress = true);
+  bool AddZipDataEntry(const char* entryName, const char* data, size_t size, bool compress = true);
+  bool CloseZip();
+
 protected:
   vtkArchive();
   ~vtkArchive() override;
   vtkArchive(const vtkArchive&);
   void operator=(const vtkArchive&);
+
+  bool WriteZipEntryHeader(const char* entryName, bool directory, vtkTypeInt64 size, bool compress);
+
+  struct archive* ZipWriter{ nullptr };
 };
 
 #endif
@@ -22,6 +22,11 @@
 #include <vtkObjectFactory.h>
 #include <vtkTimerLog.h>
 
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
 vtkCxxSetObjectMacro(vtkEventBroker, TimerLog, vtkTimerLog);
 vtkCxxSetObjectMacro(vtkEventBroker, RequestModifiedCallback, vtkCallbackCommand);
 
@@ -88,6 +93,239 @@ vtkEventBroker* vtkEventBroker::GetInstance()
   return vtkEventBrokerInstance;
 }
 
+//----------------------------------------------------------------------------
+namespace
+{
+//----------------------------------------------------------------------------
+std::string GetEventName(unsigned long event)
+{
+  const char* eventName = vtkCommand::GetStringFromEventId(event);
+  if (!strcmp(eventName, "NoEvent"))
+  {
+    return std::to_string(event);
+  }
+  return eventName;
+}
+}
+
+//----------------------------------------------------------------------------
+class vtkEventBroker::vtkInternal
+{
+public:
+  /// Statistics of a (subject class, event, observer) triple
+  struct ProfileEntry
+  {
+    std::string SubjectClassName;
+    unsigned long Event{ 0 };
+    std::string ObserverName;
+    int InvocationCount{ 0 };
+    double TotalTime{ 0.0 };
+    double SelfTime{ 0.0 };
+    int MaximumNestingLevel{ 0 };
+    /// Number of invocations of this entry that are currently running (for recursive invocations)
+    int ActiveCount{ 0 };
+  };
+
+  /// Node of the tree of observer call chains. Node 0 is the root.
+  struct CallTreeNode
+  {
+    int Parent{ -1 };
+    int EntryIndex{ -1 };
+    std::map<int, int> Children;
+    double SelfTime{ 0.0 };
+  };
+
+  struct ActiveInvocation
+  {
+    int NodeIndex;
+    double ChildTime;
+  };
+
+  vtkInternal()
+  {
+    this->Reset();
+  }
+
+  int GetEntryIndex(vtkObservation* observation, unsigned long eid);
+  int StartInvocation(vtkObservation* observation, unsigned long eid, int nestingLevel);
+  void EndInvocation(int nodeIndex, double elapsedTime);
+  void Reset();
+  ProfileEntry* GetSortedEntry(int n);
+  std::string GetFrameName(int entryIndex);
+
+  std::vector<ProfileEntry> Entries;
+  /// Class names returned by GetClassName() are static strings, therefore
+  /// entries can be looked up by pointer, without string comparisons.
+  std::map<std::tuple<const char*, unsigned long, const char*>, int> EntryIndexByClassNamePointer;
+  std::map<std::tuple<std::string, unsigned long, std::string>, int> EntryIndexByName;
+  std::vector<CallTreeNode> CallTree;
+  std::vector<ActiveInvocation> ActiveInvocations;
+  std::vector<int> SortedEntryIndices;
+  bool SortedEntryIndicesValid{ false };
+};
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::vtkInternal::GetEntryIndex(vtkObservation* observation, unsigned long eid)
+{
+  const char* subjectClassName = observation->GetSubject() ? observation->GetSubject()->GetClassName() : "No subject class";
+  const char* observerClassName = nullptr;
+  if (observation->GetScript() == nullptr)
+  {
+    observerClassName = observation->GetObserver() ? observation->GetObserver()->GetClassName() : "No observer class";
+    auto entryIt = this->EntryIndexByClassNamePointer.find(std::make_tuple(subjectClassName, eid, observerClassName));
+    if (entryIt != this->EntryIndexByClassNamePointer.end())
+    {
+      return entryIt->second;
+    }
+  }
+
+  std::string observerName = observerClassName ? observerClassName : observation->GetScript();
+  auto key = std::make_tuple(std::string(subjectClassName), eid, observerName);
+  int entryIndex = -1;
+  auto entryIt = this->EntryIndexByName.find(key);
+  if (entryIt != this->EntryIndexByName.end())
+  {
+    entryIndex = entryIt->second;
+  }
+  else
+  {
+    ProfileEntry entry;
+    entry.SubjectClassName = subjectClassName;
+    entry.Event = eid;
+    entry.ObserverName = observerName;
+    entryIndex = static_cast<int>(this->Entries.size());
+    this->Entries.push_back(entry);
+    this->EntryIndexByName[key] = entryIndex;
+  }
+  if (observerClassName)
+  {
+    this->EntryIndexByClassNamePointer[std::make_tuple(subjectClassName, eid, observerClassName)] = entryIndex;
+  }
+  return entryIndex;
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::vtkInternal::StartInvocation(vtkObservation* observation, unsigned long eid, int nestingLevel)
+{
+  int entryIndex = this->GetEntryIndex(observation, eid);
+  ProfileEntry& entry = this->Entries[entryIndex];
+  entry.ActiveCount++;
+  entry.MaximumNestingLevel = std::max(entry.MaximumNestingLevel, nestingLevel);
+
+  int parentNodeIndex = this->ActiveInvocations.empty() ? 0 : this->ActiveInvocations.back().NodeIndex;
+  int nodeIndex = -1;
+  auto childIt = this->CallTree[parentNodeIndex].Children.find(entryIndex);
+  if (childIt != this->CallTree[parentNodeIndex].Children.end())
+  {
+    nodeIndex = childIt->second;
+  }
+  else
+  {
+    nodeIndex = static_cast<int>(this->CallTree.size());
+    CallTreeNode node;
+    node.Parent = parentNodeIndex;
+    node.EntryIndex = entryIndex;
+    this->CallTree.push_back(node);
+    this->CallTree[parentNodeIndex].Children[entryIndex] = nodeIndex;
+  }
+  this->ActiveInvocations.push_back(ActiveInvocation{ nodeIndex, 0.0 });
+  return nodeIndex;
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::vtkInternal::EndInvocation(int nodeIndex, double elapsedTime)
+{
+  if (this->ActiveInvocations.empty() || this->ActiveInvocations.back().NodeIndex != nodeIndex)
+  {
+    // profile was reset while the observation was running
+    return;
+  }
+  double selfTime = std::max(0.0, elapsedTime - this->ActiveInvocations.back().ChildTime);
+  this->ActiveInvocations.pop_back();
+  if (!this->ActiveInvocations.empty())
+  {
+    this->ActiveInvocations.back().ChildTime += elapsedTime;
+  }
+
+  CallTreeNode& node = this->CallTree[nodeIndex];
+  node.SelfTime += selfTime;
+  ProfileEntry& entry = this->Entries[node.EntryIndex];
+  entry.InvocationCount++;
+  entry.SelfTime += selfTime;
+  entry.ActiveCount--;
+  if (entry.ActiveCount == 0)
+  {
+    // Only the outermost invocation is counted in total time to not count recursive invocations multiple times
+    entry.TotalTime += elapsedTime;
+  }
+  this->SortedEntryIndicesValid = false;
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::vtkInternal::Reset()
+{
+  this->SortedEntryIndicesValid = false;
+  if (!this->ActiveInvocations.empty())
+  {
+    // Observations are running, only clear the statistics to keep the running invocations valid
+    for (ProfileEntry& entry : this->Entries)
+    {
+      entry.InvocationCount = 0;
+      entry.TotalTime = 0.0;
+      entry.SelfTime = 0.0;
+      entry.MaximumNestingLevel = 0;
+    }
+    for (CallTreeNode& node : this->CallTree)
+    {
+      node.SelfTime = 0.0;
+    }
+    return;
+  }
+  this->Entries.clear();
+  this->EntryIndexByClassNamePointer.clear();
+  this->EntryIndexByName.clear();
+  this->CallTree.clear();
+  this->CallTree.emplace_back();
+}
+
+//----------------------------------------------------------------------------
+vtkEventBroker::vtkInternal::ProfileEntry* vtkEventBroker::vtkInternal::GetSortedEntry(int n)
+{
+  if (!this->SortedEntryIndicesValid)
+  {
+    this->SortedEntryIndices.clear();
+    for (int entryIndex = 0; entryIndex < static_cast<int>(this->Entries.size()); ++entryIndex)
+    {
+      if (this->Entries[entryIndex].InvocationCount > 0)
+      {
+        this->SortedEntryIndices.push_back(entryIndex);
+      }
+    }
+    std::stable_sort(this->SortedEntryIndices.begin(), this->SortedEntryIndices.end(),
+      [this](int entryIndex1, int entryIndex2)
+      {
+        return this->Entries[entryIndex1].SelfTime > this->Entries[entryIndex2].SelfTime;
+      });
+    this->SortedEntryIndicesValid = true;
+  }
+  if (n < 0 || n >= static_cast<int>(this->SortedEntryIndices.size()))
+  {
+    return nullptr;
+  }
+  return &this->Entries[this->SortedEntryIndices[n]];
+}
+
+//----------------------------------------------------------------------------
+std::string vtkEventBroker::vtkInternal::GetFrameName(int entryIndex)
+{
+  const ProfileEntry& entry = this->Entries[entryIndex];
+  std::string frameName = entry.SubjectClassName + ":" + GetEventName(entry.Event) + " -> " + entry.ObserverName;
+  // semicolon separates frames and newline separates stacks in the folded format
+  std::replace(frameName.begin(), frameName.end(), ';', ',');
+  std::replace(frameName.begin(), frameName.end(), '\n', ' ');
+  return frameName;
+}
+
 //----------------------------------------------------------------------------
 vtkEventBroker::vtkEventBroker()
 {
@@ -100,6 +338,8 @@ vtkEventBroker::vtkEventBroker()
   this->ScriptHandler = nullptr;
   this->ScriptHandlerClientData = nullptr;
   this->RequestModifiedCallback = nullptr;
+  this->EventProfiling = false;
+  this->Internal = new vtkInternal;
 }
 
 //----------------------------------------------------------------------------
@@ -124,6 +364,8 @@ vtkEventBroker::~vtkEventBroker()
   {
     this->RequestModifiedCallback->Delete();
   }
+
+  delete this->Internal;
   //cout << "vtkEventBroker singleton Deleted" << endl;
 }
 
@@ -821,6 +1063,12 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
 
   double startTime = this->TimerLog->GetUniversalTime();
 
+  int profileNodeIndex = -1;
+  if (this->EventProfiling)
+  {
+    profileNodeIndex = this->Internal->StartInvocation(observation, eid, this->EventNestingLevel);
+  }
+
   // Register so observation won't be deleted while callback is running
   observation->Register(this);
 
@@ -848,6 +1096,10 @@ void vtkEventBroker::InvokeObservation ( vtkObservation *observation,
   double elapsedTime = this->TimerLog->GetUniversalTime() - startTime;
   observation->SetTotalElapsedTime (observation->GetTotalElapsedTime() + elapsedTime);
   observation->SetLastElapsedTime (elapsedTime);
+  if (profileNodeIndex >= 0)
+  {
+    this->Internal->EndInvocation(profileNodeIndex, elapsedTime);
+  }
   this->LogEvent (observation);
 
   // clear reference to observation (may cause delete)
@@ -889,6 +1141,122 @@ void vtkEventBroker::ProcessEventQueue ()
   }
 }
 
+//----------------------------------------------------------------------------
+void vtkEventBroker::ResetEventProfile()
+{
+  this->Internal->Reset();
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::GetNumberOfProfiledObservations()
+{
+  // make sure sorted entry list is up-to-date
+  this->Internal->GetSortedEntry(0);
+  return static_cast<int>(this->Internal->SortedEntryIndices.size());
+}
+
+//----------------------------------------------------------------------------
+std::string vtkEventBroker::GetProfiledSubjectClassName(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->SubjectClassName : std::string();
+}
+
+//----------------------------------------------------------------------------
+unsigned long vtkEventBroker::GetProfiledEvent(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->Event : vtkCommand::NoEvent;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkEventBroker::GetProfiledObserverName(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->ObserverName : std::string();
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::GetProfiledInvocationCount(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->InvocationCount : 0;
+}
+
+//----------------------------------------------------------------------------
+double vtkEventBroker::GetProfiledTotalTime(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->TotalTime : 0.0;
+}
+
+//----------------------------------------------------------------------------
+double vtkEventBroker::GetProfiledSelfTime(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->SelfTime : 0.0;
+}
+
+//----------------------------------------------------------------------------
+int vtkEventBroker::GetProfiledMaximumNestingLevel(int n)
+{
+  vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+  return entry ? entry->MaximumNestingLevel : 0;
+}
+
+//----------------------------------------------------------------------------
+void vtkEventBroker::PrintEventProfile(ostream& os)
+{
+  os << "SubjectClass\tEvent\tObserver\tInvocationCount\tTotalTime\tSelfTime\tMaximumNestingLevel\n";
+  int numberOfEntries = this->GetNumberOfProfiledObservations();
+  for (int n = 0; n < numberOfEntries; ++n)
+  {
+    vtkInternal::ProfileEntry* entry = this->Internal->GetSortedEntry(n);
+    os << entry->SubjectClassName << "\t" << GetEventName(entry->Event) << "\t" << entry->ObserverName << "\t"
+      << entry->InvocationCount << "\t" << entry->TotalTime << "\t" << entry->SelfTime << "\t"
+      << entry->MaximumNestingLevel << "\n";
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkEventBroker::WriteEventProfileFlameGraph(const char* fileName)
+{
+  if (!fileName)
+  {
+    vtkErrorMacro("WriteEventProfileFlameGraph failed: invalid filename");
+    return false;
+  }
+  std::ofstream file(fileName);
+  if (!file.is_open())
+  {
+    vtkErrorMacro("WriteEventProfileFlameGraph failed: cannot open file " << fileName);
+    return false;
+  }
+  // Depth-first traversal of the call tree, keeping the call chain of each node
+  std::vector<std::pair<int, std::string> > nodesToVisit;
+  for (const auto& child : this->Internal->CallTree[0].Children)
+  {
+    nodesToVisit.emplace_back(child.second, this->Internal->GetFrameName(child.first));
+  }
+  while (!nodesToVisit.empty())
+  {
+    int nodeIndex = nodesToVisit.back().first;
+    std::string stack = nodesToVisit.back().second;
+    nodesToVisit.pop_back();
+    const vtkInternal::CallTreeNode& node = this->Internal->CallTree[nodeIndex];
+    long long selfTimeUsec = std::llround(node.SelfTime * 1e6);
+    if (selfTimeUsec > 0)
+    {
+      file << stack << " " << selfTimeUsec << "\n";
+    }
+    for (const auto& child : node.Children)
+    {
+      nodesToVisit.emplace_back(child.second, stack + ";" + this->Internal->GetFrameName(child.first));
+    }
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkEventBroker::PrintSelf(ostream& os, vtkIndent indent)
 {
@@ -898,6 +1266,7 @@ void vtkEventBroker::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "NumberOfQueueObservations: " << this->GetNumberOfQueuedObservations() << "\n";
   os << indent << "EventMode: " << this->GetEventModeAsString() << "\n";
   os << indent << "EventLogging: " << this->EventLogging << "\n";
+  os << indent << "EventProfiling: " << this->EventProfiling << "\n";
   os << indent << "EventNestingLevel: " << this->EventNestingLevel << "\n";
   os << indent << "LogFileName: " <<
     (this->LogFileName ? this->LogFileName : "(none)") << "\n";
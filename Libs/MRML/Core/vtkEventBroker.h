@@ -28,6 +28,7 @@ class vtkTimerLog;
 #include <set>
 #include <map>
 #include <fstream>
+#include <string>
 
 class vtkCollection;
 class vtkCallbackCommand;
@@ -173,6 +174,45 @@ public:
   /// Write out the current list of observations in graphviz format (.dot)
   int GenerateGraphFile ( const char *graphFile );
 
+  /// Event Profiling
+  ///
+  /// When profiling is enabled, each invocation of an observation is recorded
+  /// for its (subject class, event, observer) triple: number of invocations,
+  /// total time (including nested observations), self time (excluding nested
+  /// observations) and maximum nesting level. When profiling is disabled
+  /// (default) the overhead is a single check per invocation.
+  /// \sa ResetEventProfile, WriteEventProfileFlameGraph
+  vtkBooleanMacro (EventProfiling, bool);
+  vtkSetMacro (EventProfiling, bool);
+  vtkGetMacro (EventProfiling, bool);
+  ///
+  /// Clear all recorded profiling information
+  void ResetEventProfile();
+  ///
+  /// Number of distinct (subject class, event, observer) triples
+  /// that have been invoked since profiling was reset.
+  int GetNumberOfProfiledObservations();
+  ///
+  /// Accessors for the profiled observations. Times are in seconds.
+  /// Entries are sorted by decreasing self time.
+  std::string GetProfiledSubjectClassName(int n);
+  unsigned long GetProfiledEvent(int n);
+  std::string GetProfiledObserverName(int n);
+  int GetProfiledInvocationCount(int n);
+  double GetProfiledTotalTime(int n);
+  double GetProfiledSelfTime(int n);
+  int GetProfiledMaximumNestingLevel(int n);
+  ///
+  /// Write the profile as a table (tab-separated values) to the stream
+  void PrintEventProfile(ostream& os);
+  ///
+  /// Write the self time of each observer call chain in "folded stacks" format,
+  /// which can be converted to a flame graph (for example by flamegraph.pl or speedscope).
+  /// Each line contains the chain of observations separated by ";" and the self
+  /// time in microseconds.
+  /// Returns false if the file cannot be written.
+  bool WriteEventProfileFlameGraph(const char* fileName);
+
 
   /// Event Queue processing modes
   ///
@@ -290,6 +330,7 @@ protected:
   void *ScriptHandlerClientData;
 
   int EventLogging;
+  bool EventProfiling;
   int EventNestingLevel;
   char *LogFileName;
   vtkTimerLog *TimerLog;
@@ -301,6 +342,9 @@ protected:
 
   vtkCallbackCommand* RequestModifiedCallback;
 
+  class vtkInternal;
+  vtkInternal* Internal;
+
 private:
   /// DetachObservations is a fast (but dangerous) method to delete all the
   /// observations. It leaves the event broker in an inconsistent state:
@@ -495,6 +495,17 @@ bool vtkMRMLColorNode::GetModifiedSinceRead()
      this->GetScalarsToColors()->GetMTime() > this->GetStoredTime());
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLColorNode::GetContentMTime()
+{
+  vtkMTimeType contentMTime = this->Superclass::GetContentMTime();
+  if (this->GetScalarsToColors())
+  {
+    contentMTime = std::max(contentMTime, this->GetScalarsToColors()->GetMTime());
+  }
+  return contentMTime;
+}
+
 //---------------------------------------------------------------------------
 vtkLookupTable* vtkMRMLColorNode::CreateLookupTableCopy()
 {
@@ -188,6 +188,9 @@ public:
   /// \sa vtkMRMLStorableNode::GetModifiedSinceRead()
   bool GetModifiedSinceRead() override;
 
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
   /// The list of valid color node types, added to in subclasses
   /// For backward compatibility, User and File keep the numbers that
   /// were in the ColorTable node
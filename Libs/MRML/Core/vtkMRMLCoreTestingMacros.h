@@ -389,6 +389,12 @@
   object->Set##variable( originalString );  \
   }
 
+/// Reports a numeric value (such as an execution time) as a test measurement,
+/// which is displayed on the dashboard and can be tracked over time.
+#define PRINT_DART_MEASUREMENT( name, value ) \
+  std::cout << "<DartMeasurement name=\"" << (name) << "\" type=\"numeric/double\">" \
+    << (value) << "</DartMeasurement>" << std::endl;
+
 #define EXERCISE_BASIC_OBJECT_METHODS( node )                                        \
   {                                                                                  \
   int result = vtkMRMLCoreTestingUtilities::ExerciseBasicObjectMethods(node);        \
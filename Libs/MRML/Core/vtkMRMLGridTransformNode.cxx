@@ -17,11 +17,19 @@ Version:   $Revision: 1.14 $
 
 // VTK includes
 #include <vtkOrientedGridTransform.h>
+#include <vtkDataArray.h>
 #include <vtkImageData.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 
 // STD includes
+#include <algorithm>
+#include <functional>
 #include <sstream>
 
 //----------------------------------------------------------------------------
@@ -55,16 +63,352 @@ vtkMRMLGridTransformNode::~vtkMRMLGridTransformNode()
 void vtkMRMLGridTransformNode::WriteXML(ostream& of, int nIndent)
 {
   Superclass::WriteXML(of, nIndent);
+
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLBooleanMacro(precomputedInverse, PrecomputedInverse);
+  vtkMRMLWriteXMLEndMacro();
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLGridTransformNode::ReadXMLAttributes(const char** atts)
 {
+  MRMLNodeModifyBlocker blocker(this);
+
   Superclass::ReadXMLAttributes(atts);
+
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLBooleanMacro(precomputedInverse, PrecomputedInverse);
+  vtkMRMLReadXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=true*/)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::CopyContent(anode, deepCopy);
+
+  vtkMRMLGridTransformNode* node = vtkMRMLGridTransformNode::SafeDownCast(anode);
+  if (!node)
+  {
+    return;
+  }
+  this->SetPrecomputedInverse(node->PrecomputedInverse);
 }
 
 //----------------------------------------------------------------------------
 void vtkMRMLGridTransformNode::PrintSelf(ostream& os, vtkIndent indent)
 {
   Superclass::PrintSelf(os,indent);
+
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintBooleanMacro(PrecomputedInverse);
+  vtkMRMLPrintEndMacro();
+  if (this->PrecomputedInverseTransform)
+  {
+    os << indent << "PrecomputedInverseNumberOfNonConvergedPoints: "
+      << this->PrecomputedInverseNumberOfNonConvergedPoints << "\n";
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLGridTransformNode::GetTransformToParentForEvaluation()
+{
+  // Only the transform that is computed from the inverse of the stored transform is replaced
+  if (this->PrecomputedInverseTransform && !this->TransformToParent)
+  {
+    return this->PrecomputedInverseTransform;
+  }
+  return Superclass::GetTransformToParentForEvaluation();
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLGridTransformNode::GetTransformFromParentForEvaluation()
+{
+  // Only the transform that is computed from the inverse of the stored transform is replaced
+  if (this->PrecomputedInverseTransform && !this->TransformFromParent)
+  {
+    return this->PrecomputedInverseTransform;
+  }
+  return Superclass::GetTransformFromParentForEvaluation();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::TransformModified()
+{
+  // Update the inverse before observers are notified about the change
+  this->UpdatePrecomputedInverse();
+  Superclass::TransformModified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::SetPrecomputedInverse(bool enable)
+{
+  if (this->PrecomputedInverse == enable)
+  {
+    return;
+  }
+  this->PrecomputedInverse = enable;
+  this->Modified();
+  // Inverse transform is computed differently (the precomputed inverse is computed
+  // or released in TransformModified)
+  this->TransformModified();
+}
+
+//----------------------------------------------------------------------------
+vtkOrientedGridTransform* vtkMRMLGridTransformNode::GetPrecomputableGridTransform()
+{
+  vtkAbstractTransform* storedTransform = nullptr;
+  if (this->TransformFromParent && !this->TransformToParent)
+  {
+    storedTransform = this->TransformFromParent;
+  }
+  else if (this->TransformToParent && !this->TransformFromParent)
+  {
+    storedTransform = this->TransformToParent;
+  }
+  vtkOrientedGridTransform* gridTransform = vtkOrientedGridTransform::SafeDownCast(storedTransform);
+  if (!gridTransform || gridTransform->GetInverseFlag() || !gridTransform->GetDisplacementGrid())
+  {
+    return nullptr;
+  }
+  return gridTransform;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLGridTransformNode::ReleasePrecomputedInverse()
+{
+  this->PrecomputedInverseTransform = nullptr;
+  this->PrecomputedInverseConvergenceMask = nullptr;
+  this->PrecomputedInverseSourceTransform = nullptr;
+  this->PrecomputedInverseNumberOfNonConvergedPoints = 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLGridTransformNode::UpdatePrecomputedInverse()
+{
+  vtkOrientedGridTransform* forwardTransform = this->PrecomputedInverse ? this->GetPrecomputableGridTransform() : nullptr;
+  if (!forwardTransform)
+  {
+    this->ReleasePrecomputedInverse();
+    return false;
+  }
+  vtkMTimeType forwardTransformMTime = std::max(forwardTransform->GetMTime(),
+    forwardTransform->GetDisplacementGrid()->GetMTime());
+  if (this->PrecomputedInverseTransform
+    && this->PrecomputedInverseSourceTransform == forwardTransform
+    && this->PrecomputedInverseSourceMTime == forwardTransformMTime)
+  {
+    // up-to-date
+    return true;
+  }
+
+  if (!this->PrecomputedInverseTransform)
+  {
+    // The same transform object is kept when the inverse is recomputed so that
+    // transforms that the inverse is concatenated into remain valid.
+    this->PrecomputedInverseTransform = vtkSmartPointer<vtkOrientedGridTransform>::New();
+    this->PrecomputedInverseConvergenceMask = vtkSmartPointer<vtkImageData>::New();
+  }
+  vtkIdType numberOfNonConvergedPoints = vtkMRMLGridTransformNode::ComputeInverseDisplacementField(
+    forwardTransform, this->PrecomputedInverseTransform, this->PrecomputedInverseConvergenceMask);
+  if (numberOfNonConvergedPoints < 0)
+  {
+    vtkErrorMacro("vtkMRMLGridTransformNode::UpdatePrecomputedInverse failed: cannot compute inverse displacement field");
+    this->ReleasePrecomputedInverse();
+    return false;
+  }
+  if (numberOfNonConvergedPoints > 0)
+  {
+    vtkWarningMacro("vtkMRMLGridTransformNode::UpdatePrecomputedInverse: inverse did not converge at "
+      << numberOfNonConvergedPoints << " grid points, the inverse transform is only approximate at these points");
+  }
+  this->PrecomputedInverseNumberOfNonConvergedPoints = numberOfNonConvergedPoints;
+  this->PrecomputedInverseSourceTransform = forwardTransform;
+  this->PrecomputedInverseSourceMTime = forwardTransformMTime;
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkImageData* vtkMRMLGridTransformNode::GetPrecomputedInverseConvergenceMask()
+{
+  return this->PrecomputedInverseConvergenceMask;
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkMRMLGridTransformNode::ComputeInverseDisplacementField(vtkOrientedGridTransform* forwardTransform,
+  vtkOrientedGridTransform* inverseTransform, vtkImageData* convergenceMask/*=nullptr*/, int numberOfThreads/*=0*/)
+{
+  if (!forwardTransform || !inverseTransform || forwardTransform == inverseTransform)
+  {
+    vtkGenericWarningMacro("vtkMRMLGridTransformNode::ComputeInverseDisplacementField failed: invalid input");
+    return -1;
+  }
+  vtkImageData* forwardDisplacementField = forwardTransform->GetDisplacementGrid();
+  if (!forwardDisplacementField || forwardDisplacementField->GetNumberOfScalarComponents() != 3)
+  {
+    vtkGenericWarningMacro("vtkMRMLGridTransformNode::ComputeInverseDisplacementField failed: invalid displacement field");
+    return -1;
+  }
+
+  // Grid point index to world transform (the same way as in vtkOrientedGridTransform)
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  forwardDisplacementField->GetOrigin(origin);
+  forwardDisplacementField->GetSpacing(spacing);
+  forwardDisplacementField->GetExtent(extent);
+  vtkMatrix4x4* gridDirection = forwardTransform->GetGridDirectionMatrix();
+  double ijkToWorld[3][4] = { { 0.0 } };
+  for (int row = 0; row < 3; row++)
+  {
+    for (int col = 0; col < 3; col++)
+    {
+      double direction = gridDirection ? gridDirection->GetElement(row, col) : (row == col ? 1.0 : 0.0);
+      ijkToWorld[row][col] = direction * spacing[col];
+    }
+    ijkToWorld[row][3] = origin[row];
+  }
+
+  // Integer displacement fields are stored with scale and shift, which do not apply to the inverse
+  int scalarType = forwardDisplacementField->GetScalarType();
+  if (scalarType != VTK_FLOAT)
+  {
+    scalarType = VTK_DOUBLE;
+  }
+  vtkNew<vtkImageData> inverseDisplacementField;
+  inverseDisplacementField->SetExtent(extent);
+  inverseDisplacementField->SetOrigin(origin);
+  inverseDisplacementField->SetSpacing(spacing);
+  inverseDisplacementField->AllocateScalars(scalarType, 3);
+  vtkDataArray* inverseDisplacements = inverseDisplacementField->GetPointData()->GetScalars();
+
+  unsigned char* converged = nullptr;
+  if (convergenceMask)
+  {
+    convergenceMask->Initialize();
+    convergenceMask->SetExtent(extent);
+    convergenceMask->SetOrigin(origin);
+    convergenceMask->SetSpacing(spacing);
+    convergenceMask->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+    converged = static_cast<unsigned char*>(convergenceMask->GetScalarPointer());
+  }
+
+  // Transform evaluation is thread-safe after the transform is updated
+  forwardTransform->Update();
+  const double tolerance = forwardTransform->GetInverseTolerance();
+  const int maximumNumberOfIterations = forwardTransform->GetInverseIterations();
+  const int dimensions[3] = { extent[1] - extent[0] + 1, extent[3] - extent[2] + 1, extent[5] - extent[4] + 1 };
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(dimensions[0]) * dimensions[1] * dimensions[2];
+  vtkSMPThreadLocal<vtkIdType> numberOfNonConvergedPointsInThread(0);
+
+  std::function<void(vtkIdType, vtkIdType)> computeInverseDisplacements = [&](vtkIdType begin, vtkIdType end)
+  {
+    vtkIdType& numberOfNonConvergedPointsInRange = numberOfNonConvergedPointsInThread.Local();
+    for (vtkIdType pointIndex = begin; pointIndex < end; ++pointIndex)
+    {
+      const double ijk[3] =
+      {
+        static_cast<double>(extent[0] + pointIndex % dimensions[0]),
+        static_cast<double>(extent[2] + (pointIndex / dimensions[0]) % dimensions[1]),
+        static_cast<double>(extent[4] + pointIndex / (static_cast<vtkIdType>(dimensions[0]) * dimensions[1]))
+      };
+      double target[3] = { 0.0, 0.0, 0.0 };
+      for (int row = 0; row < 3; row++)
+      {
+        target[row] = ijkToWorld[row][0] * ijk[0] + ijkToWorld[row][1] * ijk[1] + ijkToWorld[row][2] * ijk[2] + ijkToWorld[row][3];
+      }
+
+      // Solve forward(point) = target using Newton's method.
+      // Initial guess: subtract the displacement at the target point.
+      double point[3] = { 0.0, 0.0, 0.0 };
+      double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+      double derivative[3][3];
+      forwardTransform->InternalTransformPoint(target, transformedPoint);
+      for (int i = 0; i < 3; i++)
+      {
+        point[i] = 2.0 * target[i] - transformedPoint[i];
+      }
+      double residual[3] = { 0.0, 0.0, 0.0 };
+      double lastStep[3] = { 0.0, 0.0, 0.0 };
+      double errorSquared = VTK_DOUBLE_MAX;
+      bool pointConverged = false;
+      for (int iteration = 0; iteration < maximumNumberOfIterations; iteration++)
+      {
+        forwardTransform->InternalTransformDerivative(point, transformedPoint, derivative);
+        for (int i = 0; i < 3; i++)
+        {
+          residual[i] = transformedPoint[i] - target[i];
+        }
+        double newErrorSquared = vtkMath::Dot(residual, residual);
+        if (newErrorSquared < tolerance * tolerance)
+        {
+          pointConverged = true;
+          break;
+        }
+        if (newErrorSquared > errorSquared)
+        {
+          // The error increased, therefore the last step was too large: go back half of the step
+          for (int i = 0; i < 3; i++)
+          {
+            lastStep[i] *= 0.5;
+            point[i] += lastStep[i];
+          }
+          continue;
+        }
+        errorSquared = newErrorSquared;
+        if (vtkMath::Determinant3x3(derivative) == 0.0)
+        {
+          // singular transform, cannot be inverted here
+          break;
+        }
+        vtkMath::LinearSolve3x3(derivative, residual, lastStep);
+        for (int i = 0; i < 3; i++)
+        {
+          point[i] -= lastStep[i];
+        }
+      }
+
+      const double inverseDisplacement[3] = { point[0] - target[0], point[1] - target[1], point[2] - target[2] };
+      inverseDisplacements->SetTuple(pointIndex, inverseDisplacement);
+      if (converged)
+      {
+        converged[pointIndex] = pointConverged ? 1 : 0;
+      }
+      if (!pointConverged)
+      {
+        ++numberOfNonConvergedPointsInRange;
+      }
+    }
+  };
+  if (numberOfThreads == 1)
+  {
+    computeInverseDisplacements(0, numberOfPoints);
+  }
+  else
+  {
+    vtkSMPTools::For(0, numberOfPoints, 256, computeInverseDisplacements);
+  }
+  vtkIdType numberOfNonConvergedPoints = 0;
+  for (vtkIdType numberOfNonConvergedPointsInRange : numberOfNonConvergedPointsInThread)
+  {
+    numberOfNonConvergedPoints += numberOfNonConvergedPointsInRange;
+  }
+
+  inverseTransform->SetDisplacementGridData(inverseDisplacementField);
+  inverseTransform->SetInterpolationMode(forwardTransform->GetInterpolationMode());
+  inverseTransform->SetDisplacementScale(1.0);
+  inverseTransform->SetDisplacementShift(0.0);
+  inverseTransform->SetInverseTolerance(forwardTransform->GetInverseTolerance());
+  inverseTransform->SetInverseIterations(forwardTransform->GetInverseIterations());
+  if (gridDirection)
+  {
+    vtkNew<vtkMatrix4x4> inverseGridDirection;
+    inverseGridDirection->DeepCopy(gridDirection);
+    inverseTransform->SetGridDirectionMatrix(inverseGridDirection);
+  }
+  else
+  {
+    inverseTransform->SetGridDirectionMatrix(nullptr);
+  }
+  return numberOfNonConvergedPoints;
 }
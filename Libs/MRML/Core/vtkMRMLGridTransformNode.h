@@ -17,6 +17,12 @@
 
 #include "vtkMRMLTransformNode.h"
 
+// VTK includes
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+class vtkOrientedGridTransform;
+
 /// \brief MRML node for representing a nonlinear transformation to the parent node using a grid transform.
 ///
 /// MRML node for representing a nonlinear transformation to the parent
@@ -40,17 +46,98 @@ public:
 
   /// Copy node content (excludes basic data, such as name and node references).
   /// \sa vtkMRMLNode::CopyContent
-  vtkMRMLCopyContentDefaultMacro(vtkMRMLGridTransformNode);
+  vtkMRMLCopyContentMacro(vtkMRMLGridTransformNode);
 
   ///
   /// Get node XML tag name (like Volume, Model)
   const char* GetNodeTagName() override {return "GridTransform";}
 
+  ///
+  /// Transform of this node to parent that is used for transforming points.
+  /// Returns the precomputed inverse if PrecomputedInverse is enabled and
+  /// the transform is computed from the inverse of the displacement field.
+  /// GetTransformToParent() is not affected by PrecomputedInverse.
+  vtkAbstractTransform* GetTransformToParentForEvaluation() override;
+
+  ///
+  /// Transform of this node from parent that is used for transforming points.
+  /// Returns the precomputed inverse if PrecomputedInverse is enabled and
+  /// the transform is computed from the inverse of the displacement field.
+  /// GetTransformFromParent() is not affected by PrecomputedInverse.
+  vtkAbstractTransform* GetTransformFromParentForEvaluation() override;
+
+  ///
+  /// Updates the precomputed inverse before notifying observers about the transform change.
+  void TransformModified() override;
+
+  ///
+  /// Use an explicitly computed displacement field for the inverse of the grid transform.
+  /// By default, each point is transformed by the inverse grid transform using an iterative
+  /// method, which is very slow when many points are transformed (e.g., when an image is resampled).
+  /// If this option is enabled then the inverse displacement field is computed (in parallel)
+  /// at the points of the displacement grid when the option is enabled and whenever the stored
+  /// transform is modified, and the inverse transform is computed by simple interpolation.
+  /// The precomputed inverse is used in GetTransformToParentForEvaluation(),
+  /// GetTransformFromParentForEvaluation() and therefore in transforms between nodes
+  /// (GetTransformToWorld(), GetTransformBetweenNodes(), ...).
+  /// If the displacement grid image is modified without modifying the transform then
+  /// UpdatePrecomputedInverse() must be called.
+  /// It is only used if the displacement field is stored as a vtkOrientedGridTransform (not
+  /// computed from its inverse). Disabled by default.
+  void SetPrecomputedInverse(bool enable);
+  vtkGetMacro(PrecomputedInverse, bool);
+  vtkBooleanMacro(PrecomputedInverse, bool);
+
+  ///
+  /// Compute the inverse displacement field now if it is enabled and not up-to-date.
+  /// Returns false (and releases the precomputed inverse) if the precomputed inverse
+  /// cannot be used for this transform.
+  bool UpdatePrecomputedInverse();
+
+  ///
+  /// Image that contains 1 at grid points where computation of the inverse displacement converged
+  /// and 0 where it did not (at these points the inverse is only approximate).
+  /// Returns nullptr if the precomputed inverse is not available.
+  vtkImageData* GetPrecomputedInverseConvergenceMask();
+
+  ///
+  /// Number of grid points where computation of the inverse displacement did not converge.
+  vtkGetMacro(PrecomputedInverseNumberOfNonConvergedPoints, vtkIdType);
+
+  ///
+  /// Compute inverse of forwardTransform as a displacement field sampled at the grid points of
+  /// the forward displacement field, using Newton's method at each grid point in parallel.
+  /// Inversion tolerance and maximum number of iterations are taken from the forward transform.
+  /// The inverse displacement field and the grid direction are set in inverseTransform.
+  /// The inverse displacement field has the scalar type of the forward displacement field
+  /// if it is float, otherwise double.
+  /// If convergenceMask is specified then it is set to 1 at converged points and 0 elsewhere.
+  /// numberOfThreads = 1 computes the inverse in the calling thread, other values use
+  /// the VTK SMP backend.
+  /// Returns the number of grid points where the inversion did not converge, or -1 in case of an error.
+  static vtkIdType ComputeInverseDisplacementField(vtkOrientedGridTransform* forwardTransform,
+    vtkOrientedGridTransform* inverseTransform, vtkImageData* convergenceMask = nullptr, int numberOfThreads = 0);
+
 protected:
   vtkMRMLGridTransformNode();
   ~vtkMRMLGridTransformNode() override;
   vtkMRMLGridTransformNode(const vtkMRMLGridTransformNode&);
   void operator=(const vtkMRMLGridTransformNode&);
+
+  /// Returns the displacement field transform that the inverse can be precomputed for,
+  /// nullptr if not available.
+  vtkOrientedGridTransform* GetPrecomputableGridTransform();
+
+  /// Release the precomputed inverse transform and convergence mask
+  void ReleasePrecomputedInverse();
+
+  bool PrecomputedInverse{ false };
+  vtkSmartPointer<vtkOrientedGridTransform> PrecomputedInverseTransform;
+  vtkSmartPointer<vtkImageData> PrecomputedInverseConvergenceMask;
+  vtkIdType PrecomputedInverseNumberOfNonConvergedPoints{ 0 };
+  /// Forward transform and its modification time that the inverse was computed from
+  vtkAbstractTransform* PrecomputedInverseSourceTransform{ nullptr };
+  vtkMTimeType PrecomputedInverseSourceMTime{ 0 };
 };
 
 #endif
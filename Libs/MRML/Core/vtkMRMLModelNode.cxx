@@ -31,10 +31,12 @@ Version:   $Revision: 1.3 $
 #include <vtkFloatArray.h>
 #include <vtkGeneralTransform.h>
 #include <vtkImplicitPolyDataDistance.h>
+#include <vtkLinearTransform.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
 #include <vtkTransformFilter.h>
@@ -43,6 +45,7 @@ Version:   $Revision: 1.3 $
 #include <vtkVersion.h>
 
 // STD includes
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
@@ -87,7 +90,12 @@ void vtkMRMLModelNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=true*/)
   this->MeshType = node->MeshType;
   if (deepCopy)
   {
-    if (node->GetMesh())
+    if (this->MeshToShareOnCopy)
+    {
+      // Unmodified mesh of a previous undo copy (see CopyForUndo)
+      this->SetAndObserveMesh(this->MeshToShareOnCopy);
+    }
+    else if (node->GetMesh())
     {
       if (this->GetMesh() && strcmp(this->GetMesh()->GetClassName(), node->GetMesh()->GetClassName())==0)
       {
@@ -739,13 +747,39 @@ void vtkMRMLModelNode::ApplyTransform(vtkAbstractTransform* transform)
     return;
   }
 
+  bool isInPipeline = !vtkTrivialProducer::SafeDownCast(
+     this->MeshConnection ? this->MeshConnection->GetProducer() : nullptr);
+
+  // Non-linear transforms are slow to evaluate, therefore points and normals of meshes that are
+  // stored as data objects are transformed in parallel. Vectors and cell normals would need to be
+  // transformed, too, so in that case the transform filter is used.
+  vtkPointSet* mesh = this->GetMesh();
+  if (!isInPipeline && !vtkLinearTransform::SafeDownCast(transform) && mesh->GetPoints()
+    && !mesh->GetPointData()->GetVectors()
+    && !mesh->GetCellData()->GetNormals() && !mesh->GetCellData()->GetVectors())
+  {
+    vtkNew<vtkPoints> transformedPoints;
+    transformedPoints->SetDataType(mesh->GetPoints()->GetDataType());
+    vtkDataArray* normals = mesh->GetPointData()->GetNormals();
+    vtkSmartPointer<vtkDataArray> transformedNormals;
+    if (normals)
+    {
+      transformedNormals = vtkSmartPointer<vtkDataArray>::Take(normals->NewInstance());
+      transformedNormals->SetName(normals->GetName());
+    }
+    vtkMRMLTransformNode::TransformPoints(transform, mesh->GetPoints(), transformedPoints, normals, transformedNormals);
+    mesh->SetPoints(transformedPoints);
+    if (transformedNormals)
+    {
+      mesh->GetPointData()->SetNormals(transformedNormals);
+    }
+    return;
+  }
+
   vtkTransformFilter* transformFilter = vtkTransformFilter::New();
   transformFilter->SetInputConnection(this->MeshConnection);
   transformFilter->SetTransform(transform);
 
-  bool isInPipeline = !vtkTrivialProducer::SafeDownCast(
-     this->MeshConnection ? this->MeshConnection->GetProducer() : nullptr);
-
   // If mesh was set through pipeline (SetMeshConnection), append
   // transform filter to that pipeline
   if (isInPipeline)
@@ -758,7 +792,6 @@ void vtkMRMLModelNode::ApplyTransform(vtkAbstractTransform* transform)
   else
   {
     transformFilter->Update();
-    vtkPointSet * mesh = this->GetMesh();
     mesh->DeepCopy(transformFilter->GetOutput());
   }
   transformFilter->Delete();
@@ -1034,6 +1067,30 @@ bool vtkMRMLModelNode::GetModifiedSinceRead()
     (this->GetMesh() && this->GetMesh()->GetMTime() > this->GetStoredTime());
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLModelNode::GetContentMTime()
+{
+  return std::max(this->Superclass::GetContentMTime(), vtkMRMLStorableNode::GetDataObjectContentMTime(this->GetMesh()));
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLModelNode::CopyForUndo(vtkMRMLNode* anode, vtkMRMLNode* previousCopy, vtkMTimeType previousCopyContentMTime)
+{
+  vtkMRMLModelNode* node = vtkMRMLModelNode::SafeDownCast(anode);
+  vtkMRMLModelNode* previousModelCopy = vtkMRMLModelNode::SafeDownCast(previousCopy);
+  vtkPointSet* mesh = (node ? node->GetMesh() : nullptr);
+  if (mesh && previousModelCopy && previousModelCopy->GetMesh()
+    && previousModelCopy->UndoSourceMesh.GetPointer() == mesh
+    && vtkMRMLStorableNode::GetDataObjectContentMTime(mesh) <= previousCopyContentMTime)
+  {
+    // Copies in the undo stack are not modified, therefore the mesh can be shared
+    this->MeshToShareOnCopy = previousModelCopy->GetMesh();
+  }
+  this->Superclass::CopyForUndo(anode, previousCopy, previousCopyContentMTime);
+  this->MeshToShareOnCopy = nullptr;
+  this->UndoSourceMesh = mesh;
+}
+
 //---------------------------------------------------------------------------
 vtkImplicitFunction* vtkMRMLModelNode::GetImplicitFunctionWorld()
 {
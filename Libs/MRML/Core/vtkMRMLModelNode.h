@@ -21,6 +21,7 @@ class vtkMRMLModelDisplayNode;
 class vtkMRMLStorageNode;
 
 // VTK includes
+#include <vtkWeakPointer.h>
 class vtkAlgorithmOutput;
 class vtkAssignAttributes;
 class vtkEventForwarderCommand;
@@ -253,6 +254,14 @@ public:
   /// \sa vtkMRMLStorableNode::GetModifiedSinceRead()
   bool GetModifiedSinceRead() override;
 
+  /// Includes modification of the mesh and its arrays.
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
+  /// Shares the mesh with the previous copy if the mesh has not been modified since then.
+  /// \sa vtkMRMLNode::CopyForUndo()
+  void CopyForUndo(vtkMRMLNode* node, vtkMRMLNode* previousCopy, vtkMTimeType previousCopyContentMTime) override;
+
   /// Determine if the mesh stores scalar data data that the user may want to see and if
   /// such data is found then display it.
   /// Currently, it displays single-component scalar array (with a colormap),
@@ -302,6 +311,12 @@ protected:
 
   vtkSmartPointer<vtkTransformFilter> PolyDataLocalToWorldTransformFilter;
   vtkSmartPointer<vtkImplicitPolyDataDistance> ImplicitPolyDataDistanceWorld;
+
+  /// Mesh of the node that this node was copied from by CopyForUndo()
+  vtkWeakPointer<vtkPointSet> UndoSourceMesh;
+  /// Mesh that CopyContent() uses instead of copying the mesh of the source node
+  /// (set by CopyForUndo() while copying)
+  vtkSmartPointer<vtkPointSet> MeshToShareOnCopy;
 };
 
 #endif
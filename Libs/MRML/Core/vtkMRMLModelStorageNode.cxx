@@ -200,15 +200,94 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
   int coordinateSystemInFileHeader = -1;
   vtkSmartPointer<vtkPointSet> meshFromFile;
+  if (this->UsePrefetchedData(fullName))
+  {
+    // file has been already read by PrefetchData
+    meshFromFile = this->PrefetchedMesh;
+    coordinateSystemInFileHeader = this->PrefetchedCoordinateSystem;
+    if (!this->PrefetchedSuccess)
+    {
+      return 0;
+    }
+  }
+  else if (!this->ReadMeshFromFile(fullName, extension, this->GetUserMessages(), meshFromFile, coordinateSystemInFileHeader))
+  {
+    return 0;
+  }
+
+  if (this->GetUserMessages()->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > 0)
+  {
+    // User messages are already logged, no need for logging more
+    return 0;
+  }
+
+  if (coordinateSystemInFileHeader >= 0)
+  {
+    // coordinate system specified in the file, use it (regardless oassumingf what was the preferred coordinate system in the node)
+    this->CoordinateSystem = coordinateSystemInFileHeader;
+  }
+  else
+  {
+    // no coordinate system in the file, use the currently set coordinate system
+    vtkInfoMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File "
+      << fullName.c_str() << " does not contain coordinate system information. Assuming "
+      << vtkMRMLStorageNode::GetCoordinateSystemTypeAsString(this->CoordinateSystem) << ".");
+  }
+
+  vtkSmartPointer<vtkPointSet> meshToSetInNode;
+  if (this->CoordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS)
+  {
+    // no flip of first two axes
+    meshToSetInNode = meshFromFile;
+  }
+  else
+  {
+    // transform from RAS to LPS
+    if (meshFromFile->IsA("vtkPolyData"))
+    {
+      meshToSetInNode = vtkSmartPointer<vtkPolyData>::New();
+    }
+    else
+    {
+      meshToSetInNode = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    }
+    vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, meshToSetInNode);
+  }
+  modelNode->SetAndObserveMesh(meshToSetInNode);
+
+  if (modelNode->GetMesh() != nullptr)
+  {
+    for (int i=0; i<modelNode->GetNumberOfDisplayNodes(); ++i)
+    {
+      vtkMRMLDisplayNode* displayNode = modelNode->GetNthDisplayNode(i);
+      // is there an active scalar array?
+      if (displayNode && displayNode->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDataScalarRange)
+      {
+        double *scalarRange = modelNode->GetMesh()->GetScalarRange();
+        if (scalarRange)
+        {
+          vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
+          displayNode->SetScalarRange(scalarRange);
+        }
+      }
+    } // For all display nodes
+  }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLModelStorageNode::ReadMeshFromFile(const std::string& fullName, const std::string& extension,
+  vtkMRMLMessageCollection* userMessages, vtkSmartPointer<vtkPointSet>& meshFromFile, int& coordinateSystemInFileHeader)
+{
   try
   {
     if (extension == std::string(".g") || extension == std::string(".byu"))
     {
       vtkNew<vtkBYUReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetGeometryFileName(fullName.c_str());
       reader->Update();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       meshFromFile = reader->GetOutput();
     }
     else if (extension == std::string(".vtk"))
@@ -227,10 +306,10 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         reader->ReadAllColorScalarsOn();
         reader->ReadAllTCoordsOn();
         reader->ReadAllFieldsOn();
-        this->GetUserMessages()->SetObservedObject(reader);
+        userMessages->SetObservedObject(reader);
         reader->Update();
         meshFromFile = reader->GetOutput();
-        this->GetUserMessages()->SetObservedObject(nullptr);
+        userMessages->SetObservedObject(nullptr);
       }
       else if (unstructuredGridReader->IsFileUnstructuredGrid())
       {
@@ -241,14 +320,14 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
         unstructuredGridReader->ReadAllColorScalarsOn();
         unstructuredGridReader->ReadAllTCoordsOn();
         unstructuredGridReader->ReadAllFieldsOn();
-        this->GetUserMessages()->SetObservedObject(unstructuredGridReader);
+        userMessages->SetObservedObject(unstructuredGridReader);
         unstructuredGridReader->Update();
         meshFromFile = unstructuredGridReader->GetOutput();
-        this->GetUserMessages()->SetObservedObject(nullptr);
+        userMessages->SetObservedObject(nullptr);
       }
       else
       {
-        vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+        vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
           "Failed to load model from VTK file " << fullName << " as it does not contain polydata nor unstructured grid."
           << " The file might be loadable as a volume.");
       }
@@ -257,50 +336,50 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     else if (extension == std::string(".vtp"))
     {
       vtkNew<vtkXMLPolyDataReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFieldData(meshFromFile);
     }
     else if (extension == std::string(".ucd"))
     {
       vtkNew<vtkAVSucdReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
     }
     else if (extension == std::string(".vtu"))
     {
       vtkNew<vtkXMLUnstructuredGridReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFieldData(meshFromFile);
     }
     else if (extension == std::string(".stl"))
     {
       vtkNew<vtkSTLReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetHeader());
     }
     else if (extension == std::string(".ply"))
     {
       vtkNew<vtkPLYReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       vtkStringArray* comments = reader->GetComments();
       for (int commentIndex = 0; commentIndex < comments->GetNumberOfValues(); commentIndex++)
       {
@@ -315,11 +394,11 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     else if (extension == std::string(".obj"))
     {
       vtkNew<vtkOBJReader> reader;
-      this->GetUserMessages()->SetObservedObject(reader);
+      userMessages->SetObservedObject(reader);
       reader->SetFileName(fullName.c_str());
       reader->Update();
       meshFromFile = reader->GetOutput();
-      this->GetUserMessages()->SetObservedObject(nullptr);
+      userMessages->SetObservedObject(nullptr);
       coordinateSystemInFileHeader = vtkMRMLModelStorageNode::GetCoordinateSystemFromFileHeader(reader->GetComment());
     }
     else if (extension == std::string(".meta"))  // model in meta format
@@ -340,7 +419,7 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
       }
       catch(itk::ExceptionObject &ex)
       {
-        vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+        vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
           "Failed to load model from ITK .meta file " << fullName << ": " << ex.GetDescription());
         return 0;
       }
@@ -384,76 +463,57 @@ int vtkMRMLModelStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
     else
     {
-      vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+      vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
         "Failed to load model: unrecognized file extension '" << extension << "' of file '" << fullName << "'.");
       return 0;
     }
   }
   catch (...)
   {
-    vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLModelStorageNode::ReadDataInternal",
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLModelStorageNode::ReadDataInternal",
       "Failed to load model: unknown exception while trying to load the file '" << fullName << "'.");
     return 0;
   }
+  return 1;
+}
 
-  if (this->GetUserMessages()->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent) > 0)
-  {
-    // User messages are already logged, no need for logging more
-    return 0;
-  }
-
-  if (coordinateSystemInFileHeader >= 0)
-  {
-    // coordinate system specified in the file, use it (regardless oassumingf what was the preferred coordinate system in the node)
-    this->CoordinateSystem = coordinateSystemInFileHeader;
-  }
-  else
+//----------------------------------------------------------------------------
+bool vtkMRMLModelStorageNode::PrefetchData(vtkMRMLNode* refNode)
+{
+  this->ClearPrefetchedData();
+  // Same conditions as in ReadData: data is not read for nodes that are not
+  // in the scene or when the scene does not read data on load
+  if (!refNode || !refNode->GetAddToScene()
+    || (this->GetScene() && this->GetScene()->GetReadDataOnLoad() == 0))
   {
-    // no coordinate system in the file, use the currently set coordinate system
-    vtkInfoMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): File "
-      << fullName.c_str() << " does not contain coordinate system information. Assuming "
-      << vtkMRMLStorageNode::GetCoordinateSystemTypeAsString(this->CoordinateSystem) << ".");
+    return false;
   }
-
-  vtkSmartPointer<vtkPointSet> meshToSetInNode;
-  if (this->CoordinateSystem == vtkMRMLStorageNode::CoordinateSystemRAS)
+  if (this->GetWriteState() == SkippedNoData || !this->CanReadInReferenceNode(refNode)
+    || (this->GetURI() && strlen(this->GetURI()) > 0))
   {
-    // no flip of first two axes
-    meshToSetInNode = meshFromFile;
+    return false;
   }
-  else
+  std::string fullName = this->GetFullNameFromFileName();
+  std::string extension = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
+  if (fullName.empty() || extension.empty() || !vtksys::SystemTools::FileExists(fullName.c_str()))
   {
-    // transform from RAS to LPS
-    if (meshFromFile->IsA("vtkPolyData"))
-    {
-      meshToSetInNode = vtkSmartPointer<vtkPolyData>::New();
-    }
-    else
-    {
-      meshToSetInNode = vtkSmartPointer<vtkUnstructuredGrid>::New();
-    }
-    vtkMRMLModelStorageNode::ConvertBetweenRASAndLPS(meshFromFile, meshToSetInNode);
+    return false;
   }
-  modelNode->SetAndObserveMesh(meshToSetInNode);
+  vtkNew<vtkMRMLMessageCollection> userMessages;
+  this->PrefetchedSuccess = (this->ReadMeshFromFile(fullName, extension, userMessages,
+    this->PrefetchedMesh, this->PrefetchedCoordinateSystem) != 0);
+  this->PrefetchedFileName = fullName;
+  this->PrefetchedUserMessages = userMessages;
+  return true;
+}
 
-  if (modelNode->GetMesh() != nullptr)
-  {
-    for (int i=0; i<modelNode->GetNumberOfDisplayNodes(); ++i)
-    {
-      vtkMRMLDisplayNode* displayNode = modelNode->GetNthDisplayNode(i);
-      // is there an active scalar array?
-      if (displayNode && displayNode->GetScalarRangeFlag() == vtkMRMLDisplayNode::UseDataScalarRange)
-      {
-        double *scalarRange = modelNode->GetMesh()->GetScalarRange();
-        if (scalarRange)
-        {
-          vtkDebugMacro("ReadDataInternal (" << (this->ID ? this->ID : "(unknown)") << "): setting scalar range " << scalarRange[0] << ", " << scalarRange[1]);
-          displayNode->SetScalarRange(scalarRange);
-        }
-      }
-    } // For all display nodes
-  }
-  return 1;
+//----------------------------------------------------------------------------
+void vtkMRMLModelStorageNode::ClearPrefetchedData()
+{
+  Superclass::ClearPrefetchedData();
+  this->PrefetchedMesh = nullptr;
+  this->PrefetchedCoordinateSystem = -1;
+  this->PrefetchedSuccess = false;
 }
 
 //----------------------------------------------------------------------------
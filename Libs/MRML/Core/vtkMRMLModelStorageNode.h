@@ -55,6 +55,11 @@ public:
   /// between RAS and LPS coordinate system.
   static void ConvertBetweenRASAndLPS(vtkPointSet* inputMesh, vtkPointSet* outputMesh);
 
+  /// Read the mesh from file into memory, the mesh is set in the model node by ReadData().
+  /// \sa vtkMRMLStorageNode::PrefetchData()
+  bool PrefetchData(vtkMRMLNode* refNode) override;
+  void ClearPrefetchedData() override;
+
 protected:
   vtkMRMLModelStorageNode();
   ~vtkMRMLModelStorageNode() override;
@@ -73,6 +78,11 @@ protected:
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Read mesh from file. Errors are added to userMessages.
+  /// Returns 0 on failure. Does not modify the storage node or the model node.
+  int ReadMeshFromFile(const std::string& fullName, const std::string& extension,
+    vtkMRMLMessageCollection* userMessages, vtkSmartPointer<vtkPointSet>& meshFromFile, int& coordinateSystemInFileHeader);
+
   /// Write data from a  referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
@@ -81,6 +91,11 @@ protected:
   static int GetCoordinateSystemFromFieldData(vtkPointSet* mesh);
 
   int CoordinateSystem;
+
+  /// Mesh read by PrefetchData()
+  vtkSmartPointer<vtkPointSet> PrefetchedMesh;
+  int PrefetchedCoordinateSystem{-1};
+  bool PrefetchedSuccess{false};
 };
 
 #endif
@@ -372,8 +372,7 @@ int vtkMRMLNRRDStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   vtkNew<vtkTeemNRRDWriter> writer;
   writer->SetFileName(fullName.c_str());
   writer->SetInputConnection(volNode->GetImageDataConnection());
-  writer->SetUseCompression(this->GetUseCompression());
-  writer->SetCompressionLevel(this->GetGzipCompressionLevelFromCompressionParameter(this->CompressionParameter));
+  this->SetWriterCompression(writer);
 
   // set volume attributes
   writer->SetIJKToRASMatrix(ijkToRas.GetPointer());
@@ -602,6 +601,25 @@ int vtkMRMLNRRDStorageNode::GetGzipCompressionLevelFromCompressionParameter(std:
   return 1;
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNRRDStorageNode::SetWriterCompression(vtkTeemNRRDWriter* writer)
+{
+  writer->SetUseCompression(this->GetUseCompression());
+  writer->SetCompressionLevel(this->GetGzipCompressionLevelFromCompressionParameter(this->CompressionParameter));
+  if (this->CompressionParameter == this->GetCompressionParameterMinimumSize())
+  {
+    writer->SetCompressionBlockSize(16 * 1024 * 1024);
+  }
+  else if (this->CompressionParameter == this->GetCompressionParameterNormal())
+  {
+    writer->SetCompressionBlockSize(4 * 1024 * 1024);
+  }
+  else
+  {
+    writer->SetCompressionBlockSize(1024 * 1024);
+  }
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNRRDStorageNode::ConfigureForDataExchange()
 {
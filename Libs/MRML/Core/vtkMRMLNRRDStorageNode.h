@@ -16,6 +16,8 @@
 #define __vtkMRMLNRRDStorageNode_h
 
 #include "vtkMRMLStorageNode.h"
+
+class vtkTeemNRRDWriter;
 class vtkDoubleArray;
 class vtkTeemNRRDReader;
 
@@ -94,6 +96,12 @@ protected:
   /// Convert compression parameter string to gzip compression level
   int GetGzipCompressionLevelFromCompressionParameter(std::string parameter);
 
+  /// Set compression of the writer according to UseCompression and CompressionParameter.
+  /// Presets select the gzip level and the size of blocks that are compressed in parallel:
+  /// fastest uses level 1 and small blocks (most parallelism), normal uses level 6,
+  /// minimum size uses level 9 and large blocks (fewer block boundaries, which slightly improves ratio).
+  void SetWriterCompression(vtkTeemNRRDWriter* writer);
+
   int CenterImage;
 };
 
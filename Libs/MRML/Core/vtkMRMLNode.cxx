@@ -686,6 +686,67 @@ vtkMRMLScene* vtkMRMLNode::GetScene()
   return this->Scene.GetPointer();
 }
 
+//----------------------------------------------------------------------------
+void vtkMRMLNode::SetName(const char* name)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting Name to " << (name ? name : "(null)"));
+  if (this->Name == nullptr && name == nullptr)
+  {
+    return;
+  }
+  if (this->Name && name && !strcmp(this->Name, name))
+  {
+    return;
+  }
+  delete [] this->Name;
+  if (name)
+  {
+    size_t n = strlen(name) + 1;
+    this->Name = new char[n];
+    memcpy(this->Name, name, n);
+  }
+  else
+  {
+    this->Name = nullptr;
+  }
+  if (this->Scene)
+  {
+    // Keep the node name index of the scene up-to-date
+    this->Scene->UpdateNodeNameIndex(this);
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::SetUndoEnabled(bool undoEnabled)
+{
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting UndoEnabled to " << undoEnabled);
+  if (this->UndoEnabled == undoEnabled)
+  {
+    return;
+  }
+  this->UndoEnabled = undoEnabled;
+  if (this->Scene && this->ID && this->Scene->GetNodeByID(this->ID) == this)
+  {
+    // Undo states must include or exclude this node from now on
+    this->Scene->UndoEnabledModified();
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkMRMLNode::GetContentMTime()
+{
+  return this->GetMTime();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLNode::CopyForUndo(vtkMRMLNode* node, vtkMRMLNode* vtkNotUsed(previousCopy),
+  vtkMTimeType vtkNotUsed(previousCopyContentMTime))
+{
+  this->CopyWithScene(node);
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLNode::SetScene(vtkMRMLScene* scene)
 {
@@ -389,9 +389,27 @@ public:
   /// vtkMRMLModelNode then it must be enabled for vtkMRMLModelDisplayNode
   /// and vtkMRMLModelStorageNode as well).
   vtkGetMacro(UndoEnabled, bool);
-  vtkSetMacro(UndoEnabled, bool);
+  virtual void SetUndoEnabled(bool undoEnabled);
   vtkBooleanMacro(UndoEnabled, bool);
 
+  /// Get the last time when the node or any data object that the node owns
+  /// (such as image data or mesh) was modified.
+  /// The scene uses this to determine if a node copy stored in the undo stack
+  /// is still up-to-date. Subclasses that store content in data objects that
+  /// may be modified without calling Modified() on the node must override this method.
+  /// \sa vtkMRMLStorableNode::GetModifiedSinceRead()
+  virtual vtkMTimeType GetContentMTime();
+
+  /// Copy a node into this node for storing it in the undo stack.
+  /// \a previousCopy is the copy of the same node that was stored for an earlier
+  /// undo state (nullptr if there is none) and \a previousCopyContentMTime is
+  /// the content modified time of the node when that copy was made.
+  /// Copies in the undo stack are never modified, therefore nodes may share
+  /// data objects that have not changed since then with \a previousCopy instead of
+  /// copying them again. The default implementation calls CopyWithScene().
+  /// \sa GetContentMTime()
+  virtual void CopyForUndo(vtkMRMLNode* node, vtkMRMLNode* previousCopy, vtkMTimeType previousCopyContentMTime);
+
   /// Propagate events generated in mrml.
   virtual void ProcessMRMLEvents ( vtkObject *caller, unsigned long event, void *callData );
 
@@ -409,7 +427,7 @@ public:
   vtkGetStringMacro(Description);
 
   /// Name of this node, to be set by the user
-  vtkSetStringMacro(Name);
+  virtual void SetName(const char* name);
   vtkGetStringMacro(Name);
 
   /// ID use by other nodes to reference this node in XML.
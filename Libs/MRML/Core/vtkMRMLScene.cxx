@@ -90,7 +90,9 @@ Version:   $Revision: 1.18 $
 #include <vtkDebugLeaks.h>
 #include <vtkObjectFactory.h>
 #include <vtkPNGWriter.h>
+#include <vtkSMPTools.h>
 #include <vtkSmartPointer.h>
+#include <vtkTimerLog.h>
 
 // VTKSYS includes
 #include <vtksys/RegularExpression.hxx>
@@ -99,25 +101,156 @@ Version:   $Revision: 1.18 $
 
 // STD includes
 #include <algorithm>
+#include <fstream>
 #include <numeric>
+#include <unordered_set>
 
 //#define MRMLSCENE_VERBOSE
 
-#ifdef MRMLSCENE_VERBOSE
-# include <vtkTimerLog.h>
-#endif
-
 vtkCxxSetObjectMacro(vtkMRMLScene, CacheManager, vtkCacheManager);
 vtkCxxSetObjectMacro(vtkMRMLScene, DataIOManager, vtkDataIOManager);
 vtkCxxSetObjectMacro(vtkMRMLScene, UserTagTable, vtkTagTable);
 vtkCxxSetObjectMacro(vtkMRMLScene, URIHandlerCollection, vtkCollection);
 
+namespace
+{
+
+//------------------------------------------------------------------------------
+struct PrefetchTask
+{
+  PrefetchTask(vtkMRMLStorageNode* storageNode, vtkMRMLNode* node)
+    : StorageNode(storageNode), Node(node) {}
+  vtkMRMLStorageNode* StorageNode;
+  vtkMRMLNode* Node;
+  double ElapsedTime{0.0};
+};
+
+//------------------------------------------------------------------------------
+// Read data files of storage nodes into memory concurrently.
+// The data is set in the nodes by the next ReadData call of the storage node.
+void PrefetchStorageNodes(std::vector<PrefetchTask>& tasks)
+{
+  vtkSMPTools::For(0, static_cast<vtkIdType>(tasks.size()), 1, [&tasks](vtkIdType first, vtkIdType last)
+  {
+    for (vtkIdType taskIndex = first; taskIndex < last; ++taskIndex)
+    {
+      double startTime = vtkTimerLog::GetUniversalTime();
+      tasks[taskIndex].StorageNode->PrefetchData(tasks[taskIndex].Node);
+      tasks[taskIndex].ElapsedTime = vtkTimerLog::GetUniversalTime() - startTime;
+    }
+  });
+}
+
+//------------------------------------------------------------------------------
+// Returns true if the content of the file is already compressed (compressed images,
+// gzip-encoded NRRD files, VTK XML files with compressed data arrays).
+// These files are stored in scene bundles without compressing them again.
+bool IsCompressedFile(const std::string& fileName)
+{
+  std::string extension = vtksys::SystemTools::LowerCase(vtksys::SystemTools::GetFilenameLastExtension(fileName));
+  if (extension == ".gz" || extension == ".zip" || extension == ".mrb"
+    || extension == ".png" || extension == ".jpg" || extension == ".jpeg" || extension == ".mp4")
+  {
+    return true;
+  }
+  if (extension != ".nrrd" && extension != ".mha"
+    && extension != ".vtp" && extension != ".vtu" && extension != ".vti")
+  {
+    return false;
+  }
+  // Compression is specified in the file header
+  std::ifstream file(fileName.c_str(), std::ios::in | std::ios::binary);
+  std::string header(4096, '\0');
+  file.read(&header[0], header.size());
+  header.resize(static_cast<size_t>(file.gcount()));
+  if (extension == ".nrrd")
+  {
+    return header.find("\nencoding: gz") != std::string::npos || header.find("\nencoding: bz") != std::string::npos;
+  }
+  if (extension == ".mha")
+  {
+    return header.find("CompressedData = True") != std::string::npos;
+  }
+  return header.find("compressor=\"vtk") != std::string::npos;
+}
+
+//------------------------------------------------------------------------------
+// Get the detached data file names that are referenced in a NRRD header file
+// ("data file" field). File names are relative to the directory of the header.
+std::vector<std::string> GetNrrdDetachedDataFileNames(const std::string& headerFileName)
+{
+  std::vector<std::string> dataFileNames;
+  std::ifstream headerFile(headerFileName.c_str());
+  std::string line;
+  bool list = false;
+  while (std::getline(headerFile, line))
+  {
+    if (!line.empty() && line.back() == '\r')
+    {
+      line.pop_back();
+    }
+    if (list)
+    {
+      // with "LIST" all remaining lines are file names
+      if (!line.empty())
+      {
+        dataFileNames.push_back(line);
+      }
+      continue;
+    }
+    if (line.empty())
+    {
+      // end of header
+      break;
+    }
+    std::string::size_type separator = line.find(':');
+    if (separator == std::string::npos || line.compare(0, 1, "#") == 0)
+    {
+      continue;
+    }
+    std::string field = line.substr(0, separator);
+    if (field != "data file" && field != "datafile")
+    {
+      continue;
+    }
+    std::vector<std::string> values = vtksys::SystemTools::SplitString(vtksys::SystemTools::TrimWhitespace(line.substr(separator + 1)), ' ');
+    values.erase(std::remove(values.begin(), values.end(), std::string()), values.end());
+    if (values.size() == 1)
+    {
+      dataFileNames.push_back(values[0]);
+    }
+    else if (!values.empty() && values[0] == "LIST")
+    {
+      list = true;
+    }
+    else if (values.size() >= 4 && vtksys::RegularExpression("^[^%]*%0?[0-9]*d[^%]*$").find(values[0]))
+    {
+      // printf-style format string (with a single integer field) and min, max, step
+      std::vector<char> fileName(values[0].size() + 32);
+      int first = atoi(values[1].c_str());
+      int last = atoi(values[2].c_str());
+      int step = atoi(values[3].c_str());
+      for (int index = first; step != 0 && (step > 0 ? index <= last : index >= last); index += step)
+      {
+        snprintf(fileName.data(), fileName.size(), values[0].c_str(), index);
+        dataFileNames.emplace_back(fileName.data());
+      }
+    }
+  }
+  return dataFileNames;
+}
+
+} // end of anonymous namespace
+
 //------------------------------------------------------------------------------
 vtkMRMLScene::vtkMRMLScene()
 {
   this->RandomGenerator.seed(std::random_device{}());
 
   this->NodeIDsMTime = 0;
+  this->NodeIndexesMTime = 0;
+  this->UndoEnabledNodesMTime = 0;
+  this->NextNodeIndexOrder = 0;
 
   this->Nodes = vtkCollection::New();
   this->MaximumNumberOfSavedUndoStates = 20;
@@ -259,6 +392,8 @@ vtkMRMLScene::~vtkMRMLScene()
     this->RegisteredNodeClasses[n]->Delete();
   }
 
+  this->RemoveRetainedBundleDirectories();
+
   if ( this->CacheManager != nullptr )
   {
     this->CacheManager->Delete();
@@ -328,6 +463,7 @@ void vtkMRMLScene::Clear(int removeSingletons)
   this->ClearRedoStack ( );
   this->UniqueIDs.clear();
   this->UniqueNames.clear();
+  this->RemoveRetainedBundleDirectories();
 
   if ( this->GetUserTagTable() != nullptr )
   {
@@ -878,19 +1014,58 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
 
     // Notify the imported nodes about that all nodes are created
     // (so the observers can be attached to referenced nodes, etc.)
-    // by calling UpdateScene on each node
+    // by calling UpdateScene on each node.
+    // Data files of storable nodes are read by UpdateScene. To make loading faster,
+    // files of a batch of nodes are read concurrently into memory before
+    // UpdateScene is called for each node of the batch in the original order.
+    // Data is not prefetched if ReadData would not read it.
+    const bool multithreaded = (this->NumberOfReadThreads != 1 && this->GetReadDataOnLoad());
+    std::vector<vtkMRMLNode*> nodesToUpdate;
     for (addedNodes->InitTraversal(it);
          (node = (vtkMRMLNode*)addedNodes->GetNextItemAsObject(it)) ;)
     {
-      //double progress = n / (1. * nnodes);
-      //this->InvokeEvent(vtkCommand::ProgressEvent,(void *)&progress);
-      vtkDebugMacro("Adding Node: " << (node->GetName() ? node->GetName() : "(undefined)"));
       if (node->GetAddToScene())
       {
+        nodesToUpdate.push_back(node);
+      }
+    }
+    this->NodeReadTimes.clear();
+    const size_t batchSize = 2 * static_cast<size_t>(multithreaded ? vtkSMPTools::GetEstimatedNumberOfThreads() : 1);
+    for (size_t batchStart = 0; batchStart < nodesToUpdate.size(); batchStart += batchSize)
+    {
+      const size_t batchEnd = std::min(batchStart + batchSize, nodesToUpdate.size());
+
+      // When reading a scene bundle, files are extracted only while the node is read
+      std::vector<std::vector<std::string>> extractedBundleFiles(batchEnd - batchStart);
+      std::vector<PrefetchTask> prefetchTasks;
+      for (size_t nodeIndex = batchStart; nodeIndex < batchEnd; ++nodeIndex)
+      {
+        extractedBundleFiles[nodeIndex - batchStart] = this->ExtractReadBundleFiles(nodesToUpdate[nodeIndex]);
+        vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(nodesToUpdate[nodeIndex]);
+        for (int storageNodeIndex = 0; multithreaded && storableNode && storableNode->GetAddToScene()
+          && storageNodeIndex < storableNode->GetNumberOfStorageNodes(); ++storageNodeIndex)
+        {
+          vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
+          if (storageNode)
+          {
+            prefetchTasks.emplace_back(storageNode, storableNode);
+          }
+        }
+      }
+      PrefetchStorageNodes(prefetchTasks);
+
+      for (size_t nodeIndex = batchStart; nodeIndex < batchEnd; ++nodeIndex)
+      {
+        node = nodesToUpdate[nodeIndex];
+        //double progress = n / (1. * nnodes);
+        //this->InvokeEvent(vtkCommand::ProgressEvent,(void *)&progress);
+        vtkDebugMacro("Adding Node: " << (node->GetName() ? node->GetName() : "(undefined)"));
+        double startTime = vtkTimerLog::GetUniversalTime();
         int errorsBefore = userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent);
         userMessages->SetObservedObject(node);
         node->UpdateScene(this);
         userMessages->SetObservedObject(nullptr);
+        double readTime = vtkTimerLog::GetUniversalTime() - startTime;
         if (errorsBefore < userMessages->GetNumberOfMessagesOfType(vtkCommand::ErrorEvent))
         {
           //vtkErrorMacro("Import: error updating node " << node->GetID());
@@ -899,6 +1074,42 @@ int vtkMRMLScene::Import(vtkMRMLMessageCollection* userMessagesInput/*=nullptr*/
           // (nodes are still in the scene when save it later)
           // this->RemoveNode(node);
         }
+        if (!node->IsA("vtkMRMLStorableNode") || !node->GetID())
+        {
+          continue;
+        }
+        // Extracted files are kept if the node reads data from them later
+        // (for example, lazy loaded or memory mapped volumes)
+        vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+        for (int storageNodeIndex = 0; storageNodeIndex < storableNode->GetNumberOfStorageNodes(); ++storageNodeIndex)
+        {
+          vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
+          if (storageNode && !extractedBundleFiles[nodeIndex - batchStart].empty()
+            && storageNode->IsFileInUseAfterRead(storableNode))
+          {
+            extractedBundleFiles[nodeIndex - batchStart].clear();
+            this->ReadBundleFilesInUse = true;
+          }
+        }
+        for (PrefetchTask& prefetchTask : prefetchTasks)
+        {
+          if (prefetchTask.Node == node)
+          {
+            readTime += prefetchTask.ElapsedTime;
+            // Data that was prefetched but not used by UpdateScene is released
+            prefetchTask.StorageNode->ClearPrefetchedData();
+          }
+        }
+        this->NodeReadTimes[node->GetID()] = readTime;
+        vtkDebugMacro("Import: read data of node " << node->GetID() << " in " << readTime << " seconds");
+      }
+
+      for (const std::vector<std::string>& extractedNodeFiles : extractedBundleFiles)
+      {
+        for (const std::string& extractedBundleFile : extractedNodeFiles)
+        {
+          vtksys::SystemTools::RemoveFile(extractedBundleFile);
+        }
       }
     }
 
@@ -1311,6 +1522,7 @@ vtkMRMLNode* vtkMRMLScene::AddNodeNoNotify(vtkMRMLNode *n)
 
   // cache the node so the whole scene cache stays up-to date
   this->AddNodeID(n);
+  this->AddNodeToIndexes(n);
 
   // Keep the SH up-to-date
   if (vtkMRMLSubjectHierarchyNode::SafeDownCast(n) != nullptr &&
@@ -1525,6 +1737,7 @@ void vtkMRMLScene::RemoveNode(vtkMRMLNode *n)
 
   std::string nid = (n->GetID() ? n->GetID() : "");
   this->RemoveNodeID(n->GetID());
+  this->RemoveNodeFromIndexes(n);
 
   this->InvokeEvent(vtkMRMLScene::NodeRemovedEvent, n);
 
@@ -1705,18 +1918,8 @@ int vtkMRMLScene::GetNumberOfNodesByClass(const char *className)
     vtkErrorMacro("GetNumberOfNodesByClass: class name is null.");
     return 0;
   }
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-  {
-    if (node->IsA(className))
-    {
-      num++;
-    }
-  }
-  return num;
+  std::vector<vtkMRMLNode*> nodes;
+  return this->GetIndexedNodesByClass(className, nodes, 0);
 }
 
 //------------------------------------------------------------------------------
@@ -1728,17 +1931,7 @@ int vtkMRMLScene::GetNodesByClass(const char *className, std::vector<vtkMRMLNode
     vtkErrorMacro("GetNodesByClass: class name is null.");
     return 0;
   }
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
-  {
-    if (node->IsA(className))
-    {
-      nodes.push_back(node);
-    }
-  }
-  return static_cast<int>(nodes.size());
+  return this->GetIndexedNodesByClass(className, nodes);
 }
 
 //------------------------------------------------------------------------------
@@ -1750,15 +1943,11 @@ vtkCollection* vtkMRMLScene::GetNodesByClass(const char *className)
     return nullptr;
   }
   vtkCollection* nodes = vtkCollection::New();
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::vector<vtkMRMLNode*> foundNodes;
+  this->GetIndexedNodesByClass(className, foundNodes);
+  for (vtkMRMLNode* node : foundNodes)
   {
-    if (node->IsA(className))
-    {
-      nodes->AddItem(node);
-    }
+    nodes->AddItem(node);
   }
   return nodes;
 }
@@ -1895,22 +2084,13 @@ vtkMRMLNode* vtkMRMLScene::GetNthNodeByClass(int n, const char *className)
     return nullptr;
   }
 
-  int num=0;
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  std::vector<vtkMRMLNode*> nodes;
+  this->GetIndexedNodesByClass(className, nodes, n + 1);
+  if (static_cast<int>(nodes.size()) <= n)
   {
-    if (node->IsA(className))
-    {
-      if (num == n)
-      {
-        return node;
-      }
-      num++;
-    }
+    return nullptr;
   }
-  return nullptr;
+  return nodes[n];
 }
 
 //------------------------------------------------------------------------------
@@ -1930,15 +2110,15 @@ vtkCollection* vtkMRMLScene::GetNodesByName(const char* name)
     return nodes;
   }
 
-  vtkMRMLNode *node;
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  this->UpdateNodeIndexes();
+  auto nameIt = this->NodesByName.find(name);
+  if (nameIt == this->NodesByName.end())
   {
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name))
-    {
-      nodes->AddItem(node);
-    }
+    return nodes;
+  }
+  for (auto nodeIt = nameIt->second.begin(); nodeIt != nameIt->second.end(); ++nodeIt)
+  {
+    nodes->AddItem(nodeIt->second);
   }
   return nodes;
 }
@@ -1988,16 +2168,13 @@ vtkMRMLNode* vtkMRMLScene::GetFirstNodeByName(const char* name)
     return node;
   }
 
-  vtkCollectionSimpleIterator it;
-  for (this->Nodes->InitTraversal(it);
-       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  this->UpdateNodeIndexes();
+  auto nameIt = this->NodesByName.find(name);
+  if (nameIt == this->NodesByName.end() || nameIt->second.empty())
   {
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name))
-    {
-      return node;
-    }
+    return nullptr;
   }
-  return nullptr;
+  return nameIt->second.begin()->second;
 }
 
 //------------------------------------------------------------------------------
@@ -2057,13 +2234,17 @@ vtkCollection* vtkMRMLScene::GetNodesByClassByName(const char* className, const
     return nodes;
   }
 
-  vtkMRMLNode *node;
-  for (int n=0; n < this->Nodes->GetNumberOfItems(); n++)
+  this->UpdateNodeIndexes();
+  auto nameIt = this->NodesByName.find(name);
+  if (nameIt == this->NodesByName.end())
   {
-    node = (vtkMRMLNode*)this->Nodes->GetItemAsObject(n);
-    if (node->GetName() != nullptr && !strcmp(node->GetName(), name) && node->IsA(className))
+    return nodes;
+  }
+  for (auto nodeIt = nameIt->second.begin(); nodeIt != nameIt->second.end(); ++nodeIt)
+  {
+    if (nodeIt->second->IsA(className))
     {
-      nodes->AddItem(node);
+      nodes->AddItem(nodeIt->second);
     }
   }
 
@@ -2156,6 +2337,8 @@ vtkMRMLNode* vtkMRMLScene::InsertAfterNode(vtkMRMLNode *item, vtkMRMLNode *n)
   }
   // cache the node so the whole scene cache stays up-to-date
   this->AddNodeID(n);
+  // node was not added at the end, so node class and name indexes need to be rebuilt
+  this->NodeIndexesMTime = 0;
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2254,6 +2437,8 @@ vtkMRMLNode* vtkMRMLScene::InsertBeforeNode(vtkMRMLNode *item, vtkMRMLNode *n)
   }
   // cache the node so the whole scene cache stays up-todate
   this->AddNodeID(n);
+  // node was not added at the end, so node class and name indexes need to be rebuilt
+  this->NodeIndexesMTime = 0;
 
   n->SetDisableModifiedEvent(modifyStatus);
 
@@ -2492,35 +2677,39 @@ void vtkMRMLScene::GetNodeReferenceIDsFromUndoStack(std::set<std::string>& refer
 {
   referenceIDs.clear();
 
-  std::list<vtkCollection*>::const_iterator undoStackIt;
+  // Most nodes are shared between undo states, so collect distinct nodes first
+  std::unordered_set<vtkMRMLNode*> undoNodes;
+  std::vector<vtkMRMLNode*> stateNodes;
+  std::list<UndoStackState>::const_iterator undoStackIt;
   for (undoStackIt = this->UndoStack.begin(); undoStackIt != this->UndoStack.end(); ++undoStackIt)
   {
-    vtkCollection* nodes = *undoStackIt;
-    for (int i = 0; i < nodes->GetNumberOfItems(); ++i)
+    this->GetUndoStateNodes(*undoStackIt, stateNodes);
+    undoNodes.insert(stateNodes.begin(), stateNodes.end());
+  }
+
+  for (vtkMRMLNode* node : undoNodes)
+  {
+    if (!node)
     {
-      vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(nodes->GetItemAsObject(i));
-      if (!node)
-      {
-        continue;
-      }
+      continue;
+    }
 
-      std::vector<std::string> roles;
-      node->GetNodeReferenceRoles(roles);
-      std::vector<std::string>::iterator roleIt;
-      for (roleIt = roles.begin(); roleIt != roles.end(); ++roleIt)
+    std::vector<std::string> roles;
+    node->GetNodeReferenceRoles(roles);
+    std::vector<std::string>::iterator roleIt;
+    for (roleIt = roles.begin(); roleIt != roles.end(); ++roleIt)
+    {
+      std::string role = *roleIt;
+      std::vector<const char*> currentReferenceIDs;
+      node->GetNodeReferenceIDs(role.c_str(), currentReferenceIDs);
+      std::vector<const char*>::iterator referenceIDIt;
+      for (referenceIDIt = currentReferenceIDs.begin(); referenceIDIt != currentReferenceIDs.end(); ++referenceIDIt)
       {
-        std::string role = *roleIt;
-        std::vector<const char*> currentReferenceIDs;
-        node->GetNodeReferenceIDs(role.c_str(), currentReferenceIDs);
-        std::vector<const char*>::iterator referenceIDIt;
-        for (referenceIDIt = currentReferenceIDs.begin(); referenceIDIt != currentReferenceIDs.end(); ++referenceIDIt)
+        if (!(*referenceIDIt))
         {
-          if (!(*referenceIDIt))
-          {
-            continue;
-          }
-          referenceIDs.insert(*referenceIDIt);
+          continue;
         }
+        referenceIDs.insert(*referenceIDIt);
       }
     }
   }
@@ -2755,7 +2944,7 @@ void vtkMRMLScene::SaveStateForUndo ()
 }
 
 //------------------------------------------------------------------------------
-// Make a new collection that has pointers to all the nodes in the current scene
+// Make a new state that has pointers to all the nodes in the current scene
 void vtkMRMLScene::PushIntoUndoStack()
 {
   if (this->Nodes == nullptr)
@@ -2763,27 +2952,14 @@ void vtkMRMLScene::PushIntoUndoStack()
     return;
   }
 
-  vtkCollection* newScene = vtkCollection::New();
-
-  vtkCollection* currentScene = this->Nodes;
-
-  int nnodes = currentScene->GetNumberOfItems();
-
-  for (int n=0; n<nnodes; n++)
-  {
-    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(currentScene->GetItemAsObject(n));
-    if (node && node->GetUndoEnabled())
-    {
-      newScene->AddItem(node);
-    }
-  }
-
-  this->UndoStack.push_back(newScene);
+  UndoStackState newState;
+  newState.Nodes = this->GetUndoEnabledNodes();
+  this->UndoStack.push_back(newState);
   this->TrimUndoStack();
 }
 
 //------------------------------------------------------------------------------
-// Make a new collection that has pointers to the current scene nodes
+// Make a new state that has pointers to the current scene nodes
 void vtkMRMLScene::PushIntoRedoStack()
 {
   if (this->Nodes == nullptr)
@@ -2791,22 +2967,9 @@ void vtkMRMLScene::PushIntoRedoStack()
     return;
   }
 
-  vtkCollection* newScene = vtkCollection::New();
-
-  vtkCollection* currentScene = this->Nodes;
-
-  int nnodes = currentScene->GetNumberOfItems();
-
-  for (int n=0; n<nnodes; n++)
-  {
-    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(currentScene->GetItemAsObject(n));
-    if (node && node->GetUndoEnabled())
-    {
-      newScene->AddItem(node);
-    }
-  }
-
-  this->RedoStack.push_back(newScene);
+  UndoStackState newState;
+  newState.Nodes = this->GetUndoEnabledNodes();
+  this->RedoStack.push_back(newState);
 }
 
 //------------------------------------------------------------------------------
@@ -2819,25 +2982,15 @@ void vtkMRMLScene::CopyNodeInUndoStack(vtkMRMLNode *copyNode)
     vtkErrorMacro("CopyNodeInUndoStack: node is null");
     return;
   }
-
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != nullptr)
+  if (this->UndoStack.empty())
   {
-    snode->CopyWithScene(copyNode);
+    return;
   }
-
-  vtkCollection* undoScene = this->UndoStack.back();
-  int nnodes = undoScene->GetNumberOfItems();
-  for (int n=0; n<nnodes; n++)
+  vtkSmartPointer<vtkMRMLNode> snode = this->GetNodeCopyForUndo(copyNode);
+  if (snode)
   {
-    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(undoScene->GetItemAsObject(n));
-    if (node == copyNode)
-    {
-      undoScene->ReplaceItem (n, snode);
-      break;
-    }
+    this->UndoStack.back().NodeCopies[copyNode] = snode;
   }
-  snode->Delete();
 }
 
 //------------------------------------------------------------------------------
@@ -2850,23 +3003,128 @@ void vtkMRMLScene::CopyNodeInRedoStack(vtkMRMLNode *copyNode)
     vtkErrorMacro("CopyNodeInRedoStack: node is null");
     return;
   }
-  vtkMRMLNode *snode = copyNode->CreateNodeInstance();
-  if (snode != nullptr)
+  if (this->RedoStack.empty())
+  {
+    return;
+  }
+  vtkSmartPointer<vtkMRMLNode> snode = this->GetNodeCopyForUndo(copyNode);
+  if (snode)
   {
-    snode->CopyWithScene(copyNode);
+    this->RedoStack.back().NodeCopies[copyNode] = snode;
   }
-  vtkCollection* undoScene = this->RedoStack.back();
-  int nnodes = undoScene->GetNumberOfItems();
-  for (int n=0; n<nnodes; n++)
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr< const std::vector< vtkSmartPointer<vtkMRMLNode> > > vtkMRMLScene::GetUndoEnabledNodes()
+{
+  std::shared_ptr< const std::vector< vtkSmartPointer<vtkMRMLNode> > > undoEnabledNodes = this->UndoEnabledNodes.lock();
+  if (undoEnabledNodes && this->Nodes->GetMTime() <= this->UndoEnabledNodesMTime)
+  {
+    // No nodes have been added or removed since the list was created,
+    // reuse the list that the previous undo states use.
+    return undoEnabledNodes;
+  }
+
+  std::shared_ptr< std::vector< vtkSmartPointer<vtkMRMLNode> > > nodes =
+    std::make_shared< std::vector< vtkSmartPointer<vtkMRMLNode> > >();
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
   {
-    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(undoScene->GetItemAsObject(n));
-    if (node == copyNode)
+    if (node->GetUndoEnabled())
     {
-      undoScene->ReplaceItem (n, snode);
-      break;
+      nodes->push_back(node);
+    }
+  }
+  this->UndoEnabledNodes = nodes;
+  this->UndoEnabledNodesMTime = this->Nodes->GetMTime();
+  return nodes;
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLNode> vtkMRMLScene::GetNodeCopyForUndo(vtkMRMLNode *node)
+{
+  vtkMTimeType contentMTime = node->GetContentMTime();
+  UndoNodeCopy& lastCopy = this->UndoNodeCopies[node];
+  // Node content may be changed without updating its modified time
+  // while modified events are disabled, therefore always make a new copy then.
+  if (lastCopy.Copy && contentMTime <= lastCopy.ContentMTime && !node->GetDisableModifiedEvent())
+  {
+    // Node has not been modified since the last copy was made, share that copy
+    return lastCopy.Copy.GetPointer();
+  }
+  vtkSmartPointer<vtkMRMLNode> nodeCopy = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+  if (!nodeCopy)
+  {
+    return nullptr;
+  }
+  // Data objects that have not changed since the last copy are shared with it
+  nodeCopy->CopyForUndo(node, lastCopy.Copy, lastCopy.ContentMTime);
+  lastCopy.ContentMTime = contentMTime;
+  lastCopy.Copy = nodeCopy;
+  return nodeCopy;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::GetUndoStateNodes(const UndoStackState& state, std::vector<vtkMRMLNode*>& nodes) const
+{
+  nodes.clear();
+  if (!state.Nodes)
+  {
+    return;
+  }
+  nodes.reserve(state.Nodes->size());
+  for (const vtkSmartPointer<vtkMRMLNode>& node : *state.Nodes)
+  {
+    std::unordered_map< vtkMRMLNode*, vtkSmartPointer<vtkMRMLNode> >::const_iterator copyIt = state.NodeCopies.find(node);
+    nodes.push_back(copyIt != state.NodeCopies.end() ? copyIt->second.GetPointer() : node.GetPointer());
+  }
+}
+
+//------------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLNode> vtkMRMLScene::GetNodeToRestoreFromUndo(const UndoStackState& state, vtkMRMLNode* node)
+{
+  for (const auto& nodeCopy : state.NodeCopies)
+  {
+    if (nodeCopy.second.GetPointer() == node)
+    {
+      // Node copies may be shared between undo states, therefore
+      // a new copy is added to the scene instead of the stored copy.
+      vtkSmartPointer<vtkMRMLNode> restoredNode = vtkSmartPointer<vtkMRMLNode>::Take(node->CreateNodeInstance());
+      restoredNode->CopyWithScene(node);
+      return restoredNode;
+    }
+  }
+  return node;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::UndoEnabledModified()
+{
+  // List of undo-enabled nodes must be recreated for the next undo state
+  this->UndoEnabledNodes.reset();
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLScene::RemoveUnusedUndoNodeCopies()
+{
+  if (this->UndoStack.empty() && this->RedoStack.empty())
+  {
+    this->UndoNodeCopies.clear();
+    return;
+  }
+  for (auto copyIt = this->UndoNodeCopies.begin(); copyIt != this->UndoNodeCopies.end();)
+  {
+    if (!copyIt->second.Copy)
+    {
+      copyIt = this->UndoNodeCopies.erase(copyIt);
+    }
+    else
+    {
+      ++copyIt;
     }
   }
-  snode->Delete();
 }
 
 //------------------------------------------------------------------------------
@@ -2887,93 +3145,78 @@ void vtkMRMLScene::Undo()
   this->StartState(vtkMRMLScene::UndoState);
   this->RemoveUnusedNodeReferences();
 
-  int nnodes;
-  int n;
-  unsigned int nn;
-
   this->PushIntoRedoStack();
 
-  vtkCollection* currentScene = this->Nodes;
   // We use 2 vectors instead of a map in order to keep the ordering of the
   // nodes.
   std::vector<std::string> currentIDs;
   std::vector<vtkMRMLNode*> currentNodes;
-  nnodes = currentScene->GetNumberOfItems();
-  for (n=0; n<nnodes; n++)
+  std::unordered_map<std::string, size_t> currentNodeIndices;
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
   {
-    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(currentScene->GetItemAsObject(n));
-    if (node && node->GetUndoEnabled())
+    if (node->GetUndoEnabled() && node->GetID())
     {
+      currentNodeIndices[node->GetID()] = currentNodes.size();
       currentIDs.emplace_back(node->GetID());
       currentNodes.push_back(node);
     }
   }
 
-  vtkCollection* undoScene = nullptr;
-  std::vector<std::string> undoIDs;
+  UndoStackState& undoState = this->UndoStack.back();
   std::vector<vtkMRMLNode*> undoNodes;
-
-  if (!this->UndoStack.empty())
+  std::unordered_set<std::string> undoIDs;
+  std::vector<vtkMRMLNode*> undoStateNodes;
+  this->GetUndoStateNodes(undoState, undoStateNodes);
+  for (vtkMRMLNode* undoNode : undoStateNodes)
   {
-    undoScene = this->UndoStack.back();
-    nnodes = undoScene->GetNumberOfItems();
-    for (n=0; n<nnodes; n++)
+    if (undoNode && undoNode->GetUndoEnabled() && undoNode->GetID())
     {
-      vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(undoScene->GetItemAsObject(n));
-      if (node && node->GetUndoEnabled())
-      {
-        undoIDs.emplace_back(node->GetID());
-        undoNodes.push_back(node);
-      }
+      undoIDs.insert(undoNode->GetID());
+      undoNodes.push_back(undoNode);
     }
   }
 
-  std::vector<std::string>::iterator iterID;
-  std::vector<vtkMRMLNode*>::iterator iterNode;
-  std::vector<std::string>::iterator curIterID;
-  std::vector<vtkMRMLNode*>::iterator curIterNode;
-
   // copy back changes and add deleted nodes to the current scene
-  std::vector<vtkMRMLNode*> addNodes;
-
-  for(iterID=undoIDs.begin(), iterNode = undoNodes.begin(); iterID != undoIDs.end(); iterID++, iterNode++)
+  std::vector<vtkSmartPointer<vtkMRMLNode> > addNodes;
+  for (vtkMRMLNode* undoNode : undoNodes)
   {
-    curIterID = std::find(currentIDs.begin(), currentIDs.end(), *iterID);
-    curIterNode = currentNodes.begin() + std::distance(currentIDs.begin(), curIterID);
-    if ( curIterID == currentIDs.end() )
+    std::unordered_map<std::string, size_t>::iterator currentIt = currentNodeIndices.find(undoNode->GetID());
+    if (currentIt == currentNodeIndices.end())
     {
       // the node was deleted, add Node back to the current scene
-      addNodes.push_back(*iterNode);
+      addNodes.push_back(this->GetNodeToRestoreFromUndo(undoState, undoNode));
     }
-    else if (*iterNode != *curIterNode)
+    else if (undoNode != currentNodes[currentIt->second])
     {
       // nodes differ, copy from undo to current scene
       // but before create a copy in redo stack from current
-      this->CopyNodeInRedoStack(*curIterNode);
-      (*curIterNode)->CopyWithScene(*iterNode);
+      vtkMRMLNode* currentNode = currentNodes[currentIt->second];
+      this->CopyNodeInRedoStack(currentNode);
+      currentNode->CopyWithScene(undoNode);
     }
   }
 
   // remove new nodes created before Undo
   std::vector<vtkMRMLNode*> removeNodes;
-  for(curIterID=currentIDs.begin(), curIterNode = currentNodes.begin(); curIterID != currentIDs.end(); curIterID++, curIterNode++)
+  for (size_t currentIndex = 0; currentIndex < currentIDs.size(); ++currentIndex)
   {
-    iterID = std::find(undoIDs.begin(),undoIDs.end(), *curIterID);
     // Remove only if the node is not present in the previous state.
-    if ( iterID == undoIDs.end() )
+    if (undoIDs.find(currentIDs[currentIndex]) == undoIDs.end())
     {
-      removeNodes.push_back(*curIterNode);
+      removeNodes.push_back(currentNodes[currentIndex]);
     }
   }
 
-  for (nn=0; nn<addNodes.size(); nn++)
+  for (vtkMRMLNode* nodeToAdd : addNodes)
   {
-    this->AddNode(addNodes[nn]);
-    addNodes[nn]->SetSceneReferences();
+    this->AddNode(nodeToAdd);
+    nodeToAdd->SetSceneReferences();
   }
-  for (nn=0; nn<removeNodes.size(); nn++)
+  for (vtkMRMLNode* nodeToRemove : removeNodes)
   {
-    vtkMRMLNode* nodeToRemove = removeNodes[nn];
     // Maybe the node has been removed already by a side effect of a previous
     // node removal.
     if (this->IsNodePresent(nodeToRemove))
@@ -2982,16 +3225,11 @@ void vtkMRMLScene::Undo()
     }
   }
 
-  if (undoScene)
-  {
-    undoScene->RemoveAllItems();
-    undoScene->Delete();
-  }
-
   if (!this->UndoStack.empty())
   {
-   this->UndoStack.pop_back();
+    this->UndoStack.pop_back();
   }
+  this->RemoveUnusedUndoNodeCopies();
   this->Modified();
 
   this->EndState(vtkMRMLScene::UndoState);
@@ -3014,49 +3252,33 @@ void vtkMRMLScene::Redo()
     return;
   }
 
-  int nnodes;
-  int n;
-  unsigned int nn;
-
   this->StartState(vtkMRMLScene::RedoState);
 
   this->RemoveUnusedNodeReferences();
 
   this->PushIntoUndoStack();
 
-
-  vtkCollection* currentScene = this->Nodes;
-  //std::hash_map<std::string, vtkMRMLNode*> currentMap;
   std::map<std::string, vtkWeakPointer<vtkMRMLNode> > currentMap;
-  nnodes = currentScene->GetNumberOfItems();
-  for (n=0; n<nnodes; n++)
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
   {
-    vtkMRMLNode *node  = vtkMRMLNode::SafeDownCast(currentScene->GetItemAsObject(n));
-    if (node && node->GetUndoEnabled())
+    if (node->GetUndoEnabled())
     {
       currentMap[node->GetID()] = node;
     }
   }
 
-  //std::hash_map<std::string, vtkMRMLNode*> undoMap;
   std::map<std::string, vtkWeakPointer<vtkMRMLNode> > undoMap;
-
-  vtkCollection* undoScene = nullptr;
-
-  if (!this->RedoStack.empty())
+  UndoStackState& redoState = this->RedoStack.back();
+  std::vector<vtkMRMLNode*> redoStateNodes;
+  this->GetUndoStateNodes(redoState, redoStateNodes);
+  for (vtkMRMLNode* redoNode : redoStateNodes)
   {
-    undoScene = this->RedoStack.back();
-    if (undoScene)
+    if (redoNode && redoNode->GetUndoEnabled())
     {
-      nnodes = undoScene->GetNumberOfItems();
-      for (n=0; n<nnodes; n++)
-      {
-        vtkMRMLNode *node = vtkMRMLNode::SafeDownCast(undoScene->GetItemAsObject(n));
-        if (node && node->GetUndoEnabled())
-        {
-          undoMap[node->GetID()] = node;
-        }
-      }
+      undoMap[redoNode->GetID()] = redoNode;
     }
   }
 
@@ -3064,14 +3286,17 @@ void vtkMRMLScene::Redo()
   std::map<std::string, vtkWeakPointer<vtkMRMLNode> >::iterator curIter;
 
   // copy back changes and add deleted nodes to the current scene
-  std::vector<vtkWeakPointer<vtkMRMLNode> > addNodes;
+  std::vector<vtkSmartPointer<vtkMRMLNode> > addNodes;
   for(iter=undoMap.begin(); iter != undoMap.end(); iter++)
   {
     curIter = currentMap.find(iter->first);
     if ( curIter == currentMap.end() )
     {
       // the node was deleted, add Node back to the current scene
-      addNodes.push_back(iter->second);
+      if (iter->second)
+      {
+        addNodes.push_back(this->GetNodeToRestoreFromUndo(redoState, iter->second));
+      }
     }
     else if (!curIter->second || !iter->second)
     {
@@ -3103,21 +3328,17 @@ void vtkMRMLScene::Redo()
     }
   }
 
-  for (nn=0; nn<addNodes.size(); nn++)
+  for (vtkMRMLNode* nodeToAdd : addNodes)
   {
-    this->AddNode(addNodes[nn]);
+    this->AddNode(nodeToAdd);
   }
-  for (nn=0; nn<removeNodes.size(); nn++)
+  for (vtkMRMLNode* nodeToRemove : removeNodes)
   {
-    this->RemoveNode(removeNodes[nn]);
+    this->RemoveNode(nodeToRemove);
   }
 
-  if (undoScene)
-  {
-    undoScene->RemoveAllItems();
-    undoScene->Delete();
-  }
   this->RedoStack.pop_back();
+  this->RemoveUnusedUndoNodeCopies();
   this->Modified();
 
   this->EndState(vtkMRMLScene::RedoState);
@@ -3126,25 +3347,19 @@ void vtkMRMLScene::Redo()
 //------------------------------------------------------------------------------
 void vtkMRMLScene::ClearUndoStack()
 {
-  std::list< vtkCollection* >::iterator iter;
-  for(iter=this->UndoStack.begin(); iter != this->UndoStack.end(); iter++)
-  {
-    (*iter)->RemoveAllItems();
-    (*iter)->Delete();
-  }
   this->UndoStack.clear();
+  this->RemoveUnusedUndoNodeCopies();
 }
 
 //------------------------------------------------------------------------------
 void vtkMRMLScene::ClearRedoStack()
 {
-  std::list< vtkCollection* >::iterator iter;
-  for(iter=this->RedoStack.begin(); iter != this->RedoStack.end(); iter++)
+  if (this->RedoStack.empty())
   {
-    (*iter)->RemoveAllItems();
-    (*iter)->Delete();
+    return;
   }
   this->RedoStack.clear();
+  this->RemoveUnusedUndoNodeCopies();
 }
 
 //------------------------------------------------------------------------------
@@ -3488,6 +3703,244 @@ void vtkMRMLScene::ClearNodeIDs()
   }
 }
 
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeIndexes()
+{
+  if (!this->Nodes)
+  {
+    return;
+  }
+  if (this->NodeIndexesMTime != 0
+    && this->Nodes->GetMTime() <= this->NodeIndexesMTime
+    && this->NodeIndexEntries.size() == static_cast<size_t>(this->Nodes->GetNumberOfItems()))
+  {
+    // Indexes are up-to-date
+    return;
+  }
+  this->ClearNodeIndexes();
+#ifdef MRMLSCENE_VERBOSE
+  std::cerr << "Recompute node class and name indexes..." << std::endl;
+#endif
+  vtkMRMLNode *node;
+  vtkCollectionSimpleIterator it;
+  for (this->Nodes->InitTraversal(it);
+       (node = (vtkMRMLNode*)this->Nodes->GetNextItemAsObject(it)) ;)
+  {
+    this->InsertNodeIntoIndexes(node);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::AddNodeToIndexes(vtkMRMLNode *node)
+{
+  if (!this->Nodes || !node)
+  {
+    return;
+  }
+  if (this->NodeIndexesMTime == 0
+    || this->NodeIndexEntries.size() + 1 != static_cast<size_t>(this->Nodes->GetNumberOfItems()))
+  {
+    // Indexes are not up-to-date, they will be rebuilt in UpdateNodeIndexes()
+    this->NodeIndexesMTime = 0;
+    return;
+  }
+  this->InsertNodeIntoIndexes(node);
+  this->NodeIndexesMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::InsertNodeIntoIndexes(vtkMRMLNode *node)
+{
+  NodeIndexEntry& entry = this->NodeIndexEntries[node];
+  entry.Order = this->NextNodeIndexOrder++;
+  entry.HasName = (node->GetName() != nullptr);
+  entry.Name = (entry.HasName ? node->GetName() : "");
+  this->NodesByClass[node->GetClassName()].Nodes[entry.Order] = node;
+  if (entry.HasName)
+  {
+    this->NodesByName[entry.Name][entry.Order] = node;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveNodeFromIndexes(vtkMRMLNode *node)
+{
+  if (!this->Nodes || !node || this->NodeIndexesMTime == 0)
+  {
+    return;
+  }
+  auto entryIt = this->NodeIndexEntries.find(node);
+  if (entryIt == this->NodeIndexEntries.end()
+    || this->NodeIndexEntries.size() != static_cast<size_t>(this->Nodes->GetNumberOfItems()) + 1)
+  {
+    // Indexes are not up-to-date, they will be rebuilt in UpdateNodeIndexes()
+    this->NodeIndexesMTime = 0;
+    return;
+  }
+  const NodeIndexEntry& entry = entryIt->second;
+  auto classIt = this->NodesByClass.find(node->GetClassName());
+  if (classIt != this->NodesByClass.end())
+  {
+    classIt->second.Nodes.erase(entry.Order);
+  }
+  if (entry.HasName)
+  {
+    auto nameIt = this->NodesByName.find(entry.Name);
+    if (nameIt != this->NodesByName.end())
+    {
+      nameIt->second.erase(entry.Order);
+      if (nameIt->second.empty())
+      {
+        this->NodesByName.erase(nameIt);
+      }
+    }
+  }
+  this->NodeIndexEntries.erase(entryIt);
+  this->NodeIndexesMTime = this->Nodes->GetMTime();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::ClearNodeIndexes()
+{
+  if (this->Nodes)
+  {
+    this->NodeIndexEntries.clear();
+    this->NodesByClass.clear();
+    this->NodesByName.clear();
+    this->NextNodeIndexOrder = 0;
+    this->NodeIndexesMTime = this->Nodes->GetMTime();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMRMLScene::UpdateNodeNameIndex(vtkMRMLNode *node)
+{
+  auto entryIt = this->NodeIndexEntries.find(node);
+  if (entryIt == this->NodeIndexEntries.end())
+  {
+    // Node is not indexed (yet)
+    return;
+  }
+  NodeIndexEntry& entry = entryIt->second;
+  bool hasName = (node->GetName() != nullptr);
+  if (hasName == entry.HasName && (!hasName || entry.Name == node->GetName()))
+  {
+    return;
+  }
+  if (entry.HasName)
+  {
+    auto nameIt = this->NodesByName.find(entry.Name);
+    if (nameIt != this->NodesByName.end())
+    {
+      nameIt->second.erase(entry.Order);
+      if (nameIt->second.empty())
+      {
+        this->NodesByName.erase(nameIt);
+      }
+    }
+  }
+  entry.HasName = hasName;
+  entry.Name = (hasName ? node->GetName() : "");
+  if (entry.HasName)
+  {
+    this->NodesByName[entry.Name][entry.Order] = node;
+  }
+}
+
+//-----------------------------------------------------------------------------
+int vtkMRMLScene::GetIndexedNodesByClass(const char* className, std::vector<vtkMRMLNode*>& nodes, int maxNumberOfNodes/*=-1*/)
+{
+  nodes.clear();
+  this->UpdateNodeIndexes();
+
+  // Find classes that are the requested class or its subclasses
+  std::vector<std::map< vtkIdType, vtkMRMLNode* >*> classNodes;
+  size_t numberOfNodes = 0;
+  const std::string classNameStr(className);
+  for (auto& classIndex : this->NodesByClass)
+  {
+    if (classIndex.second.Nodes.empty())
+    {
+      continue;
+    }
+    auto isAIt = classIndex.second.IsA.find(classNameStr);
+    if (isAIt == classIndex.second.IsA.end())
+    {
+      // All nodes in the class index have the same class, so it is enough to check the first one
+      bool isA = (classIndex.second.Nodes.begin()->second->IsA(className) != 0);
+      isAIt = classIndex.second.IsA.insert(std::make_pair(classNameStr, isA)).first;
+    }
+    if (isAIt->second)
+    {
+      classNodes.push_back(&classIndex.second.Nodes);
+      numberOfNodes += classIndex.second.Nodes.size();
+    }
+  }
+  const int totalNumberOfNodes = static_cast<int>(numberOfNodes);
+  if (maxNumberOfNodes >= 0 && static_cast<size_t>(maxNumberOfNodes) < numberOfNodes)
+  {
+    numberOfNodes = static_cast<size_t>(maxNumberOfNodes);
+  }
+  nodes.reserve(numberOfNodes);
+
+  if (classNodes.size() == 1)
+  {
+    for (auto nodeIt = classNodes[0]->begin(); nodeIt != classNodes[0]->end() && nodes.size() < numberOfNodes; ++nodeIt)
+    {
+      nodes.push_back(nodeIt->second);
+    }
+    return totalNumberOfNodes;
+  }
+
+  if (maxNumberOfNodes < 0)
+  {
+    // Sort all nodes of multiple classes by their position in the scene
+    std::vector<std::pair<vtkIdType, vtkMRMLNode*> > orderedNodes;
+    orderedNodes.reserve(numberOfNodes);
+    for (std::map< vtkIdType, vtkMRMLNode* >* nodesOfClass : classNodes)
+    {
+      orderedNodes.insert(orderedNodes.end(), nodesOfClass->begin(), nodesOfClass->end());
+    }
+    std::sort(orderedNodes.begin(), orderedNodes.end());
+    for (const std::pair<vtkIdType, vtkMRMLNode*>& orderedNode : orderedNodes)
+    {
+      nodes.push_back(orderedNode.second);
+    }
+    return totalNumberOfNodes;
+  }
+
+  // Merge the first few nodes of multiple classes by their position in the scene
+  std::vector<std::pair<std::map< vtkIdType, vtkMRMLNode* >::iterator, std::map< vtkIdType, vtkMRMLNode* >::iterator> > ranges;
+  for (std::map< vtkIdType, vtkMRMLNode* >* nodesOfClass : classNodes)
+  {
+    ranges.emplace_back(nodesOfClass->begin(), nodesOfClass->end());
+  }
+  while (nodes.size() < numberOfNodes)
+  {
+    size_t firstRangeIndex = 0;
+    bool found = false;
+    for (size_t rangeIndex = 0; rangeIndex < ranges.size(); ++rangeIndex)
+    {
+      if (ranges[rangeIndex].first == ranges[rangeIndex].second)
+      {
+        continue;
+      }
+      if (!found || ranges[rangeIndex].first->first < ranges[firstRangeIndex].first->first)
+      {
+        firstRangeIndex = rangeIndex;
+        found = true;
+      }
+    }
+    if (!found)
+    {
+      break;
+    }
+    nodes.push_back(ranges[firstRangeIndex].first->second);
+    ++ranges[firstRangeIndex].first;
+  }
+  return totalNumberOfNodes;
+}
+
 //------------------------------------------------------------------------------
 void vtkMRMLScene::AddURIHandler(vtkURIHandler *handler)
 {
@@ -3854,12 +4307,18 @@ void vtkMRMLScene::SetMaximumNumberOfSavedUndoStates(int stackSize)
 //-----------------------------------------------------------------------------
 void vtkMRMLScene::TrimUndoStack()
 {
-  std::list<vtkSmartPointer<vtkCollection> > removedStacks;
-  while(static_cast<int>(this->UndoStack.size()) > this->MaximumNumberOfSavedUndoStates)
+  if (static_cast<int>(this->UndoStack.size()) <= this->MaximumNumberOfSavedUndoStates)
   {
-    removedStacks.emplace_back(this->UndoStack.front());
-    this->UndoStack.pop_front();
+    return;
+  }
+  {
+    std::list<UndoStackState> removedStates;
+    while(static_cast<int>(this->UndoStack.size()) > this->MaximumNumberOfSavedUndoStates)
+    {
+      removedStates.splice(removedStates.end(), this->UndoStack, this->UndoStack.begin());
+    }
   }
+  this->RemoveUnusedUndoNodeCopies();
 }
 
 //----------------------------------------------------------------------------
@@ -3930,22 +4389,40 @@ bool vtkMRMLScene::WriteToMRB(const char* filename, vtkImageData* thumbnail/*=nu
   }
 
   //
-  // Now save the scene into the bundle directory and then make a zip (mrb) file
-  // in the user's selected file location
+  // Now save the scene into the bundle directory and stream the written files into
+  // a zip (mrb) file in the user's selected file location. Files of each storable node
+  // are added to the archive right after the node is written, therefore the temporary
+  // directory only holds the data of one node at a time.
   //
-  bool retval = this->SaveSceneToSlicerDataBundleDirectory(bundleDir.c_str(), thumbnail, userMessages);
-  if (!retval)
+  vtkDebugMacro("Zipping to " << mrbFilePath);
+  vtkNew<vtkArchive> archive;
+  if (!archive->OpenZip(mrbFilePath.c_str())
+    || !archive->AddZipDirectoryEntry((mrbBaseName + "/").c_str()))
   {
     vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::WriteToMRB",
-      "Failed to save " << filename << ": Failed to save scene to data bundle directory");
+      "Failed to save " << filename << ": Could not create bundle file");
+    archive->CloseZip();
+    vtksys::SystemTools::RemoveADirectory(tempDir);
     return false;
   }
-
-  vtkDebugMacro("Zipping to " << mrbFilePath);
-  if (!vtkArchive::Zip(mrbFilePath.c_str(), bundleDir.c_str()))
+  this->WriteBundleArchive = archive;
+  this->WriteBundleBaseDirectory = tempDir;
+  bool retval = this->SaveSceneToSlicerDataBundleDirectory(bundleDir.c_str(), thumbnail, userMessages);
+  this->WriteBundleArchive = nullptr;
+  this->WriteBundleBaseDirectory.clear();
+  this->WriteBundleAddedFiles.clear();
+  if (!archive->CloseZip() && retval)
   {
     vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::WriteToMRB",
       "Failed to save " << filename << ": Could not compress bundle");
+    retval = false;
+  }
+  if (!retval)
+  {
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::WriteToMRB",
+      "Failed to save " << filename << ": Failed to save scene to data bundle");
+    vtksys::SystemTools::RemoveFile(mrbFilePath);
+    vtksys::SystemTools::RemoveADirectory(tempDir);
     return false;
   }
 
@@ -4009,8 +4486,82 @@ bool vtkMRMLScene::ReadFromMRB(const char* fullName, bool clear/*=false*/, vtkMR
     return false;
   }
 
-  std::string mrmlFile = vtkMRMLScene::UnpackSlicerDataBundle(fullName, unpackDir.c_str());
+  // The scene file is read directly from the bundle. Files of storable nodes are
+  // extracted when the node is read and removed right after (unless the node keeps
+  // reading data from them), so that the bundle does not need to be extracted in full.
+  std::vector<std::string> entryNames;
+  if (!vtkArchive::ListArchive(fullName, entryNames))
+  {
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::ReadFromMRB",
+      "Could not open bundle file '" << fullName << "'.");
+    vtksys::SystemTools::RemoveADirectory(unpackDir);
+    return false;
+  }
+  // Use the mrml file that is closest to the root of the bundle
+  std::string mrmlEntryName;
+  for (const std::string& entryName : entryNames)
+  {
+    if (vtksys::SystemTools::GetFilenameLastExtension(entryName) == ".mrml"
+      && (mrmlEntryName.empty()
+        || std::count(entryName.begin(), entryName.end(), '/') < std::count(mrmlEntryName.begin(), mrmlEntryName.end(), '/')))
+    {
+      mrmlEntryName = entryName;
+    }
+  }
+  if (mrmlEntryName.empty())
+  {
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::ReadFromMRB",
+      "Could not find mrml file in bundle '" << fullName << "'.");
+    vtksys::SystemTools::RemoveADirectory(unpackDir);
+    return false;
+  }
+  std::vector<std::string> entryNamesToExtract;
+  for (const std::string& entryName : entryNames)
+  {
+    if (entryName.empty() || entryName.back() == '/')
+    {
+      continue;
+    }
+    if (entryName == mrmlEntryName)
+    {
+      continue;
+    }
+    if (entryName.find("/ScreenCaptures/") != std::string::npos)
+    {
+      // Legacy scene view screen captures are read while the scene file is parsed
+      entryNamesToExtract.push_back(entryName);
+      continue;
+    }
+    // Empty placeholder files let storage nodes find their files when the scene file is parsed
+    std::string placeholderFile = unpackDir + "/" + entryName;
+    vtksys::SystemTools::MakeDirectory(vtksys::SystemTools::GetFilenamePath(placeholderFile));
+    vtksys::SystemTools::Touch(placeholderFile, true);
+  }
+  // Extraction changes the current directory, therefore the bundle is referred to by its full path
+  std::string bundleFileName = vtksys::SystemTools::CollapseFullPath(fullName);
+  std::string sceneXMLString;
+  if (!vtkArchive::ReadZipEntry(bundleFileName.c_str(), mrmlEntryName.c_str(), sceneXMLString)
+    || !vtkArchive::UnZipFiles(bundleFileName.c_str(), unpackDir.c_str(), entryNamesToExtract))
+  {
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::ReadFromMRB",
+      "Could not read scene file from bundle '" << fullName << "'.");
+    vtksys::SystemTools::RemoveADirectory(unpackDir);
+    return false;
+  }
+
+  // Storage node file names are resolved relative to the location of the
+  // scene file in the unpack directory
+  std::string mrmlFile = unpackDir + "/" + mrmlEntryName;
   this->SetURL(mrmlFile.c_str());
+  this->SetRootDirectory(vtksys::SystemTools::GetParentDirectory(mrmlFile).c_str());
+  int loadFromXMLString = this->GetLoadFromXMLString();
+  this->SetSceneXMLString(sceneXMLString);
+  sceneXMLString.clear();
+  this->SetLoadFromXMLString(1);
+  this->ReadBundleFileName = bundleFileName;
+  this->ReadBundleUnpackDirectory = vtksys::SystemTools::CollapseFullPath(unpackDir);
+  this->ReadBundleEntryNames = std::set<std::string>(entryNames.begin(), entryNames.end());
+  this->ReadBundleFilesInUse = false;
   int success = false;
   if (clear)
   {
@@ -4020,7 +4571,19 @@ bool vtkMRMLScene::ReadFromMRB(const char* fullName, bool clear/*=false*/, vtkMR
   {
     success = this->Import(userMessages);
   }
-  if (!vtksys::SystemTools::RemoveADirectory(unpackDir))
+  this->SetLoadFromXMLString(loadFromXMLString);
+  this->SetSceneXMLString(std::string());
+  this->ReadBundleFileName.clear();
+  this->ReadBundleUnpackDirectory.clear();
+  this->ReadBundleEntryNames.clear();
+  if (this->ReadBundleFilesInUse)
+  {
+    // Nodes still read data from extracted files, remove them when the scene is cleared
+    vtkDebugMacro("ReadFromMRB: files in " << unpackDir << " are in use, the directory is removed when the scene is cleared");
+    this->RetainedBundleDirectories.push_back(unpackDir);
+    this->ReadBundleFilesInUse = false;
+  }
+  else if (!vtksys::SystemTools::RemoveADirectory(unpackDir))
   {
     vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::ReadFromMRB",
       "vtkMRMLScene::ReadFromMRB failed: cannot remove directory '" << unpackDir << "'");
@@ -4095,6 +4658,169 @@ bool vtkMRMLScene::ReadFromMRB(const char* fullName, bool clear/*=false*/, vtkMR
   return success;
 }
 
+//----------------------------------------------------------------------------
+double vtkMRMLScene::GetNodeReadTime(const char* nodeID)
+{
+  if (!nodeID)
+  {
+    return -1.0;
+  }
+  std::map<std::string, double>::iterator readTimeIt = this->NodeReadTimes.find(nodeID);
+  if (readTimeIt == this->NodeReadTimes.end())
+  {
+    return -1.0;
+  }
+  return readTimeIt->second;
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> vtkMRMLScene::ExtractReadBundleFiles(vtkMRMLNode* node)
+{
+  std::vector<std::string> extractedFiles;
+  vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(node);
+  if (this->ReadBundleFileName.empty() || !storableNode)
+  {
+    return extractedFiles;
+  }
+
+  // Get the entry names of storage node files
+  const std::string unpackDirectory = this->ReadBundleUnpackDirectory + "/";
+  std::vector<std::string> entryNames;
+  for (int storageNodeIndex = 0; storageNodeIndex < storableNode->GetNumberOfStorageNodes(); ++storageNodeIndex)
+  {
+    vtkMRMLStorageNode* storageNode = storableNode->GetNthStorageNode(storageNodeIndex);
+    if (!storageNode)
+    {
+      continue;
+    }
+    for (int i = -1; i < storageNode->GetNumberOfFileNames(); ++i)
+    {
+      const char* fileName = (i < 0 ? storageNode->GetFileName() : storageNode->GetNthFileName(i));
+      if (!fileName || !vtksys::SystemTools::StringStartsWith(fileName, unpackDirectory.c_str()))
+      {
+        continue;
+      }
+      std::string entryName = vtksys::SystemTools::CollapseFullPath(fileName).substr(unpackDirectory.size());
+      if (this->ReadBundleEntryNames.count(entryName)
+        && std::find(entryNames.begin(), entryNames.end(), entryName) == entryNames.end())
+      {
+        entryNames.push_back(entryName);
+      }
+    }
+  }
+
+  // Detached data files of NRRD headers may not be listed in the storage node
+  std::vector<std::string> headerEntryNames;
+  for (const std::string& entryName : entryNames)
+  {
+    if (vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(entryName) == ".nhdr")
+    {
+      headerEntryNames.push_back(entryName);
+    }
+  }
+  if (!this->ExtractReadBundleEntries(headerEntryNames))
+  {
+    vtkErrorMacro("ExtractReadBundleFiles: failed to extract files of node "
+      << (node->GetID() ? node->GetID() : "(unknown)") << " from " << this->ReadBundleFileName);
+  }
+  for (const std::string& headerEntryName : headerEntryNames)
+  {
+    std::string headerPath = vtksys::SystemTools::GetFilenamePath(headerEntryName);
+    for (const std::string& dataFileName : GetNrrdDetachedDataFileNames(unpackDirectory + headerEntryName))
+    {
+      std::string dataEntryName = vtksys::SystemTools::CollapseFullPath(dataFileName, this->ReadBundleUnpackDirectory + "/" + headerPath);
+      if (!vtksys::SystemTools::StringStartsWith(dataEntryName, unpackDirectory.c_str()))
+      {
+        continue;
+      }
+      dataEntryName = dataEntryName.substr(unpackDirectory.size());
+      if (this->ReadBundleEntryNames.count(dataEntryName)
+        && std::find(entryNames.begin(), entryNames.end(), dataEntryName) == entryNames.end())
+      {
+        entryNames.push_back(dataEntryName);
+      }
+    }
+  }
+
+  std::vector<std::string> remainingEntryNames;
+  for (const std::string& entryName : entryNames)
+  {
+    extractedFiles.push_back(unpackDirectory + entryName);
+    if (std::find(headerEntryNames.begin(), headerEntryNames.end(), entryName) == headerEntryNames.end())
+    {
+      remainingEntryNames.push_back(entryName);
+    }
+  }
+  if (!this->ExtractReadBundleEntries(remainingEntryNames))
+  {
+    vtkErrorMacro("ExtractReadBundleFiles: failed to extract files of node "
+      << (node->GetID() ? node->GetID() : "(unknown)") << " from " << this->ReadBundleFileName);
+  }
+  return extractedFiles;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLScene::ExtractReadBundleEntries(const std::vector<std::string>& entryNames)
+{
+  // Zip files are read using their central directory, therefore data of the other
+  // entries is skipped without decompressing it
+  return vtkArchive::UnZipFiles(this->ReadBundleFileName.c_str(), this->ReadBundleUnpackDirectory.c_str(), entryNames);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLScene::AddWrittenFilesToBundle(vtkMRMLMessageCollection* userMessages)
+{
+  if (!this->WriteBundleArchive)
+  {
+    return true;
+  }
+  vtksys::Glob glob;
+  glob.RecurseOn();
+  glob.RecurseThroughSymlinksOff();
+  if (!glob.FindFiles(this->WriteBundleBaseDirectory + "/*"))
+  {
+    vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::WriteToMRB",
+      "Could not find files in " << this->WriteBundleBaseDirectory);
+    return false;
+  }
+  std::vector<std::string> files = glob.GetFiles();
+  // entry order must not depend on the file system
+  std::sort(files.begin(), files.end());
+  bool success = true;
+  for (const std::string& fileName : files)
+  {
+    if (!this->WriteBundleAddedFiles.insert(fileName).second)
+    {
+      continue;
+    }
+    std::string entryName = vtksys::SystemTools::RelativePath(this->WriteBundleBaseDirectory, fileName);
+    if (!this->WriteBundleArchive->AddZipFileEntry(entryName.c_str(), fileName.c_str(), !IsCompressedFile(fileName)))
+    {
+      vtkErrorToMessageCollectionMacro(userMessages, "vtkMRMLScene::WriteToMRB",
+        "Could not add " << fileName << " to the bundle");
+      success = false;
+      continue;
+    }
+    // Only the content is removed, storage nodes that are written later
+    // must still see the file to choose a unique file name.
+    std::ofstream truncatedFile(fileName.c_str(), std::ios::out | std::ios::trunc | std::ios::binary);
+  }
+  return success;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLScene::RemoveRetainedBundleDirectories()
+{
+  for (const std::string& directory : this->RetainedBundleDirectories)
+  {
+    if (vtksys::SystemTools::FileIsDirectory(directory) && !vtksys::SystemTools::RemoveADirectory(directory))
+    {
+      vtkWarningMacro("RemoveRetainedBundleDirectories: cannot remove directory '" << directory << "'");
+    }
+  }
+  this->RetainedBundleDirectories.clear();
+}
+
 //----------------------------------------------------------------------------
 std::string vtkMRMLScene::UnpackSlicerDataBundle(const char* sdbFilePath, const char* temporaryDirectory, vtkMRMLMessageCollection* userMessages/*=nullptr*/)
 {
@@ -4345,6 +5071,10 @@ bool vtkMRMLScene::SaveSceneToSlicerDataBundleDirectory(const char* sdbDir,
   // write the scene to disk, changes paths to relative
   vtkDebugMacro("calling commit on the scene, to url " << this->GetURL());
   this->Commit(nullptr, userMessages);
+  if (!this->AddWrittenFilesToBundle(userMessages))
+  {
+    success = false;
+  }
 
   //
   // Now, restore the state of the scene
@@ -4609,6 +5339,10 @@ bool vtkMRMLScene::SaveStorableNodeToSlicerDataBundleDirectory(vtkMRMLStorableNo
       + (storableNode->GetID() ? storableNode->GetID() : "none") + "): ";
     userMessages->AddMessages(storageNode->GetUserMessages(), messagePrefix);
   }
+  if (!this->AddWrittenFilesToBundle(userMessages))
+  {
+    success = 0;
+  }
   return success;
 }
 
@@ -26,11 +26,14 @@ Version:   $Revision: 1.18 $
 // STD includes
 #include <list>
 #include <map>
+#include <memory>
 #include <random>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+class vtkArchive;
 class vtkCacheManager;
 class vtkDataIOManager;
 class vtkTagTable;
@@ -61,6 +64,10 @@ class VTK_MRML_EXPORT vtkMRMLScene : public vtkObject
   /// so that it can call protected methods, for example UpdateNodeIDs()
   /// but that's the only class that is allowed to do so
   friend class vtkMRMLSceneViewNode;
+  /// make the vtkMRMLNode a friend so that it can update the node name index
+  /// (UpdateNodeNameIndex()) when the node is renamed and the undo stack
+  /// (UndoEnabledModified()) when undo is enabled or disabled for the node
+  friend class vtkMRMLNode;
 
 public:
   static vtkMRMLScene *New();
@@ -95,6 +102,21 @@ public:
   /// encountered during the operation.
   int Import(vtkMRMLMessageCollection* userMessages=nullptr);
 
+  /// Number of threads used by Import() for reading data files of storable nodes.
+  /// 1 means reading all files on the main thread. Any other value enables concurrent
+  /// reading: files of independent nodes are read on worker threads using the VTK SMP
+  /// backend (see vtkSMPTools), then the data is set in the nodes on the main thread,
+  /// in the same order as the nodes are in the scene.
+  /// Default is 1 (concurrent reading is disabled).
+  /// \sa vtkMRMLStorageNode::PrefetchData()
+  vtkSetMacro(NumberOfReadThreads, int);
+  vtkGetMacro(NumberOfReadThreads, int);
+
+  /// Get time (in seconds) that was spent reading the data of a storable node
+  /// in the most recent Import(), including time spent on worker threads.
+  /// Returns -1 if the node was not read by the most recent Import().
+  double GetNodeReadTime(const char* nodeID);
+
   /// Save scene into URL
   /// If userMessages is not nullptr then the method may add messages to it about issues
   /// encountered during the operation.
@@ -847,6 +869,57 @@ protected:
   void CopyNodeInUndoStack(vtkMRMLNode *node);
   void CopyNodeInRedoStack(vtkMRMLNode *node);
 
+  /// Scene state stored in the undo or redo stack.
+  /// Nodes that have not been modified since the state was saved are only referenced
+  /// (not copied), and copies of nodes are shared between states while the node is not modified.
+  struct UndoStackState
+  {
+    /// Undo-enabled nodes of the scene at the time the state was saved.
+    /// The same list is shared between all states that are saved while no nodes are added or removed.
+    std::shared_ptr< const std::vector< vtkSmartPointer<vtkMRMLNode> > > Nodes;
+    /// Copies of nodes at the time the state was saved. Key is the node in Nodes.
+    std::unordered_map< vtkMRMLNode*, vtkSmartPointer<vtkMRMLNode> > NodeCopies;
+  };
+
+  /// Get undo-enabled nodes of the scene, shared between undo states.
+  std::shared_ptr< const std::vector< vtkSmartPointer<vtkMRMLNode> > > GetUndoEnabledNodes();
+
+  /// Get a copy of the node for storing it in an undo state.
+  /// If the node has not been modified since the last copy was made then the same copy is returned.
+  vtkSmartPointer<vtkMRMLNode> GetNodeCopyForUndo(vtkMRMLNode *node);
+
+  /// Get nodes of an undo state: copies of nodes saved in the state and the nodes
+  /// that were not modified since the state was saved.
+  void GetUndoStateNodes(const UndoStackState& state, std::vector<vtkMRMLNode*>& nodes) const;
+
+  /// Get the node that can be added to the scene to restore a node that was removed.
+  /// Stored node copies are not added to the scene directly, because they may be shared between states.
+  vtkSmartPointer<vtkMRMLNode> GetNodeToRestoreFromUndo(const UndoStackState& state, vtkMRMLNode* node);
+
+  /// Remove node copies from the cache that are not used by any undo or redo states anymore.
+  void RemoveUnusedUndoNodeCopies();
+
+  /// Called by vtkMRMLNode when UndoEnabled flag of a node in the scene is changed.
+  void UndoEnabledModified();
+
+  /// Extract files of the storage nodes of the node from the bundle that
+  /// is being read by ReadFromMRB. Files listed in the storage nodes are extracted
+  /// and the detached data files that are referenced from .nhdr headers.
+  /// Returns the list of extracted files, which can be removed when the node is read.
+  std::vector<std::string> ExtractReadBundleFiles(vtkMRMLNode* node);
+
+  /// Extract entries from the bundle that is being read by ReadFromMRB.
+  bool ExtractReadBundleEntries(const std::vector<std::string>& entryNames);
+
+  /// Add files that were written into the bundle directory since the last call
+  /// to the bundle that is being written by WriteToMRB. The content of the added files
+  /// is removed, the empty files are kept so that file names remain unique in the bundle.
+  bool AddWrittenFilesToBundle(vtkMRMLMessageCollection* userMessages);
+
+  /// Remove directories of scene bundles that were kept because nodes of the scene
+  /// used files in them (see RetainedBundleDirectories).
+  void RemoveRetainedBundleDirectories();
+
   /// Add a node to the scene without invoking a vtkMRMLScene::NodeAddedEvent event.
   ///
   /// \warning Use with extreme caution as it might unsynchronize observer.
@@ -894,6 +967,32 @@ protected:
   /// Clear NodeIDs map used to speedup GetByID() method.
   void ClearNodeIDs();
 
+  /// \brief Synchronize node class and name indexes used to speedup GetNodesByClass()
+  /// and GetNodesByName() methods with the \a Nodes collection.
+  void UpdateNodeIndexes();
+
+  /// Add node that was just appended to the \a Nodes collection to the end of
+  /// node class and name indexes.
+  void AddNodeToIndexes(vtkMRMLNode *node);
+
+  /// Insert node at the end of node class and name indexes without checking if indexes are up-to-date.
+  void InsertNodeIntoIndexes(vtkMRMLNode *node);
+
+  /// Remove node from node class and name indexes.
+  void RemoveNodeFromIndexes(vtkMRMLNode *node);
+
+  /// Clear node class and name indexes.
+  void ClearNodeIndexes();
+
+  /// Update node name index after the node was renamed. Called by vtkMRMLNode::SetName().
+  void UpdateNodeNameIndex(vtkMRMLNode *node);
+
+  /// Get nodes of a specified class (or its subclasses) from the node class index,
+  /// in the order of the \a Nodes collection.
+  /// \param maxNumberOfNodes If non-negative then at most this many nodes are returned.
+  /// \return Number of nodes of the specified class in the scene (regardless of \a maxNumberOfNodes).
+  int GetIndexedNodesByClass(const char* className, std::vector<vtkMRMLNode*>& nodes, int maxNumberOfNodes=-1);
+
   /// Get a NodeReferences iterator for a node reference.
   NodeReferencesType::iterator FindNodeReference(const char* referencedId, vtkMRMLNode* referencingNode);
 
@@ -934,8 +1033,46 @@ protected:
   int  MaximumNumberOfSavedUndoStates;
   bool UndoFlag;
 
-  std::list< vtkCollection* >  UndoStack;
-  std::list< vtkCollection* >  RedoStack;
+  std::list< UndoStackState >  UndoStack;
+  std::list< UndoStackState >  RedoStack;
+
+  /// Undo-enabled nodes of the scene (shared between undo states) and
+  /// the modified time of the node collection when the list was created.
+  /// The list is not kept alive by the scene, only by the undo states.
+  std::weak_ptr< const std::vector< vtkSmartPointer<vtkMRMLNode> > > UndoEnabledNodes;
+  vtkMTimeType UndoEnabledNodesMTime;
+
+  /// Last copy of each node made for an undo state, along with the content
+  /// modified time of the node when the copy was made.
+  /// Copies are not kept alive by this cache, only by the undo states.
+  struct UndoNodeCopy
+  {
+    vtkMTimeType ContentMTime{0};
+    vtkWeakPointer<vtkMRMLNode> Copy;
+  };
+  std::unordered_map< vtkMRMLNode*, UndoNodeCopy > UndoNodeCopies;
+
+  /// Scene bundle file that is being read by ReadFromMRB, the directory where its
+  /// files are extracted to, and the names of all entries in the bundle.
+  /// Files of storable nodes are only extracted when the node is read.
+  std::string ReadBundleFileName;
+  std::string ReadBundleUnpackDirectory;
+  std::set<std::string> ReadBundleEntryNames;
+  /// Archive that WriteToMRB streams the files of the scene into, the directory
+  /// that entry names are relative to, and the files that are already in the archive.
+  vtkArchive* WriteBundleArchive{nullptr};
+  std::string WriteBundleBaseDirectory;
+  std::set<std::string> WriteBundleAddedFiles;
+  /// Set if extracted files of the bundle that is being read are still used by nodes
+  /// after they were read (see vtkMRMLStorageNode::IsFileInUseAfterRead).
+  bool ReadBundleFilesInUse{false};
+  /// Unpack directories of scene bundles that contain files used by nodes in the scene.
+  /// They are removed when the scene is cleared or deleted.
+  std::vector<std::string> RetainedBundleDirectories;
+
+  int NumberOfReadThreads{1};
+  /// Time spent reading node data in the most recent Import(), indexed by node ID
+  std::map<std::string, double> NodeReadTimes;
 
   std::string                 URL;
   std::string                 RootDirectory;
@@ -952,6 +1089,27 @@ protected:
   std::map< std::string, std::string > ReferencedIDChanges;
   std::map< std::string, vtkSmartPointer<vtkMRMLNode> > NodeIDs;
 
+  /// Nodes stored in the node class and name indexes. Order is the position of the node
+  /// in the \a Nodes collection (positions are increasing but not necessarily consecutive).
+  struct NodeIndexEntry
+  {
+    vtkIdType Order;
+    std::string Name;
+    bool HasName;
+  };
+  std::unordered_map< vtkMRMLNode*, NodeIndexEntry > NodeIndexEntries;
+  /// Nodes of the same class (subclasses are stored separately), sorted by order.
+  struct NodeClassIndex
+  {
+    std::map< vtkIdType, vtkMRMLNode* > Nodes;
+    /// Cached results of IsA() for class names that this class was queried with
+    std::unordered_map< std::string, bool > IsA;
+  };
+  std::unordered_map< std::string, NodeClassIndex > NodesByClass;
+  /// Nodes by name, sorted by order.
+  std::unordered_map< std::string, std::map< vtkIdType, vtkMRMLNode* > > NodesByName;
+  vtkIdType NextNodeIndexOrder;
+
   // Stores default nodes. If a class is created or reset (using CreateNodeByClass or Clear) and
   // a default node is defined for it then the content of the default node will be used to initialize
   // the class. It is useful for overriding default values that are set in a node's constructor.
@@ -966,6 +1124,7 @@ protected:
   int ReadDataOnLoad;
 
   vtkMTimeType  NodeIDsMTime;
+  vtkMTimeType  NodeIndexesMTime;
 
   void RemoveAllNodes(bool removeSingletons);
 
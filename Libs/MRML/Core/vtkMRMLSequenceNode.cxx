@@ -29,6 +29,7 @@
 #include <vtkCollection.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
+#include <vtkStringArray.h>
 #include <vtkTimerLog.h>
 
 // STD includes
@@ -202,7 +203,7 @@ void vtkMRMLSequenceNode::ReadIndexValues(const std::string& indexText)
       std::string indexValue = nodeId_indexValue.substr(indexValueSeparatorPos+1, nodeId_indexValue.size()-indexValueSeparatorPos-1);
 
       IndexEntryType indexEntry;
-      indexEntry.IndexValue=indexValue;
+      indexEntry.SetIndexValue(indexValue);
       // The nodes are not read yet, so we can only store the node ID and get the pointer to the node later (in UpdateScene())
       indexEntry.DataNodeID=nodeId;
       indexEntry.DataNode=nullptr;
@@ -271,7 +272,8 @@ void vtkMRMLSequenceNode::Copy(vtkMRMLNode *anode)
   for(std::deque< IndexEntryType >::iterator sourceIndexIt=snode->IndexEntries.begin(); sourceIndexIt!=snode->IndexEntries.end(); ++sourceIndexIt)
   {
     IndexEntryType seqItem;
-    seqItem.IndexValue=sourceIndexIt->IndexValue;
+    seqItem.IndexValue = sourceIndexIt->IndexValue;
+    seqItem.NumericIndexValue = sourceIndexIt->NumericIndexValue;
     seqItem.DataNode = nullptr;
     if (sourceIndexIt->DataNode!=nullptr)
     {
@@ -313,6 +315,7 @@ void vtkMRMLSequenceNode::CopySequenceIndex(vtkMRMLNode *anode)
     {
       IndexEntryType seqItem;
       seqItem.IndexValue = sourceIndexIt->IndexValue;
+      seqItem.NumericIndexValue = sourceIndexIt->NumericIndexValue;
       if (sourceIndexIt->DataNode != nullptr)
       {
         seqItem.DataNodeID = sourceIndexIt->DataNode->GetID();
@@ -386,7 +389,7 @@ int vtkMRMLSequenceNode::GetInsertPosition(const std::string& indexValue)
   {
     int itemNumber = this->GetItemNumberFromIndexValue(indexValue, false);
     double numericIndexValue = atof(indexValue.c_str());
-    double foundNumericIndexValue = atof(this->IndexEntries[itemNumber].IndexValue.c_str());
+    double foundNumericIndexValue = this->IndexEntries[itemNumber].NumericIndexValue;
     if (numericIndexValue < foundNumericIndexValue) // Deals with case of index value being smaller than any in the sequence and numeric tolerances
     {
       insertPosition = itemNumber;
@@ -424,7 +427,7 @@ vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const st
     seqItemIndex = GetInsertPosition(indexValue);
     // Create new item
     IndexEntryType seqItem;
-    seqItem.IndexValue = indexValue;
+    seqItem.SetIndexValue(indexValue);
     this->IndexEntries.insert(this->IndexEntries.begin() + seqItemIndex, seqItem);
   }
   this->IndexEntries[seqItemIndex].DataNode = newNode;
@@ -448,6 +451,33 @@ vtkMRMLNode* vtkMRMLSequenceNode::SetDataNodeAtValue(vtkMRMLNode* node, const st
   return newNode;
 }
 
+//----------------------------------------------------------------------------
+bool vtkMRMLSequenceNode::SetDataNodesAtValues(vtkCollection* nodes, vtkStringArray* indexValues)
+{
+  if (nodes == nullptr || indexValues == nullptr)
+  {
+    vtkErrorMacro("vtkMRMLSequenceNode::SetDataNodesAtValues failed, invalid nodes or index values");
+    return false;
+  }
+  if (nodes->GetNumberOfItems() != indexValues->GetNumberOfValues())
+  {
+    vtkErrorMacro("vtkMRMLSequenceNode::SetDataNodesAtValues failed, number of nodes (" << nodes->GetNumberOfItems()
+      << ") does not match number of index values (" << indexValues->GetNumberOfValues() << ")");
+    return false;
+  }
+  MRMLNodeModifyBlocker blocker(this);
+  bool success = true;
+  for (int itemIndex = 0; itemIndex < nodes->GetNumberOfItems(); ++itemIndex)
+  {
+    vtkMRMLNode* node = vtkMRMLNode::SafeDownCast(nodes->GetItemAsObject(itemIndex));
+    if (!this->SetDataNodeAtValue(node, indexValues->GetValue(itemIndex)))
+    {
+      success = false;
+    }
+  }
+  return success;
+}
+
 //----------------------------------------------------------------------------
 void vtkMRMLSequenceNode::RemoveDataNodeAtValue(const std::string& indexValue)
 {
@@ -490,8 +520,8 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
 
     // Deal with index values not within the range of index values in the Sequence
     double numericIndexValue = atof(indexValue.c_str());
-    double lowerNumericIndexValue = atof(this->IndexEntries[lowerBound].IndexValue.c_str());
-    double upperNumericIndexValue = atof(this->IndexEntries[upperBound].IndexValue.c_str());
+    double lowerNumericIndexValue = this->IndexEntries[lowerBound].NumericIndexValue;
+    double upperNumericIndexValue = this->IndexEntries[upperBound].NumericIndexValue;
     if (numericIndexValue <= lowerNumericIndexValue + this->NumericIndexValueTolerance)
     {
       if (numericIndexValue < lowerNumericIndexValue - this->NumericIndexValueTolerance && exactMatchRequired)
@@ -519,7 +549,7 @@ int vtkMRMLSequenceNode::GetItemNumberFromIndexValue(const std::string& indexVal
     {
       // Note that if middle is equal to either lowerBound or upperBound then upperBound - lowerBound <= 1
       int middle = int((lowerBound + upperBound)/2);
-      double middleNumericIndexValue = atof(this->IndexEntries[middle].IndexValue.c_str());
+      double middleNumericIndexValue = this->IndexEntries[middle].NumericIndexValue;
       if (fabs(numericIndexValue - middleNumericIndexValue) <= this->NumericIndexValueTolerance)
       {
         return middle;
@@ -605,7 +635,7 @@ bool vtkMRMLSequenceNode::UpdateIndexValue(const std::string& oldIndexValue, con
     return false;
   }
   // Update the index value
-  this->IndexEntries[oldSeqItemIndex].IndexValue = newIndexValue;
+  this->IndexEntries[oldSeqItemIndex].SetIndexValue(newIndexValue);
   if (this->IndexType == vtkMRMLSequenceNode::NumericIndex)
   {
     IndexEntryType movingEntry = this->IndexEntries[oldSeqItemIndex];
@@ -23,9 +23,13 @@
 #include <vtkMRMLStorableNode.h>
 
 // std includes
+#include <cstdlib>
 #include <deque>
 #include <set>
 
+class vtkCollection;
+class vtkStringArray;
+
 
 /// \brief MRML node for representing a sequence of MRML nodes
 ///
@@ -107,6 +111,12 @@ public:
   /// Returns the data node copy that has just been created.
   vtkMRMLNode* SetDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue);
 
+  /// Add copies of the provided nodes to this sequence as data nodes, at the corresponding index values.
+  /// This is equivalent to calling SetDataNodeAtValue for each node but only a single modified event is invoked.
+  /// Adding items in increasing order of numeric index values is the fastest, as then each item is appended at the end.
+  /// Returns false if the number of nodes and index values do not match or any of the nodes is invalid.
+  bool SetDataNodesAtValues(vtkCollection* nodes, vtkStringArray* indexValues);
+
   /// Update an existing data node.
   /// Return true if a data node was found by that index.
   bool UpdateDataNodeAtValue(vtkMRMLNode* node, const std::string& indexValue, bool shallowCopy = false);
@@ -185,7 +195,15 @@ protected:
 
   struct IndexEntryType
   {
+    /// Set index value and the corresponding numeric value
+    void SetIndexValue(const std::string& indexValue)
+    {
+      this->IndexValue = indexValue;
+      this->NumericIndexValue = atof(indexValue.c_str());
+    }
     std::string IndexValue;
+    /// Index value converted to number (cached to avoid string parsing when searching in numeric index)
+    double NumericIndexValue{0.0};
     vtkWeakPointer<vtkMRMLNode> DataNode;
     std::string DataNodeID; // only used temporarily, during scene load
   };
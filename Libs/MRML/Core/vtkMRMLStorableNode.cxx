@@ -22,8 +22,17 @@ Version:   $Revision: 1.3 $
 
 // VTK includes
 #include <vtkCallbackCommand.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkPolyData.h>
+#include <vtkUnsignedCharArray.h>
+#include <vtkUnstructuredGrid.h>
 
 // STD includes
+#include <algorithm>
 #include <sstream>
 
 const char* vtkMRMLStorableNode::StorageNodeReferenceRole = "storage";
@@ -408,6 +417,96 @@ bool vtkMRMLStorableNode::GetModifiedSinceRead()
   return storedTime < this->StorableModifiedTime;
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLStorableNode::GetContentMTime()
+{
+  return std::max(this->Superclass::GetContentMTime(), this->StorableModifiedTime.GetMTime());
+}
+
+namespace
+{
+//---------------------------------------------------------------------------
+vtkMTimeType GetFieldDataContentMTime(vtkFieldData* fieldData)
+{
+  if (!fieldData)
+  {
+    return 0;
+  }
+  vtkMTimeType contentMTime = fieldData->GetMTime();
+  for (int arrayIndex = 0; arrayIndex < fieldData->GetNumberOfArrays(); ++arrayIndex)
+  {
+    vtkAbstractArray* array = fieldData->GetAbstractArray(arrayIndex);
+    if (array)
+    {
+      contentMTime = std::max(contentMTime, array->GetMTime());
+    }
+  }
+  return contentMTime;
+}
+
+//---------------------------------------------------------------------------
+vtkMTimeType GetCellArrayContentMTime(vtkCellArray* cells)
+{
+  if (!cells)
+  {
+    return 0;
+  }
+  vtkMTimeType contentMTime = cells->GetMTime();
+  if (cells->GetOffsetsArray())
+  {
+    contentMTime = std::max(contentMTime, cells->GetOffsetsArray()->GetMTime());
+  }
+  if (cells->GetConnectivityArray())
+  {
+    contentMTime = std::max(contentMTime, cells->GetConnectivityArray()->GetMTime());
+  }
+  return contentMTime;
+}
+} // end of anonymous namespace
+
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLStorableNode::GetDataObjectContentMTime(vtkDataObject* dataObject)
+{
+  if (!dataObject)
+  {
+    return 0;
+  }
+  vtkMTimeType contentMTime = std::max(dataObject->GetMTime(), GetFieldDataContentMTime(dataObject->GetFieldData()));
+  vtkDataSet* dataSet = vtkDataSet::SafeDownCast(dataObject);
+  if (dataSet)
+  {
+    contentMTime = std::max(contentMTime, GetFieldDataContentMTime(dataSet->GetPointData()));
+    contentMTime = std::max(contentMTime, GetFieldDataContentMTime(dataSet->GetCellData()));
+  }
+  vtkPointSet* pointSet = vtkPointSet::SafeDownCast(dataObject);
+  if (pointSet && pointSet->GetPoints())
+  {
+    contentMTime = std::max(contentMTime, pointSet->GetPoints()->GetMTime());
+    if (pointSet->GetPoints()->GetData())
+    {
+      contentMTime = std::max(contentMTime, pointSet->GetPoints()->GetData()->GetMTime());
+    }
+  }
+  vtkPolyData* polyData = vtkPolyData::SafeDownCast(dataObject);
+  if (polyData)
+  {
+    contentMTime = std::max(contentMTime, GetCellArrayContentMTime(polyData->GetVerts()));
+    contentMTime = std::max(contentMTime, GetCellArrayContentMTime(polyData->GetLines()));
+    contentMTime = std::max(contentMTime, GetCellArrayContentMTime(polyData->GetPolys()));
+    contentMTime = std::max(contentMTime, GetCellArrayContentMTime(polyData->GetStrips()));
+  }
+  vtkUnstructuredGrid* unstructuredGrid = vtkUnstructuredGrid::SafeDownCast(dataObject);
+  if (unstructuredGrid)
+  {
+    contentMTime = std::max(contentMTime, GetCellArrayContentMTime(unstructuredGrid->GetCells()));
+    if (unstructuredGrid->GetCellTypesArray())
+    {
+      contentMTime = std::max(contentMTime, unstructuredGrid->GetCellTypesArray()->GetMTime());
+    }
+  }
+  return contentMTime;
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLStorableNode::StorableModified()
 {
@@ -21,6 +21,7 @@ class vtkMRMLStorageNode;
 
 // VTK includes
 class vtkTagTable;
+class vtkDataObject;
 
 // STD includes
 #include <vector>
@@ -151,6 +152,10 @@ public:
   /// \sa GetStoredTime() StorableModifiedTime Modified() StorableModified()
   virtual bool GetModifiedSinceRead();
 
+  /// Includes modification of storable properties.
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
   /// Allows external code to mark that the storable has been modified
   /// and should therefore be selected for saving by default.
   /// \sa GetStoredTime() StorableModifiedTime Modified() GetModifiedSinceRead()
@@ -186,6 +191,13 @@ public:
   /// vtkMRMLStorageNode::GetStoredTime()
   virtual vtkTimeStamp GetStoredTime();
 
+  /// Get the last modification time of a data object, including its points, cells
+  /// and all arrays of its field, point and cell data.
+  /// Arrays that are modified in place only update their own modified time (when
+  /// Modified() is called on them), which is therefore checked explicitly.
+  /// \sa GetContentMTime()
+  static vtkMTimeType GetDataObjectContentMTime(vtkDataObject* dataObject);
+
   /// Last time when a storable property was modified. This is used to know
   /// if the node has been modified since the last time it was read or written
   /// on disk.
@@ -1258,6 +1258,7 @@ int vtkMRMLStorageNode::ReadData(vtkMRMLNode* refNode, bool temporary)
     << "filename = " << (this->GetFileName() == nullptr ? "null" : this->GetFileName()));
   vtkMRMLStorableNode* storableNode = vtkMRMLStorableNode::SafeDownCast(refNode);
   int success = this->ReadDataInternal(refNode);
+  this->ClearPrefetchedData();
   if (!success)
   {
     // failed
@@ -1351,6 +1352,36 @@ int vtkMRMLStorageNode::ReadDataInternal(vtkMRMLNode* vtkNotUsed(refNode))
   return 0;
 }
 
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::PrefetchData(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+void vtkMRMLStorageNode::ClearPrefetchedData()
+{
+  this->PrefetchedFileName.clear();
+  this->PrefetchedUserMessages = nullptr;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::IsFileInUseAfterRead(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return false;
+}
+
+//------------------------------------------------------------------------------
+bool vtkMRMLStorageNode::UsePrefetchedData(const std::string& fullName)
+{
+  if (!this->PrefetchedUserMessages || this->PrefetchedFileName != fullName)
+  {
+    return false;
+  }
+  this->GetUserMessages()->AddMessages(this->PrefetchedUserMessages);
+  return true;
+}
+
 //------------------------------------------------------------------------------
 int vtkMRMLStorageNode::WriteDataInternal(vtkMRMLNode* vtkNotUsed(refNode))
 {
@@ -59,6 +59,25 @@ public:
   /// \sa SetFileName(), ReadDataInternal(), GetStoredTime()
   virtual int ReadData(vtkMRMLNode *refNode, bool temporaryFile = false);
 
+  /// Read the file of the referenced node into memory, without modifying the
+  /// referenced node, the properties of this storage node, or the scene.
+  /// This allows reading files of multiple nodes concurrently on worker threads.
+  /// The next ReadData() call sets the prefetched data in the referenced node
+  /// instead of reading the file again.
+  /// Returns true if data was prefetched. Returns false by default (prefetching is not
+  /// supported by the storage node), in this case ReadData() reads the file as usual.
+  /// \sa ReadData(), ClearPrefetchedData()
+  virtual bool PrefetchData(vtkMRMLNode* refNode);
+
+  /// Discard data read by PrefetchData() that has not been used by ReadData().
+  virtual void ClearPrefetchedData();
+
+  /// Returns true if the storage node still accesses the files of the referenced node
+  /// after ReadData() returned (for example, data is read on demand or mapped into memory).
+  /// These files must not be removed while the referenced node is in use.
+  /// Returns false by default.
+  virtual bool IsFileInUseAfterRead(vtkMRMLNode* refNode);
+
   ///
   /// Write data from a  referenced node
   /// Return 1 on success, 0 on failure.
@@ -408,6 +427,11 @@ protected:
   /// To be reimplemented in subclass.
   virtual int ReadDataInternal(vtkMRMLNode* refNode);
 
+  /// Returns true if data has been read from the file by PrefetchData().
+  /// Messages that were logged while prefetching are added to the user messages.
+  /// Subclasses that implement PrefetchData() call this in ReadDataInternal().
+  bool UsePrefetchedData(const std::string& fullName);
+
   /// Does the actual writing. Returns 1 on success, 0 otherwise.
   /// Returns 0 by default (write not supported).
   /// To be reimplemented in subclass.
@@ -471,6 +495,12 @@ protected:
   // Record warnings and errors associated with this
   // vtkMRMLStorableNode.
   vtkMRMLMessageCollection *UserMessages;
+
+  /// File that data was read from by PrefetchData() and messages logged
+  /// while reading it. UserMessages cannot be used while prefetching,
+  /// because they are cleared before ReadData() is called.
+  std::string PrefetchedFileName;
+  vtkSmartPointer<vtkMRMLMessageCollection> PrefetchedUserMessages;
 };
 
 #endif
@@ -41,6 +41,7 @@
 #include <sstream>
 #include <set>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 
 //----------------------------------------------------------------------------
@@ -108,6 +109,22 @@ public:
   static std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > ItemCache;
   static std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > DataNodeCache;
 
+  /// UID and name caches to speed up finding items by UID or name without traversing the tree.
+  /// Only items that have been added to a tree (have a valid ID) are cached. Similarly to the caches
+  /// above they are static, so items found in the caches must be filtered by ancestor.
+  typedef std::set<vtkSubjectHierarchyItem*> ItemSet;
+  /// Items by UID name and UID value
+  static std::map<std::string, std::unordered_map<std::string, ItemSet> > UIDCache;
+  /// Items by UID name and each UID in the UID value if it is a list (for example DICOM instance UIDs)
+  static std::map<std::string, std::unordered_map<std::string, ItemSet> > UIDListCache;
+  /// Items by name (of the data node, or the Name member if there is no data node)
+  static std::unordered_map<std::string, ItemSet> NameCache;
+
+  /// Flag indicating whether the item is in the UID and name caches
+  bool InLookupCaches{false};
+  /// Name that was used when adding the item to the name cache
+  std::string CachedName;
+
 // Get/set functions
 public:
   /// Add data item to tree under parent, specifying basic properties
@@ -180,9 +197,11 @@ public:
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
   /// \return Item if found, nullptr otherwise
   vtkSubjectHierarchyItem* FindChildByUID(std::string uidName, std::string uidValue, bool recursive=true);
-  /// Find child by UID list (containing). For example find UID in instance UID list
+  /// Find child by UID list (containing). For example find UID in instance UID list.
+  /// A single UID is first matched against the space-separated UIDs of the items, and only if there is no
+  /// such item then it is searched as a substring of the UID values.
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
-  /// \return Item if found, nullptr otherwise
+  /// \return Item if found (first in tree order if there are multiple matches), nullptr otherwise
   vtkSubjectHierarchyItem* FindChildByUIDList(std::string uidName, std::string uidValue, bool recursive=true);
   /// Find children by name
   /// \param name Name (or part of a name) to find
@@ -190,9 +209,12 @@ public:
   /// \param contains Flag whether string containment is enough to determine match. True means a substring is searched
   ///   (case insensitive), false means that the name needs to match exactly (case sensitive)
   /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true). True by default
-  /// \return Item if found, nullptr otherwise
+  /// \param scene Scene of the data nodes. If specified then exact matches are also looked up in the node name index
+  ///   of the scene, which finds items whose data node has been renamed inside StartModify/EndModify
+  ///   (the name cache is only updated when the data node invokes its modified event)
+  /// Found items are returned in tree order.
   void FindChildrenByName( std::string name, std::vector<vtkIdType> &foundItemIDs,
-                           bool contains=false, bool recursive=true );
+                           bool contains=false, bool recursive=true, vtkMRMLScene* scene=nullptr );
   /// Get data nodes (of a certain type) associated to items in the branch of this item
   void GetDataNodesInBranch(vtkCollection *children, const char* childClass=nullptr);
   /// Get IDs of all children in the branch recursively
@@ -240,6 +262,32 @@ public:
   /// \param level Level of the ancestor node we start searching.
   vtkSubjectHierarchyItem* GetAncestorAtLevel(std::string level);
 
+// Cache functions
+public:
+  /// Add item to the UID and name caches. Items that are not in a tree (have no valid ID) are not added
+  void AddToLookupCaches();
+  /// Remove item from the UID and name caches
+  void RemoveFromLookupCaches();
+  /// Update name cache after the name of the item or the name of its data node changed
+  void UpdateNameLookupCache();
+  /// Get child item from cached items. If multiple items are found then the first one in tree order is returned
+  /// \param cache Cache to look up the items in
+  /// \param key Key of the items in the cache
+  /// \param recursive Flag whether to find only direct children (false) or in the whole branch (true)
+  vtkSubjectHierarchyItem* FindChildInCache(std::unordered_map<std::string, ItemSet>& cache, const std::string& key, bool recursive);
+  /// Determine whether given item is a child (or in the branch if recursive) of this item
+  bool HasChild(vtkSubjectHierarchyItem* item, bool recursive);
+  /// Determine whether item1 precedes item2 in depth-first (pre-order) traversal of the tree,
+  /// which is the order in which the finder methods visited the items before the caches were added
+  static bool IsBeforeInTree(vtkSubjectHierarchyItem* item1, vtkSubjectHierarchyItem* item2);
+
+private:
+  /// Find child whose UID value contains the given string, by traversing the tree
+  vtkSubjectHierarchyItem* FindChildByUIDSubstring(const std::string& uidName, const std::string& uidValue, bool recursive);
+  /// Add or remove a single UID of the item to/from the UID caches
+  void AddUIDToLookupCaches(const std::string& uidName, const std::string& uidValue);
+  void RemoveUIDFromLookupCaches(const std::string& uidName, const std::string& uidValue);
+
 public:
   vtkSubjectHierarchyItem();
   ~vtkSubjectHierarchyItem() override;
@@ -261,6 +309,9 @@ std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> > vtkSubjectHierarch
   std::map<vtkIdType, vtkWeakPointer<vtkSubjectHierarchyItem> >();
 std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> > vtkSubjectHierarchyItem::DataNodeCache =
   std::map<vtkMRMLNode*, vtkWeakPointer<vtkSubjectHierarchyItem> >();
+std::map<std::string, std::unordered_map<std::string, vtkSubjectHierarchyItem::ItemSet> > vtkSubjectHierarchyItem::UIDCache;
+std::map<std::string, std::unordered_map<std::string, vtkSubjectHierarchyItem::ItemSet> > vtkSubjectHierarchyItem::UIDListCache;
+std::unordered_map<std::string, vtkSubjectHierarchyItem::ItemSet> vtkSubjectHierarchyItem::NameCache;
 
 //---------------------------------------------------------------------------
 // vtkSubjectHierarchyItem methods
@@ -284,6 +335,7 @@ vtkSubjectHierarchyItem::vtkSubjectHierarchyItem()
 vtkSubjectHierarchyItem::~vtkSubjectHierarchyItem()
 {
   this->RemoveAllChildren();
+  this->RemoveFromLookupCaches();
 
   this->Attributes.clear();
   this->UIDs.clear();
@@ -318,6 +370,7 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, vt
     {
       vtkSubjectHierarchyItem::DataNodeCache[dataNode] = this;
     }
+    this->AddToLookupCaches();
   }
   else
   {
@@ -369,6 +422,7 @@ vtkIdType vtkSubjectHierarchyItem::AddToTree(vtkSubjectHierarchyItem* parent, st
     // Only the scene item or the unresolved items parent can have nullptr parent
     vtkErrorMacro("AddToTree: Invalid parent of non-scene item to add");
   }
+  this->AddToLookupCaches();
 
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemAddedEvent, this);
 
@@ -437,6 +491,7 @@ void vtkSubjectHierarchyItem::ReadXMLAttributes(const char** atts)
 
     if (!strcmp(attName, "id"))
     {
+      this->RemoveFromLookupCaches();
       this->ID = vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID;
       this->TemporaryID = vtkVariant(attValue).ToLongLong();
     }
@@ -482,6 +537,8 @@ void vtkSubjectHierarchyItem::ReadXMLAttributes(const char** atts)
       ss << attValue;
       std::string valueStr = ss.str();
 
+      // Read UIDs are added to the caches when the item is added to the tree
+      this->RemoveFromLookupCaches();
       this->UIDs.clear();
       size_t itemSeparatorPosition = valueStr.find(vtkMRMLSubjectHierarchyNode::SUBJECTHIERARCHY_SEPARATOR);
       while (itemSeparatorPosition != std::string::npos)
@@ -648,11 +705,13 @@ void vtkSubjectHierarchyItem::DeepCopy(vtkSubjectHierarchyItem* item, bool copyC
   // Copying is strictly related to scene or scene view operations, so the copied items will end up
   // in UnresolvedItems and need to be resolved. Otherwise they need to be added to the tree
   // explicitly using AddToTree
+  this->RemoveFromLookupCaches();
   this->Name = item->Name;
   this->OwnerPluginName = item->OwnerPluginName;
   this->Expanded = item->Expanded;
   this->UIDs = item->UIDs;
   this->Attributes = item->Attributes;
+  this->AddToLookupCaches();
 
   // Copy temporary members if they are valid, otherwise save from live members
   if (item->TemporaryID)
@@ -805,24 +864,12 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUID(std::string uid
   {
     return nullptr;
   }
-  ChildVector::iterator childIt;
-  for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
+  auto uidNameIt = vtkSubjectHierarchyItem::UIDCache.find(uidName);
+  if (uidNameIt == vtkSubjectHierarchyItem::UIDCache.end())
   {
-    vtkSubjectHierarchyItem* currentItem = childIt->GetPointer();
-    if (!currentItem->GetUID(uidName).compare(uidValue))
-    {
-      return currentItem;
-    }
-    if (recursive)
-    {
-      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByUID(uidName, uidValue);
-      if (foundItemInBranch)
-      {
-        return foundItemInBranch;
-      }
-    }
+    return nullptr;
   }
-  return nullptr;
+  return this->FindChildInCache(uidNameIt->second, uidValue, recursive);
 }
 
 //---------------------------------------------------------------------------
@@ -832,6 +879,28 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
   {
     return nullptr;
   }
+  if (uidValue.find(' ') == std::string::npos)
+  {
+    // Single UID is looked up in the UID list cache
+    auto uidNameIt = vtkSubjectHierarchyItem::UIDListCache.find(uidName);
+    if (uidNameIt != vtkSubjectHierarchyItem::UIDListCache.end())
+    {
+      vtkSubjectHierarchyItem* foundItem = this->FindChildInCache(uidNameIt->second, uidValue, recursive);
+      if (foundItem)
+      {
+        return foundItem;
+      }
+    }
+    // Not a complete UID in any of the lists, fall back to searching it as a substring
+  }
+
+  // Multiple UIDs (or part of a UID) are searched in the UID strings of the items
+  return this->FindChildByUIDSubstring(uidName, uidValue, recursive);
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDSubstring(const std::string& uidName, const std::string& uidValue, bool recursive)
+{
   ChildVector::iterator childIt;
   for (childIt=this->Children.begin(); childIt!=this->Children.end(); ++childIt)
   {
@@ -842,7 +911,7 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
     }
     if (recursive)
     {
-      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByUIDList(uidName, uidValue);
+      vtkSubjectHierarchyItem* foundItemInBranch = currentItem->FindChildByUIDSubstring(uidName, uidValue, true);
       if (foundItemInBranch)
       {
         return foundItemInBranch;
@@ -853,8 +922,48 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildByUIDList(std::string
 }
 
 //---------------------------------------------------------------------------
-void vtkSubjectHierarchyItem::FindChildrenByName(std::string name, std::vector<vtkIdType> &foundItemIDs, bool contains/*=false*/, bool recursive/*=true*/)
+void vtkSubjectHierarchyItem::FindChildrenByName(std::string name, std::vector<vtkIdType> &foundItemIDs,
+  bool contains/*=false*/, bool recursive/*=true*/, vtkMRMLScene* scene/*=nullptr*/)
 {
+  if (!contains && !name.empty())
+  {
+    // Exact match is looked up in the name cache
+    ItemSet candidateItems;
+    auto nameIt = vtkSubjectHierarchyItem::NameCache.find(name);
+    if (nameIt != vtkSubjectHierarchyItem::NameCache.end())
+    {
+      candidateItems = nameIt->second;
+    }
+    if (scene)
+    {
+      // Data nodes that have been renamed since their last modified event are only in the node name index of the scene
+      vtkSmartPointer<vtkCollection> dataNodes = vtkSmartPointer<vtkCollection>::Take(scene->GetNodesByName(name.c_str()));
+      for (int index = 0; index < dataNodes->GetNumberOfItems(); ++index)
+      {
+        auto itemIt = vtkSubjectHierarchyItem::DataNodeCache.find(vtkMRMLNode::SafeDownCast(dataNodes->GetItemAsObject(index)));
+        if (itemIt != vtkSubjectHierarchyItem::DataNodeCache.end() && itemIt->second)
+        {
+          candidateItems.insert(itemIt->second.GetPointer());
+        }
+      }
+    }
+    std::vector<vtkSubjectHierarchyItem*> cachedItems;
+    for (vtkSubjectHierarchyItem* cachedItem : candidateItems)
+    {
+      if (this->HasChild(cachedItem, recursive) && cachedItem->GetName() == name)
+      {
+        cachedItems.push_back(cachedItem);
+      }
+    }
+    // Return items in tree order, the same way as when the tree is traversed
+    std::sort(cachedItems.begin(), cachedItems.end(), vtkSubjectHierarchyItem::IsBeforeInTree);
+    for (vtkSubjectHierarchyItem* cachedItem : cachedItems)
+    {
+      foundItemIDs.push_back(cachedItem->ID);
+    }
+    return;
+  }
+
   if (contains && !name.empty())
   {
     std::transform(name.begin(), name.end(), name.begin(), ::tolower); // Make it lowercase for case-insensitive comparison
@@ -1145,6 +1254,7 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkSubjectHierarchyItem* item)
   {
     vtkSubjectHierarchyItem::DataNodeCache.erase(removedItem->DataNode);
   }
+  removedItem->RemoveFromLookupCaches();
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, item);
@@ -1207,6 +1317,7 @@ bool vtkSubjectHierarchyItem::RemoveChild(vtkIdType itemID)
   {
     vtkSubjectHierarchyItem::DataNodeCache.erase(removedItem->DataNode);
   }
+  removedItem->RemoveFromLookupCaches();
 
   // Invoke events
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemRemovedEvent, removedItem.GetPointer());
@@ -1302,9 +1413,11 @@ void vtkSubjectHierarchyItem::SetUID(std::string uidName, std::string uidValue)
     {
       vtkWarningMacro( "SetUID: UID with name '" << uidName << "' already exists in subject hierarchy item '" << this->GetName()
         << "' with value '" << it->second << "'. Replacing it with value '" << uidValue << "'" );
+      this->RemoveUIDFromLookupCaches(uidName, it->second);
     }
   }
   this->UIDs[uidName] = uidValue;
+  this->AddUIDToLookupCaches(uidName, uidValue);
   this->InvokeEvent(vtkMRMLSubjectHierarchyNode::SubjectHierarchyItemUIDAddedEvent, this);
   this->Modified();
 }
@@ -1320,6 +1433,7 @@ bool vtkSubjectHierarchyItem::RemoveUID(std::string uidName)
   }
 
   // Use the find function to prevent adding an empty UID to the map
+  this->RemoveUIDFromLookupCaches(uidName, it->second);
   this->UIDs.erase(it);
   this->Modified();
   return true;
@@ -1483,6 +1597,230 @@ vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::GetAncestorAtLevel(std::string
   return nullptr;
 }
 
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddToLookupCaches()
+{
+  if (this->InLookupCaches)
+  {
+    this->RemoveFromLookupCaches();
+  }
+  if (this->ID == vtkMRMLSubjectHierarchyNode::INVALID_ITEM_ID)
+  {
+    // Items that are not in a tree (for example unresolved items) are not cached
+    return;
+  }
+  this->InLookupCaches = true;
+
+  for (std::map<std::string, std::string>::iterator uidIt = this->UIDs.begin(); uidIt != this->UIDs.end(); ++uidIt)
+  {
+    this->AddUIDToLookupCaches(uidIt->first, uidIt->second);
+  }
+  this->CachedName = this->GetName();
+  vtkSubjectHierarchyItem::NameCache[this->CachedName].insert(this);
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveFromLookupCaches()
+{
+  if (!this->InLookupCaches)
+  {
+    return;
+  }
+  for (std::map<std::string, std::string>::iterator uidIt = this->UIDs.begin(); uidIt != this->UIDs.end(); ++uidIt)
+  {
+    this->RemoveUIDFromLookupCaches(uidIt->first, uidIt->second);
+  }
+  auto nameIt = vtkSubjectHierarchyItem::NameCache.find(this->CachedName);
+  if (nameIt != vtkSubjectHierarchyItem::NameCache.end())
+  {
+    nameIt->second.erase(this);
+    if (nameIt->second.empty())
+    {
+      vtkSubjectHierarchyItem::NameCache.erase(nameIt);
+    }
+  }
+  this->CachedName.clear();
+  this->InLookupCaches = false;
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::UpdateNameLookupCache()
+{
+  if (!this->InLookupCaches)
+  {
+    return;
+  }
+  std::string name = this->GetName();
+  if (name == this->CachedName)
+  {
+    return;
+  }
+  auto nameIt = vtkSubjectHierarchyItem::NameCache.find(this->CachedName);
+  if (nameIt != vtkSubjectHierarchyItem::NameCache.end())
+  {
+    nameIt->second.erase(this);
+    if (nameIt->second.empty())
+    {
+      vtkSubjectHierarchyItem::NameCache.erase(nameIt);
+    }
+  }
+  this->CachedName = name;
+  vtkSubjectHierarchyItem::NameCache[this->CachedName].insert(this);
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::AddUIDToLookupCaches(const std::string& uidName, const std::string& uidValue)
+{
+  if (!this->InLookupCaches)
+  {
+    return;
+  }
+  vtkSubjectHierarchyItem::UIDCache[uidName][uidValue].insert(this);
+
+  std::vector<std::string> uidList;
+  vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, uidList);
+  std::unordered_map<std::string, ItemSet>& uidListCache = vtkSubjectHierarchyItem::UIDListCache[uidName];
+  for (const std::string& uid : uidList)
+  {
+    if (!uid.empty())
+    {
+      uidListCache[uid].insert(this);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkSubjectHierarchyItem::RemoveUIDFromLookupCaches(const std::string& uidName, const std::string& uidValue)
+{
+  if (!this->InLookupCaches)
+  {
+    return;
+  }
+  std::unordered_map<std::string, ItemSet>& uidCache = vtkSubjectHierarchyItem::UIDCache[uidName];
+  auto uidIt = uidCache.find(uidValue);
+  if (uidIt != uidCache.end())
+  {
+    uidIt->second.erase(this);
+    if (uidIt->second.empty())
+    {
+      uidCache.erase(uidIt);
+    }
+  }
+
+  std::vector<std::string> uidList;
+  vtkMRMLSubjectHierarchyNode::DeserializeUIDList(uidValue, uidList);
+  std::unordered_map<std::string, ItemSet>& uidListCache = vtkSubjectHierarchyItem::UIDListCache[uidName];
+  for (const std::string& uid : uidList)
+  {
+    auto uidListIt = uidListCache.find(uid);
+    if (uidListIt != uidListCache.end())
+    {
+      uidListIt->second.erase(this);
+      if (uidListIt->second.empty())
+      {
+        uidListCache.erase(uidListIt);
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+vtkSubjectHierarchyItem* vtkSubjectHierarchyItem::FindChildInCache(
+  std::unordered_map<std::string, ItemSet>& cache, const std::string& key, bool recursive)
+{
+  auto cacheIt = cache.find(key);
+  if (cacheIt == cache.end())
+  {
+    return nullptr;
+  }
+  vtkSubjectHierarchyItem* foundItem = nullptr;
+  for (vtkSubjectHierarchyItem* cachedItem : cacheIt->second)
+  {
+    if ((!foundItem || vtkSubjectHierarchyItem::IsBeforeInTree(cachedItem, foundItem)) && this->HasChild(cachedItem, recursive))
+    {
+      foundItem = cachedItem;
+    }
+  }
+  return foundItem;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::HasChild(vtkSubjectHierarchyItem* item, bool recursive)
+{
+  if (!item)
+  {
+    return false;
+  }
+  if (!recursive)
+  {
+    return item->Parent == this;
+  }
+  for (vtkSubjectHierarchyItem* ancestor = item->Parent; ancestor; ancestor = ancestor->Parent)
+  {
+    if (ancestor == this)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSubjectHierarchyItem::IsBeforeInTree(vtkSubjectHierarchyItem* item1, vtkSubjectHierarchyItem* item2)
+{
+  if (item1 == item2)
+  {
+    return false;
+  }
+  // Paths from the root to the items
+  std::vector<vtkSubjectHierarchyItem*> path1;
+  for (vtkSubjectHierarchyItem* ancestor = item1; ancestor; ancestor = ancestor->Parent)
+  {
+    path1.push_back(ancestor);
+  }
+  std::vector<vtkSubjectHierarchyItem*> path2;
+  for (vtkSubjectHierarchyItem* ancestor = item2; ancestor; ancestor = ancestor->Parent)
+  {
+    path2.push_back(ancestor);
+  }
+  std::reverse(path1.begin(), path1.end());
+  std::reverse(path2.begin(), path2.end());
+
+  size_t level = 0;
+  while (level < path1.size() && level < path2.size() && path1[level] == path2[level])
+  {
+    ++level;
+  }
+  if (level == path1.size())
+  {
+    // item1 is an ancestor of item2, therefore it is visited first
+    return true;
+  }
+  if (level == path2.size())
+  {
+    return false;
+  }
+  if (level == 0)
+  {
+    // Items are in different trees, use creation order
+    return item1->ID < item2->ID;
+  }
+  // Compare the position of the branches that contain the items in their common parent
+  ChildVector& siblings = path1[level - 1]->Children;
+  for (ChildVector::iterator childIt = siblings.begin(); childIt != siblings.end(); ++childIt)
+  {
+    if (childIt->GetPointer() == path1[level])
+    {
+      return true;
+    }
+    if (childIt->GetPointer() == path2[level])
+    {
+      return false;
+    }
+  }
+  return item1->ID < item2->ID;
+}
+
 
 //---------------------------------------------------------------------------
 //---------------------------------------------------------------------------
@@ -2143,6 +2481,7 @@ void vtkMRMLSubjectHierarchyNode::SetItemDataNode(vtkIdType itemID, vtkMRMLNode*
   {
     vtkSubjectHierarchyItem::DataNodeCache[item->DataNode] = item;
   }
+  item->UpdateNameLookupCache();
 
   // Add observers for data node
   this->Internal->AddItemObservers(item);
@@ -2205,6 +2544,7 @@ void vtkMRMLSubjectHierarchyNode::SetItemName(vtkIdType itemID, std::string name
 
   if (nameChanged)
   {
+    item->UpdateNameLookupCache();
     this->InvokeCustomModifiedEvent(SubjectHierarchyItemModifiedEvent, (void*)&itemID);
   }
 }
@@ -2638,6 +2978,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::CreateItem(vtkIdType parentItemID, vtkMRM
 
     // The name of the data node is used, so empty name is set
     item->Name = "";
+    item->UpdateNameLookupCache();
     if (ownerPluginName)
     {
       item->OwnerPluginName = ownerPluginName;
@@ -3106,7 +3447,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemByName(std::string name)
   }
 
   std::vector<vtkIdType> foundItemIDs;
-  this->Internal->SceneItem->FindChildrenByName(name, foundItemIDs);
+  this->Internal->SceneItem->FindChildrenByName(name, foundItemIDs, false, true, this->GetScene());
   if (foundItemIDs.size() == 0)
   {
     vtkDebugMacro("GetItemByName: Failed to find subject hierarchy item with name '" << name);
@@ -3135,7 +3476,7 @@ void vtkMRMLSubjectHierarchyNode::GetItemsByName(std::string name, vtkIdList* fo
   }
 
   std::vector<vtkIdType> foundItemsVector;
-  this->Internal->SceneItem->FindChildrenByName(name, foundItemsVector, contains);
+  this->Internal->SceneItem->FindChildrenByName(name, foundItemsVector, contains, true, this->GetScene());
 
   std::vector<vtkIdType>::iterator itemIt;
   for (itemIt=foundItemsVector.begin(); itemIt!=foundItemsVector.end(); ++itemIt)
@@ -3160,7 +3501,7 @@ vtkIdType vtkMRMLSubjectHierarchyNode::GetItemChildWithName(vtkIdType parentItem
   }
 
   std::vector<vtkIdType> foundItemIDs;
-  parentItem->FindChildrenByName(name, foundItemIDs, false, recursive);
+  parentItem->FindChildrenByName(name, foundItemIDs, false, recursive, this->GetScene());
   if (foundItemIDs.size() == 0)
   {
     vtkDebugMacro("GetItemChildWithName: Failed to find subject hierarchy item with name '" << name
@@ -3595,7 +3936,7 @@ void vtkMRMLSubjectHierarchyNode::GetItemsReferencingItemByDICOM(vtkIdType itemI
 std::string vtkMRMLSubjectHierarchyNode::GenerateUniqueItemName(std::string name)
 {
   std::vector<vtkIdType> foundItemIDs;
-  this->Internal->SceneItem->FindChildrenByName(name, foundItemIDs, false, true);
+  this->Internal->SceneItem->FindChildrenByName(name, foundItemIDs, false, true, this->GetScene());
   if (foundItemIDs.size() == 0)
   {
     // If no item found with that name then return input name as it's unique already
@@ -3680,7 +4021,22 @@ int vtkMRMLSubjectHierarchyNode::GetNumberOfItemChildren(vtkIdType itemID, bool
 void vtkMRMLSubjectHierarchyNode::ItemEventCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData)
 {
   vtkMRMLSubjectHierarchyNode* self = reinterpret_cast<vtkMRMLSubjectHierarchyNode*>(clientData);
-  if (!self || self->Internal->EventsDisabled)
+  if (!self)
+  {
+    return;
+  }
+
+  // Keep name cache up-to-date even if events are disabled, as the data node may have been renamed
+  if (eid == vtkCommand::ModifiedEvent && vtkMRMLNode::SafeDownCast(caller))
+  {
+    auto itemIt = vtkSubjectHierarchyItem::DataNodeCache.find(vtkMRMLNode::SafeDownCast(caller));
+    if (itemIt != vtkSubjectHierarchyItem::DataNodeCache.end() && itemIt->second)
+    {
+      itemIt->second->UpdateNameLookupCache();
+    }
+  }
+
+  if (self->Internal->EventsDisabled)
   {
     return;
   }
@@ -290,8 +290,10 @@ public:
 
   /// Find subject hierarchy item according to a UID (by containing). For example find UID in instance UID list
   /// \param uidName UID string to lookup
-  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item
-  /// \return First match
+  /// \param uidValue UID string that needs to be _contained_ in the UID string of the subject hierarchy item.
+  ///   If it is a single UID then items that contain it as one of the space-separated UIDs of their UID list
+  ///   are preferred, items that only contain it as a substring are returned only if there is no such item.
+  /// \return First match (in tree order)
   /// \sa GetUID()
   vtkIdType GetItemByUIDList(const char* uidName, const char* uidValue);
 
@@ -30,20 +30,41 @@ Version:   $Revision: 1.14 $
 #include <vtkCommand.h>
 #include <vtkCollection.h>
 #include <vtkCollectionIterator.h>
+#include <vtkDataArray.h>
 #include <vtkGeneralTransform.h>
 #include <vtkImageData.h>
 #include <vtkLinearTransform.h>
+#include <vtkMath.h>
+#include <vtkMatrix4x4.h>
 #include <vtkHomogeneousTransform.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPoints.h>
+#include <vtkSMPTools.h>
 #include <vtkThinPlateSplineTransform.h>
 #include <vtkTransform.h>
 #include <vtksys/SystemTools.hxx>
 
 // STD includes
+#include <algorithm>
+#include <functional>
 #include <sstream>
 #include <stack>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// Component of a flattened transform. Linear components are stored as a matrix,
+/// other components are evaluated by the transform.
+struct FlattenedTransformComponent
+{
+  vtkAbstractTransform* Transform{ nullptr };
+  double Matrix[3][4];
+};
+
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkMRMLNodeNewMacro(vtkMRMLTransformNode);
@@ -156,6 +177,166 @@ void vtkMRMLTransformNode::FlattenGeneralTransform(vtkCollection* outputTransfor
   }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLTransformNode::TransformPoints(vtkAbstractTransform* transform, vtkPoints* inputPoints, vtkPoints* outputPoints,
+  vtkDataArray* inputNormals/*=nullptr*/, vtkDataArray* outputNormals/*=nullptr*/, int numberOfThreads/*=0*/)
+{
+  if (!transform || !inputPoints || !outputPoints)
+  {
+    vtkGenericWarningMacro("vtkMRMLTransformNode::TransformPoints failed: invalid input");
+    return;
+  }
+  const vtkIdType numberOfPoints = inputPoints->GetNumberOfPoints();
+  bool transformNormals = (inputNormals && outputNormals);
+  if (transformNormals && (inputNormals->GetNumberOfTuples() != numberOfPoints || inputNormals->GetNumberOfComponents() != 3))
+  {
+    vtkGenericWarningMacro("vtkMRMLTransformNode::TransformPoints: number of normals does not match the number of points,"
+      " normals are not transformed");
+    transformNormals = false;
+  }
+
+  // Flatten the transform and merge consecutive linear components.
+  // Components are updated now, therefore they can be evaluated from multiple threads.
+  vtkNew<vtkCollection> transformList;
+  vtkMRMLTransformNode::FlattenGeneralTransform(transformList, transform);
+  std::vector<FlattenedTransformComponent> components;
+  for (int transformIndex = 0; transformIndex < transformList->GetNumberOfItems(); ++transformIndex)
+  {
+    vtkAbstractTransform* transformComponent = vtkAbstractTransform::SafeDownCast(transformList->GetItemAsObject(transformIndex));
+    if (!transformComponent)
+    {
+      continue;
+    }
+    transformComponent->Update();
+    vtkLinearTransform* linearTransformComponent = vtkLinearTransform::SafeDownCast(transformComponent);
+    if (!linearTransformComponent)
+    {
+      FlattenedTransformComponent component;
+      component.Transform = transformComponent;
+      components.push_back(component);
+      continue;
+    }
+    vtkMatrix4x4* matrix = linearTransformComponent->GetMatrix();
+    if (components.empty() || components.back().Transform)
+    {
+      FlattenedTransformComponent component;
+      for (int row = 0; row < 3; ++row)
+      {
+        for (int col = 0; col < 4; ++col)
+        {
+          component.Matrix[row][col] = matrix->GetElement(row, col);
+        }
+      }
+      components.push_back(component);
+    }
+    else
+    {
+      // Previous component is linear, too: merge them (newMatrix = matrix * previousMatrix)
+      double (&previousMatrix)[3][4] = components.back().Matrix;
+      double newMatrix[3][4];
+      for (int row = 0; row < 3; ++row)
+      {
+        for (int col = 0; col < 4; ++col)
+        {
+          newMatrix[row][col] = matrix->GetElement(row, 0) * previousMatrix[0][col]
+            + matrix->GetElement(row, 1) * previousMatrix[1][col]
+            + matrix->GetElement(row, 2) * previousMatrix[2][col];
+        }
+        newMatrix[row][3] += matrix->GetElement(row, 3);
+      }
+      std::copy(&newMatrix[0][0], &newMatrix[0][0] + 12, &previousMatrix[0][0]);
+    }
+  }
+
+  if (outputPoints != inputPoints)
+  {
+    outputPoints->SetNumberOfPoints(numberOfPoints);
+  }
+  if (transformNormals && outputNormals != inputNormals)
+  {
+    outputNormals->SetNumberOfComponents(3);
+    outputNormals->SetNumberOfTuples(numberOfPoints);
+  }
+  vtkDataArray* inputPointData = inputPoints->GetData();
+  vtkDataArray* outputPointData = outputPoints->GetData();
+
+  std::function<void(vtkIdType, vtkIdType)> transformPointRange = [&](vtkIdType begin, vtkIdType end)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    double derivative[3][3];
+    double componentDerivative[3][3];
+    for (vtkIdType pointIndex = begin; pointIndex < end; ++pointIndex)
+    {
+      inputPointData->GetTuple(pointIndex, point);
+      if (transformNormals)
+      {
+        vtkMath::Identity3x3(derivative);
+      }
+      for (const FlattenedTransformComponent& component : components)
+      {
+        if (component.Transform)
+        {
+          if (transformNormals)
+          {
+            component.Transform->InternalTransformDerivative(point, point, componentDerivative);
+            vtkMath::Multiply3x3(componentDerivative, derivative, derivative);
+          }
+          else
+          {
+            component.Transform->InternalTransformPoint(point, point);
+          }
+        }
+        else
+        {
+          const double (&m)[3][4] = component.Matrix;
+          const double x = point[0];
+          const double y = point[1];
+          const double z = point[2];
+          point[0] = m[0][0] * x + m[0][1] * y + m[0][2] * z + m[0][3];
+          point[1] = m[1][0] * x + m[1][1] * y + m[1][2] * z + m[1][3];
+          point[2] = m[2][0] * x + m[2][1] * y + m[2][2] * z + m[2][3];
+          if (transformNormals)
+          {
+            double linearDerivative[3][3] =
+            {
+              { m[0][0], m[0][1], m[0][2] },
+              { m[1][0], m[1][1], m[1][2] },
+              { m[2][0], m[2][1], m[2][2] }
+            };
+            vtkMath::Multiply3x3(linearDerivative, derivative, derivative);
+          }
+        }
+      }
+      outputPointData->SetTuple(pointIndex, point);
+
+      if (transformNormals)
+      {
+        // Same computation as in vtkAbstractTransform::TransformPointsNormalsVectors
+        double normal[3] = { 0.0, 0.0, 0.0 };
+        inputNormals->GetTuple(pointIndex, normal);
+        vtkMath::Transpose3x3(derivative, derivative);
+        vtkMath::LinearSolve3x3(derivative, normal, normal);
+        vtkMath::Normalize(normal);
+        outputNormals->SetTuple(pointIndex, normal);
+      }
+    }
+  };
+  if (numberOfThreads == 1)
+  {
+    transformPointRange(0, numberOfPoints);
+  }
+  else
+  {
+    vtkSMPTools::For(0, numberOfPoints, 1024, transformPointRange);
+  }
+
+  outputPoints->Modified();
+  if (transformNormals)
+  {
+    outputNormals->Modified();
+  }
+}
+
 //---------------------------------------------------------------------------
 bool vtkMRMLTransformNode::AreTransformsEqual(vtkAbstractTransform* transform1, vtkAbstractTransform* transform2)
 {
@@ -422,6 +603,18 @@ vtkAbstractTransform* vtkMRMLTransformNode::GetTransformFromParent()
   }
 }
 
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::GetTransformToParentForEvaluation()
+{
+  return this->GetTransformToParent();
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLTransformNode::GetTransformFromParentForEvaluation()
+{
+  return this->GetTransformFromParent();
+}
+
 //----------------------------------------------------------------------------
 int  vtkMRMLTransformNode::IsTransformToWorldLinear()
 {
@@ -548,7 +741,7 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
     // traverse the transform tree from bottom to top, from sourceNode to targetNode
     for (vtkMRMLTransformNode* current = sourceNode; current != targetNode; current = current->GetParentTransformNode())
     {
-      vtkAbstractTransform* transformToParent=current->GetTransformToParent();
+      vtkAbstractTransform* transformToParent=current->GetTransformToParentForEvaluation();
       if (transformToParent)
       {
         transformSourceToTarget->Concatenate(transformToParent);
@@ -567,13 +760,17 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
   }
   else if (sourceNode == nullptr || sourceNode->IsTransformNodeMyChild(targetNode))
   {
-    // traverse the transform tree from bottom to top, from targetNode to sourceNode
+    // traverse the transform tree from bottom to top, from targetNode to sourceNode.
+    // Transforms from parent are concatenated in reverse order (instead of inverting the concatenated
+    // transforms to parent) so that nodes can provide their own inverse transform for evaluation
+    // (such as precomputed inverse of grid transforms).
+    transformSourceToTarget->PreMultiply();
     for (vtkMRMLTransformNode* current = targetNode; current != sourceNode; current = current->GetParentTransformNode())
     {
-      vtkAbstractTransform* transformToParent=current->GetTransformToParent();
-      if (transformToParent)
+      vtkAbstractTransform* transformFromParent=current->GetTransformFromParentForEvaluation();
+      if (transformFromParent)
       {
-        transformSourceToTarget->Concatenate(transformToParent);
+        transformSourceToTarget->Concatenate(transformFromParent);
       }
 
       ++currentDepth;
@@ -586,9 +783,7 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
         break;
       }
     }
-    // in transformSourceToTarget we have transform targetNode->sourceNode,
-    // need to invert to get sourceNode->targetNode
-    transformSourceToTarget->Inverse();
+    transformSourceToTarget->PostMultiply();
   }
   else
   {
@@ -597,8 +792,7 @@ void vtkMRMLTransformNode::GetTransformBetweenNodes(vtkMRMLTransformNode* source
     sourceNode->GetTransformToNode(firstCommonParentNode, transformSourceToTarget);
 
     vtkNew<vtkGeneralTransform> transformFromCommonParentNode;
-    targetNode->GetTransformToNode(firstCommonParentNode, transformFromCommonParentNode.GetPointer());
-    transformFromCommonParentNode->Inverse();
+    vtkMRMLTransformNode::GetTransformBetweenNodes(firstCommonParentNode, targetNode, transformFromCommonParentNode.GetPointer());
 
     transformSourceToTarget->Concatenate(transformFromCommonParentNode.GetPointer());
   }
@@ -880,6 +1074,21 @@ bool vtkMRMLTransformNode::GetModifiedSinceRead()
   return false;
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLTransformNode::GetContentMTime()
+{
+  vtkMTimeType contentMTime = this->Superclass::GetContentMTime();
+  if (this->TransformToParent)
+  {
+    contentMTime = std::max(contentMTime, this->TransformToParent->GetMTime());
+  }
+  if (this->TransformFromParent)
+  {
+    contentMTime = std::max(contentMTime, this->TransformFromParent->GetMTime());
+  }
+  return contentMTime;
+}
+
 //----------------------------------------------------------------------------
 int vtkMRMLTransformNode::GetMatrixTransformToParent(vtkMatrix4x4* matrix)
 {
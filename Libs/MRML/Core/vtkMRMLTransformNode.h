@@ -19,8 +19,10 @@
 
 class vtkCollection;
 class vtkAbstractTransform;
+class vtkDataArray;
 class vtkGeneralTransform;
 class vtkMatrix4x4;
+class vtkPoints;
 class vtkTransform;
 
 /// \brief MRML node for representing a transformation
@@ -110,6 +112,21 @@ public:
   /// Get a human-readable description of the transform
   virtual const char* GetTransformFromParentInfo();
 
+  ///
+  /// Transform of this node to parent that is used for transforming points.
+  /// By default it is the same as GetTransformToParent(). Subclasses may return
+  /// a transform that is faster to evaluate, such as a precomputed approximation of
+  /// an inverse transform (see vtkMRMLGridTransformNode::SetPrecomputedInverse).
+  /// GetTransformToParent() always returns the stored transform or its exact inverse,
+  /// therefore that must be used when the transform is edited, copied, or saved.
+  /// \sa GetTransformBetweenNodes
+  virtual vtkAbstractTransform* GetTransformToParentForEvaluation();
+
+  ///
+  /// Transform of this node from parent that is used for transforming points.
+  /// \sa GetTransformToParentForEvaluation
+  virtual vtkAbstractTransform* GetTransformFromParentForEvaluation();
+
   ///
   /// 1 if all the transforms to the top are linear, 0 otherwise
   int  IsTransformToWorldLinear();
@@ -147,6 +164,8 @@ public:
   ///
   /// Get concatenated transforms from source to target node
   /// Source and target nodes are allowed to be nullptr, which means that transform is the world transform.
+  /// Transforms of the nodes are retrieved by GetTransformToParentForEvaluation() and
+  /// GetTransformFromParentForEvaluation().
   /// The method may change the PreMultiply/PostMultiply flag of the transform.
   static void GetTransformBetweenNodes(vtkMRMLTransformNode* sourceNode,
     vtkMRMLTransformNode* targetNode, vtkGeneralTransform* transformSourceToTarget);
@@ -284,6 +303,10 @@ public:
 
   bool GetModifiedSinceRead() override;
 
+  /// Includes modification of the transforms.
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
   ///
   /// Retrieves the transform as the specified transform class.
   /// If modifiableOnly is set to true then nullptr will be returned for transforms that cannot be modified (e.g., because it is computed from its inverse).
@@ -322,6 +345,20 @@ public:
   /// into a flat list of transforms. This is useful for simplifying serialization for copying and writing to file.
   static void FlattenGeneralTransform(vtkCollection* outputTransformList, vtkAbstractTransform* inputTransform);
 
+  ///
+  /// Transform a set of points (and optionally normals) by an arbitrary (composite, non-linear) transform.
+  /// The transform is flattened and updated only once, consecutive linear components are merged
+  /// into a single matrix, and blocks of points are processed in parallel. This is much faster
+  /// than transforming points one by one using vtkAbstractTransform::TransformPoint.
+  /// outputPoints is resized to the number of input points, it may be the same as inputPoints.
+  /// If inputNormals and outputNormals are specified then normals are transformed as well,
+  /// the same way as in vtkAbstractTransform::TransformNormal (using the inverse transpose
+  /// of the transform derivative at each point).
+  /// numberOfThreads = 1 transforms the points in the calling thread, other values use
+  /// the VTK SMP backend.
+  static void TransformPoints(vtkAbstractTransform* transform, vtkPoints* inputPoints, vtkPoints* outputPoints,
+    vtkDataArray* inputNormals = nullptr, vtkDataArray* outputNormals = nullptr, int numberOfThreads = 0);
+
   ///
   /// Return true if the two transforms are equal. A transform object is considered to be the same if it is
   /// made up of the same flattened list of transforms.
@@ -459,6 +459,7 @@ const char* vtkMRMLViewNode::GetVolumeRenderingQualityAsString(int id)
     case Adaptive: return "Adaptive";
     case Normal: return "Normal";
     case Maximum: return "Maximum";
+    case Progressive: return "Progressive";
     default:
       // invalid id
       return "";
@@ -246,6 +246,7 @@ public:
     Adaptive = 0, ///< quality determined from desired update rate
     Normal,       ///< good image quality at reasonable speed
     Maximum,      ///< high image quality, rendering time is not considered
+    Progressive,  ///< low resolution during interaction, refined to normal quality when interaction stops
     VolumeRenderingQuality_Last
   };
 
@@ -424,6 +425,7 @@ protected:
   /// 0: Adaptive
   /// 1: Normal Quality
   /// 2: Maximum Quality
+  /// 3: Progressive refinement
   int VolumeRenderingQuality;
 
   /// Techniques for volume rendering ray cast
@@ -13,6 +13,7 @@ Version:   $Revision: 1.6 $
 =========================================================================auto=*/
 
 // MRML includes
+#include "vtkCacheManager.h"
 #include "vtkDataFileFormatHelper.h"
 #include "vtkMRMLI18N.h"
 #include "vtkDataIOManager.h"
@@ -24,6 +25,11 @@ Version:   $Revision: 1.6 $
 #endif
 #include "vtkMRMLVolumeArchetypeStorageNode.h"
 
+#ifdef MRML_USE_vtkTeem
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#endif
+
 // VTK ITK includes
 #include "vtkITKArchetypeImageSeriesScalarReader.h"
 #include "vtkITKArchetypeDiffusionTensorImageReaderFile.h"
@@ -31,6 +37,9 @@ Version:   $Revision: 1.6 $
 #include "vtkITKArchetypeImageSeriesVectorReaderSeries.h"
 #include "vtkITKImageWriter.h"
 
+// ITK includes
+#include <itkMetaDataObject.h>
+
 // VTKsys includes
 #include <vtksys/SystemTools.hxx>
 
@@ -83,6 +92,11 @@ void vtkMRMLVolumeArchetypeStorageNode::WriteXML(ostream& of, int nIndent)
     ss << this->UseOrientationFromFile;
     of << " UseOrientationFromFile=\"" << ss.str() << "\"";
   }
+  if (this->UseMemoryMapping)
+  {
+    // only written if enabled, to keep scene files unchanged by default
+    of << " useMemoryMapping=\"true\"";
+  }
 
   // SingleFile attribute is not written to file. GetNumberOfFileNames()
   // is used to determine if reader should read from single/multiple files.
@@ -121,6 +135,10 @@ void vtkMRMLVolumeArchetypeStorageNode::ReadXMLAttributes(const char** atts)
     {
       this->SetForceRightHandedIJKCoordinateSystem(strcmp(attValue, "true") == 0);
     }
+    if (!strcmp(attName, "useMemoryMapping"))
+    {
+      this->SetUseMemoryMapping(strcmp(attValue, "true") == 0);
+    }
   }
 
   // SingleFile attribute used to be read from the scene, but often
@@ -146,6 +164,8 @@ void vtkMRMLVolumeArchetypeStorageNode::Copy(vtkMRMLNode *anode)
   this->SetSingleFile(node->SingleFile);
   this->SetUseOrientationFromFile(node->UseOrientationFromFile);
   this->SetForceRightHandedIJKCoordinateSystem(node->ForceRightHandedIJKCoordinateSystem);
+  this->SetUseMemoryMapping(node->UseMemoryMapping);
+  this->SetUseDICOMHeaderCache(node->UseDICOMHeaderCache);
 
   this->EndModify(disabledModify);
 }
@@ -158,6 +178,8 @@ void vtkMRMLVolumeArchetypeStorageNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "SingleFile:   " << this->SingleFile << "\n";
   os << indent << "UseOrientationFromFile:   " << this->UseOrientationFromFile << "\n";
   os << indent << "ForceRightHandedIJKCoordinateSystem:   " << (this->ForceRightHandedIJKCoordinateSystem ? "true" : "false") << "\n";
+  os << indent << "UseMemoryMapping:   " << (this->UseMemoryMapping ? "true" : "false") << "\n";
+  os << indent << "UseDICOMHeaderCache:   " << (this->UseDICOMHeaderCache ? "true" : "false") << "\n";
 }
 
 //----------------------------------------------------------------------------
@@ -302,47 +324,8 @@ void ApplyImageSeriesReaderWorkaround(vtkMRMLVolumeArchetypeStorageNode * storag
 } // end of anonymous namespace
 
 //----------------------------------------------------------------------------
-int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+vtkITKArchetypeImageSeriesReader* vtkMRMLVolumeArchetypeStorageNode::CreateReader(vtkMRMLNode* refNode, const std::string& fullName)
 {
-  // Skip file loading for empty volume, for which no file was saved
-  if (this->GetWriteState() == SkippedNoData)
-  {
-    vtkDebugMacro("ReadDataInternal: Empty volume file was not saved, ignore loading");
-    return 1;
-  }
-
-  std::string fullName = this->GetFullNameFromFileName();
-  vtkDebugMacro("ReadData: got full archetype name " << fullName);
-
-  if (fullName.empty())
-  {
-    vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal: File name not specified");
-    return 0;
-  }
-
-  //
-  // vtkMRMLVolumeNode
-  //   |
-  //   |--vtkMRMLScalarVolumeNode
-  //         |
-  //         |----vtkMRMLDiffusionWeightedVolumeNode
-  //         |
-  //         |----vtkMRMLTensorVolumeNode
-  //                  |
-  //                  |---vtkMRMLDiffusionImageVolumeNode
-  //                  |       |
-  //                  |       |---vtkMRMLDiffusionTensorVolumeNode
-  //                  |
-  //                  |---vtkMRMLVectorVolumeNode
-  //
-
-  vtkMRMLScalarVolumeNode * volNode = vtkMRMLScalarVolumeNode::SafeDownCast(refNode);
-  if (volNode == nullptr)
-  {
-    vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal: Reference node is expected to be a vtkMRMLScalarVolumeNode");
-    return 0;
-  }
-
   vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
 
   if (refNode->IsA("vtkMRMLVectorVolumeNode"))
@@ -364,15 +347,7 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
 
   if (reader.GetPointer() == nullptr)
   {
-    vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal: Failed to instantiate a file reader");
-    return 0;
-  }
-
-  reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
-
-  if (volNode->GetImageData())
-  {
-    volNode->SetAndObserveImageData(nullptr);
+    return nullptr;
   }
 
   // Set the list of file names on the reader
@@ -382,6 +357,19 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   // Workaround
   ApplyImageSeriesReaderWorkaround(this, reader, fullName);
 
+  // Cache DICOM headers used for grouping and sorting, to speed up loading the same series again
+  vtkMRMLScene* scene = this->GetScene();
+  if (this->UseDICOMHeaderCache && scene && scene->GetDataIOManager()
+    && scene->GetDataIOManager()->GetCacheManager()
+    && scene->GetDataIOManager()->GetCacheManager()->GetRemoteCacheDirectory())
+  {
+    std::string cacheDirectory = scene->GetDataIOManager()->GetCacheManager()->GetRemoteCacheDirectory();
+    if (!cacheDirectory.empty())
+    {
+      reader->SetDICOMHeaderCacheDirectory((cacheDirectory + "/DICOMHeaderCache").c_str());
+    }
+  }
+
   // Center image
   reader->SetOutputScalarTypeToNative();
   reader->SetDesiredCoordinateOrientationToNative();
@@ -394,11 +382,18 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     reader->SetUseNativeOriginOn();
   }
 
+  reader->Register(nullptr);
+  return reader;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::UpdateReader(vtkITKArchetypeImageSeriesReader* reader, std::string& errorMessage)
+{
   bool readingWorked = true;
-  std::string errorMessage = "";
+  errorMessage.clear();
   try
   {
-    vtkDebugMacro("ReadDataInternal: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
+    vtkDebugWithObjectMacro(reader, "UpdateReader: right before reader update, reader num files = " << reader->GetNumberOfFileNames());
     reader->Update();
     if (reader->GetErrorCode() != vtkErrorCode::NoError)
     {
@@ -412,6 +407,144 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     errorMessage = std::string("ITK exception info: error in ") + e.GetLocation() + "\n"
                                                 + e.GetDescription() + "\n";
   }
+  return readingWorked;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::PrefetchData(vtkMRMLNode* refNode)
+{
+  this->ClearPrefetchedData();
+  // Same conditions as in ReadData: data is not read for nodes that are not
+  // in the scene or when the scene does not read data on load
+  if (!refNode || !refNode->GetAddToScene()
+    || (this->GetScene() && this->GetScene()->GetReadDataOnLoad() == 0))
+  {
+    return false;
+  }
+  // Memory mapped volumes are not read into memory, therefore there is nothing to prefetch
+  if (this->GetWriteState() == SkippedNoData || this->UseMemoryMapping
+    || !this->CanReadInReferenceNode(refNode)
+    || (this->GetURI() && strlen(this->GetURI()) > 0))
+  {
+    return false;
+  }
+  std::string fullName = this->GetFullNameFromFileName();
+  if (fullName.empty() || !vtksys::SystemTools::FileExists(fullName.c_str()))
+  {
+    return false;
+  }
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  reader.TakeReference(this->CreateReader(refNode, fullName));
+  if (reader.GetPointer() == nullptr)
+  {
+    return false;
+  }
+  this->PrefetchedReadingWorked = vtkMRMLVolumeArchetypeStorageNode::UpdateReader(reader, this->PrefetchedErrorMessage);
+  this->PrefetchedReader = reader;
+  this->PrefetchedFileName = fullName;
+  this->PrefetchedUserMessages = vtkSmartPointer<vtkMRMLMessageCollection>::New();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeArchetypeStorageNode::ClearPrefetchedData()
+{
+  Superclass::ClearPrefetchedData();
+  this->PrefetchedReader = nullptr;
+  this->PrefetchedReadingWorked = false;
+  this->PrefetchedErrorMessage.clear();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::IsFileInUseAfterRead(vtkMRMLNode* refNode)
+{
+#ifdef MRML_USE_vtkTeem
+  vtkMRMLVolumeNode* volNode = vtkMRMLVolumeNode::SafeDownCast(refNode);
+  if (!volNode || !volNode->GetImageData())
+  {
+    return false;
+  }
+  return vtkTeemNRRDReader::IsMemoryMappedArray(volNode->GetImageData()->GetPointData()->GetScalars());
+#else
+  (void)refNode;
+  return false;
+#endif
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
+{
+  // Skip file loading for empty volume, for which no file was saved
+  if (this->GetWriteState() == SkippedNoData)
+  {
+    vtkDebugMacro("ReadDataInternal: Empty volume file was not saved, ignore loading");
+    return 1;
+  }
+
+  std::string fullName = this->GetFullNameFromFileName();
+  vtkDebugMacro("ReadData: got full archetype name " << fullName);
+
+  if (fullName.empty())
+  {
+    vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal: File name not specified");
+    return 0;
+  }
+
+  //
+  // vtkMRMLVolumeNode
+  //   |
+  //   |--vtkMRMLScalarVolumeNode
+  //         |
+  //         |----vtkMRMLDiffusionWeightedVolumeNode
+  //         |
+  //         |----vtkMRMLTensorVolumeNode
+  //                  |
+  //                  |---vtkMRMLDiffusionImageVolumeNode
+  //                  |       |
+  //                  |       |---vtkMRMLDiffusionTensorVolumeNode
+  //                  |
+  //                  |---vtkMRMLVectorVolumeNode
+  //
+
+  vtkMRMLScalarVolumeNode * volNode = vtkMRMLScalarVolumeNode::SafeDownCast(refNode);
+  if (volNode == nullptr)
+  {
+    vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal: Reference node is expected to be a vtkMRMLScalarVolumeNode");
+    return 0;
+  }
+
+  if (this->UseMemoryMapping && this->ReadDataInternalMemoryMapped(volNode, fullName))
+  {
+    return 1;
+  }
+
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> reader;
+  bool readingWorked = true;
+  std::string errorMessage;
+  if (this->UsePrefetchedData(fullName))
+  {
+    // file has been already read by PrefetchData
+    reader = this->PrefetchedReader;
+    readingWorked = this->PrefetchedReadingWorked;
+    errorMessage = this->PrefetchedErrorMessage;
+  }
+  else
+  {
+    reader.TakeReference(this->CreateReader(refNode, fullName));
+    if (reader.GetPointer() == nullptr)
+    {
+      vtkErrorMacro("vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal: Failed to instantiate a file reader");
+      return 0;
+    }
+    reader->AddObserver( vtkCommand::ProgressEvent,  this->MRMLCallbackCommand);
+    readingWorked = vtkMRMLVolumeArchetypeStorageNode::UpdateReader(reader, errorMessage);
+  }
+
+  if (volNode->GetImageData())
+  {
+    volNode->SetAndObserveImageData(nullptr);
+  }
+
   if (!readingWorked)
   {
     vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal",
@@ -493,8 +626,27 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     }
   }
 
+  if (!this->SetImageDataFromReaderOutput(volNode, reader->GetOutput(), reader->GetRasToIjkMatrix(),
+    this->ConvertVoxelVectorTypeVTKITKToMRML(reader->GetVoxelVectorType()), fullName))
+  {
+    return 0;
+  }
+
+  if (volNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+  {
+    vtkMRMLDiffusionTensorVolumeNode* dtvn = vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(volNode);
+    dtvn->SetMeasurementFrameMatrix(reader->GetMeasurementFrameMatrix());
+  }
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::SetImageDataFromReaderOutput(vtkMRMLScalarVolumeNode* volNode,
+  vtkImageData* readerOutput, vtkMatrix4x4* rasToIjkMatrix, int voxelVectorType, const std::string& fullName)
+{
   vtkNew<vtkImageChangeInformation> ici;
-  ici->SetInputConnection(reader->GetOutputPort());
+  ici->SetInputData(readerOutput);
   ici->SetOutputSpacing( 1, 1, 1 );
   ici->SetOutputOrigin( 0, 0, 0 );
   ici->Update();
@@ -503,14 +655,13 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   {
     vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal",
       vtkMRMLI18N::Format(vtkMRMLTr("vtkMRMLVolumeArchetypeStorageNode", "Cannot read file: '%1'"), fullName.c_str()));
-    return 0;
+    return false;
   }
 
   vtkNew<vtkImageData> outputImage;
   outputImage->ShallowCopy(ici->GetOutput());
   volNode->SetAndObserveImageData(outputImage.GetPointer());
 
-  int voxelVectorType = this->ConvertVoxelVectorTypeVTKITKToMRML(reader->GetVoxelVectorType());
   volNode->SetVoxelVectorType(voxelVectorType);
 
   // If voxel values store spatial vectors then we need to convert from LPS to RAS
@@ -526,7 +677,6 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
     << ". Number of components: " << outputImage->GetNumberOfScalarComponents()
     << ". Pixel type: " << vtkImageScalarTypeNameMacro(outputImage->GetScalarType()) << ".");
 
-  vtkMatrix4x4* rasToIjkMatrix = reader->GetRasToIjkMatrix();
   if (rasToIjkMatrix == nullptr)
   {
     vtkErrorToMessageCollectionMacro(this->GetUserMessages(), "vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal",
@@ -540,14 +690,73 @@ int vtkMRMLVolumeArchetypeStorageNode::ReadDataInternal(vtkMRMLNode *refNode)
   {
     volNode->SetIJKCoordinateSystemToRightHanded();
   }
+  return true;
+}
 
-  if (volNode->IsA("vtkMRMLDiffusionTensorVolumeNode"))
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeArchetypeStorageNode::ReadDataInternalMemoryMapped(vtkMRMLScalarVolumeNode* volNode, const std::string& fullName)
+{
+#ifdef MRML_USE_vtkTeem
+  if (volNode->IsA("vtkMRMLVectorVolumeNode") || volNode->IsA("vtkMRMLTensorVolumeNode"))
   {
-    vtkMRMLDiffusionTensorVolumeNode* dtvn = vtkMRMLDiffusionTensorVolumeNode::SafeDownCast(volNode);
-    dtvn->SetMeasurementFrameMatrix(reader->GetMeasurementFrameMatrix());
+    return false;
+  }
+  std::string fileExt = vtkMRMLStorageNode::GetLowercaseExtensionFromFileName(fullName);
+  if ((fileExt != ".nrrd" && fileExt != ".nhdr") || !this->UseOrientationFromFile)
+  {
+    return false;
   }
 
-  return 1;
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fullName.c_str());
+  reader->SetUseMemoryMapping(true);
+  if (this->CenterImage)
+  {
+    reader->SetUseNativeOriginOff();
+  }
+  else
+  {
+    reader->SetUseNativeOriginOn();
+  }
+  if (!reader->CanReadFile(fullName.c_str()))
+  {
+    return false;
+  }
+  if (!reader->CanUseMemoryMapping()
+    || reader->GetPointDataType() != vtkDataSetAttributes::SCALARS
+    || reader->GetNumberOfComponents() != 1)
+  {
+    vtkDebugMacro("ReadDataInternalMemoryMapped: " << fullName << " cannot be memory mapped, read it instead");
+    return false;
+  }
+  reader->Update();
+  vtkImageData* readerOutput = reader->GetOutput();
+  if (!readerOutput || !vtkTeemNRRDReader::IsMemoryMappedArray(readerOutput->GetPointData()->GetScalars()))
+  {
+    return false;
+  }
+
+  if (volNode->GetImageData())
+  {
+    volNode->SetAndObserveImageData(nullptr);
+  }
+
+  // Header fields are stored in the metadata dictionary, as the ITK reader would do
+  itk::MetaDataDictionary dictionary;
+  for (const auto& keyValue : reader->GetHeaderKeysMap())
+  {
+    itk::EncapsulateMetaData<std::string>(dictionary, keyValue.first, keyValue.second);
+  }
+  volNode->SetMetaDataDictionary(dictionary);
+
+  // The same post-processing is applied as for images read by the ITK reader
+  return this->SetImageDataFromReaderOutput(volNode, readerOutput, reader->GetRasToIjkMatrix(),
+    vtkMRMLVolumeNode::VoxelVectorTypeUndefined, fullName);
+#else
+  (void)volNode;
+  (void)fullName;
+  return false;
+#endif
 }
 
 //----------------------------------------------------------------------------
@@ -568,6 +777,18 @@ int vtkMRMLVolumeArchetypeStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 1;
   }
 
+#ifdef MRML_USE_vtkTeem
+  // Voxels of a memory mapped volume must be loaded into memory before writing,
+  // because the writer may overwrite the mapped file.
+  vtkDataArray* scalars = volNode->GetImageData()->GetPointData()->GetScalars();
+  if (vtkTeemNRRDReader::IsMemoryMappedArray(scalars))
+  {
+    vtkSmartPointer<vtkDataArray> loadedScalars = vtkSmartPointer<vtkDataArray>::Take(scalars->NewInstance());
+    loadedScalars->DeepCopy(scalars);
+    volNode->GetImageData()->GetPointData()->SetScalars(loadedScalars);
+  }
+#endif
+
   // update the file list
   std::string moveFromDir = this->UpdateFileList(refNode, 1);
 
@@ -19,7 +19,9 @@
 
 class vtkImageData;
 class vtkITKArchetypeImageSeriesReader;
+class vtkMRMLScalarVolumeNode;
 class vtkMRMLVolumeNode;
+class vtkMatrix4x4;
 
 /// \brief MRML node for representing a volume storage.
 ///
@@ -86,6 +88,28 @@ public:
   vtkBooleanMacro(ForceRightHandedIJKCoordinateSystem, bool);
   //@}
 
+  //@{
+  /// Map the voxel data file into memory instead of reading it into a newly allocated buffer.
+  /// This makes loading of large volumes faster and allows the operating system to
+  /// share and page out voxel memory. It is only used for uncompressed single-component
+  /// NRRD files in native byte order, other files are read as usual.
+  /// Modified voxel values are never written back to the mapped file.
+  /// Disabled by default.
+  vtkSetMacro(UseMemoryMapping, bool);
+  vtkGetMacro(UseMemoryMapping, bool);
+  vtkBooleanMacro(UseMemoryMapping, bool);
+  //@}
+
+  //@{
+  /// Cache the DICOM tags that are used for grouping and sorting the files of a series
+  /// in the remote cache directory of the scene, so that the headers are not read again
+  /// when the same series is loaded again.
+  /// Disabled by default.
+  vtkSetMacro(UseDICOMHeaderCache, bool);
+  vtkGetMacro(UseDICOMHeaderCache, bool);
+  vtkBooleanMacro(UseDICOMHeaderCache, bool);
+  //@}
+
   /// Convert voxel vector type enum from vtkITK type to MRML type
   static int ConvertVoxelVectorTypeVTKITKToMRML(int vtkitkType);
   /// Convert voxel vector type enum from MRML type to vtkITK type
@@ -108,6 +132,15 @@ public:
   /// using only wrapped types.
   static void SetMetaDataDictionaryFromReader(vtkMRMLVolumeNode*, vtkITKArchetypeImageSeriesReader*);
 
+  /// Read the volume from file into memory, the image is set in the volume node by ReadData().
+  /// Volumes that are memory mapped (see UseMemoryMapping) are not prefetched.
+  /// \sa vtkMRMLStorageNode::PrefetchData()
+  bool PrefetchData(vtkMRMLNode* refNode) override;
+  void ClearPrefetchedData() override;
+
+  /// Returns true if voxels of the volume are mapped from the file (see UseMemoryMapping).
+  bool IsFileInUseAfterRead(vtkMRMLNode* refNode) override;
+
 protected:
   vtkMRMLVolumeArchetypeStorageNode();
   ~vtkMRMLVolumeArchetypeStorageNode() override;
@@ -119,11 +152,29 @@ protected:
 
   vtkITKArchetypeImageSeriesReader* InstantiateVectorVolumeReader(const std::string &fullName);
 
+  /// Create and set up a reader for the reference node. Returns a new reference.
+  /// The storage node and the reference node are not modified.
+  vtkITKArchetypeImageSeriesReader* CreateReader(vtkMRMLNode* refNode, const std::string& fullName);
+
+  /// Read the image. Returns false and sets errorMessage if reading failed.
+  static bool UpdateReader(vtkITKArchetypeImageSeriesReader* reader, std::string& errorMessage);
+
   void ConvertSpatialVectorVoxelsBetweenRasLps(vtkImageData* imageData);
 
   /// Read data and set it in the referenced node
   int ReadDataInternal(vtkMRMLNode *refNode) override;
 
+  /// Store the image that a reader produced in the volume node: image origin and spacing are reset
+  /// (geometry is stored in the RAS to IJK matrix), spatial vectors are converted from LPS to RAS,
+  /// and the IJK coordinate system is made right-handed if requested.
+  /// Used for all readers, so that the loaded volume does not depend on how the file was read.
+  bool SetImageDataFromReaderOutput(vtkMRMLScalarVolumeNode* volNode, vtkImageData* readerOutput,
+    vtkMatrix4x4* rasToIjkMatrix, int voxelVectorType, const std::string& fullName);
+
+  /// Read data by mapping the file into memory (see UseMemoryMapping).
+  /// Returns false if the file cannot be mapped, in this case the file must be read using the ITK reader.
+  bool ReadDataInternalMemoryMapped(vtkMRMLScalarVolumeNode* volNode, const std::string& fullName);
+
   /// Write data from a referenced node
   int WriteDataInternal(vtkMRMLNode *refNode) override;
 
@@ -131,6 +182,13 @@ protected:
   int SingleFile;
   int UseOrientationFromFile;
   bool ForceRightHandedIJKCoordinateSystem;
+  bool UseMemoryMapping{false};
+  bool UseDICOMHeaderCache{false};
+
+  /// Reader that has read the image in PrefetchData()
+  vtkSmartPointer<vtkITKArchetypeImageSeriesReader> PrefetchedReader;
+  bool PrefetchedReadingWorked{false};
+  std::string PrefetchedErrorMessage;
 
 };
 
@@ -168,7 +168,12 @@ void vtkMRMLVolumeNode::CopyContent(vtkMRMLNode* anode, bool deepCopy/*=true*/)
   {
     return;
   }
-  if (deepCopy)
+  if (deepCopy && this->ImageDataToShareOnCopy)
+  {
+    // Unmodified image data of a previous undo copy (see CopyForUndo)
+    this->SetAndObserveImageData(this->ImageDataToShareOnCopy);
+  }
+  else if (deepCopy)
   {
     vtkSmartPointer<vtkImageData> targetImageData = node->GetImageData();
     if (targetImageData.GetPointer() != nullptr)
@@ -990,6 +995,30 @@ bool vtkMRMLVolumeNode::GetModifiedSinceRead()
     (this->GetImageData() && this->GetImageData()->GetMTime() > this->GetStoredTime());
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLVolumeNode::GetContentMTime()
+{
+  return std::max(this->Superclass::GetContentMTime(), vtkMRMLStorableNode::GetDataObjectContentMTime(this->GetImageData()));
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeNode::CopyForUndo(vtkMRMLNode* anode, vtkMRMLNode* previousCopy, vtkMTimeType previousCopyContentMTime)
+{
+  vtkMRMLVolumeNode* node = vtkMRMLVolumeNode::SafeDownCast(anode);
+  vtkMRMLVolumeNode* previousVolumeCopy = vtkMRMLVolumeNode::SafeDownCast(previousCopy);
+  vtkImageData* imageData = (node ? node->GetImageData() : nullptr);
+  if (imageData && previousVolumeCopy && previousVolumeCopy->GetImageData()
+    && previousVolumeCopy->UndoSourceImageData.GetPointer() == imageData
+    && vtkMRMLStorableNode::GetDataObjectContentMTime(imageData) <= previousCopyContentMTime)
+  {
+    // Copies in the undo stack are not modified, therefore the image data can be shared
+    this->ImageDataToShareOnCopy = previousVolumeCopy->GetImageData();
+  }
+  this->Superclass::CopyForUndo(anode, previousCopy, previousCopyContentMTime);
+  this->ImageDataToShareOnCopy = nullptr;
+  this->UndoSourceImageData = imageData;
+}
+
 //---------------------------------------------------------------------------
 bool vtkMRMLVolumeNode::CanApplyNonLinearTransforms()const
 {
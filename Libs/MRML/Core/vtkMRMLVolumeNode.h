@@ -20,6 +20,8 @@
 class vtkMRMLVolumeDisplayNode;
 
 // VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
 class vtkAlgorithmOutput;
 class vtkEventForwarderCommand;
 class vtkImageData;
@@ -227,6 +229,14 @@ public:
 
   bool GetModifiedSinceRead() override;
 
+  /// Includes modification of the image data and its arrays.
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
+  /// Shares the image data with the previous copy if the image data has not been modified since then.
+  /// \sa vtkMRMLNode::CopyForUndo()
+  void CopyForUndo(vtkMRMLNode* node, vtkMRMLNode* previousCopy, vtkMTimeType previousCopyContentMTime) override;
+
   ///
   /// Get background voxel value of the image. It can be used for assigning
   /// intensity value to "empty" voxels when the image is transformed.
@@ -313,6 +323,12 @@ protected:
 
   int VoxelVectorType;
   itk::MetaDataDictionary Dictionary;
+
+  /// Image data of the node that this node was copied from by CopyForUndo()
+  vtkWeakPointer<vtkImageData> UndoSourceImageData;
+  /// Image data that CopyContent() uses instead of copying the image data of the source node
+  /// (set by CopyForUndo() while copying)
+  vtkSmartPointer<vtkImageData> ImageDataToShareOnCopy;
 };
 
 #endif
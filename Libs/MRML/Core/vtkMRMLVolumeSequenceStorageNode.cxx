@@ -8,6 +8,7 @@ or http://www.slicer.org/copyright/copyright.txt for details.
 =========================================================================auto=*/
 
 #include <algorithm>
+#include <chrono>
 
 #include <vtkAddonMathUtilities.h>
 
@@ -40,6 +41,54 @@ vtkMRMLVolumeSequenceStorageNode::vtkMRMLVolumeSequenceStorageNode() = default;
 //----------------------------------------------------------------------------
 vtkMRMLVolumeSequenceStorageNode::~vtkMRMLVolumeSequenceStorageNode() = default;
 
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  Superclass::PrintSelf(os,indent);
+  vtkMRMLPrintBeginMacro(os, indent);
+  vtkMRMLPrintBooleanMacro(LazyLoading);
+  vtkMRMLPrintIntMacro(MaximumNumberOfCachedFrames);
+  vtkMRMLPrintIntMacro(NumberOfReadAheadFrames);
+  vtkMRMLPrintEndMacro();
+  os << indent << "NumberOfLazyFrames: " << this->LazyFrames.size() << "\n";
+  os << indent << "NumberOfLoadedLazyFrames: " << this->LoadedLazyFrameIndices.size() << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ReadXMLAttributes(const char** atts)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::ReadXMLAttributes(atts);
+  vtkMRMLReadXMLBeginMacro(atts);
+  vtkMRMLReadXMLBooleanMacro(lazyLoading, LazyLoading);
+  vtkMRMLReadXMLIntMacro(maximumNumberOfCachedFrames, MaximumNumberOfCachedFrames);
+  vtkMRMLReadXMLIntMacro(numberOfReadAheadFrames, NumberOfReadAheadFrames);
+  vtkMRMLReadXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::WriteXML(ostream& of, int nIndent)
+{
+  Superclass::WriteXML(of, nIndent);
+  vtkMRMLWriteXMLBeginMacro(of);
+  vtkMRMLWriteXMLBooleanMacro(lazyLoading, LazyLoading);
+  vtkMRMLWriteXMLIntMacro(maximumNumberOfCachedFrames, MaximumNumberOfCachedFrames);
+  vtkMRMLWriteXMLIntMacro(numberOfReadAheadFrames, NumberOfReadAheadFrames);
+  vtkMRMLWriteXMLEndMacro();
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::Copy(vtkMRMLNode *anode)
+{
+  MRMLNodeModifyBlocker blocker(this);
+  Superclass::Copy(anode);
+  vtkMRMLCopyBeginMacro(anode);
+  vtkMRMLCopyBooleanMacro(LazyLoading);
+  vtkMRMLCopyIntMacro(MaximumNumberOfCachedFrames);
+  vtkMRMLCopyIntMacro(NumberOfReadAheadFrames);
+  vtkMRMLCopyEndMacro();
+}
+
 //----------------------------------------------------------------------------
 bool vtkMRMLVolumeSequenceStorageNode::CanReadInReferenceNode(vtkMRMLNode *refNode)
 {
@@ -68,7 +117,10 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
     return 0;
   }
 
-  vtkNew<vtkTeemNRRDReader> reader;
+  // Frames that were read on demand from the previous file cannot be read anymore
+  this->ClearLazyFrames();
+
+  vtkSmartPointer<vtkTeemNRRDReader> reader = vtkSmartPointer<vtkTeemNRRDReader>::New();
   reader->SetFileName(fullName.c_str());
 
   // Check if this is a NRRD file that we can read
@@ -158,12 +210,28 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
   const char* sequenceAxisUnit = reader->GetAxisUnit(frameAxis);
   volSequenceNode->SetIndexUnit(sequenceAxisUnit ? sequenceAxisUnit : "");
 
+  // With lazy loading only the geometry of the frames is set now and voxels are read in LoadFrame.
+  bool lazyLoading = false;
+  if (this->LazyLoading)
+  {
+    lazyLoading = reader->CanReadComponent();
+    if (!lazyLoading)
+    {
+      vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: frames of " << fullName
+        << " cannot be read on demand (file is compressed), all frames are read now.");
+    }
+  }
+
   // Read and copy the data to sequence of volume nodes
 #ifdef NRRD_CHUNK_IO_AVAILABLE
   int numberOfFrames = reader->GetNumberOfImages();
   vtkImageData* imageData = nullptr;
   vtkNew<vtkImageExtractComponents> extractComponents;
-  if (!readAsMultipleImagesOn)
+  if (lazyLoading)
+  {
+    numberOfFrames = reader->GetNumberOfComponents();
+  }
+  else if (!readAsMultipleImagesOn)
   {
     reader->Update();
     // Copy image data to sequence of volume nodes
@@ -177,18 +245,31 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
     extractComponents->SetInputConnection(reader->GetOutputPort());
   }
 #else
-  reader->Update();
-  // Copy image data to sequence of volume nodes
-  vtkImageData* imageData = reader->GetOutput();
-  if (imageData == nullptr || imageData->GetPointData()==nullptr || imageData->GetPointData()->GetScalars() == nullptr)
+  int numberOfFrames = 0;
+  vtkNew<vtkImageExtractComponents> extractComponents;
+  if (lazyLoading)
   {
-    vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: invalid image data");
-    return 0;
+    numberOfFrames = reader->GetNumberOfComponents();
+  }
+  else
+  {
+    reader->Update();
+    // Copy image data to sequence of volume nodes
+    vtkImageData* imageData = reader->GetOutput();
+    if (imageData == nullptr || imageData->GetPointData()==nullptr || imageData->GetPointData()->GetScalars() == nullptr)
+    {
+      vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: invalid image data");
+      return 0;
+    }
+    numberOfFrames = imageData->GetNumberOfScalarComponents();
+    extractComponents->SetInputConnection(reader->GetOutputPort());
   }
-  int numberOfFrames = imageData->GetNumberOfScalarComponents();
-  vtkNew<vtkImageExtractComponents> extractComponents;
-  extractComponents->SetInputConnection(reader->GetOutputPort());
 #endif
+  if (lazyLoading)
+  {
+    this->LazyFrameReader = reader;
+    this->LazyFrames.resize(numberOfFrames);
+  }
 
   vtkDebugMacro(<< " vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: Starting reading sequence. ");
   for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
@@ -196,7 +277,13 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
     vtkDebugMacro(<< " reading frame : "<<frameIndex);
 #ifdef NRRD_CHUNK_IO_AVAILABLE
     vtkImageData *frameVoxels = nullptr;
-    if (readAsMultipleImagesOn)
+    vtkSmartPointer<vtkImageData> framePlaceholder;
+    if (lazyLoading)
+    {
+      framePlaceholder = this->CreateFramePlaceholderImage();
+      frameVoxels = framePlaceholder;
+    }
+    else if (readAsMultipleImagesOn)
     {
       reader->SetCurrentImageIndex(frameIndex);
       reader->Update();
@@ -211,10 +298,18 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
       frameVoxels = extractComponents->GetOutput();
     }
 #else
-    extractComponents->SetComponents(frameIndex);
-    extractComponents->Update();
-    vtkNew<vtkImageData> frameVoxels;
-    frameVoxels->DeepCopy(extractComponents->GetOutput());
+    vtkSmartPointer<vtkImageData> frameVoxels;
+    if (lazyLoading)
+    {
+      frameVoxels = this->CreateFramePlaceholderImage();
+    }
+    else
+    {
+      extractComponents->SetComponents(frameIndex);
+      extractComponents->Update();
+      frameVoxels = vtkSmartPointer<vtkImageData>::New();
+      frameVoxels->DeepCopy(extractComponents->GetOutput());
+    }
 #endif
     // Slicer expects normalized image position and spacing
     frameVoxels->SetOrigin(0, 0, 0);
@@ -260,7 +355,19 @@ int vtkMRMLVolumeSequenceStorageNode::ReadDataInternal(vtkMRMLNode* refNode)
     std::ostringstream nameStr;
     nameStr << refNode->GetName() << "_" << std::setw(4) << std::setfill('0') << frameIndex << std::ends;
     frameVolume->SetName( nameStr.str().c_str() );
-    volSequenceNode->SetDataNodeAtValue(frameVolume.GetPointer(), indexStr.str().c_str() );
+    vtkMRMLNode* addedFrameNode = volSequenceNode->SetDataNodeAtValue(frameVolume.GetPointer(), indexStr.str().c_str() );
+    if (lazyLoading)
+    {
+      LazyFrameType& frame = this->LazyFrames[frameIndex];
+      frame.VolumeNode = vtkMRMLVolumeNode::SafeDownCast(addedFrameNode);
+      if (frame.VolumeNode)
+      {
+        this->LazyFrameIndices[addedFrameNode] = frameIndex;
+        // the sequence node stores a copy of the placeholder image
+        frame.PlaceholderImageData = frame.VolumeNode->GetImageData();
+        frame.PlaceholderImageDataMTime = frame.PlaceholderImageData ? frame.PlaceholderImageData->GetMTime() : 0;
+      }
+    }
   }
 
   vtkDebugMacro(<< " vtkMRMLVolumeSequenceStorageNode::ReadDataInternal: sequence successfully read. ");
@@ -293,6 +400,11 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
     firstFrameVolume->GetImageData()->GetExtent(firstFrameVolumeExtent);
     firstFrameVolumeScalarType = firstFrameVolume->GetImageData()->GetScalarType();
     firstFrameVolumeNumberOfComponents = firstFrameVolume->GetImageData()->GetNumberOfScalarComponents();
+    if (this->IsFrameLoadPending(firstFrameVolume))
+    {
+      // Voxels are not read yet, get the scalar type from the file header
+      firstFrameVolumeScalarType = this->LazyFrameReader->GetDataType();
+    }
     // VTK NRRD writer only supports 4D volumes (writing a 3D color volume sequence would require 5D)
     if (firstFrameVolumeNumberOfComponents != 1)
     {
@@ -306,6 +418,11 @@ bool vtkMRMLVolumeSequenceStorageNode::CanWriteFromReferenceNode(vtkMRMLNode *re
   int numberOfFrameVolumes = volSequenceNode->GetNumberOfDataNodes();
   for (int frameIndex = 1; frameIndex<numberOfFrameVolumes; frameIndex++)
   {
+    if (this->IsFrameLoadPending(volSequenceNode->GetNthDataNode(frameIndex)))
+    {
+      // Frame has the same geometry and scalar type as the other frames read from the same file
+      continue;
+    }
     vtkMRMLVolumeNode* currentFrameVolume = vtkMRMLVolumeNode::SafeDownCast(volSequenceNode->GetNthDataNode(frameIndex));
     if (currentFrameVolume == nullptr)
     {
@@ -369,6 +486,13 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
     return 0;
   }
 
+  // All frames must be in memory before writing, as the file that they would be read from may be overwritten
+  if (this->IsLazyLoadingActive() && !this->LoadAllFrames())
+  {
+    this->GetUserMessages()->AddMessage(vtkCommand::ErrorEvent, std::string("Failed to read all frames of the sequence."));
+    return 0;
+  }
+
   vtkNew<vtkMatrix4x4> firstVolumeIjkToRas;
   int frameVolumeDimensions[3] = {0};
   int frameVolumeScalarType = VTK_VOID;
@@ -461,7 +585,7 @@ int vtkMRMLVolumeSequenceStorageNode::WriteDataInternal(vtkMRMLNode *refNode)
   writer->WriteMultipleImagesAsImageListsOn();
 #endif
 
-  writer->SetUseCompression(this->GetUseCompression());
+  this->SetWriterCompression(writer);
 
   // Set volume attributes
   writer->SetIJKToRASMatrix(firstVolumeIjkToRas.GetPointer());
@@ -637,3 +761,316 @@ const char* vtkMRMLVolumeSequenceStorageNode::GetDefaultWriteFileExtension()
 {
   return "seq.nrrd";
 }
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::IsLazyLoadingActive()
+{
+  return this->LazyFrameReader != nullptr && !this->LazyFrames.empty();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::IsFileInUseAfterRead(vtkMRMLNode* vtkNotUsed(refNode))
+{
+  return this->IsLazyLoadingActive();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::IsFrameLoadPending(vtkMRMLNode* dataNode)
+{
+  int frameIndex = this->GetLazyFrameIndex(dataNode);
+  if (frameIndex < 0)
+  {
+    return false;
+  }
+  return this->LazyFrames[frameIndex].LoadedImageData == nullptr;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::IsFrameReady(vtkMRMLNode* dataNode)
+{
+  int frameIndex = this->GetLazyFrameIndex(dataNode);
+  if (frameIndex < 0 || this->LazyFrames[frameIndex].LoadedImageData != nullptr
+    || this->IsLazyFramePlaceholderModified(frameIndex))
+  {
+    return true;
+  }
+  auto prefetchedFrameIt = this->PrefetchedLazyFrames.find(frameIndex);
+  if (prefetchedFrameIt == this->PrefetchedLazyFrames.end())
+  {
+    return false;
+  }
+  return prefetchedFrameIt->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::PrefetchFrame(vtkMRMLNode* dataNode)
+{
+  int frameIndex = this->GetLazyFrameIndex(dataNode);
+  if (frameIndex < 0)
+  {
+    return false;
+  }
+  return this->PrefetchLazyFrame(frameIndex);
+}
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeSequenceStorageNode::GetLazyFrameIndex(vtkMRMLNode* dataNode)
+{
+  if (!dataNode || !this->IsLazyLoadingActive())
+  {
+    return -1;
+  }
+  auto frameIndexIt = this->LazyFrameIndices.find(dataNode);
+  if (frameIndexIt == this->LazyFrameIndices.end())
+  {
+    return -1;
+  }
+  // the data node may have been deleted and another node created at the same address
+  if (this->LazyFrames[frameIndexIt->second].VolumeNode != dataNode)
+  {
+    this->LazyFrameIndices.erase(frameIndexIt);
+    return -1;
+  }
+  return frameIndexIt->second;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::LoadFrame(vtkMRMLNode* dataNode, int readAheadDirection/*=0*/)
+{
+  int frameIndex = this->GetLazyFrameIndex(dataNode);
+  if (frameIndex < 0)
+  {
+    return false;
+  }
+  if (!this->LoadLazyFrame(frameIndex))
+  {
+    return false;
+  }
+
+  if (readAheadDirection != 0)
+  {
+    // Read-ahead frames must not push the requested frame out of the cache
+    int numberOfFrames = static_cast<int>(this->LazyFrames.size());
+    int numberOfReadAheadFrames = std::min(this->NumberOfReadAheadFrames, this->MaximumNumberOfCachedFrames - 1);
+    numberOfReadAheadFrames = std::min(numberOfReadAheadFrames, numberOfFrames - 1);
+    int step = (readAheadDirection > 0 ? 1 : -1);
+    std::vector<int> readAheadFrameIndices;
+    for (int readAheadIndex = 1; readAheadIndex <= numberOfReadAheadFrames; ++readAheadIndex)
+    {
+      // wrap around, as playback is usually looped
+      int readAheadFrameIndex = ((frameIndex + step * readAheadIndex) % numberOfFrames + numberOfFrames) % numberOfFrames;
+      readAheadFrameIndices.push_back(readAheadFrameIndex);
+      this->PrefetchLazyFrame(readAheadFrameIndex);
+    }
+    // Discard completed reads that are no longer ahead of the current frame (e.g., playback direction changed)
+    // or whose frame has been removed or modified meanwhile.
+    // Reads that are still in progress are kept, as discarding them would block until they complete.
+    for (auto prefetchedFrameIt = this->PrefetchedLazyFrames.begin(); prefetchedFrameIt != this->PrefetchedLazyFrames.end();)
+    {
+      int prefetchedFrameIndex = prefetchedFrameIt->first;
+      bool obsolete = (this->LazyFrames[prefetchedFrameIndex].VolumeNode == nullptr
+        || this->IsLazyFramePlaceholderModified(prefetchedFrameIndex)
+        || std::find(readAheadFrameIndices.begin(), readAheadFrameIndices.end(), prefetchedFrameIndex) == readAheadFrameIndices.end());
+      if (obsolete && prefetchedFrameIt->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+      {
+        prefetchedFrameIt = this->PrefetchedLazyFrames.erase(prefetchedFrameIt);
+      }
+      else
+      {
+        ++prefetchedFrameIt;
+      }
+    }
+  }
+
+  // Release least recently used frames
+  while (static_cast<int>(this->LoadedLazyFrameIndices.size()) > this->MaximumNumberOfCachedFrames)
+  {
+    int releasedFrameIndex = this->LoadedLazyFrameIndices.back();
+    this->LoadedLazyFrameIndices.pop_back();
+    this->ReleaseLazyFrame(releasedFrameIndex);
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::LoadLazyFrame(int frameIndex)
+{
+  LazyFrameType& frame = this->LazyFrames[frameIndex];
+  if (frame.VolumeNode == nullptr)
+  {
+    // frame has been removed from the sequence
+    return false;
+  }
+  if (frame.LoadedImageData != nullptr)
+  {
+    // already loaded, just mark it as most recently used
+    this->LoadedLazyFrameIndices.remove(frameIndex);
+    this->LoadedLazyFrameIndices.push_front(frameIndex);
+    return true;
+  }
+  if (this->IsLazyFramePlaceholderModified(frameIndex))
+  {
+    // The frame has been replaced or modified, it must not be overwritten by the voxels in the file.
+    // Discard the background read (waits for its completion) and stop managing the frame.
+    vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::LoadLazyFrame: frame " << frameIndex << " has been modified");
+    this->PrefetchedLazyFrames.erase(frameIndex);
+    frame.VolumeNode = nullptr;
+    return false;
+  }
+
+  vtkSmartPointer<vtkImageData> frameVoxels;
+  auto prefetchedFrameIt = this->PrefetchedLazyFrames.find(frameIndex);
+  if (prefetchedFrameIt != this->PrefetchedLazyFrames.end())
+  {
+    // Frame has been read in the background (wait for completion if it is still in progress)
+    vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::LoadLazyFrame: using prefetched frame " << frameIndex);
+    frameVoxels = prefetchedFrameIt->second.get();
+    this->PrefetchedLazyFrames.erase(prefetchedFrameIt);
+  }
+  else
+  {
+    vtkDebugMacro("vtkMRMLVolumeSequenceStorageNode::LoadLazyFrame: reading frame " << frameIndex);
+    frameVoxels = vtkSmartPointer<vtkImageData>::New();
+    if (!this->LazyFrameReader->ReadComponent(frameIndex, frameVoxels))
+    {
+      frameVoxels = nullptr;
+    }
+  }
+  if (!frameVoxels)
+  {
+    vtkErrorMacro("vtkMRMLVolumeSequenceStorageNode::LoadLazyFrame: failed to read frame " << frameIndex
+      << " from " << (this->LazyFrameReader->GetFileName() ? this->LazyFrameReader->GetFileName() : "(none)"));
+    return false;
+  }
+  // Slicer expects normalized image position and spacing
+  frameVoxels->SetOrigin(0, 0, 0);
+  frameVoxels->SetSpacing(1, 1, 1);
+  frame.VolumeNode->SetAndObserveImageData(frameVoxels);
+  frame.LoadedImageData = frameVoxels;
+  frame.LoadedImageDataMTime = frameVoxels->GetMTime();
+  this->LoadedLazyFrameIndices.push_front(frameIndex);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::PrefetchLazyFrame(int frameIndex)
+{
+  LazyFrameType& frame = this->LazyFrames[frameIndex];
+  if (frame.VolumeNode == nullptr || frame.LoadedImageData != nullptr
+    || this->PrefetchedLazyFrames.find(frameIndex) != this->PrefetchedLazyFrames.end()
+    || this->IsLazyFramePlaceholderModified(frameIndex))
+  {
+    // removed, already loaded, being read, or modified
+    return true;
+  }
+  if (static_cast<int>(this->PrefetchedLazyFrames.size()) >= this->MaximumNumberOfCachedFrames)
+  {
+    // do not use more memory for prefetched frames than for cached frames
+    return false;
+  }
+  // The reader is only used for reading voxels after the header is read, which does not modify the reader.
+  // The reader is captured by a smart pointer to keep it alive even if lazy loading is stopped meanwhile.
+  vtkSmartPointer<vtkTeemNRRDReader> reader = this->LazyFrameReader;
+  this->PrefetchedLazyFrames[frameIndex] = std::async(std::launch::async, [reader, frameIndex]()
+    {
+      vtkSmartPointer<vtkImageData> frameVoxels = vtkSmartPointer<vtkImageData>::New();
+      if (!reader->ReadComponent(frameIndex, frameVoxels))
+      {
+        return vtkSmartPointer<vtkImageData>();
+      }
+      return frameVoxels;
+    });
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ReleaseLazyFrame(int frameIndex)
+{
+  LazyFrameType& frame = this->LazyFrames[frameIndex];
+  vtkImageData* loadedImageData = frame.LoadedImageData;
+  frame.LoadedImageData = nullptr;
+  if (frame.VolumeNode == nullptr || loadedImageData == nullptr)
+  {
+    return;
+  }
+  if (frame.VolumeNode->GetImageData() != loadedImageData
+    || loadedImageData->GetMTime() != frame.LoadedImageDataMTime)
+  {
+    // The frame has been modified since it was read, it cannot be read from file again.
+    // Keep it in memory and stop managing it.
+    frame.VolumeNode = nullptr;
+    return;
+  }
+  // Proxy nodes that display this frame keep a reference to the voxels, so they are not affected.
+  this->SetLazyFramePlaceholder(frameIndex);
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::IsLazyFramePlaceholderModified(int frameIndex)
+{
+  LazyFrameType& frame = this->LazyFrames[frameIndex];
+  if (frame.VolumeNode == nullptr || frame.LoadedImageData != nullptr)
+  {
+    return false;
+  }
+  vtkImageData* imageData = frame.VolumeNode->GetImageData();
+  return imageData == nullptr || imageData != frame.PlaceholderImageData
+    || imageData->GetMTime() != frame.PlaceholderImageDataMTime;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::SetLazyFramePlaceholder(int frameIndex)
+{
+  LazyFrameType& frame = this->LazyFrames[frameIndex];
+  vtkSmartPointer<vtkImageData> placeholderImageData = this->CreateFramePlaceholderImage();
+  frame.VolumeNode->SetAndObserveImageData(placeholderImageData);
+  frame.PlaceholderImageData = placeholderImageData;
+  frame.PlaceholderImageDataMTime = placeholderImageData->GetMTime();
+}
+
+//----------------------------------------------------------------------------
+bool vtkMRMLVolumeSequenceStorageNode::LoadAllFrames()
+{
+  if (!this->IsLazyLoadingActive())
+  {
+    return true;
+  }
+  bool success = true;
+  for (int frameIndex = 0; frameIndex < static_cast<int>(this->LazyFrames.size()); ++frameIndex)
+  {
+    if (this->LazyFrames[frameIndex].VolumeNode != nullptr
+      && this->LazyFrames[frameIndex].LoadedImageData == nullptr
+      && !this->LoadLazyFrame(frameIndex))
+    {
+      success = false;
+    }
+  }
+  if (success)
+  {
+    this->ClearLazyFrames();
+  }
+  return success;
+}
+
+//----------------------------------------------------------------------------
+void vtkMRMLVolumeSequenceStorageNode::ClearLazyFrames()
+{
+  // waits for completion of background reads
+  this->PrefetchedLazyFrames.clear();
+  this->LazyFrames.clear();
+  this->LazyFrameIndices.clear();
+  this->LoadedLazyFrameIndices.clear();
+  this->LazyFrameReader = nullptr;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> vtkMRMLVolumeSequenceStorageNode::CreateFramePlaceholderImage()
+{
+  vtkSmartPointer<vtkImageData> placeholder = vtkSmartPointer<vtkImageData>::New();
+  if (this->LazyFrameReader)
+  {
+    placeholder->SetExtent(this->LazyFrameReader->GetDataExtent());
+  }
+  return placeholder;
+}
@@ -16,7 +16,21 @@
 #include "vtkMRML.h"
 
 #include "vtkMRMLNRRDStorageNode.h"
+
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <future>
+#include <list>
+#include <map>
 #include <string>
+#include <vector>
+
+class vtkImageData;
+class vtkMRMLVolumeNode;
+class vtkTeemNRRDReader;
 
 class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStorageNode
 {
@@ -27,6 +41,17 @@ class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStora
 
   vtkMRMLNode* CreateNodeInstance() override;
 
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Read node attributes from XML file
+  void ReadXMLAttributes(const char** atts) override;
+
+  /// Write this node's information to a MRML file in XML format.
+  void WriteXML(ostream& of, int indent) override;
+
+  /// Copy the node's attributes to this object
+  void Copy(vtkMRMLNode *node) override;
+
   ///
   /// Get node XML tag name (like Storage, Model)
   const char* GetNodeTagName() override {return "VolumeSequenceStorage";};
@@ -54,6 +79,54 @@ class VTK_MRML_EXPORT vtkMRMLVolumeSequenceStorageNode : public vtkMRMLNRRDStora
   /// Return a default file extension for writing
   const char* GetDefaultWriteFileExtension() override;
 
+  /// Read frame voxels on demand.
+  /// If enabled then only the header is read when the sequence is loaded and each data node
+  /// gets an image data that only contains the geometry. Voxels of a frame are read from file
+  /// when LoadFrame is called (for example by the sequence browser when the frame is displayed).
+  /// Only uncompressed files are supported, compressed files are always read completely.
+  /// Disabled by default.
+  vtkGetMacro(LazyLoading, bool);
+  vtkSetMacro(LazyLoading, bool);
+  vtkBooleanMacro(LazyLoading, bool);
+
+  /// Maximum number of frames that are kept in memory when lazy loading is active.
+  /// Least recently used frames are released when this limit is exceeded.
+  vtkGetMacro(MaximumNumberOfCachedFrames, int);
+  vtkSetClampMacro(MaximumNumberOfCachedFrames, int, 1, VTK_INT_MAX);
+
+  /// Number of frames that are read in advance in the playback direction
+  /// when lazy loading is active. Frames are read in advance on background threads.
+  vtkGetMacro(NumberOfReadAheadFrames, int);
+  vtkSetClampMacro(NumberOfReadAheadFrames, int, 0, VTK_INT_MAX);
+
+  /// Returns true if the sequence was read with lazy loading and frames are read on demand.
+  bool IsLazyLoadingActive();
+
+  /// Returns true if lazy loading is active, as frames are still read from the file.
+  bool IsFileInUseAfterRead(vtkMRMLNode* refNode) override;
+
+  /// Returns true if voxels of the data node are not read from file yet.
+  bool IsFrameLoadPending(vtkMRMLNode* dataNode);
+
+  /// Make sure voxels of the data node are read from file.
+  /// If readAheadDirection is positive (negative) then reading of the following (preceding)
+  /// NumberOfReadAheadFrames frames is started in the background (see PrefetchFrame).
+  /// Returns false if the data node is not managed by lazy loading or reading failed.
+  bool LoadFrame(vtkMRMLNode* dataNode, int readAheadDirection = 0);
+
+  /// Start reading voxels of the data node on a background thread.
+  /// The voxels are stored in the data node when LoadFrame is called for it.
+  /// Returns false if the data node is not managed by lazy loading or too many reads are in progress.
+  bool PrefetchFrame(vtkMRMLNode* dataNode);
+
+  /// Returns true if LoadFrame can be called for the data node without waiting for file reading:
+  /// the frame is not managed by lazy loading, already loaded, or its background read is completed.
+  bool IsFrameReady(vtkMRMLNode* dataNode);
+
+  /// Read all frames that are not loaded yet and keep them in memory.
+  /// Lazy loading is no longer active after this call.
+  bool LoadAllFrames();
+
 protected:
   vtkMRMLVolumeSequenceStorageNode();
   ~vtkMRMLVolumeSequenceStorageNode() override;
@@ -79,6 +152,59 @@ protected:
 
   /// Initialize all the supported write file types
   void InitializeSupportedWriteFileTypes() override;
+
+  /// Read voxels of a frame from file and store them in the frame's volume node.
+  bool LoadLazyFrame(int frameIndex);
+
+  /// Start reading voxels of a frame on a background thread.
+  bool PrefetchLazyFrame(int frameIndex);
+
+  /// Replace voxels of a loaded frame by an image that only contains the geometry.
+  void ReleaseLazyFrame(int frameIndex);
+
+  /// Returns true if the image of a frame that is not loaded has been replaced or modified
+  /// (the frame then must not be overwritten by voxels read from file).
+  bool IsLazyFramePlaceholderModified(int frameIndex);
+
+  /// Store the image that only contains the geometry in the frame's volume node.
+  void SetLazyFramePlaceholder(int frameIndex);
+
+  /// Stop managing frames (loaded frames remain in memory).
+  void ClearLazyFrames();
+
+  /// Create an image that has the geometry of the frames but no voxels.
+  vtkSmartPointer<vtkImageData> CreateFramePlaceholderImage();
+
+  /// Get index of the frame in the file that is stored in the data node. Returns -1 if not found.
+  int GetLazyFrameIndex(vtkMRMLNode* dataNode);
+
+  bool LazyLoading{false};
+  int MaximumNumberOfCachedFrames{10};
+  int NumberOfReadAheadFrames{2};
+
+  struct LazyFrameType
+  {
+    vtkWeakPointer<vtkMRMLVolumeNode> VolumeNode;
+    /// Image that was read from file, nullptr if not loaded
+    vtkWeakPointer<vtkImageData> LoadedImageData;
+    /// Modified time of the loaded image, used for detecting changes made to the frame
+    vtkMTimeType LoadedImageDataMTime{0};
+    /// Image that only contains the geometry, stored in the volume node while the frame is not loaded
+    vtkWeakPointer<vtkImageData> PlaceholderImageData;
+    /// Modified time of the placeholder image, used for detecting changes made to the frame
+    vtkMTimeType PlaceholderImageDataMTime{0};
+  };
+
+  /// Reader that keeps the header information that is needed for reading frames on demand
+  vtkSmartPointer<vtkTeemNRRDReader> LazyFrameReader;
+  /// Frames in the order they are stored in the file
+  std::vector<LazyFrameType> LazyFrames;
+  /// Index of the frame in LazyFrames for each data node, for fast lookup during playback
+  std::map<vtkMRMLNode*, int> LazyFrameIndices;
+  /// Index of frames that are loaded, most recently used is first
+  std::list<int> LoadedLazyFrameIndices;
+  /// Frames that are being read on background threads (or read but not stored in the data node yet)
+  std::map<int, std::future<vtkSmartPointer<vtkImageData>>> PrefetchedLazyFrames;
 };
 
 #endif
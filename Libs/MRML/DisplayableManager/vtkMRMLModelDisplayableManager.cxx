@@ -32,6 +32,9 @@
 #include <vtkMRMLViewNode.h>
 #include <vtkMRMLVolumeNode.h>
 
+// vtkSegmentationCore includes
+#include <vtkIndexedClipFilter.h>
+
 // VTK includes
 #include <vtkAlgorithm.h>
 #include <vtkAlgorithmOutput.h>
@@ -39,14 +42,10 @@
 #include <vtkCapPolyData.h>
 #include <vtkCallbackCommand.h>
 #include <vtkCellArray.h>
-#include <vtkClipDataSet.h>
-#include <vtkClipPolyData.h>
 #include <vtkColorTransferFunction.h>
 #include <vtkDataSetAttributes.h>
 #include <vtkDataSetMapper.h>
 #include <vtkExtractCells.h>
-#include <vtkExtractGeometry.h>
-#include <vtkExtractPolyDataGeometry.h>
 #include <vtkGeneralTransform.h>
 #include <vtkImageActor.h>
 #include <vtkImageData.h>
@@ -829,7 +828,7 @@ void vtkMRMLModelDisplayableManager::UpdateModelMesh(vtkMRMLDisplayableNode* dis
         {
           oldClipper = this->Internal->Clippers[modelDisplayNode->GetID()];
         }
-        clipper = this->GetClipper(modelDisplayNode, meshType, implicitBoolean, clipNode->GetClippingMethod());
+        clipper = this->GetClipper(modelDisplayNode, implicitBoolean, clipNode->GetClippingMethod());
         filterUpdateNeeded = oldClipper != clipper;
       }
 
@@ -1927,7 +1926,7 @@ void vtkMRMLModelDisplayableManager::SetPickedPointID(vtkIdType newPointID)
 
 //---------------------------------------------------------------------------
 vtkAlgorithm* vtkMRMLModelDisplayableManager::GetClipper(
-  vtkMRMLDisplayNode* dnode, vtkMRMLModelNode::MeshTypeHint type, vtkImplicitFunction* clipFunction, int clippingMethod)
+  vtkMRMLDisplayNode* dnode, vtkImplicitFunction* clipFunction, int clippingMethod)
 {
   if (!dnode || !clipFunction)
   {
@@ -1940,63 +1939,21 @@ vtkAlgorithm* vtkMRMLModelDisplayableManager::GetClipper(
     clipper = this->Internal->Clippers[dnode->GetID()];
   }
 
-  if (type == vtkMRMLModelNode::UnstructuredGridMeshType)
-  {
-    if (clippingMethod == vtkMRMLClipNode::Straight)
-    {
-      vtkSmartPointer<vtkClipDataSet> clipDataSet = vtkClipDataSet::SafeDownCast(clipper);
-      if (!clipDataSet)
-      {
-        clipDataSet = vtkSmartPointer<vtkClipDataSet>::New();
-        clipper = clipDataSet;
-      }
-      clipDataSet->SetClipFunction(clipFunction);
-    }
-    else
-    {
-      vtkSmartPointer<vtkExtractGeometry> extractGeometry = vtkExtractGeometry::SafeDownCast(clipper);
-      if (!extractGeometry)
-      {
-        extractGeometry = vtkSmartPointer<vtkExtractGeometry>::New();
-        clipper = extractGeometry;
-      }
-      extractGeometry->SetImplicitFunction(clipFunction);
-      extractGeometry->ExtractInsideOff();
-      if (clippingMethod == vtkMRMLClipNode::WholeCellsWithBoundary)
-      {
-        extractGeometry->ExtractBoundaryCellsOn();
-      }
-    }
-  }
-  else
+  // The same filter is used for polydata and unstructured grid meshes and for all clipping methods.
+  // It only re-executes when the clip state actually changes and it only evaluates the clip function
+  // near the clip surface, which is important when slice views that are used for clipping are moved.
+  vtkSmartPointer<vtkIndexedClipFilter> clipFilter = vtkIndexedClipFilter::SafeDownCast(clipper);
+  if (!clipFilter)
   {
-    if (clippingMethod == vtkMRMLClipNode::Straight)
-    {
-      vtkSmartPointer<vtkClipPolyData> clipPolyData = vtkClipPolyData::SafeDownCast(clipper);
-      if (!clipPolyData)
-      {
-        clipPolyData = vtkSmartPointer<vtkClipPolyData>::New();
-        clipper = clipPolyData;
-      }
-      clipPolyData->SetValue(0.0);
-      clipPolyData->SetClipFunction(clipFunction);
-    }
-    else
-    {
-      vtkSmartPointer<vtkExtractPolyDataGeometry> extractPolyDataGeometry = vtkExtractPolyDataGeometry::SafeDownCast(clipper);
-      if (!extractPolyDataGeometry)
-      {
-        extractPolyDataGeometry = vtkSmartPointer<vtkExtractPolyDataGeometry>::New();
-        clipper = extractPolyDataGeometry;
-      }
-      extractPolyDataGeometry->SetImplicitFunction(clipFunction);
-      extractPolyDataGeometry->ExtractInsideOff();
-      if (clippingMethod == vtkMRMLClipNode::WholeCellsWithBoundary)
-      {
-        extractPolyDataGeometry->ExtractBoundaryCellsOn();
-      }
-    }
+    clipFilter = vtkSmartPointer<vtkIndexedClipFilter>::New();
+    clipper = clipFilter;
   }
+  static_assert(static_cast<int>(vtkIndexedClipFilter::Straight) == static_cast<int>(vtkMRMLClipNode::Straight)
+    && static_cast<int>(vtkIndexedClipFilter::WholeCells) == static_cast<int>(vtkMRMLClipNode::WholeCells)
+    && static_cast<int>(vtkIndexedClipFilter::WholeCellsWithBoundary) == static_cast<int>(vtkMRMLClipNode::WholeCellsWithBoundary),
+    "vtkIndexedClipFilter clipping methods must match vtkMRMLClipNode clipping methods");
+  clipFilter->SetClipFunction(clipFunction);
+  clipFilter->SetClippingMethod(clippingMethod);
 
   this->Internal->Clippers[dnode->GetID()] = clipper;
   return clipper;
@@ -152,8 +152,8 @@ protected:
                                   vtkMRMLModelNode* model = nullptr);
 
   /// Returns not null if modified
+  /// clipMethod is one of vtkMRMLClipNode::ClippingMethodType values.
   vtkAlgorithm* GetClipper(vtkMRMLDisplayNode* dnode,
-                           vtkMRMLModelNode::MeshTypeHint type,
                            vtkImplicitFunction* clipFunction,
                            int clipMethod);
 
@@ -0,0 +1,172 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRMLLogic includes
+#include "vtkMRMLSliceLayerLogic.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+#include "vtkMRMLGridTransformNode.h"
+#include "vtkMRMLScalarVolumeNode.h"
+#include "vtkMRMLScene.h"
+#include "vtkMRMLSliceNode.h"
+
+// VTK includes
+#include <vtkGeneralTransform.h>
+#include <vtkGridTransform.h>
+#include <vtkImageData.h>
+#include <vtkImageReslice.h>
+#include <vtkMath.h>
+#include <vtkNew.h>
+#include <vtkOrientedGridTransform.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Returns the maximum distance between the exact and the actual reslice transform
+// at pixels of the slice.
+double GetMaximumResliceTransformError(vtkMRMLSliceLayerLogic* logic, const int dimensions[3])
+{
+  vtkAbstractTransform* resliceTransform = logic->GetReslice()->GetResliceTransform();
+  double maximumError = 0.0;
+  for (int j = 0; j < dimensions[1]; j += 7)
+  {
+    for (int i = 0; i < dimensions[0]; i += 5)
+    {
+      double xy[3] = { static_cast<double>(i), static_cast<double>(j), 0.0 };
+      double exactIjk[3] = { 0.0, 0.0, 0.0 };
+      double ijk[3] = { 0.0, 0.0, 0.0 };
+      logic->GetXYToIJKTransform()->TransformPoint(xy, exactIjk);
+      resliceTransform->TransformPoint(xy, ijk);
+      maximumError = std::max(maximumError, sqrt(vtkMath::Distance2BetweenPoints(exactIjk, ijk)));
+    }
+  }
+  return maximumError;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLSliceLayerLogicNonLinearTransformTest(int , char * [] )
+{
+  vtkNew<vtkMRMLScene> scene;
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(64, 64, 64);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  vtkMRMLScalarVolumeNode* volumeNode = vtkMRMLScalarVolumeNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLScalarVolumeNode"));
+  volumeNode->SetAndObserveImageData(imageData);
+  volumeNode->SetOrigin(-32.0, -32.0, -32.0);
+
+  // Smooth displacement field
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetOrigin(-100.0, -100.0, -100.0);
+  displacementGrid->SetSpacing(20.0, 20.0, 20.0);
+  displacementGrid->SetDimensions(11, 11, 11);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacements = static_cast<double*>(displacementGrid->GetScalarPointer());
+  for (vtkIdType pointIndex = 0; pointIndex < displacementGrid->GetNumberOfPoints(); ++pointIndex)
+  {
+    double point[3] = { 0.0, 0.0, 0.0 };
+    displacementGrid->GetPoint(pointIndex, point);
+    displacements[pointIndex * 3 + 0] = 5.0 * sin(point[1] / 30.0);
+    displacements[pointIndex * 3 + 1] = 3.0 * cos(point[0] / 40.0);
+    displacements[pointIndex * 3 + 2] = 0.0;
+  }
+  vtkNew<vtkOrientedGridTransform> gridTransform;
+  gridTransform->SetDisplacementGridData(displacementGrid);
+  gridTransform->SetInterpolationModeToCubic();
+  vtkMRMLGridTransformNode* transformNode = vtkMRMLGridTransformNode::SafeDownCast(
+    scene->AddNewNodeByClass("vtkMRMLGridTransformNode"));
+  transformNode->SetAndObserveTransformFromParent(gridTransform);
+  volumeNode->SetAndObserveTransformNodeID(transformNode->GetID());
+
+  vtkMRMLSliceNode* sliceNode = vtkMRMLSliceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSliceNode"));
+  sliceNode->SetDimensions(256, 256, 1);
+  sliceNode->SetFieldOfView(128.0, 128.0, 1.0);
+  sliceNode->UpdateMatrices();
+  const int* dimensions = sliceNode->GetDimensions();
+
+  vtkNew<vtkMRMLSliceLayerLogic> logic;
+  CHECK_BOOL(logic->GetNonLinearTransformSampling(), true);
+  logic->SetMRMLScene(scene);
+  logic->SetSliceNode(sliceNode);
+  logic->SetVolumeNode(volumeNode);
+  logic->UpdateTransforms();
+
+  // Non-linear reslice transform is sampled on a grid
+  vtkAbstractTransform* sampledTransform = logic->GetReslice()->GetResliceTransform();
+  CHECK_NOT_NULL(vtkGridTransform::SafeDownCast(sampledTransform));
+  CHECK_BOOL(logic->GetNonLinearTransformSamplingSpacing() > 0, true);
+  double error = GetMaximumResliceTransformError(logic, dimensions);
+  std::cout << "Sampling spacing: " << logic->GetNonLinearTransformSamplingSpacing()
+            << " pixels, maximum error: " << error << " voxels" << std::endl;
+  CHECK_BOOL(error <= logic->GetNonLinearTransformSamplingTolerance(), true);
+
+  // Sampled transform is reused if nothing has changed
+  logic->UpdateTransforms();
+  CHECK_POINTER(logic->GetReslice()->GetResliceTransform(), sampledTransform);
+
+  // Sampled transform is updated if the transform is modified
+  gridTransform->SetDisplacementScale(2.0);
+  logic->UpdateTransforms();
+  CHECK_POINTER_DIFFERENT(logic->GetReslice()->GetResliceTransform(), sampledTransform);
+  CHECK_BOOL(GetMaximumResliceTransformError(logic, dimensions)
+    <= logic->GetNonLinearTransformSamplingTolerance(), true);
+
+  // Smaller tolerance requires denser sampling
+  int spacing = logic->GetNonLinearTransformSamplingSpacing();
+  logic->SetNonLinearTransformSamplingTolerance(0.01);
+  logic->UpdateTransforms();
+  CHECK_BOOL(logic->GetNonLinearTransformSamplingSpacing() <= spacing, true);
+
+  // Exact transform is used if the tolerance cannot be met
+  logic->SetNonLinearTransformSamplingTolerance(1e-9);
+  TESTING_OUTPUT_ASSERT_WARNINGS_BEGIN();
+  logic->UpdateTransforms();
+  TESTING_OUTPUT_ASSERT_WARNINGS(1);
+  CHECK_POINTER(logic->GetReslice()->GetResliceTransform(), logic->GetXYToIJKTransform());
+  CHECK_INT(logic->GetNonLinearTransformSamplingSpacing(), 0);
+  CHECK_DOUBLE(GetMaximumResliceTransformError(logic, dimensions), 0.0);
+
+  // Warning is not repeated if only the slice geometry changes
+  sliceNode->SetSliceOffset(5.0);
+  logic->UpdateTransforms();
+  TESTING_OUTPUT_ASSERT_WARNINGS(1);
+  TESTING_OUTPUT_ASSERT_WARNINGS_END();
+  CHECK_POINTER(logic->GetReslice()->GetResliceTransform(), logic->GetXYToIJKTransform());
+  logic->SetNonLinearTransformSamplingTolerance(0.1);
+
+  // Exact transform is used if sampling is disabled
+  logic->NonLinearTransformSamplingOff();
+  logic->UpdateTransforms();
+  CHECK_POINTER(logic->GetReslice()->GetResliceTransform(), logic->GetXYToIJKTransform());
+  CHECK_INT(logic->GetNonLinearTransformSamplingSpacing(), 0);
+
+  // Linear transforms are not sampled
+  logic->NonLinearTransformSamplingOn();
+  volumeNode->SetAndObserveTransformNodeID(nullptr);
+  logic->UpdateTransforms();
+  CHECK_NULL(vtkGridTransform::SafeDownCast(logic->GetReslice()->GetResliceTransform()));
+  CHECK_INT(logic->GetNonLinearTransformSamplingSpacing(), 0);
+
+  return EXIT_SUCCESS;
+}
@@ -32,14 +32,18 @@
 #include <vtkDiffusionTensorMathematics.h>
 #include <vtkFloatArray.h>
 #include <vtkGeneralTransform.h>
+#include <vtkGridTransform.h>
 #include <vtkImageData.h>
 #include <vtkImageReslice.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkMath.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkTrivialProducer.h>
 #include <vtkTransform.h>
 #include <vtkVersion.h>
@@ -50,6 +54,8 @@
 
 // STD includes
 #include <algorithm>
+#include <array>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkMRMLSliceLayerLogic);
@@ -100,9 +106,278 @@ void SnapToPermuteMatrix(vtkTransform* transform)
   }
 }
 
+//----------------------------------------------------------------------------
+class vtkMRMLSliceLayerLogic::vtkInternal
+{
+public:
+  /// Modification state of the parent transform chain of the volume
+  struct TransformKey
+  {
+    std::vector<vtkAbstractTransform*> Transforms;
+    std::vector<vtkMTimeType> TransformMTimes;
+
+    bool operator==(const TransformKey& other) const
+    {
+      return this->Transforms == other.Transforms && this->TransformMTimes == other.TransformMTimes;
+    }
+    bool operator!=(const TransformKey& other) const
+    {
+      return !(*this == other);
+    }
+  };
+
+  /// Everything that a sampled reslice transform is computed from
+  struct SampledTransformKey
+  {
+    TransformKey Transform;
+    std::array<double, 16> RASToIJK{};
+    /// XY to IJK or UVW to IJK matrix
+    std::array<double, 16> SliceToIJK{};
+    std::array<int, 3> Dimensions{};
+    double Tolerance{ 0.0 };
+
+    bool operator==(const SampledTransformKey& other) const
+    {
+      return this->Transform == other.Transform
+        && this->RASToIJK == other.RASToIJK
+        && this->SliceToIJK == other.SliceToIJK
+        && this->Dimensions == other.Dimensions
+        && this->Tolerance == other.Tolerance;
+    }
+  };
+
+  /// Non-linear reslice transform sampled on a regular grid
+  struct SampledTransform
+  {
+    /// nullptr if the exact transform has to be used because the tolerance cannot be met
+    vtkSmartPointer<vtkGridTransform> Transform;
+    /// Slice geometry and transform modification times that the grid was computed from
+    SampledTransformKey Key;
+    bool KeyValid{ false };
+    /// 0 if the exact transform is used
+    int Spacing{ 0 };
+  };
+
+  /// Get reslice transform that approximates exactTransform by interpolating a displacement grid.
+  /// The grid is only recomputed if the key is different from the key of the cached grid.
+  /// The search for the sampling spacing starts at the spacing of the cached grid.
+  /// If the tolerance cannot be met even with the minimum sampling spacing then a warning
+  /// is logged (once for each transform key) and exactTransform is returned.
+  vtkAbstractTransform* GetSampledTransform(vtkMRMLSliceLayerLogic* self, SampledTransform& sampledTransform,
+    vtkAbstractTransform* exactTransform, const SampledTransformKey& key);
+
+  /// Returns a grid transform that samples exactTransform at the specified spacing (in pixels)
+  /// and stores the maximum sampling error in error.
+  static vtkSmartPointer<vtkGridTransform> CreateSampledTransform(vtkAbstractTransform* exactTransform,
+    const int dimensions[3], int spacing, double& error);
+
+  /// Fill displacement field of gridTransform with the difference between transformed and original
+  /// positions of grid points (spacing is specified in pixels) that cover the output extent.
+  static void SampleTransform(vtkAbstractTransform* exactTransform, const int dimensions[3], int spacing,
+    vtkGridTransform* gridTransform);
+
+  /// Returns maximum distance between exact and sampled transform at the center of grid cells.
+  static double GetMaximumSamplingError(vtkAbstractTransform* exactTransform, vtkGridTransform* gridTransform,
+    const int dimensions[3], int spacing);
+
+  SampledTransform XYToIJKSampledTransform;
+  SampledTransform UVWToIJKSampledTransform;
+  /// Transform key that the last "tolerance cannot be met" warning was logged for
+  TransformKey WarnedTransformKey;
+
+  /// Minimum and maximum spacing of the sampling grid, in pixels
+  static const int MinimumSamplingSpacing = 2;
+  static const int MaximumSamplingSpacing = 64;
+};
+
+//----------------------------------------------------------------------------
+void vtkMRMLSliceLayerLogic::vtkInternal::SampleTransform(vtkAbstractTransform* exactTransform,
+  const int dimensions[3], int spacing, vtkGridTransform* gridTransform)
+{
+  // Use at least two grid points along each axis so that interpolation is defined
+  // in the entire output extent.
+  int gridDimensions[3] = { 2, 2, 2 };
+  double gridSpacing[3] = { 1.0, 1.0, 1.0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (dimensions[axis] > 1)
+    {
+      gridDimensions[axis] = (dimensions[axis] - 1 + spacing - 1) / spacing + 1;
+      gridSpacing[axis] = spacing;
+    }
+  }
+  vtkNew<vtkImageData> displacementGrid;
+  displacementGrid->SetOrigin(0.0, 0.0, 0.0);
+  displacementGrid->SetSpacing(gridSpacing);
+  displacementGrid->SetDimensions(gridDimensions);
+  displacementGrid->AllocateScalars(VTK_DOUBLE, 3);
+  double* displacements = static_cast<double*>(displacementGrid->GetScalarPointer());
+
+  // Evaluation of the transform is thread-safe after it is updated
+  exactTransform->Update();
+  const vtkIdType numberOfPoints = static_cast<vtkIdType>(gridDimensions[0]) * gridDimensions[1] * gridDimensions[2];
+  vtkSMPTools::For(0, numberOfPoints, 64, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType pointIndex = begin; pointIndex < end; ++pointIndex)
+    {
+      const double point[3] =
+      {
+        (pointIndex % gridDimensions[0]) * gridSpacing[0],
+        ((pointIndex / gridDimensions[0]) % gridDimensions[1]) * gridSpacing[1],
+        (pointIndex / (static_cast<vtkIdType>(gridDimensions[0]) * gridDimensions[1])) * gridSpacing[2]
+      };
+      double transformedPoint[3] = { 0.0, 0.0, 0.0 };
+      exactTransform->InternalTransformPoint(point, transformedPoint);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        displacements[pointIndex * 3 + axis] = transformedPoint[axis] - point[axis];
+      }
+    }
+  });
+
+  gridTransform->SetDisplacementGridData(displacementGrid);
+  gridTransform->SetInterpolationModeToLinear();
+  gridTransform->SetDisplacementScale(1.0);
+  gridTransform->SetDisplacementShift(0.0);
+  gridTransform->Update();
+}
+
+//----------------------------------------------------------------------------
+double vtkMRMLSliceLayerLogic::vtkInternal::GetMaximumSamplingError(vtkAbstractTransform* exactTransform,
+  vtkGridTransform* gridTransform, const int dimensions[3], int spacing)
+{
+  // Linear interpolation error is largest far from the grid points, therefore check cell centers
+  int numberOfCells[3] = { 1, 1, 1 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (dimensions[axis] > 1)
+    {
+      numberOfCells[axis] = (dimensions[axis] - 1 + spacing - 1) / spacing;
+    }
+  }
+  const vtkIdType numberOfCellsTotal = static_cast<vtkIdType>(numberOfCells[0]) * numberOfCells[1] * numberOfCells[2];
+  vtkSMPThreadLocal<double> maximumErrors(0.0);
+  vtkSMPTools::For(0, numberOfCellsTotal, 64, [&](vtkIdType begin, vtkIdType end)
+  {
+    double& maximumError = maximumErrors.Local();
+    for (vtkIdType cellIndex = begin; cellIndex < end; ++cellIndex)
+    {
+      const vtkIdType cellIjk[3] =
+      {
+        cellIndex % numberOfCells[0],
+        (cellIndex / numberOfCells[0]) % numberOfCells[1],
+        cellIndex / (static_cast<vtkIdType>(numberOfCells[0]) * numberOfCells[1])
+      };
+      double point[3] = { 0.0, 0.0, 0.0 };
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        // Cell center, but within the output extent
+        point[axis] = dimensions[axis] > 1
+          ? std::min((cellIjk[axis] + 0.5) * spacing, static_cast<double>(dimensions[axis] - 1))
+          : 0.0;
+      }
+      double exactPoint[3] = { 0.0, 0.0, 0.0 };
+      double sampledPoint[3] = { 0.0, 0.0, 0.0 };
+      exactTransform->InternalTransformPoint(point, exactPoint);
+      gridTransform->InternalTransformPoint(point, sampledPoint);
+      maximumError = std::max(maximumError, sqrt(vtkMath::Distance2BetweenPoints(exactPoint, sampledPoint)));
+    }
+  });
+  double maximumError = 0.0;
+  for (double threadMaximumError : maximumErrors)
+  {
+    maximumError = std::max(maximumError, threadMaximumError);
+  }
+  return maximumError;
+}
+
+//----------------------------------------------------------------------------
+vtkSmartPointer<vtkGridTransform> vtkMRMLSliceLayerLogic::vtkInternal::CreateSampledTransform(
+  vtkAbstractTransform* exactTransform, const int dimensions[3], int spacing, double& error)
+{
+  vtkSmartPointer<vtkGridTransform> gridTransform = vtkSmartPointer<vtkGridTransform>::New();
+  vtkInternal::SampleTransform(exactTransform, dimensions, spacing, gridTransform);
+  error = vtkInternal::GetMaximumSamplingError(exactTransform, gridTransform, dimensions, spacing);
+  return gridTransform;
+}
+
+//----------------------------------------------------------------------------
+vtkAbstractTransform* vtkMRMLSliceLayerLogic::vtkInternal::GetSampledTransform(vtkMRMLSliceLayerLogic* self,
+  SampledTransform& sampledTransform, vtkAbstractTransform* exactTransform, const SampledTransformKey& key)
+{
+  if (sampledTransform.KeyValid && sampledTransform.Key == key)
+  {
+    // Transform and slice geometry has not changed, reuse the sampled transform
+    return sampledTransform.Transform ? sampledTransform.Transform.GetPointer() : exactTransform;
+  }
+
+  // Transforms are typically modified in small steps (e.g., during interactive editing),
+  // so the previous spacing is likely to meet the tolerance again. Starting from there
+  // avoids sampling the transform at all the coarser levels on each update.
+  int startSpacing = vtkInternal::MaximumSamplingSpacing;
+  if (sampledTransform.KeyValid)
+  {
+    startSpacing = (sampledTransform.Spacing > 0 ? sampledTransform.Spacing : vtkInternal::MinimumSamplingSpacing);
+  }
+  sampledTransform.Key = key;
+  sampledTransform.KeyValid = true;
+  sampledTransform.Transform = nullptr;
+  sampledTransform.Spacing = 0;
+
+  const int* dimensions = key.Dimensions.data();
+  double error = 0.0;
+  for (int spacing = startSpacing; spacing >= vtkInternal::MinimumSamplingSpacing; spacing /= 2)
+  {
+    vtkSmartPointer<vtkGridTransform> gridTransform =
+      vtkInternal::CreateSampledTransform(exactTransform, dimensions, spacing, error);
+    if (error <= key.Tolerance)
+    {
+      sampledTransform.Transform = gridTransform;
+      sampledTransform.Spacing = spacing;
+      break;
+    }
+  }
+  if (sampledTransform.Spacing == startSpacing)
+  {
+    // The tolerance is met at the start spacing, check if a coarser grid would be sufficient, too.
+    // Coarser grids have fewer points, so this costs less than sampling at the start spacing.
+    for (int spacing = startSpacing * 2; spacing <= vtkInternal::MaximumSamplingSpacing; spacing *= 2)
+    {
+      double coarseError = 0.0;
+      vtkSmartPointer<vtkGridTransform> gridTransform =
+        vtkInternal::CreateSampledTransform(exactTransform, dimensions, spacing, coarseError);
+      if (coarseError > key.Tolerance)
+      {
+        break;
+      }
+      sampledTransform.Transform = gridTransform;
+      sampledTransform.Spacing = spacing;
+    }
+  }
+  if (sampledTransform.Transform)
+  {
+    return sampledTransform.Transform;
+  }
+
+  if (key.Transform != this->WarnedTransformKey)
+  {
+    // Only warn once for each transform, as the slice geometry may change on every mouse move
+    this->WarnedTransformKey = key.Transform;
+    vtkWarningWithObjectMacro(self, "GetSampledTransform: sampling error of the non-linear reslice transform is "
+      << error << " voxels at " << vtkInternal::MinimumSamplingSpacing << " pixel spacing, which exceeds tolerance of "
+      << key.Tolerance << " voxels. The exact transform is used.");
+  }
+  return exactTransform;
+}
+
 //----------------------------------------------------------------------------
 vtkMRMLSliceLayerLogic::vtkMRMLSliceLayerLogic()
 {
+  this->Internal = new vtkInternal;
+  this->NonLinearTransformSampling = true;
+  this->NonLinearTransformSamplingTolerance = 0.1;
+  this->NonLinearTransformSamplingSpacing = 0;
+
   this->VolumeNode = nullptr;
   this->VolumeDisplayNode = nullptr;
   this->VolumeDisplayNodeUVW = nullptr;
@@ -197,6 +472,7 @@ vtkMRMLSliceLayerLogic::~vtkMRMLSliceLayerLogic()
     this->VolumeDisplayNodeUVW->Delete();
   }
 
+  delete this->Internal;
 }
 
 //---------------------------------------------------------------------------
@@ -504,6 +780,8 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
   this->XYToIJKTransform->PostMultiply();
   this->UVWToIJKTransform->PostMultiply();
 
+  this->NonLinearTransformSamplingSpacing = 0;
+
   if (this->SliceNode)
   {
     this->SliceNode->GetDimensions(dimensions);
@@ -520,6 +798,16 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
   {
     // Apply the transform, if it exists
     vtkMRMLTransformNode *transformNode = this->VolumeNode->GetParentTransformNode();
+    // Modification state of the transform chain, used for detecting if sampled reslice transforms are still valid.
+    // Modification times are unique across all VTK objects, so a deleted transform that is replaced by a new one
+    // at the same address cannot be mistaken for the old one.
+    vtkInternal::TransformKey transformKey;
+    for (vtkMRMLTransformNode* node = transformNode; node != nullptr; node = node->GetParentTransformNode())
+    {
+      vtkAbstractTransform* transformFromParent = node->GetTransformFromParent();
+      transformKey.Transforms.push_back(transformFromParent);
+      transformKey.TransformMTimes.push_back(transformFromParent ? transformFromParent->GetMTime() : 0);
+    }
     if ( transformNode != nullptr )
     {
       vtkNew<vtkGeneralTransform> worldTransform;
@@ -536,6 +824,10 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
 
     this->XYToIJKTransform->Concatenate(rasToIJK.GetPointer());
     this->UVWToIJKTransform->Concatenate(rasToIJK.GetPointer());
+    vtkInternal::SampledTransformKey sampledTransformKey;
+    sampledTransformKey.Transform = transformKey;
+    std::copy(&rasToIJK->Element[0][0], &rasToIJK->Element[0][0] + 16, sampledTransformKey.RASToIJK.begin());
+    sampledTransformKey.Tolerance = this->NonLinearTransformSamplingTolerance;
 
     // vtkImageReslice works faster if the input is a linear transform, so try to convert it
     // to a linear transform.
@@ -546,6 +838,15 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
       SnapToPermuteMatrix(linearXYToIJKTransform);
       this->Reslice->SetResliceTransform(linearXYToIJKTransform);
     }
+    else if (this->NonLinearTransformSampling)
+    {
+      vtkInternal::SampledTransformKey key = sampledTransformKey;
+      std::copy(&xyToIJK->Element[0][0], &xyToIJK->Element[0][0] + 16, key.SliceToIJK.begin());
+      std::copy(dimensions, dimensions + 3, key.Dimensions.begin());
+      this->Reslice->SetResliceTransform(this->Internal->GetSampledTransform(this, this->Internal->XYToIJKSampledTransform,
+        this->XYToIJKTransform, key));
+      this->NonLinearTransformSamplingSpacing = this->Internal->XYToIJKSampledTransform.Spacing;
+    }
     else
     {
       this->Reslice->SetResliceTransform(this->XYToIJKTransform);
@@ -556,6 +857,14 @@ void vtkMRMLSliceLayerLogic::UpdateTransforms()
       SnapToPermuteMatrix(linearUVWToIJKTransform);
       this->ResliceUVW->SetResliceTransform( linearUVWToIJKTransform );
     }
+    else if (this->NonLinearTransformSampling)
+    {
+      vtkInternal::SampledTransformKey key = sampledTransformKey;
+      std::copy(&uvwToIJK->Element[0][0], &uvwToIJK->Element[0][0] + 16, key.SliceToIJK.begin());
+      std::copy(dimensionsUVW, dimensionsUVW + 3, key.Dimensions.begin());
+      this->ResliceUVW->SetResliceTransform(this->Internal->GetSampledTransform(this, this->Internal->UVWToIJKSampledTransform,
+        this->UVWToIJKTransform, key));
+    }
     else
     {
       this->ResliceUVW->SetResliceTransform( this->UVWToIJKTransform );
@@ -931,6 +1240,9 @@ void vtkMRMLSliceLayerLogic::PrintSelf(ostream& os, vtkIndent indent)
   nextIndent = indent.GetNextIndent();
 
   os << indent << "SlicerSliceLayerLogic:             " << this->GetClassName() << "\n";
+  os << indent << "NonLinearTransformSampling: " << (this->NonLinearTransformSampling ? "true" : "false") << "\n";
+  os << indent << "NonLinearTransformSamplingTolerance: " << this->NonLinearTransformSamplingTolerance << "\n";
+  os << indent << "NonLinearTransformSamplingSpacing: " << this->NonLinearTransformSamplingSpacing << "\n";
 
   if (this->VolumeNode)
   {
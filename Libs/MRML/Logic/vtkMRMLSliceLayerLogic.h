@@ -135,6 +135,32 @@ public:
   vtkGetMacro(InterpolationMode, int);
   vtkSetMacro(InterpolationMode, int);
 
+  ///
+  /// Enable sampling of non-linear reslice transforms on a grid over the slice.
+  /// If enabled and the volume is transformed by a non-linear (grid, b-spline, thin-plate spline)
+  /// transform then the full transform chain is only evaluated at the points of a coarse grid
+  /// and the reslice transform is interpolated in between. This makes reslicing much faster,
+  /// because inverse of grid transforms is computed by an iterative method at each point.
+  /// The grid is reused as long as the slice geometry and the transforms are not modified.
+  /// Enabled by default. UpdateTransforms() must be called after changing this value.
+  vtkGetMacro(NonLinearTransformSampling, bool);
+  vtkSetMacro(NonLinearTransformSampling, bool);
+  vtkBooleanMacro(NonLinearTransformSampling, bool);
+
+  ///
+  /// Maximum difference (in voxels) between the sampled and the exact reslice transform.
+  /// The sampling grid is refined until the difference measured at the center of grid cells
+  /// is below this value. The search starts at the spacing that was used in the previous update.
+  /// If the tolerance cannot be met even with the densest sampling grid then the exact transform
+  /// is used and a warning is logged (once for each transform state). Default is 0.1 voxel.
+  vtkGetMacro(NonLinearTransformSamplingTolerance, double);
+  vtkSetMacro(NonLinearTransformSamplingTolerance, double);
+
+  ///
+  /// Spacing (in pixels) of the grid that was used for sampling the non-linear XYToIJK transform
+  /// in the last UpdateTransforms() call. 0 if the reslice transform was not sampled.
+  vtkGetMacro(NonLinearTransformSamplingSpacing, int);
+
 protected:
   vtkMRMLSliceLayerLogic();
   ~vtkMRMLSliceLayerLogic() override;
@@ -189,6 +215,13 @@ protected:
   int UpdatingTransforms;
 
   int InterpolationMode;
+
+  bool NonLinearTransformSampling;
+  double NonLinearTransformSamplingTolerance;
+  int NonLinearTransformSamplingSpacing;
+
+  class vtkInternal;
+  vtkInternal* Internal;
 };
 
 #endif
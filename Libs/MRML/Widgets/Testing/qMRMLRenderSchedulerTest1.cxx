@@ -0,0 +1,144 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QVariantMap>
+
+// qMRML includes
+#include "qMRMLRenderScheduler.h"
+#include "qMRMLSliceView.h"
+#include "qMRMLThreeDView.h"
+#include "qMRMLWidget.h"
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <iostream>
+
+namespace
+{
+
+//------------------------------------------------------------------------------
+void ProcessEventsUntilRendered(qMRMLRenderScheduler* scheduler, int timeoutMs = 2000)
+{
+  QElapsedTimer timer;
+  timer.start();
+  while (scheduler->numberOfPendingViews() > 0 && timer.elapsed() < timeoutMs)
+  {
+    QApplication::processEvents();
+  }
+}
+
+//------------------------------------------------------------------------------
+int RenderCount(qMRMLRenderScheduler* scheduler, const QString& viewName)
+{
+  return scheduler->renderStatistics()[viewName].toMap()["renderCount"].toInt();
+}
+
+} // end of anonymous namespace
+
+//------------------------------------------------------------------------------
+int qMRMLRenderSchedulerTest1(int argc, char * argv [] )
+{
+  qMRMLWidget::preInitializeApplication();
+  QApplication app(argc, argv);
+  qMRMLWidget::postInitializeApplication();
+
+  qMRMLRenderScheduler scheduler;
+  qMRMLThreeDView threeDView;
+  qMRMLSliceView sliceView;
+  threeDView.show();
+  sliceView.show();
+
+  // Scheduler is disabled by default
+  CHECK_BOOL(scheduler.isEnabled(), false);
+  CHECK_INT(scheduler.targetFrameTime(), 16);
+  scheduler.setEnabled(true);
+
+  // Views that are not registered are rendered by themselves
+  CHECK_BOOL(scheduler.requestRender(&threeDView), false);
+
+  scheduler.registerView(&threeDView, "1");
+  scheduler.registerView(&sliceView, "Red");
+  threeDView.setRenderScheduler(&scheduler);
+  sliceView.setRenderScheduler(&scheduler);
+  CHECK_BOOL(threeDView.renderScheduler() == &scheduler, true);
+  CHECK_BOOL(scheduler.viewNames() == (QStringList() << "1" << "Red"), true);
+  // Wait for initial render requests of the views
+  ProcessEventsUntilRendered(&scheduler);
+  scheduler.resetRenderStatistics();
+
+  // Repeated render requests are coalesced into a single render
+  for (int i = 0; i < 10; ++i)
+  {
+    threeDView.scheduleRender();
+    sliceView.scheduleRender();
+  }
+  CHECK_INT(scheduler.numberOfPendingViews(), 2);
+  ProcessEventsUntilRendered(&scheduler);
+  CHECK_INT(scheduler.numberOfPendingViews(), 0);
+  CHECK_INT(RenderCount(&scheduler, "1"), 1);
+  CHECK_INT(RenderCount(&scheduler, "Red"), 1);
+  QVariantMap threeDViewStatistics = scheduler.renderStatistics()["1"].toMap();
+  CHECK_BOOL(threeDViewStatistics["averageRenderTime"].toDouble() >= 0.0, true);
+  CHECK_BOOL(threeDViewStatistics["maximumRenderTime"].toDouble()
+    >= threeDViewStatistics["lastRenderTime"].toDouble(), true);
+
+  // Requests are kept while rendering is paused
+  scheduler.setRenderPaused(true);
+  sliceView.scheduleRender();
+  QApplication::processEvents();
+  CHECK_INT(scheduler.numberOfPendingViews(), 1);
+  CHECK_INT(RenderCount(&scheduler, "Red"), 1);
+  scheduler.setRenderPaused(false);
+  ProcessEventsUntilRendered(&scheduler);
+  CHECK_INT(RenderCount(&scheduler, "Red"), 2);
+
+  // Disabled scheduler does not handle render requests
+  scheduler.setEnabled(false);
+  CHECK_BOOL(scheduler.requestRender(&sliceView), false);
+  scheduler.setEnabled(true);
+
+  // Unregistered view renders by itself
+  scheduler.unregisterView(&sliceView);
+  CHECK_BOOL(scheduler.isViewRegistered(&sliceView), false);
+  CHECK_BOOL(scheduler.requestRender(&sliceView), false);
+  CHECK_BOOL(scheduler.viewNames() == (QStringList() << "1"), true);
+
+  // Setting the scheduler in a view registers the view
+  sliceView.setObjectName("Green");
+  sliceView.setRenderScheduler(nullptr);
+  sliceView.setRenderScheduler(&scheduler);
+  CHECK_BOOL(scheduler.isViewRegistered(&sliceView), true);
+  CHECK_BOOL(scheduler.viewNames() == (QStringList() << "1" << "Green"), true);
+  sliceView.setRenderScheduler(nullptr);
+  CHECK_BOOL(scheduler.isViewRegistered(&sliceView), false);
+
+  // Deleted views are removed automatically
+  qMRMLThreeDView* deletedView = new qMRMLThreeDView;
+  scheduler.registerView(deletedView, "2");
+  CHECK_INT(scheduler.viewNames().size(), 2);
+  delete deletedView;
+  CHECK_INT(scheduler.viewNames().size(), 1);
+
+  if (argc < 2 || QString(argv[1]) != "-I")
+  {
+    return EXIT_SUCCESS;
+  }
+  return app.exec();
+}
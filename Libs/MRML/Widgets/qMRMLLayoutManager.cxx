@@ -36,6 +36,7 @@
 #include <qMRMLTableWidget.h>
 #include <qMRMLPlotView.h>
 #include <qMRMLPlotWidget.h>
+#include <qMRMLRenderScheduler.h>
 #include <qMRMLThreeDView.h>
 #include <qMRMLThreeDWidget.h>
 
@@ -107,6 +108,11 @@ QWidget* qMRMLLayoutThreeDViewFactory::createViewFromNode(vtkMRMLAbstractViewNod
 
   this->viewLogics()->AddItem(threeDWidget->viewLogic());
 
+  if (this->layoutManager()->isRenderSchedulingEnabled())
+  {
+    threeDWidget->threeDView()->setRenderScheduler(this->layoutManager()->renderScheduler());
+  }
+
   return threeDWidget;
 }
 
@@ -267,6 +273,11 @@ QWidget* qMRMLLayoutSliceViewFactory::createViewFromNode(vtkMRMLAbstractViewNode
   sliceWidget->setMRMLSliceNode(vtkMRMLSliceNode::SafeDownCast(viewNode));
   sliceWidget->setMRMLScene(this->mrmlScene());
 
+  if (this->layoutManager()->isRenderSchedulingEnabled())
+  {
+    sliceWidget->sliceView()->setRenderScheduler(this->layoutManager()->renderScheduler());
+  }
+
   return sliceWidget;
 }
 
@@ -314,6 +325,8 @@ void qMRMLLayoutManagerPrivate::init()
 
   q->setSpacing(1);
 
+  this->RenderScheduler = new qMRMLRenderScheduler(q);
+
   qMRMLLayoutThreeDViewFactory* threeDViewFactory =
     new qMRMLLayoutThreeDViewFactory;
   q->registerViewFactory(threeDViewFactory);
@@ -1252,6 +1265,7 @@ void qMRMLLayoutManager::setRenderPaused(bool pause)
   if (pause)
   {
     d->AllViewsPauseRenderCount++;
+    d->RenderScheduler->setRenderPaused(true);
   }
   else
   {
@@ -1261,6 +1275,10 @@ void qMRMLLayoutManager::setRenderPaused(bool pause)
       qWarning() << Q_FUNC_INFO << "Cannot resume rendering on all views, pause render count is already 0";
       d->AllViewsPauseRenderCount = 0;
     }
+    else
+    {
+      d->RenderScheduler->setRenderPaused(false);
+    }
   }
 }
 
@@ -1283,6 +1301,57 @@ int qMRMLLayoutManager::allViewsPauseRenderCount()
   return d->AllViewsPauseRenderCount;
 }
 
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLLayoutManager::renderScheduler()const
+{
+  Q_D(const qMRMLLayoutManager);
+  return d->RenderScheduler;
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLLayoutManager::isRenderSchedulingEnabled()const
+{
+  Q_D(const qMRMLLayoutManager);
+  return d->RenderSchedulingEnabled;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLLayoutManager::setRenderSchedulingEnabled(bool enabled)
+{
+  Q_D(qMRMLLayoutManager);
+  if (d->RenderSchedulingEnabled == enabled)
+  {
+    return;
+  }
+  d->RenderSchedulingEnabled = enabled;
+  qMRMLRenderScheduler* renderScheduler = enabled ? d->RenderScheduler : nullptr;
+  // Disable the scheduler first so that pending render requests are passed back to the views
+  if (!enabled)
+  {
+    d->RenderScheduler->setEnabled(false);
+  }
+  foreach(const QString& sliceViewName, this->sliceViewNames())
+  {
+    qMRMLSliceWidget* sliceWidget = this->sliceWidget(sliceViewName);
+    if (sliceWidget)
+    {
+      sliceWidget->sliceView()->setRenderScheduler(renderScheduler);
+    }
+  }
+  for (int threeDViewIndex = 0; threeDViewIndex < this->threeDViewCount(); ++threeDViewIndex)
+  {
+    qMRMLThreeDWidget* threeDWidget = this->threeDWidget(threeDViewIndex);
+    if (threeDWidget)
+    {
+      threeDWidget->threeDView()->setRenderScheduler(renderScheduler);
+    }
+  }
+  if (enabled)
+  {
+    d->RenderScheduler->setEnabled(true);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void qMRMLLayoutManager::onViewportUsageChanged(const QString& viewportName)
 {
@@ -37,6 +37,7 @@ class qMRMLThreeDWidget;
 class qMRMLSliceWidget;
 class qMRMLLayoutManagerPrivate;
 class qMRMLLayoutViewFactory;
+class qMRMLRenderScheduler;
 
 class vtkMRMLAbstractViewNode;
 class vtkMRMLColorLogic;
@@ -86,6 +87,10 @@ class QMRML_WIDGETS_EXPORT qMRMLLayoutManager : public ctkLayoutFactory
   Q_PROPERTY(int threeDViewCount READ threeDViewCount DESIGNABLE false)
   Q_PROPERTY(int tableViewCount READ tableViewCount DESIGNABLE false)
   Q_PROPERTY(int plotViewCount READ plotViewCount DESIGNABLE false)
+  /// If enabled then rendering of the slice and 3D views is scheduled by renderScheduler().
+  /// Disabled by default, each view schedules its own rendering.
+  /// \sa isRenderSchedulingEnabled(), setRenderSchedulingEnabled(), renderScheduler()
+  Q_PROPERTY(bool renderSchedulingEnabled READ isRenderSchedulingEnabled WRITE setRenderSchedulingEnabled)
 
 public:
   /// Superclass typedef
@@ -214,11 +219,27 @@ public:
   /// \sa pauseRender(), resumeRender(), setRenderPaused()
   int allViewsPauseRenderCount();
 
+  /// Returns the scheduler that can render the slice and 3D views of the layout within a common frame time budget.
+  /// It can be used for changing scheduling parameters or getting render time statistics of the views.
+  /// The scheduler is only used by views if renderSchedulingEnabled is set or if it is set in a view
+  /// by qMRMLSliceView::setRenderScheduler() or qMRMLThreeDView::setRenderScheduler().
+  /// \sa qMRMLRenderScheduler, renderSchedulingEnabled
+  Q_INVOKABLE qMRMLRenderScheduler* renderScheduler()const;
+
+  /// Return the renderSchedulingEnabled property value.
+  /// \sa renderSchedulingEnabled
+  bool isRenderSchedulingEnabled()const;
+
 public slots:
   /// Set the enabled property value
   /// \sa enabled
   void setEnabled(bool enable);
 
+  /// Set the renderSchedulingEnabled property value.
+  /// The render scheduler is set in (or removed from) all existing and new slice and 3D views.
+  /// \sa renderSchedulingEnabled
+  void setRenderSchedulingEnabled(bool enabled);
+
   /// Set the MRML \a scene that should be listened for events
   /// \sa mrmlScene(), enabled
   void setMRMLScene(vtkMRMLScene* scene);
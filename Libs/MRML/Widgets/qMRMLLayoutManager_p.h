@@ -44,6 +44,7 @@
 #include "qMRMLWidgetsConfigure.h" // For MRML_WIDGETS_HAVE_WEBENGINE_SUPPORT
 #include "qMRMLLayoutManager.h"
 #include "qMRMLLayoutViewFactory.h"
+#include "qMRMLRenderScheduler.h"
 
 // MRMLLogic includes
 #include <vtkMRMLLayoutLogic.h>
@@ -156,6 +157,8 @@ public:
   /// (outside the main application window).
   QMap<QString, ViewportInfo>  DetachedViewports;
   int AllViewsPauseRenderCount{ 0 };
+  qMRMLRenderScheduler*   RenderScheduler{ nullptr };
+  bool RenderSchedulingEnabled{ false };
 };
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,491 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+#include <QWidget>
+
+// CTK includes
+#include <ctkPimpl.h>
+#include <ctkVTKAbstractView.h>
+
+// qMRML includes
+#include "qMRMLRenderScheduler.h"
+
+// STD includes
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+class qMRMLRenderSchedulerPrivate
+{
+  Q_DECLARE_PUBLIC(qMRMLRenderScheduler);
+protected:
+  qMRMLRenderScheduler* const q_ptr;
+
+public:
+  qMRMLRenderSchedulerPrivate(qMRMLRenderScheduler& object);
+
+  void init();
+
+  /// Start the frame timer so that the next frame starts TargetFrameTime after the previous one
+  void scheduleFrame();
+
+  /// Returns true if the event is a user input event that indicates interaction with a view
+  static bool isInteractionEvent(QEvent::Type type);
+
+  struct ViewInfo
+  {
+    QString Name;
+    bool RenderRequested{ false };
+    /// Time since the first render request that has not been fulfilled yet
+    QElapsedTimer RequestTimer;
+    int RenderCount{ 0 };
+    int DeferredCount{ 0 };
+    double LastRenderTime{ 0.0 };
+    double AverageRenderTime{ 0.0 };
+    double MaximumRenderTime{ 0.0 };
+  };
+
+  QHash<ctkVTKAbstractView*, ViewInfo> Views;
+  QPointer<ctkVTKAbstractView> InteractedView;
+  QElapsedTimer InteractionTimer;
+  /// Time since the start of the last frame
+  QElapsedTimer FrameTimer;
+  QTimer RenderTimer;
+
+  bool Enabled{ false };
+  int TargetFrameTime{ 16 };
+  int MaximumRenderDelay{ 250 };
+  int InteractionTimeout{ 200 };
+  int PauseRenderCount{ 0 };
+  /// Weight of the last render time in the average render time
+  double AverageRenderTimeWeight{ 0.2 };
+};
+
+//-----------------------------------------------------------------------------
+// qMRMLRenderSchedulerPrivate methods
+
+//-----------------------------------------------------------------------------
+qMRMLRenderSchedulerPrivate::qMRMLRenderSchedulerPrivate(qMRMLRenderScheduler& object)
+  : q_ptr(&object)
+{
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::init()
+{
+  Q_Q(qMRMLRenderScheduler);
+  this->RenderTimer.setSingleShot(true);
+  QObject::connect(&this->RenderTimer, SIGNAL(timeout()), q, SLOT(renderPendingViews()));
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderSchedulerPrivate::scheduleFrame()
+{
+  if (this->RenderTimer.isActive() || this->PauseRenderCount > 0)
+  {
+    return;
+  }
+  int delay = 0;
+  if (this->FrameTimer.isValid())
+  {
+    delay = std::max(0, this->TargetFrameTime - static_cast<int>(this->FrameTimer.elapsed()));
+  }
+  this->RenderTimer.start(delay);
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderSchedulerPrivate::isInteractionEvent(QEvent::Type type)
+{
+  switch (type)
+  {
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::MouseMove:
+    case QEvent::Wheel:
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::TouchBegin:
+    case QEvent::TouchUpdate:
+    case QEvent::TouchEnd:
+    case QEvent::Gesture:
+      return true;
+    default:
+      return false;
+  }
+}
+
+//-----------------------------------------------------------------------------
+// qMRMLRenderScheduler methods
+
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler::qMRMLRenderScheduler(QObject* parent)
+  : Superclass(parent)
+  , d_ptr(new qMRMLRenderSchedulerPrivate(*this))
+{
+  Q_D(qMRMLRenderScheduler);
+  d->init();
+}
+
+//-----------------------------------------------------------------------------
+qMRMLRenderScheduler::~qMRMLRenderScheduler() = default;
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::isEnabled()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->Enabled;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setEnabled(bool enabled)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (d->Enabled == enabled)
+  {
+    return;
+  }
+  d->Enabled = enabled;
+  if (!enabled)
+  {
+    // Render all pending requests now, as views will not send requests to the scheduler anymore
+    d->RenderTimer.stop();
+    for (auto it = d->Views.begin(); it != d->Views.end(); ++it)
+    {
+      if (it.value().RenderRequested)
+      {
+        it.value().RenderRequested = false;
+        it.key()->scheduleRender();
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+CTK_GET_CPP(qMRMLRenderScheduler, int, targetFrameTime, TargetFrameTime);
+CTK_SET_CPP(qMRMLRenderScheduler, int, setTargetFrameTime, TargetFrameTime);
+CTK_GET_CPP(qMRMLRenderScheduler, int, maximumRenderDelay, MaximumRenderDelay);
+CTK_SET_CPP(qMRMLRenderScheduler, int, setMaximumRenderDelay, MaximumRenderDelay);
+CTK_GET_CPP(qMRMLRenderScheduler, int, interactionTimeout, InteractionTimeout);
+CTK_SET_CPP(qMRMLRenderScheduler, int, setInteractionTimeout, InteractionTimeout);
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::registerView(ctkVTKAbstractView* view, const QString& name)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (!view)
+  {
+    qWarning() << Q_FUNC_INFO << "failed: invalid view";
+    return;
+  }
+  bool alreadyRegistered = d->Views.contains(view);
+  d->Views[view].Name = name;
+  if (alreadyRegistered)
+  {
+    return;
+  }
+  QObject::connect(view, SIGNAL(destroyed(QObject*)), this, SLOT(onViewDestroyed(QObject*)));
+  // Input events are received by the render window widget, which is a child of the view
+  view->installEventFilter(this);
+  for (QWidget* child : view->findChildren<QWidget*>())
+  {
+    child->installEventFilter(this);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::unregisterView(ctkVTKAbstractView* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  auto viewIt = d->Views.find(view);
+  if (viewIt == d->Views.end())
+  {
+    return;
+  }
+  bool renderRequested = viewIt.value().RenderRequested;
+  d->Views.erase(viewIt);
+  QObject::disconnect(view, SIGNAL(destroyed(QObject*)), this, SLOT(onViewDestroyed(QObject*)));
+  view->removeEventFilter(this);
+  for (QWidget* child : view->findChildren<QWidget*>())
+  {
+    child->removeEventFilter(this);
+  }
+  if (renderRequested)
+  {
+    // Do not lose the pending request
+    view->scheduleRender();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::onViewDestroyed(QObject* object)
+{
+  Q_D(qMRMLRenderScheduler);
+  // The view is already partially destroyed, so only its address is used
+  for (auto it = d->Views.begin(); it != d->Views.end(); ++it)
+  {
+    if (static_cast<QObject*>(it.key()) == object)
+    {
+      d->Views.erase(it);
+      break;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::isViewRegistered(ctkVTKAbstractView* view)const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->Views.contains(view);
+}
+
+//-----------------------------------------------------------------------------
+QStringList qMRMLRenderScheduler::viewNames()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  QStringList names;
+  for (const qMRMLRenderSchedulerPrivate::ViewInfo& viewInfo : d->Views)
+  {
+    names << viewInfo.Name;
+  }
+  names.sort();
+  return names;
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::requestRender(ctkVTKAbstractView* view)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (!d->Enabled)
+  {
+    return false;
+  }
+  auto viewIt = d->Views.find(view);
+  if (viewIt == d->Views.end())
+  {
+    return false;
+  }
+  qMRMLRenderSchedulerPrivate::ViewInfo& viewInfo = viewIt.value();
+  if (!viewInfo.RenderRequested)
+  {
+    viewInfo.RenderRequested = true;
+    viewInfo.RequestTimer.start();
+  }
+  d->scheduleFrame();
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+int qMRMLRenderScheduler::numberOfPendingViews()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  int numberOfPendingViews = 0;
+  for (const qMRMLRenderSchedulerPrivate::ViewInfo& viewInfo : d->Views)
+  {
+    if (viewInfo.RenderRequested)
+    {
+      numberOfPendingViews++;
+    }
+  }
+  return numberOfPendingViews;
+}
+
+//-----------------------------------------------------------------------------
+ctkVTKAbstractView* qMRMLRenderScheduler::interactedView()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->InteractedView.data();
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::isInteracting()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  return d->InteractedView && d->InteractionTimer.isValid()
+    && d->InteractionTimer.elapsed() < d->InteractionTimeout;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::setRenderPaused(bool pause)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (pause)
+  {
+    d->PauseRenderCount++;
+    d->RenderTimer.stop();
+    return;
+  }
+  if (d->PauseRenderCount <= 0)
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot resume rendering, pause render count is already 0";
+    return;
+  }
+  d->PauseRenderCount--;
+  if (d->PauseRenderCount == 0 && this->numberOfPendingViews() > 0)
+  {
+    d->scheduleFrame();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::renderPendingViews()
+{
+  Q_D(qMRMLRenderScheduler);
+  if (d->PauseRenderCount > 0)
+  {
+    return;
+  }
+  d->FrameTimer.start();
+
+  // Render the interacted view first, then the views that have been waiting the longest
+  ctkVTKAbstractView* interactedView = this->isInteracting() ? d->InteractedView.data() : nullptr;
+  QList<ctkVTKAbstractView*> pendingViews;
+  for (auto it = d->Views.begin(); it != d->Views.end(); ++it)
+  {
+    if (it.value().RenderRequested)
+    {
+      pendingViews << it.key();
+    }
+  }
+  std::sort(pendingViews.begin(), pendingViews.end(),
+    [d, interactedView](ctkVTKAbstractView* view1, ctkVTKAbstractView* view2)
+    {
+      if ((view1 == interactedView) != (view2 == interactedView))
+      {
+        return view1 == interactedView;
+      }
+      return d->Views[view1].RequestTimer.elapsed() > d->Views[view2].RequestTimer.elapsed();
+    });
+
+  bool renderDeferred = false;
+  for (ctkVTKAbstractView* view : pendingViews)
+  {
+    auto viewIt = d->Views.find(view);
+    if (viewIt == d->Views.end())
+    {
+      // view was unregistered while rendering another view
+      continue;
+    }
+    qMRMLRenderSchedulerPrivate::ViewInfo& viewInfo = viewIt.value();
+    if (interactedView && view != interactedView && viewInfo.RenderCount > 0)
+    {
+      // Defer expensive views during interaction if they do not fit into the remaining time of this frame
+      double remainingFrameTime = d->TargetFrameTime - static_cast<double>(d->FrameTimer.nsecsElapsed()) * 1e-6;
+      if (viewInfo.AverageRenderTime > remainingFrameTime
+        && viewInfo.RequestTimer.elapsed() < d->MaximumRenderDelay)
+      {
+        viewInfo.DeferredCount++;
+        renderDeferred = true;
+        continue;
+      }
+    }
+    viewInfo.RenderRequested = false;
+    if (view->isRenderPaused())
+    {
+      // Let the view keep the request until its rendering is resumed
+      view->ctkVTKAbstractView::scheduleRender();
+      continue;
+    }
+
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+    view->forceRender();
+    double renderTime = static_cast<double>(renderTimer.nsecsElapsed()) * 1e-6;
+
+    // The view may have been unregistered during rendering
+    viewIt = d->Views.find(view);
+    if (viewIt == d->Views.end())
+    {
+      continue;
+    }
+    qMRMLRenderSchedulerPrivate::ViewInfo& renderedViewInfo = viewIt.value();
+    renderedViewInfo.LastRenderTime = renderTime;
+    renderedViewInfo.MaximumRenderTime = std::max(renderedViewInfo.MaximumRenderTime, renderTime);
+    if (renderedViewInfo.RenderCount == 0)
+    {
+      renderedViewInfo.AverageRenderTime = renderTime;
+    }
+    else
+    {
+      renderedViewInfo.AverageRenderTime = d->AverageRenderTimeWeight * renderTime
+        + (1.0 - d->AverageRenderTimeWeight) * renderedViewInfo.AverageRenderTime;
+    }
+    renderedViewInfo.RenderCount++;
+  }
+
+  if (renderDeferred || this->numberOfPendingViews() > 0)
+  {
+    d->scheduleFrame();
+  }
+}
+
+//-----------------------------------------------------------------------------
+QVariantMap qMRMLRenderScheduler::renderStatistics()const
+{
+  Q_D(const qMRMLRenderScheduler);
+  QVariantMap statistics;
+  for (const qMRMLRenderSchedulerPrivate::ViewInfo& viewInfo : d->Views)
+  {
+    QVariantMap viewStatistics;
+    viewStatistics["renderCount"] = viewInfo.RenderCount;
+    viewStatistics["deferredCount"] = viewInfo.DeferredCount;
+    viewStatistics["lastRenderTime"] = viewInfo.LastRenderTime;
+    viewStatistics["averageRenderTime"] = viewInfo.AverageRenderTime;
+    viewStatistics["maximumRenderTime"] = viewInfo.MaximumRenderTime;
+    statistics[viewInfo.Name] = viewStatistics;
+  }
+  return statistics;
+}
+
+//-----------------------------------------------------------------------------
+void qMRMLRenderScheduler::resetRenderStatistics()
+{
+  Q_D(qMRMLRenderScheduler);
+  for (qMRMLRenderSchedulerPrivate::ViewInfo& viewInfo : d->Views)
+  {
+    viewInfo.RenderCount = 0;
+    viewInfo.DeferredCount = 0;
+    viewInfo.LastRenderTime = 0.0;
+    viewInfo.AverageRenderTime = 0.0;
+    viewInfo.MaximumRenderTime = 0.0;
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool qMRMLRenderScheduler::eventFilter(QObject* object, QEvent* event)
+{
+  Q_D(qMRMLRenderScheduler);
+  if (qMRMLRenderSchedulerPrivate::isInteractionEvent(event->type()))
+  {
+    // Find the registered view that contains the widget that received the event
+    for (QObject* parentObject = object; parentObject; parentObject = parentObject->parent())
+    {
+      ctkVTKAbstractView* view = qobject_cast<ctkVTKAbstractView*>(parentObject);
+      if (view && d->Views.contains(view))
+      {
+        d->InteractedView = view;
+        d->InteractionTimer.start();
+        break;
+      }
+    }
+  }
+  return this->Superclass::eventFilter(object, event);
+}
@@ -0,0 +1,125 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __qMRMLRenderScheduler_h
+#define __qMRMLRenderScheduler_h
+
+// Qt includes
+#include <QObject>
+#include <QScopedPointer>
+#include <QStringList>
+#include <QVariantMap>
+
+// qMRML includes
+#include "qMRMLWidgetsExport.h"
+
+class ctkVTKAbstractView;
+class qMRMLRenderSchedulerPrivate;
+
+/// \brief Schedules rendering of all registered views within a common frame time budget.
+///
+/// Render requests of registered views (for example, requested by displayable managers)
+/// are coalesced: a view is rendered at most once per frame, regardless of how many times
+/// rendering was requested. Frames are separated by at least \sa targetFrameTime.
+///
+/// The view that the user is interacting with is always rendered first. While the user
+/// is interacting, other views whose average render time does not fit into the remaining
+/// frame budget are deferred to later frames, but they are never delayed by more than
+/// \sa maximumRenderDelay. This keeps the interacted view responsive while views that
+/// are expensive to render (such as 3D views with volume rendering) are updated at a lower rate.
+///
+/// Render time statistics of each view are available via renderStatistics().
+///
+/// \sa qMRMLLayoutManager::renderScheduler()
+class QMRML_WIDGETS_EXPORT qMRMLRenderScheduler : public QObject
+{
+  Q_OBJECT
+  /// If disabled then render requests are not scheduled by this object, each view renders independently.
+  /// Disabled by default.
+  Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled)
+  /// Target time between the start of two frames, in milliseconds. Default is 16 (about 60 frames per second).
+  Q_PROPERTY(int targetFrameTime READ targetFrameTime WRITE setTargetFrameTime)
+  /// Maximum time a render request of a view can be deferred during interaction, in milliseconds. Default is 250.
+  Q_PROPERTY(int maximumRenderDelay READ maximumRenderDelay WRITE setMaximumRenderDelay)
+  /// Time after the last user input event when interaction is considered finished, in milliseconds. Default is 200.
+  Q_PROPERTY(int interactionTimeout READ interactionTimeout WRITE setInteractionTimeout)
+
+public:
+  typedef QObject Superclass;
+  explicit qMRMLRenderScheduler(QObject* parent = nullptr);
+  ~qMRMLRenderScheduler() override;
+
+  bool isEnabled()const;
+  int targetFrameTime()const;
+  int maximumRenderDelay()const;
+  int interactionTimeout()const;
+
+  /// Add a view to the scheduler. Statistics of the view are reported using the specified name.
+  /// Views are automatically unregistered when they are deleted.
+  Q_INVOKABLE void registerView(ctkVTKAbstractView* view, const QString& name);
+  Q_INVOKABLE void unregisterView(ctkVTKAbstractView* view);
+  Q_INVOKABLE bool isViewRegistered(ctkVTKAbstractView* view)const;
+  Q_INVOKABLE QStringList viewNames()const;
+
+  /// Request rendering of a registered view in the next frame.
+  /// Returns false if the request was not scheduled (the scheduler is disabled or
+  /// the view is not registered), in this case the caller should render the view.
+  Q_INVOKABLE bool requestRender(ctkVTKAbstractView* view);
+
+  /// Returns the view that received the last user input event or nullptr.
+  Q_INVOKABLE ctkVTKAbstractView* interactedView()const;
+
+  /// Returns true if a user input event was received in a registered view within interactionTimeout.
+  Q_INVOKABLE bool isInteracting()const;
+
+  /// Returns render statistics for each registered view, indexed by view name.
+  /// Each item is a map containing: renderCount, deferredCount (number of frames when
+  /// rendering of the view was deferred), lastRenderTime, averageRenderTime, maximumRenderTime
+  /// (render times are in milliseconds).
+  Q_INVOKABLE QVariantMap renderStatistics()const;
+
+  /// Returns the number of pending render requests.
+  Q_INVOKABLE int numberOfPendingViews()const;
+
+public slots:
+  void setEnabled(bool enabled);
+  void setTargetFrameTime(int milliseconds);
+  void setMaximumRenderDelay(int milliseconds);
+  void setInteractionTimeout(int milliseconds);
+
+  /// Pause/resume rendering of all views. Each setRenderPaused(true) call must be followed by a
+  /// setRenderPaused(false) call. Render requests are kept while paused and executed when resumed.
+  void setRenderPaused(bool pause);
+
+  /// Render all pending views that fit into the frame budget.
+  void renderPendingViews();
+
+  /// Clear render statistics of all views.
+  void resetRenderStatistics();
+
+protected:
+  bool eventFilter(QObject* object, QEvent* event) override;
+
+  QScopedPointer<qMRMLRenderSchedulerPrivate> d_ptr;
+
+protected slots:
+  void onViewDestroyed(QObject* view);
+
+private:
+  Q_DECLARE_PRIVATE(qMRMLRenderScheduler);
+  Q_DISABLE_COPY(qMRMLRenderScheduler);
+};
+
+#endif
@@ -35,6 +35,7 @@
 
 // qMRML includes
 #include "qMRMLColors.h"
+#include "qMRMLRenderScheduler.h"
 #include "qMRMLSliceView_p.h"
 #include "qMRMLUtils.h"
 
@@ -496,6 +497,46 @@ void qMRMLSliceView::setDefaultViewCursor(const QCursor &cursor)
   }
 }
 
+//---------------------------------------------------------------------------
+void qMRMLSliceView::setRenderScheduler(qMRMLRenderScheduler* scheduler)
+{
+  Q_D(qMRMLSliceView);
+  if (d->RenderScheduler == scheduler)
+  {
+    return;
+  }
+  if (d->RenderScheduler)
+  {
+    d->RenderScheduler->unregisterView(this);
+  }
+  d->RenderScheduler = scheduler;
+  if (scheduler && !scheduler->isViewRegistered(this))
+  {
+    // Statistics are reported by layout name of the view
+    vtkMRMLSliceNode* viewNode = this->mrmlSliceNode();
+    scheduler->registerView(this, viewNode && viewNode->GetLayoutName() ? QString(viewNode->GetLayoutName()) : this->objectName());
+  }
+}
+
+//---------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLSliceView::renderScheduler()const
+{
+  Q_D(const qMRMLSliceView);
+  return d->RenderScheduler;
+}
+
+//---------------------------------------------------------------------------
+void qMRMLSliceView::scheduleRender()
+{
+  Q_D(qMRMLSliceView);
+  // Paused views keep their render request until rendering is resumed
+  if (d->RenderScheduler && !this->isRenderPaused() && d->RenderScheduler->requestRender(this))
+  {
+    return;
+  }
+  this->Superclass::scheduleRender();
+}
+
 //---------------------------------------------------------------------------
 void qMRMLSliceView::dragEnterEvent(QDragEnterEvent* event)
 {
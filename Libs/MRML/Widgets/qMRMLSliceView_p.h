@@ -32,6 +32,9 @@
 // We mean it.
 //
 
+// Qt includes
+#include <QPointer>
+
 // CTK includes
 #include <ctkVTKObject.h>
 #include <ctkVTKSliceView_p.h>
@@ -47,6 +50,7 @@
 #include <vtkSmartPointer.h>
 #include <vtkWeakPointer.h>
 
+class qMRMLRenderScheduler;
 class vtkMRMLDisplayableManagerGroup;
 class vtkMRMLSliceNode;
 class vtkMRMLCameraNode;
@@ -80,6 +84,7 @@ protected:
   vtkMRMLDisplayableManagerGroup*    DisplayableManagerGroup;
   vtkMRMLSliceViewInteractorStyle*   InteractorObserver;
   vtkMRMLScene*                      MRMLScene;
+  QPointer<qMRMLRenderScheduler>     RenderScheduler;
   vtkMRMLSliceNode*                  MRMLSliceNode;
   QColor                             InactiveBoxColor;
 
@@ -32,6 +32,7 @@
 
 // qMRML includes
 #include "qMRMLColors.h"
+#include "qMRMLRenderScheduler.h"
 #include "qMRMLThreeDView_p.h"
 #include "qMRMLUtils.h"
 
@@ -553,6 +554,46 @@ void qMRMLThreeDView::setDefaultViewCursor(const QCursor &cursor)
   }
 }
 
+//---------------------------------------------------------------------------
+void qMRMLThreeDView::setRenderScheduler(qMRMLRenderScheduler* scheduler)
+{
+  Q_D(qMRMLThreeDView);
+  if (d->RenderScheduler == scheduler)
+  {
+    return;
+  }
+  if (d->RenderScheduler)
+  {
+    d->RenderScheduler->unregisterView(this);
+  }
+  d->RenderScheduler = scheduler;
+  if (scheduler && !scheduler->isViewRegistered(this))
+  {
+    // Statistics are reported by layout name of the view
+    vtkMRMLViewNode* viewNode = this->mrmlViewNode();
+    scheduler->registerView(this, viewNode && viewNode->GetLayoutName() ? QString(viewNode->GetLayoutName()) : this->objectName());
+  }
+}
+
+//---------------------------------------------------------------------------
+qMRMLRenderScheduler* qMRMLThreeDView::renderScheduler()const
+{
+  Q_D(const qMRMLThreeDView);
+  return d->RenderScheduler;
+}
+
+//---------------------------------------------------------------------------
+void qMRMLThreeDView::scheduleRender()
+{
+  Q_D(qMRMLThreeDView);
+  // Paused views keep their render request until rendering is resumed
+  if (d->RenderScheduler && !this->isRenderPaused() && d->RenderScheduler->requestRender(this))
+  {
+    return;
+  }
+  this->Superclass::scheduleRender();
+}
+
 //---------------------------------------------------------------------------
 void qMRMLThreeDView::dragEnterEvent(QDragEnterEvent* event)
 {
@@ -28,6 +28,7 @@
 #include "qMRMLWidgetsExport.h"
 
 class QDropEvent;
+class qMRMLRenderScheduler;
 class qMRMLThreeDViewPrivate;
 class vtkMRMLAbstractDisplayableManager;
 class vtkMRMLCameraNode;
@@ -116,6 +117,15 @@ public:
   /// Set default cursor in the view area
   Q_INVOKABLE void setDefaultViewCursor(const QCursor &cursor);
 
+  /// Set the scheduler that coalesces render requests of this view with those of other views.
+  /// The view is registered in the scheduler if it is not registered yet, and it is unregistered
+  /// from the previously set scheduler.
+  /// If no scheduler is set (default) or the scheduler is disabled then rendering is scheduled
+  /// by the view itself.
+  /// \sa qMRMLLayoutManager::renderScheduler(), qMRMLLayoutManager::renderSchedulingEnabled
+  Q_INVOKABLE void setRenderScheduler(qMRMLRenderScheduler* scheduler);
+  Q_INVOKABLE qMRMLRenderScheduler* renderScheduler()const;
+
   void dragEnterEvent(QDragEnterEvent* event) override;
   void dropEvent(QDropEvent* event) override;
 
@@ -131,6 +141,10 @@ public:
 
 public slots:
 
+  /// Reimplemented to let the render scheduler decide when the view is rendered.
+  /// \sa setRenderScheduler()
+  void scheduleRender() override;
+
   /// Set the MRML \a scene that should be listened for events
   /// When the scene is in batch process state, the view blocks all refresh.
   /// \sa renderEnabled
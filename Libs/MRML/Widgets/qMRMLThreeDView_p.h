@@ -32,6 +32,9 @@
 // We mean it.
 //
 
+// Qt includes
+#include <QPointer>
+
 // CTK includes
 #include <ctkVTKRenderView_p.h>
 #include <ctkPimpl.h>
@@ -45,6 +48,7 @@
 // qMRML includes
 #include "qMRMLThreeDView.h"
 
+class qMRMLRenderScheduler;
 class vtkMRMLDisplayableManagerGroup;
 class vtkMRMLViewNode;
 class vtkMRMLCameraNode;
@@ -78,6 +82,7 @@ protected:
   vtkMRMLDisplayableManagerGroup*    DisplayableManagerGroup;
   vtkMRMLThreeDViewInteractorStyle*  InteractorObserver;
   vtkMRMLScene*                      MRMLScene;
+  QPointer<qMRMLRenderScheduler>     RenderScheduler;
   vtkMRMLViewNode*                   MRMLViewNode;
 
   vtkNew<vtkSSAOPass> ShadowsRenderPass;
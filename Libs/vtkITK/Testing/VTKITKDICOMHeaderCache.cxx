@@ -0,0 +1,164 @@
+#include <vtkITKArchetypeImageSeriesScalarReader.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+
+// ITK includes
+#include <itkConfigure.h>
+#include <itkFactoryRegistration.h>
+#include <itksys/Directory.hxx>
+#include <itksys/FStream.hxx>
+#include <itksys/SystemTools.hxx>
+
+// STD includes
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+bool ReadSeries(const char* archetype, const char* cacheDirectory, vtkImageData* imageData)
+{
+  vtkNew<vtkITKArchetypeImageSeriesScalarReader> reader;
+  reader->SetArchetype(archetype);
+  reader->SetSingleFile(0);
+  reader->SetOutputScalarTypeToNative();
+  reader->SetDesiredCoordinateOrientationToNative();
+  reader->SetDICOMHeaderCacheDirectory(cacheDirectory);
+  try
+  {
+    reader->Update();
+  }
+  catch (itk::ExceptionObject& err)
+  {
+    std::cout << "Unable to read file '" << archetype << "', err = \n" << err << std::endl;
+    return false;
+  }
+  if (!reader->GetOutput() || !reader->GetOutput()->GetPointData()->GetScalars())
+  {
+    std::cout << "ERROR: image data is empty for file '" << archetype << "'" << std::endl;
+    return false;
+  }
+  imageData->DeepCopy(reader->GetOutput());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool IsSameImage(vtkImageData* image1, vtkImageData* image2)
+{
+  int* dimensions1 = image1->GetDimensions();
+  int* dimensions2 = image2->GetDimensions();
+  vtkDataArray* scalars1 = image1->GetPointData()->GetScalars();
+  vtkDataArray* scalars2 = image2->GetPointData()->GetScalars();
+  if (dimensions1[0] != dimensions2[0] || dimensions1[1] != dimensions2[1] || dimensions1[2] != dimensions2[2]
+    || scalars1->GetDataType() != scalars2->GetDataType()
+    || scalars1->GetNumberOfValues() != scalars2->GetNumberOfValues())
+  {
+    return false;
+  }
+  return memcmp(scalars1->GetVoidPointer(0), scalars2->GetVoidPointer(0),
+    scalars1->GetNumberOfValues() * scalars1->GetDataTypeSize()) == 0;
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> GetCacheFileNames(const std::string& cacheDirectory)
+{
+  std::vector<std::string> cacheFileNames;
+  itksys::Directory directory;
+  if (!directory.Load(cacheDirectory))
+  {
+    return cacheFileNames;
+  }
+  for (unsigned long fileIndex = 0; fileIndex < directory.GetNumberOfFiles(); ++fileIndex)
+  {
+    std::string fileName = directory.GetFile(fileIndex);
+    if (fileName != "." && fileName != "..")
+    {
+      cacheFileNames.push_back(cacheDirectory + "/" + fileName);
+    }
+  }
+  return cacheFileNames;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  itk::itkFactoryRegistration();
+
+  if (argc < 3)
+  {
+    std::cout << "Usage: VTKITKDICOMHeaderCache /path/to/dicom/file /path/to/temp" << std::endl;
+    return 1;
+  }
+  const char* archetype = argv[1];
+  std::string cacheDirectory = std::string(argv[2]) + "/VTKITKDICOMHeaderCache";
+  itksys::SystemTools::RemoveADirectory(cacheDirectory);
+
+  // Read without cache to get the reference image
+  vtkNew<vtkImageData> referenceImage;
+  if (!ReadSeries(archetype, nullptr, referenceImage))
+  {
+    return 1;
+  }
+
+  // First read fills the cache
+  vtkNew<vtkImageData> firstImage;
+  if (!ReadSeries(archetype, cacheDirectory.c_str(), firstImage))
+  {
+    return 1;
+  }
+  std::vector<std::string> cacheFileNames = GetCacheFileNames(cacheDirectory);
+  if (cacheFileNames.size() != 1)
+  {
+    std::cout << "ERROR: expected one cache file for the series in " << cacheDirectory
+      << ", found " << cacheFileNames.size() << std::endl;
+    return 1;
+  }
+  const std::string& cacheFileName = cacheFileNames[0];
+
+  // Add an invalid line to the cache. Readers ignore it, and it is only preserved
+  // if the cache is not written again, i.e., if all headers are found in the cache.
+  const std::string markerLine = "VTKITKDICOMHeaderCacheMarker";
+  {
+    itksys::ofstream cacheFile(cacheFileName.c_str(), std::ios::app);
+    cacheFile << markerLine << "\n";
+  }
+
+  // Second read gets all headers from the cache
+  vtkNew<vtkImageData> secondImage;
+  if (!ReadSeries(archetype, cacheDirectory.c_str(), secondImage))
+  {
+    return 1;
+  }
+  bool markerFound = false;
+  {
+    itksys::ifstream cacheFile(cacheFileName.c_str());
+    std::string line;
+    while (std::getline(cacheFile, line))
+    {
+      markerFound = markerFound || (line == markerLine);
+    }
+  }
+  if (!markerFound)
+  {
+    std::cout << "ERROR: DICOM headers were read again instead of using the cache" << std::endl;
+    return 1;
+  }
+
+  if (!IsSameImage(referenceImage, firstImage) || !IsSameImage(referenceImage, secondImage))
+  {
+    std::cout << "ERROR: image read using the DICOM header cache is different from the reference image" << std::endl;
+    return 1;
+  }
+
+  itksys::SystemTools::RemoveADirectory(cacheDirectory);
+  std::cout << "Read series twice using the DICOM header cache, image has "
+    << secondImage->GetNumberOfPoints() << " points" << std::endl;
+  return 0;
+}
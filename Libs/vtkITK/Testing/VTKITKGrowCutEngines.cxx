@@ -0,0 +1,162 @@
+// vtkITK includes
+#include <vtkITKGrowCut.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+
+// ITK includes
+#include <itkFactoryRegistration.h>
+
+// STD includes
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Noisy sphere in a noisy background
+void CreateIntensityVolume(int size, vtkImageData* intensityVolume)
+{
+  intensityVolume->SetDimensions(size, size, size);
+  intensityVolume->SetSpacing(1.0, 1.0, 1.5);
+  intensityVolume->AllocateScalars(VTK_SHORT, 1);
+  short* intensities = static_cast<short*>(intensityVolume->GetScalarPointer());
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1);
+  const double center = size / 2.0;
+  for (int z = 0; z < size; ++z)
+  {
+    for (int y = 0; y < size; ++y)
+    {
+      for (int x = 0; x < size; ++x)
+      {
+        double radius = sqrt((x - center) * (x - center) + (y - center) * (y - center) + (z - center) * (z - center));
+        *(intensities++) = static_cast<short>((radius < size / 4.0 ? 200.0 : 0.0) + random->GetNextRangeValue(-40.0, 40.0));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void SetSeed(vtkImageData* seedLabelVolume, int x, int y, int z, unsigned char label)
+{
+  *static_cast<unsigned char*>(seedLabelVolume->GetScalarPointer(x, y, z)) = label;
+  seedLabelVolume->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool RunGrowCut(vtkITKGrowCut* growCut, vtkImageData* seedLabelVolume, vtkImageData* result, const char* description)
+{
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  growCut->SetSeedLabelVolume(seedLabelVolume);
+  growCut->Update();
+  timer->StopTimer();
+  std::cout << description << ": " << timer->GetElapsedTime() << " s" << std::endl;
+  if (!growCut->GetOutput() || !growCut->GetOutput()->GetScalarPointer())
+  {
+    std::cout << "ERROR: " << description << " did not produce a result" << std::endl;
+    return false;
+  }
+  result->DeepCopy(growCut->GetOutput());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Labels may only differ where the distance to two seeds are equal
+bool IsSameResult(vtkImageData* result1, vtkImageData* result2)
+{
+  const unsigned char* labels1 = static_cast<unsigned char*>(result1->GetScalarPointer());
+  const unsigned char* labels2 = static_cast<unsigned char*>(result2->GetScalarPointer());
+  vtkIdType numberOfVoxels = result1->GetNumberOfPoints();
+  vtkIdType numberOfDifferentVoxels = 0;
+  for (vtkIdType index = 0; index < numberOfVoxels; ++index)
+  {
+    numberOfDifferentVoxels += (labels1[index] != labels2[index]);
+  }
+  std::cout << "Number of different voxels: " << numberOfDifferentVoxels << std::endl;
+  return numberOfDifferentVoxels <= numberOfVoxels / 1000;
+}
+
+} // end of anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  itk::itkFactoryRegistration();
+
+  int size = 64;
+  if (argc > 1)
+  {
+    size = atoi(argv[1]);
+  }
+
+  vtkNew<vtkImageData> intensityVolume;
+  CreateIntensityVolume(size, intensityVolume);
+  vtkNew<vtkImageData> seedLabelVolume;
+  seedLabelVolume->SetDimensions(size, size, size);
+  seedLabelVolume->SetSpacing(intensityVolume->GetSpacing());
+  seedLabelVolume->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  seedLabelVolume->GetPointData()->GetScalars()->Fill(0);
+  SetSeed(seedLabelVolume, size / 2, size / 2, size / 2, 1);
+  SetSeed(seedLabelVolume, 2, 2, 2, 2);
+
+  vtkNew<vtkITKGrowCut> fastGrowCut;
+  fastGrowCut->SetIntensityVolume(intensityVolume);
+  fastGrowCut->SetDistancePenalty(0.5);
+  fastGrowCut->SetEngineToFastGrowCut();
+  vtkNew<vtkITKGrowCut> bucketQueueGrowCut;
+  bucketQueueGrowCut->SetIntensityVolume(intensityVolume);
+  bucketQueueGrowCut->SetDistancePenalty(0.5);
+  bucketQueueGrowCut->SetEngineToBucketQueue();
+
+  // Full computation
+  vtkNew<vtkImageData> fastGrowCutResult;
+  vtkNew<vtkImageData> bucketQueueResult;
+  if (!RunGrowCut(fastGrowCut, seedLabelVolume, fastGrowCutResult, "FastGrowCut full computation")
+    || !RunGrowCut(bucketQueueGrowCut, seedLabelVolume, bucketQueueResult, "BucketQueue full computation"))
+  {
+    return 1;
+  }
+  if (!IsSameResult(fastGrowCutResult, bucketQueueResult))
+  {
+    std::cout << "ERROR: full computation results are different" << std::endl;
+    return 1;
+  }
+
+  // Incremental update after adding a seed
+  SetSeed(seedLabelVolume, size / 4, size / 2, size / 2, 3);
+  if (!RunGrowCut(fastGrowCut, seedLabelVolume, fastGrowCutResult, "FastGrowCut update")
+    || !RunGrowCut(bucketQueueGrowCut, seedLabelVolume, bucketQueueResult, "BucketQueue update"))
+  {
+    return 1;
+  }
+  if (!IsSameResult(fastGrowCutResult, bucketQueueResult))
+  {
+    std::cout << "ERROR: incremental update results are different" << std::endl;
+    return 1;
+  }
+
+  // Incremental update gives the same result as a full computation
+  vtkNew<vtkImageData> fullResult;
+  bucketQueueGrowCut->Reset();
+  bucketQueueGrowCut->Modified();
+  if (!RunGrowCut(bucketQueueGrowCut, seedLabelVolume, fullResult, "BucketQueue full computation with all seeds"))
+  {
+    return 1;
+  }
+  if (!IsSameResult(fullResult, bucketQueueResult))
+  {
+    std::cout << "ERROR: incremental update result is different from full computation" << std::endl;
+    return 1;
+  }
+
+  std::cout << "Grow cut engines computed the same segmentation" << std::endl;
+  return 0;
+}
@@ -27,6 +27,8 @@
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPTools.h>
 #include <vtkStreamingDemandDrivenPipeline.h>
 
 // ITK includes
@@ -40,6 +42,14 @@
 
 // STD includes
 #include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <tuple>
 #include <vector>
 
 #include "itkArchetypeSeriesFileNames.h"
@@ -49,10 +59,182 @@
 #include "itkDCMTKImageIO.h"
 #include "itkGDCMSeriesFileNames.h"
 #include "itkGDCMImageIO.h"
+#include <itksys/Directory.hxx>
+#include <itksys/FStream.hxx>
 #endif
 
 vtkStandardNewMacro(vtkITKArchetypeImageSeriesReader);
 
+#ifdef VTKITK_BUILD_DICOM_SUPPORT
+namespace
+{
+
+// DICOM tags that are used for grouping and sorting files
+enum DICOMHeaderTagIndex
+{
+  SeriesInstanceUIDTag,
+  ContentTimeTag,
+  TriggerTimeTag,
+  EchoNumbersTag,
+  DiffusionGradientOrientationTag,
+  SliceLocationTag,
+  ImageOrientationPatientTag,
+  ImagePositionPatientTag,
+  NumberOfDICOMHeaderTags
+};
+const char* const DICOMHeaderTags[NumberOfDICOMHeaderTags] =
+  { "0020|000e", "0008|0033", "0018|1060", "0018|0086", "0010|9089", "0020|1041", "0020|0037", "0020|0032" };
+
+const char DICOMHeaderCacheSignature[] = "vtkITKArchetypeImageSeriesReader DICOM header cache 2";
+const char DICOMHeaderCacheFilePrefix[] = "DICOMHeaderCache-";
+
+// Files are identified by path, size, and modification time, so that modified files are not found in the cache
+struct DICOMHeaderCacheKey
+{
+  std::string FileName;
+  unsigned long FileSize{0};
+  long ModifiedTime{0};
+  bool operator<(const DICOMHeaderCacheKey& other) const
+  {
+    return std::tie(this->FileName, this->FileSize, this->ModifiedTime)
+      < std::tie(other.FileName, other.FileSize, other.ModifiedTime);
+  }
+};
+typedef std::map<DICOMHeaderCacheKey, std::vector<std::string> > DICOMHeaderCacheType;
+
+//----------------------------------------------------------------------------
+// Each series has its own cache file, so that only the entries of the loaded series are read and written.
+// The series is identified by the directory of the archetype file.
+std::string GetDICOMHeaderCacheFileName(const std::string& cacheDirectory, const std::string& archetype)
+{
+  std::string seriesDirectory = itksys::SystemTools::GetFilenamePath(itksys::SystemTools::CollapseFullPath(archetype));
+  std::ostringstream cacheFileName;
+  cacheFileName << cacheDirectory << "/" << DICOMHeaderCacheFilePrefix
+    << std::hex << std::hash<std::string>()(seriesDirectory) << ".txt";
+  return cacheFileName.str();
+}
+
+//----------------------------------------------------------------------------
+std::vector<std::string> SplitDICOMHeaderCacheLine(const std::string& line)
+{
+  std::vector<std::string> fields;
+  size_t fieldStart = 0;
+  for (size_t separator = line.find('\t'); separator != std::string::npos; separator = line.find('\t', fieldStart))
+  {
+    fields.push_back(line.substr(fieldStart, separator - fieldStart));
+    fieldStart = separator + 1;
+  }
+  fields.push_back(line.substr(fieldStart));
+  return fields;
+}
+
+//----------------------------------------------------------------------------
+// Each line contains file path, size, modification time, and tag values separated by tabs.
+// Tag values cannot contain tabs, as all whitespaces are removed from them.
+void ReadDICOMHeaderCache(const std::string& cacheFileName, DICOMHeaderCacheType& cache)
+{
+  itksys::ifstream cacheFile(cacheFileName.c_str());
+  std::string line;
+  if (!cacheFile || !std::getline(cacheFile, line) || line != DICOMHeaderCacheSignature)
+  {
+    return;
+  }
+  while (std::getline(cacheFile, line))
+  {
+    std::vector<std::string> fields = SplitDICOMHeaderCacheLine(line);
+    if (fields.size() != 3 + NumberOfDICOMHeaderTags)
+    {
+      continue;
+    }
+    DICOMHeaderCacheKey key;
+    key.FileName = fields[0];
+    key.FileSize = strtoul(fields[1].c_str(), nullptr, 10);
+    key.ModifiedTime = strtol(fields[2].c_str(), nullptr, 10);
+    cache[key].assign(fields.begin() + 3, fields.end());
+  }
+}
+
+//----------------------------------------------------------------------------
+bool WriteDICOMHeaderCache(const std::string& cacheFileName, const DICOMHeaderCacheType& cache)
+{
+  // Write to a temporary file and rename it, so that readers never see a partially written cache.
+  // The temporary file name is unique so that concurrent writers (other readers or other
+  // application instances) do not write into the same file.
+  std::random_device randomDevice;
+  std::ostringstream temporaryFileNameStream;
+  temporaryFileNameStream << cacheFileName << "." << std::hex << randomDevice() << randomDevice() << ".tmp";
+  std::string temporaryFileName = temporaryFileNameStream.str();
+  {
+    itksys::ofstream cacheFile(temporaryFileName.c_str());
+    if (!cacheFile)
+    {
+      itksys::SystemTools::RemoveFile(temporaryFileName);
+      return false;
+    }
+    cacheFile << DICOMHeaderCacheSignature << "\n";
+    for (const auto& item : cache)
+    {
+      if (item.first.FileName.find_first_of("\t\n") != std::string::npos)
+      {
+        continue;
+      }
+      cacheFile << item.first.FileName << "\t" << item.first.FileSize << "\t" << item.first.ModifiedTime;
+      for (const std::string& tagValue : item.second)
+      {
+        cacheFile << "\t" << tagValue;
+      }
+      cacheFile << "\n";
+    }
+    cacheFile.close();
+    if (!cacheFile)
+    {
+      itksys::SystemTools::RemoveFile(temporaryFileName);
+      return false;
+    }
+  }
+  if (!itksys::SystemTools::RenameFile(temporaryFileName, cacheFileName))
+  {
+    itksys::SystemTools::RemoveFile(temporaryFileName);
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+// Remove the least recently used cache files so that at most maximumNumberOfFiles series are cached
+void RemoveLeastRecentlyUsedDICOMHeaderCacheFiles(const std::string& cacheDirectory, int maximumNumberOfFiles)
+{
+  itksys::Directory directory;
+  if (maximumNumberOfFiles <= 0 || !directory.Load(cacheDirectory))
+  {
+    return;
+  }
+  std::vector<std::pair<long, std::string> > cacheFiles;
+  for (unsigned long fileIndex = 0; fileIndex < directory.GetNumberOfFiles(); ++fileIndex)
+  {
+    std::string fileName = directory.GetFile(fileIndex);
+    if (fileName.compare(0, strlen(DICOMHeaderCacheFilePrefix), DICOMHeaderCacheFilePrefix) != 0
+      || itksys::SystemTools::GetFilenameLastExtension(fileName) != ".txt")
+    {
+      continue;
+    }
+    std::string filePath = cacheDirectory + "/" + fileName;
+    cacheFiles.emplace_back(itksys::SystemTools::ModifiedTime(filePath), filePath);
+  }
+  if (cacheFiles.size() <= static_cast<size_t>(maximumNumberOfFiles))
+  {
+    return;
+  }
+  std::sort(cacheFiles.begin(), cacheFiles.end());
+  for (size_t fileIndex = 0; fileIndex < cacheFiles.size() - maximumNumberOfFiles; ++fileIndex)
+  {
+    itksys::SystemTools::RemoveFile(cacheFiles[fileIndex].second);
+  }
+}
+
+} // end of anonymous namespace
+#endif
+
 //----------------------------------------------------------------------------
 vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
 {
@@ -92,6 +274,9 @@ vtkITKArchetypeImageSeriesReader::vtkITKArchetypeImageSeriesReader()
   this->ImageOrientationPatient.resize( 0 );
 
   this->AnalyzeHeader = true;
+  this->NumberOfThreads = 0;
+  this->DICOMHeaderCacheDirectory = nullptr;
+  this->MaximumNumberOfDICOMHeaderCacheFiles = 100;
 
   this->GroupingByTags = false;
   this->IsOnlyFile = false;
@@ -119,6 +304,11 @@ vtkITKArchetypeImageSeriesReader::~vtkITKArchetypeImageSeriesReader()
     delete [] this->Archetype;
     this->Archetype = nullptr;
   }
+  if (this->DICOMHeaderCacheDirectory)
+  {
+    delete [] this->DICOMHeaderCacheDirectory;
+    this->DICOMHeaderCacheDirectory = nullptr;
+  }
   if (RasToIjkMatrix)
   {
     this->RasToIjkMatrix->Delete();
@@ -155,6 +345,11 @@ void vtkITKArchetypeImageSeriesReader::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Archetype: " <<
     (this->Archetype ? this->Archetype : "(none)") << "\n";
 
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "DICOMHeaderCacheDirectory: " <<
+    (this->DICOMHeaderCacheDirectory ? this->DICOMHeaderCacheDirectory : "(none)") << "\n";
+  os << indent << "MaximumNumberOfDICOMHeaderCacheFiles: " << this->MaximumNumberOfDICOMHeaderCacheFiles << "\n";
+
   os << indent << "FileNameSliceOffset: "
      << this->FileNameSliceOffset << "\n";
   os << indent << "FileNameSliceSpacing: "
@@ -1368,20 +1563,121 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
   }
 
   // if Archetype is a Dicom File
-  gdcmIO->SetFileName( this->Archetype );
+
+  // Get tags from the cache for files that have not changed since they were cached
+  std::vector< std::vector<std::string> > fileTagValues(nFiles);
+  std::vector<DICOMHeaderCacheKey> fileCacheKeys(nFiles);
+  DICOMHeaderCacheType cache;
+  std::string cacheFileName;
+  const bool useCache = (this->DICOMHeaderCacheDirectory && strlen(this->DICOMHeaderCacheDirectory) > 0);
+  if (useCache)
+  {
+    cacheFileName = GetDICOMHeaderCacheFileName(this->DICOMHeaderCacheDirectory, this->Archetype);
+    ReadDICOMHeaderCache(cacheFileName, cache);
+  }
+  std::vector<int> filesToRead;
   for (int f = 0; f < nFiles; f++)
   {
-    gdcmIO->SetFileName( this->AllFileNames[f] );
-    gdcmIO->ReadImageInformation();
-    itk::MetaDataDictionary &dict = gdcmIO->GetMetaDataDictionary();
-    std::string tagValue;
+    if (useCache)
+    {
+      DICOMHeaderCacheKey& key = fileCacheKeys[f];
+      key.FileName = this->AllFileNames[f];
+      key.FileSize = itksys::SystemTools::FileLength(key.FileName);
+      key.ModifiedTime = itksys::SystemTools::ModifiedTime(key.FileName);
+      DICOMHeaderCacheType::iterator cacheIt = cache.find(key);
+      if (cacheIt != cache.end())
+      {
+        fileTagValues[f] = cacheIt->second;
+        continue;
+      }
+    }
+    filesToRead.push_back(f);
+  }
 
-    // Use vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces to remove extra spaces
-    // from the DICOM tag, because extra spaces were found in some DICOM file before/after the
-    // multi-value separator backslashes.
+  // Read headers of the other files concurrently, each thread uses its own image IO
+  std::vector<std::exception_ptr> readErrors(filesToRead.size());
+  vtkSMPThreadLocal<itk::GDCMImageIO::Pointer> threadGdcmIOs;
+  auto readHeaders = [&](vtkIdType begin, vtkIdType end)
+  {
+    itk::GDCMImageIO::Pointer& threadGdcmIO = threadGdcmIOs.Local();
+    if (threadGdcmIO.IsNull())
+    {
+      threadGdcmIO = itk::GDCMImageIO::New();
+    }
+    for (vtkIdType fileIndex = begin; fileIndex < end; ++fileIndex)
+    {
+      const int f = filesToRead[fileIndex];
+      try
+      {
+        threadGdcmIO->SetFileName( this->AllFileNames[f] );
+        threadGdcmIO->ReadImageInformation();
+        itk::MetaDataDictionary &dict = threadGdcmIO->GetMetaDataDictionary();
+        // Use vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces to remove extra spaces
+        // from the DICOM tag, because extra spaces were found in some DICOM file before/after the
+        // multi-value separator backslashes.
+        fileTagValues[f].resize(NumberOfDICOMHeaderTags);
+        for (int tagIndex = 0; tagIndex < NumberOfDICOMHeaderTags; tagIndex++)
+        {
+          fileTagValues[f][tagIndex] = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, DICOMHeaderTags[tagIndex]);
+        }
+      }
+      catch (...)
+      {
+        readErrors[fileIndex] = std::current_exception();
+      }
+    }
+  };
+  if (this->NumberOfThreads != 1)
+  {
+    // NumberOfThreads = 0 uses the default number of threads of the SMP backend
+    vtkSMPTools::LocalScope(vtkSMPTools::Config(this->NumberOfThreads), [&]()
+    {
+      vtkSMPTools::For(0, static_cast<vtkIdType>(filesToRead.size()), readHeaders);
+    });
+  }
+  else
+  {
+    readHeaders(0, static_cast<vtkIdType>(filesToRead.size()));
+  }
+  // Report the error of the first file that could not be read, as if files were read one by one
+  for (const std::exception_ptr& readError : readErrors)
+  {
+    if (readError)
+    {
+      std::rethrow_exception(readError);
+    }
+  }
+
+  if (useCache && filesToRead.empty())
+  {
+    // Mark the cache file as recently used, so that it is not removed when other series are cached
+    itksys::SystemTools::Touch(cacheFileName, false);
+  }
+  else if (useCache)
+  {
+    // Only entries of the current files are kept, so that the cache file does not grow
+    // when files of the series are modified or removed
+    DICOMHeaderCacheType seriesCache;
+    for (int f = 0; f < nFiles; f++)
+    {
+      seriesCache[fileCacheKeys[f]] = fileTagValues[f];
+    }
+    itksys::SystemTools::MakeDirectory(this->DICOMHeaderCacheDirectory);
+    if (!WriteDICOMHeaderCache(cacheFileName, seriesCache))
+    {
+      vtkWarningMacro("AnalyzeDicomHeaders: failed to write DICOM header cache file " << cacheFileName);
+    }
+    RemoveLeastRecentlyUsedDICOMHeaderCacheFiles(this->DICOMHeaderCacheDirectory, this->MaximumNumberOfDICOMHeaderCacheFiles);
+  }
+
+  // Fill the tag arrays in the order of the files
+  for (int f = 0; f < nFiles; f++)
+  {
+    const std::vector<std::string>& tagValues = fileTagValues[f];
+    std::string tagValue;
 
     // series instance UID
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|000e");
+    tagValue = tagValues[SeriesInstanceUIDTag];
     if (!tagValue.empty())
     {
       int idx = InsertSeriesInstanceUIDs( tagValue.c_str() );
@@ -1393,7 +1689,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // content time
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0008|0033");
+    tagValue = tagValues[ContentTimeTag];
     if (!tagValue.empty())
     {
       int idx = InsertContentTime( tagValue.c_str() );
@@ -1405,7 +1701,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // trigger time
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0018|1060");
+    tagValue = tagValues[TriggerTimeTag];
     if (!tagValue.empty())
     {
       int idx = InsertTriggerTime( tagValue.c_str() );
@@ -1417,7 +1713,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // echo numbers
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0018|0086");
+    tagValue = tagValues[EchoNumbersTag];
     if (!tagValue.empty())
     {
       int idx = InsertEchoNumbers( tagValue.c_str() );
@@ -1429,7 +1725,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // diffision gradient orientation
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0010|9089");
+    tagValue = tagValues[DiffusionGradientOrientationTag];
     if (!tagValue.empty())
     {
       float a[3] = { -1 };
@@ -1443,7 +1739,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // slice location
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|1041");
+    tagValue = tagValues[SliceLocationTag];
     if (!tagValue.empty())
     {
       float a = -1;
@@ -1457,7 +1753,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
     }
 
     // image orientation patient
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|0037");
+    tagValue = tagValues[ImageOrientationPatientTag];
     if (!tagValue.empty())
     {
       float a[6] = { -1 };
@@ -1470,7 +1766,7 @@ void vtkITKArchetypeImageSeriesReader::AnalyzeDicomHeaders()
       this->IndexImageOrientationPatient[f] = -1;
     }
     // image position patient
-    tagValue = vtkITKArchetypeImageSeriesReader::GetMetaDataWithoutSpaces(dict, "0020|0032");
+    tagValue = tagValues[ImagePositionPatientTag];
     if (!tagValue.empty())
     {
       float a[3] = { -1 };
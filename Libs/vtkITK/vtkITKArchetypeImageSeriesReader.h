@@ -246,6 +246,31 @@ public:
   vtkSetMacro(AnalyzeHeader, bool);
   vtkGetMacro(AnalyzeHeader, bool);
 
+  ///
+  /// Number of threads used for reading DICOM headers when analyzing the headers.
+  /// 1 disables multithreading, any other value reads headers concurrently
+  /// using at most this many threads of the VTK SMP backend.
+  /// Default is 0, which uses the default number of threads of the backend.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+
+  ///
+  /// Directory that stores the DICOM tags that are used for grouping and sorting files.
+  /// Each series (files in the directory of the archetype) is cached in a separate file
+  /// and each file is identified by its path, size, and modification time.
+  /// Headers of files that are found in the cache are not read again
+  /// when the same series is loaded or grouped again.
+  /// Empty (no cache is used) by default.
+  vtkSetStringMacro(DICOMHeaderCacheDirectory);
+  vtkGetStringMacro(DICOMHeaderCacheDirectory);
+
+  ///
+  /// Maximum number of series that are kept in the DICOM header cache directory.
+  /// Cache files of the least recently used series are removed when a new series is cached.
+  /// Default is 100.
+  vtkSetMacro(MaximumNumberOfDICOMHeaderCacheFiles, int);
+  vtkGetMacro(MaximumNumberOfDICOMHeaderCacheFiles, int);
+
   ///
   /// Whether to use orientation from file
   vtkSetMacro(UseOrientationFromFile, int);
@@ -879,6 +904,9 @@ protected:
 
   std::vector<std::string> AllFileNames;
   bool AnalyzeHeader;
+  int NumberOfThreads;
+  char* DICOMHeaderCacheDirectory;
+  int MaximumNumberOfDICOMHeaderCacheFiles;
   bool IsOnlyFile;
   bool ArchetypeIsDICOM;
 
@@ -34,13 +34,31 @@
 #include "vtkMath.h"
 #include "vtkObjectFactory.h"
 #include "vtkPointData.h"
+#include "vtkSMPTools.h"
+#include "vtkSmartPointer.h"
 #include "vtkStreamingDemandDrivenPipeline.h"
 
 /// ITK includes
 #include "itkFastGrowCut.h"
 
+/// STD includes
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 vtkStandardNewMacro(vtkITKGrowCut);
 
+namespace
+{
+// Distance of voxels that are not reached yet
+const float GROWCUT_DIST_INF = std::numeric_limits<float>::max();
+// Distance of seed and masked voxels, small enough so that they are never relabeled
+const float GROWCUT_DIST_EPSILON = 1e-3f;
+// Number of buckets that the largest possible distance between neighbor voxels is quantized into
+const double GROWCUT_BUCKETS_PER_MAX_NEIGHBOR_DISTANCE = 256.0;
+}
+
 //----------------------------------------------------------------------------
 class vtkITKGrowCut::vtkInternal
 {
@@ -56,13 +74,24 @@ public:
   void Reset()
   {
     this->FGCFilterProcess = nullptr;
+    this->Distances.clear();
+    this->Distances.shrink_to_fit();
+    this->BucketQueueResultLabelVolume = nullptr;
   }
 
+  // State of the bucket queue engine. It is kept between updates so that
+  // only new or changed seeds are grown from in subsequent updates.
+  std::vector<float> Distances;
+  vtkSmartPointer<vtkImageData> BucketQueueResultLabelVolume;
+
   vtkITKGrowCut* External{ nullptr };
 
   template <typename IntensityType, typename SeedLabelType, typename MaskType>
   void RunGrowCut(vtkImageData* intensityVolume, vtkImageData* seedLabelVolume, vtkImageData* maskLabelVolume, vtkImageData* resultLabelVolume);
 
+  template <typename IntensityType, typename SeedLabelType, typename MaskType>
+  void RunBucketQueueGrowCut(vtkImageData* intensityVolume, vtkImageData* seedLabelVolume, vtkImageData* maskLabelVolume, vtkImageData* resultLabelVolume);
+
   //----------------------------------------------------------------------------
   struct FastGrowCutWorker
   {
@@ -76,7 +105,14 @@ public:
       using IntensityType = vtk::GetAPIType<IntensityVolumeArrayType>;
       using SeedLabelType = vtk::GetAPIType<SeedLabelVolumeArrayType>;
       using MaskType = char; // Mask image not specified. Use placeholder type char.
-      self->Internal->RunGrowCut<IntensityType, SeedLabelType, MaskType>(intensityVolume, seedLabelVolume, nullptr, resultLabelVolume);
+      if (self->GetEngine() == vtkITKGrowCut::EngineBucketQueue)
+      {
+        self->Internal->RunBucketQueueGrowCut<IntensityType, SeedLabelType, MaskType>(intensityVolume, seedLabelVolume, nullptr, resultLabelVolume);
+      }
+      else
+      {
+        self->Internal->RunGrowCut<IntensityType, SeedLabelType, MaskType>(intensityVolume, seedLabelVolume, nullptr, resultLabelVolume);
+      }
     }
 
     template <typename IntensityVolumeArrayType, typename SeedLabelVolumeArrayType, typename MaskLabelVolumeArrayType>
@@ -90,7 +126,14 @@ public:
       using IntensityType = vtk::GetAPIType<IntensityVolumeArrayType>;
       using SeedLabelType = vtk::GetAPIType<SeedLabelVolumeArrayType>;
       using MaskType = vtk::GetAPIType<MaskLabelVolumeArrayType>;
-      self->Internal->RunGrowCut<IntensityType, SeedLabelType, MaskType>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume);
+      if (self->GetEngine() == vtkITKGrowCut::EngineBucketQueue)
+      {
+        self->Internal->RunBucketQueueGrowCut<IntensityType, SeedLabelType, MaskType>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume);
+      }
+      else
+      {
+        self->Internal->RunGrowCut<IntensityType, SeedLabelType, MaskType>(intensityVolume, seedLabelVolume, maskLabelVolume, resultLabelVolume);
+      }
     }
   };
 };
@@ -151,6 +194,174 @@ void vtkITKGrowCut::vtkInternal::RunGrowCut(vtkImageData* intensityVolume, vtkIm
   resultLabelVolume->ShallowCopy(resultImageToVTKFilter->GetOutput());
 }
 
+//----------------------------------------------------------------------------
+template <typename IntensityType, typename SeedLabelType, typename MaskType>
+void vtkITKGrowCut::vtkInternal::RunBucketQueueGrowCut(vtkImageData* intensityVolume, vtkImageData* seedLabelVolume,
+  vtkImageData* maskLabelVolume, vtkImageData* resultLabelVolume)
+{
+  int dimensions[3] = { 0, 0, 0 };
+  intensityVolume->GetDimensions(dimensions);
+  int* seedDimensions = seedLabelVolume->GetDimensions();
+  int* maskDimensions = maskLabelVolume ? maskLabelVolume->GetDimensions() : dimensions;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (seedDimensions[axis] != dimensions[axis] || maskDimensions[axis] != dimensions[axis])
+    {
+      vtkErrorWithObjectMacro(this->External, "vtkITKGrowCut: seed and mask volume dimensions must match the intensity volume dimensions");
+      resultLabelVolume->Initialize();
+      return;
+    }
+  }
+  const vtkIdType dimX = dimensions[0];
+  const vtkIdType dimY = dimensions[1];
+  const vtkIdType dimZ = dimensions[2];
+  const vtkIdType numberOfVoxels = dimX * dimY * dimZ;
+
+  const IntensityType* intensities = static_cast<IntensityType*>(intensityVolume->GetScalarPointer());
+  const SeedLabelType* seeds = static_cast<SeedLabelType*>(seedLabelVolume->GetScalarPointer());
+  const MaskType* mask = maskLabelVolume ? static_cast<MaskType*>(maskLabelVolume->GetScalarPointer()) : nullptr;
+
+  // Previous result can only be updated if the geometry and label type has not changed
+  vtkImageData* previousResult = this->BucketQueueResultLabelVolume;
+  const bool initialized = (previousResult
+    && static_cast<vtkIdType>(this->Distances.size()) == numberOfVoxels
+    && previousResult->GetScalarType() == seedLabelVolume->GetScalarType()
+    && previousResult->GetDimensions()[0] == dimensions[0]
+    && previousResult->GetDimensions()[1] == dimensions[1]
+    && previousResult->GetDimensions()[2] == dimensions[2]);
+  if (!initialized)
+  {
+    this->BucketQueueResultLabelVolume = vtkSmartPointer<vtkImageData>::New();
+    this->BucketQueueResultLabelVolume->SetOrigin(seedLabelVolume->GetOrigin());
+    this->BucketQueueResultLabelVolume->SetSpacing(seedLabelVolume->GetSpacing());
+    this->BucketQueueResultLabelVolume->SetExtent(seedLabelVolume->GetExtent());
+    this->BucketQueueResultLabelVolume->AllocateScalars(seedLabelVolume->GetScalarType(), 1);
+    this->Distances.assign(numberOfVoxels, GROWCUT_DIST_INF);
+  }
+  SeedLabelType* labels = static_cast<SeedLabelType*>(this->BucketQueueResultLabelVolume->GetScalarPointer());
+  float* distances = this->Distances.data();
+
+  // Initialize labels and distances. In a full computation all seeds are grown from,
+  // in an update only new or changed seeds are grown from, as labels of old seeds have been already propagated.
+  std::vector<unsigned char> growFromVoxel(numberOfVoxels, 0);
+  vtkSMPTools::For(0, numberOfVoxels, [&](vtkIdType begin, vtkIdType end)
+  {
+    for (vtkIdType index = begin; index < end; ++index)
+    {
+      if (!initialized)
+      {
+        if (mask && mask[index] != 0)
+        {
+          // Masked voxels are never relabeled and not grown from
+          labels[index] = 0;
+          distances[index] = GROWCUT_DIST_EPSILON;
+          continue;
+        }
+        labels[index] = seeds[index];
+        distances[index] = (seeds[index] != 0 ? GROWCUT_DIST_EPSILON : GROWCUT_DIST_INF);
+        growFromVoxel[index] = (seeds[index] != 0);
+      }
+      else if (seeds[index] != 0 && (labels[index] != seeds[index] || distances[index] > GROWCUT_DIST_EPSILON))
+      {
+        labels[index] = seeds[index];
+        distances[index] = GROWCUT_DIST_EPSILON;
+        growFromVoxel[index] = 1;
+      }
+    }
+  });
+
+  // 26-neighborhood, penalty is proportional to the physical distance of neighbor voxels
+  const double distancePenalty = this->External->GetDistancePenalty();
+  double* spacing = intensityVolume->GetSpacing();
+  std::vector<vtkIdType> neighborIndexOffsets;
+  std::vector<float> neighborDistancePenalties;
+  for (int iz = -1; iz <= 1; iz++)
+  {
+    for (int iy = -1; iy <= 1; iy++)
+    {
+      for (int ix = -1; ix <= 1; ix++)
+      {
+        if (ix == 0 && iy == 0 && iz == 0)
+        {
+          continue;
+        }
+        neighborIndexOffsets.push_back(ix + dimX * (iy + dimY * iz));
+        neighborDistancePenalties.push_back(static_cast<float>(distancePenalty * sqrt(
+          (spacing[0] * ix) * (spacing[0] * ix) + (spacing[1] * iy) * (spacing[1] * iy) + (spacing[2] * iz) * (spacing[2] * iz))));
+      }
+    }
+  }
+
+  // Distances are quantized into buckets and voxels are processed bucket by bucket.
+  // Within a bucket the processing order is arbitrary, therefore a voxel is processed
+  // again if its distance decreases later, which makes the computed distances the same
+  // as with strict ordering. A voxel is never queued farther than the maximum neighbor
+  // distance from the voxel that is being processed, so a ring of buckets is enough.
+  double* intensityRange = intensityVolume->GetScalarRange();
+  const double maxNeighborDistance = (intensityRange[1] - intensityRange[0])
+    + *std::max_element(neighborDistancePenalties.begin(), neighborDistancePenalties.end());
+  const double bucketWidth = (maxNeighborDistance > 0 ? maxNeighborDistance / GROWCUT_BUCKETS_PER_MAX_NEIGHBOR_DISTANCE : 1.0);
+  const size_t numberOfBuckets = static_cast<size_t>(maxNeighborDistance / bucketWidth) + 3;
+  std::vector< std::vector<vtkIdType> > buckets(numberOfBuckets);
+  auto getBucket = [bucketWidth](float distance) { return static_cast<size_t>(distance / bucketWidth); };
+
+  size_t numberOfQueuedVoxels = 0;
+  for (vtkIdType index = 0; index < numberOfVoxels; ++index)
+  {
+    if (growFromVoxel[index])
+    {
+      buckets[getBucket(distances[index]) % numberOfBuckets].push_back(index);
+      numberOfQueuedVoxels++;
+    }
+  }
+  growFromVoxel.clear();
+  growFromVoxel.shrink_to_fit();
+
+  const vtkIdType sliceSize = dimX * dimY;
+  for (size_t currentBucket = 0; numberOfQueuedVoxels > 0; currentBucket++)
+  {
+    std::vector<vtkIdType>& bucketVoxels = buckets[currentBucket % numberOfBuckets];
+    while (!bucketVoxels.empty())
+    {
+      vtkIdType index = bucketVoxels.back();
+      bucketVoxels.pop_back();
+      numberOfQueuedVoxels--;
+      const float currentDistance = distances[index];
+      if (getBucket(currentDistance) != currentBucket)
+      {
+        // distance decreased after the voxel was queued, it has been already processed in an earlier bucket
+        continue;
+      }
+      // Voxels at the image boundary are not grown from (there is no neighbor on one side)
+      const vtkIdType x = index % dimX;
+      const vtkIdType y = (index / dimX) % dimY;
+      const vtkIdType z = index / sliceSize;
+      if (x == 0 || x == dimX - 1 || y == 0 || y == dimY - 1 || z == 0 || z == dimZ - 1)
+      {
+        continue;
+      }
+      const SeedLabelType currentLabel = labels[index];
+      const float centerIntensity = static_cast<float>(intensities[index]);
+      for (size_t i = 0; i < neighborIndexOffsets.size(); i++)
+      {
+        const vtkIdType neighborIndex = index + neighborIndexOffsets[i];
+        const float neighborNewDistance = std::fabs(centerIntensity - static_cast<float>(intensities[neighborIndex]))
+          + currentDistance + neighborDistancePenalties[i];
+        if (distances[neighborIndex] > neighborNewDistance)
+        {
+          distances[neighborIndex] = neighborNewDistance;
+          labels[neighborIndex] = currentLabel;
+          buckets[getBucket(neighborNewDistance) % numberOfBuckets].push_back(neighborIndex);
+          numberOfQueuedVoxels++;
+        }
+      }
+    }
+  }
+
+  this->BucketQueueResultLabelVolume->Modified();
+  resultLabelVolume->ShallowCopy(this->BucketQueueResultLabelVolume);
+}
+
 //----------------------------------------------------------------------------
 vtkITKGrowCut::vtkITKGrowCut()
   : Internal(new vtkInternal(this))
@@ -170,6 +381,8 @@ vtkITKGrowCut::~vtkITKGrowCut()
 void vtkITKGrowCut::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "DistancePenalty: " << this->DistancePenalty << "\n";
+  os << indent << "Engine: " << (this->Engine == EngineBucketQueue ? "BucketQueue" : "FastGrowCut") << "\n";
 }
 
 //-----------------------------------------------------------------------------
@@ -258,3 +471,17 @@ void vtkITKGrowCut::SetDistancePenalty(double distancePenalty)
     this->Modified();
   }
 }
+
+//-----------------------------------------------------------------------------
+void vtkITKGrowCut::SetEngine(int engine)
+{
+  engine = std::max(static_cast<int>(EngineFastGrowCut), std::min(engine, static_cast<int>(EngineBucketQueue)));
+  vtkDebugMacro(<< this->GetClassName() << " (" << this << "): setting Engine to " << engine);
+  if (this->Engine != engine)
+  {
+    this->Engine = engine;
+    // Computed distances and labels of the previous engine cannot be used for updates
+    this->Reset();
+    this->Modified();
+  }
+}
@@ -63,6 +63,25 @@ class VTK_ITK_EXPORT vtkITKGrowCut : public vtkImageAlgorithm
   vtkGetMacro(DistancePenalty, double);
   void SetDistancePenalty(double distancePenalty);
 
+  enum
+  {
+    /// ITK FastGrowCut filter, which orders voxels by distance using a Fibonacci heap.
+    /// A heap node is allocated for each voxel.
+    EngineFastGrowCut,
+    /// Voxels are queued in buckets of quantized distances. Only voxels that are reached
+    /// by the growing front are queued, therefore it requires much less memory and it is
+    /// typically faster, while it computes the same distances.
+    EngineBucketQueue
+  };
+
+  /// Select the algorithm that is used for region growing.
+  /// Changing the engine resets the filter (see Reset()).
+  /// Default is EngineFastGrowCut.
+  vtkGetMacro(Engine, int);
+  void SetEngine(int engine);
+  void SetEngineToFastGrowCut() { this->SetEngine(EngineFastGrowCut); }
+  void SetEngineToBucketQueue() { this->SetEngine(EngineBucketQueue); }
+
 protected:
   vtkITKGrowCut();
   ~vtkITKGrowCut() override;
@@ -71,6 +90,7 @@ protected:
   void ExecuteDataWithInformation(vtkDataObject* outData, vtkInformation* outInfo) override;
 
   double DistancePenalty{ 0.0 };
+  int Engine{ EngineFastGrowCut };
 
 private:
   vtkITKGrowCut(const vtkITKGrowCut&) = delete;
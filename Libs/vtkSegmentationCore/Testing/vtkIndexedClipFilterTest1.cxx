@@ -0,0 +1,342 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkIndexedClipFilter.h"
+
+// VTK includes
+#include <vtkAppendFilter.h>
+#include <vtkClipDataSet.h>
+#include <vtkClipPolyData.h>
+#include <vtkExtractGeometry.h>
+#include <vtkExtractPolyDataGeometry.h>
+#include <vtkNew.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSphere.h>
+#include <vtkSphereSource.h>
+#include <vtkTimerLog.h>
+#include <vtkTransform.h>
+#include <vtkUnstructuredGrid.h>
+
+// STD includes
+#include <iostream>
+#include <string>
+
+// Get CHECK_INT and CHECK_BOOL from vtkAddonTestingMacros.h to avoid dependency on vtkAddon
+namespace
+{
+
+//----------------------------------------------------------------------------
+int CheckInt(int line, const std::string& description, vtkIdType current, vtkIdType expected)
+{
+  if (current == expected)
+  {
+    return EXIT_SUCCESS;
+  }
+  std::cerr << "\nLine " << line << " - " << description.c_str() << " : test failed"
+    << "\n\tcurrent :" << current
+    << "\n\texpected:" << expected
+    << std::endl;
+  return EXIT_FAILURE;
+}
+
+// Use a macro to be able to print the evaluated expression and the line number
+#define CHECK_INT(actual, expected) \
+{ \
+  if (CheckInt(__LINE__,#actual " != " #expected, (actual), (expected)) != EXIT_SUCCESS) \
+  { \
+    return EXIT_FAILURE; \
+  } \
+}
+
+#define CHECK_BOOL(actual, expected) CHECK_INT((actual) ? 1 : 0, (expected) ? 1 : 0)
+
+#define CHECK_EXIT_SUCCESS(actual) CHECK_INT(actual, EXIT_SUCCESS)
+
+#define PRINT_DART_MEASUREMENT(name, value) \
+  std::cout << "<DartMeasurement name=\"" << (name) << "\" type=\"numeric/double\">" << (value) << "</DartMeasurement>" << std::endl;
+
+//-----------------------------------------------------------------------------
+// Boolean function that inverts the result, similar to vtkImplicitInvertableBoolean in MRML
+class vtkTestInvertedBoolean : public vtkImplicitBoolean
+{
+public:
+  static vtkTestInvertedBoolean* New();
+  vtkTypeMacro(vtkTestInvertedBoolean, vtkImplicitBoolean);
+  using vtkImplicitBoolean::EvaluateFunction;
+  double EvaluateFunction(double x[3]) override
+  {
+    return -this->Superclass::EvaluateFunction(x);
+  }
+  void EvaluateGradient(double x[3], double g[3]) override
+  {
+    this->Superclass::EvaluateGradient(x, g);
+    g[0] = -g[0];
+    g[1] = -g[1];
+    g[2] = -g[2];
+  }
+};
+vtkStandardNewMacro(vtkTestInvertedBoolean);
+
+//-----------------------------------------------------------------------------
+// Boolean function that scales the result, it cannot be represented by the indexed clip function
+class vtkTestScaledBoolean : public vtkImplicitBoolean
+{
+public:
+  static vtkTestScaledBoolean* New();
+  vtkTypeMacro(vtkTestScaledBoolean, vtkImplicitBoolean);
+  using vtkImplicitBoolean::EvaluateFunction;
+  double EvaluateFunction(double x[3]) override
+  {
+    return 2.0 * this->Superclass::EvaluateFunction(x) + 1.0;
+  }
+};
+vtkStandardNewMacro(vtkTestScaledBoolean);
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkPolyData> CreateSphere(int resolution)
+{
+  vtkNew<vtkSphereSource> sphere;
+  sphere->SetRadius(50.0);
+  sphere->SetThetaResolution(resolution);
+  sphere->SetPhiResolution(resolution);
+  sphere->Update();
+  return sphere->GetOutput();
+}
+
+//-----------------------------------------------------------------------------
+// Clip function similar to the one created by the model displayable manager:
+// a boolean function of two planes, one of them inverted, with a linear transform.
+vtkSmartPointer<vtkImplicitBoolean> CreateClipFunction(vtkPlane* plane1, vtkPlane* plane2, int operationType)
+{
+  vtkNew<vtkTestInvertedBoolean> invertedPlane;
+  invertedPlane->AddFunction(plane2);
+  vtkNew<vtkImplicitBoolean> clipNodeFunction;
+  clipNodeFunction->SetOperationType(operationType);
+  clipNodeFunction->AddFunction(plane1);
+  clipNodeFunction->AddFunction(invertedPlane);
+  vtkSmartPointer<vtkImplicitBoolean> clipFunction = vtkSmartPointer<vtkImplicitBoolean>::New();
+  clipFunction->AddFunction(clipNodeFunction);
+  vtkNew<vtkTransform> transform;
+  transform->Translate(3.0, -2.0, 1.5);
+  transform->RotateZ(10.0);
+  clipFunction->SetTransform(transform);
+  return clipFunction;
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkDataSet> ClipReference(vtkPointSet* mesh, vtkImplicitFunction* clipFunction, int clippingMethod)
+{
+  vtkSmartPointer<vtkAlgorithm> clipper;
+  bool polyData = (vtkPolyData::SafeDownCast(mesh) != nullptr);
+  if (clippingMethod == vtkIndexedClipFilter::Straight)
+  {
+    if (polyData)
+    {
+      vtkNew<vtkClipPolyData> clipPolyData;
+      clipPolyData->SetClipFunction(clipFunction);
+      clipper = clipPolyData;
+    }
+    else
+    {
+      vtkNew<vtkClipDataSet> clipDataSet;
+      clipDataSet->SetClipFunction(clipFunction);
+      clipper = clipDataSet;
+    }
+  }
+  else if (polyData)
+  {
+    vtkNew<vtkExtractPolyDataGeometry> extractPolyDataGeometry;
+    extractPolyDataGeometry->SetImplicitFunction(clipFunction);
+    extractPolyDataGeometry->ExtractInsideOff();
+    extractPolyDataGeometry->SetExtractBoundaryCells(clippingMethod == vtkIndexedClipFilter::WholeCellsWithBoundary);
+    clipper = extractPolyDataGeometry;
+  }
+  else
+  {
+    vtkNew<vtkExtractGeometry> extractGeometry;
+    extractGeometry->SetImplicitFunction(clipFunction);
+    extractGeometry->ExtractInsideOff();
+    extractGeometry->SetExtractBoundaryCells(clippingMethod == vtkIndexedClipFilter::WholeCellsWithBoundary);
+    clipper = extractGeometry;
+  }
+  clipper->SetInputDataObject(mesh);
+  clipper->Update();
+  return vtkDataSet::SafeDownCast(clipper->GetOutputDataObject(0));
+}
+
+//-----------------------------------------------------------------------------
+int CheckClipResult(vtkPointSet* mesh, vtkImplicitFunction* clipFunction, int clippingMethod, bool expectIndexed)
+{
+  vtkSmartPointer<vtkDataSet> expectedOutput = ClipReference(mesh, clipFunction, clippingMethod);
+  vtkNew<vtkIndexedClipFilter> clipFilter;
+  clipFilter->SetInputData(mesh);
+  clipFilter->SetClipFunction(clipFunction);
+  clipFilter->SetClippingMethod(clippingMethod);
+  clipFilter->Update();
+  vtkDataSet* output = vtkDataSet::SafeDownCast(clipFilter->GetOutputDataObject(0));
+  CHECK_BOOL(output != nullptr, true);
+  CHECK_BOOL(clipFilter->GetClipFunctionIndexed(), expectIndexed);
+  CHECK_BOOL(std::string(output->GetClassName()) == mesh->GetClassName(), true);
+  CHECK_INT(output->GetNumberOfCells(), expectedOutput->GetNumberOfCells());
+  if (clippingMethod == vtkIndexedClipFilter::Straight)
+  {
+    CHECK_INT(output->GetNumberOfPoints(), expectedOutput->GetNumberOfPoints());
+    CHECK_INT(output->GetPointData()->GetNumberOfArrays(), expectedOutput->GetPointData()->GetNumberOfArrays());
+  }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+// At low resolution most cells are in bins that are intersected by the clip planes, therefore all cells are clipped.
+// At high resolution only cells in intersected bins are clipped, the others are copied or removed.
+int TestClipResults(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = CreateSphere(resolution);
+  vtkNew<vtkAppendFilter> sphereToUnstructuredGrid;
+  sphereToUnstructuredGrid->SetInputData(sphere);
+  sphereToUnstructuredGrid->Update();
+  vtkUnstructuredGrid* sphereUnstructuredGrid = sphereToUnstructuredGrid->GetOutput();
+
+  vtkNew<vtkPlane> plane1;
+  plane1->SetOrigin(1.234, 0.0, 0.0);
+  plane1->SetNormal(1.0, 0.2, 0.0);
+  vtkNew<vtkPlane> plane2;
+  plane2->SetOrigin(0.0, 0.0, -7.89);
+  plane2->SetNormal(0.0, -0.3, 1.0);
+  vtkNew<vtkSphere> sphereFunction;
+  sphereFunction->SetRadius(30.0);
+
+  const int clippingMethods[3] = { vtkIndexedClipFilter::Straight, vtkIndexedClipFilter::WholeCells, vtkIndexedClipFilter::WholeCellsWithBoundary };
+  const int operationTypes[2] = { vtkImplicitBoolean::VTK_INTERSECTION, vtkImplicitBoolean::VTK_UNION };
+  for (int clippingMethod : clippingMethods)
+  {
+    for (int operationType : operationTypes)
+    {
+      vtkSmartPointer<vtkImplicitBoolean> clipFunction = CreateClipFunction(plane1, plane2, operationType);
+      CHECK_EXIT_SUCCESS(CheckClipResult(sphere, clipFunction, clippingMethod, true));
+      CHECK_EXIT_SUCCESS(CheckClipResult(sphereUnstructuredGrid, clipFunction, clippingMethod, true));
+    }
+    // Functions that are not made up of planes are evaluated directly
+    CHECK_EXIT_SUCCESS(CheckClipResult(sphere, sphereFunction, clippingMethod, false));
+    vtkNew<vtkTestScaledBoolean> scaledFunction;
+    scaledFunction->AddFunction(plane1);
+    CHECK_EXIT_SUCCESS(CheckClipResult(sphere, scaledFunction, clippingMethod, false));
+  }
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestClipStateCaching()
+{
+  vtkSmartPointer<vtkPolyData> sphere = CreateSphere(100);
+  vtkNew<vtkPlane> plane1;
+  plane1->SetNormal(1.0, 0.0, 0.0);
+  vtkNew<vtkPlane> plane2;
+  plane2->SetNormal(0.0, 0.0, 1.0);
+
+  vtkNew<vtkIndexedClipFilter> clipFilter;
+  clipFilter->SetInputData(sphere);
+  clipFilter->SetClipFunction(CreateClipFunction(plane1, plane2, vtkImplicitBoolean::VTK_INTERSECTION));
+  clipFilter->Update();
+  vtkMTimeType outputMTime = clipFilter->GetOutputDataObject(0)->GetMTime();
+  // Only points near the clip surface are evaluated
+  CHECK_BOOL(clipFilter->GetNumberOfEvaluatedPoints() > 0, true);
+  CHECK_BOOL(clipFilter->GetNumberOfEvaluatedPoints() < sphere->GetNumberOfPoints(), true);
+
+  // Function modified without changing the clip state
+  plane1->Modified();
+  clipFilter->Update();
+  CHECK_BOOL(clipFilter->GetOutputDataObject(0)->GetMTime() == outputMTime, true);
+
+  // Identical function set
+  clipFilter->SetClipFunction(CreateClipFunction(plane1, plane2, vtkImplicitBoolean::VTK_INTERSECTION));
+  clipFilter->Update();
+  CHECK_BOOL(clipFilter->GetOutputDataObject(0)->GetMTime() == outputMTime, true);
+
+  // Clip state changed
+  plane1->SetOrigin(10.0, 0.0, 0.0);
+  clipFilter->Update();
+  CHECK_BOOL(clipFilter->GetOutputDataObject(0)->GetMTime() > outputMTime, true);
+  outputMTime = clipFilter->GetOutputDataObject(0)->GetMTime();
+
+  // Clipping method changed
+  clipFilter->SetClippingMethod(vtkIndexedClipFilter::WholeCells);
+  clipFilter->Update();
+  CHECK_BOOL(clipFilter->GetOutputDataObject(0)->GetMTime() > outputMTime, true);
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestClipPerformance(int resolution)
+{
+  vtkSmartPointer<vtkPolyData> sphere = CreateSphere(resolution);
+  vtkNew<vtkPlane> plane1;
+  plane1->SetNormal(1.0, 0.0, 0.0);
+  vtkNew<vtkPlane> plane2;
+  plane2->SetNormal(0.0, 0.0, 1.0);
+  vtkSmartPointer<vtkImplicitBoolean> clipFunction = CreateClipFunction(plane1, plane2, vtkImplicitBoolean::VTK_INTERSECTION);
+
+  // Move a plane as a slice would be moved in a view
+  const int numberOfSteps = 20;
+  vtkNew<vtkClipPolyData> clipPolyData;
+  clipPolyData->SetInputData(sphere);
+  clipPolyData->SetClipFunction(clipFunction);
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int step = 0; step < numberOfSteps; ++step)
+  {
+    plane1->SetOrigin(step - numberOfSteps / 2, 0.0, 0.0);
+    clipPolyData->Update();
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkIndexedClipFilter-vtkClipPolyDataTimePerUpdateMsec", timer->GetElapsedTime() / numberOfSteps * 1000.0);
+  vtkIdType expectedNumberOfCells = clipPolyData->GetOutput()->GetNumberOfCells();
+
+  vtkNew<vtkIndexedClipFilter> clipFilter;
+  clipFilter->SetInputData(sphere);
+  clipFilter->SetClipFunction(clipFunction);
+  timer->StartTimer();
+  for (int step = 0; step < numberOfSteps; ++step)
+  {
+    plane1->SetOrigin(step - numberOfSteps / 2, 0.0, 0.0);
+    clipFilter->Update();
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkIndexedClipFilter-TimePerUpdateMsec", timer->GetElapsedTime() / numberOfSteps * 1000.0);
+  CHECK_INT(vtkDataSet::SafeDownCast(clipFilter->GetOutputDataObject(0))->GetNumberOfCells(), expectedNumberOfCells);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkIndexedClipFilterTest1(int argc, char* argv[])
+{
+  // Sphere resolution used for measuring performance
+  int resolution = 500;
+  if (argc > 1)
+  {
+    resolution = atoi(argv[1]);
+  }
+  CHECK_EXIT_SUCCESS(TestClipResults(60));
+  CHECK_EXIT_SUCCESS(TestClipResults(200));
+  CHECK_EXIT_SUCCESS(TestClipStateCaching());
+  CHECK_EXIT_SUCCESS(TestClipPerformance(resolution));
+  return EXIT_SUCCESS;
+}
@@ -86,6 +86,82 @@ int GetVoxelCount(vtkImageData* labelmap, int labelValue)
   return accumulate->GetVoxelCount();
 }
 
+//----------------------------------------------------------------------------
+int TestCompressedStates()
+{
+  vtkNew<vtkOrientedImageData> labelmap;
+  int labelmapExtent[6] = { 0, 99, 0, 99, 0, 99 };
+  CreateCubeLabelmap(labelmap, labelmapExtent);
+  vtkNew<vtkSegment> segment;
+  segment->SetLabelValue(1);
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), labelmap);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->AddSegment(segment, "Segment_1");
+
+  vtkNew<vtkSegmentationHistory> history;
+  history->SetSegmentation(segmentation);
+  const int numberOfModifications = 10;
+  history->SetMaximumNumberOfStates(numberOfModifications + 1);
+  history->SaveState();
+  unsigned long fullStateMemoryUsage = history->GetMemoryUsage();
+
+  // Erase small regions and save state after each modification
+  std::vector<int> voxelCounts;
+  voxelCounts.push_back(GetVoxelCount(labelmap, 1));
+  for (int modificationIndex = 0; modificationIndex < numberOfModifications; ++modificationIndex)
+  {
+    vtkOrientedImageData* currentLabelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    int modifierExtent[6] = { modificationIndex * 10, modificationIndex * 10 + 4, 10, 14, 20, 24 };
+    vtkNew<vtkOrientedImageData> modifierLabelmap;
+    CreateCubeLabelmap(modifierLabelmap, modifierExtent);
+    vtkOrientedImageDataResample::ModifyImage(currentLabelmap, modifierLabelmap, vtkOrientedImageDataResample::OPERATION_MASKING,
+      nullptr, 0.0, 0.0);
+    history->SaveState();
+    voxelCounts.push_back(GetVoxelCount(currentLabelmap, 1));
+  }
+  CHECK_INT(history->GetNumberOfStates(), numberOfModifications + 1);
+
+  // Only the most recent state stores a full copy of the labelmap
+  unsigned long memoryUsage = history->GetMemoryUsage();
+  if (memoryUsage > fullStateMemoryUsage * 3 / 2)
+  {
+    std::cerr << "Memory usage of " << numberOfModifications + 1 << " states is " << memoryUsage
+      << " KiB, while a single state uses " << fullStateMemoryUsage << " KiB" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Undo all modifications
+  for (int stateIndex = numberOfModifications - 1; stateIndex >= 0; --stateIndex)
+  {
+    CHECK_INT(history->RestorePreviousState(), true);
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    CHECK_INT(GetVoxelCount(restoredLabelmap, 1), voxelCounts[stateIndex]);
+  }
+
+  // Redo all modifications
+  for (int stateIndex = 1; stateIndex <= numberOfModifications; ++stateIndex)
+  {
+    CHECK_INT(history->RestoreNextState(), true);
+    vtkOrientedImageData* restoredLabelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+    CHECK_INT(GetVoxelCount(restoredLabelmap, 1), voxelCounts[stateIndex]);
+  }
+
+  // Memory budget removes the oldest states.
+  // Budget of a single full state only allows keeping the most recent state.
+  history->SetMaximumMemoryUsage(fullStateMemoryUsage);
+  CHECK_INT(history->GetNumberOfStates(), 1);
+  if (history->GetMemoryUsage() > fullStateMemoryUsage)
+  {
+    std::cerr << "Memory budget is exceeded: " << history->GetMemoryUsage() << " KiB is used" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -243,6 +319,11 @@ int vtkSegmentationHistoryTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
   // restoring previous state saves the current modified state
   CHECK_INT(history->GetNumberOfStates(), 3);
 
+  if (TestCompressedStates() != EXIT_SUCCESS)
+  {
+    return EXIT_FAILURE;
+  }
+
   std::cout << "Segmentation history test 1 passed." << std::endl;
   return EXIT_SUCCESS;
 }
@@ -19,6 +19,8 @@
 ==============================================================================*/
 
 // VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkFeatureEdges.h>
 #include <vtkNew.h>
 #include <vtkVersion.h>
 #include <vtkPointData.h>
@@ -34,6 +36,7 @@
 #include "vtkOrientedImageData.h"
 #include "vtkOrientedImageDataResample.h"
 #include "vtkSegmentationConverterFactory.h"
+#include "vtkSegmentationModifier.h"
 #include "vtkBinaryLabelmapToClosedSurfaceConversionRule.h"
 #include "vtkClosedSurfaceToBinaryLabelmapConversionRule.h"
 
@@ -410,6 +413,227 @@ bool TestLabelmapValidation()
   return true;
 }
 
+//----------------------------------------------------------------------------
+void AbortConversionCallback(vtkObject* caller, unsigned long vtkNotUsed(eid), void* vtkNotUsed(clientData), void* callData)
+{
+  vtkSegmentation* segmentation = vtkSegmentation::SafeDownCast(caller);
+  double* progress = reinterpret_cast<double*>(callData);
+  if (segmentation && progress && *progress > 0.0)
+  {
+    segmentation->AbortConversionOn();
+  }
+}
+
+//----------------------------------------------------------------------------
+bool TestParallelClosedSurfaceConversion()
+{
+  // Create non-overlapping cubes, collapsed into one shared labelmap
+  const int numberOfSegments = 12;
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+  {
+    vtkNew<vtkOrientedImageData> cubeImage;
+    int extent[6] = { segmentIndex * 4, segmentIndex * 4 + 2, 0, 2, 0, 2 };
+    CreateCubeLabelmap(cubeImage, extent);
+    vtkNew<vtkSegment> segment;
+    segment->SetName(("cube" + std::to_string(segmentIndex)).c_str());
+    segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), cubeImage);
+    segmentation->AddSegment(segment);
+  }
+  segmentation->CollapseBinaryLabelmaps();
+  if (segmentation->GetNumberOfLayers() != 1)
+  {
+    std::cerr << "Invalid number of layers " << segmentation->GetNumberOfLayers() << " should be 1" << std::endl;
+    return false;
+  }
+
+  std::vector<std::string> segmentIDs;
+  segmentation->GetSegmentIDs(segmentIDs);
+  for (int jointSmoothing = 0; jointSmoothing <= 1; ++jointSmoothing)
+  {
+    segmentation->SetConversionParameter(
+      vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), std::to_string(jointSmoothing));
+
+    // Aborted conversion must not leave empty surfaces behind.
+    // Segments are converted in parallel, so some or all of them may be completed before the abort is processed.
+    segmentation->RemoveRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName());
+    vtkNew<vtkCallbackCommand> abortCallback;
+    abortCallback->SetCallback(AbortConversionCallback);
+    unsigned long observerTag = segmentation->AddObserver(vtkCommand::ProgressEvent, abortCallback);
+    bool conversionCompleted = segmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName());
+    segmentation->RemoveObserver(observerTag);
+    int numberOfConvertedSegments = 0;
+    for (const std::string& segmentID : segmentIDs)
+    {
+      vtkPolyData* surface = vtkPolyData::SafeDownCast(segmentation->GetSegment(segmentID)->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (!surface)
+      {
+        continue;
+      }
+      if (surface->GetNumberOfPoints() == 0)
+      {
+        std::cerr << "Empty surface found in " << segmentID << " after aborted conversion" << std::endl;
+        return false;
+      }
+      ++numberOfConvertedSegments;
+    }
+    if (conversionCompleted != (numberOfConvertedSegments == numberOfSegments))
+    {
+      std::cerr << "Conversion result does not match the number of converted segments: "
+        << numberOfConvertedSegments << " of " << numberOfSegments << std::endl;
+      return false;
+    }
+
+    // Complete conversion must create the same surface as converting the segments one by one
+    if (!segmentation->CreateRepresentation(vtkSegmentationConverter::GetClosedSurfaceRepresentationName(), true))
+    {
+      std::cerr << "Failed to create closed surface representation" << std::endl;
+      return false;
+    }
+    vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> rule;
+    rule->SetConversionParameter(
+      vtkBinaryLabelmapToClosedSurfaceConversionRule::GetJointSmoothingParameterName(), std::to_string(jointSmoothing));
+    for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+    {
+      vtkSegment* segment = segmentation->GetSegment(segmentIDs[segmentIndex]);
+      vtkPolyData* surface = vtkPolyData::SafeDownCast(segment->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (!surface || surface->GetNumberOfPoints() == 0)
+      {
+        std::cerr << "Missing surface in segment " << segmentIDs[segmentIndex] << std::endl;
+        return false;
+      }
+      double bounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+      surface->GetBounds(bounds);
+      if (bounds[0] < segmentIndex * 4 - 1.0 || bounds[1] > segmentIndex * 4 + 3.0)
+      {
+        std::cerr << "Surface of segment " << segmentIDs[segmentIndex] << " is at an invalid position" << std::endl;
+        return false;
+      }
+
+      vtkNew<vtkSegment> serialSegment;
+      serialSegment->SetLabelValue(segment->GetLabelValue());
+      serialSegment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(),
+        segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+      rule->Convert(serialSegment);
+      vtkPolyData* serialSurface = vtkPolyData::SafeDownCast(serialSegment->GetRepresentation(
+        vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+      if (!serialSurface || serialSurface->GetNumberOfPoints() != surface->GetNumberOfPoints()
+        || serialSurface->GetNumberOfCells() != surface->GetNumberOfCells())
+      {
+        std::cerr << "Surface of segment " << segmentIDs[segmentIndex] << " differs from serial conversion result" << std::endl;
+        return false;
+      }
+    }
+    rule->PostConvert(segmentation);
+  }
+
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool TestIncrementalClosedSurfaceConversion()
+{
+  vtkNew<vtkOrientedImageData> cubeImage;
+  int cubeExtent[6] = { 0, 79, 0, 79, 0, 79 };
+  CreateCubeLabelmap(cubeImage, cubeExtent);
+  vtkNew<vtkSegment> segment;
+  segment->SetName("cube");
+  segment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(), cubeImage);
+  vtkNew<vtkSegmentation> segmentation;
+  segmentation->SetSourceRepresentationName(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName());
+  segmentation->AddSegment(segment, "cube");
+
+  // Without smoothing the surface only depends on the voxels in the immediate neighborhood,
+  // therefore the modified region is small compared to the labelmap and it is updated incrementally.
+  vtkNew<vtkBinaryLabelmapToClosedSurfaceConversionRule> rule;
+  rule->SetConversionParameter(vtkBinaryLabelmapToClosedSurfaceConversionRule::GetSmoothingFactorParameterName(), "0.0");
+  rule->Convert(segment);
+
+  // Add a small bump on top of the cube
+  vtkNew<vtkOrientedImageData> modifierImage;
+  int modifierExtent[6] = { 36, 43, 36, 43, 76, 83 };
+  CreateCubeLabelmap(modifierImage, modifierExtent);
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  if (!vtkSegmentationModifier::ModifyBinaryLabelmap(modifierImage, segmentation, "cube", vtkSegmentationModifier::MODE_MERGE_MAX,
+    nullptr, false, false, {}, nullptr, modifiedExtent))
+  {
+    std::cerr << "Failed to modify segment" << std::endl;
+    return false;
+  }
+  for (int i = 0; i < 3; ++i)
+  {
+    if (modifiedExtent[2 * i] > modifierExtent[2 * i] || modifiedExtent[2 * i + 1] < modifierExtent[2 * i + 1])
+    {
+      std::cerr << "Modified extent does not contain the modifier labelmap extent" << std::endl;
+      return false;
+    }
+  }
+
+  // Surface updated in the modified region must match the surface converted from the entire labelmap
+  rule->ConvertModifiedRegion(segment, modifiedExtent);
+  vtkPolyData* surface = vtkPolyData::SafeDownCast(segment->GetRepresentation(
+    vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+  vtkNew<vtkSegment> referenceSegment;
+  referenceSegment->AddRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName(),
+    segment->GetRepresentation(vtkSegmentationConverter::GetBinaryLabelmapRepresentationName()));
+  rule->Convert(referenceSegment);
+  vtkPolyData* referenceSurface = vtkPolyData::SafeDownCast(referenceSegment->GetRepresentation(
+    vtkSegmentationConverter::GetClosedSurfaceRepresentationName()));
+  if (!surface || !referenceSurface || surface->GetNumberOfPoints() == 0)
+  {
+    std::cerr << "Missing surface after incremental update" << std::endl;
+    return false;
+  }
+  double bounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  surface->GetBounds(bounds);
+  double referenceBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  referenceSurface->GetBounds(referenceBounds);
+  for (int i = 0; i < 6; ++i)
+  {
+    if (fabs(bounds[i] - referenceBounds[i]) > 0.5)
+    {
+      std::cerr << "Incrementally updated surface bounds differ from full conversion result" << std::endl;
+      return false;
+    }
+  }
+  if (surface->GetNumberOfCells() != referenceSurface->GetNumberOfCells())
+  {
+    std::cerr << "Incrementally updated surface has " << surface->GetNumberOfCells() << " cells, full conversion result has "
+      << referenceSurface->GetNumberOfCells() << std::endl;
+    return false;
+  }
+
+  // Surface patch must be stitched into the existing surface without cracks
+  vtkNew<vtkFeatureEdges> boundaryEdges;
+  boundaryEdges->SetInputData(surface);
+  boundaryEdges->BoundaryEdgesOn();
+  boundaryEdges->FeatureEdgesOff();
+  boundaryEdges->NonManifoldEdgesOn();
+  boundaryEdges->ManifoldEdgesOff();
+  boundaryEdges->Update();
+  if (boundaryEdges->GetOutput()->GetNumberOfCells() != 0)
+  {
+    std::cerr << "Incrementally updated surface has " << boundaryEdges->GetOutput()->GetNumberOfCells()
+      << " boundary or non-manifold edges" << std::endl;
+    return false;
+  }
+
+  // Invalid modified extent means that the entire segment must be converted
+  int emptyExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  rule->ConvertModifiedRegion(segment, emptyExtent);
+  if (surface->GetNumberOfPoints() != referenceSurface->GetNumberOfPoints()
+    || surface->GetNumberOfCells() != referenceSurface->GetNumberOfCells())
+  {
+    std::cerr << "Full conversion result differs from reference surface" << std::endl;
+    return false;
+  }
+
+  return true;
+}
+
 //----------------------------------------------------------------------------
 int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
 {
@@ -449,6 +673,16 @@ int vtkSegmentationTest2(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
     return EXIT_FAILURE;
   }
 
+  if (!TestParallelClosedSurfaceConversion())
+  {
+    return EXIT_FAILURE;
+  }
+
+  if (!TestIncrementalClosedSurfaceConversion())
+  {
+    return EXIT_FAILURE;
+  }
+
   std::cout << "Segmentation test 2 passed." << std::endl;
   return EXIT_SUCCESS;
 }
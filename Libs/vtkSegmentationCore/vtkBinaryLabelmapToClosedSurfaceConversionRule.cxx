@@ -26,6 +26,7 @@
 #include "vtkOrientedImageDataResample.h"
 
 // VTK includes
+#include <vtkCommand.h>
 #include <vtkCompositeDataIterator.h>
 #include <vtkDecimatePro.h>
 #include <vtkDiscreteFlyingEdges3D.h>
@@ -45,6 +46,7 @@
 #include <vtkPolyDataNormals.h>
 #include <vtkSelection.h>
 #include <vtkSelectionNode.h>
+#include <vtkSMPTools.h>
 #include <vtkThreshold.h>
 #include <vtkTransform.h>
 #include <vtkTransformPolyDataFilter.h>
@@ -62,11 +64,142 @@
 #include <vtkInformation.h>
 #include <vtkExtractSelection.h>
 #include <vtkSelectionSource.h>
+#include <vtkCellArray.h>
+#include <vtkPointLocator.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
 
 //----------------------------------------------------------------------------
 const std::string vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_FLYING_EDGES = std::string("0");
 const std::string vtkBinaryLabelmapToClosedSurfaceConversionRule::CONVERSION_METHOD_SURFACE_NETS = std::string("1");
 
+//----------------------------------------------------------------------------
+namespace
+{
+/// Size of blocks of voxels that modified regions are aligned to
+const int MODIFIED_REGION_BRICK_SIZE = 16;
+
+//----------------------------------------------------------------------------
+int FloorDivide(int value, int divisor)
+{
+  return (value >= 0 ? value / divisor : -((-value + divisor - 1) / divisor));
+}
+
+//----------------------------------------------------------------------------
+/// Number of vtkWindowedSincPolyDataFilter iterations for a smoothing factor
+int GetWindowedSincNumberOfIterations(double smoothingFactor)
+{
+  return 20 + smoothingFactor * 40;
+}
+
+//----------------------------------------------------------------------------
+/// Number of surface nets internal smoothing iterations for a smoothing factor
+int GetSurfaceNetsNumberOfIterations(double smoothingFactor)
+{
+  // This formula maps (input) -> (iteration count)
+  // 0.0  ->  0   (almost no smoothing)
+  // 0.2  ->  2   (little smoothing)
+  // 0.5  ->  8   (average smoothing)
+  // 0.7  ->  14  (strong smoothing)
+  // 1.0  ->  24  (very strong smoothing)
+  double fCount = 15.0 * smoothingFactor * smoothingFactor + 9.0 * smoothingFactor;
+  return floor(fCount);
+}
+
+//----------------------------------------------------------------------------
+/// Returns true if all edges that have an endpoint on the seam are shared by exactly two cells,
+/// i.e., the surface patch and the existing surface are stitched without cracks.
+bool IsSeamClosed(vtkCellArray* polys, const std::vector<bool>& isSeamPoint)
+{
+  std::map<std::pair<vtkIdType, vtkIdType>, int> seamEdgeCellCounts;
+  vtkIdType numberOfCellPoints = 0;
+  const vtkIdType* cellPointIds = nullptr;
+  for (polys->InitTraversal(); polys->GetNextCell(numberOfCellPoints, cellPointIds);)
+  {
+    for (vtkIdType cellPointIndex = 0; cellPointIndex < numberOfCellPoints; ++cellPointIndex)
+    {
+      vtkIdType pointId1 = cellPointIds[cellPointIndex];
+      vtkIdType pointId2 = cellPointIds[(cellPointIndex + 1) % numberOfCellPoints];
+      if (!isSeamPoint[pointId1] && !isSeamPoint[pointId2])
+      {
+        continue;
+      }
+      ++seamEdgeCellCounts[std::make_pair(std::min(pointId1, pointId2), std::max(pointId1, pointId2))];
+    }
+  }
+  for (const auto& seamEdgeCellCount : seamEdgeCellCounts)
+  {
+    if (seamEdgeCellCount.second != 2)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Get point positions of the polydata in the IJK coordinate system of the labelmap
+void GetPointPositionsInImage(vtkPolyData* polyData, vtkMatrix4x4* worldToImageMatrix, std::vector<double>& pointPositions)
+{
+  vtkIdType numberOfPoints = polyData->GetNumberOfPoints();
+  pointPositions.resize(3 * numberOfPoints);
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    double position[4] = { 0.0, 0.0, 0.0, 1.0 };
+    polyData->GetPoint(pointId, position);
+    worldToImageMatrix->MultiplyPoint(position, position);
+    std::copy(position, position + 3, pointPositions.begin() + 3 * pointId);
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Returns true if the cell centroid is in the region. Region is defined by voxel extent,
+/// the centroid is in IJK coordinates.
+bool IsCellInRegion(vtkIdType numberOfCellPoints, const vtkIdType* cellPointIds,
+  const std::vector<double>& pointPositions, const int region[6])
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double centroid = 0.0;
+    for (vtkIdType cellPointIndex = 0; cellPointIndex < numberOfCellPoints; ++cellPointIndex)
+    {
+      centroid += pointPositions[3 * cellPointIds[cellPointIndex] + axis];
+    }
+    centroid /= numberOfCellPoints;
+    if (centroid < region[2 * axis] - 0.5 || centroid >= region[2 * axis + 1] + 0.5)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Returns true if the point is near the boundary of the region, where surfaces need to be stitched
+bool IsPointNearRegionBoundary(const double* pointPosition, const int region[6], double distance)
+{
+  bool inside = true;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double regionMin = region[2 * axis] - 0.5;
+    double regionMax = region[2 * axis + 1] + 0.5;
+    if (pointPosition[axis] < regionMin - distance || pointPosition[axis] > regionMax + distance)
+    {
+      return false;
+    }
+    if (pointPosition[axis] < regionMin + distance || pointPosition[axis] > regionMax - distance)
+    {
+      inside = false;
+    }
+  }
+  return !inside;
+}
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRuleNewMacro(vtkBinaryLabelmapToClosedSurfaceConversionRule);
 
@@ -173,57 +306,20 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
   {
     if (this->JointSmoothCache.find(orientedBinaryLabelmap) == this->JointSmoothCache.end())
     {
-      double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
-      int lowLabel = (int)(floor(scalarRange[0]));
-      int highLabel = (int)(ceil(scalarRange[1]));
-
-      vtkNew<vtkImageAccumulate> imageAccumulate;
-      imageAccumulate->SetInputData(orientedBinaryLabelmap);
-      imageAccumulate->IgnoreZeroOn();
-      imageAccumulate->SetComponentOrigin(0, 0, 0);
-      imageAccumulate->SetComponentSpacing(1, 1, 1);
-      imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
-      imageAccumulate->Update();
-
-      std::vector<int> labelValues;
-      for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
-      {
-        // Add a new threshold for every level in the labelmap
-        double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
-        if (numberOfVoxels > 0.0)
-        {
-          labelValues.push_back(labelValue);
-        }
-      }
-
+      std::vector<int> labelValues = this->GetLabelValuesInLabelmap(orientedBinaryLabelmap);
       vtkSmartPointer<vtkPolyData> jointSmoothedSurface = vtkSmartPointer<vtkPolyData>::New();
       this->CreateClosedSurface(orientedBinaryLabelmap, jointSmoothedSurface, labelValues);
       this->JointSmoothCache[orientedBinaryLabelmap] = jointSmoothedSurface;
     }
 
-    vtkDataObject* sharedSurface = this->JointSmoothCache[orientedBinaryLabelmap];
+    vtkPolyData* sharedSurface = this->JointSmoothCache[orientedBinaryLabelmap];
     if (!sharedSurface)
     {
       vtkErrorMacro("Convert: Could not find cached surface");
       return false;
     }
 
-    vtkNew<vtkSelectionSource> selection;
-    selection->SetContentType(vtkSelectionNode::THRESHOLDS);
-    selection->SetFieldType(vtkSelectionNode::POINT);
-    selection->GetContainingCells();
-    selection->AddThreshold(segment->GetLabelValue(), segment->GetLabelValue());
-
-    vtkNew<vtkExtractSelection> threshold;
-    threshold->SetInputData(sharedSurface);
-    threshold->SetSelectionConnection(selection->GetOutputPort());
-
-    vtkNew<vtkGeometryFilter> geometry;
-    geometry->SetInputConnection(threshold->GetOutputPort());
-    geometry->Update();
-
-    vtkPolyData* thresholdedSurface = geometry->GetOutput();
-    closedSurfacePolyData->ShallowCopy(thresholdedSurface);
+    this->ExtractSegmentSurface(sharedSurface, segment->GetLabelValue(), closedSurfacePolyData);
   }
   else
   {
@@ -242,27 +338,485 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::Convert(vtkSegment* segment
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::ConvertSegments(vtkSegmentation* segmentation, const std::vector<vtkSegment*>& segments)
+{
+  if (segments.empty())
+  {
+    return true;
+  }
+
+  double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
+  bool jointSmoothing = (this->ConversionParameters->GetValueAsInt(GetJointSmoothingParameterName()) > 0 && smoothingFactor > 0);
+
+  // Group segments into independent conversion jobs: one job per segment, or one job per
+  // shared labelmap if joint smoothing is enabled (all segments of the labelmap are smoothed together).
+  // Segments in a shared labelmap reference the same image object, therefore each job gets
+  // its own shallow copy of the image so that pipelines in different threads do not share data objects.
+  std::vector<SurfaceConversionJob> jobs;
+  std::map<vtkOrientedImageData*, size_t> jointSmoothingJobIndices;
+  std::set<vtkOrientedImageData*> sourceLabelmaps;
+  for (vtkSegment* segment : segments)
+  {
+    vtkOrientedImageData* orientedBinaryLabelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(this->GetSourceRepresentationName()));
+    if (!orientedBinaryLabelmap)
+    {
+      vtkErrorMacro("ConvertSegments: Source representation is not oriented image data");
+      continue;
+    }
+    if (vtkOrientedImageDataResample::IsImageScalarTypeValid(orientedBinaryLabelmap) != vtkOrientedImageDataResample::TYPE_OK)
+    {
+      vtkErrorMacro("ConvertSegments: Source representation scalar type is not a valid integer type");
+      continue;
+    }
+    if (sourceLabelmaps.insert(orientedBinaryLabelmap).second)
+    {
+      // Scalar range is cached in the scalar array, compute it before the array is accessed from multiple threads
+      orientedBinaryLabelmap->GetScalarRange();
+    }
+
+    if (jointSmoothing)
+    {
+      auto jobIndexIt = jointSmoothingJobIndices.find(orientedBinaryLabelmap);
+      if (jobIndexIt != jointSmoothingJobIndices.end())
+      {
+        jobs[jobIndexIt->second].Segments.push_back(segment);
+        continue;
+      }
+      jointSmoothingJobIndices[orientedBinaryLabelmap] = jobs.size();
+    }
+    SurfaceConversionJob job;
+    job.Labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+    job.Labelmap->ShallowCopy(orientedBinaryLabelmap);
+    job.Segments.push_back(segment);
+    jobs.push_back(job);
+  }
+
+  // Jobs are processed in batches, and progress is reported and abort requests are checked between batches,
+  // so that progress event observers are only called from the calling thread.
+  const size_t batchSize = 2 * static_cast<size_t>(vtkSMPTools::GetEstimatedNumberOfThreads());
+  size_t numberOfConvertedSegments = 0;
+  bool abortRequested = false;
+  for (size_t batchStart = 0; batchStart < jobs.size() && !abortRequested; batchStart += batchSize)
+  {
+    const size_t batchEnd = std::min(batchStart + batchSize, jobs.size());
+    vtkSMPTools::For(static_cast<vtkIdType>(batchStart), static_cast<vtkIdType>(batchEnd), 1,
+      [&](vtkIdType firstJob, vtkIdType lastJob)
+      {
+        for (vtkIdType jobIndex = firstJob; jobIndex < lastJob; ++jobIndex)
+        {
+          this->ConvertJob(jobs[jobIndex], jointSmoothing);
+        }
+      });
+    for (size_t jobIndex = batchStart; jobIndex < batchEnd; ++jobIndex)
+    {
+      if (!jobs[jobIndex].ErrorMessage.empty())
+      {
+        vtkErrorMacro("ConvertSegments: " << jobs[jobIndex].ErrorMessage);
+      }
+      numberOfConvertedSegments += jobs[jobIndex].Segments.size();
+    }
+    if (segmentation)
+    {
+      double progress = static_cast<double>(numberOfConvertedSegments) / segments.size();
+      segmentation->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+      abortRequested = segmentation->GetAbortConversion();
+    }
+  }
+
+  // Attach results to the segments
+  for (SurfaceConversionJob& job : jobs)
+  {
+    if (!job.Completed)
+    {
+      continue;
+    }
+    for (size_t segmentIndex = 0; segmentIndex < job.Segments.size(); ++segmentIndex)
+    {
+      vtkSegment* segment = job.Segments[segmentIndex];
+      this->CreateTargetRepresentation(segment);
+      vtkPolyData* closedSurfacePolyData = vtkPolyData::SafeDownCast(
+        segment->GetRepresentation(this->GetTargetRepresentationName()));
+      if (!closedSurfacePolyData)
+      {
+        vtkErrorMacro("ConvertSegments: Target representation is not poly data");
+        continue;
+      }
+      closedSurfacePolyData->ShallowCopy(job.Surfaces[segmentIndex]);
+    }
+  }
+
+  if (numberOfConvertedSegments < segments.size() && abortRequested)
+  {
+    return false;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+bool vtkBinaryLabelmapToClosedSurfaceConversionRule::ConvertModifiedRegion(vtkSegment* segment, const int modifiedExtent[6])
+{
+  vtkOrientedImageData* orientedBinaryLabelmap = vtkOrientedImageData::SafeDownCast(
+    segment->GetRepresentation(this->GetSourceRepresentationName()));
+  vtkPolyData* closedSurfacePolyData = vtkPolyData::SafeDownCast(
+    segment->GetRepresentation(this->GetTargetRepresentationName()));
+
+  double decimationFactor = this->ConversionParameters->GetValueAsDouble(GetDecimationFactorParameterName());
+  double smoothingFactor = this->ConversionParameters->GetValueAsDouble(GetSmoothingFactorParameterName());
+  bool jointSmoothing = (this->ConversionParameters->GetValueAsInt(GetJointSmoothingParameterName()) > 0 && smoothingFactor > 0);
+
+  // Decimation and joint smoothing depend on the entire surface, therefore in those cases
+  // (and if there is no existing surface to update) full conversion is needed.
+  if (!modifiedExtent || !orientedBinaryLabelmap || !closedSurfacePolyData || this->ReplaceTargetRepresentation
+    || decimationFactor > 0.0 || jointSmoothing || orientedBinaryLabelmap->IsEmpty()
+    || closedSurfacePolyData->GetNumberOfPolys() == 0 || closedSurfacePolyData->GetNumberOfCells() != closedSurfacePolyData->GetNumberOfPolys()
+    || modifiedExtent[0] > modifiedExtent[1] || modifiedExtent[2] > modifiedExtent[3] || modifiedExtent[4] > modifiedExtent[5]
+    || vtkOrientedImageDataResample::IsImageScalarTypeValid(orientedBinaryLabelmap) != vtkOrientedImageDataResample::TYPE_OK)
+  {
+    return this->Convert(segment);
+  }
+
+  // Smoothing computes each point position from the points in its neighborhood, repeatedly,
+  // therefore the surface within this many voxels of a modified voxel may change, and the surface
+  // generated from a cropped labelmap differs from the full conversion result within this many voxels
+  // of the crop boundary (each iteration reaches at most one voxel further).
+  int smoothingRadius = 1;
+  std::string conversionMethod = this->ConversionParameters->GetValue(GetConversionMethodParameterName());
+  if (conversionMethod == CONVERSION_METHOD_SURFACE_NETS
+    && this->ConversionParameters->GetValueAsInt(GetSurfaceNetInternalSmoothingParameterName()) == 1)
+  {
+    smoothingRadius += GetSurfaceNetsNumberOfIterations(smoothingFactor);
+  }
+  else if (smoothingFactor > 0)
+  {
+    smoothingRadius += GetWindowedSincNumberOfIterations(smoothingFactor);
+  }
+
+  // Region where the surface is regenerated: the modified region is expanded by the smoothing radius
+  // and aligned to bricks, so that consecutive edits in the same area reuse the same seam locations.
+  // The surface is generated from a crop that is larger than the region by the smoothing radius,
+  // therefore inside the region the patch matches the full conversion result.
+  int region[6] = { 0, -1, 0, -1, 0, -1 };
+  int cropExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  int* labelmapExtent = orientedBinaryLabelmap->GetExtent();
+  double regionVoxelCount = 1.0;
+  double labelmapVoxelCount = 1.0;
+  const int margin = smoothingRadius + 2;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    region[2 * axis] = FloorDivide(modifiedExtent[2 * axis] - margin, MODIFIED_REGION_BRICK_SIZE) * MODIFIED_REGION_BRICK_SIZE;
+    region[2 * axis + 1] = (FloorDivide(modifiedExtent[2 * axis + 1] + margin, MODIFIED_REGION_BRICK_SIZE) + 1) * MODIFIED_REGION_BRICK_SIZE - 1;
+    cropExtent[2 * axis] = region[2 * axis] - margin;
+    cropExtent[2 * axis + 1] = region[2 * axis + 1] + margin;
+    regionVoxelCount *= region[2 * axis + 1] - region[2 * axis] + 1;
+    labelmapVoxelCount *= labelmapExtent[2 * axis + 1] - labelmapExtent[2 * axis] + 1;
+  }
+  if (regionVoxelCount > 0.5 * labelmapVoxelCount)
+  {
+    // Large part of the labelmap changed, full conversion is not much slower
+    return this->Convert(segment);
+  }
+
+  // Generate surface patch from the labelmap around the modified region
+  vtkNew<vtkPolyData> patchPolyData;
+  bool regionOverlapsLabelmap = true;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    if (cropExtent[2 * axis] > labelmapExtent[2 * axis + 1] || cropExtent[2 * axis + 1] < labelmapExtent[2 * axis])
+    {
+      regionOverlapsLabelmap = false;
+    }
+  }
+  if (regionOverlapsLabelmap)
+  {
+    // Voxels outside the labelmap extent are filled with background
+    vtkNew<vtkImageConstantPad> padder;
+    padder->SetInputData(orientedBinaryLabelmap);
+    padder->SetConstant(0);
+    padder->SetOutputWholeExtent(cropExtent);
+    padder->Update();
+    vtkNew<vtkOrientedImageData> croppedLabelmap;
+    croppedLabelmap->ShallowCopy(padder->GetOutput());
+    croppedLabelmap->CopyDirections(orientedBinaryLabelmap);
+    std::vector<int> labelValue = { segment->GetLabelValue() };
+    if (!this->CreateClosedSurface(croppedLabelmap, patchPolyData, labelValue))
+    {
+      return this->Convert(segment);
+    }
+  }
+
+  vtkNew<vtkMatrix4x4> worldToImageMatrix;
+  orientedBinaryLabelmap->GetWorldToImageMatrix(worldToImageMatrix);
+  std::vector<double> existingPointPositions;
+  GetPointPositionsInImage(closedSurfacePolyData, worldToImageMatrix, existingPointPositions);
+  std::vector<double> patchPointPositions;
+  GetPointPositionsInImage(patchPolyData, worldToImageMatrix, patchPointPositions);
+
+  vtkNew<vtkPoints> points;
+  points->SetDataType(closedSurfacePolyData->GetPoints()->GetDataType());
+  vtkNew<vtkCellArray> polys;
+  vtkDataArray* existingNormals = closedSurfacePolyData->GetPointData()->GetNormals();
+  vtkDataArray* patchNormals = patchPolyData->GetPointData()->GetNormals();
+  vtkSmartPointer<vtkFloatArray> normals;
+  if (existingNormals && (patchNormals || patchPolyData->GetNumberOfPoints() == 0))
+  {
+    normals = vtkSmartPointer<vtkFloatArray>::New();
+    normals->SetName(existingNormals->GetName());
+    normals->SetNumberOfComponents(3);
+  }
+
+  // Points near the boundary of the region, where the surfaces are stitched
+  std::vector<bool> isSeamOutputPoint;
+
+  // Keep cells of the existing surface outside the region
+  std::vector<vtkIdType> existingToOutputPointIds(closedSurfacePolyData->GetNumberOfPoints(), -1);
+  std::vector<vtkIdType> outputCellPointIds;
+  vtkCellArray* existingPolys = closedSurfacePolyData->GetPolys();
+  vtkIdType numberOfCellPoints = 0;
+  const vtkIdType* cellPointIds = nullptr;
+  for (existingPolys->InitTraversal(); existingPolys->GetNextCell(numberOfCellPoints, cellPointIds);)
+  {
+    if (numberOfCellPoints == 0 || IsCellInRegion(numberOfCellPoints, cellPointIds, existingPointPositions, region))
+    {
+      continue;
+    }
+    outputCellPointIds.resize(numberOfCellPoints);
+    for (vtkIdType cellPointIndex = 0; cellPointIndex < numberOfCellPoints; ++cellPointIndex)
+    {
+      vtkIdType pointId = cellPointIds[cellPointIndex];
+      if (existingToOutputPointIds[pointId] < 0)
+      {
+        existingToOutputPointIds[pointId] = points->InsertNextPoint(closedSurfacePolyData->GetPoint(pointId));
+        isSeamOutputPoint.push_back(false);
+        if (normals)
+        {
+          normals->InsertNextTuple(existingNormals->GetTuple(pointId));
+        }
+      }
+      outputCellPointIds[cellPointIndex] = existingToOutputPointIds[pointId];
+    }
+    polys->InsertNextCell(numberOfCellPoints, outputCellPointIds.data());
+  }
+
+  // Points of the existing surface along the seam, which new points are merged with
+  const double seamDistance = 1.5;
+  vtkNew<vtkPoints> seamPoints;
+  std::vector<vtkIdType> seamPointOutputIds;
+  for (vtkIdType pointId = 0; pointId < static_cast<vtkIdType>(existingToOutputPointIds.size()); ++pointId)
+  {
+    if (existingToOutputPointIds[pointId] >= 0
+      && IsPointNearRegionBoundary(&existingPointPositions[3 * pointId], region, seamDistance))
+    {
+      seamPoints->InsertNextPoint(closedSurfacePolyData->GetPoint(pointId));
+      seamPointOutputIds.push_back(existingToOutputPointIds[pointId]);
+      isSeamOutputPoint[existingToOutputPointIds[pointId]] = true;
+    }
+  }
+  vtkNew<vtkPolyData> seamPolyData;
+  seamPolyData->SetPoints(seamPoints);
+  vtkNew<vtkPointLocator> seamPointLocator;
+  if (seamPoints->GetNumberOfPoints() > 0)
+  {
+    seamPointLocator->SetDataSet(seamPolyData);
+    seamPointLocator->BuildLocator();
+  }
+  double* spacing = orientedBinaryLabelmap->GetSpacing();
+  const double mergeTolerance = 0.3 * std::min(spacing[0], std::min(spacing[1], spacing[2]));
+
+  // Add cells of the new surface inside the region
+  std::vector<vtkIdType> patchToOutputPointIds(patchPolyData->GetNumberOfPoints(), -1);
+  vtkCellArray* patchPolys = patchPolyData->GetPolys();
+  for (patchPolys->InitTraversal(); patchPolys->GetNextCell(numberOfCellPoints, cellPointIds);)
+  {
+    if (numberOfCellPoints == 0 || !IsCellInRegion(numberOfCellPoints, cellPointIds, patchPointPositions, region))
+    {
+      continue;
+    }
+    outputCellPointIds.resize(numberOfCellPoints);
+    for (vtkIdType cellPointIndex = 0; cellPointIndex < numberOfCellPoints; ++cellPointIndex)
+    {
+      vtkIdType pointId = cellPointIds[cellPointIndex];
+      if (patchToOutputPointIds[pointId] < 0)
+      {
+        double* position = patchPolyData->GetPoint(pointId);
+        bool nearSeam = IsPointNearRegionBoundary(&patchPointPositions[3 * pointId], region, seamDistance);
+        if (seamPoints->GetNumberOfPoints() > 0 && nearSeam)
+        {
+          double distance2 = 0.0;
+          vtkIdType seamPointId = seamPointLocator->FindClosestPointWithinRadius(mergeTolerance, position, distance2);
+          if (seamPointId >= 0)
+          {
+            patchToOutputPointIds[pointId] = seamPointOutputIds[seamPointId];
+          }
+        }
+        if (patchToOutputPointIds[pointId] < 0)
+        {
+          patchToOutputPointIds[pointId] = points->InsertNextPoint(position);
+          isSeamOutputPoint.push_back(nearSeam);
+          if (normals)
+          {
+            normals->InsertNextTuple(patchNormals->GetTuple(pointId));
+          }
+        }
+      }
+      outputCellPointIds[cellPointIndex] = patchToOutputPointIds[pointId];
+    }
+    // Skip cells that became degenerate by merging points
+    std::vector<vtkIdType> uniqueCellPointIds(outputCellPointIds);
+    std::sort(uniqueCellPointIds.begin(), uniqueCellPointIds.end());
+    if (std::unique(uniqueCellPointIds.begin(), uniqueCellPointIds.end()) != uniqueCellPointIds.end())
+    {
+      continue;
+    }
+    polys->InsertNextCell(numberOfCellPoints, outputCellPointIds.data());
+  }
+
+  if (polys->GetNumberOfCells() == 0)
+  {
+    closedSurfacePolyData->Initialize();
+    return true;
+  }
+  if (!IsSeamClosed(polys, isSeamOutputPoint))
+  {
+    // Surfaces could not be stitched without cracks (for example, the existing surface was not generated
+    // with the current conversion parameters), regenerate the entire surface instead
+    vtkDebugMacro("ConvertModifiedRegion: surface patch could not be stitched, performing full conversion");
+    return this->Convert(segment);
+  }
+  vtkNew<vtkPolyData> updatedPolyData;
+  updatedPolyData->SetPoints(points);
+  updatedPolyData->SetPolys(polys);
+  if (normals)
+  {
+    updatedPolyData->GetPointData()->SetNormals(normals);
+  }
+  closedSurfacePolyData->ShallowCopy(updatedPolyData);
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::ConvertJob(SurfaceConversionJob& job, bool jointSmoothing)
+{
+  job.Surfaces.clear();
+  job.ErrorMessage.clear();
+  bool success = true;
+  if (jointSmoothing)
+  {
+    std::vector<int> labelValues = this->GetLabelValuesInLabelmap(job.Labelmap);
+    vtkNew<vtkPolyData> jointSmoothedSurface;
+    success = this->CreateClosedSurface(job.Labelmap, jointSmoothedSurface, labelValues, &job.ErrorMessage);
+    for (vtkSegment* segment : job.Segments)
+    {
+      vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+      this->ExtractSegmentSurface(jointSmoothedSurface, segment->GetLabelValue(), surface);
+      job.Surfaces.push_back(surface);
+    }
+  }
+  else
+  {
+    for (vtkSegment* segment : job.Segments)
+    {
+      vtkSmartPointer<vtkPolyData> surface = vtkSmartPointer<vtkPolyData>::New();
+      std::vector<int> labelValue = { segment->GetLabelValue() };
+      success = this->CreateClosedSurface(job.Labelmap, surface, labelValue, &job.ErrorMessage) && success;
+      job.Surfaces.push_back(surface);
+    }
+  }
+
+  // Remove "ImageScalars" array (see Convert)
+  for (vtkPolyData* surface : job.Surfaces)
+  {
+    vtkPointData* pointData = surface->GetPointData();
+    if (pointData != nullptr)
+    {
+      pointData->RemoveArray("ImageScalars");
+    }
+  }
+  job.Completed = success;
+}
+
+//----------------------------------------------------------------------------
+std::vector<int> vtkBinaryLabelmapToClosedSurfaceConversionRule::GetLabelValuesInLabelmap(vtkOrientedImageData* orientedBinaryLabelmap)
+{
+  double* scalarRange = orientedBinaryLabelmap->GetScalarRange();
+  int lowLabel = (int)(floor(scalarRange[0]));
+  int highLabel = (int)(ceil(scalarRange[1]));
+
+  vtkNew<vtkImageAccumulate> imageAccumulate;
+  imageAccumulate->SetInputData(orientedBinaryLabelmap);
+  imageAccumulate->IgnoreZeroOn();
+  imageAccumulate->SetComponentOrigin(0, 0, 0);
+  imageAccumulate->SetComponentSpacing(1, 1, 1);
+  imageAccumulate->SetComponentExtent(lowLabel, highLabel, 0, 0, 0, 0);
+  imageAccumulate->Update();
+
+  std::vector<int> labelValues;
+  for (int labelValue = lowLabel; labelValue <= highLabel; ++labelValue)
+  {
+    // Add a new threshold for every level in the labelmap
+    double numberOfVoxels = imageAccumulate->GetOutput()->GetPointData()->GetScalars()->GetTuple1((int)labelValue - lowLabel);
+    if (numberOfVoxels > 0.0)
+    {
+      labelValues.push_back(labelValue);
+    }
+  }
+  return labelValues;
+}
+
+//----------------------------------------------------------------------------
+void vtkBinaryLabelmapToClosedSurfaceConversionRule::ExtractSegmentSurface(vtkPolyData* jointSurface, int labelValue, vtkPolyData* segmentSurface)
+{
+  vtkNew<vtkSelectionSource> selection;
+  selection->SetContentType(vtkSelectionNode::THRESHOLDS);
+  selection->SetFieldType(vtkSelectionNode::POINT);
+  selection->GetContainingCells();
+  selection->AddThreshold(labelValue, labelValue);
+
+  vtkNew<vtkExtractSelection> threshold;
+  threshold->SetInputData(jointSurface);
+  threshold->SetSelectionConnection(selection->GetOutputPort());
+
+  vtkNew<vtkGeometryFilter> geometry;
+  geometry->SetInputConnection(threshold->GetOutputPort());
+  geometry->Update();
+
+  segmentSurface->ShallowCopy(geometry->GetOutput());
+}
+
 //----------------------------------------------------------------------------
 bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrientedImageData* orientedBinaryLabelmap,
-  vtkPolyData* closedSurfacePolyData, std::vector<int> labelValues)
+  vtkPolyData* closedSurfacePolyData, std::vector<int> labelValues, std::string* errorMessage/*=nullptr*/)
 {
+  auto reportError = [this, errorMessage](const std::string& message)
+  {
+    if (errorMessage)
+    {
+      *errorMessage += (errorMessage->empty() ? "" : "\n") + message;
+    }
+    else
+    {
+      vtkErrorMacro(<< message);
+    }
+  };
+
   if (!closedSurfacePolyData)
   {
-    vtkErrorMacro("Convert: Target representation is not poly data");
+    reportError("Convert: Target representation is not poly data");
     return false;
   }
 
   // Check validity of source and target representation objects
   if (!orientedBinaryLabelmap)
   {
-    vtkErrorMacro("Convert: Source representation is not oriented image data");
+    reportError("Convert: Source representation is not oriented image data");
     return false;
   }
 
   vtkSmartPointer<vtkImageData> binaryLabelmap = orientedBinaryLabelmap;
   if (!binaryLabelmap)
   {
-    vtkErrorMacro("Convert: Source representation is not data");
+    reportError("Convert: Source representation is not data");
     return false;
   }
 
@@ -335,7 +889,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     }
     catch (...)
     {
-      vtkErrorMacro("Convert: Error while running flying edges!");
+      reportError("Convert: Error while running flying edges!");
       return false;
     }
     processingResult = flyingEdges->GetOutput();
@@ -352,15 +906,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     {
       surfaceNets->SmoothingOn();
 
-      // This formula maps (input) -> (iteration count)
-      // 0.0  ->  0   (almost no smoothing)
-      // 0.2  ->  2   (little smoothing)
-      // 0.5  ->  8   (average smoothing)
-      // 0.7  ->  14  (strong smoothing)
-      // 1.0  ->  24  (very strong smoothing)
-      double fCount = 15.0 * smoothingFactor * smoothingFactor + 9.0 * smoothingFactor;
-      int iterationCount = floor(fCount);
-      surfaceNets->SetNumberOfIterations(iterationCount);
+      surfaceNets->SetNumberOfIterations(GetSurfaceNetsNumberOfIterations(smoothingFactor));
     }
 
     int valueIndex = 0;
@@ -376,14 +922,14 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     }
     catch (...)
     {
-      vtkErrorMacro("Convert: Error while running surface nets!");
+      reportError("Convert: Error while running surface nets!");
       return false;
     }
     processingResult = surfaceNets->GetOutput();
   }
   else
   {
-    vtkErrorMacro("Conversion Rule: Unknown surface generation method");
+    reportError("Conversion Rule: Unknown surface generation method");
   }
 
   vtkSmartPointer<vtkPolyData> convertedSegment = vtkSmartPointer<vtkPolyData>::New();
@@ -432,7 +978,7 @@ bool vtkBinaryLabelmapToClosedSurfaceConversionRule::CreateClosedSurface(vtkOrie
     //     1.0  (very strong smoothing, shrinks)   ->   0.0001       60
     //
     double passBand = pow(10.0, -4.0 * smoothingFactor);
-    int numberOfIterations = 20 + smoothingFactor * 40;
+    int numberOfIterations = GetWindowedSincNumberOfIterations(smoothingFactor);
 
     smoother->SetNumberOfIterations(numberOfIterations);
     smoother->SetPassBand(passBand);
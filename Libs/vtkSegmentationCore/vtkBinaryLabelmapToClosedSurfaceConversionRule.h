@@ -24,6 +24,7 @@
 // SegmentationCore includes
 #include "vtkSegmentationConverterRule.h"
 #include "vtkSegmentationConverter.h"
+#include "vtkOrientedImageData.h"
 
 #include "vtkSegmentationCoreConfigure.h"
 
@@ -75,11 +76,26 @@ public:
   vtkDataObject* ConstructRepresentationObjectByClass(std::string className) override;
 
   /// Perform the actual binary labelmap to closed surface conversion
-  bool CreateClosedSurface(vtkOrientedImageData* inputImage, vtkPolyData* outputPolydata, std::vector<int> values);
+  /// \param errorMessage If specified then errors are returned in this string instead of being logged.
+  ///   It allows calling the method from worker threads and reporting the errors from the calling thread.
+  bool CreateClosedSurface(vtkOrientedImageData* inputImage, vtkPolyData* outputPolydata, std::vector<int> values,
+    std::string* errorMessage = nullptr);
 
   /// Update the target representation based on the source representation
   bool Convert(vtkSegment* segment) override;
 
+  /// Update the target representation of multiple segments.
+  /// Segments are converted in parallel, using all available processor cores.
+  bool ConvertSegments(vtkSegmentation* segmentation, const std::vector<vtkSegment*>& segments) override;
+
+  /// Update the target representation after the labelmap was changed in a small region.
+  /// Surface is only regenerated in the modified region (expanded by the smoothing radius and to whole
+  /// bricks of voxels) and stitched into the existing surface. The patch is generated from a labelmap crop
+  /// that is larger than the region by the smoothing radius, so along the seam its points match the points
+  /// of the existing surface and they are merged. If any crack remains, the entire surface is regenerated.
+  /// Full conversion is performed if decimation or joint smoothing is enabled or the region is large.
+  bool ConvertModifiedRegion(vtkSegment* segment, const int modifiedExtent[6]) override;
+
   /// Perform postprocessing steps on the output
   /// Clears the joint smoothing cache
   bool PostConvert(vtkSegmentation* segmentation) override;
@@ -101,6 +117,27 @@ protected:
   /// This function checks whether this is the case.
   bool IsLabelmapPaddingNecessary(vtkImageData* binaryLabelMap);
 
+  /// Get all non-zero label values that occur in the labelmap.
+  std::vector<int> GetLabelValuesInLabelmap(vtkOrientedImageData* orientedBinaryLabelmap);
+
+  /// Extract the surface of a single segment from a jointly smoothed surface.
+  void ExtractSegmentSurface(vtkPolyData* jointSurface, int labelValue, vtkPolyData* segmentSurface);
+
+  /// Surfaces created from one labelmap in a single thread
+  struct SurfaceConversionJob
+  {
+    vtkSmartPointer<vtkOrientedImageData> Labelmap;
+    std::vector<vtkSegment*> Segments;
+    std::vector<vtkSmartPointer<vtkPolyData> > Surfaces;
+    bool Completed{ false };
+    /// Errors that occurred during the conversion, reported after all jobs are finished
+    std::string ErrorMessage;
+  };
+
+  /// Create surfaces for all segments of a job. It may be called from any thread,
+  /// as it does not modify the rule or the segments and it does not log errors.
+  void ConvertJob(SurfaceConversionJob& job, bool jointSmoothing);
+
 protected:
   vtkBinaryLabelmapToClosedSurfaceConversionRule();
   ~vtkBinaryLabelmapToClosedSurfaceConversionRule() override;
@@ -0,0 +1,1480 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// SegmentationCore includes
+#include "vtkIndexedClipFilter.h"
+
+// VTK includes
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkClipDataSet.h>
+#include <vtkClipPolyData.h>
+#include <vtkDoubleArray.h>
+#include <vtkExtractCells.h>
+#include <vtkGeneralTransform.h>
+#include <vtkHomogeneousTransform.h>
+#include <vtkIdList.h>
+#include <vtkImplicitBoolean.h>
+#include <vtkImplicitFunctionCollection.h>
+#include <vtkInformation.h>
+#include <vtkInformationVector.h>
+#include <vtkMatrix4x4.h>
+#include <vtkObjectFactory.h>
+#include <vtkPlane.h>
+#include <vtkPlanes.h>
+#include <vtkPointData.h>
+#include <vtkPolyData.h>
+#include <vtkSMPTools.h>
+#include <vtkTransform.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkWeakPointer.h>
+
+// STD includes
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <stack>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const char ClipValuesArrayName[] = "vtkIndexedClipFilterValues";
+
+//----------------------------------------------------------------------------
+/// Call function for consecutive sub-ranges of [0, numberOfItems) using vtkSMPTools.
+/// If numberOfThreads is 1 then the function is called on the current thread.
+void SMPFor(vtkIdType numberOfItems, int numberOfThreads, const std::function<void(vtkIdType, vtkIdType)>& function)
+{
+  if (numberOfItems <= 0)
+  {
+    return;
+  }
+  // Dispatching to other threads takes longer than processing a few thousand items
+  const vtkIdType grain = 4096;
+  if (numberOfThreads == 1 || numberOfItems <= grain)
+  {
+    function(0, numberOfItems);
+    return;
+  }
+  vtkSMPTools::For(0, numberOfItems, grain, function);
+}
+
+//----------------------------------------------------------------------------
+/// Clip function converted to linear functions combined by boolean operations.
+/// Evaluation has no side effects, therefore it can be called from multiple threads.
+struct ClipFunctionNode
+{
+  enum NodeType
+  {
+    LinearNode,
+    BooleanNode
+  };
+  NodeType Type{ LinearNode };
+  /// Value of a linear node is Coefficients[0]*x + Coefficients[1]*y + Coefficients[2]*z + Coefficients[3]
+  double Coefficients[4] = { 0.0, 0.0, 0.0, 0.0 };
+  /// Operation of a boolean node, same as in vtkImplicitBoolean
+  int OperationType{ vtkImplicitBoolean::VTK_UNION };
+  bool Invert{ false };
+  std::vector<ClipFunctionNode> Children;
+
+  double Evaluate(const double x[3]) const
+  {
+    if (this->Type == LinearNode)
+    {
+      return this->Coefficients[0] * x[0] + this->Coefficients[1] * x[1] + this->Coefficients[2] * x[2] + this->Coefficients[3];
+    }
+    double value = 0.0;
+    if (!this->Children.empty())
+    {
+      switch (this->OperationType)
+      {
+        case vtkImplicitBoolean::VTK_INTERSECTION:
+          value = -VTK_DOUBLE_MAX;
+          for (const ClipFunctionNode& child : this->Children)
+          {
+            value = std::max(value, child.Evaluate(x));
+          }
+          break;
+        case vtkImplicitBoolean::VTK_UNION_OF_MAGNITUDES:
+          value = VTK_DOUBLE_MAX;
+          for (const ClipFunctionNode& child : this->Children)
+          {
+            value = std::min(value, std::fabs(child.Evaluate(x)));
+          }
+          break;
+        case vtkImplicitBoolean::VTK_DIFFERENCE:
+          value = this->Children[0].Evaluate(x);
+          for (size_t childIndex = 1; childIndex < this->Children.size(); ++childIndex)
+          {
+            value = std::max(value, -this->Children[childIndex].Evaluate(x));
+          }
+          break;
+        case vtkImplicitBoolean::VTK_UNION:
+        default:
+          value = VTK_DOUBLE_MAX;
+          for (const ClipFunctionNode& child : this->Children)
+          {
+            value = std::min(value, child.Evaluate(x));
+          }
+          break;
+      }
+    }
+    return this->Invert ? -value : value;
+  }
+
+  /// Compute a range that contains all function values within the axis-aligned box.
+  /// The range is exact for linear nodes and conservative for boolean nodes.
+  void EvaluateRange(const double bounds[6], double range[2]) const
+  {
+    if (this->Type == LinearNode)
+    {
+      range[0] = this->Coefficients[3];
+      range[1] = this->Coefficients[3];
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        double valueAtMin = this->Coefficients[axis] * bounds[axis * 2];
+        double valueAtMax = this->Coefficients[axis] * bounds[axis * 2 + 1];
+        range[0] += std::min(valueAtMin, valueAtMax);
+        range[1] += std::max(valueAtMin, valueAtMax);
+      }
+      return;
+    }
+    range[0] = 0.0;
+    range[1] = 0.0;
+    if (!this->Children.empty())
+    {
+      double childRange[2] = { 0.0, 0.0 };
+      switch (this->OperationType)
+      {
+        case vtkImplicitBoolean::VTK_INTERSECTION:
+          range[0] = -VTK_DOUBLE_MAX;
+          range[1] = -VTK_DOUBLE_MAX;
+          for (const ClipFunctionNode& child : this->Children)
+          {
+            child.EvaluateRange(bounds, childRange);
+            range[0] = std::max(range[0], childRange[0]);
+            range[1] = std::max(range[1], childRange[1]);
+          }
+          break;
+        case vtkImplicitBoolean::VTK_UNION_OF_MAGNITUDES:
+          range[0] = VTK_DOUBLE_MAX;
+          range[1] = VTK_DOUBLE_MAX;
+          for (const ClipFunctionNode& child : this->Children)
+          {
+            child.EvaluateRange(bounds, childRange);
+            double magnitudeMax = std::max(std::fabs(childRange[0]), std::fabs(childRange[1]));
+            double magnitudeMin = (childRange[0] <= 0.0 && childRange[1] >= 0.0) ? 0.0
+              : std::min(std::fabs(childRange[0]), std::fabs(childRange[1]));
+            range[0] = std::min(range[0], magnitudeMin);
+            range[1] = std::min(range[1], magnitudeMax);
+          }
+          break;
+        case vtkImplicitBoolean::VTK_DIFFERENCE:
+          this->Children[0].EvaluateRange(bounds, range);
+          for (size_t childIndex = 1; childIndex < this->Children.size(); ++childIndex)
+          {
+            this->Children[childIndex].EvaluateRange(bounds, childRange);
+            range[0] = std::max(range[0], -childRange[1]);
+            range[1] = std::max(range[1], -childRange[0]);
+          }
+          break;
+        case vtkImplicitBoolean::VTK_UNION:
+        default:
+          range[0] = VTK_DOUBLE_MAX;
+          range[1] = VTK_DOUBLE_MAX;
+          for (const ClipFunctionNode& child : this->Children)
+          {
+            child.EvaluateRange(bounds, childRange);
+            range[0] = std::min(range[0], childRange[0]);
+            range[1] = std::min(range[1], childRange[1]);
+          }
+          break;
+      }
+    }
+    if (this->Invert)
+    {
+      double invertedRange[2] = { -range[1], -range[0] };
+      range[0] = invertedRange[0];
+      range[1] = invertedRange[1];
+    }
+  }
+
+  /// Append all parameters of the function. Two functions produce the same clipping
+  /// result if their signatures are the same.
+  void AppendSignature(std::vector<double>& signature) const
+  {
+    signature.push_back(this->Type);
+    if (this->Type == LinearNode)
+    {
+      signature.insert(signature.end(), this->Coefficients, this->Coefficients + 4);
+      return;
+    }
+    signature.push_back(this->OperationType);
+    signature.push_back(this->Invert ? 1.0 : 0.0);
+    signature.push_back(static_cast<double>(this->Children.size()));
+    for (const ClipFunctionNode& child : this->Children)
+    {
+      child.AppendSignature(signature);
+    }
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Set the Invert flag of a converted boolean node so that it gives the same values as the function.
+/// worldToParent maps points to the coordinate system where the function is evaluated.
+/// Returns false if the values are different, regardless of inversion.
+bool DetectClipFunctionInversion(vtkImplicitFunction* function, vtkMatrix4x4* worldToParent, ClipFunctionNode& node)
+{
+  const double testPoints[5][3] =
+  {
+    { 0.0, 0.0, 0.0 }, { 1.0, 2.0, 3.0 }, { -5.0, 7.0, 11.0 }, { 13.0, -17.0, 19.0 }, { 101.0, -103.0, 107.0 }
+  };
+  node.Invert = false;
+  bool inversionDetected = false;
+  for (const double* worldPoint : testPoints)
+  {
+    double worldPointHomogeneous[4] = { worldPoint[0], worldPoint[1], worldPoint[2], 1.0 };
+    double parentPoint[4] = { 0.0, 0.0, 0.0, 1.0 };
+    worldToParent->MultiplyPoint(worldPointHomogeneous, parentPoint);
+    const double functionValue = function->FunctionValue(parentPoint);
+    const double convertedValue = node.Evaluate(worldPoint);
+    const double tolerance = 1e-6 * std::max(1.0, std::fabs(convertedValue));
+    const bool sameValue = (std::fabs(functionValue - convertedValue) <= tolerance);
+    const bool invertedValue = (std::fabs(functionValue + convertedValue) <= tolerance);
+    if (!sameValue && !invertedValue)
+    {
+      return false;
+    }
+    if (sameValue && invertedValue)
+    {
+      // value is zero, it cannot be used for detecting inversion
+      continue;
+    }
+    if (inversionDetected && invertedValue != node.Invert)
+    {
+      // inverted at some points but not at others
+      return false;
+    }
+    node.Invert = invertedValue;
+    inversionDetected = true;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Get the matrix of a transform that is made up of homogeneous transforms.
+/// Returns false if the transform contains non-linear transforms.
+bool GetLinearTransformMatrix(vtkAbstractTransform* inputTransform, vtkMatrix4x4* matrix)
+{
+  vtkNew<vtkTransform> concatenatedTransform;
+  concatenatedTransform->PostMultiply();
+  // Decompose general transforms, use a stack to avoid recursive calls
+  std::stack<vtkAbstractTransform*> transforms;
+  transforms.push(inputTransform);
+  while (!transforms.empty())
+  {
+    vtkAbstractTransform* transform = transforms.top();
+    transforms.pop();
+    vtkGeneralTransform* generalTransform = vtkGeneralTransform::SafeDownCast(transform);
+    if (generalTransform)
+    {
+      generalTransform->Update();
+      for (int transformIndex = generalTransform->GetNumberOfConcatenatedTransforms() - 1; transformIndex >= 0; --transformIndex)
+      {
+        transforms.push(generalTransform->GetConcatenatedTransform(transformIndex));
+      }
+      continue;
+    }
+    vtkHomogeneousTransform* homogeneousTransform = vtkHomogeneousTransform::SafeDownCast(transform);
+    if (!homogeneousTransform)
+    {
+      return false;
+    }
+    concatenatedTransform->Concatenate(homogeneousTransform->GetMatrix());
+  }
+  matrix->DeepCopy(concatenatedTransform->GetMatrix());
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Convert the implicit function to a ClipFunctionNode.
+/// worldToParent maps the clipped points to the coordinate system of the parent function.
+/// Returns false if the function cannot be represented by linear functions and boolean operations.
+bool ConvertClipFunction(vtkImplicitFunction* function, vtkMatrix4x4* worldToParent, ClipFunctionNode& node)
+{
+  if (!function)
+  {
+    return false;
+  }
+
+  // Points are transformed by the function's transform before evaluating the function
+  vtkNew<vtkMatrix4x4> worldToFunction;
+  worldToFunction->DeepCopy(worldToParent);
+  if (function->GetTransform())
+  {
+    vtkNew<vtkMatrix4x4> transformMatrix;
+    if (!GetLinearTransformMatrix(function->GetTransform(), transformMatrix))
+    {
+      return false;
+    }
+    if (transformMatrix->GetElement(3, 0) != 0.0 || transformMatrix->GetElement(3, 1) != 0.0
+      || transformMatrix->GetElement(3, 2) != 0.0 || transformMatrix->GetElement(3, 3) != 1.0)
+    {
+      // perspective transform
+      return false;
+    }
+    vtkMatrix4x4::Multiply4x4(transformMatrix, worldToParent, worldToFunction);
+  }
+
+  vtkPlane* plane = vtkPlane::SafeDownCast(function);
+  if (plane)
+  {
+    // The plane is a linear function in its own coordinate system, get its coefficients
+    // by evaluating it at the origin and at unit points along each axis.
+    double point[3] = { 0.0, 0.0, 0.0 };
+    const double offset = plane->EvaluateFunction(point);
+    double gradient[3] = { 0.0, 0.0, 0.0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      point[0] = point[1] = point[2] = 0.0;
+      point[axis] = 1.0;
+      gradient[axis] = plane->EvaluateFunction(point) - offset;
+    }
+    node.Type = ClipFunctionNode::LinearNode;
+    node.Coefficients[3] = offset;
+    for (int row = 0; row < 3; ++row)
+    {
+      for (int column = 0; column < 3; ++column)
+      {
+        node.Coefficients[column] += gradient[row] * worldToFunction->GetElement(row, column);
+      }
+      node.Coefficients[3] += gradient[row] * worldToFunction->GetElement(row, 3);
+    }
+    return true;
+  }
+
+  vtkPlanes* planes = vtkPlanes::SafeDownCast(function);
+  if (planes)
+  {
+    if (planes->GetNumberOfPlanes() < 1)
+    {
+      return false;
+    }
+    // vtkPlanes value is the maximum of the plane function values
+    node.Type = ClipFunctionNode::BooleanNode;
+    node.OperationType = vtkImplicitBoolean::VTK_INTERSECTION;
+    for (int planeIndex = 0; planeIndex < planes->GetNumberOfPlanes(); ++planeIndex)
+    {
+      node.Children.emplace_back();
+      if (!ConvertClipFunction(planes->GetPlane(planeIndex), worldToFunction, node.Children.back()))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  vtkImplicitBoolean* booleanFunction = vtkImplicitBoolean::SafeDownCast(function);
+  if (booleanFunction)
+  {
+    node.Type = ClipFunctionNode::BooleanNode;
+    node.OperationType = booleanFunction->GetOperationType();
+    vtkImplicitFunctionCollection* functions = booleanFunction->GetFunction();
+    for (int functionIndex = 0; functionIndex < functions->GetNumberOfItems(); ++functionIndex)
+    {
+      node.Children.emplace_back();
+      vtkImplicitFunction* childFunction = vtkImplicitFunction::SafeDownCast(functions->GetItemAsObject(functionIndex));
+      if (!ConvertClipFunction(childFunction, worldToFunction, node.Children.back()))
+      {
+        return false;
+      }
+    }
+    if (strcmp(booleanFunction->GetClassName(), "vtkImplicitBoolean") == 0)
+    {
+      return true;
+    }
+    // Subclasses may modify the result of the boolean operation (for example, vtkImplicitInvertableBoolean
+    // can invert it). Compare the function value to the converted function at a few points to detect inversion,
+    // and do not convert the function if its value is different in any other way.
+    return DetectClipFunctionInversion(function, worldToParent, node);
+  }
+
+  return false;
+}
+
+//----------------------------------------------------------------------------
+/// Cell array of a mesh and the ID of its first cell in the mesh.
+/// Polydata cells are stored in vertex, line, polygon, and strip cell arrays (in this order),
+/// unstructured grid cells are stored in a single cell array.
+struct CellArrayRange
+{
+  vtkCellArray* Cells{ nullptr };
+  vtkIdType FirstCellId{ 0 };
+  /// Index of the polydata cell array (0 = vertices, 1 = lines, 2 = polygons, 3 = strips)
+  int PolyDataCellArrayIndex{ 0 };
+};
+
+//----------------------------------------------------------------------------
+std::vector<CellArrayRange> GetCellArrays(vtkPointSet* mesh)
+{
+  std::vector<vtkCellArray*> cellArrays;
+  vtkPolyData* polyData = vtkPolyData::SafeDownCast(mesh);
+  vtkUnstructuredGrid* unstructuredGrid = vtkUnstructuredGrid::SafeDownCast(mesh);
+  if (polyData)
+  {
+    cellArrays = { polyData->GetVerts(), polyData->GetLines(), polyData->GetPolys(), polyData->GetStrips() };
+  }
+  else if (unstructuredGrid)
+  {
+    cellArrays = { unstructuredGrid->GetCells() };
+  }
+  std::vector<CellArrayRange> ranges;
+  vtkIdType firstCellId = 0;
+  for (size_t cellArrayIndex = 0; cellArrayIndex < cellArrays.size(); ++cellArrayIndex)
+  {
+    vtkCellArray* cells = cellArrays[cellArrayIndex];
+    if (!cells || cells->GetNumberOfCells() == 0)
+    {
+      continue;
+    }
+    CellArrayRange range;
+    range.Cells = cells;
+    range.FirstCellId = firstCellId;
+    range.PolyDataCellArrayIndex = static_cast<int>(cellArrayIndex);
+    ranges.push_back(range);
+    firstCellId += cells->GetNumberOfCells();
+  }
+  return ranges;
+}
+
+//----------------------------------------------------------------------------
+void GetCellPoints(const std::vector<CellArrayRange>& cellArrays, vtkIdType cellId,
+  vtkIdType& numberOfCellPoints, const vtkIdType*& cellPoints, vtkIdList* pointIds)
+{
+  for (auto it = cellArrays.rbegin(); it != cellArrays.rend(); ++it)
+  {
+    if (cellId >= it->FirstCellId)
+    {
+      it->Cells->GetCellAtId(cellId - it->FirstCellId, numberOfCellPoints, cellPoints, pointIds);
+      return;
+    }
+  }
+  numberOfCellPoints = 0;
+  cellPoints = nullptr;
+}
+
+//----------------------------------------------------------------------------
+/// Returns true if the cell is kept by whole cell extraction.
+bool IsCellKept(vtkIdType numberOfCellPoints, const vtkIdType* cellPoints, const double* clipValues, bool extractBoundaryCells)
+{
+  // Same criteria as in vtkExtractPolyDataGeometry and vtkExtractGeometry with ExtractInside off
+  if (extractBoundaryCells)
+  {
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+    {
+      if (clipValues[cellPoints[pointIndex]] >= 0.0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+  for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+  {
+    if (clipValues[cellPoints[pointIndex]] < 0.0)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+/// Position of a cell relative to the clip surface, used in straight clipping
+enum CellClipState
+{
+  /// All points are outside, the clipper would not generate any output
+  CellOutside = 0,
+  /// All points are inside and the clipper would copy the cell unchanged
+  CellInside = 1,
+  /// Cell has to be clipped
+  CellIntersected = 2
+};
+
+//----------------------------------------------------------------------------
+/// Returns true if vtkClipPolyData and vtkClipDataSet output a cell unchanged when all its points are inside.
+/// Other cell types (polygons, strips, etc.) are triangulated by the clippers, therefore they are always clipped.
+bool IsCellCopiedByClipper(vtkPointSet* mesh, int polyDataCellArrayIndex, vtkIdType cellId, vtkIdType numberOfCellPoints)
+{
+  vtkUnstructuredGrid* unstructuredGrid = vtkUnstructuredGrid::SafeDownCast(mesh);
+  if (unstructuredGrid)
+  {
+    int cellType = unstructuredGrid->GetCellType(cellId);
+    return cellType == VTK_VERTEX || cellType == VTK_LINE || cellType == VTK_TRIANGLE || cellType == VTK_TETRA;
+  }
+  // vertex, line, and polygon cell arrays of polydata
+  return polyDataCellArrayIndex < 3 && numberOfCellPoints == polyDataCellArrayIndex + 1;
+}
+
+//----------------------------------------------------------------------------
+/// Copy points, point data, and the cells that have the selected state to the output polydata.
+void ExtractPolyDataCells(vtkPolyData* input, const std::vector<unsigned char>& cellStates, unsigned char selectedState,
+  vtkPolyData* output)
+{
+  output->SetPoints(input->GetPoints());
+  output->GetPointData()->PassData(input->GetPointData());
+  vtkCellData* inputCellData = input->GetCellData();
+  vtkCellData* outputCellData = output->GetCellData();
+  outputCellData->CopyAllocate(inputCellData, static_cast<vtkIdType>(std::count(cellStates.begin(), cellStates.end(), selectedState)));
+  vtkCellArray* inputCellArrays[4] = { input->GetVerts(), input->GetLines(), input->GetPolys(), input->GetStrips() };
+  vtkNew<vtkCellArray> outputCellArrays[4];
+  vtkIdType inputCellId = 0;
+  vtkIdType outputCellId = 0;
+  vtkNew<vtkIdList> pointIds;
+  for (int cellArrayIndex = 0; cellArrayIndex < 4; ++cellArrayIndex)
+  {
+    vtkCellArray* inputCells = inputCellArrays[cellArrayIndex];
+    if (!inputCells || inputCells->GetNumberOfCells() == 0)
+    {
+      continue;
+    }
+    for (vtkIdType cellIndex = 0; cellIndex < inputCells->GetNumberOfCells(); ++cellIndex, ++inputCellId)
+    {
+      if (cellStates[inputCellId] != selectedState)
+      {
+        continue;
+      }
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPoints = nullptr;
+      inputCells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+      outputCellArrays[cellArrayIndex]->InsertNextCell(numberOfCellPoints, cellPoints);
+      outputCellData->CopyData(inputCellData, inputCellId, outputCellId++);
+    }
+  }
+  output->SetVerts(outputCellArrays[0]);
+  output->SetLines(outputCellArrays[1]);
+  output->SetPolys(outputCellArrays[2]);
+  output->SetStrips(outputCellArrays[3]);
+  output->Squeeze();
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkIndexedClipFilter::vtkInternal
+{
+public:
+  /// Convert the clip function if it has been modified since the last conversion and
+  /// update ClipStateTime if the clipping result may change.
+  void UpdateClipState();
+
+  /// Sort the cells of the mesh into bins. Only performed if the mesh changed since the last call.
+  void UpdateCellIndex(vtkPointSet* mesh);
+
+  /// Compute clip function values at all points of the indexed mesh.
+  /// Points that are only used by cells in bins that are not intersected by the clip surface get the bin's
+  /// bounding value (that has the correct sign), exact values are only computed near the clip surface.
+  /// Returns the number of points where the function was evaluated.
+  vtkIdType ComputeClipValues(vtkPointSet* mesh, double* clipValues, int numberOfThreads);
+
+  int GetBinIndex(const double point[3]) const;
+
+  /// Clip all cells of the mesh using the clip values with vtkClipPolyData or vtkClipDataSet.
+  void ClipAllCells(vtkPointSet* mesh, vtkDoubleArray* clipValues, vtkPointSet* output);
+
+  /// Clip only cells in bins that are intersected by the clip surface, copy cells that are inside
+  /// and remove cells that are outside. Requires an up-to-date cell index.
+  /// Returns false (and does not change the output) if most of the cells need to be clipped,
+  /// as then clipping all cells is faster.
+  bool ClipIntersectedCells(vtkPointSet* mesh, vtkDoubleArray* clipValues, int numberOfThreads, vtkPointSet* output);
+
+  vtkSmartPointer<vtkImplicitFunction> ClipFunction;
+  vtkMTimeType ConvertedClipFunctionMTime{ 0 };
+  bool ClipFunctionConverted{ false };
+  ClipFunctionNode ConvertedClipFunction;
+  std::vector<double> ClipFunctionSignature;
+  vtkTimeStamp ClipStateTime;
+
+  // Cell index
+  vtkWeakPointer<vtkPointSet> IndexedMesh;
+  vtkMTimeType IndexedMeshMTime{ 0 };
+  double MeshBounds[6] = { 0.0, -1.0, 0.0, -1.0, 0.0, -1.0 };
+  int BinDimensions[3] = { 1, 1, 1 };
+  /// Bounding box of all cells (and orphan points) of each bin, 6 values per bin
+  std::vector<double> BinBounds;
+  /// Cells of bin i are BinCellIds[BinCellOffsets[i]] ... BinCellIds[BinCellOffsets[i+1]-1]
+  std::vector<vtkIdType> BinCellOffsets;
+  std::vector<vtkIdType> BinCellIds;
+  std::vector<vtkIdType> CellBins;
+  /// Bin of one of the cells that use the point (or bin containing the point if it is not used by any cell)
+  std::vector<vtkIdType> PointBins;
+
+  // Bins that the clip surface does not intersect, and their bounding clip value
+  std::vector<unsigned char> BinIntersected;
+  std::vector<double> BinClipValues;
+
+  vtkSmartPointer<vtkClipPolyData> PolyDataClipper;
+  vtkSmartPointer<vtkClipDataSet> DataSetClipper;
+  vtkSmartPointer<vtkExtractCells> CellExtractor;
+};
+
+//----------------------------------------------------------------------------
+void vtkIndexedClipFilter::vtkInternal::UpdateClipState()
+{
+  if (!this->ClipFunction)
+  {
+    if (this->ConvertedClipFunctionMTime != 0)
+    {
+      this->ConvertedClipFunctionMTime = 0;
+      this->ClipFunctionConverted = false;
+      this->ClipFunctionSignature.clear();
+      this->ClipStateTime.Modified();
+    }
+    return;
+  }
+  vtkMTimeType clipFunctionMTime = this->ClipFunction->GetMTime();
+  if (clipFunctionMTime == this->ConvertedClipFunctionMTime)
+  {
+    return;
+  }
+  this->ConvertedClipFunctionMTime = clipFunctionMTime;
+
+  ClipFunctionNode convertedClipFunction;
+  vtkNew<vtkMatrix4x4> identityMatrix;
+  bool converted = ConvertClipFunction(this->ClipFunction, identityMatrix, convertedClipFunction);
+  std::vector<double> signature;
+  if (converted)
+  {
+    convertedClipFunction.AppendSignature(signature);
+  }
+  if (!converted || !this->ClipFunctionConverted || signature != this->ClipFunctionSignature)
+  {
+    // Clipping result may be different
+    this->ClipStateTime.Modified();
+  }
+  this->ClipFunctionConverted = converted;
+  this->ConvertedClipFunction = convertedClipFunction;
+  this->ClipFunctionSignature = signature;
+}
+
+//----------------------------------------------------------------------------
+int vtkIndexedClipFilter::vtkInternal::GetBinIndex(const double point[3]) const
+{
+  int binIndex = 0;
+  int stride = 1;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double extent = this->MeshBounds[axis * 2 + 1] - this->MeshBounds[axis * 2];
+    int axisIndex = 0;
+    if (extent > 0.0)
+    {
+      axisIndex = static_cast<int>((point[axis] - this->MeshBounds[axis * 2]) / extent * this->BinDimensions[axis]);
+      axisIndex = std::max(0, std::min(this->BinDimensions[axis] - 1, axisIndex));
+    }
+    binIndex += axisIndex * stride;
+    stride *= this->BinDimensions[axis];
+  }
+  return binIndex;
+}
+
+//----------------------------------------------------------------------------
+void vtkIndexedClipFilter::vtkInternal::UpdateCellIndex(vtkPointSet* mesh)
+{
+  if (this->IndexedMesh == mesh && this->IndexedMeshMTime == mesh->GetMTime())
+  {
+    return;
+  }
+  this->IndexedMesh = mesh;
+  this->IndexedMeshMTime = mesh->GetMTime();
+
+  const vtkIdType numberOfPoints = mesh->GetNumberOfPoints();
+  std::vector<CellArrayRange> cellArrays = GetCellArrays(mesh);
+  vtkIdType numberOfCells = 0;
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    numberOfCells += cellArray.Cells->GetNumberOfCells();
+  }
+
+  // Choose bin size so that there are a few hundred cells in each bin
+  const vtkIdType cellsPerBin = 256;
+  const int maximumBinsPerAxis = 64;
+  mesh->GetBounds(this->MeshBounds);
+  double volume = 1.0;
+  int numberOfNonFlatAxes = 0;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double extent = this->MeshBounds[axis * 2 + 1] - this->MeshBounds[axis * 2];
+    if (extent > 0.0)
+    {
+      volume *= extent;
+      ++numberOfNonFlatAxes;
+    }
+  }
+  const double requestedNumberOfBins = std::max<double>(1.0, static_cast<double>(numberOfCells / cellsPerBin));
+  const double binSize = numberOfNonFlatAxes > 0 ? std::pow(volume / requestedNumberOfBins, 1.0 / numberOfNonFlatAxes) : 1.0;
+  vtkIdType numberOfBins = 1;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double extent = this->MeshBounds[axis * 2 + 1] - this->MeshBounds[axis * 2];
+    this->BinDimensions[axis] = 1;
+    if (extent > 0.0 && binSize > 0.0)
+    {
+      this->BinDimensions[axis] = static_cast<int>(std::max(1.0, std::min<double>(maximumBinsPerAxis, std::ceil(extent / binSize))));
+    }
+    numberOfBins *= this->BinDimensions[axis];
+  }
+
+  this->BinBounds.resize(numberOfBins * 6);
+  for (vtkIdType binIndex = 0; binIndex < numberOfBins; ++binIndex)
+  {
+    double* bounds = &this->BinBounds[binIndex * 6];
+    bounds[0] = bounds[2] = bounds[4] = VTK_DOUBLE_MAX;
+    bounds[1] = bounds[3] = bounds[5] = -VTK_DOUBLE_MAX;
+  }
+  this->CellBins.resize(numberOfCells);
+  this->PointBins.assign(numberOfPoints, -1);
+  std::vector<vtkIdType> binCellCounts(numberOfBins, 0);
+
+  // Assign each cell to the bin that contains the center of the cell's bounding box,
+  // and expand the bin bounds to contain the whole cell.
+  vtkPoints* points = mesh->GetPoints();
+  vtkNew<vtkIdList> pointIds;
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    const vtkIdType numberOfArrayCells = cellArray.Cells->GetNumberOfCells();
+    for (vtkIdType cellIndex = 0; cellIndex < numberOfArrayCells; ++cellIndex)
+    {
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPoints = nullptr;
+      cellArray.Cells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+      double cellBounds[6] = { VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX, VTK_DOUBLE_MAX, -VTK_DOUBLE_MAX };
+      double point[3] = { 0.0, 0.0, 0.0 };
+      for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+      {
+        points->GetPoint(cellPoints[pointIndex], point);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          cellBounds[axis * 2] = std::min(cellBounds[axis * 2], point[axis]);
+          cellBounds[axis * 2 + 1] = std::max(cellBounds[axis * 2 + 1], point[axis]);
+        }
+      }
+      vtkIdType binIndex = 0;
+      if (numberOfCellPoints > 0)
+      {
+        double center[3] = { 0.0, 0.0, 0.0 };
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          center[axis] = (cellBounds[axis * 2] + cellBounds[axis * 2 + 1]) * 0.5;
+        }
+        binIndex = this->GetBinIndex(center);
+        double* bounds = &this->BinBounds[binIndex * 6];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+          bounds[axis * 2] = std::min(bounds[axis * 2], cellBounds[axis * 2]);
+          bounds[axis * 2 + 1] = std::max(bounds[axis * 2 + 1], cellBounds[axis * 2 + 1]);
+        }
+        for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+        {
+          if (this->PointBins[cellPoints[pointIndex]] < 0)
+          {
+            this->PointBins[cellPoints[pointIndex]] = binIndex;
+          }
+        }
+      }
+      this->CellBins[cellArray.FirstCellId + cellIndex] = binIndex;
+      ++binCellCounts[binIndex];
+    }
+  }
+
+  // Points that are not used by any cell are assigned to the bin that contains them
+  for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+  {
+    if (this->PointBins[pointId] >= 0)
+    {
+      continue;
+    }
+    double point[3] = { 0.0, 0.0, 0.0 };
+    points->GetPoint(pointId, point);
+    vtkIdType binIndex = this->GetBinIndex(point);
+    this->PointBins[pointId] = binIndex;
+    double* bounds = &this->BinBounds[binIndex * 6];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      bounds[axis * 2] = std::min(bounds[axis * 2], point[axis]);
+      bounds[axis * 2 + 1] = std::max(bounds[axis * 2 + 1], point[axis]);
+    }
+  }
+
+  // Store cell IDs ordered by bin
+  this->BinCellOffsets.assign(numberOfBins + 1, 0);
+  for (vtkIdType binIndex = 0; binIndex < numberOfBins; ++binIndex)
+  {
+    this->BinCellOffsets[binIndex + 1] = this->BinCellOffsets[binIndex] + binCellCounts[binIndex];
+  }
+  this->BinCellIds.resize(numberOfCells);
+  std::vector<vtkIdType> binInsertPositions(this->BinCellOffsets.begin(), this->BinCellOffsets.end() - 1);
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    this->BinCellIds[binInsertPositions[this->CellBins[cellId]]++] = cellId;
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkIdType vtkIndexedClipFilter::vtkInternal::ComputeClipValues(vtkPointSet* mesh, double* clipValues, int numberOfThreads)
+{
+  const ClipFunctionNode& clipFunction = this->ConvertedClipFunction;
+
+  // Classify bins
+  const vtkIdType numberOfBins = static_cast<vtkIdType>(this->BinCellOffsets.size()) - 1;
+  this->BinIntersected.resize(numberOfBins);
+  this->BinClipValues.resize(numberOfBins);
+  SMPFor(numberOfBins, numberOfThreads, [&](vtkIdType beginBin, vtkIdType endBin)
+  {
+    for (vtkIdType binIndex = beginBin; binIndex < endBin; ++binIndex)
+    {
+      const double* bounds = &this->BinBounds[binIndex * 6];
+      this->BinIntersected[binIndex] = 0;
+      this->BinClipValues[binIndex] = 1.0;
+      if (bounds[0] > bounds[1])
+      {
+        // empty bin
+        continue;
+      }
+      double range[2] = { 0.0, 0.0 };
+      clipFunction.EvaluateRange(bounds, range);
+      if (range[0] > 0.0)
+      {
+        this->BinClipValues[binIndex] = range[0];
+      }
+      else if (range[1] < 0.0)
+      {
+        this->BinClipValues[binIndex] = range[1];
+      }
+      else
+      {
+        this->BinIntersected[binIndex] = 1;
+      }
+    }
+  });
+
+  // All points of cells that may be cut need exact values, so that the cut position is interpolated correctly
+  const vtkIdType numberOfPoints = mesh->GetNumberOfPoints();
+  std::vector<unsigned char> evaluatePoint(numberOfPoints, 0);
+  std::vector<CellArrayRange> cellArrays = GetCellArrays(mesh);
+  vtkNew<vtkIdList> pointIds;
+  for (vtkIdType binIndex = 0; binIndex < numberOfBins; ++binIndex)
+  {
+    if (!this->BinIntersected[binIndex])
+    {
+      continue;
+    }
+    for (vtkIdType cellIndex = this->BinCellOffsets[binIndex]; cellIndex < this->BinCellOffsets[binIndex + 1]; ++cellIndex)
+    {
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPoints = nullptr;
+      GetCellPoints(cellArrays, this->BinCellIds[cellIndex], numberOfCellPoints, cellPoints, pointIds);
+      for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+      {
+        evaluatePoint[cellPoints[pointIndex]] = 1;
+      }
+    }
+  }
+
+  vtkPoints* points = mesh->GetPoints();
+  std::atomic<vtkIdType> numberOfEvaluatedPoints(0);
+  SMPFor(numberOfPoints, numberOfThreads, [&](vtkIdType beginPoint, vtkIdType endPoint)
+  {
+    vtkIdType numberOfEvaluatedPointsInRange = 0;
+    double point[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointId = beginPoint; pointId < endPoint; ++pointId)
+    {
+      vtkIdType binIndex = this->PointBins[pointId];
+      if (evaluatePoint[pointId] || binIndex < 0 || this->BinIntersected[binIndex])
+      {
+        points->GetPoint(pointId, point);
+        clipValues[pointId] = clipFunction.Evaluate(point);
+        ++numberOfEvaluatedPointsInRange;
+      }
+      else
+      {
+        clipValues[pointId] = this->BinClipValues[binIndex];
+      }
+    }
+    numberOfEvaluatedPoints += numberOfEvaluatedPointsInRange;
+  });
+  return numberOfEvaluatedPoints;
+}
+
+//----------------------------------------------------------------------------
+void vtkIndexedClipFilter::vtkInternal::ClipAllCells(vtkPointSet* mesh, vtkDoubleArray* clipValues, vtkPointSet* output)
+{
+  // Clip using the computed values as scalars
+  vtkSmartPointer<vtkPointSet> clipInput = vtkSmartPointer<vtkPointSet>::Take(mesh->NewInstance());
+  clipInput->ShallowCopy(mesh);
+  std::string inputScalarsName;
+  if (mesh->GetPointData()->GetScalars() && mesh->GetPointData()->GetScalars()->GetName())
+  {
+    inputScalarsName = mesh->GetPointData()->GetScalars()->GetName();
+  }
+  clipInput->GetPointData()->AddArray(clipValues);
+  clipInput->GetPointData()->SetActiveScalars(ClipValuesArrayName);
+  vtkAlgorithm* clipper = nullptr;
+  if (vtkPolyData::SafeDownCast(mesh))
+  {
+    if (!this->PolyDataClipper)
+    {
+      this->PolyDataClipper = vtkSmartPointer<vtkClipPolyData>::New();
+      this->PolyDataClipper->SetValue(0.0);
+    }
+    clipper = this->PolyDataClipper;
+  }
+  else
+  {
+    if (!this->DataSetClipper)
+    {
+      this->DataSetClipper = vtkSmartPointer<vtkClipDataSet>::New();
+      this->DataSetClipper->SetValue(0.0);
+    }
+    clipper = this->DataSetClipper;
+  }
+  clipper->SetInputDataObject(clipInput);
+  clipper->Update();
+  output->ShallowCopy(clipper->GetOutputDataObject(0));
+  clipper->SetInputDataObject(nullptr);
+  output->GetPointData()->RemoveArray(ClipValuesArrayName);
+  if (!inputScalarsName.empty())
+  {
+    output->GetPointData()->SetActiveScalars(inputScalarsName.c_str());
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkIndexedClipFilter::vtkInternal::ClipIntersectedCells(vtkPointSet* mesh, vtkDoubleArray* clipValues,
+  int numberOfThreads, vtkPointSet* output)
+{
+  vtkPolyData* inputPolyData = vtkPolyData::SafeDownCast(mesh);
+  vtkUnstructuredGrid* inputUnstructuredGrid = vtkUnstructuredGrid::SafeDownCast(mesh);
+  if (!inputPolyData && (!inputUnstructuredGrid || inputUnstructuredGrid->GetFaces()))
+  {
+    // Polyhedron cells are not copied, always clip all cells
+    return false;
+  }
+
+  // Classify cells. Cells in bins that are not intersected by the clip surface are classified
+  // without checking their points.
+  const double* clipValuesPtr = clipValues->GetPointer(0);
+  std::vector<CellArrayRange> cellArrays = GetCellArrays(mesh);
+  vtkIdType numberOfCells = 0;
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    numberOfCells += cellArray.Cells->GetNumberOfCells();
+  }
+  std::vector<unsigned char> cellStates(numberOfCells, CellOutside);
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    SMPFor(cellArray.Cells->GetNumberOfCells(), numberOfThreads, [&](vtkIdType beginCell, vtkIdType endCell)
+    {
+      vtkNew<vtkIdList> pointIds;
+      for (vtkIdType cellIndex = beginCell; cellIndex < endCell; ++cellIndex)
+      {
+        const vtkIdType cellId = cellArray.FirstCellId + cellIndex;
+        vtkIdType numberOfCellPoints = 0;
+        const vtkIdType* cellPoints = nullptr;
+        cellArray.Cells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+        bool allInside = true;
+        bool allOutside = true;
+        vtkIdType binIndex = this->CellBins[cellId];
+        if (!this->BinIntersected[binIndex])
+        {
+          allInside = (this->BinClipValues[binIndex] > 0.0);
+          allOutside = !allInside;
+        }
+        else
+        {
+          for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+          {
+            double clipValue = clipValuesPtr[cellPoints[pointIndex]];
+            allInside = allInside && clipValue > 0.0;
+            allOutside = allOutside && clipValue < 0.0;
+          }
+        }
+        if (allOutside && numberOfCellPoints > 0)
+        {
+          cellStates[cellId] = CellOutside;
+        }
+        else if (allInside && IsCellCopiedByClipper(mesh, cellArray.PolyDataCellArrayIndex, cellId, numberOfCellPoints))
+        {
+          cellStates[cellId] = CellInside;
+        }
+        else
+        {
+          cellStates[cellId] = CellIntersected;
+        }
+      }
+    });
+  }
+  const vtkIdType numberOfIntersectedCells = static_cast<vtkIdType>(std::count(cellStates.begin(), cellStates.end(), CellIntersected));
+  if (numberOfIntersectedCells * 2 > numberOfCells)
+  {
+    return false;
+  }
+
+  // Clip the intersected cells
+  vtkSmartPointer<vtkPointSet> clippedCells;
+  if (numberOfIntersectedCells > 0)
+  {
+    vtkSmartPointer<vtkPointSet> intersectedCells;
+    vtkSmartPointer<vtkDataArray> intersectedCellsClipValues;
+    if (inputPolyData)
+    {
+      // Points are shared with the input mesh, only the cells are copied
+      vtkNew<vtkPolyData> intersectedPolyData;
+      ExtractPolyDataCells(inputPolyData, cellStates, CellIntersected, intersectedPolyData);
+      intersectedCells = intersectedPolyData;
+      intersectedCellsClipValues = clipValues;
+    }
+    else
+    {
+      vtkNew<vtkIdList> intersectedCellIds;
+      intersectedCellIds->Allocate(numberOfIntersectedCells);
+      for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+      {
+        if (cellStates[cellId] == CellIntersected)
+        {
+          intersectedCellIds->InsertNextId(cellId);
+        }
+      }
+      vtkNew<vtkUnstructuredGrid> meshWithClipValues;
+      meshWithClipValues->ShallowCopy(mesh);
+      meshWithClipValues->GetPointData()->AddArray(clipValues);
+      if (!this->CellExtractor)
+      {
+        this->CellExtractor = vtkSmartPointer<vtkExtractCells>::New();
+      }
+      this->CellExtractor->SetInputData(meshWithClipValues);
+      this->CellExtractor->SetCellList(intersectedCellIds);
+      this->CellExtractor->Update();
+      intersectedCells = vtkSmartPointer<vtkUnstructuredGrid>::New();
+      intersectedCells->ShallowCopy(this->CellExtractor->GetOutput());
+      this->CellExtractor->SetInputData(nullptr);
+      intersectedCellsClipValues = intersectedCells->GetPointData()->GetArray(ClipValuesArrayName);
+    }
+    if (!vtkDoubleArray::SafeDownCast(intersectedCellsClipValues))
+    {
+      return false;
+    }
+    clippedCells = vtkSmartPointer<vtkPointSet>::Take(mesh->NewInstance());
+    this->ClipAllCells(intersectedCells, vtkDoubleArray::SafeDownCast(intersectedCellsClipValues), clippedCells);
+  }
+
+  // Output points: input points of the copied cells (in their original order), followed by the clipped cells' points.
+  // The clippers merge coincident points, therefore points of the clipped cells that are copies of
+  // input points that are shared with copied cells are merged, too.
+  vtkPoints* inputPoints = mesh->GetPoints();
+  const vtkIdType numberOfInputPoints = mesh->GetNumberOfPoints();
+  std::vector<vtkIdType> outputPointIds(numberOfInputPoints, -1);
+  std::vector<unsigned char> pointUsedByIntersectedCell(numberOfInputPoints, 0);
+  vtkNew<vtkIdList> pointIds;
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    for (vtkIdType cellIndex = 0; cellIndex < cellArray.Cells->GetNumberOfCells(); ++cellIndex)
+    {
+      unsigned char cellState = cellStates[cellArray.FirstCellId + cellIndex];
+      if (cellState == CellOutside)
+      {
+        continue;
+      }
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPoints = nullptr;
+      cellArray.Cells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+      for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+      {
+        if (cellState == CellInside)
+        {
+          outputPointIds[cellPoints[pointIndex]] = 0;
+        }
+        else
+        {
+          pointUsedByIntersectedCell[cellPoints[pointIndex]] = 1;
+        }
+      }
+    }
+  }
+  vtkIdType numberOfOutputPoints = 0;
+  std::map<std::array<double, 3>, vtkIdType> sharedPointIds;
+  for (vtkIdType pointId = 0; pointId < numberOfInputPoints; ++pointId)
+  {
+    if (outputPointIds[pointId] < 0)
+    {
+      continue;
+    }
+    outputPointIds[pointId] = numberOfOutputPoints++;
+    if (pointUsedByIntersectedCell[pointId])
+    {
+      std::array<double, 3> point;
+      inputPoints->GetPoint(pointId, point.data());
+      sharedPointIds[point] = outputPointIds[pointId];
+    }
+  }
+  const vtkIdType numberOfClippedPoints = clippedCells ? clippedCells->GetNumberOfPoints() : 0;
+  std::vector<vtkIdType> clippedOutputPointIds(numberOfClippedPoints, -1);
+  std::vector<vtkIdType> newClippedPointIds;
+  for (vtkIdType clippedPointId = 0; clippedPointId < numberOfClippedPoints; ++clippedPointId)
+  {
+    std::array<double, 3> point;
+    clippedCells->GetPoint(clippedPointId, point.data());
+    auto sharedPointIt = sharedPointIds.find(point);
+    if (sharedPointIt != sharedPointIds.end())
+    {
+      clippedOutputPointIds[clippedPointId] = sharedPointIt->second;
+    }
+    else
+    {
+      clippedOutputPointIds[clippedPointId] = numberOfOutputPoints++;
+      newClippedPointIds.push_back(clippedPointId);
+    }
+  }
+
+  output->Initialize();
+  vtkDataSetAttributes::FieldList pointFields(2);
+  pointFields.InitializeFieldList(mesh->GetPointData());
+  if (clippedCells)
+  {
+    pointFields.IntersectFieldList(clippedCells->GetPointData());
+  }
+  vtkNew<vtkPoints> outputPoints;
+  outputPoints->SetDataType(inputPoints->GetDataType());
+  outputPoints->SetNumberOfPoints(numberOfOutputPoints);
+  vtkPointData* outputPointData = output->GetPointData();
+  outputPointData->CopyAllocate(pointFields, numberOfOutputPoints);
+  double point[3] = { 0.0, 0.0, 0.0 };
+  for (vtkIdType pointId = 0; pointId < numberOfInputPoints; ++pointId)
+  {
+    if (outputPointIds[pointId] >= 0)
+    {
+      inputPoints->GetPoint(pointId, point);
+      outputPoints->SetPoint(outputPointIds[pointId], point);
+      outputPointData->CopyData(pointFields, mesh->GetPointData(), 0, pointId, outputPointIds[pointId]);
+    }
+  }
+  for (vtkIdType clippedPointId : newClippedPointIds)
+  {
+    clippedCells->GetPoint(clippedPointId, point);
+    outputPoints->SetPoint(clippedOutputPointIds[clippedPointId], point);
+    outputPointData->CopyData(pointFields, clippedCells->GetPointData(), 1, clippedPointId, clippedOutputPointIds[clippedPointId]);
+  }
+  output->SetPoints(outputPoints);
+
+  // Output cells: copied cells followed by clipped cells (for polydata, in each cell array)
+  vtkDataSetAttributes::FieldList cellFields(2);
+  cellFields.InitializeFieldList(mesh->GetCellData());
+  if (clippedCells)
+  {
+    cellFields.IntersectFieldList(clippedCells->GetCellData());
+  }
+  vtkCellData* outputCellData = output->GetCellData();
+  const vtkIdType numberOfCopiedCells = static_cast<vtkIdType>(std::count(cellStates.begin(), cellStates.end(), CellInside));
+  const vtkIdType numberOfClippedCells = clippedCells ? clippedCells->GetNumberOfCells() : 0;
+  outputCellData->CopyAllocate(cellFields, numberOfCopiedCells + numberOfClippedCells);
+  std::vector<vtkIdType> outputCellPoints;
+  auto getOutputCellPoints = [&outputCellPoints](vtkIdType numberOfCellPoints, const vtkIdType* cellPoints,
+    const std::vector<vtkIdType>& pointIdMap)
+  {
+    outputCellPoints.resize(numberOfCellPoints);
+    for (vtkIdType pointIndex = 0; pointIndex < numberOfCellPoints; ++pointIndex)
+    {
+      outputCellPoints[pointIndex] = pointIdMap[cellPoints[pointIndex]];
+    }
+    return outputCellPoints.data();
+  };
+  vtkIdType outputCellId = 0;
+  if (inputPolyData)
+  {
+    vtkPolyData* clippedPolyData = vtkPolyData::SafeDownCast(clippedCells);
+    vtkPolyData* outputPolyData = vtkPolyData::SafeDownCast(output);
+    vtkCellArray* inputCellArrays[4] = { inputPolyData->GetVerts(), inputPolyData->GetLines(), inputPolyData->GetPolys(), inputPolyData->GetStrips() };
+    vtkCellArray* clippedCellArrays[4] = { nullptr, nullptr, nullptr, nullptr };
+    if (clippedPolyData)
+    {
+      clippedCellArrays[0] = clippedPolyData->GetVerts();
+      clippedCellArrays[1] = clippedPolyData->GetLines();
+      clippedCellArrays[2] = clippedPolyData->GetPolys();
+      clippedCellArrays[3] = clippedPolyData->GetStrips();
+    }
+    vtkNew<vtkCellArray> outputCellArrays[4];
+    vtkIdType inputCellId = 0;
+    vtkIdType clippedCellId = 0;
+    for (int cellArrayIndex = 0; cellArrayIndex < 4; ++cellArrayIndex)
+    {
+      vtkCellArray* inputCells = inputCellArrays[cellArrayIndex];
+      const vtkIdType numberOfInputArrayCells = inputCells ? inputCells->GetNumberOfCells() : 0;
+      for (vtkIdType cellIndex = 0; cellIndex < numberOfInputArrayCells; ++cellIndex, ++inputCellId)
+      {
+        if (cellStates[inputCellId] != CellInside)
+        {
+          continue;
+        }
+        vtkIdType numberOfCellPoints = 0;
+        const vtkIdType* cellPoints = nullptr;
+        inputCells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+        outputCellArrays[cellArrayIndex]->InsertNextCell(numberOfCellPoints, getOutputCellPoints(numberOfCellPoints, cellPoints, outputPointIds));
+        outputCellData->CopyData(cellFields, mesh->GetCellData(), 0, inputCellId, outputCellId++);
+      }
+      vtkCellArray* clippedArrayCells = clippedCellArrays[cellArrayIndex];
+      const vtkIdType numberOfClippedArrayCells = clippedArrayCells ? clippedArrayCells->GetNumberOfCells() : 0;
+      for (vtkIdType cellIndex = 0; cellIndex < numberOfClippedArrayCells; ++cellIndex, ++clippedCellId)
+      {
+        vtkIdType numberOfCellPoints = 0;
+        const vtkIdType* cellPoints = nullptr;
+        clippedArrayCells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+        outputCellArrays[cellArrayIndex]->InsertNextCell(numberOfCellPoints, getOutputCellPoints(numberOfCellPoints, cellPoints, clippedOutputPointIds));
+        outputCellData->CopyData(cellFields, clippedCells->GetCellData(), 1, clippedCellId, outputCellId++);
+      }
+    }
+    outputPolyData->SetVerts(outputCellArrays[0]);
+    outputPolyData->SetLines(outputCellArrays[1]);
+    outputPolyData->SetPolys(outputCellArrays[2]);
+    outputPolyData->SetStrips(outputCellArrays[3]);
+  }
+  else
+  {
+    vtkUnstructuredGrid* clippedUnstructuredGrid = vtkUnstructuredGrid::SafeDownCast(clippedCells);
+    vtkUnstructuredGrid* outputUnstructuredGrid = vtkUnstructuredGrid::SafeDownCast(output);
+    outputUnstructuredGrid->AllocateEstimate(numberOfCopiedCells + numberOfClippedCells, 4);
+    vtkCellArray* inputCells = inputUnstructuredGrid->GetCells();
+    for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+    {
+      if (cellStates[cellId] != CellInside)
+      {
+        continue;
+      }
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPoints = nullptr;
+      inputCells->GetCellAtId(cellId, numberOfCellPoints, cellPoints, pointIds);
+      outputUnstructuredGrid->InsertNextCell(inputUnstructuredGrid->GetCellType(cellId),
+        numberOfCellPoints, getOutputCellPoints(numberOfCellPoints, cellPoints, outputPointIds));
+      outputCellData->CopyData(cellFields, mesh->GetCellData(), 0, cellId, outputCellId++);
+    }
+    for (vtkIdType clippedCellId = 0; clippedCellId < numberOfClippedCells; ++clippedCellId)
+    {
+      vtkIdType numberOfCellPoints = 0;
+      const vtkIdType* cellPoints = nullptr;
+      clippedUnstructuredGrid->GetCells()->GetCellAtId(clippedCellId, numberOfCellPoints, cellPoints, pointIds);
+      outputUnstructuredGrid->InsertNextCell(clippedUnstructuredGrid->GetCellType(clippedCellId),
+        numberOfCellPoints, getOutputCellPoints(numberOfCellPoints, cellPoints, clippedOutputPointIds));
+      outputCellData->CopyData(cellFields, clippedCells->GetCellData(), 1, clippedCellId, outputCellId++);
+    }
+  }
+  output->Squeeze();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkIndexedClipFilter);
+
+//----------------------------------------------------------------------------
+vtkIndexedClipFilter::vtkIndexedClipFilter()
+  : Internal(new vtkInternal())
+{
+}
+
+//----------------------------------------------------------------------------
+vtkIndexedClipFilter::~vtkIndexedClipFilter() = default;
+
+//----------------------------------------------------------------------------
+void vtkIndexedClipFilter::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "Clip Function:" << std::endl;
+  if (this->Internal->ClipFunction)
+  {
+    this->Internal->ClipFunction->PrintSelf(os, indent.GetNextIndent());
+  }
+  else
+  {
+    os << indent.GetNextIndent() << "(none)" << std::endl;
+  }
+  os << indent << "Clipping Method: " << (this->ClippingMethod == Straight ? "Straight"
+    : (this->ClippingMethod == WholeCells ? "WholeCells" : "WholeCellsWithBoundary")) << "\n";
+  os << indent << "Number Of Threads: " << this->NumberOfThreads << "\n";
+  os << indent << "Clip Function Indexed: " << (this->Internal->ClipFunctionConverted ? "true" : "false") << "\n";
+  os << indent << "Number Of Evaluated Points: " << this->NumberOfEvaluatedPoints << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkIndexedClipFilter::SetClipFunction(vtkImplicitFunction* clipFunction)
+{
+  if (this->Internal->ClipFunction == clipFunction)
+  {
+    return;
+  }
+  this->Internal->ClipFunction = clipFunction;
+  // Force conversion of the new function. The filter only becomes modified if the new function
+  // produces a different result (see GetMTime).
+  this->Internal->ConvertedClipFunctionMTime = 0;
+  if (!clipFunction)
+  {
+    this->Internal->ClipStateTime.Modified();
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkImplicitFunction* vtkIndexedClipFilter::GetClipFunction()
+{
+  return this->Internal->ClipFunction;
+}
+
+//----------------------------------------------------------------------------
+bool vtkIndexedClipFilter::GetClipFunctionIndexed()
+{
+  return this->Internal->ClipFunctionConverted;
+}
+
+//----------------------------------------------------------------------------
+vtkMTimeType vtkIndexedClipFilter::GetMTime()
+{
+  vtkMTimeType mTime = this->Superclass::GetMTime();
+  this->Internal->UpdateClipState();
+  return std::max(mTime, this->Internal->ClipStateTime.GetMTime());
+}
+
+//----------------------------------------------------------------------------
+int vtkIndexedClipFilter::FillInputPortInformation(int vtkNotUsed(port), vtkInformation* info)
+{
+  info->Set(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkPolyData");
+  info->Append(vtkAlgorithm::INPUT_REQUIRED_DATA_TYPE(), "vtkUnstructuredGrid");
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkIndexedClipFilter::RequestData(vtkInformation* vtkNotUsed(request),
+  vtkInformationVector** inputVector, vtkInformationVector* outputVector)
+{
+  vtkPointSet* input = vtkPointSet::GetData(inputVector[0]);
+  vtkPointSet* output = vtkPointSet::GetData(outputVector);
+  if (!input || !output)
+  {
+    vtkErrorMacro("RequestData failed: invalid input or output");
+    return 0;
+  }
+  this->NumberOfEvaluatedPoints = 0;
+  this->Internal->UpdateClipState();
+  if (!this->Internal->ClipFunction)
+  {
+    output->ShallowCopy(input);
+    return 1;
+  }
+
+  // Compute clip function values
+  const vtkIdType numberOfPoints = input->GetNumberOfPoints();
+  vtkNew<vtkDoubleArray> clipValues;
+  clipValues->SetName(ClipValuesArrayName);
+  clipValues->SetNumberOfValues(numberOfPoints);
+  double* clipValuesPtr = clipValues->GetPointer(0);
+  if (this->Internal->ClipFunctionConverted)
+  {
+    this->Internal->UpdateCellIndex(input);
+    this->NumberOfEvaluatedPoints = this->Internal->ComputeClipValues(input, clipValuesPtr, this->NumberOfThreads);
+  }
+  else
+  {
+    // The clip function may not be thread-safe, evaluate it on the main thread
+    double point[3] = { 0.0, 0.0, 0.0 };
+    for (vtkIdType pointId = 0; pointId < numberOfPoints; ++pointId)
+    {
+      input->GetPoint(pointId, point);
+      clipValuesPtr[pointId] = this->Internal->ClipFunction->FunctionValue(point);
+    }
+    this->NumberOfEvaluatedPoints = numberOfPoints;
+  }
+
+  if (this->ClippingMethod == Straight)
+  {
+    if (!this->Internal->ClipFunctionConverted
+      || !this->Internal->ClipIntersectedCells(input, clipValues, this->NumberOfThreads, output))
+    {
+      this->Internal->ClipAllCells(input, clipValues, output);
+    }
+    return 1;
+  }
+
+  // Whole cell extraction. Cells in bins that are not intersected by the clip surface
+  // are kept or removed without checking their points.
+  const bool extractBoundaryCells = (this->ClippingMethod == WholeCellsWithBoundary);
+  const bool useBins = this->Internal->ClipFunctionConverted;
+  std::vector<CellArrayRange> cellArrays = GetCellArrays(input);
+  vtkIdType numberOfCells = 0;
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    numberOfCells += cellArray.Cells->GetNumberOfCells();
+  }
+  std::vector<unsigned char> keepCell(numberOfCells, 0);
+  for (const CellArrayRange& cellArray : cellArrays)
+  {
+    SMPFor(cellArray.Cells->GetNumberOfCells(), this->NumberOfThreads, [&](vtkIdType beginCell, vtkIdType endCell)
+    {
+      vtkNew<vtkIdList> pointIds;
+      for (vtkIdType cellIndex = beginCell; cellIndex < endCell; ++cellIndex)
+      {
+        const vtkIdType cellId = cellArray.FirstCellId + cellIndex;
+        if (useBins)
+        {
+          vtkIdType binIndex = this->Internal->CellBins[cellId];
+          if (!this->Internal->BinIntersected[binIndex])
+          {
+            keepCell[cellId] = (this->Internal->BinClipValues[binIndex] > 0.0);
+            continue;
+          }
+        }
+        vtkIdType numberOfCellPoints = 0;
+        const vtkIdType* cellPoints = nullptr;
+        cellArray.Cells->GetCellAtId(cellIndex, numberOfCellPoints, cellPoints, pointIds);
+        keepCell[cellId] = IsCellKept(numberOfCellPoints, cellPoints, clipValuesPtr, extractBoundaryCells);
+      }
+    });
+  }
+
+  vtkPolyData* inputPolyData = vtkPolyData::SafeDownCast(input);
+  if (inputPolyData)
+  {
+    ExtractPolyDataCells(inputPolyData, keepCell, 1, vtkPolyData::SafeDownCast(output));
+    return 1;
+  }
+
+  vtkNew<vtkIdList> keptCellIds;
+  for (vtkIdType cellId = 0; cellId < numberOfCells; ++cellId)
+  {
+    if (keepCell[cellId])
+    {
+      keptCellIds->InsertNextId(cellId);
+    }
+  }
+  if (!this->Internal->CellExtractor)
+  {
+    this->Internal->CellExtractor = vtkSmartPointer<vtkExtractCells>::New();
+  }
+  this->Internal->CellExtractor->SetInputData(input);
+  this->Internal->CellExtractor->SetCellList(keptCellIds);
+  this->Internal->CellExtractor->Update();
+  output->ShallowCopy(this->Internal->CellExtractor->GetOutput());
+  this->Internal->CellExtractor->SetInputData(nullptr);
+  return 1;
+}
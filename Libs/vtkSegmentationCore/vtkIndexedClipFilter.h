@@ -0,0 +1,126 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+/**
+ * @class   vtkIndexedClipFilter
+ * @brief   Clip a polydata or unstructured grid with an implicit function, reusing results between clip updates.
+ *
+ * The filter produces the same output as vtkClipPolyData/vtkClipDataSet (straight cut) or
+ * vtkExtractPolyDataGeometry/vtkExtractGeometry (whole cells) with ExtractInside off, but it is optimized for
+ * interactive clipping, when the clip function is modified many times while the input mesh remains the same:
+ *
+ * - The clip function is converted to a flat list of linear functions, combined by the boolean operations of
+ *   vtkImplicitBoolean. Planes (vtkPlane, vtkPlanes) with linear transforms are supported. Subclasses of
+ *   vtkImplicitBoolean that invert the result (such as vtkImplicitInvertableBoolean) are also supported,
+ *   as the converted function is compared to the original function at a few points.
+ *   The converted function is evaluated in multiple threads.
+ * - Cells of the input mesh are sorted into a uniform grid of bins. The grid is only computed again if the input mesh
+ *   is modified. When the clip function changes, the function value range is computed for each bin and the clip
+ *   function is only evaluated at points of cells that are in bins intersected by the clip surface.
+ * - In straight clipping mode, only cells that may be cut by the clip surface are clipped. Other cells are copied or
+ *   removed without clipping. Vertices, lines, triangles, and tetrahedra are copied. Other cell types are always
+ *   clipped, because the VTK clippers triangulate them. If most cells need clipping, all cells are clipped.
+ *   Points of copied cells are merged with the clipped cells' points only along the clip boundary.
+ *   So if the input has coincident points, the output may have more points than the VTK clippers produce.
+ * - The filter is only considered modified if the clip function is modified in a way that changes the clipping result
+ *   (for example, it is not modified if the clip function is replaced by an identical function or when an observed
+ *   node is modified without changing the plane positions). Therefore the previous output is kept for unchanged clip states.
+ *
+ * If the clip function cannot be converted (it contains other function types or non-linear transforms) then the clip
+ * function is evaluated at all points on the main thread, as in standard VTK clip filters.
+ *
+ * Whole cell extraction of polydata passes all input points to the output.
+ */
+
+#ifndef vtkIndexedClipFilter_h
+#define vtkIndexedClipFilter_h
+
+// VTK includes
+#include <vtkImplicitFunction.h>
+#include <vtkPointSetAlgorithm.h>
+#include <vtkSmartPointer.h>
+
+// SegmentationCore includes
+#include "vtkSegmentationCoreConfigure.h"
+
+// STD includes
+#include <memory>
+
+class vtkSegmentationCore_EXPORT vtkIndexedClipFilter : public vtkPointSetAlgorithm
+{
+public:
+  vtkTypeMacro(vtkIndexedClipFilter, vtkPointSetAlgorithm);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+  static vtkIndexedClipFilter* New();
+
+  /// Set the implicit function used for clipping. Points where the function value is positive are kept.
+  /// Setting a different function object that would produce the same clipping result does not make the filter modified.
+  void SetClipFunction(vtkImplicitFunction* clipFunction);
+  vtkImplicitFunction* GetClipFunction();
+
+  /// Straight cut, whole cell extraction, or whole cell extraction with boundary cells.
+  /// Values are the same as in vtkMRMLClipNode::ClippingMethodType.
+  enum ClippingMethodType
+  {
+    Straight = 0,
+    WholeCells,
+    WholeCellsWithBoundary
+  };
+
+  //@{
+  /// Clipping method. Default is Straight.
+  vtkSetClampMacro(ClippingMethod, int, Straight, WholeCellsWithBoundary);
+  vtkGetMacro(ClippingMethod, int);
+  //@}
+
+  //@{
+  /// Number of threads used for evaluating the clip function and classifying cells.
+  /// If set to 1 then all computations are performed on the calling thread,
+  /// otherwise (default: 0) vtkSMPTools is used.
+  vtkSetMacro(NumberOfThreads, int);
+  vtkGetMacro(NumberOfThreads, int);
+  //@}
+
+  /// Returns true if the clip function could be converted to a form that can be evaluated
+  /// in multiple threads and per bin. Available after the filter is updated.
+  bool GetClipFunctionIndexed();
+
+  /// Number of points where the clip function was evaluated at the last update.
+  /// This can be used for testing and performance monitoring.
+  vtkGetMacro(NumberOfEvaluatedPoints, vtkIdType);
+
+  /// Return the mtime also considering the clip function.
+  /// Modification of the clip function is only taken into account if it changes the clipping result.
+  vtkMTimeType GetMTime() override;
+
+protected:
+  vtkIndexedClipFilter();
+  ~vtkIndexedClipFilter() override;
+
+  int FillInputPortInformation(int port, vtkInformation* info) override;
+  int RequestData(vtkInformation*, vtkInformationVector**, vtkInformationVector*) override;
+
+  int ClippingMethod{ Straight };
+  int NumberOfThreads{ 0 };
+  vtkIdType NumberOfEvaluatedPoints{ 0 };
+
+private:
+  class vtkInternal;
+  std::unique_ptr<vtkInternal> Internal;
+
+  vtkIndexedClipFilter(const vtkIndexedClipFilter&) = delete;
+  void operator=(const vtkIndexedClipFilter&) = delete;
+};
+
+#endif
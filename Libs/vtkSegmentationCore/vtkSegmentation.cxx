@@ -50,6 +50,7 @@
 // STD includes
 #include <algorithm>
 #include <chrono>
+#include <cstring>
 #include <functional>
 #include <sstream>
 
@@ -1186,13 +1187,16 @@ void vtkSegmentation::ApplyNonLinearTransform(vtkAbstractTransform* transform)
 }
 
 //-----------------------------------------------------------------------------
-bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentIDs, vtkSegmentationConversionPath* path, bool overwriteExisting)
+bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentIDs, vtkSegmentationConversionPath* path, bool overwriteExisting,
+  const int modifiedExtent[6]/*=nullptr*/)
 {
   if (segmentIDs.empty())
   {
     return true;
   }
 
+  this->AbortConversion = false;
+
   // Execute each conversion step in the selected path
   int numberOfRules = (path == nullptr ? 0 : path->GetNumberOfRules());
   for (int ruleIndex = 0; ruleIndex < numberOfRules; ++ruleIndex)
@@ -1204,8 +1208,7 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
       return false;
     }
 
-    // Perform conversion step
-    currentConversionRule->PreConvert(this);
+    std::vector<vtkSegment*> segmentsToConvert;
     for (auto segmentID : segmentIDs)
     {
       vtkSegment* segment = this->GetSegment(segmentID);
@@ -1228,10 +1231,42 @@ bool vtkSegmentation::ConvertSegmentsUsingPath(std::vector<std::string> segmentI
       {
         continue;
       }
-      currentConversionRule->Convert(segment);
+      segmentsToConvert.push_back(segment);
     }
-    currentConversionRule->PostConvert(this);
 
+    // Perform conversion step
+    currentConversionRule->PreConvert(this);
+    bool completed = true;
+    if (ruleIndex == 0 && modifiedExtent
+      && modifiedExtent[0] <= modifiedExtent[1] && modifiedExtent[2] <= modifiedExtent[3] && modifiedExtent[4] <= modifiedExtent[5]
+      && strcmp(currentConversionRule->GetSourceRepresentationName(), vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()) == 0)
+    {
+      // Only a small region of the source labelmap changed, the rule may update the existing target representation
+      std::vector<vtkSegment*> segmentsToFullyConvert;
+      for (vtkSegment* segment : segmentsToConvert)
+      {
+        if (!currentConversionRule->ConvertModifiedRegion(segment, modifiedExtent))
+        {
+          segmentsToFullyConvert.push_back(segment);
+        }
+      }
+      if (!segmentsToFullyConvert.empty())
+      {
+        vtkWarningMacro("ConvertSegmentsUsingPath: Failed to update modified region of "
+          << segmentsToFullyConvert.size() << " segment(s), performing full conversion");
+        completed = currentConversionRule->ConvertSegments(this, segmentsToFullyConvert);
+      }
+    }
+    else
+    {
+      completed = currentConversionRule->ConvertSegments(this, segmentsToConvert);
+    }
+    currentConversionRule->PostConvert(this);
+    if (!completed)
+    {
+      vtkWarningMacro("ConvertSegmentsUsingPath: Conversion was aborted");
+      return false;
+    }
   }
 
   return true;
@@ -1350,11 +1385,7 @@ bool vtkSegmentation::CreateRepresentation(const std::string& targetRepresentati
 
   std::vector<std::string> segmentIDs;
   this->GetSegmentIDs(segmentIDs);
-  if (!this->ConvertSegmentsUsingPath(segmentIDs, cheapestPath, alwaysConvert))
-  {
-    vtkErrorMacro("CreateRepresentation: Conversion failed");
-    return false;
-  }
+  bool conversionCompleted = this->ConvertSegmentsUsingPath(segmentIDs, cheapestPath, alwaysConvert);
 
   for (SegmentMap::iterator segmentIt = this->Segments.begin(); segmentIt != this->Segments.end(); ++segmentIt)
   {
@@ -1384,6 +1415,11 @@ bool vtkSegmentation::CreateRepresentation(const std::string& targetRepresentati
   }
 
   this->InvokeEvent(vtkSegmentation::ContainedRepresentationNamesModified);
+  if (!conversionCompleted)
+  {
+    vtkErrorMacro("CreateRepresentation: Conversion failed");
+    return false;
+  }
   return true;
 }
 
@@ -528,10 +528,27 @@ public:
   vtkGetMacro(UUIDSegmentIDs, bool);
   vtkBooleanMacro(UUIDSegmentIDs, bool);
 
+  /// Request stopping of the representation conversion that is in progress.
+  /// Conversion progress is reported by vtkCommand::ProgressEvent events (call data is a pointer
+  /// to a double value between 0.0 and 1.0), therefore the flag is typically set from a progress
+  /// event observer. Progress events are only invoked from the thread that started the conversion.
+  /// Target representation of segments that were not converted yet is not created or updated:
+  /// if the segment did not have this representation before then it remains without it,
+  /// so a subsequent CreateRepresentation call only converts these segments.
+  /// The flag is reset at the start of each conversion.
+  vtkSetMacro(AbortConversion, bool);
+  vtkGetMacro(AbortConversion, bool);
+  vtkBooleanMacro(AbortConversion, bool);
+
   static vtkMinimalStandardRandomSequence* GetSegmentIDRandomSequenceInstance();
 
 protected:
-  bool ConvertSegmentsUsingPath(std::vector<std::string> segmentIDs, vtkSegmentationConversionPath* path, bool overwriteExisting = false);
+  /// Convert given segments along a specified path
+  /// \param modifiedExtent If specified and valid, then the source binary labelmap of the segments only changed
+  ///   in this region (in the IJK coordinate system of the labelmap) since the last conversion, which allows
+  ///   the first rule in the path to update only part of the existing target representation.
+  bool ConvertSegmentsUsingPath(std::vector<std::string> segmentIDs, vtkSegmentationConversionPath* path, bool overwriteExisting = false,
+    const int modifiedExtent[6] = nullptr);
 
   /// Convert given segment along a specified path
   /// \param segment Segment to convert
@@ -631,6 +648,9 @@ protected:
 
   bool UUIDSegmentIDs;
 
+  /// Set to true to stop the representation conversion in progress
+  bool AbortConversion{ false };
+
   /// Singleton class managing vtkMinimalStandardRandomSequence used for randomizing segment IDs
   friend class vtkSegmentationRandomSequenceInitialize;
 
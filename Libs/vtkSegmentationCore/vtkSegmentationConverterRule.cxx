@@ -22,11 +22,13 @@
 #include "vtkSegmentationConverterRule.h"
 
 // VTK includes
+#include <vtkCommand.h>
 #include <vtkObjectFactory.h>
 #include <vtkSmartPointer.h>
 
 // SegmentationCore includes
 #include <vtkSegment.h>
+#include <vtkSegmentation.h>
 
 //----------------------------------------------------------------------------
 vtkSegmentationConverterRule::vtkSegmentationConverterRule() = default;
@@ -75,6 +77,26 @@ bool vtkSegmentationConverterRule::CreateTargetRepresentation(vtkSegment* segmen
   return true;
 }
 
+//----------------------------------------------------------------------------
+bool vtkSegmentationConverterRule::ConvertSegments(vtkSegmentation* segmentation, const std::vector<vtkSegment*>& segments)
+{
+  int numberOfSegments = static_cast<int>(segments.size());
+  for (int segmentIndex = 0; segmentIndex < numberOfSegments; ++segmentIndex)
+  {
+    if (segmentation && segmentation->GetAbortConversion())
+    {
+      return false;
+    }
+    this->Convert(segments[segmentIndex]);
+    if (segmentation)
+    {
+      double progress = static_cast<double>(segmentIndex + 1) / numberOfSegments;
+      segmentation->InvokeEvent(vtkCommand::ProgressEvent, &progress);
+    }
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 void vtkSegmentationConverterRule::GetRuleConversionParameters(vtkSegmentationConversionParameters* conversionParameters)
 {
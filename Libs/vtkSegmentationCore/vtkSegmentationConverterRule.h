@@ -27,6 +27,9 @@
 #include <vtkNew.h>
 #include <vtkObject.h>
 
+// STD includes
+#include <vector>
+
 class vtkDataObject;
 class vtkSegmentation;
 class vtkSegment;
@@ -89,6 +92,21 @@ public:
   /// \sa ConvertInternal
   virtual bool Convert(vtkSegment* segment) = 0;
 
+  /// Update the target representation of multiple segments of a segmentation.
+  /// The default implementation calls Convert for each segment. Rules can override this method
+  /// to convert the segments in parallel.
+  /// Progress is reported by invoking vtkCommand::ProgressEvent on the segmentation and conversion
+  /// is stopped if AbortConversion flag of the segmentation is set.
+  /// \return False if the conversion was aborted.
+  virtual bool ConvertSegments(vtkSegmentation* segmentation, const std::vector<vtkSegment*>& segments);
+
+  /// Update the target representation after the source representation was changed in a small region.
+  /// The default implementation calls Convert. Rules can override this method to only recompute the
+  /// part of the target representation that depends on the modified region.
+  /// \param modifiedExtent Region that may have changed, in the IJK coordinate system of the source binary labelmap.
+  /// \return False if the target representation could not be updated. In this case the caller performs full conversion.
+  virtual bool ConvertModifiedRegion(vtkSegment* segment, const int vtkNotUsed(modifiedExtent)[6]) { return this->Convert(segment); };
+
   /// Perform post-conversion steps across the specified segments in the segmentation
   /// This step should be unnecessary if only converting a single segment
   virtual bool PostConvert(vtkSegmentation* vtkNotUsed(segmentation)) { return true; };
@@ -22,14 +22,131 @@
 #include "vtkSegmentationHistory.h"
 #include "vtkSegmentationConverterFactory.h"
 #include "vtkSegmentation.h"
+#include "vtkOrientedImageData.h"
+#include "vtkOrientedImageDataResample.h"
 
 // VTK includes
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkCallbackCommand.h>
+#include <vtkImageConstantPad.h>
+#include <vtkMatrix4x4.h>
+#include <vtkPointData.h>
 
 // std includes
 #include <algorithm>
+#include <cstring>
+#include <set>
+
+namespace
+{
+//----------------------------------------------------------------------------
+template <class ScalarType>
+void GetDifferenceExtentGeneric(vtkImageData* image, vtkImageData* baselineImage, int differenceExtent[6])
+{
+  // Images are expected to have the same extent and number of components
+  int* extent = image->GetExtent();
+  int numberOfComponents = image->GetNumberOfScalarComponents();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    differenceExtent[axis * 2] = extent[axis * 2 + 1];
+    differenceExtent[axis * 2 + 1] = extent[axis * 2] - 1;
+  }
+  ScalarType* voxel = static_cast<ScalarType*>(image->GetScalarPointer());
+  ScalarType* baselineVoxel = static_cast<ScalarType*>(baselineImage->GetScalarPointer());
+  for (int k = extent[4]; k <= extent[5]; ++k)
+  {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+    {
+      for (int i = extent[0]; i <= extent[1]; ++i)
+      {
+        bool voxelModified = false;
+        for (int component = 0; component < numberOfComponents; ++component, ++voxel, ++baselineVoxel)
+        {
+          if (*voxel != *baselineVoxel)
+          {
+            voxelModified = true;
+          }
+        }
+        if (voxelModified)
+        {
+          differenceExtent[0] = std::min(differenceExtent[0], i);
+          differenceExtent[1] = std::max(differenceExtent[1], i);
+          differenceExtent[2] = std::min(differenceExtent[2], j);
+          differenceExtent[3] = std::max(differenceExtent[3], j);
+          differenceExtent[4] = std::min(differenceExtent[4], k);
+          differenceExtent[5] = std::max(differenceExtent[5], k);
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class ScalarType>
+void EncodeRunsGeneric(vtkImageData* image, const int extent[6], std::vector<vtkIdType>& runLengths, std::vector<char>& runValues)
+{
+  vtkIdType rowLength = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * image->GetNumberOfScalarComponents();
+  ScalarType runValue = 0;
+  for (int k = extent[4]; k <= extent[5]; ++k)
+  {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+    {
+      ScalarType* voxel = static_cast<ScalarType*>(image->GetScalarPointer(extent[0], j, k));
+      for (vtkIdType index = 0; index < rowLength; ++index, ++voxel)
+      {
+        if (!runLengths.empty() && runValue == *voxel)
+        {
+          ++runLengths.back();
+        }
+        else
+        {
+          runValue = *voxel;
+          runLengths.push_back(1);
+          const char* runValueBytes = reinterpret_cast<const char*>(&runValue);
+          runValues.insert(runValues.end(), runValueBytes, runValueBytes + sizeof(ScalarType));
+        }
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+template <class ScalarType>
+void DecodeRunsGeneric(vtkImageData* image, const int extent[6], const std::vector<vtkIdType>& runLengths, const std::vector<char>& runValues)
+{
+  vtkIdType rowLength = static_cast<vtkIdType>(extent[1] - extent[0] + 1) * image->GetNumberOfScalarComponents();
+  const vtkIdType numberOfRuns = static_cast<vtkIdType>(std::min(runLengths.size(), runValues.size() / sizeof(ScalarType)));
+  vtkIdType runIndex = 0;
+  vtkIdType remainingRunLength = (numberOfRuns > 0 ? runLengths[0] : 0);
+  ScalarType runValue = 0;
+  if (numberOfRuns > 0)
+  {
+    memcpy(&runValue, runValues.data(), sizeof(ScalarType));
+  }
+  for (int k = extent[4]; k <= extent[5]; ++k)
+  {
+    for (int j = extent[2]; j <= extent[3]; ++j)
+    {
+      ScalarType* voxel = static_cast<ScalarType*>(image->GetScalarPointer(extent[0], j, k));
+      for (vtkIdType index = 0; index < rowLength; ++index, ++voxel)
+      {
+        while (remainingRunLength == 0)
+        {
+          if (++runIndex >= numberOfRuns)
+          {
+            return;
+          }
+          remainingRunLength = runLengths[runIndex];
+          memcpy(&runValue, runValues.data() + runIndex * sizeof(ScalarType), sizeof(ScalarType));
+        }
+        *voxel = runValue;
+        --remainingRunLength;
+      }
+    }
+  }
+}
+} // end of anonymous namespace
 
 //----------------------------------------------------------------------------
 vtkStandardNewMacro(vtkSegmentationHistory);
@@ -40,9 +157,11 @@ vtkSegmentationHistory::vtkSegmentationHistory()
   this->Segmentation = nullptr;
 
   this->MaximumNumberOfStates = 5;
+  this->MaximumMemoryUsage = 0;
 
   this->LastRestoredState = 0;
   this->RestoreStateInProgress = false;
+  this->ReconstructedStateIndex = -1;
 
   this->SegmentationModifiedCallbackCommand = vtkCallbackCommand::New();
   this->SegmentationModifiedCallbackCommand->SetClientData( reinterpret_cast<void *>(this) );
@@ -98,6 +217,8 @@ void vtkSegmentationHistory::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << "Modified Time: " << this->GetMTime() << "\n";
 
   os << indent << "Number of saved states:  " << this->SegmentationStates.size() << "\n";
+  os << indent << "Memory usage (KiB):  " << this->GetMemoryUsage() << "\n";
+  os << indent << "Maximum memory usage (KiB):  " << this->MaximumMemoryUsage << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -141,7 +262,7 @@ bool vtkSegmentationHistory::SaveState()
     // Previous saved state of the segment
     // (if the new state has exactly the same representation then only a shallow copy will be made)
     vtkSegment* baselineSegment = nullptr;
-    if (this->SegmentationStates.size() > 0)
+    if (this->SegmentationStates.size() > 0 && !this->SegmentationStates.back().LabelmapsRestored)
     {
       SegmentsMap::iterator baselineSegmentIt = this->SegmentationStates.back().Segments.find(*segmentIDIt);
       if (baselineSegmentIt != this->SegmentationStates.back().Segments.end())
@@ -154,8 +275,15 @@ bool vtkSegmentationHistory::SaveState()
     vtkSegmentation::CopySegment(segmentClone, segment, baselineSegment, savedObjects);
     newSegmentationState.Segments[*segmentIDIt] = segmentClone;
   }
+  this->ClearReconstructedState();
   this->SegmentationStates.push_back(newSegmentationState);
 
+  // Only the most recent state stores full labelmaps
+  if (this->SegmentationStates.size() > 1)
+  {
+    this->CompressState((unsigned int)this->SegmentationStates.size() - 2);
+  }
+
   // Set the current state as last restored state.
   // Setting it to SegmentationStates.size() would mean that the state has been modified since
   // the state was saved.
@@ -222,7 +350,13 @@ bool vtkSegmentationHistory::RestoreState(unsigned int stateIndex)
 
   bool containedRepresentationNamesModified = false;
 
-  SegmentationState restoredState = this->SegmentationStates[stateIndex];
+  SegmentationState restoredState;
+  if (!this->GetFullState(stateIndex, restoredState))
+  {
+    vtkErrorMacro("RestoreState failed: cannot restore labelmaps of state " << stateIndex);
+    this->RestoreStateInProgress = false;
+    return false;
+  }
 
   std::set<std::string> segmentIDsToKeep;
   std::map<vtkDataObject*, vtkDataObject*> restoredRepresentations;
@@ -307,6 +441,19 @@ bool vtkSegmentationHistory::IsRestoreNextStateAvailable()
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::RemoveAllNextStates()
 {
+  if (this->SegmentationStates.size() > this->LastRestoredState + 1)
+  {
+    // The last restored state becomes the most recent state, which must store full labelmaps
+    SegmentationState fullState;
+    if (this->GetFullState(this->LastRestoredState, fullState))
+    {
+      this->SegmentationStates[this->LastRestoredState] = fullState;
+    }
+    else
+    {
+      vtkErrorMacro("RemoveAllNextStates: cannot restore labelmaps of state " << this->LastRestoredState);
+    }
+  }
   bool modified = false;
   while ((this->SegmentationStates.size() > this->LastRestoredState + 1) && (!this->SegmentationStates.empty()))
   {
@@ -315,6 +462,7 @@ void vtkSegmentationHistory::RemoveAllNextStates()
   }
   if (modified)
   {
+    this->ClearReconstructedState();
     this->Modified();
   }
 }
@@ -329,8 +477,17 @@ void vtkSegmentationHistory::RemoveAllObsoleteStates()
     this->LastRestoredState--;
     modified = true;
   }
+  // Older states only depend on more recent states, therefore the oldest states can be removed
+  while (this->MaximumMemoryUsage > 0 && this->SegmentationStates.size() > 1 && this->LastRestoredState > 0
+    && this->GetMemoryUsage() > this->MaximumMemoryUsage)
+  {
+    this->SegmentationStates.pop_front();
+    this->LastRestoredState--;
+    modified = true;
+  }
   if (modified)
   {
+    this->ClearReconstructedState();
     this->Modified();
   }
 }
@@ -347,6 +504,333 @@ void vtkSegmentationHistory::SetMaximumNumberOfStates(unsigned int maximumNumber
   this->Modified();
 }
 
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::SetMaximumMemoryUsage(unsigned long maximumMemoryUsageKiB)
+{
+  if (maximumMemoryUsageKiB == this->MaximumMemoryUsage)
+  {
+    return;
+  }
+  this->MaximumMemoryUsage = maximumMemoryUsageKiB;
+  this->RemoveAllObsoleteStates();
+  this->Modified();
+}
+
+//---------------------------------------------------------------------------
+unsigned long vtkSegmentationHistory::GetMemoryUsage()
+{
+  std::set<vtkDataObject*> countedRepresentations;
+  vtkTypeUInt64 memoryUsageBytes = 0;
+  for (const SegmentationState& state : this->SegmentationStates)
+  {
+    for (const auto& segmentIt : state.Segments)
+    {
+      std::vector<std::string> representationNames;
+      segmentIt.second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+      {
+        vtkDataObject* representation = segmentIt.second->GetRepresentation(representationName);
+        if (representation && countedRepresentations.insert(representation).second)
+        {
+          memoryUsageBytes += static_cast<vtkTypeUInt64>(representation->GetActualMemorySize()) * 1024;
+        }
+      }
+    }
+    for (const auto& differenceIt : state.LabelmapDifferences)
+    {
+      memoryUsageBytes += sizeof(LabelmapDifference) + differenceIt.second.RunLengths.capacity() * sizeof(vtkIdType)
+        + differenceIt.second.RunValues.capacity();
+    }
+  }
+  return static_cast<unsigned long>((memoryUsageBytes + 1023) / 1024);
+}
+
+//---------------------------------------------------------------------------
+bool vtkSegmentationHistory::CreateLabelmapDifference(vtkOrientedImageData* labelmap, vtkOrientedImageData* baselineLabelmap,
+  LabelmapDifference& difference)
+{
+  labelmap->GetExtent(difference.Extent);
+  difference.ScalarType = labelmap->GetScalarType();
+  difference.NumberOfScalarComponents = labelmap->GetNumberOfScalarComponents();
+  difference.ImageToWorldMatrix = vtkSmartPointer<vtkMatrix4x4>::New();
+  labelmap->GetImageToWorldMatrix(difference.ImageToWorldMatrix);
+  difference.RunLengths.clear();
+  difference.RunValues.clear();
+  for (int i = 0; i < 6; i += 2)
+  {
+    difference.ModifiedExtent[i] = 0;
+    difference.ModifiedExtent[i + 1] = -1;
+  }
+  if (labelmap->IsEmpty() || !labelmap->GetPointData()->GetScalars())
+  {
+    // Empty labelmap, only the metadata is needed
+    return false;
+  }
+
+  bool useBaseline = false;
+  if (baselineLabelmap && baselineLabelmap->GetPointData()->GetScalars()
+    && baselineLabelmap->GetScalarType() == difference.ScalarType
+    && baselineLabelmap->GetNumberOfScalarComponents() == difference.NumberOfScalarComponents)
+  {
+    vtkNew<vtkMatrix4x4> baselineImageToWorldMatrix;
+    baselineLabelmap->GetImageToWorldMatrix(baselineImageToWorldMatrix);
+    useBaseline = vtkOrientedImageDataResample::IsEqual(difference.ImageToWorldMatrix, baselineImageToWorldMatrix);
+  }
+
+  if (useBaseline && baselineLabelmap == labelmap)
+  {
+    // Unchanged labelmap (shared between the states)
+    return true;
+  }
+
+  if (useBaseline)
+  {
+    // Get baseline voxels in the labelmap extent (voxels outside the baseline extent are 0)
+    vtkNew<vtkImageConstantPad> padder;
+    padder->SetInputData(baselineLabelmap);
+    padder->SetConstant(0);
+    padder->SetOutputWholeExtent(difference.Extent);
+    padder->Update();
+    switch (difference.ScalarType)
+    {
+      vtkTemplateMacro(GetDifferenceExtentGeneric<VTK_TT>(labelmap, padder->GetOutput(), difference.ModifiedExtent));
+      default:
+        vtkErrorWithObjectMacro(labelmap, "CreateLabelmapDifference: Unknown image scalar type!");
+        return false;
+    }
+  }
+  else
+  {
+    labelmap->GetExtent(difference.ModifiedExtent);
+  }
+
+  if (difference.ModifiedExtent[0] <= difference.ModifiedExtent[1]
+    && difference.ModifiedExtent[2] <= difference.ModifiedExtent[3]
+    && difference.ModifiedExtent[4] <= difference.ModifiedExtent[5])
+  {
+    switch (difference.ScalarType)
+    {
+      vtkTemplateMacro(EncodeRunsGeneric<VTK_TT>(labelmap, difference.ModifiedExtent, difference.RunLengths, difference.RunValues));
+      default:
+        vtkErrorWithObjectMacro(labelmap, "CreateLabelmapDifference: Unknown image scalar type!");
+        return false;
+    }
+    difference.RunLengths.shrink_to_fit();
+    difference.RunValues.shrink_to_fit();
+  }
+  return useBaseline;
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkOrientedImageData> vtkSegmentationHistory::RestoreLabelmap(const LabelmapDifference& difference,
+  vtkOrientedImageData* baselineLabelmap)
+{
+  vtkSmartPointer<vtkOrientedImageData> labelmap = vtkSmartPointer<vtkOrientedImageData>::New();
+  bool extentValid = (difference.Extent[0] <= difference.Extent[1]
+    && difference.Extent[2] <= difference.Extent[3]
+    && difference.Extent[4] <= difference.Extent[5]);
+  if (baselineLabelmap && extentValid)
+  {
+    vtkNew<vtkImageConstantPad> padder;
+    padder->SetInputData(baselineLabelmap);
+    padder->SetConstant(0);
+    padder->SetOutputWholeExtent(const_cast<int*>(difference.Extent));
+    padder->Update();
+    labelmap->ShallowCopy(padder->GetOutput());
+  }
+  else
+  {
+    labelmap->SetExtent(const_cast<int*>(difference.Extent));
+    labelmap->AllocateScalars(difference.ScalarType, difference.NumberOfScalarComponents);
+  }
+  labelmap->SetGeometryFromImageToWorldMatrix(difference.ImageToWorldMatrix);
+
+  if (!difference.RunLengths.empty())
+  {
+    switch (difference.ScalarType)
+    {
+      vtkTemplateMacro(DecodeRunsGeneric<VTK_TT>(labelmap, difference.ModifiedExtent, difference.RunLengths, difference.RunValues));
+      default:
+        vtkErrorWithObjectMacro(labelmap, "RestoreLabelmap: Unknown image scalar type!");
+        return nullptr;
+    }
+  }
+  return labelmap;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::CompressState(unsigned int stateIndex)
+{
+  if (stateIndex + 1 >= this->SegmentationStates.size())
+  {
+    vtkErrorMacro("CompressState: the most recent state cannot be compressed");
+    return;
+  }
+  SegmentationState& state = this->SegmentationStates[stateIndex];
+  const SegmentationState& nextState = this->SegmentationStates[stateIndex + 1];
+  if (state.LabelmapsCompressed || nextState.LabelmapsCompressed)
+  {
+    return;
+  }
+
+  const std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
+  std::map<vtkOrientedImageData*, std::string> labelmapKeys;
+  for (auto& segmentIt : state.Segments)
+  {
+    const std::string& segmentId = segmentIt.first;
+    vtkOrientedImageData* labelmap = vtkOrientedImageData::SafeDownCast(segmentIt.second->GetRepresentation(labelmapRepresentationName));
+    if (!labelmap)
+    {
+      continue;
+    }
+    auto labelmapKeyIt = labelmapKeys.find(labelmap);
+    if (labelmapKeyIt != labelmapKeys.end())
+    {
+      // Shared labelmap is already stored
+      state.LabelmapKeys[segmentId] = labelmapKeyIt->second;
+      continue;
+    }
+    labelmapKeys[labelmap] = segmentId;
+    state.LabelmapKeys[segmentId] = segmentId;
+
+    vtkOrientedImageData* baselineLabelmap = nullptr;
+    SegmentsMap::const_iterator baselineSegmentIt = nextState.Segments.find(segmentId);
+    if (baselineSegmentIt != nextState.Segments.end())
+    {
+      baselineLabelmap = vtkOrientedImageData::SafeDownCast(baselineSegmentIt->second->GetRepresentation(labelmapRepresentationName));
+    }
+    LabelmapDifference& difference = state.LabelmapDifferences[segmentId];
+    if (CreateLabelmapDifference(labelmap, baselineLabelmap, difference))
+    {
+      difference.BaselineSegmentId = segmentId;
+    }
+  }
+
+  // Labelmaps are now stored as differences, remove the full copies
+  for (auto& segmentIt : state.Segments)
+  {
+    if (state.LabelmapKeys.find(segmentIt.first) != state.LabelmapKeys.end())
+    {
+      segmentIt.second->RemoveRepresentation(labelmapRepresentationName);
+    }
+  }
+  state.LabelmapsCompressed = true;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSegmentationHistory::GetFullState(unsigned int stateIndex, SegmentationState& fullState)
+{
+  if (stateIndex >= this->SegmentationStates.size())
+  {
+    return false;
+  }
+  // Start from the closest more recent state that stores full labelmaps (at least the most recent state does)
+  unsigned int fullStateIndex = stateIndex;
+  while (fullStateIndex < this->SegmentationStates.size() && this->SegmentationStates[fullStateIndex].LabelmapsCompressed)
+  {
+    ++fullStateIndex;
+  }
+  if (fullStateIndex >= this->SegmentationStates.size())
+  {
+    vtkErrorMacro("GetFullState: no state is found with full labelmaps");
+    return false;
+  }
+  bool labelmapsRestored = false;
+  if (this->ReconstructedStateIndex >= static_cast<int>(stateIndex)
+    && this->ReconstructedStateIndex < static_cast<int>(fullStateIndex))
+  {
+    // The last reconstructed state is closer (typically when undoing multiple times)
+    fullStateIndex = static_cast<unsigned int>(this->ReconstructedStateIndex);
+    fullState = this->ReconstructedState;
+    labelmapsRestored = true;
+  }
+  else
+  {
+    fullState = this->SegmentationStates[fullStateIndex];
+  }
+
+  // Apply differences going backward in time until the requested state is reached
+  const std::string labelmapRepresentationName = vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName();
+  while (fullStateIndex > stateIndex)
+  {
+    --fullStateIndex;
+    const SegmentationState& compressedState = this->SegmentationStates[fullStateIndex];
+
+    std::map<std::string, vtkSmartPointer<vtkOrientedImageData> > restoredLabelmaps;
+    for (const auto& differenceIt : compressedState.LabelmapDifferences)
+    {
+      const LabelmapDifference& difference = differenceIt.second;
+      vtkOrientedImageData* baselineLabelmap = nullptr;
+      if (!difference.BaselineSegmentId.empty())
+      {
+        SegmentsMap::iterator baselineSegmentIt = fullState.Segments.find(difference.BaselineSegmentId);
+        if (baselineSegmentIt != fullState.Segments.end())
+        {
+          baselineLabelmap = vtkOrientedImageData::SafeDownCast(baselineSegmentIt->second->GetRepresentation(labelmapRepresentationName));
+        }
+        if (!baselineLabelmap)
+        {
+          vtkErrorMacro("GetFullState: baseline labelmap is not found for segment " << difference.BaselineSegmentId);
+          return false;
+        }
+      }
+      if (baselineLabelmap && difference.RunLengths.empty()
+        && std::equal(difference.Extent, difference.Extent + 6, baselineLabelmap->GetExtent()))
+      {
+        // Labelmap has not changed, it can be shared between the restored states
+        restoredLabelmaps[differenceIt.first] = baselineLabelmap;
+      }
+      else
+      {
+        restoredLabelmaps[differenceIt.first] = RestoreLabelmap(difference, baselineLabelmap);
+      }
+      if (!restoredLabelmaps[differenceIt.first])
+      {
+        return false;
+      }
+    }
+
+    SegmentationState restoredState;
+    restoredState.SegmentIds = compressedState.SegmentIds;
+    for (const auto& segmentIt : compressedState.Segments)
+    {
+      // Segments of the stored state must not be modified, therefore add representations to a copy
+      vtkSmartPointer<vtkSegment> segment = vtkSmartPointer<vtkSegment>::New();
+      segment->DeepCopyMetadata(segmentIt.second);
+      std::vector<std::string> representationNames;
+      segmentIt.second->GetContainedRepresentationNames(representationNames);
+      for (const std::string& representationName : representationNames)
+      {
+        segment->AddRepresentation(representationName, segmentIt.second->GetRepresentation(representationName));
+      }
+      auto labelmapKeyIt = compressedState.LabelmapKeys.find(segmentIt.first);
+      if (labelmapKeyIt != compressedState.LabelmapKeys.end())
+      {
+        segment->AddRepresentation(labelmapRepresentationName, restoredLabelmaps[labelmapKeyIt->second]);
+      }
+      restoredState.Segments[segmentIt.first] = segment;
+    }
+    fullState = restoredState;
+    labelmapsRestored = true;
+  }
+  fullState.LabelmapsRestored = (fullState.LabelmapsRestored || labelmapsRestored);
+  if (labelmapsRestored)
+  {
+    // Segments of the reconstructed state are not modified after this point (RestoreState copies them
+    // into the segmentation), therefore they can be reused for reconstructing earlier states.
+    this->ReconstructedState = fullState;
+    this->ReconstructedStateIndex = static_cast<int>(stateIndex);
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void vtkSegmentationHistory::ClearReconstructedState()
+{
+  this->ReconstructedState = SegmentationState();
+  this->ReconstructedStateIndex = -1;
+}
+
 //---------------------------------------------------------------------------
 void vtkSegmentationHistory::OnSegmentationModified(vtkObject* vtkNotUsed(caller),
   unsigned long vtkNotUsed(eid),
@@ -377,6 +861,7 @@ void vtkSegmentationHistory::RemoveAllStates()
 {
   this->SegmentationStates.clear();
   this->LastRestoredState = 0;
+  this->ClearReconstructedState();
   this->Modified();
 }
 
@@ -28,15 +28,24 @@
 // STD includes
 #include <deque>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "vtkSegmentationCoreConfigure.h"
 
 class vtkCallbackCommand;
 class vtkDataObject;
+class vtkMatrix4x4;
+class vtkOrientedImageData;
 class vtkSegment;
 class vtkSegmentation;
 
+/// \brief Undo/redo states of a segmentation.
+///
+/// Only the most recent state stores a full copy of binary labelmaps. In older states, each labelmap
+/// is stored as a run-length encoded region that differs from the corresponding labelmap of the next
+/// state, therefore memory usage of a state is proportional to the size of the modification.
+/// Previous states are restored by applying these differences, starting from the most recent state.
 class vtkSegmentationCore_EXPORT vtkSegmentationHistory : public vtkObject
 {
 public:
@@ -85,6 +94,19 @@ public:
   /// Get the current number of states.
   int GetNumberOfStates();
 
+  /// Limits how much memory the stored states may use, in kibibytes.
+  /// If the memory usage exceeds the limit then the oldest states are removed (the most recent
+  /// and the last restored states are always kept). 0 means that memory usage is not limited
+  /// (only the number of states, see SetMaximumNumberOfStates). Default is 0.
+  void SetMaximumMemoryUsage(unsigned long maximumMemoryUsageKiB);
+
+  /// Get the memory usage limit of stored states, in kibibytes.
+  vtkGetMacro(MaximumMemoryUsage, unsigned long);
+
+  /// Get memory used by all stored states, in kibibytes.
+  /// Data objects that are shared between states are only counted once.
+  unsigned long GetMemoryUsage();
+
 protected:
   /// Callback function called when the segmentation has been modified.
   /// It clears all states that are more recent than the last restored state.
@@ -105,16 +127,68 @@ protected:
 
   typedef std::map<std::string, vtkSmartPointer<vtkSegment> > SegmentsMap;
 
+  /// Binary labelmap stored as the difference from a labelmap of the next state
+  struct LabelmapDifference
+  {
+    /// ID of the segment in the next state that contains the baseline labelmap.
+    /// If empty then the labelmap is restored from the runs only.
+    std::string BaselineSegmentId;
+    int Extent[6]{ 0, -1, 0, -1, 0, -1 };
+    int ScalarType{ VTK_UNSIGNED_CHAR };
+    int NumberOfScalarComponents{ 1 };
+    vtkSmartPointer<vtkMatrix4x4> ImageToWorldMatrix;
+    /// Region where voxels differ from the baseline labelmap
+    int ModifiedExtent[6]{ 0, -1, 0, -1, 0, -1 };
+    /// Run-length encoded voxels of ModifiedExtent: number of voxels in each run
+    std::vector<vtkIdType> RunLengths;
+    /// Voxel value of each run, stored in ScalarType (one value per run)
+    std::vector<char> RunValues;
+  };
+
   struct SegmentationState
   {
     SegmentsMap Segments;
     std::vector<std::string> SegmentIds; // order of segments
+    /// If true then binary labelmap representations are removed from Segments
+    /// and they are stored in LabelmapDifferences.
+    bool LabelmapsCompressed{ false };
+    /// If true then labelmaps were restored from differences. Modification time of these labelmaps
+    /// does not indicate if they are more recent than the segmentation, therefore they cannot be reused
+    /// when the next state is saved.
+    bool LabelmapsRestored{ false };
+    /// Labelmap key for each segment ID. Segments that share a labelmap have the same key.
+    std::map<std::string, std::string> LabelmapKeys;
+    /// Compressed labelmaps, indexed by labelmap key
+    std::map<std::string, LabelmapDifference> LabelmapDifferences;
   };
 
+  /// Get differences between a labelmap and a baseline labelmap.
+  /// \return True if the difference is relative to the baseline labelmap. If the baseline is not usable
+  ///   (missing, or has different geometry or scalar type) then the entire labelmap is stored.
+  static bool CreateLabelmapDifference(vtkOrientedImageData* labelmap, vtkOrientedImageData* baselineLabelmap,
+    LabelmapDifference& difference);
+
+  /// Restore a labelmap from the baseline labelmap and the differences
+  static vtkSmartPointer<vtkOrientedImageData> RestoreLabelmap(const LabelmapDifference& difference,
+    vtkOrientedImageData* baselineLabelmap);
+
+  /// Replace binary labelmaps of a state by their differences from the labelmaps of the next state.
+  void CompressState(unsigned int stateIndex);
+
+  /// Get a state with all binary labelmaps restored.
+  /// Differences are applied starting from the closest more recent state that has full labelmaps
+  /// or from the last reconstructed state, whichever is closer. Therefore restoring a sequence
+  /// of previous states only requires applying one difference per state.
+  bool GetFullState(unsigned int stateIndex, SegmentationState& fullState);
+
+  /// Discard the last reconstructed state. Must be called when states are added or removed.
+  void ClearReconstructedState();
+
   vtkSegmentation* Segmentation;
   vtkCallbackCommand* SegmentationModifiedCallbackCommand;
   std::deque<SegmentationState> SegmentationStates;
   unsigned int MaximumNumberOfStates;
+  unsigned long MaximumMemoryUsage;
 
   // Index of the state in SegmentationStates that was restored last.
   // If LastRestoredState == size of states then it means that the segmentation has changed
@@ -123,6 +197,10 @@ protected:
 
   bool RestoreStateInProgress;
 
+  /// Last state reconstructed by GetFullState and its index (-1 if there is no such state)
+  SegmentationState ReconstructedState;
+  int ReconstructedStateIndex;
+
 private:
   vtkSegmentationHistory(const vtkSegmentationHistory&) = delete;
   void operator=(const vtkSegmentationHistory&) = delete;
@@ -28,8 +28,10 @@
 // VTK includes
 #include <vtkImageConstantPad.h>
 #include <vtkImageThreshold.h>
+#include <vtkMatrix4x4.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkTransform.h>
 
 // STD includes
 #include <algorithm>
@@ -46,8 +48,17 @@ vtkSegmentationModifier::~vtkSegmentationModifier() = default;
 bool vtkSegmentationModifier::ModifyBinaryLabelmap(
   vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID, int mergeMode/*=MODE_REPLACE*/, const int extent[6]/*=0*/,
   bool minimumOfAllSegments/*=false*/, bool sourceRepresentationModifiedEnabled/*=false*/, std::vector<std::string> segmentIDsToOverwrite/*={}*/,
-  std::vector<std::string>* modifiedSegmentIDs/*=nullptr*/)
+  std::vector<std::string>* modifiedSegmentIDs/*=nullptr*/, int modifiedExtent[6]/*=nullptr*/)
 {
+  if (modifiedExtent)
+  {
+    // Entire segment may change, unless a smaller region can be determined
+    for (int i = 0; i < 3; ++i)
+    {
+      modifiedExtent[2 * i] = 0;
+      modifiedExtent[2 * i + 1] = -1;
+    }
+  }
   if (!segmentation || segmentID.empty() || !labelmap)
   {
     vtkGenericWarningMacro("vtkSegmentationModifier::SetBinaryLabelmapToSegment: Invalid inputs");
@@ -60,9 +71,11 @@ bool vtkSegmentationModifier::ModifyBinaryLabelmap(
   }
 
   // If there are segments on the same layer that we should not overwrite, determine if there are any under the modifier labelmap
+  bool segmentSeparated = false;
   if (vtkSegmentationModifier::SharedLabelmapShouldOverlap(segmentation, segmentID, segmentIDsToOverwrite))
   {
     vtkSegmentationModifier::SeparateModifiedSegmentFromSharedLabelmap(labelmap, segmentation, segmentID, extent, segmentIDsToOverwrite);
+    segmentSeparated = true;
   }
 
   if (modifiedSegmentIDs)
@@ -87,6 +100,11 @@ bool vtkSegmentationModifier::ModifyBinaryLabelmap(
     return false;
   }
 
+  // Segment geometry before modification, to detect if the labelmap is resampled
+  vtkNew<vtkMatrix4x4> segmentImageToWorldMatrixBefore;
+  segmentLabelmap->GetImageToWorldMatrix(segmentImageToWorldMatrixBefore);
+  bool segmentLabelmapEmptyBefore = segmentLabelmap->IsEmpty();
+
   bool wasSourceRepresentationModifiedEnabled = segmentation->SetSourceRepresentationModifiedEnabled(sourceRepresentationModifiedEnabled);
 
   bool segmentLabelmapModified = true;
@@ -97,6 +115,25 @@ bool vtkSegmentationModifier::ModifyBinaryLabelmap(
     return false;
   }
 
+  if (modifiedExtent && !segmentSeparated && !segmentLabelmapEmptyBefore && mergeMode != MODE_REPLACE)
+  {
+    vtkNew<vtkMatrix4x4> segmentImageToWorldMatrixAfter;
+    segmentLabelmap->GetImageToWorldMatrix(segmentImageToWorldMatrixAfter);
+    if (vtkOrientedImageDataResample::IsEqual(segmentImageToWorldMatrixBefore, segmentImageToWorldMatrixAfter))
+    {
+      // Voxels can only change within the extent of the modifier labelmap.
+      // Get that region in the IJK coordinate system of the segment labelmap.
+      int modifierExtent[6] = { 0, -1, 0, -1, 0, -1 };
+      vtkSegmentationModifier::GetExtentIntersection(labelmap->GetExtent(), extent, modifierExtent);
+      if (vtkSegmentationModifier::IsExtentValid(modifierExtent))
+      {
+        vtkNew<vtkTransform> modifierToSegmentTransform;
+        vtkOrientedImageDataResample::GetTransformBetweenOrientedImages(labelmap, segmentLabelmap, modifierToSegmentTransform);
+        vtkOrientedImageDataResample::TransformExtent(modifierExtent, modifierToSegmentTransform, modifiedExtent);
+      }
+    }
+  }
+
   // Shrink the image data extent to only contain the effective data (extent of non-zero voxels)
   vtkSegmentationModifier::ShrinkSegmentToEffectiveExtent(segmentLabelmap);
 
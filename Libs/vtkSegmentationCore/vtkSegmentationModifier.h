@@ -47,6 +47,9 @@ public:
   /// segment binary labelmap is shrunk to the effective extent. Display update is triggered.
   /// \param mergeMode Determines if the labelmap should replace the segment, combined with a maximum or minimum operation, or set under the mask.
   /// \param extent If extent is specified then only that extent of the labelmap is used.
+  /// \param modifiedExtent If specified then it is set to the region of the segment binary labelmap (in the IJK coordinate system
+  ///   of the segment binary labelmap) that may have been changed. It is set to an empty extent if the entire segment may have changed.
+  ///   Converters can use this information to only update the corresponding region of derived representations.
   enum
   {
     MODE_REPLACE = 0,
@@ -56,7 +59,8 @@ public:
   };
   static bool ModifyBinaryLabelmap(vtkOrientedImageData* labelmap, vtkSegmentation* segmentation, std::string segmentID,
     int mergeMode = MODE_REPLACE, const int extent[6] = nullptr, bool minimumOfAllSegments = false, bool sourceRepresentationModifiedEnabled = false,
-    const std::vector<std::string> segmentIdsToOverwrite = {}, std::vector<std::string>* modifiedSegmentIDs = nullptr);
+    const std::vector<std::string> segmentIdsToOverwrite = {}, std::vector<std::string>* modifiedSegmentIDs = nullptr,
+    int modifiedExtent[6] = nullptr);
 
   /// Get the list of segment IDs in the same shared labelmap that are contained within the mask
   /// \param segmentationNode Node containing the segmentation
@@ -0,0 +1,178 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// vtkTeem includes
+#include <vtkTeemNRRDReader.h>
+#include <vtkTeemNRRDWriter.h>
+
+// VTK includes
+#include <vtkDataArray.h>
+#include <vtkImageData.h>
+#include <vtkMinimalStandardRandomSequence.h>
+#include <vtkNew.h>
+#include <vtkPointData.h>
+#include <vtkTimerLog.h>
+#include <vtksys/SystemTools.hxx>
+
+// STD includes
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Label map: few large homogeneous regions (typical segmentation)
+void FillLabelmap(vtkImageData* image)
+{
+  int* dims = image->GetDimensions();
+  unsigned char* voxels = static_cast<unsigned char*>(image->GetScalarPointer());
+  for (int k = 0; k < dims[2]; ++k)
+  {
+    for (int j = 0; j < dims[1]; ++j)
+    {
+      for (int i = 0; i < dims[0]; ++i)
+      {
+        double x = i - dims[0] / 2.0;
+        double y = j - dims[1] / 2.0;
+        double z = k - dims[2] / 2.0;
+        double r2 = x * x + y * y + z * z;
+        *(voxels++) = static_cast<unsigned char>(r2 < dims[0] * dims[0] / 16.0 ? 1 : (r2 < dims[0] * dims[0] / 5.0 ? 2 : 0));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+// Intensity image: smooth gradient with noise (typical CT or MRI)
+void FillIntensityImage(vtkImageData* image)
+{
+  vtkNew<vtkMinimalStandardRandomSequence> random;
+  random->SetSeed(1234);
+  int* dims = image->GetDimensions();
+  short* voxels = static_cast<short*>(image->GetScalarPointer());
+  for (int k = 0; k < dims[2]; ++k)
+  {
+    for (int j = 0; j < dims[1]; ++j)
+    {
+      for (int i = 0; i < dims[0]; ++i)
+      {
+        random->Next();
+        *(voxels++) = static_cast<short>(i + 2 * j - k + random->GetRangeValue(-20.0, 20.0));
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+int TestWritePerformance(vtkImageData* image, const std::string& imageName, const std::string& tempDir,
+  int compressionLevel, int numberOfThreads, vtkIdType compressionBlockSize)
+{
+  std::string fileName = tempDir + "/vtkTeemNRRDWriterPerformanceTest_" + imageName + ".nrrd";
+  std::string measurementName = imageName + "-Level" + std::to_string(compressionLevel)
+    + (numberOfThreads == 1 ? "-SingleThread" : "-MultiThread");
+
+  vtkNew<vtkTeemNRRDWriter> writer;
+  writer->SetInputData(image);
+  writer->SetFileName(fileName.c_str());
+  writer->SetUseCompression(true);
+  writer->SetCompressionLevel(compressionLevel);
+  writer->SetNumberOfThreads(numberOfThreads);
+  if (compressionBlockSize > 0)
+  {
+    writer->SetCompressionBlockSize(compressionBlockSize);
+  }
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  writer->Write();
+  timer->StopTimer();
+  if (writer->GetWriteError())
+  {
+    std::cerr << "Line " << __LINE__ << ": failed to write " << fileName << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  double dataSize = static_cast<double>(image->GetPointData()->GetScalars()->GetDataSize())
+    * image->GetPointData()->GetScalars()->GetDataTypeSize();
+  double fileSize = static_cast<double>(vtksys::SystemTools::FileLength(fileName));
+  std::cout << measurementName << ": " << dataSize / 1e6 / timer->GetElapsedTime() << " MB/s, compression ratio "
+    << dataSize / fileSize << std::endl;
+
+  // Voxels must be restored exactly
+  vtkNew<vtkTeemNRRDReader> reader;
+  reader->SetFileName(fileName.c_str());
+  reader->Update();
+  vtkImageData* readImage = reader->GetOutput();
+  if (!readImage || !readImage->GetPointData()->GetScalars()
+    || readImage->GetPointData()->GetScalars()->GetDataSize() != image->GetPointData()->GetScalars()->GetDataSize()
+    || memcmp(readImage->GetScalarPointer(), image->GetScalarPointer(), static_cast<size_t>(dataSize)) != 0)
+  {
+    std::cerr << "Line " << __LINE__ << ": voxels read from " << fileName << " do not match the written image" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  vtksys::SystemTools::RemoveFile(fileName);
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkTeemNRRDWriterPerformanceTest(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::cerr << "Usage: " << argv[0] << " /path/to/temp [imageSize] [compressionBlockSize]" << std::endl;
+    return EXIT_FAILURE;
+  }
+  const std::string tempDir = argv[1];
+  int imageSize = 256;
+  if (argc > 2)
+  {
+    imageSize = atoi(argv[2]);
+  }
+  // Small blocks make small images compressed in multiple blocks (default block size is used if not specified)
+  vtkIdType compressionBlockSize = 0;
+  if (argc > 3)
+  {
+    compressionBlockSize = atoi(argv[3]);
+  }
+
+  vtkNew<vtkImageData> labelmap;
+  labelmap->SetDimensions(imageSize, imageSize, imageSize);
+  labelmap->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  FillLabelmap(labelmap);
+
+  vtkNew<vtkImageData> intensityImage;
+  intensityImage->SetDimensions(imageSize, imageSize, imageSize);
+  intensityImage->AllocateScalars(VTK_SHORT, 1);
+  FillIntensityImage(intensityImage);
+
+  const int compressionLevels[] = { 1, 6 };
+  for (int compressionLevel : compressionLevels)
+  {
+    for (int numberOfThreads : { 1, 0 })
+    {
+      if (TestWritePerformance(labelmap, "Labelmap", tempDir, compressionLevel, numberOfThreads, compressionBlockSize) != EXIT_SUCCESS
+        || TestWritePerformance(intensityImage, "Intensity", tempDir, compressionLevel, numberOfThreads, compressionBlockSize) != EXIT_SUCCESS)
+      {
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  std::cout << "Test passed." << std::endl;
+  return EXIT_SUCCESS;
+}
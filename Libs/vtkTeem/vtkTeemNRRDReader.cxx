@@ -49,11 +49,132 @@
 #include "vtkUnsignedLongArray.h"
 #include <vtksys/SystemTools.hxx>
 
+// STD includes
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <vector>
+
+// Memory mapping includes
+#ifdef _WIN32
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+# include <vtksys/Encoding.hxx>
+#else
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <unistd.h>
+#endif
+
 // Teem includes
 #include "teem/ten.h"
 
 vtkStandardNewMacro(vtkTeemNRRDReader);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Memory mapped file regions, indexed by the address of the first voxel.
+// Data arrays only provide the data pointer to their free function, therefore
+// the mapping information is looked up from this registry when unmapping.
+struct MemoryMappedRegion
+{
+  void* MappingAddress{ nullptr };
+  size_t MappingSize{ 0 };
+};
+std::mutex MemoryMappedRegionsMutex;
+std::map<void*, MemoryMappedRegion> MemoryMappedRegions;
+
+//----------------------------------------------------------------------------
+// Map a region of a file into memory (copy-on-write). Returns the address of the first byte of the region.
+void* MapFileRegion(const std::string& fileName, vtkTypeInt64 offset, vtkTypeInt64 size)
+{
+  if (size <= 0 || offset < 0)
+  {
+    return nullptr;
+  }
+#ifdef _WIN32
+  SYSTEM_INFO systemInfo;
+  GetSystemInfo(&systemInfo);
+  const vtkTypeInt64 alignment = systemInfo.dwAllocationGranularity;
+#else
+  const vtkTypeInt64 alignment = sysconf(_SC_PAGESIZE);
+#endif
+  // mapping must start at a page boundary
+  const vtkTypeInt64 alignedOffset = offset - offset % alignment;
+  const size_t mappingSize = static_cast<size_t>(size + offset - alignedOffset);
+  void* mappingAddress = nullptr;
+#ifdef _WIN32
+  HANDLE fileHandle = CreateFileW(vtksys::Encoding::ToWindowsExtendedPath(fileName).c_str(), GENERIC_READ,
+    FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (fileHandle == INVALID_HANDLE_VALUE)
+  {
+    return nullptr;
+  }
+  HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(fileHandle);
+  if (mappingHandle == nullptr)
+  {
+    return nullptr;
+  }
+  mappingAddress = MapViewOfFile(mappingHandle, FILE_MAP_COPY,
+    static_cast<DWORD>(alignedOffset >> 32), static_cast<DWORD>(alignedOffset & 0xFFFFFFFF), mappingSize);
+  // the view keeps the mapping alive
+  CloseHandle(mappingHandle);
+  if (mappingAddress == nullptr)
+  {
+    return nullptr;
+  }
+#else
+  int fileDescriptor = open(fileName.c_str(), O_RDONLY);
+  if (fileDescriptor < 0)
+  {
+    return nullptr;
+  }
+  // Private mapping: voxels can be modified in memory without changing the file
+  mappingAddress = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileDescriptor, static_cast<off_t>(alignedOffset));
+  // the mapping keeps the file open
+  close(fileDescriptor);
+  if (mappingAddress == MAP_FAILED)
+  {
+    return nullptr;
+  }
+#endif
+  void* dataAddress = static_cast<char*>(mappingAddress) + (offset - alignedOffset);
+  std::lock_guard<std::mutex> lock(MemoryMappedRegionsMutex);
+  MemoryMappedRegion& region = MemoryMappedRegions[dataAddress];
+  region.MappingAddress = mappingAddress;
+  region.MappingSize = mappingSize;
+  return dataAddress;
+}
+
+//----------------------------------------------------------------------------
+// Free function of memory mapped data arrays
+void UnmapFileRegion(void* dataAddress)
+{
+  MemoryMappedRegion region;
+  {
+    std::lock_guard<std::mutex> lock(MemoryMappedRegionsMutex);
+    auto regionIt = MemoryMappedRegions.find(dataAddress);
+    if (regionIt == MemoryMappedRegions.end())
+    {
+      return;
+    }
+    region = regionIt->second;
+    MemoryMappedRegions.erase(regionIt);
+  }
+#ifdef _WIN32
+  UnmapViewOfFile(region.MappingAddress);
+#else
+  munmap(region.MappingAddress, region.MappingSize);
+#endif
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkTeemNRRDReader::vtkTeemNRRDReader()
 {
@@ -359,6 +480,9 @@ void vtkTeemNRRDReader::ExecuteInformation()
     return;
   }
   this->CurrentFileName = this->GetFileName();
+  this->RawDataFileName.clear();
+  this->RawDataOffset = -1;
+  this->RangeAxisIndex = -1;
 
   nrrdNuke(this->nrrd); // nuke and reallocate to reset the state
   this->nrrd = nrrdNew();
@@ -674,10 +798,281 @@ void vtkTeemNRRDReader::ExecuteInformation()
     }
   }
 
+  this->UpdateRawDataLocation(nio);
+
   this->vtkImageReader2::ExecuteInformation();
   nio = nrrdIoStateNix(nio);
 }
 
+//----------------------------------------------------------------------------
+void vtkTeemNRRDReader::UpdateRawDataLocation(NrrdIoState* nio)
+{
+  this->RawDataFileName.clear();
+  this->RawDataOffset = -1;
+  this->RangeAxisIndex = -1;
+
+  unsigned int rangeAxisIdx[NRRD_DIM_MAX] = { 0 };
+  unsigned int rangeAxisNum = nrrdRangeAxesGet(this->nrrd, rangeAxisIdx);
+  if (rangeAxisNum == 1)
+  {
+    this->RangeAxisIndex = static_cast<int>(rangeAxisIdx[0]);
+  }
+
+  if (nio->encoding != nrrdEncodingRaw)
+  {
+    // Compressed or text encoding, voxels can only be accessed by teem
+    return;
+  }
+  const vtkTypeInt64 elementSize = static_cast<vtkTypeInt64>(nrrdElementSize(this->nrrd));
+  if (elementSize > 1 && nio->endian != airMyEndian())
+  {
+    // Byte swapping would be needed
+    return;
+  }
+  if (nio->dataFNFormat != nullptr || nio->dataFNArr->len > 1)
+  {
+    // Voxels are split between multiple files
+    return;
+  }
+  if (this->RangeAxisIndex > 0 && this->RangeAxisIndex != static_cast<int>(this->nrrd->dim) - 1)
+  {
+    // Components are neither interleaved nor stored one after the other
+    return;
+  }
+
+  bool attachedData = (nio->dataFNArr->len == 0);
+  std::string dataFileName = this->GetFileName();
+  if (!attachedData)
+  {
+    dataFileName = vtksys::SystemTools::CollapseFullPath(nio->dataFN[0],
+      vtksys::SystemTools::GetFilenamePath(this->GetFileName()));
+  }
+
+  std::ifstream dataFile(dataFileName.c_str(), std::ios::in | std::ios::binary);
+  if (dataFile.fail())
+  {
+    return;
+  }
+  std::string line;
+  if (attachedData)
+  {
+    // Attached data starts after the first empty line
+    bool headerEndFound = false;
+    while (std::getline(dataFile, line))
+    {
+      if (line.empty() || line == "\r")
+      {
+        headerEndFound = true;
+        break;
+      }
+    }
+    if (!headerEndFound)
+    {
+      return;
+    }
+  }
+  for (unsigned int lineIndex = 0; lineIndex < nio->lineSkip; ++lineIndex)
+  {
+    if (!std::getline(dataFile, line))
+    {
+      return;
+    }
+  }
+  vtkTypeInt64 dataOffset = static_cast<vtkTypeInt64>(dataFile.tellg());
+  const vtkTypeInt64 dataSize = elementSize * static_cast<vtkTypeInt64>(nrrdElementNumber(this->nrrd));
+  dataFile.seekg(0, std::ios::end);
+  const vtkTypeInt64 fileSize = static_cast<vtkTypeInt64>(dataFile.tellg());
+  if (nio->byteSkip < 0)
+  {
+    // Negative byte skip means that the data is at the end of the file
+    dataOffset = fileSize - dataSize;
+  }
+  else
+  {
+    dataOffset += nio->byteSkip;
+  }
+  if (dataOffset < 0 || dataOffset + dataSize > fileSize)
+  {
+    vtkWarningMacro("UpdateRawDataLocation: data file " << dataFileName << " is smaller than expected");
+    return;
+  }
+
+  this->RawDataFileName = dataFileName;
+  this->RawDataOffset = dataOffset;
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::CanReadComponent()
+{
+  this->ExecuteInformation();
+  return !this->RawDataFileName.empty() && this->PointDataType == vtkDataSetAttributes::SCALARS;
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::CanUseMemoryMapping()
+{
+  this->ExecuteInformation();
+  if (this->RawDataFileName.empty())
+  {
+    return false;
+  }
+  if (this->PointDataType != vtkDataSetAttributes::SCALARS
+    && this->PointDataType != vtkDataSetAttributes::VECTORS
+    && this->PointDataType != vtkDataSetAttributes::NORMALS)
+  {
+    // tensors may need to be expanded or transformed
+    return false;
+  }
+  // Components must be interleaved, as in VTK data arrays
+  if (this->RangeAxisIndex > 0 && this->NumberOfComponents != 1)
+  {
+    return false;
+  }
+  // The mapping starts at a page boundary, therefore the first voxel is only correctly aligned
+  // in memory if its offset in the file is a multiple of the voxel value size
+  // (it is not the case, for example, if the header of an attached file has an odd length).
+  const int elementSize = vtkAbstractArray::GetDataTypeSize(this->DataType);
+  return elementSize > 0 && this->RawDataOffset >= 0 && this->RawDataOffset % elementSize == 0;
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::IsMemoryMappedArray(vtkAbstractArray* array)
+{
+  if (!array || array->GetNumberOfValues() == 0)
+  {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(MemoryMappedRegionsMutex);
+  return MemoryMappedRegions.find(array->GetVoidPointer(0)) != MemoryMappedRegions.end();
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::ExecuteDataMemoryMapped(vtkImageData* imageData, vtkInformation* outInfo)
+{
+  vtkSmartPointer<vtkDataArray> voxels = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(this->DataType));
+  if (!voxels)
+  {
+    return false;
+  }
+  int extent[6] = { 0, -1, 0, -1, 0, -1 };
+  this->GetDataExtent(extent);
+  const vtkIdType numberOfValues = vtkIdType(extent[1] - extent[0] + 1)
+    * vtkIdType(extent[3] - extent[2] + 1)
+    * vtkIdType(extent[5] - extent[4] + 1)
+    * this->NumberOfComponents;
+  void* data = MapFileRegion(this->RawDataFileName, this->RawDataOffset,
+    static_cast<vtkTypeInt64>(numberOfValues) * voxels->GetDataTypeSize());
+  if (!data)
+  {
+    return false;
+  }
+  voxels->SetNumberOfComponents(this->NumberOfComponents);
+  voxels->SetVoidArray(data, numberOfValues, 0, vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+  voxels->SetArrayFreeFunction(UnmapFileRegion);
+  voxels->SetName(this->DataArrayName.c_str());
+
+  imageData->SetExtent(extent);
+  switch (this->PointDataType)
+  {
+    case vtkDataSetAttributes::SCALARS:
+      imageData->GetPointData()->SetScalars(voxels);
+      vtkDataObject::SetPointDataActiveScalarInfo(outInfo, this->DataType, this->NumberOfComponents);
+      break;
+    case vtkDataSetAttributes::VECTORS:
+      imageData->GetPointData()->SetVectors(voxels);
+      break;
+    case vtkDataSetAttributes::NORMALS:
+      imageData->GetPointData()->SetNormals(voxels);
+      break;
+  }
+  return true;
+}
+
+//----------------------------------------------------------------------------
+std::string vtkTeemNRRDReader::GetRawDataFileName()
+{
+  this->ExecuteInformation();
+  return this->RawDataFileName;
+}
+
+//----------------------------------------------------------------------------
+vtkTypeInt64 vtkTeemNRRDReader::GetRawDataOffset()
+{
+  this->ExecuteInformation();
+  return this->RawDataOffset;
+}
+
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDReader::ReadComponent(int component, vtkImageData* output)
+{
+  if (!output)
+  {
+    vtkErrorMacro("ReadComponent: invalid output image");
+    return false;
+  }
+  if (!this->CanReadComponent())
+  {
+    vtkErrorMacro("ReadComponent: voxels of " << (this->GetFileName() ? this->GetFileName() : "(none)")
+      << " cannot be accessed directly (the file may be compressed)");
+    return false;
+  }
+  const int numberOfComponents = this->NumberOfComponents;
+  if (component < 0 || component >= numberOfComponents)
+  {
+    vtkErrorMacro("ReadComponent: component " << component << " is out of range (number of components: " << numberOfComponents << ")");
+    return false;
+  }
+
+  output->SetExtent(this->GetDataExtent());
+  output->AllocateScalars(this->DataType, 1);
+  vtkDataArray* scalars = output->GetPointData()->GetScalars();
+  scalars->SetName(this->DataArrayName.c_str());
+  char* outputPtr = static_cast<char*>(scalars->GetVoidPointer(0));
+  const vtkTypeInt64 elementSize = scalars->GetDataTypeSize();
+  const vtkTypeInt64 numberOfVoxels = scalars->GetNumberOfTuples();
+
+  std::ifstream dataFile(this->RawDataFileName.c_str(), std::ios::in | std::ios::binary);
+  if (dataFile.fail())
+  {
+    vtkErrorMacro("ReadComponent: failed to open " << this->RawDataFileName);
+    return false;
+  }
+
+  if (this->RangeAxisIndex != 0 || numberOfComponents == 1)
+  {
+    // Components are stored one after the other, read a contiguous block
+    dataFile.seekg(this->RawDataOffset + component * numberOfVoxels * elementSize);
+    dataFile.read(outputPtr, numberOfVoxels * elementSize);
+  }
+  else
+  {
+    // Components are interleaved, read blocks of voxels and keep only the selected component
+    const vtkTypeInt64 voxelSize = elementSize * numberOfComponents;
+    const vtkTypeInt64 maxNumberOfVoxelsInBlock = std::max<vtkTypeInt64>(1, (vtkTypeInt64(1) << 24) / voxelSize);
+    std::vector<char> buffer(maxNumberOfVoxelsInBlock * voxelSize);
+    dataFile.seekg(this->RawDataOffset);
+    for (vtkTypeInt64 firstVoxel = 0; firstVoxel < numberOfVoxels && dataFile.good(); firstVoxel += maxNumberOfVoxelsInBlock)
+    {
+      const vtkTypeInt64 numberOfVoxelsInBlock = std::min(maxNumberOfVoxelsInBlock, numberOfVoxels - firstVoxel);
+      dataFile.read(buffer.data(), numberOfVoxelsInBlock * voxelSize);
+      const char* inputPtr = buffer.data() + component * elementSize;
+      for (vtkTypeInt64 voxelIndex = 0; voxelIndex < numberOfVoxelsInBlock; ++voxelIndex)
+      {
+        memcpy(outputPtr, inputPtr, elementSize);
+        outputPtr += elementSize;
+        inputPtr += voxelSize;
+      }
+    }
+  }
+
+  if (dataFile.fail())
+  {
+    vtkErrorMacro("ReadComponent: failed to read component " << component << " from " << this->RawDataFileName);
+    return false;
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 vtkImageData *vtkTeemNRRDReader::AllocateOutputData(vtkDataObject *out, vtkInformation* outInfo)
 {
@@ -915,6 +1310,16 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
         vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT()), 6);
   }
 
+  if (this->UseMemoryMapping && this->CanUseMemoryMapping())
+  {
+    vtkImageData* mappedImageData = vtkImageData::SafeDownCast(output);
+    if (mappedImageData && this->ExecuteDataMemoryMapped(mappedImageData, outInfo))
+    {
+      return;
+    }
+    vtkWarningMacro("Failed to map " << this->RawDataFileName << " into memory, reading the file instead");
+  }
+
   vtkImageData *imageData = this->AllocateOutputData(output, outInfo);
 
   if (this->GetFileName() == nullptr)
@@ -1112,4 +1517,5 @@ void vtkTeemNRRDReader::ExecuteDataWithInformation(vtkDataObject *output, vtkInf
 void vtkTeemNRRDReader::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "UseMemoryMapping: " << (this->UseMemoryMapping ? "true" : "false") << "\n";
 }
@@ -92,6 +92,55 @@ public:
   /// Get unit for specified axis
   const char* GetAxisUnit(unsigned int axis);
 
+  ///
+  /// Returns true if the voxels are stored uncompressed, in native byte order, in a single file,
+  /// and the range axis (if any) is the fastest or slowest axis.
+  /// In this case a single component of the image can be read by ReadComponent
+  /// without reading the entire file into memory.
+  bool CanReadComponent();
+
+  ///
+  /// Name of the file that contains the raw voxel data (the header file itself if the data is attached).
+  /// Empty if voxels cannot be accessed directly (see CanReadComponent).
+  std::string GetRawDataFileName();
+
+  ///
+  /// Position of the first voxel in the raw data file, in bytes.
+  /// Returns -1 if voxels cannot be accessed directly (see CanReadComponent).
+  vtkTypeInt64 GetRawDataOffset();
+
+  ///
+  /// Read a single scalar component of the image from the file into the output image.
+  /// For 4D sequence files each component corresponds to a frame.
+  /// Only the selected component is kept in memory, therefore this can be used for
+  /// reading frames of images that would not fit into memory.
+  /// The method does not use the pipeline and it does not modify the reader, therefore
+  /// it may be called from multiple threads concurrently after the header has been read.
+  /// Returns true on success.
+  bool ReadComponent(int component, vtkImageData* output);
+
+  ///
+  /// Map the voxel data file into memory instead of reading it.
+  /// Voxels are then loaded by the operating system when they are accessed and
+  /// the memory is shared with other processes that map the same file.
+  /// Only used if CanUseMemoryMapping() returns true (uncompressed data in native
+  /// byte order, which does not need to be reordered, and that starts at a file offset
+  /// that is a multiple of the voxel value size), otherwise the file is read.
+  /// Modifications of the voxels are not written to the file.
+  /// The file must not be modified or truncated while the image is in use.
+  /// Disabled by default.
+  vtkSetMacro(UseMemoryMapping, bool);
+  vtkGetMacro(UseMemoryMapping, bool);
+  vtkBooleanMacro(UseMemoryMapping, bool);
+
+  ///
+  /// Returns true if voxels can be accessed by mapping the file into memory (see UseMemoryMapping).
+  bool CanUseMemoryMapping();
+
+  ///
+  /// Returns true if the data of the array is a file mapped into memory by this reader.
+  static bool IsMemoryMappedArray(vtkAbstractArray* array);
+
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
   ///  is the given file name a NRRD file?
@@ -272,6 +321,20 @@ protected:
   std::map<unsigned int, std::string> AxisLabels;
   std::map<unsigned int, std::string> AxisUnits;
 
+  /// Location of the voxels in the file, set if they can be read directly (without teem decoding)
+  std::string RawDataFileName;
+  vtkTypeInt64 RawDataOffset{-1};
+  /// Index of the range (component) axis in the file, -1 if there is no range axis
+  int RangeAxisIndex{-1};
+
+  /// Determine the location of the voxels from the header information.
+  void UpdateRawDataLocation(NrrdIoState* nio);
+
+  /// Set output voxel array to the memory mapped data file. Returns false if mapping failed.
+  bool ExecuteDataMemoryMapped(vtkImageData* imageData, vtkInformation* outInfo);
+
+  bool UseMemoryMapping{false};
+
   void ExecuteInformation() override;
   void ExecuteDataWithInformation(vtkDataObject *output, vtkInformation* outInfo) override;
 
@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <map>
+#include <vector>
 
 #include "vtkTeemNRRDWriter.h"
 
@@ -7,7 +11,10 @@
 #include "vtkPointData.h"
 #include "vtkObjectFactory.h"
 #include "vtkInformation.h"
+#include <vtkSMPTools.h>
 #include <vtkVersion.h>
+#include <vtk_zlib.h>
+#include <vtksys/SystemTools.hxx>
 
 #include <itkMath.h>
 #include <vnl/vnl_double_3.h>
@@ -20,6 +27,34 @@ class AxisInfoMapType : public std::map<unsigned int, std::string> {};
 
 vtkStandardNewMacro(vtkTeemNRRDWriter);
 
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Compress a block of data into a complete gzip stream (header, deflate data, and trailer).
+// Concatenated gzip streams are decoded as a single stream by gzip readers.
+bool GzipCompressBlock(const unsigned char* data, size_t size, int level, std::vector<unsigned char>& compressed)
+{
+  z_stream stream;
+  memset(&stream, 0, sizeof(stream));
+  // 16 is added to the window bits to get gzip instead of zlib header
+  if (deflateInit2(&stream, level, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    return false;
+  }
+  compressed.resize(deflateBound(&stream, static_cast<uLong>(size)));
+  stream.next_in = const_cast<Bytef*>(data);
+  stream.avail_in = static_cast<uInt>(size);
+  stream.next_out = compressed.data();
+  stream.avail_out = static_cast<uInt>(compressed.size());
+  int result = deflate(&stream, Z_FINISH);
+  compressed.resize(stream.total_out);
+  deflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+} // end of anonymous namespace
+
 //----------------------------------------------------------------------------
 vtkTeemNRRDWriter::vtkTeemNRRDWriter()
 {
@@ -439,6 +474,20 @@ void vtkTeemNRRDWriter::WriteData()
   // set endianness as unknown of output
   nio->endian = airEndianUnknown;
 
+  // Compress large attached data using multiple threads: teem only writes the header
+  // and voxels are appended by AppendCompressedData.
+  bool multithreadedCompression = false;
+  if (nio->encoding == nrrdEncodingGzip && this->NumberOfThreads != 1)
+  {
+    std::string extension = vtksys::SystemTools::LowerCase(vtksys::SystemTools::GetFilenameLastExtension(this->GetFileName()));
+    size_t dataSize = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+    multithreadedCompression = (extension != ".nhdr" && dataSize > static_cast<size_t>(this->CompressionBlockSize));
+  }
+  if (multithreadedCompression)
+  {
+    nio->skipData = AIR_TRUE;
+  }
+
   // Write the nrrd to file.
   if (nrrdSave(this->GetFileName(), nrrd, nio))
   {
@@ -447,14 +496,87 @@ void vtkTeemNRRDWriter::WriteData()
                       << this->GetFileName() << ":\n" << err);
     this->WriteErrorOn();
   }
+  else if (multithreadedCompression && !this->AppendCompressedData(nrrd))
+  {
+    vtkErrorMacro("Write: Error writing compressed data to " << this->GetFileName());
+    this->WriteErrorOn();
+  }
   // Free the nrrd struct but don't touch nrrd->data
   nrrd = nrrdNix(nrrd);
   nio = nrrdIoStateNix(nio);
 }
 
+//----------------------------------------------------------------------------
+bool vtkTeemNRRDWriter::AppendCompressedData(Nrrd* nrrd)
+{
+  FILE* file = vtksys::SystemTools::Fopen(this->GetFileName(), "r+b");
+  if (!file)
+  {
+    return false;
+  }
+
+  // Attached data starts after an empty line
+  char headerEnd[2] = { 0, 0 };
+  bool success = (fseek(file, -2, SEEK_END) == 0 && fread(headerEnd, 1, 2, file) == 2);
+  success = success && (fseek(file, 0, SEEK_END) == 0);
+  if (success && (headerEnd[0] != '\n' || headerEnd[1] != '\n'))
+  {
+    success = (fputc('\n', file) != EOF);
+  }
+
+  const unsigned char* data = static_cast<const unsigned char*>(nrrd->data);
+  const size_t dataSize = nrrdElementNumber(nrrd) * nrrdElementSize(nrrd);
+  const size_t blockSize = static_cast<size_t>(this->CompressionBlockSize);
+  const size_t numberOfBlocks = (dataSize + blockSize - 1) / blockSize;
+  const bool multithreaded = (this->NumberOfThreads != 1);
+
+  // Blocks are compressed in batches to limit memory usage, each batch is written in order.
+  const size_t batchSize = 2 * static_cast<size_t>(multithreaded ? vtkSMPTools::GetEstimatedNumberOfThreads() : 1);
+  std::vector<std::vector<unsigned char>> compressedBlocks(batchSize);
+  for (size_t batchStart = 0; success && batchStart < numberOfBlocks; batchStart += batchSize)
+  {
+    const size_t batchEnd = std::min(batchStart + batchSize, numberOfBlocks);
+    std::atomic<bool> compressionSucceeded(true);
+    auto compressBlocks = [&](vtkIdType firstBlock, vtkIdType lastBlock)
+    {
+      for (size_t block = static_cast<size_t>(firstBlock); block < static_cast<size_t>(lastBlock); ++block)
+      {
+        size_t blockStart = block * blockSize;
+        if (!GzipCompressBlock(data + blockStart, std::min(blockSize, dataSize - blockStart),
+          this->CompressionLevel, compressedBlocks[block - batchStart]))
+        {
+          compressionSucceeded = false;
+        }
+      }
+    };
+    if (multithreaded)
+    {
+      vtkSMPTools::For(static_cast<vtkIdType>(batchStart), static_cast<vtkIdType>(batchEnd), 1, compressBlocks);
+    }
+    else
+    {
+      compressBlocks(static_cast<vtkIdType>(batchStart), static_cast<vtkIdType>(batchEnd));
+    }
+    success = compressionSucceeded;
+    for (size_t block = batchStart; success && block < batchEnd; ++block)
+    {
+      const std::vector<unsigned char>& compressed = compressedBlocks[block - batchStart];
+      success = (fwrite(compressed.data(), 1, compressed.size(), file) == compressed.size());
+    }
+  }
+
+  success = (fclose(file) == 0) && success;
+  return success;
+}
+
+//----------------------------------------------------------------------------
 void vtkTeemNRRDWriter::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os,indent);
+  os << indent << "UseCompression: " << this->UseCompression << "\n";
+  os << indent << "CompressionLevel: " << this->CompressionLevel << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "CompressionBlockSize: " << this->CompressionBlockSize << "\n";
 
   os << indent << "RAS to IJK Matrix: ";
      this->IJKToRASMatrix->PrintSelf(os,indent);
@@ -58,6 +58,20 @@ public:
   vtkSetClampMacro(CompressionLevel, int, 0, 9);
   vtkGetMacro(CompressionLevel, int);
 
+  /// Controls multithreaded compression of voxel data.
+  /// Voxel data is split into blocks (see CompressionBlockSize) that are compressed independently
+  /// and stored as consecutive gzip streams, which can be decoded by any gzip-capable NRRD reader.
+  /// Only used when compressed data is written into the header file (.nrrd).
+  /// 1 disables multithreading. Any other value (default is 0) compresses blocks in parallel using
+  /// VTK's SMP backend, with the number of threads configured there (see vtkSMPTools::Initialize).
+  vtkSetClampMacro(NumberOfThreads, int, 0, VTK_INT_MAX);
+  vtkGetMacro(NumberOfThreads, int);
+
+  /// Size of voxel data blocks (in bytes) that are compressed independently when multithreaded
+  /// compression is used. Larger blocks slightly improve compression ratio, but provide less parallelism.
+  vtkSetClampMacro(CompressionBlockSize, vtkIdType, 65536, VTK_INT_MAX);
+  vtkGetMacro(CompressionBlockSize, vtkIdType);
+
   vtkSetClampMacro(FileType,int,VTK_ASCII,VTK_BINARY);
   vtkGetMacro(FileType,int);
   void SetFileTypeToASCII() {this->SetFileType(VTK_ASCII);};
@@ -115,6 +129,11 @@ protected:
   /// Write method. It is called by vtkWriter::Write();
   void WriteData() override;
 
+  ///
+  /// Append gzip compressed voxel data to the file, using multiple threads.
+  /// Returns false on failure.
+  bool AppendCompressedData(Nrrd* nrrd);
+
   ///
   /// Flag to set to on when a write error occurred
   int WriteError;
@@ -129,6 +148,8 @@ protected:
 
   int UseCompression;
   int CompressionLevel;
+  int NumberOfThreads{0};
+  vtkIdType CompressionBlockSize{4 * 1024 * 1024};
   int FileType;
 
   AttributeMapType *Attributes;
@@ -47,6 +47,7 @@
 #include <vtkObjectFactory.h>
 #include <vtkPlane.h>
 #include <vtkPointData.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkStringArray.h>
 #include <vtkTransform.h>
@@ -58,6 +59,7 @@
 // STD includes
 #include <sstream>
 #include <algorithm>
+#include <vector>
 
 //----------------------------------------------------------------------------
 vtkMRMLMarkupsNode::vtkMRMLMarkupsNode()
@@ -1882,20 +1884,28 @@ void vtkMRMLMarkupsNode::ApplyTransform(vtkAbstractTransform* transform, bool ap
     }
   }
 
+  // Transform all control points at once, as it is much faster for non-linear transforms
   int numControlPoints = this->GetNumberOfControlPoints();
-  double xyzIn[3];
-  double xyzOut[3];
+  std::vector<int> transformedControlPointIndices;
+  vtkNew<vtkPoints> controlPointPositions;
+  double xyz[3];
   for (int controlPointIndex = 0; controlPointIndex < numControlPoints; controlPointIndex++)
   {
     if (!applyToLockedControlPoints && this->GetNthControlPointLocked(controlPointIndex))
     {
       continue;
     }
-
-    this->GetNthControlPointPosition(controlPointIndex, xyzIn);
-    transform->TransformPoint(xyzIn,xyzOut);
+    this->GetNthControlPointPosition(controlPointIndex, xyz);
+    controlPointPositions->InsertNextPoint(xyz);
+    transformedControlPointIndices.push_back(controlPointIndex);
+  }
+  vtkMRMLTransformNode::TransformPoints(transform, controlPointPositions, controlPointPositions);
+  for (vtkIdType pointIndex = 0; pointIndex < controlPointPositions->GetNumberOfPoints(); pointIndex++)
+  {
+    int controlPointIndex = transformedControlPointIndices[pointIndex];
+    controlPointPositions->GetPoint(pointIndex, xyz);
     int status = this->GetNthControlPointPositionStatus(controlPointIndex);
-    this->SetNthControlPointPosition(controlPointIndex, xyzOut, status);
+    this->SetNthControlPointPosition(controlPointIndex, xyz, status);
   }
   this->StorableModifiedTime.Modified();
   this->Modified();
@@ -1960,6 +1970,12 @@ bool vtkMRMLMarkupsNode::GetModifiedSinceRead()
   return false;
 }
 
+//---------------------------------------------------------------------------
+vtkMTimeType vtkMRMLMarkupsNode::GetContentMTime()
+{
+  return std::max(this->Superclass::GetContentMTime(), vtkMRMLStorableNode::GetDataObjectContentMTime(this->CurveInputPoly));
+}
+
 //---------------------------------------------------------------------------
 bool vtkMRMLMarkupsNode::ResetNthControlPointID(int n)
 {
@@ -629,6 +629,10 @@ public:
   /// \sa vtkMRMLStorableNode::GetModifiedSinceRead()
   bool GetModifiedSinceRead() override;
 
+  /// Includes modification of control point positions (including in-place modification of the point array).
+  /// \sa vtkMRMLNode::GetContentMTime()
+  vtkMTimeType GetContentMTime() override;
+
   /// Reset the id of the Nth control point according to the local policy
   /// Called after an already initialized markup has been added to the
   /// scene. Returns false if n out of bounds, true on success.
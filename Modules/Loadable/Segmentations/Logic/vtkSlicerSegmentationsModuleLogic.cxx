@@ -87,6 +87,8 @@
 #include <vtkEventBroker.h>
 
 // STD includes
+#include <algorithm>
+#include <array>
 #include <sstream>
 #include <string>
 
@@ -2036,8 +2038,9 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
   }
 
   std::vector<std::string> modifiedSegmentIDs;
+  int modifiedExtent[6] = { 0, -1, 0, -1, 0, -1 };
   bool result = vtkSegmentationModifier::ModifyBinaryLabelmap(labelmap, segmentation, segmentID, mergeMode, extent, minimumOfAllSegments,
-    false, segmentIdsToOverwrite, &modifiedSegmentIDs);
+    false, segmentIdsToOverwrite, &modifiedSegmentIDs, modifiedExtent);
 
   // Re-convert all other representations
   bool conversionHappened = false;
@@ -2045,6 +2048,49 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
   vtkSegment* segment = segmentation->GetSegment(segmentID);
   if (segment)
   {
+    // The modified extent is in the IJK coordinate system of the labelmap of the modified segment.
+    // Overwritten segments may be stored in other labelmaps (layers) that have different geometry,
+    // therefore the extent is transformed into the labelmap of each modified segment.
+    // Segments in the same layer share the labelmap, so they are converted together.
+    vtkOrientedImageData* modifiedLabelmap = vtkOrientedImageData::SafeDownCast(
+      segment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName()));
+    std::vector<vtkOrientedImageData*> layerLabelmaps;
+    std::vector<std::vector<std::string> > layerSegmentIDs;
+    for (const std::string& modifiedSegmentID : modifiedSegmentIDs)
+    {
+      vtkSegment* modifiedSegment = segmentation->GetSegment(modifiedSegmentID);
+      vtkOrientedImageData* layerLabelmap = modifiedSegment ? vtkOrientedImageData::SafeDownCast(
+        modifiedSegment->GetRepresentation(vtkSegmentationConverter::GetSegmentationBinaryLabelmapRepresentationName())) : nullptr;
+      std::vector<vtkOrientedImageData*>::iterator layerIt = std::find(layerLabelmaps.begin(), layerLabelmaps.end(), layerLabelmap);
+      if (layerIt == layerLabelmaps.end())
+      {
+        layerLabelmaps.push_back(layerLabelmap);
+        layerSegmentIDs.emplace_back();
+        layerIt = layerLabelmaps.end() - 1;
+      }
+      layerSegmentIDs[layerIt - layerLabelmaps.begin()].push_back(modifiedSegmentID);
+    }
+    std::vector<std::array<int, 6> > layerModifiedExtents(layerLabelmaps.size(), std::array<int, 6>{ { 0, -1, 0, -1, 0, -1 } });
+    for (size_t layerIndex = 0; layerIndex < layerLabelmaps.size(); ++layerIndex)
+    {
+      vtkOrientedImageData* layerLabelmap = layerLabelmaps[layerIndex];
+      if (!modifiedLabelmap || !layerLabelmap)
+      {
+        // Region is unknown, the segments are fully converted
+        continue;
+      }
+      if (layerLabelmap == modifiedLabelmap)
+      {
+        std::copy(modifiedExtent, modifiedExtent + 6, layerModifiedExtents[layerIndex].begin());
+        continue;
+      }
+      vtkNew<vtkTransform> modifiedToLayerTransform;
+      if (vtkOrientedImageDataResample::GetTransformBetweenOrientedImages(modifiedLabelmap, layerLabelmap, modifiedToLayerTransform))
+      {
+        vtkOrientedImageDataResample::TransformExtent(modifiedExtent, modifiedToLayerTransform, layerModifiedExtents[layerIndex].data());
+      }
+    }
+
     segment->GetContainedRepresentationNames(representationNames);
     for (std::vector<std::string>::iterator reprIt = representationNames.begin();
       reprIt != representationNames.end(); ++reprIt)
@@ -2061,7 +2107,11 @@ bool vtkSlicerSegmentationsModuleLogic::SetBinaryLabelmapToSegment(
         {
           continue;
         }
-        conversionHappened |= segmentation->ConvertSegmentsUsingPath(modifiedSegmentIDs, cheapestPath, true);
+        for (size_t layerIndex = 0; layerIndex < layerLabelmaps.size(); ++layerIndex)
+        {
+          conversionHappened |= segmentation->ConvertSegmentsUsingPath(layerSegmentIDs[layerIndex], cheapestPath, true,
+            layerModifiedExtents[layerIndex].data());
+        }
       }
     }
   }
@@ -54,6 +54,7 @@
 
 // STL includes
 #include <algorithm>
+#include <set>
 
 
 //----------------------------------------------------------------------------
@@ -69,6 +70,7 @@ vtkSlicerSequencesLogic::~vtkSlicerSequencesLogic() = default;
 void vtkSlicerSequencesLogic::PrintSelf(ostream& os, vtkIndent indent)
 {
   this->Superclass::PrintSelf(os, indent);
+  os << indent << "NumberOfPrefetchedItems: " << this->NumberOfPrefetchedItems << "\n";
 }
 
 //---------------------------------------------------------------------------
@@ -135,6 +137,8 @@ void vtkSlicerSequencesLogic::OnMRMLSceneNodeRemoved(vtkMRMLNode* node)
   {
     vtkDebugMacro("OnMRMLSceneNodeRemoved: Have a vtkMRMLSequenceBrowserNode node");
     vtkUnObserveMRMLNodeMacro(node);
+    this->ConsecutiveDroppedFrames.erase(vtkMRMLSequenceBrowserNode::SafeDownCast(node));
+    this->PrefetchedItems.erase(vtkMRMLSequenceBrowserNode::SafeDownCast(node));
   }
 }
 
@@ -147,7 +151,9 @@ vtkMRMLSequenceNode* vtkSlicerSequencesLogic::AddSequence(const char* filename,
   }
   vtkNew<vtkMRMLSequenceNode> sequenceNode;
   vtkNew<vtkMRMLSequenceStorageNode> sequenceStorageNode;
-  vtkNew<vtkMRMLVolumeSequenceStorageNode> volumeSequenceStorageNode;
+  // Create by class name to apply default properties set in the scene (such as lazy loading of frames)
+  vtkSmartPointer<vtkMRMLVolumeSequenceStorageNode> volumeSequenceStorageNode = vtkSmartPointer<vtkMRMLVolumeSequenceStorageNode>::Take(
+    vtkMRMLVolumeSequenceStorageNode::SafeDownCast(this->GetMRMLScene()->CreateNodeByClass("vtkMRMLVolumeSequenceStorageNode")));
 
   vtkMRMLStorageNode* storageNode = nullptr;
   if (sequenceStorageNode->SupportedFileType(filename))
@@ -255,12 +261,16 @@ void vtkSlicerSequencesLogic::UpdateAllProxyNodes()
     if (!browserNode->GetPlaybackActive())
     {
       this->LastSequenceBrowserUpdateTimeSec.erase(browserNode);
+      this->PrefetchedItems.erase(browserNode);
       continue;
     }
     if ( this->LastSequenceBrowserUpdateTimeSec.find(browserNode) == this->LastSequenceBrowserUpdateTimeSec.end() )
     {
       // we just started to play now, no need to update output nodes yet
       this->LastSequenceBrowserUpdateTimeSec[browserNode] = updateStartTimeSec;
+      browserNode->ResetNumberOfDroppedFrames();
+      this->ConsecutiveDroppedFrames[browserNode] = 0;
+      this->PrefetchItems(browserNode, browserNode->GetSelectedItemNumber() + 1, 1);
       continue;
     }
     // play is already in progress
@@ -275,9 +285,50 @@ void vtkSlicerSequencesLogic::UpdateAllProxyNodes()
       {
         selectionIncrement = 1;
       }
+      else
+      {
+        int& consecutiveDroppedFrames = this->ConsecutiveDroppedFrames[browserNode];
+        int nextItemNumber = this->GetPlaybackItemNumber(browserNode, selectionIncrement);
+        if (nextItemNumber >= 0 && consecutiveDroppedFrames < this->NumberOfPrefetchedItems
+          && !this->IsItemPrefetched(browserNode, nextItemNumber))
+        {
+          // Data of the next item is not ready yet. Keep the current item selected instead of
+          // waiting for it, to maintain the requested playback rate.
+          consecutiveDroppedFrames++;
+          browserNode->IncrementNumberOfDroppedFrames();
+          this->PrefetchItems(browserNode, nextItemNumber, 0);
+          continue;
+        }
+        consecutiveDroppedFrames = 0;
+      }
       browserNode->SelectNextItem(selectionIncrement);
     }
+    else
+    {
+      // There is time left until the next item has to be shown, prepare the following items
+      this->PrefetchItems(browserNode, browserNode->GetSelectedItemNumber() + 1, 1);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+int vtkSlicerSequencesLogic::GetPlaybackItemNumber(vtkMRMLSequenceBrowserNode* browserNode, int itemOffset)
+{
+  int numberOfItems = browserNode->GetNumberOfItems();
+  int itemNumber = std::max(browserNode->GetSelectedItemNumber(), 0) + itemOffset;
+  if (numberOfItems <= 0)
+  {
+    return -1;
+  }
+  if (itemNumber >= numberOfItems)
+  {
+    if (!browserNode->GetPlaybackLooped())
+    {
+      return -1;
+    }
+    itemNumber %= numberOfItems;
   }
+  return itemNumber;
 }
 
 //---------------------------------------------------------------------------
@@ -318,9 +369,10 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
     return;
   }
 
+  int selectedItemNumber=browserNode->GetSelectedItemNumber();
+
   this->UpdateProxyNodesFromSequencesInProgress = true;
 
-  int selectedItemNumber=browserNode->GetSelectedItemNumber();
   std::string indexValue("0");
   if (selectedItemNumber >= 0 && selectedItemNumber < browserNode->GetNumberOfItems())
   {
@@ -482,10 +534,33 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
     std::pair<vtkMRMLNode*, int> nodeModifiedState(targetProxyNode, targetProxyNode->StartModify());
     nodeModifiedStates.push_back(nodeModifiedState);
 
+    // Voxels of lazy-loaded volume sequence frames are read from file when the frame is displayed
+    vtkMRMLVolumeSequenceStorageNode* volumeSequenceStorageNode =
+      vtkMRMLVolumeSequenceStorageNode::SafeDownCast(synchronizedSequenceNode->GetStorageNode());
+    if (volumeSequenceStorageNode && volumeSequenceStorageNode->IsLazyLoadingActive())
+    {
+      // During playback the following frames are read in advance
+      int readAheadDirection = (browserNode->GetPlaybackActive() ? 1 : 0);
+      volumeSequenceStorageNode->LoadFrame(sourceDataNode, readAheadDirection);
+    }
+
     // TODO: if we really want to force non-mutable nodes in the sequence then we have to deep-copy, but that's slow.
     // Make sure that by default/most of the time shallow-copy is used.
     bool shallowCopy = browserNode->GetSaveChanges(synchronizedSequenceNode);
-    targetProxyNode->CopyContent(sourceDataNode, !shallowCopy);
+    vtkSmartPointer<vtkMRMLNode> prefetchedDataNode;
+    if (!shallowCopy)
+    {
+      prefetchedDataNode = this->TakePrefetchedItem(browserNode, sourceDataNode);
+    }
+    if (prefetchedDataNode)
+    {
+      // the prefetched node is a deep copy that is not used anywhere else, its content can be shared
+      targetProxyNode->CopyContent(prefetchedDataNode, false);
+    }
+    else
+    {
+      targetProxyNode->CopyContent(sourceDataNode, !shallowCopy);
+    }
 
     // Singleton nodes must not be renamed, as they are often expected to exist by a specific name
     if (browserNode->GetOverwriteProxyName(synchronizedSequenceNode) && !targetProxyNode->GetSingletonTag())
@@ -542,12 +617,171 @@ void vtkSlicerSequencesLogic::UpdateProxyNodesFromSequences(vtkMRMLSequenceBrows
 
   this->UpdateProxyNodesFromSequencesInProgress = false;
 
+  if (browserNode->GetPlaybackActive())
+  {
+    // Start reading the following items from file. Copies are made later, when there is time left before the next item.
+    this->PrefetchItems(browserNode, selectedItemNumber + 1, 0);
+  }
+
 #ifdef ENABLE_PERFORMANCE_PROFILING
   timer->StopTimer();
   vtkInfoMacro("UpdateProxyNodesFromSequences: " << timer->GetElapsedTime() << "sec\n");
 #endif
 }
 
+//---------------------------------------------------------------------------
+void vtkSlicerSequencesLogic::PrefetchItems(vtkMRMLSequenceBrowserNode* browserNode, int firstItemNumber, int maximumNumberOfCopiedItems)
+{
+  if (!browserNode || !browserNode->GetMasterSequenceNode() || this->NumberOfPrefetchedItems <= 0)
+  {
+    return;
+  }
+  vtkMRMLSequenceNode* masterSequenceNode = browserNode->GetMasterSequenceNode();
+  int numberOfItems = browserNode->GetNumberOfItems();
+  if (numberOfItems <= 0 || firstItemNumber < 0)
+  {
+    return;
+  }
+
+  std::vector< vtkMRMLSequenceNode* > synchronizedSequenceNodes;
+  browserNode->GetSynchronizedSequenceNodes(synchronizedSequenceNodes, true);
+
+  std::map<vtkMRMLNode*, PrefetchedItemType>& prefetchedItems = this->PrefetchedItems[browserNode];
+  // Data nodes of the prefetched items, copies of other data nodes are no longer needed
+  std::set<vtkMRMLNode*> prefetchedDataNodes;
+  int numberOfCopiedItems = 0;
+
+  int numberOfPrefetchedItems = std::min(this->NumberOfPrefetchedItems, numberOfItems);
+  for (int itemOffset = 0; itemOffset < numberOfPrefetchedItems; ++itemOffset)
+  {
+    int itemNumber = firstItemNumber + itemOffset;
+    if (itemNumber >= numberOfItems)
+    {
+      if (!browserNode->GetPlaybackLooped())
+      {
+        break;
+      }
+      itemNumber %= numberOfItems;
+    }
+    std::string indexValue = masterSequenceNode->GetNthIndexValue(itemNumber);
+    for (vtkMRMLSequenceNode* synchronizedSequenceNode : synchronizedSequenceNodes)
+    {
+      if (!synchronizedSequenceNode || !browserNode->GetPlayback(synchronizedSequenceNode))
+      {
+        continue;
+      }
+      vtkMRMLNode* dataNode = synchronizedSequenceNode->GetDataNodeAtValue(indexValue, /* exactMatchRequired= */ false);
+      if (!dataNode)
+      {
+        continue;
+      }
+      // Voxels of lazy-loaded volume sequence frames are read from file on background threads.
+      vtkMRMLVolumeSequenceStorageNode* volumeSequenceStorageNode =
+        vtkMRMLVolumeSequenceStorageNode::SafeDownCast(synchronizedSequenceNode->GetStorageNode());
+      if (volumeSequenceStorageNode && volumeSequenceStorageNode->IsFrameLoadPending(dataNode))
+      {
+        volumeSequenceStorageNode->PrefetchFrame(dataNode);
+        continue;
+      }
+      if (browserNode->GetSaveChanges(synchronizedSequenceNode))
+      {
+        // proxy node shares the content of the data node, there is nothing to prepare
+        continue;
+      }
+      // Proxy node gets a deep copy of the data node. The copy is made in advance, on the main thread,
+      // as data nodes in memory may be modified at any time.
+      prefetchedDataNodes.insert(dataNode);
+      PrefetchedItemType& prefetchedItem = prefetchedItems[dataNode];
+      if (prefetchedItem.SourceDataNode == dataNode && prefetchedItem.DataNode
+        && prefetchedItem.SourceContentMTime == dataNode->GetContentMTime())
+      {
+        // already prefetched
+        continue;
+      }
+      if (numberOfCopiedItems >= maximumNumberOfCopiedItems)
+      {
+        prefetchedItems.erase(dataNode);
+        continue;
+      }
+      prefetchedItem.SourceDataNode = dataNode;
+      prefetchedItem.SourceContentMTime = dataNode->GetContentMTime();
+      prefetchedItem.DataNode = vtkSmartPointer<vtkMRMLNode>::Take(dataNode->CreateNodeInstance());
+      prefetchedItem.DataNode->CopyContent(dataNode, true);
+      numberOfCopiedItems++;
+    }
+  }
+
+  for (auto prefetchedItemIt = prefetchedItems.begin(); prefetchedItemIt != prefetchedItems.end();)
+  {
+    if (prefetchedDataNodes.find(prefetchedItemIt->first) == prefetchedDataNodes.end())
+    {
+      prefetchedItemIt = prefetchedItems.erase(prefetchedItemIt);
+    }
+    else
+    {
+      ++prefetchedItemIt;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+vtkSmartPointer<vtkMRMLNode> vtkSlicerSequencesLogic::TakePrefetchedItem(vtkMRMLSequenceBrowserNode* browserNode, vtkMRMLNode* dataNode)
+{
+  auto prefetchedItemsIt = this->PrefetchedItems.find(browserNode);
+  if (!dataNode || prefetchedItemsIt == this->PrefetchedItems.end())
+  {
+    return nullptr;
+  }
+  auto prefetchedItemIt = prefetchedItemsIt->second.find(dataNode);
+  if (prefetchedItemIt == prefetchedItemsIt->second.end())
+  {
+    return nullptr;
+  }
+  vtkSmartPointer<vtkMRMLNode> prefetchedDataNode;
+  // The copy cannot be used if the data node has been modified since the copy was made
+  if (prefetchedItemIt->second.SourceDataNode == dataNode
+    && prefetchedItemIt->second.SourceContentMTime == dataNode->GetContentMTime())
+  {
+    prefetchedDataNode = prefetchedItemIt->second.DataNode;
+  }
+  // each copy is used only once, as the proxy node may modify it
+  prefetchedItemsIt->second.erase(prefetchedItemIt);
+  return prefetchedDataNode;
+}
+
+//---------------------------------------------------------------------------
+bool vtkSlicerSequencesLogic::IsItemPrefetched(vtkMRMLSequenceBrowserNode* browserNode, int itemNumber)
+{
+  if (!browserNode || !browserNode->GetMasterSequenceNode()
+    || itemNumber < 0 || itemNumber >= browserNode->GetNumberOfItems())
+  {
+    return true;
+  }
+  std::string indexValue = browserNode->GetMasterSequenceNode()->GetNthIndexValue(itemNumber);
+
+  std::vector< vtkMRMLSequenceNode* > synchronizedSequenceNodes;
+  browserNode->GetSynchronizedSequenceNodes(synchronizedSequenceNodes, true);
+  for (vtkMRMLSequenceNode* synchronizedSequenceNode : synchronizedSequenceNodes)
+  {
+    if (!synchronizedSequenceNode || !browserNode->GetPlayback(synchronizedSequenceNode))
+    {
+      continue;
+    }
+    vtkMRMLVolumeSequenceStorageNode* volumeSequenceStorageNode =
+      vtkMRMLVolumeSequenceStorageNode::SafeDownCast(synchronizedSequenceNode->GetStorageNode());
+    if (!volumeSequenceStorageNode)
+    {
+      continue;
+    }
+    vtkMRMLNode* dataNode = synchronizedSequenceNode->GetDataNodeAtValue(indexValue, /* exactMatchRequired= */ false);
+    if (dataNode && !volumeSequenceStorageNode->IsFrameReady(dataNode))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
 //---------------------------------------------------------------------------
 void vtkSlicerSequencesLogic::UpdateSequencesFromProxyNodes(vtkMRMLSequenceBrowserNode* browserNode, vtkMRMLNode* proxyNode)
 {
@@ -29,8 +29,13 @@
 
 // MRML includes
 
+// VTK includes
+#include <vtkSmartPointer.h>
+#include <vtkWeakPointer.h>
+
 // STD includes
 #include <cstdlib>
+#include <map>
 
 #include "vtkSlicerSequencesModuleLogicExport.h"
 
@@ -59,6 +64,17 @@ public:
   /// Refreshes the output of all the active browser nodes. Called regularly by a timer.
   void UpdateAllProxyNodes();
 
+  /// Number of items that are prepared ahead of the selected item during playback.
+  /// Voxels of lazy-loaded volume sequence frames are read from file on background threads.
+  /// Items that proxy nodes get a deep copy of (saving of changes is disabled) are copied in advance,
+  /// in update cycles when no new item has to be shown, so the proxy node only has to take the prepared copy.
+  /// Copies are made on the main thread, because data nodes in memory may be modified at any time.
+  /// If playback item skipping is enabled then the selected item is not advanced to items that are not
+  /// read in time, which is reported in the browser node as dropped frames.
+  /// Set to 0 to disable prefetching. Default is 2.
+  vtkGetMacro(NumberOfPrefetchedItems, int);
+  vtkSetClampMacro(NumberOfPrefetchedItems, int, 0, 100);
+
   /// Updates the contents of all the proxy nodes (all the nodes copied from the master and synchronized sequences to the scene)
   void UpdateProxyNodesFromSequences(vtkMRMLSequenceBrowserNode* browserNode);
 
@@ -118,9 +134,42 @@ protected:
 
   bool IsDataConnectorNode(vtkMRMLNode*);
 
+  /// Start preparing NumberOfPrefetchedItems items starting from firstItemNumber.
+  /// Reading of lazy-loaded frames is started for all these items, but deep copies
+  /// are only made for at most maximumNumberOfCopiedItems items, to limit the time spent in one call.
+  void PrefetchItems(vtkMRMLSequenceBrowserNode* browserNode, int firstItemNumber, int maximumNumberOfCopiedItems);
+
+  /// Returns true if the item can be copied to the proxy nodes without waiting for background preparation.
+  bool IsItemPrefetched(vtkMRMLSequenceBrowserNode* browserNode, int itemNumber);
+
+  /// Returns the prefetched deep copy of the data node and removes it from the prefetched items.
+  /// Returns nullptr if no copy was prepared or the data node has been modified since then.
+  vtkSmartPointer<vtkMRMLNode> TakePrefetchedItem(vtkMRMLSequenceBrowserNode* browserNode, vtkMRMLNode* dataNode);
+
+  /// Returns the item number that playback reaches after itemOffset steps from the selected item.
+  /// Returns -1 if playback ends before that (the sequence is not looped).
+  int GetPlaybackItemNumber(vtkMRMLSequenceBrowserNode* browserNode, int itemOffset);
+
   // Time of the last update of each browser node (in universal time)
   std::map< vtkMRMLSequenceBrowserNode*, double > LastSequenceBrowserUpdateTimeSec;
 
+  int NumberOfPrefetchedItems{2};
+
+  // Number of frames dropped in a row by each browser node. The number is limited to make sure
+  // proxy nodes are updated even if preparation is slower than the requested playback rate.
+  std::map< vtkMRMLSequenceBrowserNode*, int > ConsecutiveDroppedFrames;
+
+  struct PrefetchedItemType
+  {
+    vtkWeakPointer<vtkMRMLNode> SourceDataNode;
+    /// Content modified time of the source data node when the copy was made
+    vtkMTimeType SourceContentMTime{0};
+    /// Deep copy of the source data node
+    vtkSmartPointer<vtkMRMLNode> DataNode;
+  };
+  /// Deep copies of data nodes that are shown next, for each browser node
+  std::map< vtkMRMLSequenceBrowserNode*, std::map< vtkMRMLNode*, PrefetchedItemType > > PrefetchedItems;
+
 private:
 
   bool UpdateProxyNodesFromSequencesInProgress{false};
@@ -399,6 +399,7 @@ void vtkMRMLSequenceBrowserNode::PrintSelf(ostream& os, vtkIndent indent)
   os << indent << " Playback rate (fps): " << this->PlaybackRateFps << '\n';
   os << indent << " Playback item skipping enabled: " << (this->PlaybackItemSkippingEnabled ? "true" : "false") << '\n';
   os << indent << " Playback looped: " << (this->PlaybackLooped ? "true" : "false") << '\n';
+  os << indent << " Number of dropped frames: " << this->NumberOfDroppedFrames << '\n';
   os << indent << " Selected item number: " << this->SelectedItemNumber << '\n';
   os << indent << " Recording active: " << (this->RecordingActive ? "true" : "false") << '\n';
   os << indent << " Recording on master modified only: " << (this->RecordMasterOnly ? "true" : "false") << '\n';
@@ -1574,6 +1575,24 @@ vtkMRMLSequenceBrowserNode::MissingItemModeType vtkMRMLSequenceBrowserNode::GetM
   return MissingItemInvalid;
 }
 
+//-----------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::IncrementNumberOfDroppedFrames()
+{
+  this->NumberOfDroppedFrames++;
+  this->InvokeCustomModifiedEvent(PlaybackFrameDroppedEvent);
+}
+
+//-----------------------------------------------------------
+void vtkMRMLSequenceBrowserNode::ResetNumberOfDroppedFrames()
+{
+  if (this->NumberOfDroppedFrames == 0)
+  {
+    return;
+  }
+  this->NumberOfDroppedFrames = 0;
+  this->InvokeCustomModifiedEvent(PlaybackFrameDroppedEvent);
+}
+
 //-----------------------------------------------------------
 void vtkMRMLSequenceBrowserNode::SetIndexDisplayFormat(std::string indexDisplayNode)
 {
@@ -45,11 +45,14 @@ public:
   void PrintSelf(ostream& os, vtkIndent indent) override;
 
   /// ProxyNodeModifiedEvent is invoked when a proxy node is modified
+  /// PlaybackFrameDroppedEvent is invoked when a proxy node update was skipped during playback
+  /// because the data of the item was not ready yet
   enum
   {
     ProxyNodeModifiedEvent = 21001,
     IndexDisplayFormatModifiedEvent,
-    SequenceNodeModifiedEvent
+    SequenceNodeModifiedEvent,
+    PlaybackFrameDroppedEvent
   };
 
   /// Modes for determining recording frame rate.
@@ -155,6 +158,16 @@ public:
   vtkBooleanMacro(PlaybackItemSkippingEnabled, bool);
   //@}
 
+  //@{
+  /// Number of frames that were dropped during playback because item data was not prepared in time.
+  /// The counter is reset when playback is started. It is not saved in the scene.
+  /// Incrementing the counter invokes PlaybackFrameDroppedEvent (and not ModifiedEvent,
+  /// so that it does not trigger proxy node updates).
+  vtkGetMacro(NumberOfDroppedFrames, int);
+  void IncrementNumberOfDroppedFrames();
+  void ResetNumberOfDroppedFrames();
+  //@}
+
   //@{
   /// Get/Set playback looping (restart from the first sequence node when reached the last one)
   vtkGetMacro(PlaybackLooped, bool);
@@ -392,6 +405,7 @@ protected:
   bool PlaybackItemSkippingEnabled{true};
   bool PlaybackLooped{true};
   int SelectedItemNumber{-1};
+  int NumberOfDroppedFrames{0};
 
   bool RecordingActive{false};
   double RecordingTimeOffsetSec; // difference between universal time and index value
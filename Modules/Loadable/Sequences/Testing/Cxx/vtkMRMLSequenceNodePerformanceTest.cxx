@@ -0,0 +1,162 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include <vtkMRMLScene.h>
+#include <vtkMRMLSequenceNode.h>
+#include <vtkMRMLTransformNode.h>
+
+// VTK includes
+#include <vtkCollection.h>
+#include <vtkNew.h>
+#include <vtkStringArray.h>
+#include <vtkTimerLog.h>
+
+#include "vtkMRMLCoreTestingMacros.h"
+
+// STD includes
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace
+{
+
+//-----------------------------------------------------------------------------
+std::string GetIndexValue(int itemNumber)
+{
+  // 100 Hz recording
+  std::ostringstream indexValueStr;
+  indexValueStr << std::setprecision(10) << itemNumber * 0.01;
+  return indexValueStr.str();
+}
+
+//-----------------------------------------------------------------------------
+int TestSeekPerformance(int numberOfItems)
+{
+  // Create a sequence that only has index values (data node IDs are not resolved),
+  // so that the index can be large without using much memory.
+  std::ostringstream indexValuesStr;
+  for (int itemNumber = 0; itemNumber < numberOfItems; ++itemNumber)
+  {
+    if (itemNumber > 0)
+    {
+      indexValuesStr << ";";
+    }
+    indexValuesStr << "vtkMRMLLinearTransformNode" << itemNumber + 1 << ":" << GetIndexValue(itemNumber);
+  }
+  std::string indexValues = indexValuesStr.str();
+  const char* atts[] = { "indexType", "numeric", "indexValues", indexValues.c_str(), nullptr };
+
+  vtkNew<vtkMRMLSequenceNode> sequenceNode;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  sequenceNode->ReadXMLAttributes(atts);
+  timer->StopTimer();
+  CHECK_INT(sequenceNode->GetNumberOfDataNodes(), numberOfItems);
+  PRINT_DART_MEASUREMENT("vtkMRMLSequenceNode-ReadIndexValues-" + std::to_string(numberOfItems), timer->GetElapsedTime());
+
+  // Seek to each item (exact and closest match)
+  const int numberOfSeeks = std::min(numberOfItems, 100000);
+  timer->StartTimer();
+  for (int seekIndex = 0; seekIndex < numberOfSeeks; ++seekIndex)
+  {
+    int itemNumber = static_cast<int>((static_cast<long long>(seekIndex) * 7919) % numberOfItems);
+    if (sequenceNode->GetItemNumberFromIndexValue(GetIndexValue(itemNumber)) != itemNumber)
+    {
+      std::cerr << "Line " << __LINE__ << ": exact seek failed for item " << itemNumber << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkMRMLSequenceNode-ExactSeekTimePerItemUsec-" + std::to_string(numberOfItems), timer->GetElapsedTime() / numberOfSeeks * 1e6);
+
+  timer->StartTimer();
+  for (int seekIndex = 0; seekIndex < numberOfSeeks; ++seekIndex)
+  {
+    int itemNumber = static_cast<int>((static_cast<long long>(seekIndex) * 7919) % numberOfItems);
+    std::ostringstream betweenItemsStr;
+    betweenItemsStr << std::setprecision(10) << itemNumber * 0.01 + 0.005;
+    if (sequenceNode->GetItemNumberFromIndexValue(betweenItemsStr.str(), false) != itemNumber)
+    {
+      std::cerr << "Line " << __LINE__ << ": closest seek failed for item " << itemNumber << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  timer->StopTimer();
+  PRINT_DART_MEASUREMENT("vtkMRMLSequenceNode-ClosestSeekTimePerItemUsec-" + std::to_string(numberOfItems), timer->GetElapsedTime() / numberOfSeeks * 1e6);
+
+  return EXIT_SUCCESS;
+}
+
+//-----------------------------------------------------------------------------
+int TestAppendPerformance(int numberOfItems)
+{
+  vtkNew<vtkMRMLTransformNode> dataNode;
+
+  // Add items one by one
+  vtkNew<vtkMRMLSequenceNode> sequenceNode;
+  vtkNew<vtkTimerLog> timer;
+  timer->StartTimer();
+  for (int itemNumber = 0; itemNumber < numberOfItems; ++itemNumber)
+  {
+    sequenceNode->SetDataNodeAtValue(dataNode, GetIndexValue(itemNumber));
+  }
+  timer->StopTimer();
+  CHECK_INT(sequenceNode->GetNumberOfDataNodes(), numberOfItems);
+  PRINT_DART_MEASUREMENT("vtkMRMLSequenceNode-AppendTimePerItemUsec-" + std::to_string(numberOfItems), timer->GetElapsedTime() / numberOfItems * 1e6);
+
+  // Add all items at once
+  vtkNew<vtkCollection> dataNodes;
+  vtkNew<vtkStringArray> indexValues;
+  for (int itemNumber = 0; itemNumber < numberOfItems; ++itemNumber)
+  {
+    dataNodes->AddItem(dataNode);
+    indexValues->InsertNextValue(GetIndexValue(itemNumber));
+  }
+  vtkNew<vtkMRMLSequenceNode> bulkSequenceNode;
+  timer->StartTimer();
+  CHECK_BOOL(bulkSequenceNode->SetDataNodesAtValues(dataNodes, indexValues), true);
+  timer->StopTimer();
+  CHECK_INT(bulkSequenceNode->GetNumberOfDataNodes(), numberOfItems);
+  PRINT_DART_MEASUREMENT("vtkMRMLSequenceNode-BulkAppendTimePerItemUsec-" + std::to_string(numberOfItems), timer->GetElapsedTime() / numberOfItems * 1e6);
+
+  return EXIT_SUCCESS;
+}
+
+} // end of anonymous namespace
+
+//-----------------------------------------------------------------------------
+int vtkMRMLSequenceNodePerformanceTest(int argc, char* argv[])
+{
+  // Default sizes only check correctness quickly,
+  // vtkMRMLSequenceNodePerformanceBenchmark test passes larger sizes.
+  // Number of index values used for testing seek performance
+  int numberOfIndexedItems = 10000;
+  // Number of data nodes used for testing append performance (each item is a deep copy of a node)
+  int numberOfDataItems = 1000;
+  if (argc > 1)
+  {
+    numberOfIndexedItems = atoi(argv[1]);
+  }
+  if (argc > 2)
+  {
+    numberOfDataItems = atoi(argv[2]);
+  }
+  CHECK_EXIT_SUCCESS(TestSeekPerformance(numberOfIndexedItems));
+  CHECK_EXIT_SUCCESS(TestAppendPerformance(numberOfDataItems));
+  return EXIT_SUCCESS;
+}
@@ -26,8 +26,10 @@
 #include <vtkMRMLScene.h>
 
 // VTK includes
+#include <vtkCollection.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
+#include <vtkStringArray.h>
 
 #include "vtkMRMLCoreTestingMacros.h"
 #include "vtkTestingOutputWindow.h"
@@ -148,6 +150,30 @@ int vtkMRMLSequenceNodeTest1( int, char * [] )
   CHECK_INT(scene->GetNumberOfNodes(), 1);
   CHECK_INT(seqNode->GetNumberOfDataNodes(), 1);
 
+  // Add multiple data nodes at once
+  seqNode->RemoveAllDataNodes();
+  vtkNew<vtkCollection> bulkDataNodes;
+  vtkNew<vtkStringArray> bulkIndexValues;
+  for (int i = 0; i < numberOfDataNodes; ++i)
+  {
+    vtkNew<vtkMRMLTransformNode> bulkDataNode;
+    bulkDataNodes->AddItem(bulkDataNode);
+    // last value is out of order to test insertion
+    bulkIndexValues->InsertNextValue(i < numberOfDataNodes - 1 ? std::to_string(i * 2.0 + 1.0) : "-5");
+  }
+  CHECK_BOOL(seqNode->SetDataNodesAtValues(bulkDataNodes, bulkIndexValues), true);
+  CHECK_INT(seqNode->GetNumberOfDataNodes(), numberOfDataNodes);
+  CHECK_BOOL(SequenceSortedByIndex(seqNode.GetPointer()), true);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("-5"), 0);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("7.0"), 4);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("8"), -1);
+  CHECK_INT(seqNode->GetItemNumberFromIndexValue("8", false), 4);
+  bulkIndexValues->InsertNextValue("1000");
+  TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
+  CHECK_BOOL(seqNode->SetDataNodesAtValues(bulkDataNodes, bulkIndexValues), false);
+  TESTING_OUTPUT_ASSERT_ERRORS_END();
+  CHECK_INT(seqNode->GetNumberOfDataNodes(), numberOfDataNodes);
+
   /*
   bool res = true;
   TESTING_OUTPUT_ASSERT_ERRORS_BEGIN();
@@ -35,6 +35,7 @@
 #include <vtkImageData.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
+#include <vtkPointData.h>
 #include <vtkPolyData.h>
 
 #include "vtkMRMLCoreTestingMacros.h"
@@ -70,6 +71,90 @@ int TestWriteReadSequence(const std::string& tempDir, vtkMRMLSequenceNode* seque
   return EXIT_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+int TestLazyLoadingVolumeSequence(const std::string& tempDir, vtkMRMLScene* scene)
+{
+  const int numberOfFrames = 5;
+  vtkSmartPointer<vtkMRMLSequenceNode> imageSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
+  for (int frameIndex = 0; frameIndex < numberOfFrames; ++frameIndex)
+  {
+    vtkNew<vtkImageData> image;
+    image->SetDimensions(10, 8, 3);
+    image->AllocateScalars(VTK_SHORT, 1);
+    image->GetPointData()->GetScalars()->Fill(frameIndex * 10);
+    vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+    volumeNode->SetAndObserveImageData(image);
+    imageSequenceNode->SetDataNodeAtValue(volumeNode, std::to_string(frameIndex));
+  }
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> storageNode;
+  scene->AddNode(storageNode);
+  std::string fullFilePath = tempDir + "/TestLazyLoadingImageSequence.seq.nrrd";
+  storageNode->SetFileName(fullFilePath.c_str());
+  storageNode->SetUseCompression(false);
+  CHECK_BOOL(storageNode->WriteData(imageSequenceNode), true);
+
+  vtkNew<vtkMRMLSequenceNode> readSequenceNode;
+  scene->AddNode(readSequenceNode);
+  vtkNew<vtkMRMLVolumeSequenceStorageNode> readStorageNode;
+  scene->AddNode(readStorageNode);
+  readStorageNode->SetFileName(fullFilePath.c_str());
+  readStorageNode->LazyLoadingOn();
+  readStorageNode->SetMaximumNumberOfCachedFrames(2);
+  readStorageNode->SetNumberOfReadAheadFrames(1);
+  CHECK_BOOL(readStorageNode->ReadData(readSequenceNode), true);
+  CHECK_BOOL(readStorageNode->IsLazyLoadingActive(), true);
+  CHECK_INT(readSequenceNode->GetNumberOfDataNodes(), numberOfFrames);
+
+  // Frames only have geometry after reading
+  vtkMRMLScalarVolumeNode* frame2 = vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetNthDataNode(2));
+  CHECK_NOT_NULL(frame2);
+  CHECK_BOOL(readStorageNode->IsFrameLoadPending(frame2), true);
+  CHECK_NULL(frame2->GetImageData()->GetPointData()->GetScalars());
+  CHECK_INT(frame2->GetImageData()->GetDimensions()[0], 10);
+
+  // Load frame on demand, with read-ahead
+  CHECK_BOOL(readStorageNode->LoadFrame(frame2, 1), true);
+  CHECK_BOOL(readStorageNode->IsFrameLoadPending(frame2), false);
+  CHECK_NOT_NULL(frame2->GetImageData()->GetPointData()->GetScalars());
+  CHECK_DOUBLE(frame2->GetImageData()->GetScalarComponentAsDouble(4, 3, 1, 0), 20.0);
+
+  // Read-ahead frame is read in the background and stored in the data node when it is loaded
+  vtkMRMLScalarVolumeNode* frame3 = vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetNthDataNode(3));
+  CHECK_BOOL(readStorageNode->IsFrameLoadPending(frame3), true);
+  CHECK_BOOL(readStorageNode->LoadFrame(frame3), true);
+  CHECK_BOOL(readStorageNode->IsFrameReady(frame3), true);
+  CHECK_DOUBLE(frame3->GetImageData()->GetScalarComponentAsDouble(4, 3, 1, 0), 30.0);
+
+  // Least recently used frames are released
+  CHECK_BOOL(readStorageNode->LoadFrame(readSequenceNode->GetNthDataNode(0)), true);
+  CHECK_BOOL(readStorageNode->IsFrameLoadPending(frame2), true);
+  CHECK_BOOL(readStorageNode->IsFrameLoadPending(frame3), false);
+  CHECK_DOUBLE(vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetNthDataNode(0))
+    ->GetImageData()->GetScalarComponentAsDouble(0, 0, 0, 0), 0.0);
+
+  // Frames that are modified before they are loaded are not overwritten by the voxels in the file
+  vtkMRMLScalarVolumeNode* frame1 = vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetNthDataNode(1));
+  CHECK_BOOL(readStorageNode->PrefetchFrame(frame1), true);
+  vtkNew<vtkImageData> modifiedImage;
+  modifiedImage->SetDimensions(10, 8, 3);
+  modifiedImage->AllocateScalars(VTK_SHORT, 1);
+  modifiedImage->GetPointData()->GetScalars()->Fill(99);
+  frame1->SetAndObserveImageData(modifiedImage);
+  CHECK_BOOL(readStorageNode->IsFrameReady(frame1), true);
+  CHECK_BOOL(readStorageNode->LoadFrame(frame1), false);
+  CHECK_POINTER(frame1->GetImageData(), modifiedImage.GetPointer());
+  CHECK_DOUBLE(frame1->GetImageData()->GetScalarComponentAsDouble(4, 3, 1, 0), 99.0);
+
+  // All frames are read before writing
+  CHECK_BOOL(readStorageNode->CanWriteFromReferenceNode(readSequenceNode), true);
+  CHECK_BOOL(readStorageNode->WriteData(readSequenceNode), true);
+  CHECK_BOOL(readStorageNode->IsLazyLoadingActive(), false);
+  CHECK_DOUBLE(vtkMRMLScalarVolumeNode::SafeDownCast(readSequenceNode->GetNthDataNode(4))
+    ->GetImageData()->GetScalarComponentAsDouble(9, 7, 2, 0), 40.0);
+
+  return EXIT_SUCCESS;
+}
+
 //-----------------------------------------------------------------------------
 int vtkMRMLSequenceStorageNodeTest1( int argc, char * argv[] )
 {
@@ -110,6 +195,9 @@ int vtkMRMLSequenceStorageNodeTest1( int argc, char * argv[] )
     CHECK_EXIT_SUCCESS(TestWriteReadSequence(tempDir, imageSequenceNode, addedVolumeStorageNode, "TestImageSequence"));
   }
 
+  // Read volume node sequence frames on demand
+  CHECK_EXIT_SUCCESS(TestLazyLoadingVolumeSequence(tempDir, scene));
+
   // Add transform node sequence
   {
     vtkSmartPointer<vtkMRMLSequenceNode> transformSequenceNode = vtkMRMLSequenceNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceNode"));
@@ -270,6 +270,60 @@ namespace
 
     return EXIT_SUCCESS;
   }
+
+  int TestPlaybackPrefetch()
+  {
+    // Test that items copied in advance during playback are shown and modified items are not shown from stale copies
+
+    vtkSmartPointer<vtkMRMLScene> scene = vtkSmartPointer<vtkMRMLScene>::New();
+    vtkNew<vtkSlicerSequencesLogic> sequencesLogic;
+    sequencesLogic->SetMRMLScene(scene);
+    CHECK_INT(sequencesLogic->GetNumberOfPrefetchedItems(), 2);
+
+    vtkMRMLSequenceBrowserNode* browserNode = vtkMRMLSequenceBrowserNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLSequenceBrowserNode"));
+    vtkMRMLTextNode* proxyNode = vtkMRMLTextNode::SafeDownCast(scene->AddNewNodeByClass("vtkMRMLTextNode"));
+    vtkMRMLSequenceNode* sequenceNode = sequencesLogic->AddSynchronizedNode(nullptr, proxyNode, browserNode);
+    vtkNew<vtkMRMLTextNode> proxyNodeTemp;
+    proxyNodeTemp->SetText("Zero");
+    sequenceNode->SetDataNodeAtValue(proxyNodeTemp, "0");
+    proxyNodeTemp->SetText("One");
+    sequenceNode->SetDataNodeAtValue(proxyNodeTemp, "1");
+    proxyNodeTemp->SetText("Two");
+    sequenceNode->SetDataNodeAtValue(proxyNodeTemp, "2");
+    CHECK_BOOL(browserNode->GetSaveChanges(sequenceNode), false);
+
+    CHECK_BOOL(browserNode->SetSelectedItemByIndexValue("0"), true);
+    CHECK_STD_STRING(proxyNode->GetText(), "Zero");
+
+    // Low playback rate, so that UpdateAllProxyNodes calls only prepare the next items
+    browserNode->SetPlaybackRateFps(0.1);
+    browserNode->SetPlaybackActive(true);
+    sequencesLogic->UpdateAllProxyNodes();
+    sequencesLogic->UpdateAllProxyNodes();
+    CHECK_INT(browserNode->GetSelectedItemNumber(), 0);
+
+    // Prepared copy is shown
+    browserNode->SelectNextItem();
+    CHECK_STD_STRING(proxyNode->GetText(), "One");
+    // Proxy node has its own copy
+    proxyNode->SetText("Changed");
+    CHECK_STD_STRING(vtkMRMLTextNode::SafeDownCast(sequenceNode->GetDataNodeAtValue("1"))->GetText(), "One");
+
+    // Item that is modified after it has been copied is shown with the modification
+    sequencesLogic->UpdateAllProxyNodes();
+    vtkMRMLTextNode::SafeDownCast(sequenceNode->GetDataNodeAtValue("2"))->SetText("Two modified");
+    browserNode->SelectNextItem();
+    CHECK_STD_STRING(proxyNode->GetText(), "Two modified");
+
+    // Items are not prepared when playback is stopped
+    browserNode->SetPlaybackActive(false);
+    sequencesLogic->UpdateAllProxyNodes();
+    browserNode->SelectNextItem();
+    CHECK_STD_STRING(proxyNode->GetText(), "Zero");
+    CHECK_INT(browserNode->GetNumberOfDroppedFrames(), 0);
+
+    return EXIT_SUCCESS;
+  }
 }
 
 int vtkSlicerSequencesLogicTest1(int , char * [] )
@@ -277,5 +331,6 @@ int vtkSlicerSequencesLogicTest1(int , char * [] )
   CHECK_EXIT_SUCCESS(TestLogicWithoutScene());
   CHECK_EXIT_SUCCESS(TestAddSequence());
   CHECK_EXIT_SUCCESS(TestSparseSequence());
+  CHECK_EXIT_SUCCESS(TestPlaybackPrefetch());
   return EXIT_SUCCESS;
 }
@@ -70,6 +70,7 @@ void qMRMLSequenceBrowserPlayWidgetPrivate::init()
   QObject::connect( this->doubleSpinBox_VcrPlaybackRate, SIGNAL(valueChanged(double)), q, SLOT(setPlaybackRateFps(double)) );
   QObject::connect(this->pushButton_VcrRecord, SIGNAL(toggled(bool)), q, SLOT(setRecordingEnabled(bool)));
   QObject::connect(this->pushButton_Snapshot, SIGNAL(clicked()), q, SLOT(onRecordSnapshot()));
+  this->label_DroppedFrames->setVisible(false);
 
   q->setPlayPauseShortcut(this->PlayPauseShortcut);
   q->setPreviousFrameShortcut(this->PreviousFrameShortcut);
@@ -106,6 +107,8 @@ void qMRMLSequenceBrowserPlayWidget::setMRMLSequenceBrowserNode(vtkMRMLSequenceB
 
   qvtkReconnect(d->SequenceBrowserNode, browserNode, vtkCommand::ModifiedEvent,
                 this, SLOT(updateWidgetFromMRML()));
+  qvtkReconnect(d->SequenceBrowserNode, browserNode, vtkMRMLSequenceBrowserNode::PlaybackFrameDroppedEvent,
+                this, SLOT(updateWidgetFromMRML()));
 
   d->SequenceBrowserNode = browserNode;
   this->updateWidgetFromMRML();
@@ -160,6 +163,11 @@ void qMRMLSequenceBrowserPlayWidget::updateWidgetFromMRML()
   d->pushButton_Snapshot->setVisible(recordingAllowed && d->RecordingControlsVisible);
   d->pushButton_Snapshot->setEnabled(!playbackActive && !recordingActive);
 
+  // Dropped frames are only displayed if there are any, to not clutter the toolbar
+  int numberOfDroppedFrames = d->SequenceBrowserNode->GetNumberOfDroppedFrames();
+  d->label_DroppedFrames->setVisible(numberOfDroppedFrames > 0);
+  d->label_DroppedFrames->setText(tr("Dropped: %1").arg(numberOfDroppedFrames));
+
   foreach( QObject*w, vcrPlaybackControls ) { w->setProperty( "enabled", vcrControlsEnabled ); }
 }
 
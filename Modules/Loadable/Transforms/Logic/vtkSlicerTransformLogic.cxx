@@ -697,6 +697,34 @@ vtkMRMLTransformNode* vtkSlicerTransformLogic::ConvertToGridTransform(vtkMRMLTra
   return outputGridTransformNode.GetPointer();
 }
 
+//----------------------------------------------------------------------------
+bool vtkSlicerTransformLogic::SetGridTransformPrecomputedInverse(vtkMRMLTransformNode* transformNode,
+  bool enable /* = true */, vtkImageData* convergenceMask /* = nullptr */)
+{
+  vtkMRMLGridTransformNode* gridTransformNode = vtkMRMLGridTransformNode::SafeDownCast(transformNode);
+  if (!gridTransformNode)
+  {
+    vtkGenericWarningMacro("vtkSlicerTransformLogic::SetGridTransformPrecomputedInverse failed: invalid grid transform node");
+    return false;
+  }
+  gridTransformNode->SetPrecomputedInverse(enable);
+  if (!enable)
+  {
+    return true;
+  }
+  if (!gridTransformNode->UpdatePrecomputedInverse())
+  {
+    vtkGenericWarningMacro("vtkSlicerTransformLogic::SetGridTransformPrecomputedInverse failed:"
+      " inverse cannot be computed for transform " << (gridTransformNode->GetID() ? gridTransformNode->GetID() : "(unknown)"));
+    return false;
+  }
+  if (convergenceMask)
+  {
+    convergenceMask->DeepCopy(gridTransformNode->GetPrecomputedInverseConvergenceMask());
+  }
+  return true;
+}
+
 //----------------------------------------------------------------------------
 bool vtkSlicerTransformLogic::GetTransformedPointSamplesAsVectorImage(vtkImageData* vectorImage,
   vtkMRMLTransformNode* inputTransformNode, vtkMatrix4x4* ijkToRAS, bool transformToWorld /* = true */)
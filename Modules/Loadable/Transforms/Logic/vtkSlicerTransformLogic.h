@@ -111,6 +111,15 @@ class VTK_SLICER_TRANSFORMS_MODULE_LOGIC_EXPORT vtkSlicerTransformLogic : public
   vtkMRMLTransformNode* ConvertToGridTransform(vtkMRMLTransformNode* inputTransformNode, vtkMRMLVolumeNode* referenceVolumeNode = nullptr,
     vtkMRMLTransformNode* existingOutputTransformNode = nullptr);
 
+  /// Enable or disable using a precomputed inverse displacement field for a grid transform node.
+  /// If enabled then points are transformed by the inverse of the grid transform using interpolation
+  /// instead of an iterative inversion at each point (see vtkMRMLGridTransformNode::SetPrecomputedInverse).
+  /// The inverse is computed immediately, so that the first use of the inverse transform is not delayed.
+  /// If convergenceMask is specified then it is set to 1 at grid points where the inversion converged and 0 elsewhere.
+  /// Returns false if the inverse displacement field cannot be computed for the transform node.
+  static bool SetGridTransformPrecomputedInverse(vtkMRMLTransformNode* transformNode, bool enable = true,
+    vtkImageData* convergenceMask = nullptr);
+
   /// Take samples from the displacement field and store the magnitude in an image volume
   /// The extents of the output image must be set before calling this method.
   /// The origin and spacing attributes of the output image are ignored (origin, spacing, and axis directions
@@ -18,6 +18,7 @@
 #include "vtkMRMLSliceLogic.h"
 #include "vtkMRMLVolumeRenderingDisplayNode.h"
 #include "vtkSlicerVolumeRenderingLogic.h"
+#include "vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode.h"
 #include "vtkMRMLCPURayCastVolumeRenderingDisplayNode.h"
 #include "vtkMRMLGPURayCastVolumeRenderingDisplayNode.h"
 #include "vtkMRMLMultiVolumeRenderingDisplayNode.h"
@@ -72,6 +73,8 @@ vtkSlicerVolumeRenderingLogic::vtkSlicerVolumeRenderingLogic()
 
   this->RegisterRenderingMethod("VTK CPU Ray Casting",
     "vtkMRMLCPURayCastVolumeRenderingDisplayNode");
+  this->RegisterRenderingMethod("VTK CPU Ray Casting with empty space skipping",
+    "vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode");
   this->RegisterRenderingMethod("VTK GPU Ray Casting",
     "vtkMRMLGPURayCastVolumeRenderingDisplayNode");
   this->RegisterRenderingMethod("VTK Multi-Volume (experimental)",
@@ -141,6 +144,9 @@ void vtkSlicerVolumeRenderingLogic::RegisterNodes()
   this->GetMRMLScene()->RegisterNodeClass( cpuVRNode.GetPointer(), "VolumeRenderingParameters");
 #endif
 
+  vtkNew<vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode> cpuEmptySpaceSkippingNode;
+  this->GetMRMLScene()->RegisterNodeClass( cpuEmptySpaceSkippingNode.GetPointer() );
+
   vtkNew<vtkMRMLGPURayCastVolumeRenderingDisplayNode> gpuNode;
   this->GetMRMLScene()->RegisterNodeClass( gpuNode.GetPointer() );
 
@@ -0,0 +1,35 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// MRML includes
+#include "vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode.h"
+
+// VTK includes
+#include <vtkObjectFactory.h>
+
+//----------------------------------------------------------------------------
+vtkMRMLNodeNewMacro(vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode);
+
+//----------------------------------------------------------------------------
+vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode::vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode() = default;
+
+//----------------------------------------------------------------------------
+vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode::~vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode() = default;
+
+//----------------------------------------------------------------------------
+void vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+}
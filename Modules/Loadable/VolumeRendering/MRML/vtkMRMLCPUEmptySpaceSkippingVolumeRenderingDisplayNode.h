@@ -0,0 +1,51 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode_h
+#define __vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode_h
+
+// Volume Rendering includes
+#include "vtkMRMLCPURayCastVolumeRenderingDisplayNode.h"
+
+/// \brief MRML node for storing information for CPU Raycast Volume Rendering with empty space skipping.
+///
+/// Rays are not cast through regions of the volume that are fully transparent according to the
+/// current scalar opacity transfer function. All other display properties are the same
+/// as in vtkMRMLCPURayCastVolumeRenderingDisplayNode.
+class VTK_SLICER_VOLUMERENDERING_MODULE_MRML_EXPORT vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode
+  : public vtkMRMLCPURayCastVolumeRenderingDisplayNode
+{
+public:
+  static vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode *New();
+  vtkTypeMacro(vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode,vtkMRMLCPURayCastVolumeRenderingDisplayNode);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  vtkMRMLNode* CreateNodeInstance() override;
+
+  /// Copy node content (excludes basic data, such as name and node references).
+  /// \sa vtkMRMLNode::CopyContent
+  vtkMRMLCopyContentDefaultMacro(vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode);
+
+  /// Get node XML tag name (like Volume, Model)
+  const char* GetNodeTagName() override {return "CPUEmptySpaceSkippingVolumeRendering";}
+
+protected:
+  vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode();
+  ~vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode() override;
+  vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode(const vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode&);
+  void operator=(const vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode&);
+};
+
+#endif
@@ -0,0 +1,765 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRendering includes
+#include "vtkEmptySpaceSkippingVolumeRayCastMapper.h"
+
+// VTK includes
+#include <vtkCommand.h>
+#include <vtkDataArray.h>
+#include <vtkFixedPointRayCastImage.h>
+#include <vtkFixedPointVolumeRayCastCompositeHelper.h>
+#include <vtkImageData.h>
+#include <vtkInformation.h>
+#include <vtkObjectFactory.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkPointData.h>
+#include <vtkRenderWindow.h>
+#include <vtkSMPTools.h>
+#include <vtkStreamingDemandDrivenPipeline.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+
+// STD includes
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+/// One level of the min/max octree. Level 0 contains the bricks,
+/// each node of level N+1 contains the range of 2x2x2 nodes of level N.
+struct OctreeLevel
+{
+  int Dimensions[3] = { 0, 0, 0 };
+  std::vector<double> Minimum;
+  std::vector<double> Maximum;
+};
+
+//----------------------------------------------------------------------------
+/// Compute scalar range of each brick, processing slabs of bricks in parallel
+/// (numberOfThreads = 1 processes all slabs in the calling thread).
+/// Neighbor bricks share their boundary voxels so that samples interpolated between
+/// two bricks are within the range of both.
+template <class T>
+void ComputeBrickRanges(const T* scalars, const int dimensions[3], int brickSize,
+  OctreeLevel& bricks, int numberOfThreads)
+{
+  const int* brickDimensions = bricks.Dimensions;
+  auto processBrickSlabs = [&](vtkIdType firstBrickSlab, vtkIdType lastBrickSlab)
+  {
+    for (int bk = static_cast<int>(firstBrickSlab); bk < static_cast<int>(lastBrickSlab); ++bk)
+    {
+      const int k0 = bk * brickSize;
+      const int k1 = std::min(k0 + brickSize, dimensions[2] - 1);
+      for (int bj = 0; bj < brickDimensions[1]; ++bj)
+      {
+        const int j0 = bj * brickSize;
+        const int j1 = std::min(j0 + brickSize, dimensions[1] - 1);
+        for (int bi = 0; bi < brickDimensions[0]; ++bi)
+        {
+          const int i0 = bi * brickSize;
+          const int i1 = std::min(i0 + brickSize, dimensions[0] - 1);
+          double minimum = std::numeric_limits<double>::max();
+          double maximum = std::numeric_limits<double>::lowest();
+          for (int k = k0; k <= k1; ++k)
+          {
+            for (int j = j0; j <= j1; ++j)
+            {
+              const T* row = scalars + (static_cast<vtkIdType>(k) * dimensions[1] + j) * dimensions[0];
+              for (int i = i0; i <= i1; ++i)
+              {
+                const double value = static_cast<double>(row[i]);
+                minimum = std::min(minimum, value);
+                maximum = std::max(maximum, value);
+              }
+            }
+          }
+          const vtkIdType brickIndex = (static_cast<vtkIdType>(bk) * brickDimensions[1] + bj) * brickDimensions[0] + bi;
+          bricks.Minimum[brickIndex] = minimum;
+          bricks.Maximum[brickIndex] = maximum;
+        }
+      }
+    }
+  };
+  if (numberOfThreads == 1)
+  {
+    processBrickSlabs(0, brickDimensions[2]);
+  }
+  else
+  {
+    // Each slab writes a distinct range of bricks, no synchronization is needed
+    vtkSMPTools::For(0, brickDimensions[2], 1, processBrickSlabs);
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Non-transparent flag of each brick of the finest octree level, used for leaping over
+/// transparent bricks during ray traversal.
+struct BrickMask
+{
+  /// Scalars the mask was computed from
+  vtkDataArray* Scalars = nullptr;
+  int Dimensions[3] = { 0, 0, 0 };
+  int BrickDimensions[3] = { 0, 0, 0 };
+  int BrickSize = 1;
+  std::vector<unsigned char> Opaque;
+
+  /// Returns the number of ray steps until the sample at fixed point position pos leaves its brick
+  /// if the brick is transparent. Returns 0 if the brick is not transparent.
+  /// step is the signed change of the fixed point position in one step.
+  unsigned int GetNumberOfTransparentSteps(const unsigned int pos[3], const int step[3]) const
+  {
+    int brickIndex[3] = { 0, 0, 0 };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      brickIndex[axis] = std::min(static_cast<int>(pos[axis] >> VTKKW_FP_SHIFT) / this->BrickSize,
+        this->BrickDimensions[axis] - 1);
+    }
+    if (this->Opaque[(static_cast<vtkIdType>(brickIndex[2]) * this->BrickDimensions[1] + brickIndex[1])
+      * this->BrickDimensions[0] + brickIndex[0]])
+    {
+      return 0;
+    }
+    // Samples interpolate between voxels [first, first + 1], they are within the brick
+    // while the integer part of the position is in [brickIndex * BrickSize, (brickIndex + 1) * BrickSize - 1].
+    int64_t numberOfSteps = std::numeric_limits<unsigned int>::max();
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      const int64_t position = pos[axis];
+      if (step[axis] > 0)
+      {
+        const int64_t exitPosition = static_cast<int64_t>((brickIndex[axis] + 1) * this->BrickSize) << VTKKW_FP_SHIFT;
+        numberOfSteps = std::min(numberOfSteps, (exitPosition - position + step[axis] - 1) / step[axis]);
+      }
+      else if (step[axis] < 0)
+      {
+        const int64_t firstPosition = static_cast<int64_t>(brickIndex[axis] * this->BrickSize) << VTKKW_FP_SHIFT;
+        numberOfSteps = std::min(numberOfSteps, (position - firstPosition) / (-step[axis]) + 1);
+      }
+    }
+    // Position of the last voxel may be outside the last brick, do not leap there
+    return numberOfSteps > 0 ? static_cast<unsigned int>(numberOfSteps) : 0;
+  }
+};
+
+//----------------------------------------------------------------------------
+/// Composite ray casting of single-component volumes without shading and gradient opacity
+/// (the same as in vtkFixedPointVolumeRayCastCompositeHelper), which leaps over transparent bricks.
+/// Samples are taken at the same positions and composited the same way as in
+/// vtkFixedPointVolumeRayCastCompositeHelper, therefore the rendered image is the same.
+template <class T>
+void GenerateImageOneComponentSkipEmptySpace(const T* data, int threadID, int threadCount,
+  vtkFixedPointVolumeRayCastMapper* mapper, const BrickMask& opaqueBricks, bool trilinear)
+{
+  int imageInUseSize[2] = { 0, 0 };
+  int imageMemorySize[2] = { 0, 0 };
+  mapper->GetRayCastImage()->GetImageInUseSize(imageInUseSize);
+  mapper->GetRayCastImage()->GetImageMemorySize(imageMemorySize);
+  float shift[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  float scale[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+  mapper->GetTableShift(shift);
+  mapper->GetTableScale(scale);
+  const int* rowBounds = mapper->GetRowBounds();
+  unsigned short* image = mapper->GetRayCastImage()->GetImage();
+  vtkRenderWindow* renderWindow = mapper->GetRenderWindow();
+  const bool cropping = (mapper->GetCropping() && mapper->GetCroppingRegionFlags() != VTK_CROP_SUBVOLUME);
+  const unsigned short* colorTable = mapper->GetColorTable(0);
+  const unsigned short* scalarOpacityTable = mapper->GetScalarOpacityTable(0);
+
+  const vtkIdType inc[3] = { 1, opaqueBricks.Dimensions[0],
+    static_cast<vtkIdType>(opaqueBricks.Dimensions[0]) * opaqueBricks.Dimensions[1] };
+  // Offsets of the 8 voxels of the cell that is used for trilinear interpolation
+  const vtkIdType cornerOffsets[8] = { 0, inc[0], inc[1], inc[0] + inc[1],
+    inc[2], inc[2] + inc[0], inc[2] + inc[1], inc[2] + inc[1] + inc[0] };
+
+  for (int j = 0; j < imageInUseSize[1]; ++j)
+  {
+    if (j % threadCount != threadID)
+    {
+      continue;
+    }
+    if (!threadID)
+    {
+      if (renderWindow->CheckAbortStatus())
+      {
+        break;
+      }
+    }
+    else if (renderWindow->GetAbortRender())
+    {
+      break;
+    }
+
+    unsigned short* imagePtr = image + 4 * (j * imageMemorySize[0] + rowBounds[j * 2]);
+    for (int i = rowBounds[j * 2]; i <= rowBounds[j * 2 + 1]; ++i, imagePtr += 4)
+    {
+      unsigned int numSteps = 0;
+      unsigned int pos[3] = { 0, 0, 0 };
+      unsigned int dir[3] = { 0, 0, 0 };
+      mapper->ComputeRayInfo(i, j, pos, dir, &numSteps);
+      if (numSteps == 0)
+      {
+        imagePtr[0] = imagePtr[1] = imagePtr[2] = imagePtr[3] = 0;
+        continue;
+      }
+
+      // Signed position change of one step, for leaping over multiple steps
+      int step[3] = { 0, 0, 0 };
+      unsigned int nextPos[3] = { pos[0], pos[1], pos[2] };
+      mapper->FixedPointIncrement(nextPos, dir);
+      for (int axis = 0; axis < 3; ++axis)
+      {
+        step[axis] = static_cast<int>(nextPos[axis] - pos[axis]);
+      }
+
+      unsigned int color[3] = { 0, 0, 0 };
+      unsigned int remainingOpacity = 0x7fff;
+      unsigned int mmpos[3] = { (pos[0] >> VTKKW_FPMM_SHIFT) + 1, 0, 0 };
+      int mmvalid = 0;
+      unsigned int spos[3] = { 0, 0, 0 };
+      unsigned int oldSPos[3] = { VTK_UNSIGNED_INT_MAX, VTK_UNSIGNED_INT_MAX, VTK_UNSIGNED_INT_MAX };
+      unsigned int cornerValues[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+      for (unsigned int k = 0; k < numSteps; ++k)
+      {
+        if (k)
+        {
+          mapper->FixedPointIncrement(pos, dir);
+        }
+
+        // Leap over the transparent brick
+        const unsigned int transparentSteps = opaqueBricks.GetNumberOfTransparentSteps(pos, step);
+        if (transparentSteps > 0)
+        {
+          if (transparentSteps >= numSteps - k)
+          {
+            break;
+          }
+          // The next iteration moves to the first sample after the brick
+          for (int axis = 0; axis < 3; ++axis)
+          {
+            pos[axis] = static_cast<unsigned int>(pos[axis] + static_cast<int64_t>(step[axis]) * (transparentSteps - 1));
+          }
+          k += transparentSteps - 1;
+          continue;
+        }
+
+        // Skip 4x4x4 blocks that are transparent, the same way as vtkFixedPointVolumeRayCastCompositeHelper
+        if (pos[0] >> VTKKW_FPMM_SHIFT != mmpos[0] || pos[1] >> VTKKW_FPMM_SHIFT != mmpos[1]
+          || pos[2] >> VTKKW_FPMM_SHIFT != mmpos[2])
+        {
+          mmpos[0] = pos[0] >> VTKKW_FPMM_SHIFT;
+          mmpos[1] = pos[1] >> VTKKW_FPMM_SHIFT;
+          mmpos[2] = pos[2] >> VTKKW_FPMM_SHIFT;
+          mmvalid = mapper->CheckMinMaxVolumeFlag(mmpos, 0);
+        }
+        if (!mmvalid)
+        {
+          continue;
+        }
+        if (cropping && mapper->CheckIfCropped(pos))
+        {
+          continue;
+        }
+
+        mapper->ShiftVectorDown(pos, spos);
+        const T* dptr = data + spos[0] * inc[0] + spos[1] * inc[1] + spos[2] * inc[2];
+        unsigned short value = 0;
+        if (trilinear)
+        {
+          if (spos[0] != oldSPos[0] || spos[1] != oldSPos[1] || spos[2] != oldSPos[2])
+          {
+            std::copy(spos, spos + 3, oldSPos);
+            for (int corner = 0; corner < 8; ++corner)
+            {
+              cornerValues[corner] = static_cast<unsigned int>(scale[0] * (*(dptr + cornerOffsets[corner]) + shift[0]));
+            }
+          }
+          const unsigned int w2X = (pos[0] & VTKKW_FP_MASK);
+          const unsigned int w2Y = (pos[1] & VTKKW_FP_MASK);
+          const unsigned int w2Z = (pos[2] & VTKKW_FP_MASK);
+          const unsigned int w1X = ((~w2X) & VTKKW_FP_MASK);
+          const unsigned int w1Y = ((~w2Y) & VTKKW_FP_MASK);
+          const unsigned int w1Z = ((~w2Z) & VTKKW_FP_MASK);
+          const unsigned int w1Xw1Y = (0x4000 + (w1X * w1Y)) >> VTKKW_FP_SHIFT;
+          const unsigned int w2Xw1Y = (0x4000 + (w2X * w1Y)) >> VTKKW_FP_SHIFT;
+          const unsigned int w1Xw2Y = (0x4000 + (w1X * w2Y)) >> VTKKW_FP_SHIFT;
+          const unsigned int w2Xw2Y = (0x4000 + (w2X * w2Y)) >> VTKKW_FP_SHIFT;
+          value = static_cast<unsigned short>((0x7fff
+            + ((cornerValues[0] * ((0x4000 + w1Xw1Y * w1Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[1] * ((0x4000 + w2Xw1Y * w1Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[2] * ((0x4000 + w1Xw2Y * w1Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[3] * ((0x4000 + w2Xw2Y * w1Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[4] * ((0x4000 + w1Xw1Y * w2Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[5] * ((0x4000 + w2Xw1Y * w2Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[6] * ((0x4000 + w1Xw2Y * w2Z) >> VTKKW_FP_SHIFT))
+              + (cornerValues[7] * ((0x4000 + w2Xw2Y * w2Z) >> VTKKW_FP_SHIFT))))
+            >> VTKKW_FP_SHIFT);
+        }
+        else
+        {
+          value = static_cast<unsigned short>(((*dptr) + shift[0]) * scale[0]);
+        }
+
+        const unsigned int opacity = scalarOpacityTable[value];
+        if (!opacity)
+        {
+          continue;
+        }
+        for (int c = 0; c < 3; ++c)
+        {
+          const unsigned int sampleColor = (colorTable[3 * value + c] * opacity + 0x7fff) >> VTKKW_FP_SHIFT;
+          color[c] += (sampleColor * remainingOpacity + 0x7fff) >> VTKKW_FP_SHIFT;
+        }
+        remainingOpacity = (remainingOpacity * ((~opacity) & VTKKW_FP_MASK) + 0x7fff) >> VTKKW_FP_SHIFT;
+        if (remainingOpacity < 0xff)
+        {
+          // early ray termination
+          break;
+        }
+      }
+
+      imagePtr[0] = static_cast<unsigned short>(std::min(color[0], 32767u));
+      imagePtr[1] = static_cast<unsigned short>(std::min(color[1], 32767u));
+      imagePtr[2] = static_cast<unsigned short>(std::min(color[2], 32767u));
+      imagePtr[3] = static_cast<unsigned short>(std::min((~remainingOpacity) & VTKKW_FP_MASK, 32767u));
+    }
+
+    if ((j / threadCount) % 8 == 7 && threadID == 0)
+    {
+      double progress = static_cast<double>(j) / static_cast<double>(imageInUseSize[1] - 1);
+      mapper->InvokeEvent(vtkCommand::VolumeMapperRenderProgressEvent, &progress);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+/// Composite helper that leaps over transparent bricks in single-component volumes.
+/// Other volumes are rendered by vtkFixedPointVolumeRayCastCompositeHelper.
+class vtkEmptySpaceSkippingCompositeHelper : public vtkFixedPointVolumeRayCastCompositeHelper
+{
+public:
+  static vtkEmptySpaceSkippingCompositeHelper* New();
+  vtkTypeMacro(vtkEmptySpaceSkippingCompositeHelper, vtkFixedPointVolumeRayCastCompositeHelper);
+
+  void GenerateImage(int threadID, int threadCount, vtkVolume* vol, vtkFixedPointVolumeRayCastMapper* mapper) override
+  {
+    vtkDataArray* scalars = mapper->GetCurrentScalars();
+    if (!this->OpaqueBricks || !scalars || scalars != this->OpaqueBricks->Scalars || scalars->GetNumberOfComponents() != 1)
+    {
+      this->Superclass::GenerateImage(threadID, threadCount, vol, mapper);
+      return;
+    }
+    const bool trilinear = !mapper->ShouldUseNearestNeighborInterpolation(vol);
+    void* data = scalars->GetVoidPointer(0);
+    switch (scalars->GetDataType())
+    {
+      vtkTemplateMacro(GenerateImageOneComponentSkipEmptySpace(static_cast<const VTK_TT*>(data),
+        threadID, threadCount, mapper, *this->OpaqueBricks, trilinear));
+      default:
+        this->Superclass::GenerateImage(threadID, threadCount, vol, mapper);
+    }
+  }
+
+  /// Bricks used for empty space skipping. If nullptr then the volume is rendered by the superclass.
+  const BrickMask* OpaqueBricks{ nullptr };
+
+protected:
+  vtkEmptySpaceSkippingCompositeHelper() = default;
+  ~vtkEmptySpaceSkippingCompositeHelper() override = default;
+
+private:
+  vtkEmptySpaceSkippingCompositeHelper(const vtkEmptySpaceSkippingCompositeHelper&) = delete;
+  void operator=(const vtkEmptySpaceSkippingCompositeHelper&) = delete;
+};
+
+vtkStandardNewMacro(vtkEmptySpaceSkippingCompositeHelper);
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+class vtkEmptySpaceSkippingVolumeRayCastMapper::vtkInternal
+{
+public:
+  /// Rebuild the octree if the input or brick size changed since the last build.
+  /// Returns false if the input cannot be used for empty space skipping.
+  bool UpdateOctree(vtkImageData* input, int brickSize, int numberOfThreads);
+
+  /// Compute scalar ranges where opacity is not zero.
+  void UpdateOpaqueScalarRanges(vtkPiecewiseFunction* scalarOpacity);
+
+  /// Returns true if opacity is not zero anywhere in the [minimum, maximum] scalar range.
+  bool IsOpaque(double minimum, double maximum) const;
+
+  /// Expand extent with non-transparent bricks within the octree node and mark them in OpaqueBricks.
+  void ClassifyNode(int level, int i, int j, int k, int extent[6], vtkIdType& numberOfOpaqueBricks);
+
+  std::vector<OctreeLevel> Levels;
+  int Dimensions[3] = { 0, 0, 0 };
+  int BrickSize = 0;
+  vtkImageData* Input = nullptr;
+  vtkMTimeType InputTime = 0;
+
+  /// Sorted, non-overlapping scalar ranges with non-zero opacity
+  std::vector<std::pair<double, double>> OpaqueScalarRanges;
+  /// Scalar values closer than this to an opaque range may be classified as opaque by
+  /// the mapper because of discretization of the transfer function table.
+  double ScalarTolerance = 0.0;
+
+  vtkPiecewiseFunction* ScalarOpacity = nullptr;
+  vtkMTimeType ScalarOpacityTime = 0;
+  /// Octree build time at the last classification
+  vtkMTimeType ClassifiedOctreeTime = 0;
+  vtkTimeStamp OctreeBuildTime;
+
+  /// Classification of the bricks of the finest octree level
+  BrickMask OpaqueBricks;
+  /// Composite helper of the mapper, owned by the mapper
+  vtkEmptySpaceSkippingCompositeHelper* CompositeHelper = nullptr;
+};
+
+//----------------------------------------------------------------------------
+bool vtkEmptySpaceSkippingVolumeRayCastMapper::vtkInternal::UpdateOctree(vtkImageData* input, int brickSize, int numberOfThreads)
+{
+  vtkDataArray* scalars = input ? input->GetPointData()->GetScalars() : nullptr;
+  if (!scalars || scalars->GetNumberOfComponents() != 1)
+  {
+    this->Input = nullptr;
+    this->Levels.clear();
+    return false;
+  }
+  vtkMTimeType inputTime = std::max(input->GetMTime(), scalars->GetMTime());
+  if (this->Input == input && this->InputTime == inputTime && this->BrickSize == brickSize && !this->Levels.empty())
+  {
+    // up-to-date
+    return true;
+  }
+  this->Input = input;
+  this->InputTime = inputTime;
+  this->BrickSize = brickSize;
+  input->GetDimensions(this->Dimensions);
+  this->Levels.clear();
+
+  OctreeLevel bricks;
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    bricks.Dimensions[axis] = std::max(1, (this->Dimensions[axis] - 1 + brickSize - 1) / brickSize);
+  }
+  vtkIdType numberOfBricks = static_cast<vtkIdType>(bricks.Dimensions[0]) * bricks.Dimensions[1] * bricks.Dimensions[2];
+  bricks.Minimum.resize(numberOfBricks);
+  bricks.Maximum.resize(numberOfBricks);
+  void* scalarPointer = scalars->GetVoidPointer(0);
+  switch (scalars->GetDataType())
+  {
+    vtkTemplateMacro(ComputeBrickRanges(static_cast<const VTK_TT*>(scalarPointer),
+      this->Dimensions, brickSize, bricks, numberOfThreads));
+    default:
+      this->Input = nullptr;
+      return false;
+  }
+  this->Levels.push_back(std::move(bricks));
+
+  // Merge 2x2x2 nodes until a single root node remains
+  while (this->Levels.back().Dimensions[0] > 1 || this->Levels.back().Dimensions[1] > 1 || this->Levels.back().Dimensions[2] > 1)
+  {
+    const OctreeLevel& children = this->Levels.back();
+    OctreeLevel parents;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      parents.Dimensions[axis] = (children.Dimensions[axis] + 1) / 2;
+    }
+    vtkIdType numberOfParents = static_cast<vtkIdType>(parents.Dimensions[0]) * parents.Dimensions[1] * parents.Dimensions[2];
+    parents.Minimum.resize(numberOfParents, std::numeric_limits<double>::max());
+    parents.Maximum.resize(numberOfParents, std::numeric_limits<double>::lowest());
+    for (int k = 0; k < children.Dimensions[2]; ++k)
+    {
+      for (int j = 0; j < children.Dimensions[1]; ++j)
+      {
+        for (int i = 0; i < children.Dimensions[0]; ++i)
+        {
+          vtkIdType childIndex = (static_cast<vtkIdType>(k) * children.Dimensions[1] + j) * children.Dimensions[0] + i;
+          vtkIdType parentIndex = (static_cast<vtkIdType>(k / 2) * parents.Dimensions[1] + j / 2) * parents.Dimensions[0] + i / 2;
+          parents.Minimum[parentIndex] = std::min(parents.Minimum[parentIndex], children.Minimum[childIndex]);
+          parents.Maximum[parentIndex] = std::max(parents.Maximum[parentIndex], children.Maximum[childIndex]);
+        }
+      }
+    }
+    this->Levels.push_back(std::move(parents));
+  }
+  this->OctreeBuildTime.Modified();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkEmptySpaceSkippingVolumeRayCastMapper::vtkInternal::UpdateOpaqueScalarRanges(vtkPiecewiseFunction* scalarOpacity)
+{
+  this->OpaqueScalarRanges.clear();
+  const int numberOfNodes = scalarOpacity->GetSize();
+  if (numberOfNodes == 0)
+  {
+    return;
+  }
+  const double infinity = std::numeric_limits<double>::infinity();
+  double node[4] = { 0.0, 0.0, 0.5, 0.0 };
+  double previousNode[4] = { 0.0, 0.0, 0.5, 0.0 };
+  scalarOpacity->GetNodeValue(0, previousNode);
+  if (scalarOpacity->GetClamping() && previousNode[1] > 0.0)
+  {
+    this->OpaqueScalarRanges.emplace_back(-infinity, previousNode[0]);
+  }
+  else if (previousNode[1] > 0.0)
+  {
+    this->OpaqueScalarRanges.emplace_back(previousNode[0], previousNode[0]);
+  }
+  for (int nodeIndex = 1; nodeIndex < numberOfNodes; ++nodeIndex)
+  {
+    scalarOpacity->GetNodeValue(nodeIndex, node);
+    // The function between two nodes is within the range of the two node values
+    // (regardless of midpoint and sharpness), therefore it is zero if both nodes are zero.
+    if (previousNode[1] > 0.0 || node[1] > 0.0)
+    {
+      if (!this->OpaqueScalarRanges.empty() && this->OpaqueScalarRanges.back().second >= previousNode[0])
+      {
+        this->OpaqueScalarRanges.back().second = node[0];
+      }
+      else
+      {
+        this->OpaqueScalarRanges.emplace_back(previousNode[0], node[0]);
+      }
+    }
+    std::copy(node, node + 4, previousNode);
+  }
+  if (scalarOpacity->GetClamping() && previousNode[1] > 0.0)
+  {
+    if (!this->OpaqueScalarRanges.empty() && this->OpaqueScalarRanges.back().second >= previousNode[0])
+    {
+      this->OpaqueScalarRanges.back().second = infinity;
+    }
+    else
+    {
+      this->OpaqueScalarRanges.emplace_back(previousNode[0], infinity);
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+bool vtkEmptySpaceSkippingVolumeRayCastMapper::vtkInternal::IsOpaque(double minimum, double maximum) const
+{
+  minimum -= this->ScalarTolerance;
+  maximum += this->ScalarTolerance;
+  // Find the first opaque range that ends at or after the minimum
+  auto range = std::lower_bound(this->OpaqueScalarRanges.begin(), this->OpaqueScalarRanges.end(), minimum,
+    [](const std::pair<double, double>& opaqueRange, double value) { return opaqueRange.second < value; });
+  return range != this->OpaqueScalarRanges.end() && range->first <= maximum;
+}
+
+//----------------------------------------------------------------------------
+void vtkEmptySpaceSkippingVolumeRayCastMapper::vtkInternal::ClassifyNode(
+  int level, int i, int j, int k, int extent[6], vtkIdType& numberOfOpaqueBricks)
+{
+  const OctreeLevel& octreeLevel = this->Levels[level];
+  vtkIdType nodeIndex = (static_cast<vtkIdType>(k) * octreeLevel.Dimensions[1] + j) * octreeLevel.Dimensions[0] + i;
+  if (!this->IsOpaque(octreeLevel.Minimum[nodeIndex], octreeLevel.Maximum[nodeIndex]))
+  {
+    // transparent subtree
+    return;
+  }
+  if (level == 0)
+  {
+    const int brickIndex[3] = { i, j, k };
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      int first = brickIndex[axis] * this->BrickSize;
+      int last = std::min(first + this->BrickSize, this->Dimensions[axis] - 1);
+      extent[axis * 2] = std::min(extent[axis * 2], first);
+      extent[axis * 2 + 1] = std::max(extent[axis * 2 + 1], last);
+    }
+    this->OpaqueBricks.Opaque[nodeIndex] = 1;
+    ++numberOfOpaqueBricks;
+    return;
+  }
+  const OctreeLevel& children = this->Levels[level - 1];
+  for (int ck = 2 * k; ck < std::min(2 * k + 2, children.Dimensions[2]); ++ck)
+  {
+    for (int cj = 2 * j; cj < std::min(2 * j + 2, children.Dimensions[1]); ++cj)
+    {
+      for (int ci = 2 * i; ci < std::min(2 * i + 2, children.Dimensions[0]); ++ci)
+      {
+        this->ClassifyNode(level - 1, ci, cj, ck, extent, numberOfOpaqueBricks);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+vtkStandardNewMacro(vtkEmptySpaceSkippingVolumeRayCastMapper);
+
+//----------------------------------------------------------------------------
+vtkEmptySpaceSkippingVolumeRayCastMapper::vtkEmptySpaceSkippingVolumeRayCastMapper()
+  : Internal(new vtkInternal)
+{
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    this->NonTransparentExtent[axis * 2] = 0;
+    this->NonTransparentExtent[axis * 2 + 1] = -1;
+  }
+  // Replace the composite helper to leap over transparent bricks during ray traversal
+  this->Internal->CompositeHelper = vtkEmptySpaceSkippingCompositeHelper::New();
+  this->CompositeHelper->Delete();
+  this->CompositeHelper = this->Internal->CompositeHelper;
+}
+
+//----------------------------------------------------------------------------
+vtkEmptySpaceSkippingVolumeRayCastMapper::~vtkEmptySpaceSkippingVolumeRayCastMapper() = default;
+
+//----------------------------------------------------------------------------
+void vtkEmptySpaceSkippingVolumeRayCastMapper::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os, indent);
+  os << indent << "EmptySpaceSkipping: " << (this->EmptySpaceSkipping ? "true" : "false") << "\n";
+  os << indent << "BrickSize: " << this->BrickSize << "\n";
+  os << indent << "NonTransparentExtent: " << this->NonTransparentExtent[0] << " " << this->NonTransparentExtent[1]
+    << " " << this->NonTransparentExtent[2] << " " << this->NonTransparentExtent[3]
+    << " " << this->NonTransparentExtent[4] << " " << this->NonTransparentExtent[5] << "\n";
+  os << indent << "NumberOfNonTransparentBricks: " << this->NumberOfNonTransparentBricks << "\n";
+}
+
+//----------------------------------------------------------------------------
+void vtkEmptySpaceSkippingVolumeRayCastMapper::SetEmptySpaceSkipping(bool enable)
+{
+  if (this->EmptySpaceSkipping == enable)
+  {
+    return;
+  }
+  this->EmptySpaceSkipping = enable;
+  if (!enable)
+  {
+    this->SetCropping(false);
+  }
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+bool vtkEmptySpaceSkippingVolumeRayCastMapper::UpdateNonTransparentExtent(vtkVolumeProperty* property)
+{
+  vtkImageData* input = this->GetInput();
+  vtkPiecewiseFunction* scalarOpacity = property ? property->GetScalarOpacity(0) : nullptr;
+  if (!input || !scalarOpacity || this->GetBlendMode() != vtkVolumeMapper::COMPOSITE_BLEND)
+  {
+    return false;
+  }
+  if (!this->Internal->UpdateOctree(input, this->BrickSize, this->GetNumberOfThreads()))
+  {
+    return false;
+  }
+
+  // Classification only needs to be updated if the octree or the opacity function changed
+  if (this->Internal->ScalarOpacity == scalarOpacity
+    && this->Internal->ScalarOpacityTime == scalarOpacity->GetMTime()
+    && this->Internal->ClassifiedOctreeTime == this->Internal->OctreeBuildTime.GetMTime())
+  {
+    return true;
+  }
+  this->Internal->ScalarOpacity = scalarOpacity;
+  this->Internal->ScalarOpacityTime = scalarOpacity->GetMTime();
+  this->Internal->UpdateOpaqueScalarRanges(scalarOpacity);
+  // The mapper samples the transfer function into a table over the scalar range,
+  // a voxel may get the opacity of a table entry that is one step away.
+  double scalarRange[2] = { 0.0, 0.0 };
+  input->GetPointData()->GetScalars()->GetRange(scalarRange);
+  this->Internal->ScalarTolerance = (scalarRange[1] - scalarRange[0]) / 255.0;
+
+  BrickMask& opaqueBricks = this->Internal->OpaqueBricks;
+  const OctreeLevel& bricks = this->Internal->Levels[0];
+  opaqueBricks.Scalars = input->GetPointData()->GetScalars();
+  std::copy(this->Internal->Dimensions, this->Internal->Dimensions + 3, opaqueBricks.Dimensions);
+  std::copy(bricks.Dimensions, bricks.Dimensions + 3, opaqueBricks.BrickDimensions);
+  opaqueBricks.BrickSize = this->Internal->BrickSize;
+  opaqueBricks.Opaque.assign(bricks.Minimum.size(), 0);
+
+  int extent[6] = { VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN, VTK_INT_MAX, VTK_INT_MIN };
+  vtkIdType numberOfOpaqueBricks = 0;
+  this->Internal->ClassifyNode(static_cast<int>(this->Internal->Levels.size()) - 1, 0, 0, 0, extent, numberOfOpaqueBricks);
+  if (numberOfOpaqueBricks == 0)
+  {
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      extent[axis * 2] = 0;
+      extent[axis * 2 + 1] = -1;
+    }
+  }
+  std::copy(extent, extent + 6, this->NonTransparentExtent);
+  this->NumberOfNonTransparentBricks = numberOfOpaqueBricks;
+  this->Internal->ClassifiedOctreeTime = this->Internal->OctreeBuildTime.GetMTime();
+  return true;
+}
+
+//----------------------------------------------------------------------------
+void vtkEmptySpaceSkippingVolumeRayCastMapper::Render(vtkRenderer* ren, vtkVolume* vol)
+{
+  vtkImageData* input = this->GetInput();
+  this->Internal->CompositeHelper->OpaqueBricks = nullptr;
+  if (!this->EmptySpaceSkipping || !input || !vol)
+  {
+    this->Superclass::Render(ren, vol);
+    return;
+  }
+
+  // Make sure the input is up-to-date before computing the octree
+  this->GetInputAlgorithm()->UpdateInformation();
+  vtkStreamingDemandDrivenPipeline::SetUpdateExtentToWholeExtent(this->GetInputInformation());
+  this->GetInputAlgorithm()->Update();
+
+  if (!this->UpdateNonTransparentExtent(vol->GetProperty()))
+  {
+    // Empty space skipping is not applicable, render the entire volume
+    this->SetCropping(false);
+    this->Superclass::Render(ren, vol);
+    return;
+  }
+  if (this->NumberOfNonTransparentBricks == 0)
+  {
+    // Nothing is visible
+    return;
+  }
+
+  // Clip rays to the non-transparent region using a subvolume cropping region
+  double origin[3] = { 0.0, 0.0, 0.0 };
+  double spacing[3] = { 1.0, 1.0, 1.0 };
+  int inputExtent[6] = { 0, -1, 0, -1, 0, -1 };
+  input->GetOrigin(origin);
+  input->GetSpacing(spacing);
+  input->GetExtent(inputExtent);
+  double planes[6] = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double first = origin[axis] + (inputExtent[axis * 2] + this->NonTransparentExtent[axis * 2]) * spacing[axis];
+    double last = origin[axis] + (inputExtent[axis * 2] + this->NonTransparentExtent[axis * 2 + 1]) * spacing[axis];
+    planes[axis * 2] = std::min(first, last);
+    planes[axis * 2 + 1] = std::max(first, last);
+  }
+  this->SetCroppingRegionPlanes(planes);
+  this->SetCroppingRegionFlags(VTK_CROP_SUBVOLUME);
+  this->SetCropping(true);
+
+  // Leap over transparent bricks within the non-transparent region
+  this->Internal->CompositeHelper->OpaqueBricks = &this->Internal->OpaqueBricks;
+  this->Superclass::Render(ren, vol);
+  this->Internal->CompositeHelper->OpaqueBricks = nullptr;
+}
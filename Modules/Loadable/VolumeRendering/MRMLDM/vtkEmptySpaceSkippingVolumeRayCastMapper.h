@@ -0,0 +1,105 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+#ifndef __vtkEmptySpaceSkippingVolumeRayCastMapper_h
+#define __vtkEmptySpaceSkippingVolumeRayCastMapper_h
+
+// VolumeRendering includes
+#include "vtkSlicerVolumeRenderingModuleMRMLDisplayableManagerExport.h"
+
+// VTK includes
+#include <vtkFixedPointVolumeRayCastMapper.h>
+
+// STD includes
+#include <memory>
+
+class vtkVolumeProperty;
+
+/// \brief CPU ray cast mapper that does not cast rays through fully transparent regions of the volume.
+///
+/// The volume is divided into bricks (BrickSize voxels along each axis) and the scalar range
+/// of each brick is stored in an octree. Bricks are classified against the scalar opacity transfer
+/// function of the volume property: a brick is transparent if the opacity is zero over its entire
+/// scalar range (extended by one transfer function table step). Rays are then clipped to the
+/// bounding box of the non-transparent bricks (using a subvolume cropping region), therefore
+/// no samples are taken in the empty space around the visible structures. Within the bounding box,
+/// rays leap over transparent bricks: when a sample is in a transparent brick, the ray traversal
+/// moves directly to the first sample after the brick. Samples that are skipped have zero opacity,
+/// therefore the rendered image is the same as with vtkFixedPointVolumeRayCastMapper.
+///
+/// The octree is only rebuilt when the input volume changes. When the opacity transfer function
+/// changes then only the classification is updated, traversing the octree top-down and skipping
+/// transparent subtrees. Changes of the color or gradient opacity transfer functions do not
+/// require classification. Brick ranges are computed using the VTK SMP backend,
+/// if NumberOfThreads is set to 1 then they are computed in the calling thread.
+///
+/// Empty space skipping is only used for single-component volumes with composite blending.
+/// Leaping over transparent bricks is only used if shading and gradient opacity are disabled,
+/// otherwise rays are only clipped to the bounding box of the non-transparent bricks.
+/// Other volumes are rendered the same way as in vtkFixedPointVolumeRayCastMapper.
+/// Cropping of the mapper is managed by this class while EmptySpaceSkipping is enabled.
+class VTK_SLICER_VOLUMERENDERING_MODULE_MRMLDISPLAYABLEMANAGER_EXPORT vtkEmptySpaceSkippingVolumeRayCastMapper
+  : public vtkFixedPointVolumeRayCastMapper
+{
+public:
+  static vtkEmptySpaceSkippingVolumeRayCastMapper* New();
+  vtkTypeMacro(vtkEmptySpaceSkippingVolumeRayCastMapper, vtkFixedPointVolumeRayCastMapper);
+  void PrintSelf(ostream& os, vtkIndent indent) override;
+
+  /// Enable empty space skipping. Enabled by default.
+  void SetEmptySpaceSkipping(bool enable);
+  vtkGetMacro(EmptySpaceSkipping, bool);
+  vtkBooleanMacro(EmptySpaceSkipping, bool);
+
+  /// Number of voxels along each axis of the smallest bricks. Default is 8.
+  vtkSetClampMacro(BrickSize, int, 2, 256);
+  vtkGetMacro(BrickSize, int);
+
+  /// Update the brick octree from the current input and compute the extent
+  /// of non-transparent voxels based on the scalar opacity function of the property.
+  /// Returns false if empty space skipping cannot be used for the current input and property.
+  /// It is called automatically before rendering.
+  bool UpdateNonTransparentExtent(vtkVolumeProperty* property);
+
+  /// Extent of the non-transparent region of the input volume (in voxel coordinates),
+  /// computed by the last UpdateNonTransparentExtent() call.
+  /// If the entire volume is transparent then the extent is empty (min > max).
+  vtkGetVector6Macro(NonTransparentExtent, int);
+
+  /// Number of bricks (at the finest octree level) that are not transparent,
+  /// computed by the last UpdateNonTransparentExtent() call.
+  vtkGetMacro(NumberOfNonTransparentBricks, vtkIdType);
+
+  /// Render the volume. Rays are clipped to the non-transparent extent and leap over transparent bricks.
+  void Render(vtkRenderer* ren, vtkVolume* vol) override;
+
+protected:
+  vtkEmptySpaceSkippingVolumeRayCastMapper();
+  ~vtkEmptySpaceSkippingVolumeRayCastMapper() override;
+
+  bool EmptySpaceSkipping{ true };
+  int BrickSize{ 8 };
+  int NonTransparentExtent[6];
+  vtkIdType NumberOfNonTransparentBricks{ 0 };
+
+private:
+  class vtkInternal;
+  std::unique_ptr<vtkInternal> Internal;
+
+  vtkEmptySpaceSkippingVolumeRayCastMapper(const vtkEmptySpaceSkippingVolumeRayCastMapper&) = delete;
+  void operator=(const vtkEmptySpaceSkippingVolumeRayCastMapper&) = delete;
+};
+
+#endif
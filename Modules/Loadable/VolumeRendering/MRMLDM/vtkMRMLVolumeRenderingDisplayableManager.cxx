@@ -24,6 +24,8 @@
 
 #include "vtkSlicerConfigure.h" // For Slicer_VTK_RENDERING_USE_OpenGL2_BACKEND
 #include "vtkSlicerVolumeRenderingLogic.h"
+#include "vtkEmptySpaceSkippingVolumeRayCastMapper.h"
+#include "vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode.h"
 #include "vtkMRMLCPURayCastVolumeRenderingDisplayNode.h"
 #include "vtkMRMLGPURayCastVolumeRenderingDisplayNode.h"
 #include "vtkMRMLMultiVolumeRenderingDisplayNode.h"
@@ -44,6 +46,7 @@
 #include <vtkVersion.h> // must precede reference to VTK_MAJOR_VERSION
 #include "vtkAddonMathUtilities.h"
 #include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
 #include <vtkClipVolume.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
@@ -156,9 +159,16 @@ public:
   class PipelineCPU : public Pipeline
   {
   public:
-    PipelineCPU() : Pipeline()
+    PipelineCPU(bool emptySpaceSkipping = false) : Pipeline()
     {
-      this->RayCastMapperCPU = vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
+      if (emptySpaceSkipping)
+      {
+        this->RayCastMapperCPU = vtkSmartPointer<vtkEmptySpaceSkippingVolumeRayCastMapper>::New();
+      }
+      else
+      {
+        this->RayCastMapperCPU = vtkSmartPointer<vtkFixedPointVolumeRayCastMapper>::New();
+      }
       this->VolumeScaling = vtkSmartPointer<vtkImageChangeInformation>::New();
       this->RayCastMapperCPU->SetInputConnection(0, this->VolumeScaling->GetOutputPort());
     }
@@ -219,6 +229,23 @@ public:
   vtkIdType GetMaxMemoryInBytes(vtkMRMLVolumeRenderingDisplayNode* displayNode);
   void UpdateDesiredUpdateRate(vtkMRMLVolumeRenderingDisplayNode* displayNode);
 
+  // Progressive refinement of CPU ray cast volumes
+  void AddRendererObservations(vtkRenderer* renderer);
+  void RemoveRendererObservations();
+  static void RendererCallback(vtkObject* caller, unsigned long eid, void* clientData, void* callData);
+  /// Set image sample distance of CPU ray cast mappers based on the current refinement level
+  void UpdateProgressiveRefinementBeforeRender();
+  /// Request rendering of the next refinement level
+  void UpdateProgressiveRefinementAfterRender();
+  /// Abort rendering of a refinement level if there are pending input events
+  void AbortProgressiveRefinementIfEventPending(vtkRenderWindow* renderWindow);
+  bool IsProgressiveRefinementEnabled();
+  bool IsInteracting();
+  double GetProgressiveImageSampleDistance();
+  /// Camera parameters, view size and modification time of CPU ray cast volumes.
+  /// Refinement is restarted if any of these change.
+  std::vector<double> GetProgressiveRefinementState();
+
   // Observations
   void AddObservations(vtkMRMLVolumeNode* node);
   void RemoveObservations(vtkMRMLVolumeNode* node);
@@ -253,6 +280,14 @@ public:
   /// When interaction is >0, we are in interactive mode (low level of detail)
   int Interaction;
 
+  /// Index of the currently rendered progressive refinement level (0 = coarsest)
+  int ProgressiveRefinementLevel;
+  /// State of the view at the last render
+  std::vector<double> ProgressiveRefinementState;
+  vtkSmartPointer<vtkCallbackCommand> RendererCallbackCommand;
+  vtkWeakPointer<vtkRenderer> ObservedRenderer;
+  vtkWeakPointer<vtkRenderWindow> ObservedRenderWindow;
+
   /// Picker of volume in renderer
   vtkSmartPointer<vtkVolumePicker> VolumePicker;
 
@@ -280,8 +315,13 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::vtkInternal(vtkMRMLVolume
 , AddingVolumeNode(false)
 , OriginalDesiredUpdateRate(0.0) // 0 fps is a special value that means it hasn't been set
 , Interaction(0)
+, ProgressiveRefinementLevel(0)
 , PickedNodeID("")
 {
+  this->RendererCallbackCommand = vtkSmartPointer<vtkCallbackCommand>::New();
+  this->RendererCallbackCommand->SetClientData(this);
+  this->RendererCallbackCommand->SetCallback(vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::RendererCallback);
+
   this->MultiVolumeActor = vtkSmartPointer<vtkMultiVolume>::New();
   this->MultiVolumeMapper = vtkSmartPointer<vtkGPUVolumeRayCastMapper>::New();
   this->MultiVolumeDummyImage = vtkSmartPointer<vtkImageData>::New();
@@ -323,6 +363,7 @@ vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::vtkInternal(vtkMRMLVolume
 //---------------------------------------------------------------------------
 vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::~vtkInternal()
 {
+  this->RemoveRendererObservations();
   this->ClearDisplayableNodes();
 
   if (this->DisplayObservedEvents)
@@ -564,7 +605,8 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::AddDisplayNode(vtkMR
 
   if (displayNode->IsA("vtkMRMLCPURayCastVolumeRenderingDisplayNode"))
   {
-    PipelineCPU* pipelineCpu = new PipelineCPU();
+    PipelineCPU* pipelineCpu = new PipelineCPU(
+      displayNode->IsA("vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode"));
     pipelineCpu->DisplayNode = displayNode;
     // Set volume to the mapper
     // Reconnection is expensive operation, therefore only do it if needed
@@ -1042,6 +1084,12 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateDisplayNodePip
         cpuMapper->SetLockSampleDistanceToInputSpacing(false);
         cpuMapper->SetImageSampleDistance(0.5);
         break;
+      case vtkMRMLViewNode::Progressive:
+        // Image sample distance is set before each render based on the refinement level
+        cpuMapper->SetAutoAdjustSampleDistances(false);
+        cpuMapper->SetLockSampleDistanceToInputSpacing(true);
+        cpuMapper->SetImageSampleDistance(this->GetProgressiveImageSampleDistance());
+        break;
     }
 
     cpuMapper->SetSampleDistance(displayNode->GetSampleDistance());
@@ -1074,6 +1122,7 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateDisplayNodePip
         gpuMapper->SetUseJittering(viewNode->GetVolumeRenderingSurfaceSmoothing());
         break;
       case vtkMRMLViewNode::Normal:
+      case vtkMRMLViewNode::Progressive: // progressive refinement is only available for CPU ray casting
         gpuMapper->SetAutoAdjustSampleDistances(false);
         gpuMapper->SetLockSampleDistanceToInputSpacing(true);
         gpuMapper->SetUseJittering(viewNode->GetVolumeRenderingSurfaceSmoothing());
@@ -1111,6 +1160,7 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateDisplayNodePip
         gpuMultiMapper->SetUseJittering(viewNode->GetVolumeRenderingSurfaceSmoothing());
         break;
       case vtkMRMLViewNode::Normal:
+      case vtkMRMLViewNode::Progressive: // progressive refinement is only available for CPU ray casting
         gpuMultiMapper->SetAutoAdjustSampleDistances(false);
         // need to disable LockSampleDistanceToInputSpacing because the dummy volume would interfere with the computation
         gpuMultiMapper->SetLockSampleDistanceToInputSpacing(false);
@@ -1313,6 +1363,200 @@ void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateDesiredUpdateR
   }
 }
 
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::AddRendererObservations(vtkRenderer* renderer)
+{
+  this->RemoveRendererObservations();
+  if (!renderer)
+  {
+    return;
+  }
+  renderer->AddObserver(vtkCommand::StartEvent, this->RendererCallbackCommand);
+  renderer->AddObserver(vtkCommand::EndEvent, this->RendererCallbackCommand);
+  this->ObservedRenderer = renderer;
+  vtkRenderWindow* renderWindow = renderer->GetRenderWindow();
+  if (renderWindow)
+  {
+    renderWindow->AddObserver(vtkCommand::AbortCheckEvent, this->RendererCallbackCommand);
+    this->ObservedRenderWindow = renderWindow;
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::RemoveRendererObservations()
+{
+  if (this->ObservedRenderer)
+  {
+    this->ObservedRenderer->RemoveObserver(this->RendererCallbackCommand);
+    this->ObservedRenderer = nullptr;
+  }
+  if (this->ObservedRenderWindow)
+  {
+    this->ObservedRenderWindow->RemoveObserver(this->RendererCallbackCommand);
+    this->ObservedRenderWindow = nullptr;
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::RendererCallback(
+  vtkObject* caller, unsigned long eid, void* clientData, void* vtkNotUsed(callData))
+{
+  vtkMRMLVolumeRenderingDisplayableManager::vtkInternal* self =
+    reinterpret_cast<vtkMRMLVolumeRenderingDisplayableManager::vtkInternal*>(clientData);
+  if (eid == vtkCommand::AbortCheckEvent)
+  {
+    self->AbortProgressiveRefinementIfEventPending(vtkRenderWindow::SafeDownCast(caller));
+  }
+  else if (eid == vtkCommand::StartEvent)
+  {
+    self->UpdateProgressiveRefinementBeforeRender();
+  }
+  else if (eid == vtkCommand::EndEvent)
+  {
+    self->UpdateProgressiveRefinementAfterRender();
+  }
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::IsProgressiveRefinementEnabled()
+{
+  vtkMRMLViewNode* viewNode = this->External->GetMRMLViewNode();
+  if (!viewNode || viewNode->GetVolumeRenderingQuality() != vtkMRMLViewNode::Progressive)
+  {
+    return false;
+  }
+  for (Pipeline* pipeline : this->DisplayPipelines)
+  {
+    if (dynamic_cast<PipelineCPU*>(pipeline) && pipeline->VolumeActor->GetVisibility())
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+bool vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::IsInteracting()
+{
+  if (this->Interaction > 0)
+  {
+    return true;
+  }
+  vtkRenderWindowInteractor* interactor = this->External->GetInteractor();
+  vtkInteractorStyle* interactorStyle = interactor ? vtkInteractorStyle::SafeDownCast(interactor->GetInteractorStyle()) : nullptr;
+  return interactorStyle && interactorStyle->GetState() != VTKIS_NONE;
+}
+
+//---------------------------------------------------------------------------
+double vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::GetProgressiveImageSampleDistance()
+{
+  // Each level halves the image sample distance, the last level is the same as normal quality
+  const int numberOfLevels = this->External->NumberOfProgressiveRefinementLevels;
+  int level = std::max(0, std::min(this->ProgressiveRefinementLevel, numberOfLevels - 1));
+  return static_cast<double>(1 << (numberOfLevels - 1 - level));
+}
+
+//---------------------------------------------------------------------------
+std::vector<double> vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::GetProgressiveRefinementState()
+{
+  std::vector<double> state;
+  vtkRenderer* renderer = this->External->GetRenderer();
+  vtkCamera* camera = renderer ? renderer->GetActiveCamera() : nullptr;
+  if (camera)
+  {
+    double* position = camera->GetPosition();
+    state.insert(state.end(), position, position + 3);
+    double* focalPoint = camera->GetFocalPoint();
+    state.insert(state.end(), focalPoint, focalPoint + 3);
+    double* viewUp = camera->GetViewUp();
+    state.insert(state.end(), viewUp, viewUp + 3);
+    state.push_back(camera->GetViewAngle());
+    state.push_back(camera->GetParallelScale());
+    state.push_back(camera->GetParallelProjection());
+  }
+  if (renderer)
+  {
+    int* size = renderer->GetSize();
+    state.push_back(size[0]);
+    state.push_back(size[1]);
+  }
+  for (Pipeline* pipeline : this->DisplayPipelines)
+  {
+    if (dynamic_cast<PipelineCPU*>(pipeline))
+    {
+      // Includes changes of the volume property (transfer functions) and transform
+      state.push_back(static_cast<double>(pipeline->VolumeActor->GetMTime()));
+      state.push_back(pipeline->VolumeActor->GetVisibility());
+    }
+  }
+  return state;
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateProgressiveRefinementBeforeRender()
+{
+  if (!this->IsProgressiveRefinementEnabled())
+  {
+    return;
+  }
+  // Start from the coarsest level if anything changed since the last render
+  if (this->IsInteracting() || this->GetProgressiveRefinementState() != this->ProgressiveRefinementState)
+  {
+    this->ProgressiveRefinementLevel = 0;
+  }
+  double imageSampleDistance = this->GetProgressiveImageSampleDistance();
+  for (Pipeline* pipeline : this->DisplayPipelines)
+  {
+    PipelineCPU* pipelineCpu = dynamic_cast<PipelineCPU*>(pipeline);
+    if (pipelineCpu)
+    {
+      pipelineCpu->RayCastMapperCPU->SetImageSampleDistance(imageSampleDistance);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::UpdateProgressiveRefinementAfterRender()
+{
+  if (!this->IsProgressiveRefinementEnabled())
+  {
+    return;
+  }
+  this->ProgressiveRefinementState = this->GetProgressiveRefinementState();
+  vtkRenderWindow* renderWindow = this->ObservedRenderer ? this->ObservedRenderer->GetRenderWindow() : nullptr;
+  if (renderWindow && renderWindow->GetAbortRender())
+  {
+    // The aborted image is not displayed. Render this level again after pending events
+    // are processed, interaction restarts refinement from the coarsest level.
+    this->External->RequestRender();
+    return;
+  }
+  if (this->IsInteracting()
+    || this->ProgressiveRefinementLevel >= this->External->NumberOfProgressiveRefinementLevels - 1)
+  {
+    // Keep the low resolution during interaction, refinement starts when interaction stops
+    return;
+  }
+  // The rendered image is displayed now, the next level is rendered asynchronously
+  // so that user interaction can restart refinement before it starts.
+  ++this->ProgressiveRefinementLevel;
+  this->External->RequestRender();
+}
+
+//---------------------------------------------------------------------------
+void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::AbortProgressiveRefinementIfEventPending(vtkRenderWindow* renderWindow)
+{
+  // The coarsest level is always completed so that the view follows the interaction
+  if (!renderWindow || this->ProgressiveRefinementLevel == 0 || !this->IsProgressiveRefinementEnabled())
+  {
+    return;
+  }
+  if (renderWindow->GetEventPending())
+  {
+    renderWindow->SetAbortRender(1);
+  }
+}
+
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager::vtkInternal::AddObservations(vtkMRMLVolumeNode* node)
 {
@@ -1546,12 +1790,14 @@ void vtkMRMLVolumeRenderingDisplayableManager::PrintSelf( ostream& os, vtkIndent
 {
   this->Superclass::PrintSelf ( os, indent );
   os << indent << "vtkMRMLVolumeRenderingDisplayableManager: " << this->GetClassName() << "\n";
+  os << indent << "NumberOfProgressiveRefinementLevels: " << this->NumberOfProgressiveRefinementLevels << "\n";
 }
 
 //---------------------------------------------------------------------------
 void vtkMRMLVolumeRenderingDisplayableManager::Create()
 {
   Superclass::Create();
+  this->Internal->AddRendererObservations(this->GetRenderer());
   this->ObserveGraphicalResourcesCreatedEvent();
   this->SetUpdateFromMRMLRequested(true);
 }
@@ -1921,3 +2167,9 @@ const char* vtkMRMLVolumeRenderingDisplayableManager::GetPickedNodeID()
 {
   return this->Internal->PickedNodeID.c_str();
 }
+
+//---------------------------------------------------------------------------
+int vtkMRMLVolumeRenderingDisplayableManager::GetProgressiveRefinementLevel()
+{
+  return this->Internal->ProgressiveRefinementLevel;
+}
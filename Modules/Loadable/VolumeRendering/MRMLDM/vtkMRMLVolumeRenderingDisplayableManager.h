@@ -65,6 +65,17 @@ public:
   /// Get the MRML ID of the picked node, returns empty string if no pick
   const char* GetPickedNodeID() override;
 
+  /// Get the current refinement level of CPU ray cast volumes when volume rendering quality
+  /// is set to vtkMRMLViewNode::Progressive. 0 is the coarsest level,
+  /// NumberOfProgressiveRefinementLevels-1 is the final (normal quality) level.
+  int GetProgressiveRefinementLevel();
+
+  /// Number of image resolution levels used for progressive refinement. Each level halves
+  /// the image sample distance of the previous level, the last level uses image sample distance of 1.
+  /// Default is 3.
+  vtkSetClampMacro(NumberOfProgressiveRefinementLevels, int, 1, 8);
+  vtkGetMacro(NumberOfProgressiveRefinementLevels, int);
+
 public:
   static int DefaultGPUMemorySize;
 
@@ -84,6 +95,7 @@ protected:
 
 protected:
   vtkSlicerVolumeRenderingLogic *VolumeRenderingLogic{nullptr};
+  int NumberOfProgressiveRefinementLevels{3};
 
 protected:
   vtkMRMLVolumeRenderingDisplayableManager(const vtkMRMLVolumeRenderingDisplayableManager&); // Not implemented
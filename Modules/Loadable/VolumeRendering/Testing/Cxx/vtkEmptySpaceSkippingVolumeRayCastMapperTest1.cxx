@@ -0,0 +1,172 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRendering includes
+#include <vtkEmptySpaceSkippingVolumeRayCastMapper.h>
+
+// MRML includes
+#include "vtkMRMLCoreTestingMacros.h"
+
+// VTK includes
+#include <vtkColorTransferFunction.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkImageDifference.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkVolume.h>
+#include <vtkVolumeProperty.h>
+#include <vtkWindowToImageFilter.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Create a 64^3 volume that contains a bright sphere centered at (40, 30, 20) with radius 10
+void CreateSphereVolume(vtkImageData* imageData)
+{
+  imageData->SetDimensions(64, 64, 64);
+  imageData->AllocateScalars(VTK_SHORT, 1);
+  short* scalars = static_cast<short*>(imageData->GetScalarPointer());
+  for (int k = 0; k < 64; ++k)
+  {
+    for (int j = 0; j < 64; ++j)
+    {
+      for (int i = 0; i < 64; ++i)
+      {
+        double distance2 = (i - 40) * (i - 40) + (j - 30) * (j - 30) + (k - 20) * (k - 20);
+        *(scalars++) = (distance2 < 100.0 ? 1000 : -1000);
+      }
+    }
+  }
+}
+
+//----------------------------------------------------------------------------
+void RenderVolume(vtkVolumeMapper* mapper, vtkVolumeProperty* property, vtkImageData* outputImage)
+{
+  vtkNew<vtkVolume> volume;
+  volume->SetMapper(mapper);
+  volume->SetProperty(property);
+  vtkNew<vtkRenderer> renderer;
+  renderer->AddVolume(volume);
+  vtkNew<vtkRenderWindow> renderWindow;
+  renderWindow->SetSize(200, 200);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer);
+  renderer->ResetCamera();
+  renderWindow->Render();
+  vtkNew<vtkWindowToImageFilter> windowToImage;
+  windowToImage->SetInput(renderWindow);
+  windowToImage->Update();
+  outputImage->DeepCopy(windowToImage->GetOutput());
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkEmptySpaceSkippingVolumeRayCastMapperTest1(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkImageData> imageData;
+  CreateSphereVolume(imageData);
+
+  vtkNew<vtkPiecewiseFunction> scalarOpacity;
+  scalarOpacity->AddPoint(-1000.0, 0.0);
+  scalarOpacity->AddPoint(0.0, 0.0);
+  scalarOpacity->AddPoint(500.0, 0.5);
+  scalarOpacity->AddPoint(1000.0, 0.5);
+  vtkNew<vtkColorTransferFunction> color;
+  color->AddRGBPoint(-1000.0, 0.0, 0.0, 0.0);
+  color->AddRGBPoint(1000.0, 1.0, 1.0, 1.0);
+  vtkNew<vtkVolumeProperty> property;
+  property->SetScalarOpacity(scalarOpacity);
+  property->SetColor(color);
+
+  vtkNew<vtkEmptySpaceSkippingVolumeRayCastMapper> mapper;
+  CHECK_BOOL(mapper->GetEmptySpaceSkipping(), true);
+  CHECK_BOOL(mapper->UpdateNonTransparentExtent(property), false); // no input
+  mapper->SetInputData(imageData);
+  mapper->SetBrickSize(8);
+
+  // Non-transparent extent is the extent of the bricks that contain the sphere.
+  // Sphere voxels are in the extent [31, 49, 21, 39, 11, 29], bricks share boundary voxels.
+  CHECK_BOOL(mapper->UpdateNonTransparentExtent(property), true);
+  int* extent = mapper->GetNonTransparentExtent();
+  const int expectedExtent[6] = { 24, 56, 16, 40, 8, 32 };
+  for (int boundIndex = 0; boundIndex < 6; ++boundIndex)
+  {
+    CHECK_INT(extent[boundIndex], expectedExtent[boundIndex]);
+  }
+  vtkIdType numberOfSphereBricks = mapper->GetNumberOfNonTransparentBricks();
+  CHECK_BOOL(numberOfSphereBricks > 0, true);
+  CHECK_BOOL(numberOfSphereBricks < 8 * 8 * 8 / 4, true);
+
+  // Octree built in a single thread gives the same classification
+  vtkNew<vtkEmptySpaceSkippingVolumeRayCastMapper> singleThreadedMapper;
+  singleThreadedMapper->SetNumberOfThreads(1);
+  singleThreadedMapper->SetInputData(imageData);
+  singleThreadedMapper->SetBrickSize(8);
+  CHECK_BOOL(singleThreadedMapper->UpdateNonTransparentExtent(property), true);
+  CHECK_INT(singleThreadedMapper->GetNumberOfNonTransparentBricks(), numberOfSphereBricks);
+  for (int boundIndex = 0; boundIndex < 6; ++boundIndex)
+  {
+    CHECK_INT(singleThreadedMapper->GetNonTransparentExtent()[boundIndex], extent[boundIndex]);
+  }
+
+  // Color changes do not affect classification
+  color->AddRGBPoint(0.0, 1.0, 0.0, 0.0);
+  CHECK_BOOL(mapper->UpdateNonTransparentExtent(property), true);
+  CHECK_INT(mapper->GetNumberOfNonTransparentBricks(), numberOfSphereBricks);
+
+  // Opacity curve changes are reclassified
+  scalarOpacity->RemoveAllPoints();
+  scalarOpacity->AddPoint(-1000.0, 0.0);
+  scalarOpacity->AddPoint(1000.0, 0.0);
+  CHECK_BOOL(mapper->UpdateNonTransparentExtent(property), true);
+  CHECK_INT(mapper->GetNumberOfNonTransparentBricks(), 0);
+  extent = mapper->GetNonTransparentExtent();
+  CHECK_BOOL(extent[0] > extent[1], true);
+
+  scalarOpacity->AddPoint(-1000.0, 0.1);
+  CHECK_BOOL(mapper->UpdateNonTransparentExtent(property), true);
+  extent = mapper->GetNonTransparentExtent();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    CHECK_INT(extent[axis * 2], 0);
+    CHECK_INT(extent[axis * 2 + 1], 63);
+  }
+
+  // Rendered image is the same as the one rendered without empty space skipping
+  scalarOpacity->RemoveAllPoints();
+  scalarOpacity->AddPoint(-1000.0, 0.0);
+  scalarOpacity->AddPoint(0.0, 0.0);
+  scalarOpacity->AddPoint(500.0, 0.5);
+  scalarOpacity->AddPoint(1000.0, 0.5);
+  vtkNew<vtkFixedPointVolumeRayCastMapper> referenceMapper;
+  referenceMapper->SetInputData(imageData);
+  vtkNew<vtkImageData> referenceImage;
+  RenderVolume(referenceMapper, property, referenceImage);
+  vtkNew<vtkImageData> image;
+  RenderVolume(mapper, property, image);
+  vtkNew<vtkImageDifference> difference;
+  difference->SetInputData(image);
+  difference->SetImageData(referenceImage);
+  difference->Update();
+  std::cout << "Image difference: " << difference->GetThresholdedError() << std::endl;
+  CHECK_BOOL(difference->GetThresholdedError() < 10.0, true);
+
+  return EXIT_SUCCESS;
+}
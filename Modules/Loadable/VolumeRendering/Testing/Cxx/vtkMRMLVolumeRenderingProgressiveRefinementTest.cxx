@@ -0,0 +1,162 @@
+/*==============================================================================
+
+  Program: 3D Slicer
+
+  See COPYRIGHT.txt
+  or http://www.slicer.org/copyright/copyright.txt for details.
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+
+==============================================================================*/
+
+// VolumeRendering includes
+#include <vtkMRMLVolumeRenderingDisplayNode.h>
+#include <vtkMRMLVolumeRenderingDisplayableManager.h>
+#include <vtkSlicerVolumeRenderingLogic.h>
+
+// MRMLDisplayableManager includes
+#include <vtkMRMLDisplayableManagerGroup.h>
+
+// MRMLLogic includes
+#include <vtkMRMLApplicationLogic.h>
+
+// MRML includes
+#include <vtkMRMLCoreTestingMacros.h>
+#include <vtkMRMLScalarVolumeNode.h>
+#include <vtkMRMLScene.h>
+#include <vtkMRMLViewNode.h>
+#include <vtkMRMLVolumePropertyNode.h>
+
+// VTK includes
+#include <vtkCallbackCommand.h>
+#include <vtkCamera.h>
+#include <vtkFixedPointVolumeRayCastMapper.h>
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkPiecewiseFunction.h>
+#include <vtkRenderer.h>
+#include <vtkRenderWindow.h>
+#include <vtkRenderWindowInteractor.h>
+
+namespace
+{
+
+//----------------------------------------------------------------------------
+// Simulate an input event that arrives while the image is rendered
+void AbortRenderCallback(vtkObject* caller, unsigned long vtkNotUsed(eid),
+  void* vtkNotUsed(clientData), void* vtkNotUsed(callData))
+{
+  vtkRenderWindow::SafeDownCast(caller)->SetAbortRender(1);
+}
+
+} // end of anonymous namespace
+
+//----------------------------------------------------------------------------
+int vtkMRMLVolumeRenderingProgressiveRefinementTest(int vtkNotUsed(argc), char* vtkNotUsed(argv)[])
+{
+  vtkNew<vtkRenderer> renderer;
+  vtkNew<vtkRenderWindow> renderWindow;
+  vtkNew<vtkRenderWindowInteractor> renderWindowInteractor;
+  renderWindow->SetSize(300, 300);
+  renderWindow->SetMultiSamples(0);
+  renderWindow->AddRenderer(renderer);
+  renderWindow->SetInteractor(renderWindowInteractor);
+
+  vtkNew<vtkMRMLScene> scene;
+  vtkNew<vtkMRMLApplicationLogic> applicationLogic;
+  applicationLogic->SetMRMLScene(scene);
+
+  vtkNew<vtkMRMLViewNode> viewNode;
+  viewNode->SetVolumeRenderingQuality(vtkMRMLViewNode::Progressive);
+  scene->AddNode(viewNode);
+
+  vtkNew<vtkMRMLDisplayableManagerGroup> displayableManagerGroup;
+  displayableManagerGroup->SetRenderer(renderer);
+  displayableManagerGroup->SetMRMLDisplayableNode(viewNode);
+  vtkNew<vtkMRMLVolumeRenderingDisplayableManager> vrDisplayableManager;
+  vrDisplayableManager->SetMRMLApplicationLogic(applicationLogic);
+  vrDisplayableManager->SetMRMLScene(scene);
+  displayableManagerGroup->AddDisplayableManager(vrDisplayableManager);
+  displayableManagerGroup->GetInteractor()->Initialize();
+
+  vtkNew<vtkImageData> imageData;
+  imageData->SetDimensions(32, 32, 32);
+  imageData->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
+  unsigned char* scalars = static_cast<unsigned char*>(imageData->GetScalarPointer());
+  for (vtkIdType i = 0; i < 32 * 32 * 32; ++i)
+  {
+    scalars[i] = static_cast<unsigned char>(i % 256);
+  }
+  vtkNew<vtkMRMLScalarVolumeNode> volumeNode;
+  volumeNode->SetAndObserveImageData(imageData);
+  scene->AddNode(volumeNode);
+
+  vtkNew<vtkSlicerVolumeRenderingLogic> vrLogic;
+  vrLogic->SetDefaultRenderingMethod("vtkMRMLCPURayCastVolumeRenderingDisplayNode");
+  vrLogic->SetMRMLScene(scene);
+  vtkMRMLVolumeRenderingDisplayNode* vrDisplayNode = vrLogic->CreateDefaultVolumeRenderingNodes(volumeNode);
+  CHECK_NOT_NULL(vrDisplayNode);
+  vrDisplayNode->SetVisibility(true);
+  renderer->ResetCamera();
+
+  vtkFixedPointVolumeRayCastMapper* mapper =
+    vtkFixedPointVolumeRayCastMapper::SafeDownCast(vrDisplayableManager->GetVolumeMapper(volumeNode));
+  CHECK_NOT_NULL(mapper);
+  CHECK_INT(vrDisplayableManager->GetNumberOfProgressiveRefinementLevels(), 3);
+
+  // Each render refines the image, until normal quality is reached
+  const double expectedImageSampleDistances[] = { 4.0, 2.0, 1.0, 1.0 };
+  for (double expectedImageSampleDistance : expectedImageSampleDistances)
+  {
+    renderWindow->Render();
+    CHECK_DOUBLE(mapper->GetImageSampleDistance(), expectedImageSampleDistance);
+  }
+  CHECK_INT(vrDisplayableManager->GetProgressiveRefinementLevel(), 2);
+
+  // Camera change restarts refinement
+  renderer->GetActiveCamera()->Azimuth(10.0);
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 4.0);
+  renderWindow->Render();
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 1.0);
+
+  // Transfer function change restarts refinement
+  vtkMRMLVolumePropertyNode* volumePropertyNode = vrDisplayNode->GetVolumePropertyNode();
+  CHECK_NOT_NULL(volumePropertyNode);
+  volumePropertyNode->GetScalarOpacity()->AddPoint(128.0, 0.5);
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 4.0);
+
+  // Rendering without changes continues refinement
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 2.0);
+
+  // Aborted refinement level is rendered again
+  renderer->GetActiveCamera()->Azimuth(10.0);
+  renderWindow->Render();
+  CHECK_INT(vrDisplayableManager->GetProgressiveRefinementLevel(), 1);
+  vtkNew<vtkCallbackCommand> abortRenderCallback;
+  abortRenderCallback->SetCallback(AbortRenderCallback);
+  unsigned long abortObserverTag = renderWindow->AddObserver(vtkCommand::AbortCheckEvent, abortRenderCallback);
+  renderWindow->Render();
+  CHECK_INT(vrDisplayableManager->GetProgressiveRefinementLevel(), 1);
+  renderWindow->RemoveObserver(abortObserverTag);
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 2.0);
+  CHECK_INT(vrDisplayableManager->GetProgressiveRefinementLevel(), 2);
+
+  // Number of levels can be set for each view
+  vrDisplayableManager->SetNumberOfProgressiveRefinementLevels(2);
+  renderer->GetActiveCamera()->Azimuth(10.0);
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 2.0);
+  renderWindow->Render();
+  CHECK_DOUBLE(mapper->GetImageSampleDistance(), 1.0);
+
+  return EXIT_SUCCESS;
+}
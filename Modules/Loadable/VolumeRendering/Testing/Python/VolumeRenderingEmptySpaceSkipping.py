@@ -0,0 +1,135 @@
+import time
+
+import numpy as np
+import vtk
+
+import slicer
+from slicer.ScriptedLoadableModule import ScriptedLoadableModuleTest
+
+
+class VolumeRenderingEmptySpaceSkipping(ScriptedLoadableModuleTest):
+    """
+    Check correctness of empty space skipping on a synthetic volume and compare rendering time
+    of CPU ray casting with and without empty space skipping. Render times and the speedup
+    are reported as dashboard measurements.
+
+    See VolumeRenderingEmptySpaceSkippingBenchmark for measurements on clinical sample data.
+    """
+
+    def setUp(self):
+        slicer.mrmlScene.Clear(0)
+
+    def tearDown(self):
+        slicer.mrmlScene.Clear(0)
+
+    def test_SyntheticVolume(self):
+        volumeNode = self.createSphereVolume()
+        brickSize = 8
+
+        # Non-transparent extent must be exactly the extent of the bricks that contain visible voxels
+        scalarOpacity, color = self.createTransferFunctions()
+        volumeProperty = vtk.vtkVolumeProperty()
+        volumeProperty.SetScalarOpacity(scalarOpacity)
+        volumeProperty.SetColor(color)
+        voxels = slicer.util.arrayFromVolume(volumeNode)
+        visibleVoxelIndices = np.nonzero(voxels > 0)
+        dimensions = volumeNode.GetImageData().GetDimensions()
+        expectedExtent = []
+        # numpy array axis order is k, j, i
+        for axis, arrayAxis in enumerate([2, 1, 0]):
+            numberOfBricks = max(1, (dimensions[axis] - 1 + brickSize - 1) // brickSize)
+            firstVoxel = visibleVoxelIndices[arrayAxis].min()
+            lastVoxel = visibleVoxelIndices[arrayAxis].max()
+            # bricks share their boundary voxels, use the first brick that contains the first voxel
+            # and the last brick that contains the last voxel
+            firstBrick = max(0, (firstVoxel - 1) // brickSize)
+            lastBrick = min(lastVoxel // brickSize, numberOfBricks - 1)
+            expectedExtent.append(firstBrick * brickSize)
+            expectedExtent.append(min(lastBrick * brickSize + brickSize, dimensions[axis] - 1))
+
+        for numberOfThreads in [1, 0]:
+            mapper = slicer.vtkEmptySpaceSkippingVolumeRayCastMapper()
+            mapper.SetNumberOfThreads(numberOfThreads)
+            mapper.SetBrickSize(brickSize)
+            mapper.SetInputData(volumeNode.GetImageData())
+            self.assertTrue(mapper.UpdateNonTransparentExtent(volumeProperty))
+            self.assertEqual(list(mapper.GetNonTransparentExtent()), expectedExtent)
+
+        # Rendered image must match the image rendered without empty space skipping
+        self.benchmarkVolume(volumeNode)
+
+    def createSphereVolume(self, dimensions=(256, 256, 256), center=(160, 100, 80), radius=20):
+        """Create a volume that contains a bright sphere in dark background."""
+        k, j, i = np.ogrid[0:dimensions[2], 0:dimensions[1], 0:dimensions[0]]
+        distance2 = (i - center[0]) ** 2 + (j - center[1]) ** 2 + (k - center[2]) ** 2
+        voxels = np.where(distance2 < radius * radius, 1000, -1000).astype(np.int16)
+        return slicer.util.addVolumeFromArray(voxels, name="Sphere")
+
+    def createTransferFunctions(self):
+        """Create transfer functions that only show the sphere."""
+        scalarOpacity = vtk.vtkPiecewiseFunction()
+        scalarOpacity.AddPoint(-1000.0, 0.0)
+        scalarOpacity.AddPoint(0.0, 0.0)
+        scalarOpacity.AddPoint(500.0, 0.5)
+        scalarOpacity.AddPoint(1000.0, 0.5)
+        color = vtk.vtkColorTransferFunction()
+        color.AddRGBPoint(-1000.0, 0.0, 0.0, 0.0)
+        color.AddRGBPoint(1000.0, 1.0, 1.0, 1.0)
+        return scalarOpacity, color
+
+    def renderView(self, threeDView, numberOfFrames):
+        """Render the view while rotating the camera. Returns average render time in seconds
+        and the image rendered in the last frame.
+        """
+        threeDView.resetFocalPoint()
+        renderWindow = threeDView.renderWindow()
+        camera = renderWindow.GetRenderers().GetFirstRenderer().GetActiveCamera()
+        startTime = time.perf_counter()
+        for frameIndex in range(numberOfFrames):
+            camera.Azimuth(360.0 / numberOfFrames)
+            renderWindow.Render()
+        averageRenderTime = (time.perf_counter() - startTime) / numberOfFrames
+        windowToImage = vtk.vtkWindowToImageFilter()
+        windowToImage.SetInput(renderWindow)
+        windowToImage.Update()
+        image = vtk.vtkImageData()
+        image.DeepCopy(windowToImage.GetOutput())
+        return averageRenderTime, image
+
+    def benchmarkVolume(self, volumeNode, numberOfFrames=10):
+        layoutManager = slicer.app.layoutManager()
+        layoutManager.setLayout(slicer.vtkMRMLLayoutNode.SlicerLayoutOneUp3DView)
+        threeDView = layoutManager.threeDWidget(0).threeDView()
+
+        logic = slicer.modules.volumerendering.logic()
+        defaultRenderingMethod = logic.GetDefaultRenderingMethod()
+        results = {}
+        for methodClassName in ["vtkMRMLCPURayCastVolumeRenderingDisplayNode", "vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode"]:
+            logic.SetDefaultRenderingMethod(methodClassName)
+            displayNode = logic.CreateDefaultVolumeRenderingNodes(volumeNode)
+            scalarOpacity, color = self.createTransferFunctions()
+            displayNode.GetVolumePropertyNode().SetScalarOpacity(scalarOpacity)
+            displayNode.GetVolumePropertyNode().SetColor(color)
+            displayNode.SetVisibility(True)
+            # First render builds the rendering pipeline (and the octree), exclude it from the measurement
+            threeDView.forceRender()
+            results[methodClassName] = self.renderView(threeDView, numberOfFrames)
+            displayNode.SetVisibility(False)
+            slicer.mrmlScene.RemoveNode(displayNode)
+        logic.SetDefaultRenderingMethod(defaultRenderingMethod)
+
+        referenceTime, referenceImage = results["vtkMRMLCPURayCastVolumeRenderingDisplayNode"]
+        emptySpaceSkippingTime, image = results["vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode"]
+        difference = vtk.vtkImageDifference()
+        difference.SetInputData(image)
+        difference.SetImageData(referenceImage)
+        difference.Update()
+        measurements = {
+            "CPURayCastRenderTimeMs": referenceTime * 1000.0,
+            "EmptySpaceSkippingRenderTimeMs": emptySpaceSkippingTime * 1000.0,
+            "EmptySpaceSkippingSpeedup": referenceTime / emptySpaceSkippingTime,
+            "EmptySpaceSkippingImageDifference": difference.GetThresholdedError(),
+        }
+        for name, value in measurements.items():
+            print(f'<DartMeasurement name="{name}" type="numeric/double">{value:.3f}</DartMeasurement>')
+        self.assertLess(difference.GetThresholdedError(), 10.0)
@@ -0,0 +1,87 @@
+import time
+
+import vtk
+
+import slicer
+from slicer.ScriptedLoadableModule import ScriptedLoadableModuleTest
+
+
+class VolumeRenderingEmptySpaceSkippingBenchmark(ScriptedLoadableModuleTest):
+    """
+    Compare rendering time and image quality of CPU ray casting with and without empty space skipping
+    on the CTChest and CTACardio sample data sets. Render times and the speedup are reported
+    as dashboard measurements.
+
+    The test downloads sample data, therefore it is only added if Slicer_BUILD_BENCHMARK_TESTING is enabled.
+    """
+
+    def setUp(self):
+        slicer.mrmlScene.Clear(0)
+
+    def tearDown(self):
+        slicer.mrmlScene.Clear(0)
+
+    def test_CTChest(self):
+        self.benchmarkSample("CTChest", "CT-Chest-Contrast-Enhanced")
+
+    def test_CTACardio(self):
+        self.benchmarkSample("CTACardio", "CT-Cardiac3")
+
+    def renderView(self, threeDView, numberOfFrames):
+        """Render the view while rotating the camera. Returns average render time in seconds
+        and the image rendered in the last frame.
+        """
+        threeDView.resetFocalPoint()
+        renderWindow = threeDView.renderWindow()
+        camera = renderWindow.GetRenderers().GetFirstRenderer().GetActiveCamera()
+        startTime = time.perf_counter()
+        for frameIndex in range(numberOfFrames):
+            camera.Azimuth(360.0 / numberOfFrames)
+            renderWindow.Render()
+        averageRenderTime = (time.perf_counter() - startTime) / numberOfFrames
+        windowToImage = vtk.vtkWindowToImageFilter()
+        windowToImage.SetInput(renderWindow)
+        windowToImage.Update()
+        image = vtk.vtkImageData()
+        image.DeepCopy(windowToImage.GetOutput())
+        return averageRenderTime, image
+
+    def benchmarkSample(self, sampleName, presetName, numberOfFrames=10):
+        import SampleData
+
+        volumeNode = SampleData.downloadSample(sampleName)
+        layoutManager = slicer.app.layoutManager()
+        layoutManager.setLayout(slicer.vtkMRMLLayoutNode.SlicerLayoutOneUp3DView)
+        threeDView = layoutManager.threeDWidget(0).threeDView()
+
+        logic = slicer.modules.volumerendering.logic()
+        preset = logic.GetPresetByName(presetName)
+        defaultRenderingMethod = logic.GetDefaultRenderingMethod()
+        results = {}
+        for methodClassName in ["vtkMRMLCPURayCastVolumeRenderingDisplayNode", "vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode"]:
+            logic.SetDefaultRenderingMethod(methodClassName)
+            displayNode = logic.CreateDefaultVolumeRenderingNodes(volumeNode)
+            displayNode.GetVolumePropertyNode().Copy(preset)
+            displayNode.SetVisibility(True)
+            # First render builds the rendering pipeline (and the octree), exclude it from the measurement
+            threeDView.forceRender()
+            results[methodClassName] = self.renderView(threeDView, numberOfFrames)
+            displayNode.SetVisibility(False)
+            slicer.mrmlScene.RemoveNode(displayNode)
+        logic.SetDefaultRenderingMethod(defaultRenderingMethod)
+
+        referenceTime, referenceImage = results["vtkMRMLCPURayCastVolumeRenderingDisplayNode"]
+        emptySpaceSkippingTime, image = results["vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode"]
+        difference = vtk.vtkImageDifference()
+        difference.SetInputData(image)
+        difference.SetImageData(referenceImage)
+        difference.Update()
+        measurements = {
+            f"{sampleName}-CPURayCastRenderTimeMs": referenceTime * 1000.0,
+            f"{sampleName}-EmptySpaceSkippingRenderTimeMs": emptySpaceSkippingTime * 1000.0,
+            f"{sampleName}-EmptySpaceSkippingSpeedup": referenceTime / emptySpaceSkippingTime,
+            f"{sampleName}-EmptySpaceSkippingImageDifference": difference.GetThresholdedError(),
+        }
+        for name, value in measurements.items():
+            print(f'<DartMeasurement name="{name}" type="numeric/double">{value:.3f}</DartMeasurement>')
+        self.assertLess(difference.GetThresholdedError(), 10.0)
@@ -124,6 +124,8 @@ void qSlicerVolumeRenderingModuleWidgetPrivate::setupUi(qSlicerVolumeRenderingMo
   this->RenderingMethodStackedWidget->addWidget(new QWidget());
   q->addRenderingMethodWidget("vtkMRMLCPURayCastVolumeRenderingDisplayNode",
                               new qSlicerCPURayCastVolumeRenderingPropertiesWidget);
+  q->addRenderingMethodWidget("vtkMRMLCPUEmptySpaceSkippingVolumeRenderingDisplayNode",
+                              new qSlicerCPURayCastVolumeRenderingPropertiesWidget);
   q->addRenderingMethodWidget("vtkMRMLGPURayCastVolumeRenderingDisplayNode",
                               new qSlicerGPURayCastVolumeRenderingPropertiesWidget);
   q->addRenderingMethodWidget("vtkMRMLMultiVolumeRenderingDisplayNode",